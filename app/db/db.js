@@ -767,6 +767,11 @@ function onAbout() {
 
 // ====================== Toolbar Actions ======================
 
+// 查询在 C 侧工作线程上执行，行分批直接追加到 resultTable，这里只轮询进度
+var queryStreamId = 0;
+var queryPollTimer = 0;
+var queryStartTime = 0;
+
 function executeQuery() {
     var editor = yui.find("sqlEditor");
     var sql = editor ? editor.text : "";
@@ -779,21 +784,62 @@ function executeQuery() {
 
     updateStatus("执行中...", "#F9E2AF");
 
-    var result = YUI.call("mysql_query", JSON.stringify({ sql: sql }));
+    var result = YUI.call("mysql_query_start", JSON.stringify({
+        sql: sql, target: "resultTable", batch: RESULT_PAGE_SIZE
+    }));
+    var info = result ? JSON.parse(result) : null;
+    if (!info || info.error) {
+        updateStatus("查询失败: " + (info ? info.error : "无响应"), "#F38BA8");
+        return;
+    }
 
-    if (!result || result === "[]") {
-        var affectedInfo = YUI.call("mysql_exec", JSON.stringify({ sql: sql }));
-        if (affectedInfo) {
-            var info = JSON.parse(affectedInfo);
-            updateStatus("影响 " + (info.affected || 0) + " 行", "#A6E3A1");
-            showResults([], 0);
-        }
+    queryStreamId = info.id;
+    queryStartTime = Date.now();
+    resultRowsAll = [];
+    resultStreamed = true;
+    setResultInfo(0);
+    if (queryPollTimer) clearInterval(queryPollTimer);
+    queryPollTimer = setInterval(pollQuery, 100);
+}
+
+function pollQuery() {
+    if (!queryStreamId) return;
+    var text = YUI.call("mysql_query_status", JSON.stringify({ id: queryStreamId }));
+    var st = text ? JSON.parse(text) : null;
+    if (st && st.state === "running") {
+        setResultInfo(st.rows);
+        updateStatus("执行中... 已接收 " + st.rows + " 行", "#F9E2AF");
         return;
     }
 
-    var rows = JSON.parse(result);
-    showResults(rows, rows.length);
-    updateStatus("查询完成, " + rows.length + " 行", "#A6E3A1");
+    clearInterval(queryPollTimer);
+    queryPollTimer = 0;
+    queryStreamId = 0;
+    if (!st || st.state === "unknown") {
+        updateStatus("就绪", "#F38BA8");
+        return;
+    }
+
+    var secs = ((Date.now() - queryStartTime) / 1000).toFixed(2);
+    if (st.state === "error") {
+        finishStreamedResults(st.rows);
+        updateStatus("查询失败: " + st.error, "#F38BA8");
+    } else if (st.state === "cancelled") {
+        finishStreamedResults(st.rows);
+        updateStatus("已取消, 保留 " + st.rows + " 行", "#F9E2AF");
+    } else if (!st.columns) {
+        showResults([], 0);
+        updateStatus("影响 " + (st.affected || 0) + " 行", "#A6E3A1");
+    } else {
+        finishStreamedResults(st.rows);
+        updateStatus("查询完成, " + st.rows + " 行 (" + secs + "s)", "#A6E3A1");
+    }
+}
+
+function cancelQuery() {
+    if (!queryStreamId) return;
+    YUI.call("mysql_query_cancel", JSON.stringify({ id: queryStreamId }));
+    updateStatus("正在取消...", "#F9E2AF");
 }
 
 function onExplain() {
@@ -1034,7 +1080,7 @@ function onSave() {
 }
 
 function onExportCsv() {
-    if (!resultRowsAll || resultRowsAll.length === 0) {
+    if (getResultRows().length === 0) {
         updateStatus("没有可导出的查询结果", "#F38BA8");
         return;
     }
@@ -1042,7 +1088,8 @@ function onExportCsv() {
 }
 
 function doExportCsv(path) {
-    if (!resultRowsAll || resultRowsAll.length === 0) {
+    var rows = getResultRows();
+    if (rows.length === 0) {
         updateStatus("没有可导出的查询结果", "#F38BA8");
         return;
     }
@@ -1054,11 +1101,11 @@ function doExportCsv(path) {
         path += ".csv";
     }
 
-    var csv = rowsToCsv(resultRowsAll);
+    var csv = rowsToCsv(rows);
     var content = "\uFEFF" + csv;
     var ok = YUI.writeFile(path, content);
     if (ok) {
-        updateStatus("已导出 " + resultRowsAll.length + " 行到 " + path, "#A6E3A1");
+        updateStatus("已导出 " + rows.length + " 行到 " + path, "#A6E3A1");
     } else {
         updateStatus("导出失败: " + path, "#F38BA8");
     }
@@ -1186,9 +1233,12 @@ function applyDbFilter(filter) {
 
 var RESULT_PAGE_SIZE = 500;
 var resultRowsAll = [];
+// 流式查询的行只在 resultTable 里，整表一页显示（Table 按可见行绘制）
+var resultStreamed = false;
 
 function showResults(rows, rowCount) {
     resultRowsAll = rows || [];
+    resultStreamed = false;
     var total = rowCount != null ? rowCount : resultRowsAll.length;
     var pager = yui.find("resultPager");
     if (pager) {
@@ -1199,6 +1249,29 @@ function showResults(rows, rowCount) {
     renderResultPage(1, RESULT_PAGE_SIZE);
 }
 
+function finishStreamedResults(rowCount) {
+    var pager = yui.find("resultPager");
+    if (pager) {
+        pager.pageSize = Math.max(rowCount, RESULT_PAGE_SIZE);
+        pager.total = rowCount;
+        pager.page = 1;
+    }
+    setResultInfo(rowCount);
+}
+
+// 当前结果的全部行：流式结果从表格读取
+function getResultRows() {
+    if (!resultStreamed) return resultRowsAll;
+    var table = yui.find("resultTable");
+    var rows = table ? table.data : null;
+    return rows || [];
+}
+
+function setResultInfo(count) {
+    var resultInfo = yui.find("resultInfo");
+    if (resultInfo) resultInfo.text = "(" + count + " 行)";
+}
+
 function renderResultPage(page, pageSize) {
     page = page || 1;
     pageSize = pageSize || RESULT_PAGE_SIZE;
@@ -1221,6 +1294,7 @@ function renderResultPage(page, pageSize) {
 }
 
 function onResultPageChange(layerId) {
+    if (resultStreamed) return;
     var pager = yui.find(layerId);
     if (!pager || !pager.text) return;
     try {
@@ -1241,6 +1315,7 @@ function onResultRowClick(layerId) {
 }
 
 function clearEditor() {
+    cancelQuery();
     var editor = yui.find("sqlEditor");
     if (editor) editor.text = "";
     if (activeTab >= 0 && activeTab < tabs.length) tabs[activeTab].sql = "";
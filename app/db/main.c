@@ -14,6 +14,7 @@
 #include "popup_manager.h"
 #include "yaml_cjson.h"
 #include "../lib/jsmodule/js_module.h"
+#include "row_stream.h"
 #include "mysql_fun.h"
 
 #if defined(_WIN32)
@@ -208,6 +209,7 @@ int main(int argc, char* argv[]) {
     backend_run(ui_root);
 
     // 清理资源
+    row_stream_shutdown();  // 取消未完成的流式查询并等待工作线程退出
     js_module_cleanup();  // 清理 JS 引擎
     // destroy_layer(ui_root);  // 暂时注释掉以避免内存问题
     popup_manager_cleanup();
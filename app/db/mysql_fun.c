@@ -1,14 +1,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "cJSON.h"
 #include "event.h"
+#include "layer.h"
+#include "layer_properties.h"
+#include "backend.h"
+#include "row_stream.h"
 #include "mysql_fun.h"
 #include <mysql/mysql.h>
 
 static MYSQL* g_mysql_conn = NULL;
 static int g_mysql_connected = 0;
 
+// 最近一次成功连接的参数，流式查询在工作线程上另开连接时使用
+typedef struct {
+    char host[256];
+    char user[128];
+    char password[128];
+    int port;
+    int ssl;
+} MysqlConnParams;
+
+static MysqlConnParams g_conn_params;
+
+extern Layer* g_layer_root;
+
 static const char* json_get_string(cJSON* json, const char* key) {
     cJSON* item = cJSON_GetObjectItem(json, key);
     return (item && cJSON_IsString(item)) ? item->valuestring : NULL;
@@ -25,6 +43,19 @@ static int json_get_bool(cJSON* json, const char* key, int def) {
     return def;
 }
 
+static cJSON* row_to_json(MYSQL_FIELD* fields, unsigned int num, MYSQL_ROW row) {
+    cJSON* obj = cJSON_CreateObject();
+    if (!obj) return NULL;
+    for (unsigned int j = 0; j < num; j++) {
+        if (row[j]) {
+            cJSON_AddStringToObject(obj, fields[j].name, row[j]);
+        } else {
+            cJSON_AddNullToObject(obj, fields[j].name);
+        }
+    }
+    return obj;
+}
+
 static char* result_to_json(MYSQL_RES* result) {
     if (!result) return strdup("[]");
 
@@ -34,16 +65,7 @@ static char* result_to_json(MYSQL_RES* result) {
     cJSON* arr = cJSON_CreateArray();
     MYSQL_ROW row;
     while ((row = mysql_fetch_row(result))) {
-        unsigned long* lengths = mysql_fetch_lengths(result);
-        cJSON* obj = cJSON_CreateObject();
-        for (unsigned int j = 0; j < num; j++) {
-            if (row[j]) {
-                cJSON_AddStringToObject(obj, fields[j].name, row[j]);
-            } else {
-                cJSON_AddNullToObject(obj, fields[j].name);
-            }
-        }
-        cJSON_AddItemToArray(arr, obj);
+        cJSON_AddItemToArray(arr, row_to_json(fields, num, row));
     }
     mysql_free_result(result);
 
@@ -52,6 +74,21 @@ static char* result_to_json(MYSQL_RES* result) {
     return json_str;
 }
 
+// 根据配置决定是否启用 SSL
+// MariaDB Connector/C 3.4.0+ 默认启用 MYSQL_OPT_SSL_VERIFY_SERVER_CERT
+// 需要显式禁用 SSL 验证才能连接不支持 SSL 的服务器
+static void mysql_apply_ssl(MYSQL* conn, int ssl) {
+    if (!ssl) {
+        // 禁用 SSL
+        my_bool verify_off = 0;
+        mysql_options(conn, MYSQL_OPT_SSL_VERIFY_SERVER_CERT, &verify_off);
+        // 对于 MariaDB 3.4.1+，可以使用环境变量 MARIADB_TLS_DISABLE_PEER_VERIFICATION=1
+    } else {
+        // 启用 SSL
+        mysql_ssl_set(conn, NULL, NULL, NULL, NULL, NULL);
+    }
+}
+
 // ====================== 事件处理器 ======================
 
 static void* handle_mysql_connect(void* data) {
@@ -85,28 +122,20 @@ static void* handle_mysql_connect(void* data) {
         return strdup("{\"success\":false,\"error\":\"mysql_init failed\"}");
     }
 
-    // 根据配置决定是否启用 SSL
-    // MariaDB Connector/C 3.4.0+ 默认启用 MYSQL_OPT_SSL_VERIFY_SERVER_CERT
-    // 需要显式禁用 SSL 验证才能连接不支持 SSL 的服务器
-    if (!ssl) {
-        // 禁用 SSL
-        printf("SSL disabled: disabling SSL verification\n");
-        my_bool verify_off = 0;
-        mysql_options(g_mysql_conn, MYSQL_OPT_SSL_VERIFY_SERVER_CERT, &verify_off);
-        // 对于 MariaDB 3.4.1+，可以使用环境变量 MARIADB_TLS_DISABLE_PEER_VERIFICATION=1
-    } else {
-        // 启用 SSL
-        printf("SSL enabled: calling mysql_ssl_set\n");
-        mysql_ssl_set(g_mysql_conn, NULL, NULL, NULL, NULL, NULL);
-    }
+    mysql_apply_ssl(g_mysql_conn, ssl);
 
     // 连接数据库（db 可以为 NULL）
     MYSQL* ret = mysql_real_connect(g_mysql_conn, host, user, pass, db && db[0] ? db : NULL, port, NULL, 0);
     if (ret) {
-        cJSON_Delete(json);
         g_mysql_connected = 1;
         mysql_set_character_set(g_mysql_conn, "utf8mb4");
+        snprintf(g_conn_params.host, sizeof(g_conn_params.host), "%s", host);
+        snprintf(g_conn_params.user, sizeof(g_conn_params.user), "%s", user);
+        snprintf(g_conn_params.password, sizeof(g_conn_params.password), "%s", pass);
+        g_conn_params.port = port;
+        g_conn_params.ssl = ssl;
         printf("MySQL: Connected to %s:%d db=%s ssl=%s\n", host, port, db ? db : "(none)", ssl ? "true" : "false");
+        cJSON_Delete(json);
         return strdup("{\"success\":true}");
     } else {
         cJSON_Delete(json);
@@ -370,6 +399,295 @@ static void* handle_mysql_db_functions(void* data) {
     return query_name_list(sql);
 }
 
+// ====================== 流式查询 ======================
+// 查询在工作线程上用独立连接执行，mysql_use_result 逐行取，
+// 行直接追加到结果 Table（row_stream），不再整体 store 后拼 JSON 字符串。
+
+typedef struct {
+    int id;
+    MysqlConnParams params;
+    char database[128];
+    char* sql;
+    MYSQL* conn;
+    MYSQL_RES* result;
+    MYSQL_FIELD* fields;
+    unsigned int num_fields;
+    pthread_mutex_t lock;       // 保护 thread_id，取消时在主线程读取
+    unsigned long thread_id;
+    my_ulonglong affected;
+    int has_result;
+} MysqlStream;
+
+static int g_stream_id = 0;
+// 流结束时由 release 记下，供 mysql_query_status 返回
+static long long g_stream_affected = 0;
+static int g_stream_has_result = 0;
+
+static void mysql_stream_close(void* ctx);
+
+// 失败时 row_stream 不会再调 close，这里自己关掉连接并结束线程
+static int mysql_stream_open(void* ctx, char* error, int error_size) {
+    MysqlStream* st = (MysqlStream*)ctx;
+
+    mysql_thread_init();
+    st->conn = mysql_init(NULL);
+    if (!st->conn) {
+        snprintf(error, (size_t)error_size, "mysql_init failed");
+        mysql_stream_close(st);
+        return -1;
+    }
+    mysql_apply_ssl(st->conn, st->params.ssl);
+    if (!mysql_real_connect(st->conn, st->params.host, st->params.user, st->params.password,
+                            st->database[0] ? st->database : NULL, st->params.port, NULL, 0)) {
+        snprintf(error, (size_t)error_size, "%s", mysql_error(st->conn));
+        mysql_stream_close(st);
+        return -1;
+    }
+    mysql_set_character_set(st->conn, "utf8mb4");
+
+    pthread_mutex_lock(&st->lock);
+    st->thread_id = mysql_thread_id(st->conn);
+    pthread_mutex_unlock(&st->lock);
+
+    if (mysql_real_query(st->conn, st->sql, (unsigned long)strlen(st->sql)) != 0) {
+        snprintf(error, (size_t)error_size, "%s", mysql_error(st->conn));
+        mysql_stream_close(st);
+        return -1;
+    }
+    st->result = mysql_use_result(st->conn);
+    if (!st->result) {
+        if (mysql_field_count(st->conn) != 0) {
+            snprintf(error, (size_t)error_size, "%s", mysql_error(st->conn));
+            mysql_stream_close(st);
+            return -1;
+        }
+        // INSERT/UPDATE 等没有结果集
+        st->affected = mysql_affected_rows(st->conn);
+        return 0;
+    }
+    st->has_result = 1;
+    st->num_fields = mysql_num_fields(st->result);
+    st->fields = mysql_fetch_fields(st->result);
+    return 0;
+}
+
+static int mysql_stream_fetch(void* ctx, cJSON** out, char* error, int error_size) {
+    MysqlStream* st = (MysqlStream*)ctx;
+    MYSQL_ROW row;
+
+    if (!st->result) return 0;
+    row = mysql_fetch_row(st->result);
+    if (!row) {
+        if (mysql_errno(st->conn) != 0) {
+            snprintf(error, (size_t)error_size, "%s", mysql_error(st->conn));
+            return -1;
+        }
+        return 0;
+    }
+    *out = row_to_json(st->fields, st->num_fields, row);
+    if (!*out) {
+        snprintf(error, (size_t)error_size, "out of memory");
+        return -1;
+    }
+    return 1;
+}
+
+static void mysql_stream_close(void* ctx) {
+    MysqlStream* st = (MysqlStream*)ctx;
+
+    if (st->result) {
+        mysql_free_result(st->result);
+        st->result = NULL;
+    }
+    if (st->conn) {
+        mysql_close(st->conn);
+        st->conn = NULL;
+    }
+    pthread_mutex_lock(&st->lock);
+    st->thread_id = 0;
+    pthread_mutex_unlock(&st->lock);
+    mysql_thread_end();
+}
+
+// 取消用的 KILL QUERY 在分离线程上执行：连接最多要等 3 秒，不能卡住主线程。
+// 线程持有参数副本，流被 release 之后仍可安全运行
+typedef struct {
+    MysqlConnParams params;
+    unsigned long thread_id;
+} MysqlKill;
+
+static void* mysql_kill_worker(void* arg) {
+    MysqlKill* kill = (MysqlKill*)arg;
+    unsigned int timeout = 3;
+    char sql[64];
+    MYSQL* killer;
+
+    mysql_thread_init();
+    killer = mysql_init(NULL);
+    if (killer) {
+        mysql_options(killer, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+        mysql_apply_ssl(killer, kill->params.ssl);
+        if (mysql_real_connect(killer, kill->params.host, kill->params.user, kill->params.password,
+                               NULL, kill->params.port, NULL, 0)) {
+            snprintf(sql, sizeof(sql), "KILL QUERY %lu", kill->thread_id);
+            if (mysql_query(killer, sql) != 0) {
+                printf("MySQL: cancel failed: %s\n", mysql_error(killer));
+            }
+        } else {
+            printf("MySQL: cancel connect failed: %s\n", mysql_error(killer));
+        }
+        mysql_close(killer);
+    }
+    free(kill);
+    mysql_thread_end();
+    return NULL;
+}
+
+// 取消：另开短连接 KILL QUERY，打断阻塞在服务器上的取行；立即返回
+static void mysql_stream_interrupt(void* ctx) {
+    MysqlStream* st = (MysqlStream*)ctx;
+    MysqlKill* kill;
+    pthread_t thread;
+    unsigned long thread_id;
+
+    pthread_mutex_lock(&st->lock);
+    thread_id = st->thread_id;
+    pthread_mutex_unlock(&st->lock);
+    if (thread_id == 0) return;   // 还在连接或已结束，行间的取消检查足够
+
+    kill = (MysqlKill*)malloc(sizeof(MysqlKill));
+    if (!kill) return;
+    kill->params = st->params;
+    kill->thread_id = thread_id;
+    if (pthread_create(&thread, NULL, mysql_kill_worker, kill) != 0) {
+        printf("MySQL: cancel thread failed\n");
+        free(kill);
+        return;
+    }
+    pthread_detach(thread);
+}
+
+static void mysql_stream_release(void* ctx) {
+    MysqlStream* st = (MysqlStream*)ctx;
+
+    // 被新查询替换掉的旧流不覆盖当前结果
+    if (st->id == g_stream_id) {
+        g_stream_affected = (long long)st->affected;
+        g_stream_has_result = st->has_result;
+    }
+    pthread_mutex_destroy(&st->lock);
+    free(st->sql);
+    free(st);
+}
+
+static const RowStreamSource g_mysql_stream_source = {
+    mysql_stream_open,
+    mysql_stream_fetch,
+    mysql_stream_close,
+    mysql_stream_interrupt,
+    mysql_stream_release,
+};
+
+// 当前库名：流式连接要落在与主连接相同的库上
+static void mysql_current_database(char* out, size_t size) {
+    out[0] = '\0';
+    if (mysql_query(g_mysql_conn, "SELECT DATABASE()") != 0) return;
+    MYSQL_RES* result = mysql_store_result(g_mysql_conn);
+    if (!result) return;
+    MYSQL_ROW row = mysql_fetch_row(result);
+    if (row && row[0]) snprintf(out, size, "%s", row[0]);
+    mysql_free_result(result);
+}
+
+// 参数 {sql, target, batch}：清空 target 表格后开始流式查询，返回 {"id":n}
+static void* handle_mysql_query_start(void* data) {
+    const char* json_str = (const char*)data;
+    if (!json_str) return strdup("{\"error\":\"No args\"}");
+    if (!g_mysql_conn || !g_mysql_connected) return strdup("{\"error\":\"Not connected\"}");
+
+    cJSON* json = cJSON_Parse(json_str);
+    if (!json) return strdup("{\"error\":\"Invalid JSON\"}");
+
+    const char* sql = json_get_string(json, "sql");
+    const char* target_id = json_get_string(json, "target");
+    int batch = json_get_int(json, "batch", 0);
+    if (!sql) { cJSON_Delete(json); return strdup("{\"error\":\"Missing sql\"}"); }
+
+    MysqlStream* st = (MysqlStream*)calloc(1, sizeof(MysqlStream));
+    if (!st || !(st->sql = strdup(sql))) {
+        free(st);
+        cJSON_Delete(json);
+        return strdup("{\"error\":\"Out of memory\"}");
+    }
+    st->params = g_conn_params;
+    pthread_mutex_init(&st->lock, NULL);
+    mysql_current_database(st->database, sizeof(st->database));
+
+    Layer* target = target_id ? find_layer_by_id(g_layer_root, target_id) : NULL;
+    cJSON_Delete(json);
+
+    // 同一时间只保留一个流式查询
+    if (g_stream_id > 0) {
+        row_stream_close(g_stream_id);
+        g_stream_id = 0;
+    }
+    if (target) {
+        cJSON* empty = cJSON_CreateArray();
+        if (empty && layer_set_data(target, empty) != 2) cJSON_Delete(empty);
+    }
+    g_stream_affected = 0;
+    g_stream_has_result = 0;
+
+    int id = row_stream_start(target, &g_mysql_stream_source, st, batch);
+    if (id < 0) {
+        mysql_stream_release(st);
+        return strdup("{\"error\":\"Failed to start query worker\"}");
+    }
+    st->id = id;
+    g_stream_id = id;
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), "{\"id\":%d}", id);
+    return strdup(buf);
+}
+
+// 参数 {id}：返回 {state, rows, columns, affected, error}
+static void* handle_mysql_query_status(void* data) {
+    static const char* names[] = { "running", "done", "error", "cancelled" };
+    const char* json_str = (const char*)data;
+    cJSON* json = json_str ? cJSON_Parse(json_str) : NULL;
+    int id = json ? json_get_int(json, "id", g_stream_id) : g_stream_id;
+    char error[256];
+    int rows = 0;
+
+    if (json) cJSON_Delete(json);
+    if (id != g_stream_id) return strdup("{\"state\":\"unknown\"}");
+
+    int state = row_stream_status(id, &rows, error, (int)sizeof(error));
+    if (state < 0) return strdup("{\"state\":\"unknown\"}");
+
+    cJSON* out = cJSON_CreateObject();
+    cJSON_AddStringToObject(out, "state", names[state]);
+    cJSON_AddNumberToObject(out, "rows", rows);
+    if (state != ROW_STREAM_RUNNING) {
+        cJSON_AddBoolToObject(out, "columns", g_stream_has_result);
+        cJSON_AddNumberToObject(out, "affected", (double)g_stream_affected);
+    }
+    if (state == ROW_STREAM_ERROR) cJSON_AddStringToObject(out, "error", error);
+
+    char* json_out = cJSON_PrintUnformatted(out);
+    cJSON_Delete(out);
+    return json_out;
+}
+
+static void* handle_mysql_query_cancel(void* data) {
+    (void)data;
+    if (g_stream_id <= 0 || row_stream_cancel(g_stream_id) != 0) {
+        return strdup("{\"success\":false}");
+    }
+    return strdup("{\"success\":true}");
+}
+
 // ====================== 注册 ======================
 
 void register_mysql_handlers(void) {
@@ -385,5 +703,12 @@ void register_mysql_handlers(void) {
     register_event_handler("mysql_db_views",     handle_mysql_db_views);
     register_event_handler("mysql_db_procedures", handle_mysql_db_procedures);
     register_event_handler("mysql_db_functions",  handle_mysql_db_functions);
-    printf("MySQL: Registered %d event handlers\n", 12);
+    register_event_handler("mysql_query_start",   handle_mysql_query_start);
+    register_event_handler("mysql_query_status",  handle_mysql_query_status);
+    register_event_handler("mysql_query_cancel",  handle_mysql_query_cancel);
+    printf("MySQL: Registered %d event handlers\n", 15);
+
+    // 流式查询的批次由主循环送达；工作线程到批后 backend_wake
+    backend_register_update_callback(row_stream_tick);
+    backend_set_update_deadline(row_stream_tick, row_stream_deadline);
 }
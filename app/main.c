@@ -12,6 +12,7 @@
 #include "backend.h"
 #include "popup_manager.h"
 #include "yaml_cjson.h"
+#include "ui_blob.h"
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -95,8 +96,19 @@ int main(int argc, char* argv[]) {
     register_event_handler("@hello", hello_world);
     register_event_handler("@helloTouch", hello_touch);
 
-    cJSON* root_json=parse_yaml_json_file(json_path);
-    Layer* ui_root = layer_create_from_json(root_json,NULL);
+    cJSON* root_json=NULL;
+    Layer* ui_root=NULL;
+    if(ui_blob_is_blob_file(json_path)){
+        // ui-compile 预编译的二进制 UI，mmap 后直接建树
+        ui_root = ui_blob_load_file(json_path,NULL);
+    }else{
+        root_json=parse_yaml_json_file(json_path);
+        ui_root = layer_create_from_json(root_json,NULL);
+    }
+    if(ui_root==NULL){
+        printf("load ui failed %s\n",json_path);
+        return -1;
+    }
 
     
     if (ui_root->rect.w <= 0 || ui_root->rect.h <= 0) {
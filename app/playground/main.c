@@ -15,6 +15,7 @@
 #include "../lib/jsmodule/js_module.h"
 #include "yaml_cjson.h"
 #include "log.h"
+#include "perf/perf.h"
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -79,6 +80,7 @@ int main(int argc, char* argv[]) {
     const char* auto_env;
     const char* frames_env;
     const char* headless_env;
+    const char* trace_path = getenv("YUI_PERF_TRACE");
     int i;
 
     auto_env = getenv("YUI_AUTO_TEST");
@@ -113,6 +115,10 @@ int main(int argc, char* argv[]) {
             if (n > 0) auto_frames = n;
             continue;
         }
+        if (strncmp(argv[i], "--perf-trace=", 13) == 0) {
+            trace_path = argv[i] + 13;
+            continue;
+        }
         if (argv[i][0] != '-') {
             json_path = argv[i];
         }
@@ -128,6 +134,11 @@ int main(int argc, char* argv[]) {
         backend_set_headless(0);
     }
 
+    /* --perf-trace=out.json：记录每轮主循环的阶段耗时，退出时导出 trace */
+    if (trace_path && trace_path[0]) {
+        perf_enable(1);
+    }
+
     backend_init();
     popup_manager_init();
 
@@ -249,6 +260,19 @@ int main(int argc, char* argv[]) {
 
     backend_run(ui_root);
 
+    if (trace_path && trace_path[0]) {
+        int count = perf_export_trace(trace_path);
+        printf("PERF_TRACE: %d loops -> %s\n", count, trace_path);
+        for (i = 0; i <= PERF_SERIES_LOOP; i++) {
+            PerfPercentiles p;
+            if (perf_get_percentiles(i, &p) == 0) {
+                printf("PERF_TRACE: %-8s n=%llu p50=%.2fms p95=%.2fms p99=%.2fms max=%.2fms\n",
+                       perf_phase_name(i), (unsigned long long)p.count,
+                       p.p50_ms, p.p95_ms, p.p99_ms, p.max_ms);
+            }
+        }
+    }
+
     // 清理资源：先走 JS onUnload，再释放引擎，最后销毁 C 层树
     js_module_shutdown();
     js_module_cleanup();
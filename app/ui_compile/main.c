@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "layer.h"
+#include "ui_blob.h"
+#include "component_registry.h"
+#include "yaml_cjson.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    extern int __argc;
+    extern char** __argv;
+    return main(__argc, __argv);
+}
+#endif
+
+// 离线 UI 编译器：UI JSON/YAML (+ 主题 JSON) -> .yuib
+//   ya -r ui-compile -- app/app.json -t app/light-theme.json -o app/app.yuib
+
+static int is_yaml_file(const char* path) {
+    const char* ext = strrchr(path, '.');
+    return ext && (strcmp(ext, ".yaml") == 0 || strcmp(ext, ".yml") == 0);
+}
+
+static cJSON* load_ui(const char* path) {
+    if (!is_yaml_file(path)) {
+        return parse_json((char*)path);
+    }
+    char* error = NULL;
+    cJSON* json = yaml_file2cjson(path, &error);
+    if (!json && error) {
+        fprintf(stderr, "yaml error: %s\n", error);
+    }
+    free(error);
+    return json;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s <ui.json|ui.yaml> [-t theme.json] [-o out.yuib]\n", name);
+}
+
+int main(int argc, char* argv[]) {
+    const char* input = NULL;
+    const char* theme_path = NULL;
+    const char* output = NULL;
+    char default_output[1024];
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            theme_path = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] != '-' && !input) {
+            input = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!input) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!output) {
+        // 默认与输入同名，扩展名换成 .yuib
+        snprintf(default_output, sizeof(default_output), "%s", input);
+        char* ext = strrchr(default_output, '.');
+        if (ext && !strchr(ext, '/') && !strchr(ext, '\\')) {
+            *ext = '\0';
+        }
+        strncat(default_output, UI_BLOB_EXT, sizeof(default_output) - strlen(default_output) - 1);
+        output = default_output;
+    }
+
+    // 普通节点的判定依赖组件注册表
+    yui_components_register_builtin();
+
+    cJSON* ui = load_ui(input);
+    if (!ui) {
+        fprintf(stderr, "cannot load %s\n", input);
+        return 1;
+    }
+    cJSON* theme = NULL;
+    if (theme_path) {
+        theme = parse_json((char*)theme_path);
+        if (!theme) {
+            fprintf(stderr, "cannot load theme %s\n", theme_path);
+            cJSON_Delete(ui);
+            return 1;
+        }
+    }
+
+    int ret = ui_blob_write_file(ui, theme, output);
+    if (ret == 0) {
+        printf("wrote %s\n", output);
+    }
+    cJSON_Delete(theme);
+    cJSON_Delete(ui);
+    return ret == 0 ? 0 : 1;
+}
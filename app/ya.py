@@ -28,6 +28,17 @@ if is_host_plat():
         add_run()
     )
 
+    # 离线 UI 编译器：UI JSON/YAML + 主题 -> .yuib，main 可直接加载
+    target("ui-compile") 
+    (
+        add_deps("yui","cjson","yaml2json"),
+        add_rules("mode.debug", "mode.release"),
+        set_kind("binary"),
+        add_flags(),
+        add_files("ui_compile/main.c"),
+        add_run()
+    )
+
 
 if is_host_plat():
     # 嵌入式平台跳过依赖 jsmodule-quickjs 的 demo（jsmodule-quickjs 需 POSIX socket/lwip，由 ESP-IDF 工程编译）
@@ -23,16 +23,16 @@ static JSValue game_entity_to_js(JSContext* ctx, GameEntity* e)
     JS_SetPropertyStr(ctx, obj, "id", JS_NewString(ctx, e->id));
     JS_SetPropertyStr(ctx, obj, "tag", JS_NewString(ctx, e->tag));
     JS_SetPropertyStr(ctx, obj, "script", JS_NewString(ctx, e->script));
-    JS_SetPropertyStr(ctx, obj, "x", JS_NewFloat64(ctx, e->x));
-    JS_SetPropertyStr(ctx, obj, "y", JS_NewFloat64(ctx, e->y));
+    JS_SetPropertyStr(ctx, obj, "x", JS_NewFloat64(ctx, GAME_X(e)));
+    JS_SetPropertyStr(ctx, obj, "y", JS_NewFloat64(ctx, GAME_Y(e)));
     JS_SetPropertyStr(ctx, obj, "z", JS_NewFloat64(ctx, e->z));
-    JS_SetPropertyStr(ctx, obj, "vx", JS_NewFloat64(ctx, e->vx));
-    JS_SetPropertyStr(ctx, obj, "vy", JS_NewFloat64(ctx, e->vy));
+    JS_SetPropertyStr(ctx, obj, "vx", JS_NewFloat64(ctx, GAME_VX(e)));
+    JS_SetPropertyStr(ctx, obj, "vy", JS_NewFloat64(ctx, GAME_VY(e)));
     JS_SetPropertyStr(ctx, obj, "w", JS_NewFloat64(ctx, e->w));
     JS_SetPropertyStr(ctx, obj, "h", JS_NewFloat64(ctx, e->h));
-    JS_SetPropertyStr(ctx, obj, "grounded", JS_NewBool(e->grounded));
-    JS_SetPropertyStr(ctx, obj, "solid", JS_NewBool(e->solid));
-    JS_SetPropertyStr(ctx, obj, "trigger", JS_NewBool(e->trigger));
+    JS_SetPropertyStr(ctx, obj, "grounded", JS_NewBool(GAME_GROUNDED(e)));
+    JS_SetPropertyStr(ctx, obj, "solid", JS_NewBool(GAME_SOLID(e)));
+    JS_SetPropertyStr(ctx, obj, "trigger", JS_NewBool(GAME_TRIGGER(e)));
     JS_SetPropertyStr(ctx, obj, "__ptr", JS_NewInt64(ctx, (int64_t)(uintptr_t)e));
     return obj;
 }
@@ -65,15 +65,15 @@ static void game_entity_apply_js(JSContext* ctx, GameEntity* e, JSValue val)
         return;
     }
     v = JS_GetPropertyStr(ctx, val, "x");
-    if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) e->x = (float)d;
+    if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) GAME_X(e) = (float)d;
     v = JS_GetPropertyStr(ctx, val, "y");
-    if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) e->y = (float)d;
+    if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) GAME_Y(e) = (float)d;
     v = JS_GetPropertyStr(ctx, val, "z");
     if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) e->z = (float)d;
     v = JS_GetPropertyStr(ctx, val, "vx");
-    if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) e->vx = (float)d;
+    if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) GAME_VX(e) = (float)d;
     v = JS_GetPropertyStr(ctx, val, "vy");
-    if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) e->vy = (float)d;
+    if (JS_IsNumber(ctx, v) && JS_ToNumber(ctx, &d, v) == 0) GAME_VY(e) = (float)d;
     /* Do not write w/h: scripts rarely resize, and mid-reload stale apply
      * used to clobber platforms with the player's 32x48. */
 }
@@ -110,7 +110,7 @@ static void js_game_script_update(GameEntity* entity, float dt)
         printf("JS(Game): script %s error: ", entity->script);
         JS_PrintValueF(g_game_ctx, exc, JS_DUMP_LONG);
         printf("\n");
-    } else if (game_scene_generation() == scene_gen && entity->alive) {
+    } else if (game_scene_generation() == scene_gen && GAME_ALIVE(entity)) {
         /* Scene reload mid-script: do not apply stale JS state onto reused slots. */
         game_entity_apply_js(g_game_ctx, entity, ent);
     }
@@ -390,7 +390,8 @@ static void js_game_on_trigger(GameEntity* a, GameEntity* b, GameTriggerPhase ph
 static JSValue js_game_find_all_by_tag(JSContext* ctx, JSValue* this_val, int argc, JSValue* argv)
 {
     const char* tag;
-    GameEntity* list[GAME_MAX_ENTITIES];
+    GameEntity** list;
+    int max_out = 0;
     int n;
     int i;
     JSValue arr;
@@ -400,11 +401,14 @@ static JSValue js_game_find_all_by_tag(JSContext* ctx, JSValue* this_val, int ar
         return JS_NewArray(ctx, 0);
     }
     tag = JS_ToCString(ctx, argv[0], &cstr);
-    n = game_find_all_by_tag(tag, list, GAME_MAX_ENTITIES);
+    game_entities(&max_out);
+    list = max_out > 0 ? (GameEntity**)malloc((size_t)max_out * sizeof(GameEntity*)) : NULL;
+    n = list ? game_find_all_by_tag(tag, list, max_out) : 0;
     arr = JS_NewArray(ctx, 0);
     for (i = 0; i < n; i++) {
         JS_SetPropertyUint32(ctx, arr, (uint32_t)i, game_entity_to_js(ctx, list[i]));
     }
+    free(list);
     return arr;
 }
 
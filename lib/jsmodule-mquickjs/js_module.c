@@ -3,6 +3,7 @@
 
 #include "mquickjs.h"
 #include "../../src/ytype.h"
+#include "../../src/damage.h"
 
 #include "event.h"
 #define CONFIG_CLASS_SOCKET
@@ -35,6 +36,8 @@ static void check_timers(void);
 void js_module_pump_timers(void);
 
 extern void backend_register_update_callback(void (*callback)(void));
+extern void backend_set_update_deadline(void (*callback)(void), int (*deadline)(void));
+static int js_module_timer_deadline(void);
 
 
 extern const JSSTDLibraryDef js_yuistdlib;
@@ -83,6 +86,7 @@ int js_module_init(void)
 
     /* 驱动 setTimeout/clearTimeout：注册到 backend 每帧 update 回调 */
     backend_register_update_callback(js_module_pump_timers);
+    backend_set_update_deadline(js_module_pump_timers, js_module_timer_deadline);
 
     printf("JS: JavaScript engine initialized\n");
     return 0;
@@ -580,7 +584,10 @@ int js_module_call_event(const char* event_name, Layer* layer)
 static void check_timers(void)
 {
     if (!g_js_ctx) return;
-    js_run_timers(g_js_ctx);
+    /* 回调可能以任意方式修改图层（含不标脏的直接写字段），整屏重绘 */
+    if (js_run_timers(g_js_ctx) > 0) {
+        damage_add_full();
+    }
 }
 
 // 供 UI 主循环周期性调用，驱动 setTimeout/setInterval
@@ -589,6 +596,12 @@ void js_module_pump_timers(void)
     check_timers();
 }
 
+// 主循环据此决定可以休眠多久
+static int js_module_timer_deadline(void)
+{
+    return g_js_ctx ? js_next_timer_delay(g_js_ctx) : -1;
+}
+
 void* js_module_get_context(void) {
     return g_js_ctx;
 }
@@ -27,9 +27,11 @@
 #include "layer.h"
 #include "layout.h"
 #include "layer_lifecycle.h"
+#include "layer_update.h"
 #include "cJSON.h"
 #include "../../src/render.h"
 #include "../../src/backend.h"
+#include "../../src/damage.h"
 
 #ifndef STDLIB_BUILD
 #include "../../src/perf/perf.h"
@@ -426,6 +428,7 @@ static JSValue js_set_bg_color(JSContext *ctx, JSValue *this_val, int argc, JSVa
                 layer->bg_color.g = (hex_to_int(color_hex[3]) * 16 + hex_to_int(color_hex[4]));
                 layer->bg_color.b = (hex_to_int(color_hex[5]) * 16 + hex_to_int(color_hex[6]));
                 layer->bg_color.a = 255;
+                mark_layer_dirty(layer, DIRTY_COLOR);
                 printf("YUI: Set bg_color for layer '%s': %s\n", layer_id, color_hex);
             }
         }
@@ -610,6 +613,7 @@ static JSValue js_render_from_json(JSContext *ctx, JSValue *this_val, int argc,
         parent_layer->children[0] = new_layer;
         parent_layer->child_count = 1;
     }
+    mark_layer_dirty(parent_layer, DIRTY_CHILDREN | DIRTY_LAYOUT);
 
     layout_layer(parent_layer);
     load_all_fonts(new_layer);
@@ -1309,6 +1313,7 @@ static JSValue js_yui_inspect_enable(JSContext *ctx, JSValue *this_val, int argc
     // 启用全局 inspect 模式
     extern int yui_inspect_mode_enabled;
     yui_inspect_mode_enabled = 1;
+    damage_add_full();
     printf("YUI Inspect: Enabled global inspect mode\n");
     return JS_NewBool( 1);
 }
@@ -1319,6 +1324,7 @@ static JSValue js_yui_inspect_disable(JSContext *ctx, JSValue *this_val, int arg
     // 禁用全局 inspect 模式
     extern int yui_inspect_mode_enabled;
     yui_inspect_mode_enabled = 0;
+    damage_add_full();
     printf("YUI Inspect: Disabled global inspect mode\n");
     return JS_NewBool( 1);
 }
@@ -1356,6 +1362,7 @@ static JSValue js_yui_inspect_setLayer(JSContext *ctx, JSValue *this_val, int ar
         Layer* layer = find_layer_by_id(g_layer_root, layer_id);
         if (layer) {
             layer->inspect_enabled = enabled;
+            mark_layer_dirty(layer, DIRTY_STYLE);
             printf("YUI Inspect: Set layer '%s' inspect enabled = %d\n", layer_id, enabled);
             return JS_NewBool( 1);
         } else {
@@ -1395,6 +1402,7 @@ static JSValue js_yui_inspect_setShowBounds(JSContext *ctx, JSValue *this_val, i
     
     extern int yui_inspect_show_bounds;
     yui_inspect_show_bounds = show_bounds;
+    damage_add_full();
     printf("YUI Inspect: Set show bounds = %d\n", show_bounds);
     return JS_NewBool( 1);
 }
@@ -1427,6 +1435,7 @@ static JSValue js_yui_inspect_setShowInfo(JSContext *ctx, JSValue *this_val, int
     
     extern int yui_inspect_show_info;
     yui_inspect_show_info = show_info;
+    damage_add_full();
     printf("YUI Inspect: Set show info = %d\n", show_info);
     return JS_NewBool( 1);
 }
@@ -1527,6 +1536,11 @@ static JSValue js_yui_perf_getFrameStats(JSContext* ctx, JSValue* this_val, int
     JS_SetPropertyStr(ctx, obj, "frameMs", JS_NewFloat64(ctx, stats ? (double)stats->frame_ns / 1000000.0 : 0.0));
     JS_SetPropertyStr(ctx, obj, "renderMs", JS_NewFloat64(ctx, stats ? (double)stats->render_tree_ns / 1000000.0 : 0.0));
     JS_SetPropertyStr(ctx, obj, "layerCount", JS_NewInt32(ctx, stats ? (int)stats->layers_rendered : 0));
+    JS_SetPropertyStr(ctx, obj, "pixelsRedrawn", JS_NewInt64(ctx, stats ? (int64_t)stats->pixels_redrawn : 0));
+    JS_SetPropertyStr(ctx, obj, "skippedFrames", JS_NewInt64(ctx, stats ? (int64_t)stats->frames_skipped : 0));
+    JS_SetPropertyStr(ctx, obj, "wakeReason", JS_NewString(ctx, perf_wake_reason_name(stats ? stats->wake_reason : PERF_WAKE_NONE)));
+    JS_SetPropertyStr(ctx, obj, "waitMs", JS_NewInt32(ctx, stats ? (int)stats->wait_ms : 0));
+    JS_SetPropertyStr(ctx, obj, "textRasterized", JS_NewInt32(ctx, stats ? (int)stats->text_rasterized : 0));
     return obj;
 }
 
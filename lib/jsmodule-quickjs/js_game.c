@@ -9,108 +9,323 @@
 #include <stdint.h>
 
 static JSContext* g_game_ctx;
+static JSClassID js_game_entity_class_id;
 
-static JSValue game_entity_to_js(JSContext* ctx, GameEntity* e)
-{
+/* One wrapper per entity slot, kept for the entity's lifetime together with
+ * its script function, resolved when the wrapper is created or the script
+ * changes; dropped by the release hook. */
+typedef struct JsGameEntityRef {
+    GameEntity* entity;
     JSValue obj;
+    JSValue fn;
+} JsGameEntityRef;
+
+static JsGameEntityRef* g_entity_refs;
+static int g_entity_ref_cap;
+
+enum {
+    JS_GAME_FIELD_X,
+    JS_GAME_FIELD_Y,
+    JS_GAME_FIELD_Z,
+    JS_GAME_FIELD_VX,
+    JS_GAME_FIELD_VY,
+    JS_GAME_FIELD_W,
+    JS_GAME_FIELD_H,
+    JS_GAME_FIELD_GROUNDED,
+    JS_GAME_FIELD_SOLID,
+    JS_GAME_FIELD_TRIGGER,
+    JS_GAME_FIELD_ALIVE,
+    JS_GAME_FIELD_ID,
+    JS_GAME_FIELD_TAG,
+    JS_GAME_FIELD_SCRIPT
+};
+
+static float* js_game_entity_float(GameEntity* e, int field)
+{
+    switch (field) {
+    case JS_GAME_FIELD_X: return &GAME_X(e);
+    case JS_GAME_FIELD_Y: return &GAME_Y(e);
+    case JS_GAME_FIELD_Z: return &e->z;
+    case JS_GAME_FIELD_VX: return &GAME_VX(e);
+    case JS_GAME_FIELD_VY: return &GAME_VY(e);
+    case JS_GAME_FIELD_W: return &e->w;
+    case JS_GAME_FIELD_H: return &e->h;
+    default: return NULL;
+    }
+}
+
+static JSValue js_game_entity_get(JSContext* ctx, JSValueConst this_val, int magic)
+{
+    GameEntity* e = (GameEntity*)JS_GetOpaque(this_val, js_game_entity_class_id);
+    float* f;
+    if (magic == JS_GAME_FIELD_ALIVE) {
+        return JS_NewBool(ctx, e && GAME_ALIVE(e));
+    }
+    /* Detached wrapper (entity destroyed or pooled) */
     if (!e) {
-        return JS_NULL;
+        return JS_UNDEFINED;
+    }
+    f = js_game_entity_float(e, magic);
+    if (f) {
+        return JS_NewFloat64(ctx, *f);
+    }
+    switch (magic) {
+    case JS_GAME_FIELD_GROUNDED: return JS_NewBool(ctx, GAME_GROUNDED(e));
+    case JS_GAME_FIELD_SOLID: return JS_NewBool(ctx, GAME_SOLID(e));
+    case JS_GAME_FIELD_TRIGGER: return JS_NewBool(ctx, GAME_TRIGGER(e));
+    case JS_GAME_FIELD_ID: return JS_NewString(ctx, e->id);
+    case JS_GAME_FIELD_TAG: return JS_NewString(ctx, e->tag);
+    case JS_GAME_FIELD_SCRIPT: return JS_NewString(ctx, e->script);
+    default: return JS_UNDEFINED;
+    }
+}
+
+static JSValue js_game_entity_set(JSContext* ctx, JSValueConst this_val, JSValueConst val, int magic)
+{
+    GameEntity* e = (GameEntity*)JS_GetOpaque(this_val, js_game_entity_class_id);
+    float* f;
+    double d;
+    if (!e) {
+        return JS_UNDEFINED;
+    }
+    f = js_game_entity_float(e, magic);
+    if (f && JS_IsNumber(val) && JS_ToFloat64(ctx, &d, val) == 0) {
+        *f = (float)d;
+    }
+    return JS_UNDEFINED;
+}
+
+/* JSON.stringify(entity): accessors live on the prototype, so snapshot them. */
+static JSValue js_game_entity_to_json(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    static const char* names[] = {"x", "y", "z", "vx", "vy", "w", "h", "grounded",
+                                  "solid", "trigger", "alive", "id", "tag", "script"};
+    JSValue obj = JS_NewObject(ctx);
+    int i;
+    (void)argc; (void)argv;
+    for (i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        JS_SetPropertyStr(ctx, obj, names[i], js_game_entity_get(ctx, this_val, i));
     }
-    obj = JS_NewObject(ctx);
-    JS_SetPropertyStr(ctx, obj, "id", JS_NewString(ctx, e->id));
-    JS_SetPropertyStr(ctx, obj, "tag", JS_NewString(ctx, e->tag));
-    JS_SetPropertyStr(ctx, obj, "script", JS_NewString(ctx, e->script));
-    JS_SetPropertyStr(ctx, obj, "x", JS_NewFloat64(ctx, e->x));
-    JS_SetPropertyStr(ctx, obj, "y", JS_NewFloat64(ctx, e->y));
-    JS_SetPropertyStr(ctx, obj, "z", JS_NewFloat64(ctx, e->z));
-    JS_SetPropertyStr(ctx, obj, "vx", JS_NewFloat64(ctx, e->vx));
-    JS_SetPropertyStr(ctx, obj, "vy", JS_NewFloat64(ctx, e->vy));
-    JS_SetPropertyStr(ctx, obj, "w", JS_NewFloat64(ctx, e->w));
-    JS_SetPropertyStr(ctx, obj, "h", JS_NewFloat64(ctx, e->h));
-    JS_SetPropertyStr(ctx, obj, "grounded", JS_NewBool(ctx, e->grounded));
-    JS_SetPropertyStr(ctx, obj, "solid", JS_NewBool(ctx, e->solid));
-    JS_SetPropertyStr(ctx, obj, "trigger", JS_NewBool(ctx, e->trigger));
-    JS_SetPropertyStr(ctx, obj, "__ptr", JS_NewInt64(ctx, (int64_t)(uintptr_t)e));
     return obj;
 }
 
-static GameEntity* game_entity_from_js(JSContext* ctx, JSValueConst val)
+static const JSCFunctionListEntry js_game_entity_proto_funcs[] = {
+    JS_CGETSET_MAGIC_DEF("x", js_game_entity_get, js_game_entity_set, JS_GAME_FIELD_X),
+    JS_CGETSET_MAGIC_DEF("y", js_game_entity_get, js_game_entity_set, JS_GAME_FIELD_Y),
+    JS_CGETSET_MAGIC_DEF("z", js_game_entity_get, js_game_entity_set, JS_GAME_FIELD_Z),
+    JS_CGETSET_MAGIC_DEF("vx", js_game_entity_get, js_game_entity_set, JS_GAME_FIELD_VX),
+    JS_CGETSET_MAGIC_DEF("vy", js_game_entity_get, js_game_entity_set, JS_GAME_FIELD_VY),
+    JS_CGETSET_MAGIC_DEF("w", js_game_entity_get, js_game_entity_set, JS_GAME_FIELD_W),
+    JS_CGETSET_MAGIC_DEF("h", js_game_entity_get, js_game_entity_set, JS_GAME_FIELD_H),
+    JS_CGETSET_MAGIC_DEF("grounded", js_game_entity_get, NULL, JS_GAME_FIELD_GROUNDED),
+    JS_CGETSET_MAGIC_DEF("solid", js_game_entity_get, NULL, JS_GAME_FIELD_SOLID),
+    JS_CGETSET_MAGIC_DEF("trigger", js_game_entity_get, NULL, JS_GAME_FIELD_TRIGGER),
+    JS_CGETSET_MAGIC_DEF("alive", js_game_entity_get, NULL, JS_GAME_FIELD_ALIVE),
+    JS_CGETSET_MAGIC_DEF("id", js_game_entity_get, NULL, JS_GAME_FIELD_ID),
+    JS_CGETSET_MAGIC_DEF("tag", js_game_entity_get, NULL, JS_GAME_FIELD_TAG),
+    JS_CGETSET_MAGIC_DEF("script", js_game_entity_get, NULL, JS_GAME_FIELD_SCRIPT),
+    JS_CFUNC_DEF("toJSON", 0, js_game_entity_to_json),
+};
+
+static JSClassDef js_game_entity_class = {
+    "GameEntity",
+    .finalizer = NULL,
+};
+
+static void js_game_entity_ref_reset(JSContext* ctx, JsGameEntityRef* ref)
+{
+    if (!ref->entity) {
+        return;
+    }
+    /* Scripts may still hold the wrapper: make it read as detached. */
+    JS_SetOpaque(ref->obj, NULL);
+    JS_FreeValue(ctx, ref->obj);
+    JS_FreeValue(ctx, ref->fn);
+    ref->entity = NULL;
+    ref->obj = JS_UNDEFINED;
+    ref->fn = JS_UNDEFINED;
+}
+
+static void js_game_entity_refs_clear(JSContext* ctx)
 {
-    JSValue ptr_val;
-    int64_t ptr = 0;
-    if (!JS_IsObject(val)) {
-        return NULL;
+    int i;
+    for (i = 0; i < g_entity_ref_cap; i++) {
+        js_game_entity_ref_reset(ctx, &g_entity_refs[i]);
     }
-    ptr_val = JS_GetPropertyStr(ctx, val, "__ptr");
-    if (JS_ToInt64(ctx, &ptr, ptr_val) != 0) {
-        JS_FreeValue(ctx, ptr_val);
+    free(g_entity_refs);
+    g_entity_refs = NULL;
+    g_entity_ref_cap = 0;
+}
+
+/* Look up the entity's script as a global function; stays undefined while the
+ * global is missing so js_game_script_update can retry. */
+static void js_game_entity_ref_resolve(JSContext* ctx, JsGameEntityRef* ref)
+{
+    JSValue global;
+    JSValue fn;
+    JS_FreeValue(ctx, ref->fn);
+    ref->fn = JS_UNDEFINED;
+    if (!ref->entity->script[0]) {
+        return;
+    }
+    global = JS_GetGlobalObject(ctx);
+    fn = JS_GetPropertyStr(ctx, global, ref->entity->script);
+    JS_FreeValue(ctx, global);
+    if (JS_IsFunction(ctx, fn)) {
+        ref->fn = fn;
+    } else {
+        JS_FreeValue(ctx, fn);
+    }
+}
+
+static JsGameEntityRef* js_game_entity_ref(JSContext* ctx, GameEntity* e)
+{
+    JsGameEntityRef* ref;
+    if (!e || e->slot < 0) {
         return NULL;
     }
-    JS_FreeValue(ctx, ptr_val);
-    return (GameEntity*)(uintptr_t)ptr;
+    if (e->slot >= g_entity_ref_cap) {
+        int cap = g_entity_ref_cap > 0 ? g_entity_ref_cap : 128;
+        int i;
+        JsGameEntityRef* grown;
+        while (cap <= e->slot) {
+            cap *= 2;
+        }
+        grown = (JsGameEntityRef*)realloc(g_entity_refs, (size_t)cap * sizeof(JsGameEntityRef));
+        if (!grown) {
+            return NULL;
+        }
+        for (i = g_entity_ref_cap; i < cap; i++) {
+            grown[i].entity = NULL;
+            grown[i].obj = JS_UNDEFINED;
+            grown[i].fn = JS_UNDEFINED;
+        }
+        g_entity_refs = grown;
+        g_entity_ref_cap = cap;
+    }
+    ref = &g_entity_refs[e->slot];
+    if (ref->entity != e) {
+        JSValue obj = JS_NewObjectClass(ctx, (int)js_game_entity_class_id);
+        if (JS_IsException(obj)) {
+            return NULL;
+        }
+        js_game_entity_ref_reset(ctx, ref);
+        JS_SetOpaque(obj, e);
+        ref->entity = e;
+        ref->obj = obj;
+        js_game_entity_ref_resolve(ctx, ref);
+    }
+    return ref;
 }
 
-static void game_entity_apply_js(JSContext* ctx, GameEntity* e, JSValueConst val)
+static void js_game_on_entity_release(GameEntity* e)
 {
-    JSValue v;
-    double d;
-    if (!e || !JS_IsObject(val)) {
+    if (!g_game_ctx || !e || e->slot < 0 || e->slot >= g_entity_ref_cap) {
         return;
     }
-    v = JS_GetPropertyStr(ctx, val, "x");
-    if (JS_IsNumber(v) && JS_ToFloat64(ctx, &d, v) == 0) e->x = (float)d;
-    JS_FreeValue(ctx, v);
-    v = JS_GetPropertyStr(ctx, val, "y");
-    if (JS_IsNumber(v) && JS_ToFloat64(ctx, &d, v) == 0) e->y = (float)d;
-    JS_FreeValue(ctx, v);
-    v = JS_GetPropertyStr(ctx, val, "z");
-    if (JS_IsNumber(v) && JS_ToFloat64(ctx, &d, v) == 0) e->z = (float)d;
-    JS_FreeValue(ctx, v);
-    v = JS_GetPropertyStr(ctx, val, "vx");
-    if (JS_IsNumber(v) && JS_ToFloat64(ctx, &d, v) == 0) e->vx = (float)d;
-    JS_FreeValue(ctx, v);
-    v = JS_GetPropertyStr(ctx, val, "vy");
-    if (JS_IsNumber(v) && JS_ToFloat64(ctx, &d, v) == 0) e->vy = (float)d;
-    JS_FreeValue(ctx, v);
-    /* Do not write w/h: scripts rarely resize, and mid-reload stale apply
-     * used to clobber platforms with the player's 32x48. */
+    if (g_entity_refs[e->slot].entity == e) {
+        js_game_entity_ref_reset(g_game_ctx, &g_entity_refs[e->slot]);
+    }
+}
+
+static void js_game_on_entity_script(GameEntity* e)
+{
+    if (!g_game_ctx || !e || e->slot < 0 || e->slot >= g_entity_ref_cap) {
+        return;
+    }
+    if (g_entity_refs[e->slot].entity == e) {
+        js_game_entity_ref_resolve(g_game_ctx, &g_entity_refs[e->slot]);
+    }
+}
+
+static JSValue game_entity_to_js(JSContext* ctx, GameEntity* e)
+{
+    JsGameEntityRef* ref = js_game_entity_ref(ctx, e);
+    if (!ref) {
+        return JS_NULL;
+    }
+    return JS_DupValue(ctx, ref->obj);
+}
+
+static GameEntity* game_entity_from_js(JSContext* ctx, JSValueConst val)
+{
+    (void)ctx;
+    return (GameEntity*)JS_GetOpaque(val, js_game_entity_class_id);
 }
 
 static void js_game_script_update(GameEntity* entity, float dt)
 {
-    JSValue global;
+    JsGameEntityRef* ref;
     JSValue fn;
-    JSValue ent;
     JSValue args[2];
     JSValue ret;
-    int scene_gen;
     if (!g_game_ctx || !entity || !entity->script[0]) {
         return;
     }
-    scene_gen = game_scene_generation();
-    global = JS_GetGlobalObject(g_game_ctx);
-    fn = JS_GetPropertyStr(g_game_ctx, global, entity->script);
-    if (!JS_IsFunction(g_game_ctx, fn)) {
-        JS_FreeValue(g_game_ctx, fn);
-        JS_FreeValue(g_game_ctx, global);
+    ref = js_game_entity_ref(g_game_ctx, entity);
+    if (!ref) {
         return;
     }
-    ent = game_entity_to_js(g_game_ctx, entity);
-    args[0] = ent;
+    if (!JS_IsFunction(g_game_ctx, ref->fn)) {
+        /* Script loaded after the entity was spawned: retry until it exists. */
+        js_game_entity_ref_resolve(g_game_ctx, ref);
+        if (!JS_IsFunction(g_game_ctx, ref->fn)) {
+            return;
+        }
+    }
+    /* The script may destroy its own entity, which resets ref mid-call. */
+    fn = JS_DupValue(g_game_ctx, ref->fn);
+    args[0] = JS_DupValue(g_game_ctx, ref->obj);
     args[1] = JS_NewFloat64(g_game_ctx, dt);
     ret = JS_Call(g_game_ctx, fn, JS_UNDEFINED, 2, args);
     if (JS_IsException(ret)) {
         JSValue exc = JS_GetException(g_game_ctx);
         JS_FreeValue(g_game_ctx, exc);
-    } else if (game_scene_generation() == scene_gen && entity->alive) {
-        /* Scene reload mid-script: do not apply stale JS state onto reused slots. */
-        game_entity_apply_js(g_game_ctx, entity, ent);
     }
     JS_FreeValue(g_game_ctx, ret);
     JS_FreeValue(g_game_ctx, args[1]);
-    JS_FreeValue(g_game_ctx, ent);
+    JS_FreeValue(g_game_ctx, args[0]);
     JS_FreeValue(g_game_ctx, fn);
+}
+
+/* Game.update(entities, dt): when defined, one call per frame replaces the
+ * per-entity script functions. */
+static int js_game_script_batch(GameEntity** list, int count, float dt)
+{
+    JSValue global;
+    JSValue game;
+    JSValue fn;
+    JSValue args[2];
+    JSValue ret;
+    int i;
+    if (!g_game_ctx) {
+        return 0;
+    }
+    global = JS_GetGlobalObject(g_game_ctx);
+    game = JS_GetPropertyStr(g_game_ctx, global, "Game");
     JS_FreeValue(g_game_ctx, global);
+    fn = JS_GetPropertyStr(g_game_ctx, game, "update");
+    if (!JS_IsFunction(g_game_ctx, fn)) {
+        JS_FreeValue(g_game_ctx, fn);
+        JS_FreeValue(g_game_ctx, game);
+        return 0;
+    }
+    args[0] = JS_NewArray(g_game_ctx);
+    for (i = 0; i < count; i++) {
+        JS_SetPropertyUint32(g_game_ctx, args[0], (uint32_t)i, game_entity_to_js(g_game_ctx, list[i]));
+    }
+    args[1] = JS_NewFloat64(g_game_ctx, dt);
+    ret = JS_Call(g_game_ctx, fn, game, 2, args);
+    if (JS_IsException(ret)) {
+        JSValue exc = JS_GetException(g_game_ctx);
+        JS_FreeValue(g_game_ctx, exc);
+    }
+    JS_FreeValue(g_game_ctx, ret);
+    JS_FreeValue(g_game_ctx, args[1]);
+    JS_FreeValue(g_game_ctx, args[0]);
+    JS_FreeValue(g_game_ctx, fn);
+    JS_FreeValue(g_game_ctx, game);
+    return 1;
 }
 
 static JSValue js_game_load_scene(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
@@ -383,7 +598,8 @@ static void js_game_on_trigger(GameEntity* a, GameEntity* b, GameTriggerPhase ph
 static JSValue js_game_find_all_by_tag(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
 {
     const char* tag;
-    GameEntity* list[GAME_MAX_ENTITIES];
+    GameEntity** list;
+    int max_out = 0;
     int n;
     int i;
     JSValue arr;
@@ -392,12 +608,15 @@ static JSValue js_game_find_all_by_tag(JSContext* ctx, JSValueConst this_val, in
         return JS_NewArray(ctx);
     }
     tag = JS_ToCString(ctx, argv[0]);
-    n = game_find_all_by_tag(tag, list, GAME_MAX_ENTITIES);
+    game_entities(&max_out);
+    list = max_out > 0 ? (GameEntity**)malloc((size_t)max_out * sizeof(GameEntity*)) : NULL;
+    n = list ? game_find_all_by_tag(tag, list, max_out) : 0;
     if (tag) JS_FreeCString(ctx, tag);
     arr = JS_NewArray(ctx);
     for (i = 0; i < n; i++) {
         JS_SetPropertyUint32(ctx, arr, (uint32_t)i, game_entity_to_js(ctx, list[i]));
     }
+    free(list);
     return arr;
 }
 
@@ -520,6 +739,27 @@ static JSValue js_game_spawn_particles(JSContext* ctx, JSValueConst this_val, in
     return JS_NewInt32(ctx, game_spawn_particles((float)x, (float)y, count, color, (float)speed, (float)life));
 }
 
+static JSValue js_game_set_tile(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    int32_t col = 0, row = 0, tid = 0;
+    (void)this_val;
+    if (argc < 3) return JS_NewBool(ctx, 0);
+    JS_ToInt32(ctx, &col, argv[0]);
+    JS_ToInt32(ctx, &row, argv[1]);
+    JS_ToInt32(ctx, &tid, argv[2]);
+    return JS_NewBool(ctx, game_tilemap_set_tile(col, row, tid));
+}
+
+static JSValue js_game_get_tile(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    int32_t col = 0, row = 0;
+    (void)this_val;
+    if (argc < 2) return JS_NewInt32(ctx, -1);
+    JS_ToInt32(ctx, &col, argv[0]);
+    JS_ToInt32(ctx, &row, argv[1]);
+    return JS_NewInt32(ctx, game_tilemap_get_tile(col, row));
+}
+
 static JSValue js_game_debug_set_boxes(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
 {
     int on = 1;
@@ -548,6 +788,9 @@ static JSValue js_game_perf_get_stats(JSContext* ctx, JSValueConst this_val, int
     JS_SetPropertyStr(ctx, obj, "entities", JS_NewInt32(ctx, st->entities));
     JS_SetPropertyStr(ctx, obj, "draws", JS_NewInt32(ctx, st->draws));
     JS_SetPropertyStr(ctx, obj, "particles", JS_NewInt32(ctx, st->particles));
+    JS_SetPropertyStr(ctx, obj, "tileChunks", JS_NewInt32(ctx, st->tile_chunks));
+    JS_SetPropertyStr(ctx, obj, "batches", JS_NewInt32(ctx, st->batches));
+    JS_SetPropertyStr(ctx, obj, "drawCalls", JS_NewInt32(ctx, st->draw_calls));
     JS_SetPropertyStr(ctx, obj, "fps", JS_NewFloat64(ctx, st->fps));
     JS_SetPropertyStr(ctx, obj, "updateMs", JS_NewFloat64(ctx, st->update_ms));
     JS_SetPropertyStr(ctx, obj, "renderMs", JS_NewFloat64(ctx, st->render_ms));
@@ -572,8 +815,25 @@ void js_game_register_api(JSContext* ctx)
     g_game_ctx = ctx;
     game_init();
     game_set_script_update_fn(js_game_script_update);
+    game_set_script_batch_fn(js_game_script_batch);
+    game_set_entity_release_fn(js_game_on_entity_release);
+    game_set_entity_script_fn(js_game_on_entity_script);
     game_set_trigger_fn(js_game_on_trigger);
 
+    /* Class ids are process-wide; the class itself is per runtime. */
+    if (js_game_entity_class_id == 0) {
+        JS_NewClassID(&js_game_entity_class_id);
+    }
+    if (!JS_IsRegisteredClass(JS_GetRuntime(ctx), js_game_entity_class_id)) {
+        JS_NewClass(JS_GetRuntime(ctx), js_game_entity_class_id, &js_game_entity_class);
+    }
+    {
+        JSValue proto = JS_NewObject(ctx);
+        JS_SetPropertyFunctionList(ctx, proto, js_game_entity_proto_funcs,
+                                   sizeof(js_game_entity_proto_funcs) / sizeof(js_game_entity_proto_funcs[0]));
+        JS_SetClassProto(ctx, js_game_entity_class_id, proto);
+    }
+
     global = JS_GetGlobalObject(ctx);
     game_obj = JS_NewObject(ctx);
 
@@ -587,6 +847,8 @@ void js_game_register_api(JSContext* ctx)
     JS_SetPropertyStr(ctx, game_obj, "overlaps", JS_NewCFunction(ctx, js_game_overlaps, "overlaps", 2));
     JS_SetPropertyStr(ctx, game_obj, "playAnim", JS_NewCFunction(ctx, js_game_play_anim, "playAnim", 2));
     JS_SetPropertyStr(ctx, game_obj, "spawnParticles", JS_NewCFunction(ctx, js_game_spawn_particles, "spawnParticles", 1));
+    JS_SetPropertyStr(ctx, game_obj, "setTile", JS_NewCFunction(ctx, js_game_set_tile, "setTile", 3));
+    JS_SetPropertyStr(ctx, game_obj, "getTile", JS_NewCFunction(ctx, js_game_get_tile, "getTile", 2));
 
     input_obj = JS_NewObject(ctx);
     JS_SetPropertyStr(ctx, input_obj, "down", JS_NewCFunction(ctx, js_game_input_down, "down", 1));
@@ -644,6 +906,7 @@ void js_game_shutdown(void)
         game_shutdown();
         return;
     }
+    js_game_entity_refs_clear(g_game_ctx);
     JSValue global = JS_GetGlobalObject(g_game_ctx);
     JS_SetPropertyStr(g_game_ctx, global, "Game", JS_UNDEFINED);
     JS_FreeValue(g_game_ctx, global);
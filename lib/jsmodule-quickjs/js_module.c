@@ -6,6 +6,8 @@
 #include "../../src/layer_update.h"
 #include "../../src/layer_lifecycle.h"
 #include "../../src/render.h"
+#include "../../src/damage.h"
+#include "../../src/perf/perf.h"
 #include "../../src/theme_manager.h"
 #include "../../src/components/text_component.h"
 #include "js_socket.h"
@@ -15,6 +17,7 @@
 #include "../../src/event.h"
 #include "../../src/backend.h"
 #include "../../src/log.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,11 +39,33 @@ extern struct Layer* g_layer_root;
 
 static void js_module_timer_tick(void)
 {
-    if (g_js_ctx) {
-        js_timer_run(g_js_ctx);
+    /* 回调可能以任意方式修改图层（含不标脏的直接写字段），整屏重绘 */
+    perf_phase_begin(PERF_PHASE_TIMERS);
+    if (g_js_ctx && js_timer_run(g_js_ctx) > 0) {
+        damage_add_full();
+    }
+    perf_phase_end(PERF_PHASE_TIMERS);
+}
+
+// 主循环据此决定可以休眠多久
+static int js_module_timer_deadline(void)
+{
+    return g_js_ctx ? js_timer_next_deadline() : -1;
+}
+
+static void js_module_socket_tick(void)
+{
+    if (g_js_ctx && js_socket_reactor_run(g_js_ctx) > 0) {
+        damage_add_full();
     }
 }
 
+// socket 就绪由后台线程 backend_wake 唤醒，不需要定时轮询
+static int js_module_socket_deadline(void)
+{
+    return g_js_ctx ? js_socket_reactor_deadline() : -1;
+}
+
 /* ====================== QuickJS 原生函数 ====================== */
 
 JSValue js_read_file(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
@@ -240,6 +265,7 @@ static JSValue js_set_bg_color(JSContext *ctx, JSValueConst this_val, int argc,
                 layer->bg_color.g = g;
                 layer->bg_color.b = b;
                 layer->bg_color.a = 255;
+                mark_layer_dirty(layer, DIRTY_COLOR);
                 printf("JS(QuickJS): Set bg_color for layer '%s': %s\n", layer_id, color_hex);
             }
         }
@@ -436,6 +462,7 @@ static JSValue js_render_from_json(JSContext *ctx, JSValueConst this_val, int ar
         parent_layer->children[0] = new_layer;
         parent_layer->child_count = 1;
     }
+    mark_layer_dirty(parent_layer, DIRTY_CHILDREN | DIRTY_LAYOUT);
 
     layout_layer(parent_layer);
     load_all_fonts(new_layer);
@@ -455,6 +482,268 @@ static JSValue js_render_from_json(JSContext *ctx, JSValueConst this_val, int ar
     return JS_NewInt32(ctx, 0);
 }
 
+// JS 值直接转 cJSON（语义同 JSON.stringify：函数/undefined 在对象中省略、
+// 在数组中为 null，非有限数为 null，带 toJSON 的对象先调用，包装对象按原始值，
+// BigInt 抛 TypeError），免去字符串往返
+#define JS_TO_CJSON_MAX_DEPTH 128
+
+// 各原始类型的原型，用来识别 new Number(1) 等包装对象；遇到第一个对象时才取
+typedef struct JsBoxedProtos {
+    int ready;
+    JSValue number;
+    JSValue string;
+    JSValue boolean;
+    JSValue bigint;
+} JsBoxedProtos;
+
+static void js_boxed_protos_init(JSContext* ctx, JsBoxedProtos* protos)
+{
+    JSValue str = JS_NewStringLen(ctx, "", 0);
+    JSValue big = JS_NewBigInt64(ctx, 0);
+    protos->number = JS_GetPrototype(ctx, JS_NewInt32(ctx, 0));
+    protos->boolean = JS_GetPrototype(ctx, JS_FALSE);
+    protos->string = JS_GetPrototype(ctx, str);
+    protos->bigint = JS_GetPrototype(ctx, big);
+    JS_FreeValue(ctx, str);
+    JS_FreeValue(ctx, big);
+    protos->ready = 1;
+}
+
+static void js_boxed_protos_free(JSContext* ctx, JsBoxedProtos* protos)
+{
+    if (!protos->ready) {
+        return;
+    }
+    JS_FreeValue(ctx, protos->number);
+    JS_FreeValue(ctx, protos->string);
+    JS_FreeValue(ctx, protos->boolean);
+    JS_FreeValue(ctx, protos->bigint);
+}
+
+static int js_same_object(JSValueConst a, JSValueConst b)
+{
+    return JS_IsObject(a) && JS_IsObject(b) && JS_VALUE_GET_PTR(a) == JS_VALUE_GET_PTR(b);
+}
+
+static cJSON* js_value_to_cjson_depth(JSContext* ctx, JSValueConst val, int depth,
+                                      JsBoxedProtos* protos, int* failed);
+
+// 包装对象经 valueOf 取原始值再转换；不是包装对象时 *handled 为 0
+static cJSON* js_boxed_to_cjson(JSContext* ctx, JSValueConst val, int depth,
+                                JsBoxedProtos* protos, int* failed, int* handled)
+{
+    JSValue proto;
+    JSValue value_of;
+    JSValue prim;
+    cJSON* item;
+
+    *handled = 0;
+    if (!protos->ready) {
+        js_boxed_protos_init(ctx, protos);
+    }
+    proto = JS_GetPrototype(ctx, val);
+    if (JS_IsException(proto)) {
+        *handled = 1;
+        *failed = 1;
+        return NULL;
+    }
+    if (js_same_object(proto, protos->bigint)) {
+        JS_FreeValue(ctx, proto);
+        *handled = 1;
+        *failed = 1;
+        JS_ThrowTypeError(ctx, "BigInt value can't be serialized in JSON");
+        return NULL;
+    }
+    if (!js_same_object(proto, protos->number) && !js_same_object(proto, protos->string) &&
+        !js_same_object(proto, protos->boolean)) {
+        JS_FreeValue(ctx, proto);
+        return NULL;
+    }
+    JS_FreeValue(ctx, proto);
+
+    *handled = 1;
+    value_of = JS_GetPropertyStr(ctx, val, "valueOf");
+    if (JS_IsException(value_of)) {
+        *failed = 1;
+        return NULL;
+    }
+    prim = JS_Call(ctx, value_of, val, 0, NULL);
+    JS_FreeValue(ctx, value_of);
+    if (JS_IsException(prim)) {
+        *failed = 1;
+        return NULL;
+    }
+    // valueOf 被改写成返回对象时不再展开，按普通对象序列化
+    if (JS_IsObject(prim)) {
+        JS_FreeValue(ctx, prim);
+        *handled = 0;
+        return NULL;
+    }
+    item = js_value_to_cjson_depth(ctx, prim, depth + 1, protos, failed);
+    JS_FreeValue(ctx, prim);
+    return item;
+}
+
+static cJSON* js_value_to_cjson_depth(JSContext* ctx, JSValueConst val, int depth,
+                                      JsBoxedProtos* protos, int* failed)
+{
+    int tag = JS_VALUE_GET_TAG(val);
+
+    if (tag == JS_TAG_INT) {
+        return cJSON_CreateNumber(JS_VALUE_GET_INT(val));
+    }
+    if (JS_IsNumber(val)) {
+        double d = 0;
+        JS_ToFloat64(ctx, &d, val);
+        return isfinite(d) ? cJSON_CreateNumber(d) : cJSON_CreateNull();
+    }
+    if (JS_IsBool(val)) {
+        return cJSON_CreateBool(JS_ToBool(ctx, val));
+    }
+    if (JS_IsString(val)) {
+        const char* str = JS_ToCString(ctx, val);
+        cJSON* item;
+        if (!str) {
+            *failed = 1;
+            return NULL;
+        }
+        item = cJSON_CreateString(str);
+        JS_FreeCString(ctx, str);
+        return item;
+    }
+    if (JS_IsNull(val)) {
+        return cJSON_CreateNull();
+    }
+    if (JS_IsBigInt(ctx, val)) {
+        JS_ThrowTypeError(ctx, "BigInt value can't be serialized in JSON");
+        *failed = 1;
+        return NULL;
+    }
+    if (!JS_IsObject(val) || JS_IsFunction(ctx, val)) {
+        return NULL;  // undefined / 函数 / symbol：由调用方省略
+    }
+    if (depth >= JS_TO_CJSON_MAX_DEPTH) {
+        JS_ThrowRangeError(ctx, "value is cyclic or nested too deeply");
+        *failed = 1;
+        return NULL;
+    }
+
+    JSValue to_json = JS_GetPropertyStr(ctx, val, "toJSON");
+    if (JS_IsException(to_json)) {
+        *failed = 1;
+        return NULL;
+    }
+    if (JS_IsFunction(ctx, to_json)) {
+        JSValue replaced = JS_Call(ctx, to_json, val, 0, NULL);
+        cJSON* item = NULL;
+        JS_FreeValue(ctx, to_json);
+        if (JS_IsException(replaced)) {
+            *failed = 1;
+            return NULL;
+        }
+        item = js_value_to_cjson_depth(ctx, replaced, depth + 1, protos, failed);
+        JS_FreeValue(ctx, replaced);
+        return item;
+    }
+    JS_FreeValue(ctx, to_json);
+
+    {
+        int handled = 0;
+        cJSON* item = js_boxed_to_cjson(ctx, val, depth, protos, failed, &handled);
+        if (handled) {
+            return item;
+        }
+    }
+
+    if (JS_IsArray(ctx, val) > 0) {
+        cJSON* arr = cJSON_CreateArray();
+        JSValue len_val = JS_GetPropertyStr(ctx, val, "length");
+        uint32_t len = 0;
+        int len_failed = JS_ToUint32(ctx, &len, len_val) < 0;
+        JS_FreeValue(ctx, len_val);
+        if (len_failed) {
+            cJSON_Delete(arr);
+            *failed = 1;
+            return NULL;
+        }
+        if (!arr) return NULL;
+        for (uint32_t i = 0; i < len; i++) {
+            JSValue elem = JS_GetPropertyUint32(ctx, val, i);
+            cJSON* item;
+            // getter / Proxy 抛出的异常原样传给调用方
+            if (JS_IsException(elem)) {
+                cJSON_Delete(arr);
+                *failed = 1;
+                return NULL;
+            }
+            item = js_value_to_cjson_depth(ctx, elem, depth + 1, protos, failed);
+            JS_FreeValue(ctx, elem);
+            if (!item) {
+                if (*failed) {
+                    cJSON_Delete(arr);
+                    return NULL;
+                }
+                item = cJSON_CreateNull();
+            }
+            cJSON_AddItemToArray(arr, item);
+        }
+        return arr;
+    }
+
+    cJSON* obj = cJSON_CreateObject();
+    JSPropertyEnum* props = NULL;
+    uint32_t count = 0;
+    if (!obj) return NULL;
+    if (JS_GetOwnPropertyNames(ctx, &props, &count, val, JS_GPN_STRING_MASK | JS_GPN_ENUM_ONLY) < 0) {
+        cJSON_Delete(obj);
+        *failed = 1;
+        return NULL;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        JSValue prop = JS_GetProperty(ctx, val, props[i].atom);
+        cJSON* item;
+        if (JS_IsException(prop)) {
+            cJSON_Delete(obj);
+            obj = NULL;
+            *failed = 1;
+            break;
+        }
+        item = js_value_to_cjson_depth(ctx, prop, depth + 1, protos, failed);
+        JS_FreeValue(ctx, prop);
+        if (item) {
+            const char* key = JS_AtomToCString(ctx, props[i].atom);
+            if (key) {
+                cJSON_AddItemToObject(obj, key, item);
+                JS_FreeCString(ctx, key);
+            } else {
+                cJSON_Delete(item);
+            }
+        } else if (*failed) {
+            cJSON_Delete(obj);
+            obj = NULL;
+            break;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        JS_FreeAtom(ctx, props[i].atom);
+    }
+    js_free(ctx, props);
+    return obj;
+}
+
+/* 返回 NULL 时 *failed 非 0 表示已抛出 JS 异常，否则是不可转换的值（undefined / 函数） */
+static cJSON* js_value_to_cjson(JSContext* ctx, JSValueConst val, int* failed)
+{
+    JsBoxedProtos protos;
+    cJSON* json;
+
+    *failed = 0;
+    protos.ready = 0;
+    json = js_value_to_cjson_depth(ctx, val, 0, &protos, failed);
+    js_boxed_protos_free(ctx, &protos);
+    return json;
+}
+
 // JSON 增量更新
 extern int yui_update(Layer* root, const char* update_json);
 
@@ -473,27 +762,18 @@ static JSValue js_update(JSContext *ctx, JSValueConst this_val, int argc, JSValu
         update_json = JS_ToCString(ctx, argv[0]);
         need_free = 1;
     } else if (JS_IsObject(argv[0])) {
-        // 如果是对象，调用 JSON.stringify 转换
-        JSValue global = JS_GetGlobalObject(ctx);
-        JSValue json_obj = JS_GetPropertyStr(ctx, global, "JSON");
-        JSValue stringify_func = JS_GetPropertyStr(ctx, json_obj, "stringify");
-        
-        if (JS_IsFunction(ctx, stringify_func)) {
-            JSValue json_str = JS_Call(ctx, stringify_func, json_obj, 1, argv);
-            if (!JS_IsException(json_str) && JS_IsString(json_str)) {
-                update_json = JS_ToCString(ctx, json_str);
-                need_free = 1;
-            }
-            JS_FreeValue(ctx, json_str);
+        // 如果是对象，直接转成 cJSON
+        int failed = 0;
+        cJSON* json = js_value_to_cjson(ctx, argv[0], &failed);
+        int result = -1;
+        if (!json) {
+            return failed ? JS_EXCEPTION : JS_ThrowTypeError(ctx, "Failed to convert object");
         }
-        
-        JS_FreeValue(ctx, stringify_func);
-        JS_FreeValue(ctx, json_obj);
-        JS_FreeValue(ctx, global);
-        
-        if (!update_json) {
-            return JS_ThrowTypeError(ctx, "Failed to stringify object");
+        if (g_layer_root) {
+            result = yui_update_json(g_layer_root, json);
         }
+        cJSON_Delete(json);
+        return JS_NewInt32(ctx, result);
     } else {
         return JS_ThrowTypeError(ctx, "Argument must be string or object");
     }
@@ -632,6 +912,7 @@ static JSValue js_inspect_enable(JSContext *ctx, JSValueConst this_val, int argc
 {
     extern int yui_inspect_mode_enabled;
     yui_inspect_mode_enabled = 1;
+    damage_add_full();
     printf("JS(QuickJS): Enabled global inspect mode\n");
     return JS_NewBool(ctx, 1);
 }
@@ -641,6 +922,7 @@ static JSValue js_inspect_disable(JSContext *ctx, JSValueConst this_val, int arg
 {
     extern int yui_inspect_mode_enabled;
     yui_inspect_mode_enabled = 0;
+    damage_add_full();
     printf("JS(QuickJS): Disabled global inspect mode\n");
     return JS_NewBool(ctx, 1);
 }
@@ -660,6 +942,7 @@ static JSValue js_inspect_set_layer(JSContext *ctx, JSValueConst this_val, int a
         struct Layer* layer = find_layer_by_id(g_layer_root, layer_id);
         if (layer) {
             layer->inspect_enabled = enabled;
+            mark_layer_dirty(layer, DIRTY_STYLE);
             printf("JS(QuickJS): Set layer '%s' inspect enabled = %d\n", layer_id, enabled);
             JS_FreeCString(ctx, layer_id);
             return JS_NewBool(ctx, 1);
@@ -684,6 +967,7 @@ static JSValue js_inspect_set_show_bounds(JSContext *ctx, JSValueConst this_val,
     int show_bounds = JS_ToBool(ctx, argv[0]);
     extern int yui_inspect_show_bounds;
     yui_inspect_show_bounds = show_bounds;
+    damage_add_full();
     printf("JS(QuickJS): Set show bounds = %d\n", show_bounds);
     return JS_NewBool(ctx, 1);
 }
@@ -698,6 +982,7 @@ static JSValue js_inspect_set_show_info(JSContext *ctx, JSValueConst this_val, i
     int show_info = JS_ToBool(ctx, argv[0]);
     extern int yui_inspect_show_info;
     yui_inspect_show_info = show_info;
+    damage_add_full();
     printf("JS(QuickJS): Set show info = %d\n", show_info);
     return JS_NewBool(ctx, 1);
 }
@@ -860,6 +1145,9 @@ int js_module_init(void)
     js_module_register_api();
     js_module_init_layer_lifecycle();
     backend_register_update_callback(js_module_timer_tick);
+    backend_set_update_deadline(js_module_timer_tick, js_module_timer_deadline);
+    backend_register_update_callback(js_module_socket_tick);
+    backend_set_update_deadline(js_module_socket_tick, js_module_socket_deadline);
 
     printf("JS(QuickJS): QuickJS engine initialized\n");
     return 0;
@@ -875,6 +1163,7 @@ void js_module_cleanup(void)
 
     if (g_js_ctx) {
         js_timer_clear_all(g_js_ctx);
+        js_socket_reactor_clear(g_js_ctx);
         js_module_clear_events();
 #if YUI_WITH_GAME
         js_game_shutdown();
@@ -1227,6 +1516,10 @@ static JSValue js_layer_wrapper_get_data(JSContext* ctx, JSValueConst this_val)
 
     cJSON* value = layer_get_property_as_json(layer, "data");
     if (!value) {
+        // 组件未提供 data 属性（Table/List）：直接读图层数据，不先复制整棵树
+        if (layer->data && layer->data->json) {
+            return js_cjson_to_jsvalue(ctx, layer->data->json);
+        }
         return JS_UNDEFINED;
     }
 
@@ -1241,38 +1534,56 @@ static JSValue js_layer_wrapper_set_data(JSContext* ctx, JSValueConst this_val,
     Layer* layer = js_get_layer_from_wrapper(ctx, this_val);
     if (!layer) return JS_UNDEFINED;
 
-    // JSON.stringify → cJSON 后走统一 property 系统
-    JSValue global = JS_GetGlobalObject(ctx);
-    JSValue json_obj = JS_GetPropertyStr(ctx, global, "JSON");
-    JSValue stringify = JS_GetPropertyStr(ctx, json_obj, "stringify");
-    
-    JSValue json_str_val = JS_Call(ctx, stringify, json_obj, 1, &val);
-    if (JS_IsException(json_str_val)) {
-        JS_FreeValue(ctx, json_str_val); JS_FreeValue(ctx, stringify);
-        JS_FreeValue(ctx, json_obj); JS_FreeValue(ctx, global);
-        return JS_UNDEFINED;
+    int failed = 0;
+    cJSON* data_json = js_value_to_cjson(ctx, val, &failed);
+    if (!data_json) {
+        return failed ? JS_EXCEPTION : JS_UNDEFINED;
     }
-    
-    const char* json_str = JS_ToCString(ctx, json_str_val);
-    if (json_str) {
-        cJSON* data_json = cJSON_Parse(json_str);
-        if (data_json) {
-            int result = layer_set_data(layer, data_json);
-            if (result != 2) {
-                cJSON_Delete(data_json);
-            }
-        }
-        JS_FreeCString(ctx, json_str);
+    if (layer_set_data(layer, data_json) != 2) {
+        cJSON_Delete(data_json);
     }
-    
-    JS_FreeValue(ctx, json_str_val);
-    JS_FreeValue(ctx, stringify);
-    JS_FreeValue(ctx, json_obj);
-    JS_FreeValue(ctx, global);
-    
     return JS_UNDEFINED;
 }
 
+// layer.appendRows(rows)：追加行，不重发已有数据
+static JSValue js_layer_wrapper_append_rows(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    Layer* layer = js_get_layer_from_wrapper(ctx, this_val);
+    if (!layer || argc < 1) return JS_FALSE;
+    if (!JS_IsArray(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "appendRows expects an array");
+    }
+
+    int failed = 0;
+    cJSON* rows = js_value_to_cjson(ctx, argv[0], &failed);
+    if (!rows) {
+        return failed ? JS_EXCEPTION : JS_FALSE;
+    }
+    int handled = layer_append_rows(layer, rows);
+    cJSON_Delete(rows);
+    return JS_NewBool(ctx, handled);
+}
+
+// layer.updateRow(index, row)：替换单行
+static JSValue js_layer_wrapper_update_row(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    Layer* layer = js_get_layer_from_wrapper(ctx, this_val);
+    int index = -1;
+    if (!layer || argc < 2) return JS_FALSE;
+    if (JS_ToInt32(ctx, &index, argv[0]) != 0) return JS_EXCEPTION;
+
+    int failed = 0;
+    cJSON* row = js_value_to_cjson(ctx, argv[1], &failed);
+    if (!row) {
+        return failed ? JS_EXCEPTION : JS_FALSE;
+    }
+    if (layer_update_row(layer, index, row) != 2) {
+        cJSON_Delete(row);
+        return JS_FALSE;
+    }
+    return JS_TRUE;
+}
+
 // 创建 Layer 包装对象
 static JSValue js_create_layer_wrapper(JSContext* ctx, Layer* layer)
 {
@@ -1305,6 +1616,12 @@ static JSValue js_create_layer_wrapper(JSContext* ctx, Layer* layer)
     JS_DefinePropertyGetSet(ctx, wrapper, data_atom, data_getter, data_setter, JS_PROP_CONFIGURABLE | JS_PROP_ENUMERABLE);
     JS_FreeAtom(ctx, data_atom);
 
+    // 增量数据（Table/List）
+    JS_SetPropertyStr(ctx, wrapper, "appendRows",
+                      JS_NewCFunction(ctx, js_layer_wrapper_append_rows, "appendRows", 1));
+    JS_SetPropertyStr(ctx, wrapper, "updateRow",
+                      JS_NewCFunction(ctx, js_layer_wrapper_update_row, "updateRow", 2));
+
     // 定义 visible 属性的 getter/setter
     JSValue visible_getter = JS_NewCFunction2(ctx, (JSCFunction*)js_layer_wrapper_get_visible, "get visible", 0, JS_CFUNC_getter, 0);
     JSValue visible_setter = JS_NewCFunction2(ctx, (JSCFunction*)js_layer_wrapper_set_visible, "set visible", 1, JS_CFUNC_setter, 0);
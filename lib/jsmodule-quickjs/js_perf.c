@@ -99,6 +99,11 @@ static JSValue js_perf_get_frame_stats(JSContext* ctx, JSValueConst this_val, in
     JS_SetPropertyStr(ctx, obj, "frameMs", JS_NewFloat64(ctx, stats ? (double)stats->frame_ns / 1000000.0 : 0.0));
     JS_SetPropertyStr(ctx, obj, "renderMs", JS_NewFloat64(ctx, stats ? (double)stats->render_tree_ns / 1000000.0 : 0.0));
     JS_SetPropertyStr(ctx, obj, "layerCount", JS_NewInt32(ctx, stats ? (int)stats->layers_rendered : 0));
+    JS_SetPropertyStr(ctx, obj, "pixelsRedrawn", JS_NewInt64(ctx, stats ? (int64_t)stats->pixels_redrawn : 0));
+    JS_SetPropertyStr(ctx, obj, "skippedFrames", JS_NewInt64(ctx, stats ? (int64_t)stats->frames_skipped : 0));
+    JS_SetPropertyStr(ctx, obj, "wakeReason", JS_NewString(ctx, perf_wake_reason_name(stats ? stats->wake_reason : PERF_WAKE_NONE)));
+    JS_SetPropertyStr(ctx, obj, "waitMs", JS_NewInt32(ctx, stats ? (int)stats->wait_ms : 0));
+    JS_SetPropertyStr(ctx, obj, "textRasterized", JS_NewInt32(ctx, stats ? (int)stats->text_rasterized : 0));
     return obj;
 }
 
@@ -147,6 +152,43 @@ static JSValue js_perf_get_layer_stats(JSContext* ctx, JSValueConst this_val, in
     return arr;
 }
 
+// 主循环及各阶段的尾延迟：{ loop: {count, p50, p95, p99, max}, events: ..., ... }，单位毫秒
+static JSValue js_perf_get_percentiles(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    JSValue obj = JS_NewObject(ctx);
+
+    for (int series = 0; series <= PERF_SERIES_LOOP; series++) {
+        PerfPercentiles p;
+        JSValue item = JS_NewObject(ctx);
+        perf_get_percentiles(series, &p);
+        JS_SetPropertyStr(ctx, item, "count", JS_NewInt64(ctx, (int64_t)p.count));
+        JS_SetPropertyStr(ctx, item, "p50", JS_NewFloat64(ctx, p.p50_ms));
+        JS_SetPropertyStr(ctx, item, "p95", JS_NewFloat64(ctx, p.p95_ms));
+        JS_SetPropertyStr(ctx, item, "p99", JS_NewFloat64(ctx, p.p99_ms));
+        JS_SetPropertyStr(ctx, item, "max", JS_NewFloat64(ctx, p.max_ms));
+        JS_SetPropertyStr(ctx, obj, perf_phase_name(series), item);
+    }
+    return obj;
+}
+
+// 导出最近的主循环记录为 Chrome trace JSON，返回记录数，失败 -1
+static JSValue js_perf_export_trace(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    const char* path;
+    int count;
+
+    if (argc < 1 || !JS_IsString(argv[0])) {
+        return JS_NewInt32(ctx, -1);
+    }
+    path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+    count = perf_export_trace(path);
+    JS_FreeCString(ctx, path);
+    return JS_NewInt32(ctx, count);
+}
+
 void js_module_register_perf_api(JSContext* ctx, JSValueConst yui_obj)
 {
     JSValue perf_obj;
@@ -167,6 +209,8 @@ void js_module_register_perf_api(JSContext* ctx, JSValueConst yui_obj)
     JS_SetPropertyStr(ctx, perf_obj, "clearWatch", JS_NewCFunction(ctx, js_perf_clear_watch, "clearWatch", 0));
     JS_SetPropertyStr(ctx, perf_obj, "getFrameStats", JS_NewCFunction(ctx, js_perf_get_frame_stats, "getFrameStats", 0));
     JS_SetPropertyStr(ctx, perf_obj, "getLayerStats", JS_NewCFunction(ctx, js_perf_get_layer_stats, "getLayerStats", 1));
+    JS_SetPropertyStr(ctx, perf_obj, "getPercentiles", JS_NewCFunction(ctx, js_perf_get_percentiles, "getPercentiles", 0));
+    JS_SetPropertyStr(ctx, perf_obj, "exportTrace", JS_NewCFunction(ctx, js_perf_export_trace, "exportTrace", 1));
     JS_SetPropertyStr(ctx, yui_obj, "perf", perf_obj);
     printf("JS(QuickJS): Registered YUI.perf API\n");
 }
@@ -1,6 +1,9 @@
 #include "lib/jsmodule/js_module.h"
 #include "../../lib/quickjs/quickjs.h"
 #include "../../src/layer.h"
+#include "../../src/backend.h"
+#include "js_socket.h"
+#include "socket_reactor.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -65,6 +68,452 @@ extern in_addr_t _inet_addr(const char* strptr);
 extern uint32_t _ntohl(uint32_t netlong);
 extern void* make_sockaddr_in(int family, int addr, int port);
 
+/* ====================== 就绪回调（反应器） ====================== */
+
+#define JS_SOCKET_BUFFER_SIZE 65536
+#define JS_SOCKET_BUFFER_MAX (16 * 1024 * 1024)
+#define JS_SOCKET_READS_PER_TICK 16   // 每轮每个 socket 最多读几次，避免饿死界面
+#define JS_SOCKET_POLL_MS 10          // 没有后台唤醒线程的平台按此间隔轮询
+
+typedef struct JsSocketWatch {
+    int fd;
+    int recv;          // 1：由反应器读入复用缓冲后回调 onReadable(buffer, length)
+    int want_write;    // onWritable 只触发一次，Socket.wantWrite 重新登记
+    int busy;          // 正在执行它的回调
+    int dead;          // 回调中被取消，回调返回后释放
+    JSValue on_readable;
+    JSValue on_writable;
+    JSValue on_close;
+    JSValue buffer;    // 复用的 ArrayBuffer，数据归它所有
+    uint8_t* data;
+    size_t size;
+    struct JsSocketWatch* next;
+} JsSocketWatch;
+
+static JsSocketWatch* g_socket_watches = NULL;
+static JSContext* g_socket_ctx = NULL;
+static int g_socket_fired = 0;
+
+static int js_socket_would_block(void)
+{
+#ifdef WIN32
+    int err = WSAGetLastError();
+    return err == WSAEWOULDBLOCK || err == WSAEINTR;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+static int js_socket_last_error(void)
+{
+#ifdef WIN32
+    return WSAGetLastError();
+#else
+    return errno;
+#endif
+}
+
+static void js_socket_dump_exception(JSContext* ctx)
+{
+    JSValue exc = JS_GetException(ctx);
+    JSValue msg_val = JS_GetPropertyStr(ctx, exc, "message");
+    const char* msg = JS_ToCString(ctx, msg_val);
+    if (msg) {
+        printf("JS(Socket): callback error: %s\n", msg);
+        JS_FreeCString(ctx, msg);
+    }
+    JS_FreeValue(ctx, msg_val);
+    JS_FreeValue(ctx, exc);
+}
+
+static void js_socket_free_buffer(JSRuntime* rt, void* opaque, void* ptr)
+{
+    (void)rt;
+    (void)opaque;
+    free(ptr);
+}
+
+/* 取 ArrayBuffer / TypedArray 的字节区；不是二进制对象返回 NULL 且不留异常 */
+static uint8_t* js_socket_get_bytes(JSContext* ctx, JSValueConst val, size_t* len)
+{
+    size_t size = 0;
+    size_t offset = 0;
+    size_t length = 0;
+    size_t element = 0;
+    uint8_t* data;
+    JSValue ab;
+
+    if (!JS_IsObject(val)) {
+        return NULL;
+    }
+    data = JS_GetArrayBuffer(ctx, &size, val);
+    if (data) {
+        *len = size;
+        return data;
+    }
+    JS_FreeValue(ctx, JS_GetException(ctx));
+
+    ab = JS_GetTypedArrayBuffer(ctx, val, &offset, &length, &element);
+    if (JS_IsException(ab)) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return NULL;
+    }
+    data = JS_GetArrayBuffer(ctx, &size, ab);
+    JS_FreeValue(ctx, ab);   // 仍由 TypedArray 引用
+    if (!data) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return NULL;
+    }
+    *len = length;
+    return data + offset;
+}
+
+static JsSocketWatch* js_socket_find_watch(int fd)
+{
+    for (JsSocketWatch* w = g_socket_watches; w; w = w->next) {
+        if (w->fd == fd && !w->dead) {
+            return w;
+        }
+    }
+    return NULL;
+}
+
+static void js_socket_free_watch(JSContext* ctx, JsSocketWatch* w)
+{
+    JS_FreeValue(ctx, w->on_readable);
+    JS_FreeValue(ctx, w->on_writable);
+    JS_FreeValue(ctx, w->on_close);
+    JS_FreeValue(ctx, w->buffer);
+    free(w);
+}
+
+// 从反应器和链表中移除；正在执行回调的延后到回调返回再释放
+static void js_socket_remove_watch(JSContext* ctx, JsSocketWatch* w)
+{
+    JsSocketWatch** link = &g_socket_watches;
+
+    socket_reactor_unwatch(w->fd);
+    while (*link && *link != w) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = w->next;
+    }
+    w->next = NULL;
+    w->dead = 1;
+    if (!w->busy) {
+        js_socket_free_watch(ctx, w);
+    }
+}
+
+static int js_socket_watch_events(JsSocketWatch* w)
+{
+    // 始终关注可读：raw 模式交给脚本 accept/recv，recv 模式据此发现对端关闭
+    return SOCKET_REACTOR_READ | (w->want_write ? SOCKET_REACTOR_WRITE : 0);
+}
+
+/* 调用回调；返回 0 表示 watch 已在回调中被取消并释放，调用者不能再访问 */
+static int js_socket_call(JSContext* ctx, JsSocketWatch* w, JSValueConst func, int argc, JSValueConst* argv)
+{
+    JSValue ret;
+
+    if (!JS_IsFunction(ctx, func)) {
+        return 1;
+    }
+    w->busy++;
+    ret = JS_Call(ctx, func, JS_UNDEFINED, argc, argv);
+    w->busy--;
+    g_socket_fired++;
+    if (JS_IsException(ret)) {
+        js_socket_dump_exception(ctx);
+    }
+    JS_FreeValue(ctx, ret);
+
+    if (w->dead) {
+        if (!w->busy) {
+            js_socket_free_watch(ctx, w);
+        }
+        return 0;
+    }
+    return 1;
+}
+
+// 对端关闭或出错：先移除再回调 onClose(err)，fd 仍由脚本关闭
+static void js_socket_watch_closed(JSContext* ctx, JsSocketWatch* w, int err)
+{
+    JSValue func = JS_DupValue(ctx, w->on_close);
+    JSValue arg = JS_NewInt32(ctx, err);
+
+    w->busy++;
+    js_socket_remove_watch(ctx, w);
+    w->busy--;
+    if (JS_IsFunction(ctx, func)) {
+        JSValue ret = JS_Call(ctx, func, JS_UNDEFINED, 1, &arg);
+        g_socket_fired++;
+        if (JS_IsException(ret)) {
+            js_socket_dump_exception(ctx);
+        }
+        JS_FreeValue(ctx, ret);
+    }
+    JS_FreeValue(ctx, func);
+    js_socket_free_watch(ctx, w);
+}
+
+static void js_socket_on_ready(int fd, int events, void* opaque)
+{
+    JSContext* ctx = g_socket_ctx;
+    JsSocketWatch* w = (JsSocketWatch*)opaque;
+
+    (void)fd;
+    if (!ctx || w->dead) {
+        return;
+    }
+
+    if ((events & SOCKET_REACTOR_WRITE) && w->want_write) {
+        w->want_write = 0;
+        socket_reactor_modify(w->fd, js_socket_watch_events(w));
+        if (!js_socket_call(ctx, w, w->on_writable, 0, NULL)) {
+            return;
+        }
+    }
+
+    if (w->recv) {
+        if (!(events & (SOCKET_REACTOR_READ | SOCKET_REACTOR_ERROR))) {
+            return;
+        }
+        for (int i = 0; i < JS_SOCKET_READS_PER_TICK; i++) {
+            ssize_t n = _recv(w->fd, w->data, w->size, 0);
+            JSValue args[2];
+
+            if (n == 0) {
+                js_socket_watch_closed(ctx, w, 0);
+                return;
+            }
+            if (n < 0) {
+                if (!js_socket_would_block()) {
+                    js_socket_watch_closed(ctx, w, js_socket_last_error());
+                }
+                return;
+            }
+            // 回调按 length 读取同一个 ArrayBuffer，需要保留数据时自行 slice
+            args[0] = w->buffer;
+            args[1] = JS_NewInt32(ctx, (int32_t)n);
+            if (!js_socket_call(ctx, w, w->on_readable, 2, args)) {
+                return;
+            }
+            if ((size_t)n < w->size) {
+                return;   // 没读满，内核缓冲已取空
+            }
+        }
+        return;
+    }
+
+    if (events & SOCKET_REACTOR_READ) {
+        js_socket_call(ctx, w, w->on_readable, 0, NULL);
+    } else if (events & SOCKET_REACTOR_ERROR) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        _getsockopt(w->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        js_socket_watch_closed(ctx, w, err);
+    }
+}
+
+int js_socket_reactor_run(JSContext* ctx)
+{
+    if (!ctx || !g_socket_watches) {
+        return 0;
+    }
+    g_socket_ctx = ctx;
+    g_socket_fired = 0;
+    socket_reactor_poll(0);
+    return g_socket_fired;
+}
+
+int js_socket_reactor_deadline(void)
+{
+    if (!g_socket_watches || socket_reactor_has_waker()) {
+        return -1;
+    }
+    return JS_SOCKET_POLL_MS;
+}
+
+void js_socket_reactor_clear(JSContext* ctx)
+{
+    while (g_socket_watches) {
+        JsSocketWatch* w = g_socket_watches;
+        g_socket_watches = w->next;
+        socket_reactor_unwatch(w->fd);
+        if (ctx) {
+            js_socket_free_watch(ctx, w);
+        } else {
+            free(w);
+        }
+    }
+    socket_reactor_shutdown();
+    g_socket_ctx = NULL;
+}
+
+static JSValue js_socket_get_handler(JSContext* ctx, JSValueConst handlers, const char* name)
+{
+    JSValue func = JS_GetPropertyStr(ctx, handlers, name);
+    if (!JS_IsFunction(ctx, func)) {
+        JS_FreeValue(ctx, func);
+        return JS_UNDEFINED;
+    }
+    return func;
+}
+
+// Socket.watch(fd, { onReadable, onWritable, onClose, bufferSize, recv })
+static JSValue js_socket_watch(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    int fd;
+    int32_t size = JS_SOCKET_BUFFER_SIZE;
+    JsSocketWatch* w;
+    JsSocketWatch* old;
+    JSValue opt;
+
+    (void)this_val;
+    if (argc < 2 || !JS_IsObject(argv[1])) {
+        return JS_ThrowTypeError(ctx, "Socket.watch(fd, handlers)");
+    }
+    if (JS_ToInt32(ctx, &fd, argv[0])) {
+        return JS_EXCEPTION;
+    }
+    if (fd < 0) {
+        return JS_NewInt32(ctx, -1);
+    }
+
+    opt = JS_GetPropertyStr(ctx, argv[1], "bufferSize");
+    if (!JS_IsUndefined(opt) && JS_ToInt32(ctx, &size, opt)) {
+        JS_FreeValue(ctx, opt);
+        return JS_EXCEPTION;
+    }
+    JS_FreeValue(ctx, opt);
+    if (size < 256) {
+        size = 256;
+    }
+    if (size > JS_SOCKET_BUFFER_MAX) {
+        size = JS_SOCKET_BUFFER_MAX;
+    }
+
+    w = (JsSocketWatch*)calloc(1, sizeof(JsSocketWatch));
+    if (!w) {
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    w->fd = fd;
+    w->buffer = JS_UNDEFINED;
+    opt = JS_GetPropertyStr(ctx, argv[1], "recv");
+    w->recv = JS_IsUndefined(opt) ? 1 : JS_ToBool(ctx, opt);
+    JS_FreeValue(ctx, opt);
+    w->on_readable = js_socket_get_handler(ctx, argv[1], "onReadable");
+    w->on_writable = js_socket_get_handler(ctx, argv[1], "onWritable");
+    w->on_close = js_socket_get_handler(ctx, argv[1], "onClose");
+    w->want_write = JS_IsFunction(ctx, w->on_writable);
+
+    if (w->recv) {
+        w->data = (uint8_t*)malloc((size_t)size);
+        if (!w->data) {
+            js_socket_free_watch(ctx, w);
+            return JS_ThrowOutOfMemory(ctx);
+        }
+        w->size = (size_t)size;
+        w->buffer = JS_NewArrayBuffer(ctx, w->data, w->size, js_socket_free_buffer, NULL, 0);
+        if (JS_IsException(w->buffer)) {
+            free(w->data);
+            w->buffer = JS_UNDEFINED;
+            js_socket_free_watch(ctx, w);
+            return JS_EXCEPTION;
+        }
+    }
+
+    // 重复 watch 同一 fd 视为替换回调
+    old = js_socket_find_watch(fd);
+    if (old) {
+        js_socket_remove_watch(ctx, old);
+    }
+
+    js_socket_set_nonblocking(fd, 1);
+    g_socket_ctx = ctx;
+    if (!socket_reactor_has_waker()) {
+        socket_reactor_set_waker(backend_wake);
+    }
+    if (socket_reactor_watch(fd, js_socket_watch_events(w), js_socket_on_ready, w) != 0) {
+        js_socket_free_watch(ctx, w);
+        return JS_NewInt32(ctx, -1);
+    }
+    w->next = g_socket_watches;
+    g_socket_watches = w;
+    return JS_NewInt32(ctx, 0);
+}
+
+static JSValue js_socket_unwatch(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    int fd;
+    JsSocketWatch* w;
+
+    (void)this_val;
+    if (argc < 1 || JS_ToInt32(ctx, &fd, argv[0])) {
+        return JS_UNDEFINED;
+    }
+    w = js_socket_find_watch(fd);
+    if (w) {
+        js_socket_remove_watch(ctx, w);
+    }
+    return JS_UNDEFINED;
+}
+
+// Socket.wantWrite(fd[, on])：登记一次 onWritable（发送遇到 EAGAIN 后等待可写）
+static JSValue js_socket_want_write(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    int fd;
+    JsSocketWatch* w;
+
+    (void)this_val;
+    if (argc < 1 || JS_ToInt32(ctx, &fd, argv[0])) {
+        return JS_UNDEFINED;
+    }
+    w = js_socket_find_watch(fd);
+    if (!w) {
+        return JS_FALSE;
+    }
+    w->want_write = argc < 2 ? 1 : JS_ToBool(ctx, argv[1]);
+    socket_reactor_modify(fd, js_socket_watch_events(w));
+    return JS_TRUE;
+}
+
+// Socket.recvInto(fd, buffer[, offset[, length]])：读入已有 ArrayBuffer/TypedArray，
+// 返回字节数，0 为对端关闭，-1 为暂无数据或出错
+static JSValue js_socket_recv_into(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    int fd;
+    int32_t offset = 0;
+    int32_t length = -1;
+    size_t size = 0;
+    uint8_t* data;
+
+    (void)this_val;
+    if (argc < 2 || JS_ToInt32(ctx, &fd, argv[0])) {
+        return JS_NewInt32(ctx, -1);
+    }
+    data = js_socket_get_bytes(ctx, argv[1], &size);
+    if (!data) {
+        return JS_ThrowTypeError(ctx, "Socket.recvInto: ArrayBuffer or TypedArray expected");
+    }
+    if (argc > 2 && JS_ToInt32(ctx, &offset, argv[2])) {
+        return JS_EXCEPTION;
+    }
+    if (argc > 3 && JS_ToInt32(ctx, &length, argv[3])) {
+        return JS_EXCEPTION;
+    }
+    if (offset < 0 || (size_t)offset > size) {
+        return JS_ThrowRangeError(ctx, "Socket.recvInto: offset out of range");
+    }
+    if (length < 0 || (size_t)length > size - (size_t)offset) {
+        length = (int32_t)(size - (size_t)offset);
+    }
+    return JS_NewInt32(ctx, (int32_t)_recv(fd, data + offset, (size_t)length, 0));
+}
+
 /* ====================== Socket 相关的 JS 函数 ====================== */
 
 // 创建 socket
@@ -93,6 +542,10 @@ static JSValue js_socket_close(JSContext *ctx, JSValueConst this_val, int argc,
 
     int fd;
     JS_ToInt32(ctx, &fd, argv[0]);
+    JsSocketWatch* w = js_socket_find_watch(fd);
+    if (w) {
+        js_socket_remove_watch(ctx, w);
+    }
     _close(fd);
     return JS_UNDEFINED;
 }
@@ -220,7 +673,8 @@ static JSValue js_socket_bind(JSContext *ctx, JSValueConst this_val, int argc, J
     JS_ToInt32(ctx, &port, argv[2]);
 
     int res = -1;
-    if(fd < 0 || port <= 0) {
+    // 端口 0 由系统分配，用 getsockname 取回
+    if(fd < 0 || port < 0) {
         JS_FreeCString(ctx, host);
         return JS_NewInt32(ctx, res);
     }
@@ -284,7 +738,7 @@ static JSValue js_socket_getsockname(JSContext *ctx, JSValueConst this_val, int
         // 返回包含地址和端口的对象
         JSValue obj = JS_NewObject(ctx);
         JS_SetPropertyStr(ctx, obj, "ip", JS_NewString(ctx, inet_ntoa(addr.sin_addr)));
-        JS_SetPropertyStr(ctx, obj, "port", JS_NewInt32(ctx, _ntohl(addr.sin_port)));
+        JS_SetPropertyStr(ctx, obj, "port", JS_NewInt32(ctx, ntohs(addr.sin_port)));
         
         return obj;
     }
@@ -309,7 +763,7 @@ static JSValue js_socket_getpeername(JSContext *ctx, JSValueConst this_val, int
         // 返回包含地址和端口的对象
         JSValue obj = JS_NewObject(ctx);
         JS_SetPropertyStr(ctx, obj, "ip", JS_NewString(ctx, inet_ntoa(addr.sin_addr)));
-        JS_SetPropertyStr(ctx, obj, "port", JS_NewInt32(ctx, _ntohl(addr.sin_port)));
+        JS_SetPropertyStr(ctx, obj, "port", JS_NewInt32(ctx, ntohs(addr.sin_port)));
         
         return obj;
     }
@@ -416,7 +870,13 @@ static JSValue js_socket_send(JSContext *ctx, JSValueConst this_val, int argc, J
     JS_ToInt32(ctx, &fd, argv[0]);
     JS_ToInt32(ctx, &flags, argv[2]);
     
+    // ArrayBuffer / TypedArray 直接发送字节，不经字符串转换
     size_t msg_len;
+    uint8_t* bytes = js_socket_get_bytes(ctx, argv[1], &msg_len);
+    if (bytes) {
+        return JS_NewInt32(ctx, (int32_t)_send(fd, bytes, msg_len, flags));
+    }
+
     const char* message = JS_ToCStringLen(ctx, &msg_len, argv[1]);
     
     int result = _send(fd, message, msg_len, flags);
@@ -610,6 +1070,10 @@ void js_module_register_socket_api(JSContext* ctx)
     JS_SetPropertyStr(ctx, socket_obj, "setNonBlocking", JS_NewCFunction(ctx, js_socket_set_nonblocking_js, "setNonBlocking", 2));
     JS_SetPropertyStr(ctx, socket_obj, "send", JS_NewCFunction(ctx, js_socket_send, "send", 3));
     JS_SetPropertyStr(ctx, socket_obj, "recv", JS_NewCFunction(ctx, js_socket_recv, "recv", 3));
+    JS_SetPropertyStr(ctx, socket_obj, "recvInto", JS_NewCFunction(ctx, js_socket_recv_into, "recvInto", 4));
+    JS_SetPropertyStr(ctx, socket_obj, "watch", JS_NewCFunction(ctx, js_socket_watch, "watch", 2));
+    JS_SetPropertyStr(ctx, socket_obj, "unwatch", JS_NewCFunction(ctx, js_socket_unwatch, "unwatch", 1));
+    JS_SetPropertyStr(ctx, socket_obj, "wantWrite", JS_NewCFunction(ctx, js_socket_want_write, "wantWrite", 2));
     JS_SetPropertyStr(ctx, socket_obj, "sendto", JS_NewCFunction(ctx, js_socket_sendto, "sendto", 5));
     JS_SetPropertyStr(ctx, socket_obj, "recvfrom", JS_NewCFunction(ctx, js_socket_recvfrom, "recvfrom", 3));
     JS_SetPropertyStr(ctx, socket_obj, "inet_addr", JS_NewCFunction(ctx, js_socket_inet_addr, "inet_addr", 1));
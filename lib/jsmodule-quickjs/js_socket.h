@@ -10,6 +10,12 @@ extern "C" {
 // 注册 Socket 相关的函数到 JS
 void js_module_register_socket_api(JSContext* ctx);
 
+/* Socket.watch 登记的就绪回调：在主循环中分派，返回本次触发的回调数 */
+int js_socket_reactor_run(JSContext* ctx);
+/* 距下次需要分派的毫秒数；没有关注的 socket 或由后台线程唤醒时返回 -1 */
+int js_socket_reactor_deadline(void);
+void js_socket_reactor_clear(JSContext* ctx);
+
 #ifdef __cplusplus
 }
 #endif
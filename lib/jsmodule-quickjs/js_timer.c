@@ -1,6 +1,8 @@
 #include "js_timer.h"
 
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef _WIN32
@@ -10,16 +12,46 @@
 #include <time.h>
 #endif
 
-#define MAX_JS_TIMERS 64
+/* 定时器按 (到期时间, 创建序号) 存最小堆，插入/取消/触发均为 O(log n)，数量不设上限。
+   id 低位是槽号、高位是槽的代数，槽复用后旧 id 失效，clearTimeout 不会误删新定时器。 */
+#define JS_TIMER_SLOT_BITS 20
+#define JS_TIMER_SLOT_MASK ((1 << JS_TIMER_SLOT_BITS) - 1)
+#define JS_TIMER_GEN_MASK 0x7ff   // 31 位正整数 id 中留给代数的 11 位
+#define JS_TIMER_FRAME_MS 16      // requestAnimationFrame 的节拍
 
 typedef struct {
-    int active;
+    int id;            // 0 表示空闲
+    int gen;           // 槽的代数，每次复用 +1
+    int heap_index;
     int64_t expire_ms;
+    uint32_t seq;      // 到期时间相同时按创建顺序触发
+    int interval_ms;   // >0 为 setInterval
     JSValue func;
 } JsTimerEntry;
 
-static JsTimerEntry g_js_timers[MAX_JS_TIMERS];
-static int g_js_timer_seq = 0;
+typedef struct {
+    int id;
+    JSValue func;      // 取消后为 JS_UNDEFINED
+} JsFrameEntry;
+
+typedef struct {
+    JsFrameEntry* items;
+    int count;
+    int capacity;
+} JsFrameList;
+
+static JsTimerEntry* g_js_timers = NULL;
+static int g_js_timer_capacity = 0;
+static int* g_js_timer_free = NULL;    // 空闲槽栈
+static int g_js_timer_free_count = 0;
+static int* g_js_timer_heap = NULL;    // 槽号
+static int g_js_timer_heap_count = 0;
+static uint32_t g_js_timer_seq = 0;
+
+static JsFrameList g_js_frames;        // 等待下一帧
+static JsFrameList g_js_frames_running; // 本帧正在执行
+static int g_js_frame_seq = 0;
+static int64_t g_js_frame_due = 0;
 
 static int64_t js_timer_now_ms(void)
 {
@@ -51,47 +83,197 @@ static void js_timer_dump_exception(JSContext* ctx)
     JS_FreeValue(ctx, exc);
 }
 
-static int js_timer_alloc_slot(void)
+/* ====================== 最小堆 ====================== */
+
+static int js_timer_before(int a, int b)
+{
+    const JsTimerEntry* ta = &g_js_timers[a];
+    const JsTimerEntry* tb = &g_js_timers[b];
+    if (ta->expire_ms != tb->expire_ms) {
+        return ta->expire_ms < tb->expire_ms;
+    }
+    return (int32_t)(ta->seq - tb->seq) < 0;
+}
+
+static void js_timer_heap_set(int index, int slot)
 {
-    for (int i = 0; i < MAX_JS_TIMERS; i++) {
-        int slot = (g_js_timer_seq + i) % MAX_JS_TIMERS;
-        if (!g_js_timers[slot].active) {
-            g_js_timer_seq = (slot + 1) % MAX_JS_TIMERS;
-            return slot;
+    g_js_timer_heap[index] = slot;
+    g_js_timers[slot].heap_index = index;
+}
+
+static void js_timer_heap_up(int index)
+{
+    int slot = g_js_timer_heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!js_timer_before(slot, g_js_timer_heap[parent])) {
+            break;
         }
+        js_timer_heap_set(index, g_js_timer_heap[parent]);
+        index = parent;
     }
-    return -1;
+    js_timer_heap_set(index, slot);
 }
 
-JSValue js_qjs_setTimeout(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+static void js_timer_heap_down(int index)
 {
-    (void)this_val;
-    if (argc < 2) {
-        return JS_ThrowTypeError(ctx, "setTimeout expects (function, delay)");
+    int slot = g_js_timer_heap[index];
+    for (;;) {
+        int child = index * 2 + 1;
+        if (child >= g_js_timer_heap_count) {
+            break;
+        }
+        if (child + 1 < g_js_timer_heap_count &&
+            js_timer_before(g_js_timer_heap[child + 1], g_js_timer_heap[child])) {
+            child++;
+        }
+        if (!js_timer_before(g_js_timer_heap[child], slot)) {
+            break;
+        }
+        js_timer_heap_set(index, g_js_timer_heap[child]);
+        index = child;
     }
-    if (!JS_IsFunction(ctx, argv[0])) {
-        return JS_ThrowTypeError(ctx, "not a function");
+    js_timer_heap_set(index, slot);
+}
+
+static void js_timer_heap_push(int slot)
+{
+    js_timer_heap_set(g_js_timer_heap_count++, slot);
+    js_timer_heap_up(g_js_timer_heap_count - 1);
+}
+
+static void js_timer_heap_remove(int slot)
+{
+    int index = g_js_timers[slot].heap_index;
+    int last = g_js_timer_heap[--g_js_timer_heap_count];
+
+    g_js_timers[slot].heap_index = -1;
+    if (last == slot) {
+        return;
     }
+    js_timer_heap_set(index, last);
+    if (index > 0 && js_timer_before(last, g_js_timer_heap[(index - 1) / 2])) {
+        js_timer_heap_up(index);
+    } else {
+        js_timer_heap_down(index);
+    }
+}
+
+/* ====================== 槽分配 ====================== */
+
+static int js_timer_grow(void)
+{
+    int capacity = g_js_timer_capacity > 0 ? g_js_timer_capacity * 2 : 64;
+    JsTimerEntry* timers;
+    int* free_slots;
+    int* heap;
 
+    if (capacity > JS_TIMER_SLOT_MASK + 1) {
+        capacity = JS_TIMER_SLOT_MASK + 1;
+    }
+    if (capacity <= g_js_timer_capacity) {
+        return -1;
+    }
+    timers = (JsTimerEntry*)realloc(g_js_timers, (size_t)capacity * sizeof(JsTimerEntry));
+    if (!timers) {
+        return -1;
+    }
+    g_js_timers = timers;
+    free_slots = (int*)realloc(g_js_timer_free, (size_t)capacity * sizeof(int));
+    if (!free_slots) {
+        return -1;
+    }
+    g_js_timer_free = free_slots;
+    heap = (int*)realloc(g_js_timer_heap, (size_t)capacity * sizeof(int));
+    if (!heap) {
+        return -1;
+    }
+    g_js_timer_heap = heap;
+
+    memset(&g_js_timers[g_js_timer_capacity], 0,
+           (size_t)(capacity - g_js_timer_capacity) * sizeof(JsTimerEntry));
+    // 倒序压栈，先分配低槽号
+    for (int slot = capacity - 1; slot >= g_js_timer_capacity; slot--) {
+        g_js_timer_free[g_js_timer_free_count++] = slot;
+    }
+    g_js_timer_capacity = capacity;
+    return 0;
+}
+
+static int js_timer_slot_of(int id)
+{
+    int slot = id & JS_TIMER_SLOT_MASK;
+    if (id <= 0 || slot >= g_js_timer_capacity || g_js_timers[slot].id != id) {
+        return -1;
+    }
+    return slot;
+}
+
+static void js_timer_release(JSContext* ctx, int slot)
+{
+    JsTimerEntry* timer = &g_js_timers[slot];
+    if (timer->heap_index >= 0) {
+        js_timer_heap_remove(slot);
+    }
+    JS_FreeValue(ctx, timer->func);
+    timer->func = JS_UNDEFINED;
+    timer->id = 0;
+    g_js_timer_free[g_js_timer_free_count++] = slot;
+}
+
+static JSValue js_timer_add(JSContext* ctx, int argc, JSValueConst* argv, int repeat)
+{
     int32_t delay = 0;
-    if (JS_ToInt32(ctx, &delay, argv[1])) {
+    int slot;
+    int gen;
+    JsTimerEntry* timer;
+
+    if (argc < 1 || !JS_IsFunction(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "not a function");
+    }
+    if (argc > 1 && JS_ToInt32(ctx, &delay, argv[1])) {
         return JS_EXCEPTION;
     }
     if (delay < 0) {
         delay = 0;
     }
+    if (repeat && delay < 1) {
+        delay = 1;  // 间隔为 0 会在同一次 js_timer_run 中反复触发
+    }
 
-    int id = js_timer_alloc_slot();
-    if (id < 0) {
+    if (g_js_timer_free_count == 0 && js_timer_grow() != 0) {
         return JS_ThrowInternalError(ctx, "too many timers");
     }
+    slot = g_js_timer_free[--g_js_timer_free_count];
+    timer = &g_js_timers[slot];
 
-    g_js_timers[id].active = 1;
-    g_js_timers[id].expire_ms = js_timer_now_ms() + delay;
-    g_js_timers[id].func = JS_DupValue(ctx, argv[0]);
-    return JS_NewInt32(ctx, id);
+    gen = (timer->gen + 1) & JS_TIMER_GEN_MASK;
+    if (gen == 0) {
+        gen = 1;
+    }
+    timer->gen = gen;
+    timer->id = (gen << JS_TIMER_SLOT_BITS) | slot;
+    timer->seq = g_js_timer_seq++;
+    timer->expire_ms = js_timer_now_ms() + delay;
+    timer->interval_ms = repeat ? delay : 0;
+    timer->func = JS_DupValue(ctx, argv[0]);
+    js_timer_heap_push(slot);
+    return JS_NewInt32(ctx, timer->id);
 }
 
+JSValue js_qjs_setTimeout(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    (void)this_val;
+    return js_timer_add(ctx, argc, argv, 0);
+}
+
+JSValue js_qjs_setInterval(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    (void)this_val;
+    return js_timer_add(ctx, argc, argv, 1);
+}
+
+// clearTimeout 与 clearInterval 共用：id 空间相同
 JSValue js_qjs_clearTimeout(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
 {
     (void)this_val;
@@ -104,13 +286,130 @@ JSValue js_qjs_clearTimeout(JSContext* ctx, JSValueConst this_val, int argc, JSV
         return JS_EXCEPTION;
     }
 
-    if (id >= 0 && id < MAX_JS_TIMERS && g_js_timers[id].active) {
-        JS_FreeValue(ctx, g_js_timers[id].func);
-        memset(&g_js_timers[id], 0, sizeof(g_js_timers[id]));
+    int slot = js_timer_slot_of(id);
+    if (slot >= 0) {
+        js_timer_release(ctx, slot);
+    }
+    return JS_UNDEFINED;
+}
+
+/* ====================== requestAnimationFrame ====================== */
+
+static int js_frame_list_push(JsFrameList* list, int id, JSValue func)
+{
+    if (list->count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 16;
+        JsFrameEntry* items = (JsFrameEntry*)realloc(list->items, (size_t)capacity * sizeof(JsFrameEntry));
+        if (!items) {
+            return -1;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count].id = id;
+    list->items[list->count].func = func;
+    list->count++;
+    return 0;
+}
+
+static void js_frame_list_clear(JSContext* ctx, JsFrameList* list)
+{
+    for (int i = 0; i < list->count; i++) {
+        if (ctx) {
+            JS_FreeValue(ctx, list->items[i].func);
+        }
+    }
+    list->count = 0;
+}
+
+static int js_frame_list_cancel(JSContext* ctx, JsFrameList* list, int id)
+{
+    for (int i = 0; i < list->count; i++) {
+        if (list->items[i].id == id) {
+            JS_FreeValue(ctx, list->items[i].func);
+            list->items[i].func = JS_UNDEFINED;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+JSValue js_qjs_requestAnimationFrame(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    (void)this_val;
+    if (argc < 1 || !JS_IsFunction(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "not a function");
+    }
+
+    if (g_js_frame_seq >= 0x7fffffff) {
+        g_js_frame_seq = 0;
+    }
+    int id = ++g_js_frame_seq;
+    JSValue func = JS_DupValue(ctx, argv[0]);
+    if (g_js_frames.count == 0 && g_js_frames_running.count == 0) {
+        // 空闲后的第一次请求：下一次 js_timer_run 就执行
+        g_js_frame_due = js_timer_now_ms();
+    }
+    if (js_frame_list_push(&g_js_frames, id, func) != 0) {
+        JS_FreeValue(ctx, func);
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    return JS_NewInt32(ctx, id);
+}
+
+JSValue js_qjs_cancelAnimationFrame(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+{
+    (void)this_val;
+    if (argc < 1) {
+        return JS_UNDEFINED;
+    }
+
+    int32_t id = 0;
+    if (JS_ToInt32(ctx, &id, argv[0])) {
+        return JS_EXCEPTION;
+    }
+    if (!js_frame_list_cancel(ctx, &g_js_frames, id)) {
+        js_frame_list_cancel(ctx, &g_js_frames_running, id);
     }
     return JS_UNDEFINED;
 }
 
+// 执行本帧的 rAF 回调；回调里再次请求的排到下一帧
+static int js_frame_run(JSContext* ctx, int64_t now)
+{
+    JsFrameList swap;
+    int fired = 0;
+
+    if (g_js_frames.count == 0 || now < g_js_frame_due) {
+        return 0;
+    }
+    swap = g_js_frames_running;
+    g_js_frames_running = g_js_frames;
+    g_js_frames = swap;
+    g_js_frame_due = now + JS_TIMER_FRAME_MS;
+
+    for (int i = 0; i < g_js_frames_running.count; i++) {
+        JSValue func = g_js_frames_running.items[i].func;
+        JSValue arg;
+        JSValue ret;
+
+        if (JS_IsUndefined(func)) {
+            continue;  // 已取消
+        }
+        g_js_frames_running.items[i].func = JS_UNDEFINED;
+        arg = JS_NewFloat64(ctx, (double)now);
+        ret = JS_Call(ctx, func, JS_UNDEFINED, 1, &arg);
+        JS_FreeValue(ctx, func);
+        if (JS_IsException(ret)) {
+            js_timer_dump_exception(ctx);
+        }
+        JS_FreeValue(ctx, ret);
+        fired++;
+    }
+    js_frame_list_clear(ctx, &g_js_frames_running);
+    return fired;
+}
+
 void js_timer_register_globals(JSContext* ctx)
 {
     JSValue global = JS_GetGlobalObject(ctx);
@@ -118,51 +417,122 @@ void js_timer_register_globals(JSContext* ctx)
                       JS_NewCFunction(ctx, js_qjs_setTimeout, "setTimeout", 2));
     JS_SetPropertyStr(ctx, global, "clearTimeout",
                       JS_NewCFunction(ctx, js_qjs_clearTimeout, "clearTimeout", 1));
+    JS_SetPropertyStr(ctx, global, "setInterval",
+                      JS_NewCFunction(ctx, js_qjs_setInterval, "setInterval", 2));
+    JS_SetPropertyStr(ctx, global, "clearInterval",
+                      JS_NewCFunction(ctx, js_qjs_clearTimeout, "clearInterval", 1));
+    JS_SetPropertyStr(ctx, global, "requestAnimationFrame",
+                      JS_NewCFunction(ctx, js_qjs_requestAnimationFrame, "requestAnimationFrame", 1));
+    JS_SetPropertyStr(ctx, global, "cancelAnimationFrame",
+                      JS_NewCFunction(ctx, js_qjs_cancelAnimationFrame, "cancelAnimationFrame", 1));
     JS_FreeValue(ctx, global);
 }
 
-void js_timer_run(JSContext* ctx)
+int js_timer_run(JSContext* ctx)
 {
+    int fired = 0;
+    uint32_t limit;
+    int64_t now;
+
     if (!ctx) {
-        return;
+        return 0;
     }
 
-    int64_t now = js_timer_now_ms();
-    for (int i = 0; i < MAX_JS_TIMERS; i++) {
-        if (!g_js_timers[i].active) {
-            continue;
-        }
-        if (g_js_timers[i].expire_ms > now) {
-            continue;
+    now = js_timer_now_ms();
+    // 本次运行期间新建的定时器（含重新排期的 interval）留到下一次
+    limit = g_js_timer_seq;
+    while (g_js_timer_heap_count > 0) {
+        int slot = g_js_timer_heap[0];
+        JsTimerEntry* timer = &g_js_timers[slot];
+        JSValue func;
+        JSValue ret;
+
+        if (timer->expire_ms > now || (int32_t)(timer->seq - limit) >= 0) {
+            break;
         }
 
-        JSValue func = JS_DupValue(ctx, g_js_timers[i].func);
-        g_js_timers[i].active = 0;
-        JS_FreeValue(ctx, g_js_timers[i].func);
-        memset(&g_js_timers[i], 0, sizeof(g_js_timers[i]));
+        func = JS_DupValue(ctx, timer->func);
+        if (timer->interval_ms > 0) {
+            // 按原节拍补齐；落后超过一个周期（如主循环长时间阻塞）则从现在重新计时
+            timer->expire_ms += timer->interval_ms;
+            if (timer->expire_ms <= now) {
+                timer->expire_ms = now + timer->interval_ms;
+            }
+            timer->seq = g_js_timer_seq++;
+            js_timer_heap_down(0);
+        } else {
+            js_timer_release(ctx, slot);
+        }
 
-        JSValue ret = JS_Call(ctx, func, JS_UNDEFINED, 0, NULL);
+        ret = JS_Call(ctx, func, JS_UNDEFINED, 0, NULL);
         JS_FreeValue(ctx, func);
         if (JS_IsException(ret)) {
             js_timer_dump_exception(ctx);
         }
         JS_FreeValue(ctx, ret);
+        fired++;
     }
+
+    fired += js_frame_run(ctx, now);
+    return fired;
 }
 
-void js_timer_clear_all(JSContext* ctx)
+int js_timer_next_deadline(void)
 {
-    if (!ctx) {
-        memset(g_js_timers, 0, sizeof(g_js_timers));
-        g_js_timer_seq = 0;
-        return;
+    int64_t now;
+    int64_t best = -1;
+
+    if (g_js_timer_heap_count == 0 && g_js_frames.count == 0) {
+        return -1;
+    }
+    now = js_timer_now_ms();
+    if (g_js_timer_heap_count > 0) {
+        best = g_js_timers[g_js_timer_heap[0]].expire_ms - now;
+    }
+    if (g_js_frames.count > 0) {
+        int64_t frame = g_js_frame_due - now;
+        if (best < 0 || frame < best) {
+            best = frame;
+        }
+    }
+    if (best < 0) {
+        best = 0;
     }
+    if (best > 0x7fffffff) {
+        best = 0x7fffffff;
+    }
+    return (int)best;
+}
+
+int js_timer_count(void)
+{
+    return g_js_timer_heap_count;
+}
 
-    for (int i = 0; i < MAX_JS_TIMERS; i++) {
-        if (g_js_timers[i].active) {
-            JS_FreeValue(ctx, g_js_timers[i].func);
+void js_timer_clear_all(JSContext* ctx)
+{
+    for (int slot = 0; slot < g_js_timer_capacity; slot++) {
+        if (g_js_timers[slot].id != 0 && ctx) {
+            JS_FreeValue(ctx, g_js_timers[slot].func);
         }
     }
-    memset(g_js_timers, 0, sizeof(g_js_timers));
+    js_frame_list_clear(ctx, &g_js_frames);
+    js_frame_list_clear(ctx, &g_js_frames_running);
+    free(g_js_frames.items);
+    free(g_js_frames_running.items);
+    memset(&g_js_frames, 0, sizeof(g_js_frames));
+    memset(&g_js_frames_running, 0, sizeof(g_js_frames_running));
+
+    free(g_js_timers);
+    free(g_js_timer_free);
+    free(g_js_timer_heap);
+    g_js_timers = NULL;
+    g_js_timer_free = NULL;
+    g_js_timer_heap = NULL;
+    g_js_timer_capacity = 0;
+    g_js_timer_free_count = 0;
+    g_js_timer_heap_count = 0;
     g_js_timer_seq = 0;
+    g_js_frame_seq = 0;
+    g_js_frame_due = 0;
 }
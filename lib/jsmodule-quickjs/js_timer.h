@@ -7,8 +7,15 @@
 extern "C" {
 #endif
 
+/* 注册 setTimeout/clearTimeout、setInterval/clearInterval、
+   requestAnimationFrame/cancelAnimationFrame */
 void js_timer_register_globals(JSContext* ctx);
-void js_timer_run(JSContext* ctx);
+/* 执行到期定时器和到点的 rAF 回调，返回本次触发的回调数 */
+int js_timer_run(JSContext* ctx);
+/* 距最早定时器或下一帧 rAF 的毫秒数（已到期为 0），都没有返回 -1 */
+int js_timer_next_deadline(void);
+/* 未触发的 setTimeout/setInterval 数 */
+int js_timer_count(void);
 void js_timer_clear_all(JSContext* ctx);
 
 #ifdef __cplusplus
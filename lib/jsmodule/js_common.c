@@ -4,6 +4,8 @@
 #include "../../src/backend.h"
 #include "../../src/layout.h"
 #include "../../src/log.h"
+#include "../../src/damage.h"
+#include "../../src/layer_update.h"
 
 #include "event.h"
 
@@ -75,10 +77,20 @@ void js_module_set_button_style(Layer* layer, const char* bg_color)
             layer->bg_color.g = (hex_to_int(bg_color[3]) * 16 + hex_to_int(bg_color[4]));
             layer->bg_color.b = (hex_to_int(bg_color[5]) * 16 + hex_to_int(bg_color[6]));
             layer->bg_color.a = 255;
+            mark_layer_dirty(layer, DIRTY_COLOR);
         }
     }
 }
 
+/* JS 设置器都经 mark_layer_dirty 记脏；回调里剩下的直接写字段（组件原生 API 等）
+   只作用于事件图层，处理器确实执行过才补记该图层区域 */
+static void js_event_damage(Layer* layer, int rc)
+{
+    if (rc == 0) {
+        damage_add_layer(layer, DIRTY_NONE);
+    }
+}
+
 static void js_layer_resize_handler(Layer* layer, const ResizeEvent* event);
 
 int js_module_set_layer_event(Layer* layer, const char* event_name, const char* event_func_name, EventHandler event_handler)
@@ -162,24 +174,30 @@ static void* js_module_common_event(void* data)
     /* 指针手势（touch / mouse drag）优先走 touch_name → onTouch(layerId, event) */
     if (get_current_pointer_event() && layer->event->touch_name[0] != '\0') {
         const char* name = layer->event->touch_name;
-        if (js_module_trigger_event(name, layer) != 0) {
+        int rc = js_module_trigger_event(name, layer);
+        if (rc != 0) {
             char full_name[256];
             snprintf(full_name, sizeof(full_name), "%s.%s", layer->id, name);
-            if (js_module_trigger_event(full_name, layer) != 0) {
-                js_module_call_event(name, layer);
+            rc = js_module_trigger_event(full_name, layer);
+            if (rc != 0) {
+                rc = js_module_call_event(name, layer);
             }
         }
+        js_event_damage(layer, rc);
         return NULL;
     }
     if (layer->event->click_name[0] != '\0') {
         const char* name = layer->event->click_name;
-        if (js_module_trigger_event(name, layer) != 0) {
+        int rc = js_module_trigger_event(name, layer);
+        if (rc != 0) {
             char full_name[256];
             snprintf(full_name, sizeof(full_name), "%s.%s", layer->id, name);
-            if (js_module_trigger_event(full_name, layer) != 0) {
-                js_module_call_event(name, layer);
+            rc = js_module_trigger_event(full_name, layer);
+            if (rc != 0) {
+                rc = js_module_call_event(name, layer);
             }
         }
+        js_event_damage(layer, rc);
     }
     return NULL;
 }
@@ -190,7 +208,7 @@ static void* js_module_click_event(void* data)
     Layer* layer = (Layer*)data;
     if (layer) {
         printf("JS: Click event on layer '%s'\n", layer->id);
-        js_module_call_layer_event(layer->id, "onClick");
+        js_event_damage(layer, js_module_call_layer_event(layer->id, "onClick"));
     }
     return NULL;
 }
@@ -201,7 +219,7 @@ static void* js_module_press_event(void* data)
     Layer* layer = (Layer*)data;
     if (layer) {
         printf("JS: Press event on layer '%s'\n", layer->id);
-        js_module_call_layer_event(layer->id, "onPress");
+        js_event_damage(layer, js_module_call_layer_event(layer->id, "onPress"));
     }
     return NULL;
 }
@@ -212,7 +230,7 @@ static void* js_module_scroll_event(void* data)
     Layer* layer = (Layer*)data;
     if (layer) {
         printf("JS: Scroll event on layer '%s'\n", layer->id);
-        js_module_call_layer_event(layer->id, "onScroll");
+        js_event_damage(layer, js_module_call_layer_event(layer->id, "onScroll"));
     }
     return NULL;
 }
@@ -223,7 +241,7 @@ static void* js_module_touch_event(void* data)
     Layer* layer = (Layer*)data;
     if (layer) {
         // printf("JS: Touch event on layer '%s'\n", layer->id);
-        js_module_call_layer_event(layer->id, "onTouch");
+        js_event_damage(layer, js_module_call_layer_event(layer->id, "onTouch"));
     }
     return NULL;
 }
@@ -234,7 +252,7 @@ static void* js_module_change_event(void* data)
     Layer* layer = (Layer*)data;
     if (layer) {
         printf("JS: Change event on layer '%s'\n", layer->id);
-        js_module_call_layer_event(layer->id, "onChange");
+        js_event_damage(layer, js_module_call_layer_event(layer->id, "onChange"));
     }
     return NULL;
 }
@@ -251,9 +269,9 @@ static void js_layer_resize_handler(Layer* layer, const ResizeEvent* event)
     layer_set_text(layer, payload);
 
     if (layer->event && layer->event->resize_name[0] != '\0') {
-        js_module_call_event(layer->event->resize_name, layer);
+        js_event_damage(layer, js_module_call_event(layer->event->resize_name, layer));
     } else {
-        js_module_call_layer_event(layer->id, "onResize");
+        js_event_damage(layer, js_module_call_layer_event(layer->id, "onResize"));
     }
 }
 
@@ -612,7 +630,7 @@ static void layer_lifecycle_js_dispatch(Layer* layer, const char* event_type)
     if (handler_name) {
         strncpy(handler_buf, handler_name, sizeof(handler_buf) - 1);
         handler_buf[sizeof(handler_buf) - 1] = '\0';
-        js_module_call_event(handler_buf, layer);
+        js_event_damage(layer, js_module_call_event(handler_buf, layer));
         return;
     }
 
@@ -623,7 +641,7 @@ static void layer_lifecycle_js_dispatch(Layer* layer, const char* event_type)
         strncpy(event_name, event_type, sizeof(event_name) - 1);
         event_name[sizeof(event_name) - 1] = '\0';
     }
-    js_module_trigger_event(event_name, layer);
+    js_event_damage(layer, js_module_trigger_event(event_name, layer));
 }
 
 // 扫描并注册事件（从 events 或 event 对象）
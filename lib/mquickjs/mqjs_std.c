@@ -221,8 +221,9 @@ static void run_timers(JSContext *ctx)
 }
 
 /* 宿主(js_module / UI 主循环)周期性调用：非阻塞，仅执行到期定时器。 */
-void js_run_timers(JSContext *ctx)
+int js_run_timers(JSContext *ctx)
 {
+    int fired = 0;
     int64_t cur_time = get_time_ms();
     for (int i = 0; i < MAX_TIMERS; i++) {
         JSTimer *th = &js_timer_list[i];
@@ -233,12 +234,35 @@ void js_run_timers(JSContext *ctx)
             JS_PushArg(ctx, JS_NULL);
             JS_DeleteGCRef(ctx, &th->func);
             th->allocated = FALSE;
+            fired++;
             if (JS_IsException(JS_Call(ctx, 0))) {
             fail:
                 dump_error(ctx);
             }
         }
     }
+    return fired;
+}
+
+/* 距最早定时器到期的毫秒数（已到期为 0），没有定时器返回 -1 */
+int js_next_timer_delay(JSContext *ctx)
+{
+    int64_t best = -1;
+    int64_t cur_time = get_time_ms();
+    (void)ctx;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        JSTimer *th = &js_timer_list[i];
+        if (th->allocated) {
+            int64_t delay = th->timeout - cur_time;
+            if (delay < 0)
+                delay = 0;
+            if (best < 0 || delay < best)
+                best = delay;
+        }
+    }
+    if (best > 0x7fffffff)
+        best = 0x7fffffff;
+    return (int)best;
 }
 
 /* stdlib ROM table: 32-bit targets (JS_PTR64 undefined) use the
@@ -301,8 +301,10 @@ JSValue JS_Eval(JSContext *ctx, const char *input, size_t input_len,
                 const char *filename, int eval_flags);
 void JS_GC(JSContext *ctx);
 /* 宿主周期性调用以执行到期定时器（setTimeout/clearTimeout），
- * 非阻塞；由 js_module_pump_timers 间接驱动。 */
-void js_run_timers(JSContext *ctx);
+ * 非阻塞；由 js_module_pump_timers 间接驱动。返回本次触发的回调数。 */
+int js_run_timers(JSContext *ctx);
+/* 距最早定时器到期的毫秒数（已到期为 0），没有定时器返回 -1；供主循环决定休眠时长 */
+int js_next_timer_delay(JSContext *ctx);
 JSValue JS_NewStringLen(JSContext *ctx, const char *buf, size_t buf_len);
 JSValue JS_NewString(JSContext *ctx, const char *buf);
 const char *JS_ToCStringLen(JSContext *ctx, size_t *plen, JSValue val, JSCStringBuf *buf);
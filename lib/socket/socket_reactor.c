@@ -0,0 +1,446 @@
+#include "socket_reactor.h"
+#include "socket.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+typedef WSAPOLLFD SocketReactorPollFd;
+#define socket_reactor_os_poll(fds, n, timeout) WSAPoll((fds), (ULONG)(n), (timeout))
+#else
+#include <poll.h>
+typedef struct pollfd SocketReactorPollFd;
+#define socket_reactor_os_poll(fds, n, timeout) poll((fds), (nfds_t)(n), (timeout))
+#endif
+
+// 后台等待线程只在有 pthread 与 pipe 的平台上启用
+#if !defined(WIN32) && !defined(ESP_PLATFORM)
+#define SOCKET_REACTOR_THREAD 1
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#else
+#define SOCKET_REACTOR_THREAD 0
+#endif
+
+typedef struct {
+    int fd;
+    int events;
+    unsigned int gen;   // 同一 fd 取消后重新关注时区分新旧
+    SocketReactorCallback callback;
+    void* opaque;
+} SocketReactorEntry;
+
+typedef struct {
+    int fd;
+    int events;
+    unsigned int gen;
+} SocketReactorReady;
+
+// g_entries 与 g_pollfds 下标一一对应；只有主线程修改，修改时持锁供后台线程拷贝
+static SocketReactorEntry* g_entries = NULL;
+static SocketReactorPollFd* g_pollfds = NULL;
+static SocketReactorReady* g_ready = NULL;
+static int g_count = 0;
+static int g_capacity = 0;
+static unsigned int g_gen = 0;
+static int g_dispatching = 0;
+
+#if SOCKET_REACTOR_THREAD
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t g_thread;
+static int g_thread_running = 0;
+static int g_wake_pipe[2] = {-1, -1};
+// 以下由 g_lock 保护
+static SocketReactorWaker g_waker = NULL;
+static int g_armed = 0;   // 主线程已处理完，可以再次唤醒
+static int g_quit = 0;
+#endif
+
+static void socket_reactor_lock(void)
+{
+#if SOCKET_REACTOR_THREAD
+    if (g_thread_running) {
+        pthread_mutex_lock(&g_lock);
+    }
+#endif
+}
+
+static void socket_reactor_unlock(void)
+{
+#if SOCKET_REACTOR_THREAD
+    if (g_thread_running) {
+        pthread_mutex_unlock(&g_lock);
+    }
+#endif
+}
+
+// 关注集合变化：让阻塞中的后台线程重新拷贝
+static void socket_reactor_notify(void)
+{
+#if SOCKET_REACTOR_THREAD
+    if (g_thread_running) {
+        char c = 1;
+        ssize_t n = write(g_wake_pipe[1], &c, 1);
+        (void)n;   // 管道满说明已有未处理的通知
+    }
+#endif
+}
+
+static short socket_reactor_poll_events(int events)
+{
+    short out = 0;
+    if (events & SOCKET_REACTOR_READ) {
+        out |= POLLIN;
+    }
+    if (events & SOCKET_REACTOR_WRITE) {
+        out |= POLLOUT;
+    }
+    return out;
+}
+
+static int socket_reactor_find(int fd)
+{
+    for (int i = 0; i < g_count; i++) {
+        if (g_entries[i].fd == fd) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void socket_reactor_set_pollfd(int index)
+{
+    SocketReactorEntry* entry = &g_entries[index];
+    // 不关注任何事件的 fd 用负值让 poll 跳过
+    g_pollfds[index].fd = entry->events ? entry->fd : -1;
+    g_pollfds[index].events = socket_reactor_poll_events(entry->events);
+    g_pollfds[index].revents = 0;
+}
+
+static int socket_reactor_grow(void)
+{
+    int capacity = g_capacity > 0 ? g_capacity * 2 : 8;
+    SocketReactorEntry* entries;
+    SocketReactorPollFd* pollfds;
+    SocketReactorReady* ready;
+
+    entries = (SocketReactorEntry*)realloc(g_entries, (size_t)capacity * sizeof(SocketReactorEntry));
+    if (!entries) {
+        return -1;
+    }
+    g_entries = entries;
+    pollfds = (SocketReactorPollFd*)realloc(g_pollfds, (size_t)capacity * sizeof(SocketReactorPollFd));
+    if (!pollfds) {
+        return -1;
+    }
+    g_pollfds = pollfds;
+    ready = (SocketReactorReady*)realloc(g_ready, (size_t)capacity * sizeof(SocketReactorReady));
+    if (!ready) {
+        return -1;
+    }
+    g_ready = ready;
+    g_capacity = capacity;
+    return 0;
+}
+
+int socket_reactor_watch(int fd, int events, SocketReactorCallback callback, void* opaque)
+{
+    int index;
+
+    if (fd < 0 || !callback) {
+        return -1;
+    }
+
+    socket_reactor_lock();
+    index = socket_reactor_find(fd);
+    if (index < 0) {
+        // 分派循环每次按下标重新取 g_ready，回调里扩容也安全
+        if (g_count == g_capacity && socket_reactor_grow() != 0) {
+            socket_reactor_unlock();
+            return -1;
+        }
+        index = g_count++;
+        g_entries[index].fd = fd;
+        g_entries[index].gen = ++g_gen;
+    }
+    g_entries[index].events = events & (SOCKET_REACTOR_READ | SOCKET_REACTOR_WRITE);
+    g_entries[index].callback = callback;
+    g_entries[index].opaque = opaque;
+    socket_reactor_set_pollfd(index);
+    socket_reactor_unlock();
+
+    socket_reactor_notify();
+    return 0;
+}
+
+int socket_reactor_modify(int fd, int events)
+{
+    int index;
+
+    socket_reactor_lock();
+    index = socket_reactor_find(fd);
+    if (index >= 0) {
+        g_entries[index].events = events & (SOCKET_REACTOR_READ | SOCKET_REACTOR_WRITE);
+        socket_reactor_set_pollfd(index);
+    }
+    socket_reactor_unlock();
+
+    if (index < 0) {
+        return -1;
+    }
+    socket_reactor_notify();
+    return 0;
+}
+
+void socket_reactor_unwatch(int fd)
+{
+    int index;
+
+    socket_reactor_lock();
+    index = socket_reactor_find(fd);
+    if (index >= 0) {
+        g_count--;
+        if (index != g_count) {
+            g_entries[index] = g_entries[g_count];
+            g_pollfds[index] = g_pollfds[g_count];
+        }
+    }
+    socket_reactor_unlock();
+
+    if (index >= 0) {
+        socket_reactor_notify();
+    }
+}
+
+int socket_reactor_count(void)
+{
+    return g_count;
+}
+
+// 主线程处理完一轮，允许后台线程再次唤醒
+static void socket_reactor_arm(void)
+{
+#if SOCKET_REACTOR_THREAD
+    if (!g_thread_running) {
+        return;
+    }
+    pthread_mutex_lock(&g_lock);
+    if (!g_armed) {
+        g_armed = 1;
+        pthread_cond_signal(&g_cond);
+    }
+    pthread_mutex_unlock(&g_lock);
+#endif
+}
+
+int socket_reactor_poll(int timeout_ms)
+{
+    int ready_count = 0;
+    int fired = 0;
+
+    if (g_dispatching) {
+        return 0;
+    }
+    if (g_count == 0) {
+        socket_reactor_arm();
+        return 0;
+    }
+
+    if (socket_reactor_os_poll(g_pollfds, g_count, timeout_ms) > 0) {
+        for (int i = 0; i < g_count; i++) {
+            short revents = g_pollfds[i].revents;
+            int events = 0;
+
+            if (!revents) {
+                continue;
+            }
+            if (revents & POLLIN) {
+                events |= SOCKET_REACTOR_READ;
+            }
+            if (revents & POLLOUT) {
+                events |= SOCKET_REACTOR_WRITE;
+            }
+            if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                events |= SOCKET_REACTOR_ERROR;
+            }
+            g_ready[ready_count].fd = g_entries[i].fd;
+            g_ready[ready_count].events = events;
+            g_ready[ready_count].gen = g_entries[i].gen;
+            ready_count++;
+            // fd 已关闭却没取消关注：移除，否则每轮都会立即返回
+            if (revents & POLLNVAL) {
+                g_ready[ready_count - 1].gen = 0;
+            }
+        }
+    }
+
+    g_dispatching = 1;
+    for (int i = 0; i < ready_count; i++) {
+        int index = socket_reactor_find(g_ready[i].fd);
+        SocketReactorEntry entry;
+
+        if (index < 0) {
+            continue;   // 前面的回调取消了它
+        }
+        entry = g_entries[index];
+        if (g_ready[i].gen == 0) {
+            socket_reactor_unwatch(entry.fd);
+        } else if (entry.gen != g_ready[i].gen) {
+            continue;   // 取消后又重新关注，属于下一轮
+        }
+        entry.callback(entry.fd, g_ready[i].events, entry.opaque);
+        fired++;
+    }
+    g_dispatching = 0;
+
+    socket_reactor_arm();
+    return fired;
+}
+
+#if SOCKET_REACTOR_THREAD
+static void* socket_reactor_thread_main(void* arg)
+{
+    SocketReactorPollFd* fds = NULL;
+    int capacity = 0;
+
+    (void)arg;
+    pthread_mutex_lock(&g_lock);
+    while (!g_quit) {
+        int n;
+        int any = 0;
+
+        if (!g_armed) {
+            pthread_cond_wait(&g_cond, &g_lock);
+            continue;
+        }
+
+        n = g_count + 1;
+        if (n > capacity) {
+            SocketReactorPollFd* grown = (SocketReactorPollFd*)realloc(fds, (size_t)n * sizeof(SocketReactorPollFd));
+            if (!grown) {
+                break;
+            }
+            fds = grown;
+            capacity = n;
+        }
+        fds[0].fd = g_wake_pipe[0];
+        fds[0].events = POLLIN;
+        // 逐字段拷贝：主线程的 poll 可能正在写 revents
+        for (int i = 0; i < g_count; i++) {
+            fds[i + 1].fd = g_pollfds[i].fd;
+            fds[i + 1].events = g_pollfds[i].events;
+        }
+        pthread_mutex_unlock(&g_lock);
+
+        if (socket_reactor_os_poll(fds, n, -1) > 0) {
+            if (fds[0].revents) {
+                char buf[64];
+                while (read(g_wake_pipe[0], buf, sizeof(buf)) > 0) {
+                }
+            }
+            for (int i = 1; i < n; i++) {
+                if (fds[i].revents) {
+                    any = 1;
+                    break;
+                }
+            }
+        }
+
+        pthread_mutex_lock(&g_lock);
+        if (any && g_armed && !g_quit && g_waker) {
+            SocketReactorWaker waker = g_waker;
+            g_armed = 0;
+            pthread_mutex_unlock(&g_lock);
+            waker();
+            pthread_mutex_lock(&g_lock);
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+    free(fds);
+    return NULL;
+}
+
+static void socket_reactor_stop_thread(void)
+{
+    if (!g_thread_running) {
+        return;
+    }
+    pthread_mutex_lock(&g_lock);
+    g_quit = 1;
+    g_waker = NULL;
+    pthread_cond_signal(&g_cond);
+    pthread_mutex_unlock(&g_lock);
+    socket_reactor_notify();
+    pthread_join(g_thread, NULL);
+
+    g_thread_running = 0;
+    close(g_wake_pipe[0]);
+    close(g_wake_pipe[1]);
+    g_wake_pipe[0] = -1;
+    g_wake_pipe[1] = -1;
+}
+#endif
+
+int socket_reactor_set_waker(SocketReactorWaker waker)
+{
+#if SOCKET_REACTOR_THREAD
+    if (!waker) {
+        socket_reactor_stop_thread();
+        return 0;
+    }
+    if (g_thread_running) {
+        pthread_mutex_lock(&g_lock);
+        g_waker = waker;
+        pthread_mutex_unlock(&g_lock);
+        return 0;
+    }
+
+    if (pipe(g_wake_pipe) != 0) {
+        return -1;
+    }
+    fcntl(g_wake_pipe[0], F_SETFL, fcntl(g_wake_pipe[0], F_GETFL, 0) | O_NONBLOCK);
+    fcntl(g_wake_pipe[1], F_SETFL, fcntl(g_wake_pipe[1], F_GETFL, 0) | O_NONBLOCK);
+    g_waker = waker;
+    g_armed = 1;
+    g_quit = 0;
+    if (pthread_create(&g_thread, NULL, socket_reactor_thread_main, NULL) != 0) {
+        close(g_wake_pipe[0]);
+        close(g_wake_pipe[1]);
+        g_wake_pipe[0] = -1;
+        g_wake_pipe[1] = -1;
+        g_waker = NULL;
+        return -1;
+    }
+    g_thread_running = 1;
+    return 0;
+#else
+    (void)waker;
+    return -1;
+#endif
+}
+
+int socket_reactor_has_waker(void)
+{
+#if SOCKET_REACTOR_THREAD
+    return g_thread_running;
+#else
+    return 0;
+#endif
+}
+
+void socket_reactor_shutdown(void)
+{
+#if SOCKET_REACTOR_THREAD
+    socket_reactor_stop_thread();
+#endif
+    free(g_entries);
+    free(g_pollfds);
+    free(g_ready);
+    g_entries = NULL;
+    g_pollfds = NULL;
+    g_ready = NULL;
+    g_count = 0;
+    g_capacity = 0;
+}
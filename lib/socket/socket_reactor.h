@@ -0,0 +1,42 @@
+#ifndef SOCKET_REACTOR_H
+#define SOCKET_REACTOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 基于 poll 的就绪分派：回调都在调用 socket_reactor_poll 的线程（主循环）执行。
+   设置了唤醒函数时，后台线程代为阻塞等待，fd 就绪后调用唤醒函数让主循环醒来，
+   主循环处理完（下一次 socket_reactor_poll）前不会重复唤醒。 */
+
+#define SOCKET_REACTOR_READ 1
+#define SOCKET_REACTOR_WRITE 2
+#define SOCKET_REACTOR_ERROR 4   // 出错、对端挂断或 fd 已失效
+
+typedef void (*SocketReactorCallback)(int fd, int events, void* opaque);
+typedef void (*SocketReactorWaker)(void);
+
+// 关注 fd 的 events（READ/WRITE 组合）；已关注则替换。返回 0 成功
+int socket_reactor_watch(int fd, int events, SocketReactorCallback callback, void* opaque);
+// 只改关注的事件，未关注返回 -1
+int socket_reactor_modify(int fd, int events);
+void socket_reactor_unwatch(int fd);
+int socket_reactor_count(void);
+
+/* 等待最多 timeout_ms（0 不等待，-1 无限）并分派就绪事件，返回分派的回调数。
+   回调里可以关注/取消任意 fd，被取消的 fd 本轮不再分派。 */
+int socket_reactor_poll(int timeout_ms);
+
+/* 设置唤醒函数（须线程安全）并按需启动后台等待线程；NULL 停止。
+   返回 0 表示后台等待可用，-1 表示平台不支持（调用者需自行轮询）。 */
+int socket_reactor_set_waker(SocketReactorWaker waker);
+int socket_reactor_has_waker(void);
+
+// 停止后台线程并清空所有关注
+void socket_reactor_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
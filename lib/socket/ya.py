@@ -9,6 +9,7 @@ set_kind("static")
 add_flags()
 add_files(
     'socket.c',
+    'socket_reactor.c',
 ) 
 add_includedirs('.')
 add_cflags(' -I.')
@@ -1,4 +1,5 @@
 #include "animate.h"
+#include "damage.h"
 
 #include <math.h>
 
@@ -121,6 +122,7 @@ void animation_start(Layer* layer, Animation* animation) {
     
     // 将动画附加到图层
     layer->animation = animation;
+    damage_add_full();
 }
 
 // 停止动画
@@ -144,6 +146,7 @@ void animation_stop(Layer* layer) {
     // 释放动画资源
     free(layer->animation);
     layer->animation = NULL;
+    damage_add_full();
 }
 
 // 暂停动画
@@ -165,6 +168,7 @@ void animation_resume(Layer* layer) {
     
     if (layer->animation->state == ANIMATION_STATE_PAUSED) {
         layer->animation->state = ANIMATION_STATE_RUNNING;
+        damage_add_full();
     }
 }
 
@@ -181,6 +185,9 @@ void animation_update(Layer* layer, float delta_time) {
         return;
     }
     
+    /* 动画会移动/缩放图层，运行期间持续整屏重绘，保证下一帧仍会走到这里 */
+    damage_add_full();
+
     // 更新动画进度
     animation->progress += delta_time / animation->duration;
     
@@ -12,9 +12,26 @@ int backend_init();
 void backend_quit();
 Texture* backend_load_texture(char* path);
 Texture* backend_load_texture_from_base64(const char* base64_data, size_t data_len);
+/* 共享图片纹理：按 (路径, 目标尺寸) 引用计数，同一张图只解码上传一次。
+   max_w/max_h 为逻辑像素，>0 时解码后缩小到刚好覆盖该尺寸，0 为原图。
+   SDL 后端在后台线程解码，就绪前 backend_image_texture 返回 NULL，
+   就绪时整屏记脏；其它后端同步加载。 */
+typedef struct BackendImage BackendImage;
+BackendImage* backend_image_acquire(const char* path, int max_w, int max_h);
+void backend_image_release(BackendImage* image);
+Texture* backend_image_texture(BackendImage* image);
+int backend_image_failed(BackendImage* image);
+// 引用归零后仍保留的纹理字节上限
+void backend_image_set_budget(size_t bytes);
 Texture* backend_render_texture(DFont* font,const char* text,Color color);
 /* Measure text width in layout pixels without creating a render texture. */
 int backend_measure_text_width(DFont* font, const char* text);
+/* 文本尺寸（逻辑像素），与 backend_render_text 的排版一致；失败返回 -1 */
+int backend_text_size(DFont* font, const char* text, int* w, int* h);
+/* 把文本画进 dst（逻辑坐标，dst 与 backend_text_size 不同则缩放）。
+   SDL 后端走字形图集：字形只光栅化一次，文本变化不产生新纹理；
+   其它后端经 backend_render_texture 绘制。 */
+void backend_render_text(DFont* font, const char* text, Color color, const Rect* dst);
 void backend_render_fill_rect(Rect* rect,Color color);
 void backend_render_rect(Rect* rect,Color color);
 void backend_render_rect_color(Rect* rect,unsigned char r,unsigned char g,unsigned char b,unsigned char a);
@@ -43,6 +60,16 @@ void backend_render_texture_tinted(Texture* texture,
                                    const Rect* srcrect,
                                    const Rect* dstrect,
                                    Color tint);
+/* 顶点批量绘制：布局与 SDL_Vertex 一致（屏幕坐标、顶点色、0~1 纹理坐标），
+   texture 为 NULL 时画纯色三角形。vertex_count 为 0 时只探测是否支持；
+   不支持的后端返回 -1，调用方退回逐个 copy / fill_rect。 */
+typedef struct BackendVertex {
+    float x, y;
+    Color color;
+    float u, v;
+} BackendVertex;
+int backend_render_geometry(Texture* texture, const BackendVertex* vertices, int vertex_count,
+                            const int* indices, int index_count);
 
 void backend_render_fill_rect_color(Rect* rect,unsigned char r,unsigned char g,unsigned char b,unsigned char a);
 
@@ -73,11 +100,22 @@ int backend_query_texture(Texture * texture,
 // 主循环回调类型
 typedef void (*UpdateCallback)(void);
 typedef void (*ResizeCallback)(Layer* root, int width, int height);
+// 距下次需要执行的毫秒数：0 表示立即，<0 表示没有待办
+typedef int (*UpdateDeadlineCallback)(void);
 
 // 注册主循环更新回调（每帧调用）
 void backend_register_update_callback(UpdateCallback callback);
+
+/* 为更新回调登记到期查询；事件驱动的主循环据此决定可以阻塞多久。
+   未登记的回调按帧间隔轮询。 */
+void backend_set_update_deadline(UpdateCallback callback, UpdateDeadlineCallback deadline);
+UpdateDeadlineCallback backend_get_update_deadline(UpdateCallback callback);
 void backend_set_resize_callback(ResizeCallback callback);
 
+/* 线程安全：唤醒阻塞等待中的主循环跑一轮（事件、update 回调、渲染），
+   供后台线程在 I/O 就绪时调用；多次调用在主循环处理前只生效一次。 */
+void backend_wake(void);
+
 void backend_render_rounded_rect(Rect* rect, Color color, int radius);
 void backend_render_rounded_rect_color(Rect* rect, unsigned char r, unsigned char g, unsigned char b, unsigned char a, int radius);
 void backend_render_rounded_rect_with_border(Rect* rect, Color bg_color, int radius, int border_width, Color border_color);
@@ -117,6 +155,11 @@ void backend_set_window_icon(const char* path);
 void backend_set_font_fallback_path(const char* path);
 int backend_has_font_fallback(void);
 
+// 字形图集开关（SDL 后端，默认开启；0 退回逐字符串纹理，用于对比），
+// 也可用环境变量 YUI_GLYPH_ATLAS=0 关闭
+void backend_set_glyph_atlas(int on);
+int backend_glyph_atlas_enabled(void);
+
 // 文本纹理缓存：预热 / 固定 / 失效（SDL 后端）
 void backend_texture_cache_invalidate(void);
 void backend_texture_cache_pin(DFont* font, const char* text, Color color);
@@ -125,6 +168,13 @@ void backend_texture_cache_warmup(DFont* font, const char** texts, int count, Co
 // 截取当前 UI 为 PNG（桌面 SDL；失败返回负值）
 int backend_screenshot(const char* path);
 
+// 离屏渲染目标：创建可作为渲染目标的透明纹理（不支持的后端返回 NULL），
+// begin/end 之间的绘制落到该纹理（坐标从纹理左上角起），不可嵌套；
+// 用 backend_render_text_destroy 释放
+Texture* backend_create_target_texture(int w, int h);
+int backend_begin_render_to_texture(Texture* target);
+void backend_end_render_to_texture(void);
+
 // 设置当前 UI 根图层（在 backend_run 之前即可截图）
 void backend_set_ui_root(Layer* root);
 
@@ -1,6 +1,7 @@
 #include "backend_common.h"
 #include "../backend.h"
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 typedef struct {
@@ -71,6 +72,16 @@ void backend_render_bezier_cubic(int x0, int y0,
 static Rect g_clip_stack[BACKEND_CLIP_STACK_MAX];
 static int g_clip_depth = 0;
 
+#define BACKEND_MAX_UPDATE_DEADLINES 16
+
+typedef struct {
+    UpdateCallback callback;
+    UpdateDeadlineCallback deadline;
+} UpdateDeadlineEntry;
+
+static UpdateDeadlineEntry g_update_deadlines[BACKEND_MAX_UPDATE_DEADLINES];
+static int g_update_deadline_count = 0;
+
 uint32_t backend_get_caps(void)
 {
 #if defined(YUI_USE_LVGL_BACKEND)
@@ -117,3 +128,169 @@ void backend_clip_pop(Rect* prev)
         *prev = g_clip_stack[g_clip_depth];
     }
 }
+
+void backend_set_update_deadline(UpdateCallback callback, UpdateDeadlineCallback deadline)
+{
+    if (!callback) {
+        return;
+    }
+    for (int i = 0; i < g_update_deadline_count; i++) {
+        if (g_update_deadlines[i].callback == callback) {
+            g_update_deadlines[i].deadline = deadline;
+            return;
+        }
+    }
+    if (g_update_deadline_count >= BACKEND_MAX_UPDATE_DEADLINES) {
+        return;
+    }
+    g_update_deadlines[g_update_deadline_count].callback = callback;
+    g_update_deadlines[g_update_deadline_count].deadline = deadline;
+    g_update_deadline_count++;
+}
+
+UpdateDeadlineCallback backend_get_update_deadline(UpdateCallback callback)
+{
+    for (int i = 0; i < g_update_deadline_count; i++) {
+        if (g_update_deadlines[i].callback == callback) {
+            return g_update_deadlines[i].deadline;
+        }
+    }
+    return NULL;
+}
+
+#ifndef YUI_USE_SDL_BACKEND
+/* 非 SDL 后端没有字形图集，文本仍按字符串纹理绘制 */
+int backend_text_size(DFont* font, const char* text, int* w, int* h)
+{
+    Texture* texture;
+    int tw = 0;
+    int th = 0;
+    float density = yui_density > 0.0f ? yui_density : 1.0f;
+
+    if (!font || !text || !text[0]) {
+        return -1;
+    }
+    texture = backend_render_texture(font, text, (Color){0, 0, 0, 255});
+    if (!texture) {
+        return -1;
+    }
+    backend_query_texture(texture, NULL, NULL, &tw, &th);
+    backend_render_text_destroy(texture);
+    if (w) {
+        *w = (int)(tw / density);
+    }
+    if (h) {
+        *h = (int)(th / density);
+    }
+    return 0;
+}
+
+void backend_render_text(DFont* font, const char* text, Color color, const Rect* dst)
+{
+    Texture* texture;
+
+    if (!font || !text || !text[0] || !dst) {
+        return;
+    }
+    texture = backend_render_texture(font, text, color);
+    if (!texture) {
+        return;
+    }
+    backend_render_text_copy(texture, NULL, dst);
+    backend_render_text_destroy(texture);
+}
+
+// 非 SDL 后端的主循环由宿主按帧驱动，不会无限阻塞
+void backend_wake(void)
+{
+}
+
+void backend_set_glyph_atlas(int on)
+{
+    (void)on;
+}
+
+int backend_glyph_atlas_enabled(void)
+{
+    return 0;
+}
+
+/* 非 SDL 后端没有解码线程：同步加载，只按路径共享，忽略目标尺寸 */
+struct BackendImage {
+    struct BackendImage* next;
+    char* path;
+    int refcount;
+    Texture* texture;
+};
+
+static struct BackendImage* g_images = NULL;
+
+BackendImage* backend_image_acquire(const char* path, int max_w, int max_h)
+{
+    struct BackendImage* image;
+    size_t len;
+
+    (void)max_w;
+    (void)max_h;
+    if (!path || !path[0]) {
+        return NULL;
+    }
+    for (image = g_images; image; image = image->next) {
+        if (strcmp(image->path, path) == 0) {
+            image->refcount++;
+            return image;
+        }
+    }
+    image = (struct BackendImage*)calloc(1, sizeof(struct BackendImage));
+    if (!image) {
+        return NULL;
+    }
+    len = strlen(path);
+    image->path = (char*)malloc(len + 1);
+    if (!image->path) {
+        free(image);
+        return NULL;
+    }
+    memcpy(image->path, path, len + 1);
+    image->refcount = 1;
+    image->texture = backend_load_texture(image->path);
+    image->next = g_images;
+    g_images = image;
+    return image;
+}
+
+void backend_image_release(BackendImage* image)
+{
+    struct BackendImage** link = &g_images;
+
+    if (!image || --image->refcount > 0) {
+        return;
+    }
+    while (*link && *link != image) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = image->next;
+    }
+    if (image->texture) {
+        backend_render_text_destroy(image->texture);
+    }
+    free(image->path);
+    free(image);
+}
+
+Texture* backend_image_texture(BackendImage* image)
+{
+    return image ? image->texture : NULL;
+}
+
+int backend_image_failed(BackendImage* image)
+{
+    return image && !image->texture;
+}
+
+void backend_image_set_budget(size_t bytes)
+{
+    (void)bytes;
+}
+#endif
@@ -1452,6 +1452,10 @@ void backend_texture_cache_invalidate(void) {}
 void backend_texture_cache_pin(DFont* f, const char* t, Color c) { (void)f; (void)t; (void)c; }
 void backend_texture_cache_warmup(DFont* f, const char** t, int n, Color c) { (void)f; (void)t; (void)n; (void)c; }
 int backend_screenshot(const char* p) { (void)p; return -1; }
+Texture* backend_create_target_texture(int w, int h) { (void)w; (void)h; return NULL; }
+int backend_render_geometry(Texture* t, const BackendVertex* v, int n, const int* i, int ni) { (void)t; (void)v; (void)n; (void)i; (void)ni; return -1; }
+int backend_begin_render_to_texture(Texture* t) { (void)t; return -1; }
+void backend_end_render_to_texture(void) {}
 Layer* g_ui_root = NULL;
 void backend_set_ui_root(Layer* root) { g_ui_root = root; }
 
@@ -1195,6 +1195,10 @@ void backend_texture_cache_warmup(DFont* font, const char** texts, int count, Co
     (void)color;
 }
 int backend_screenshot(const char* path) { (void)path; return -1; }
+Texture* backend_create_target_texture(int w, int h) { (void)w; (void)h; return NULL; }
+int backend_render_geometry(Texture* t, const BackendVertex* v, int n, const int* i, int ni) { (void)t; (void)v; (void)n; (void)i; (void)ni; return -1; }
+int backend_begin_render_to_texture(Texture* target) { (void)target; return -1; }
+void backend_end_render_to_texture(void) {}
 
 int backend_query_texture(Texture* texture, Uint32* format, int* access, int* w, int* h)
 {
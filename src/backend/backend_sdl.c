@@ -3,6 +3,7 @@
 #include "event.h"
 #include "render.h"
 #include "perf/perf.h"
+#include "damage.h"
 #include "ytype.h"
 #include "util.h"
 #include "popup_manager.h"
@@ -10,6 +11,8 @@
 #include "game/game.h"
 #include "input/state.h"
 #include "log.h"
+#include "backend/sdl_glyph_atlas.h"
+#include "backend/sdl_image_cache.h"
 #include <stdbool.h>  // 添加支持bool类型
 #include <math.h>     // 添加数学函数支持
 #include <stdlib.h>
@@ -49,6 +52,13 @@ float yui_density=1.0f;
 static Rect current_clip;
 static int clip_enabled = 0;
 SDL_Window* window=NULL;
+
+/* 常驻 back-buffer：保留上一帧内容，每帧只重绘脏区（设备像素尺寸） */
+static SDL_Texture* g_back_buffer = NULL;
+static int g_back_buffer_w = 0;
+static int g_back_buffer_h = 0;
+static int g_back_buffer_failed = 0;
+static Uint32 yui_fx_pixel_format(void);
 DFont* default_font=NULL;
 Layer* g_ui_root = NULL;
 int g_running=0;
@@ -57,6 +67,9 @@ static int g_auto_frames = -1; /* -1 = run forever */
 static int g_request_quit = 0;
 static int g_exit_code = 0;
 static int g_headless = -1; /* -1 = unset (read YUI_HEADLESS), 0/1 = explicit */
+static Uint32 g_frame_period_ms = 16; /* 显示器刷新周期，backend_run 启动时更新 */
+static Uint32 g_next_frame_ms = 0;
+static int g_glyph_atlas = -1; /* -1 = unset (read YUI_GLYPH_ATLAS), 0/1 = explicit */
 
 void backend_set_headless(int on)
 {
@@ -106,6 +119,10 @@ static UpdateCallback update_callbacks[MAX_UPDATE_CALLBACKS] = {NULL};
 static int update_callback_count = 0;
 static ResizeCallback resize_callback = NULL;
 
+// backend_wake 投递的自定义事件；处理前只投递一个
+static Uint32 g_wake_event = (Uint32)-1;
+static SDL_atomic_t g_wake_posted;
+
 // 字体缓存结构
 typedef struct {
     uint64_t hash;          // 预计算的哈希值
@@ -892,6 +909,150 @@ static void sdl_handle_window_event(Layer* root, const SDL_Event* event) {
     }
 }
 
+// ====================== 脏区重绘 ======================
+/* 按渲染输出尺寸维护 back-buffer；尺寸变化时重建并整屏重绘。
+   渲染器不支持目标纹理时返回 0，主循环退回每帧整屏直绘。 */
+static int backend_back_buffer_ensure(void) {
+    int w = 0, h = 0;
+
+    if (g_back_buffer_failed) {
+        return 0;
+    }
+    if (SDL_GetRendererOutputSize(renderer, &w, &h) != 0 || w <= 0 || h <= 0) {
+        return 0;
+    }
+    if (g_back_buffer && w == g_back_buffer_w && h == g_back_buffer_h) {
+        return 1;
+    }
+    if (g_back_buffer) {
+        SDL_DestroyTexture(g_back_buffer);
+        g_back_buffer = NULL;
+    }
+    g_back_buffer = SDL_CreateTexture(renderer, yui_fx_pixel_format(),
+                                      SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!g_back_buffer) {
+        printf("backend: back-buffer unavailable, fallback to full redraw: %s\n", SDL_GetError());
+        g_back_buffer_failed = 1;
+        return 0;
+    }
+    SDL_SetTextureBlendMode(g_back_buffer, SDL_BLENDMODE_NONE);
+    g_back_buffer_w = w;
+    g_back_buffer_h = h;
+    damage_add_full();
+    return 1;
+}
+
+static void backend_back_buffer_free(void) {
+    if (g_back_buffer) {
+        SDL_DestroyTexture(g_back_buffer);
+        g_back_buffer = NULL;
+    }
+    g_back_buffer_w = 0;
+    g_back_buffer_h = 0;
+}
+
+/* 渲染一帧：脏区逐块设为 clip 重绘到 back-buffer，再整体拷到屏幕，
+   之后叠加 inspect / HUD / 弹出层。没有脏区且无需刷新 HUD 时跳过本帧。 */
+static void backend_render_frame(Layer* root) {
+    float density = yui_density > 0.0f ? yui_density : 1.0f;
+    int use_back_buffer;
+    int out_w = 0, out_h = 0;
+    int rect_count;
+    Rect viewport;
+
+#if YUI_WITH_GAME
+    // 游戏场景每帧都在变化
+    if (game_is_active()) {
+        damage_add_full();
+    }
+#endif
+    // 后台解码完的图片在这里上传，占位图换成真图
+    if (sdl_image_cache_pump(renderer) > 0) {
+        damage_add_full();
+    }
+
+    use_back_buffer = backend_back_buffer_ensure();
+    if (!use_back_buffer) {
+        damage_add_full();
+    }
+
+    SDL_GetRendererOutputSize(renderer, &out_w, &out_h);
+    viewport.x = 0;
+    viewport.y = 0;
+    viewport.w = (int)ceilf((float)out_w / density);
+    viewport.h = (int)ceilf((float)out_h / density);
+
+    damage_promote_due(SDL_GetTicks());
+    rect_count = damage_begin_frame(&viewport);
+    if (rect_count == 0 && !perf_overlay_enabled()) {
+        perf_frame_skipped();
+        return;
+    }
+
+    perf_frame_begin();
+    perf_render_tree_begin();
+    if (rect_count > 0) {
+        const Rect* rects = damage_frame_rects(NULL);
+
+        if (use_back_buffer) {
+            SDL_SetRenderTarget(renderer, g_back_buffer);
+            SDL_RenderSetScale(renderer, density, density);
+        }
+        backend_render_set_clip_rect(NULL);
+
+        if (damage_frame_is_full()) {
+            SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+            SDL_RenderClear(renderer);
+#if YUI_WITH_GAME
+            game_render();
+#endif
+            render_layer(root);
+        } else {
+            damage_set_frame_active(1);
+            for (int i = 0; i < rect_count; i++) {
+                Rect r = rects[i];
+                backend_render_set_clip_rect(&r);
+                // RenderClear 不受 clip 限制，这里用不混合的填充擦除脏区
+                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+                SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+                SDL_RenderFillRect(renderer, &r);
+                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+                render_layer(root);
+            }
+            damage_set_frame_active(0);
+            backend_render_set_clip_rect(NULL);
+        }
+
+        if (use_back_buffer) {
+            SDL_SetRenderTarget(renderer, NULL);
+        }
+        perf_frame_set_pixels_redrawn(
+            (uint64_t)((double)damage_frame_area() * density * density));
+    } else {
+        perf_frame_set_pixels_redrawn(0);
+    }
+    perf_render_tree_end();
+
+    if (use_back_buffer) {
+        SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+        SDL_RenderCopy(renderer, g_back_buffer, NULL, NULL);
+        SDL_RenderSetScale(renderer, density, density);
+    }
+
+    render_inspect_overlay(root);
+    perf_draw_overlay(root);
+
+    // 渲染弹出层
+    perf_phase_begin(PERF_PHASE_POPUPS);
+    popup_manager_render();
+    perf_phase_end(PERF_PHASE_POPUPS);
+    perf_frame_end();
+
+    perf_phase_begin(PERF_PHASE_PRESENT);
+    SDL_RenderPresent(renderer);
+    perf_phase_end(PERF_PHASE_PRESENT);
+}
+
 #ifdef __EMSCRIPTEN__
 void backend_main_loop(void) {
     if (!g_ui_root || !g_running) {
@@ -899,16 +1060,21 @@ void backend_main_loop(void) {
     }
 
     SDL_Event event;
+    perf_loop_begin();
+    perf_phase_begin(PERF_PHASE_EVENTS);
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) {
             g_running = 0;
+            perf_loop_end();
             emscripten_cancel_main_loop();
             return;
         }
         handle_event(g_ui_root, &event);
     }
+    perf_phase_end(PERF_PHASE_EVENTS);
 
     // 调用所有注册的更新回调
+    perf_phase_begin(PERF_PHASE_UPDATE);
     for (int i = 0; i < update_callback_count; i++) {
         if (update_callbacks[i]) {
             update_callbacks[i]();
@@ -918,25 +1084,10 @@ void backend_main_loop(void) {
 #if YUI_WITH_GAME
     game_update(-1.0f);
 #endif
+    perf_phase_end(PERF_PHASE_UPDATE);
 
-    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
-    SDL_RenderClear(renderer);
-
-    perf_frame_begin();
-    perf_render_tree_begin();
-#if YUI_WITH_GAME
-    game_render();
-#endif
-    render_layer(g_ui_root);
-    perf_render_tree_end();
-    render_inspect_overlay(g_ui_root);
-    perf_draw_overlay(g_ui_root);
-
-    // 渲染弹出层
-    popup_manager_render();
-    perf_frame_end();
-
-    SDL_RenderPresent(renderer);
+    backend_render_frame(g_ui_root);
+    perf_loop_end();
 }
 #endif
 
@@ -990,6 +1141,8 @@ void cleanup_texture_cache() {
 void backend_texture_cache_invalidate(void) {
     int i;
 
+    sdl_glyph_atlas_reset();
+
     for (i = 0; i < TEXTURE_CACHE_SIZE; i++) {
         if (!texture_cache[i].texture || texture_cache[i].pinned) {
             continue;
@@ -1078,6 +1231,8 @@ void add_texture_to_cache(DFont* font, const char* text, Color color, int font_s
         return;
     }
 
+    // 每张新建的字符串纹理都经过这里
+    perf_frame_add_text_rasterized(1);
     backend_texture_cache_sync_scale();
     if (font_size <= 0) {
         font_size = backend_get_font_size(font);
@@ -1142,6 +1297,7 @@ void init_font_cache() {
 
 void cleanup_font_cache() {
     printf("Cleaning up font cache...\n");
+    sdl_glyph_atlas_reset();
     for (int i = 0; i < FONT_CACHE_SIZE; i++) {
         if (font_cache[i].font) {
             TTF_CloseFont(font_cache[i].font);
@@ -1205,8 +1361,9 @@ void add_font_to_cache(const char* font_path, int size, const char* weight, TTF_
     int cache_index = (empty_slot >= 0) ? empty_slot : lru_slot;
     
     if (cache_index >= 0) {
-        // 如果该位置已有字体，先关闭它
+        // 如果该位置已有字体，先关闭它（图集中该字体的字形随之失效）
         if (font_cache[cache_index].font) {
+            sdl_glyph_atlas_reset();
             TTF_CloseFont(font_cache[cache_index].font);
         }
         
@@ -1511,6 +1668,7 @@ int backend_init(){
 
     // 初始化SDL
     SDL_Init(SDL_INIT_VIDEO);
+    g_wake_event = SDL_RegisterEvents(1);
 
     // 启用 IME UI 显示（候选词窗口）
     SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
@@ -1522,6 +1680,9 @@ int backend_init(){
     // 开启 click-through 让首次点击也能送达应用侧
     SDL_SetHint(SDL_HINT_MOUSE_FOCUS_CLICKTHROUGH, "1");
 
+    // 相同纹理的连续绘制合并提交（字形图集文本依赖）；指定渲染驱动时 SDL 默认关闭
+    SDL_SetHint(SDL_HINT_RENDER_BATCHING, "1");
+
     // Windows: 强制使用 OpenGL 渲染器以避免 Direct3D 的颜色问题
     #ifdef YUI_WIN32_NATIVE
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
@@ -1844,7 +2005,30 @@ int pointInLayer(SDL_Point* point, Layer* layer) {
 }
 
 void handle_event(Layer* root, SDL_Event* event) {
+    // 后台唤醒只为让主循环跑一轮，由各 update 回调自行记脏
+    if (event->type == g_wake_event) {
+        SDL_AtomicSet(&g_wake_posted, 0);
+        return;
+    }
+
+    /* 目标纹理内容丢失（如 D3D 切换全屏）：back-buffer 与烘焙的 tile 块都要重画；
+       设备重置时纹理本身也失效，释放后下一帧重建 */
+    if (event->type == SDL_RENDER_TARGETS_RESET || event->type == SDL_RENDER_DEVICE_RESET) {
+        int lost = event->type == SDL_RENDER_DEVICE_RESET;
+        if (lost) {
+            backend_back_buffer_free();
+        }
+#if YUI_WITH_GAME
+        game_tilemap_invalidate_chunks(lost);
+#endif
+        damage_add_full();
+        return;
+    }
+
+    /* 输入事件由 event.c 按悬停/焦点/滚动标记涉及的图层，JS 回调经设置器各自记脏；
+       只有窗口事件（尺寸、曝光、显隐等）需要整屏 */
     if (event->type == SDL_WINDOWEVENT) {
+        damage_add_full();
         sdl_handle_window_event(root, event);
         return;
     }
@@ -2080,6 +2264,27 @@ void backend_render_text_copy(Texture * texture,
    SDL_RenderCopy(renderer, texture, srcrect, dstrect);                 
 }
 
+int backend_render_geometry(Texture* texture, const BackendVertex* vertices, int vertex_count,
+                            const int* indices, int index_count) {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    /* BackendVertex 与 SDL_Vertex 同布局（float x,y / RGBA8 / float u,v），直接转交 */
+    if (!renderer) {
+        return -1;
+    }
+    if (vertex_count <= 0) {
+        return 0;
+    }
+    if (!texture) {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    }
+    return SDL_RenderGeometry(renderer, texture, (const SDL_Vertex*)vertices, vertex_count,
+                              indices, index_count);
+#else
+    (void)texture; (void)vertices; (void)vertex_count; (void)indices; (void)index_count;
+    return -1;
+#endif
+}
+
 void backend_render_texture_tinted(Texture* texture,
                                    const Rect* srcrect,
                                    const Rect* dstrect,
@@ -2128,11 +2333,14 @@ void backend_quit(){
       cleanup_arc_cache();
       yui_style_fx_cleanup();
       yui_aa_circle_cache_free();
+      backend_back_buffer_free();
       cleanup_font_cache();
       cleanup_font_cache();
       
       // 清理纹理缓存
       cleanup_texture_cache();
+      sdl_glyph_atlas_destroy();
+      sdl_image_cache_destroy();
       
       // 清理资源
 #ifndef __EMSCRIPTEN__
@@ -2167,6 +2375,115 @@ void print_layer_info(Layer* layer, int depth) {
     }
 }
 
+#ifndef __EMSCRIPTEN__
+// 按窗口所在显示器的刷新率确定出帧周期，取不到时按 60Hz
+static void backend_update_frame_period(void) {
+    SDL_DisplayMode mode;
+    int index = window ? SDL_GetWindowDisplayIndex(window) : 0;
+
+    g_frame_period_ms = 16;
+    if (index >= 0 && SDL_GetCurrentDisplayMode(index, &mode) == 0 && mode.refresh_rate > 0) {
+        g_frame_period_ms = (Uint32)(1000 / mode.refresh_rate);
+    }
+    if (g_frame_period_ms == 0) {
+        g_frame_period_ms = 1;
+    }
+    g_next_frame_ms = SDL_GetTicks();
+}
+
+// 距下一个刷新周期刻度的毫秒数；错过的周期整体跳过，保持与刷新网格对齐
+static int backend_ms_to_next_frame(Uint32 now) {
+    if ((int32_t)(now - g_next_frame_ms) >= 0) {
+        g_next_frame_ms += ((now - g_next_frame_ms) / g_frame_period_ms + 1) * g_frame_period_ms;
+    }
+    return (int)(g_next_frame_ms - now);
+}
+
+/* 事件驱动的帧节奏：有脏区（动画、加载动画、HUD）时按刷新周期出帧；
+   否则阻塞到下一个事件、JS 定时器或定时重绘到期，空闲时不占 CPU。
+   返回 0 表示收到退出事件。 */
+static int backend_wait_next_frame(Layer* root) {
+    SDL_Event event;
+    Uint32 now = SDL_GetTicks();
+    int timeout = -1;
+    int reason = PERF_WAKE_NONE;
+    int got;
+    int busy = damage_pending() || perf_overlay_enabled();
+
+#if YUI_WITH_GAME
+    busy = busy || game_is_active();
+#endif
+
+    if (busy) {
+        timeout = backend_ms_to_next_frame(now);
+        reason = PERF_WAKE_ANIMATION;
+    } else {
+        int due = damage_next_due(now);
+        if (due >= 0) {
+            timeout = due;
+            reason = PERF_WAKE_TIMER;
+        }
+        for (int i = 0; i < update_callback_count; i++) {
+            UpdateDeadlineCallback deadline;
+            int ms;
+            int r = PERF_WAKE_TIMER;
+
+            if (!update_callbacks[i]) {
+                continue;
+            }
+            deadline = backend_get_update_deadline(update_callbacks[i]);
+            if (deadline) {
+                ms = deadline();
+                if (ms < 0) {
+                    continue;
+                }
+            } else {
+                // 无法给出截止时间的回调只能按帧轮询
+                ms = backend_ms_to_next_frame(now);
+                r = PERF_WAKE_POLL;
+            }
+            if (timeout < 0 || ms < timeout) {
+                timeout = ms;
+                reason = r;
+            }
+        }
+    }
+
+    // 自动化测试按帧计数退出，不能无限阻塞
+    if (g_auto_frames >= 0) {
+        int ms = backend_ms_to_next_frame(now);
+        if (timeout < 0 || ms < timeout) {
+            timeout = ms;
+            reason = PERF_WAKE_POLL;
+        }
+    }
+
+    if (timeout == 0) {
+        got = SDL_PollEvent(&event);
+    } else if (timeout < 0) {
+        got = SDL_WaitEvent(&event);
+    } else {
+        got = SDL_WaitEventTimeout(&event, timeout);
+    }
+
+    if (got) {
+        reason = event.type == g_wake_event ? PERF_WAKE_IO : PERF_WAKE_EVENT;
+        if (event.type == SDL_QUIT) {
+            return 0;
+        }
+    }
+    // 下一轮从等待返回时开始计时，唤醒事件算在它的 events 阶段里
+    perf_frame_set_wake(reason, SDL_GetTicks() - now);
+    perf_loop_begin();
+    if (got) {
+        perf_phase_begin(PERF_PHASE_EVENTS);
+        handle_event(root, &event);
+        perf_phase_end(PERF_PHASE_EVENTS);
+    }
+    return 1;
+}
+#endif
+
 void backend_run(Layer* ui_root){
     if (yui_log_get_level() >= YUI_LOG_DEBUG) {
         LOGD("layer", "=== Layer Information ===");
@@ -2188,18 +2505,23 @@ void backend_run(Layer* ui_root){
     // 主循环（onLoad 可能已在 backend_run 前调用 YUI.exit）
     SDL_Event event;
     int running = !g_request_quit;
+    backend_update_frame_period();
     while (running) {
         if (g_request_quit) {
             running = 0;
             break;
         }
 
+        perf_loop_begin();
+        perf_phase_begin(PERF_PHASE_EVENTS);
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) running = 0;
             handle_event(ui_root, &event);
         }
+        perf_phase_end(PERF_PHASE_EVENTS);
 
         // 调用所有注册的更新回调
+        perf_phase_begin(PERF_PHASE_UPDATE);
         for (int i = 0; i < update_callback_count; i++) {
             if (update_callbacks[i]) {
                 update_callbacks[i]();
@@ -2209,25 +2531,10 @@ void backend_run(Layer* ui_root){
 #if YUI_WITH_GAME
         game_update(-1.0f);
 #endif
+        perf_phase_end(PERF_PHASE_UPDATE);
 
-        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
-        SDL_RenderClear(renderer);
-
-        perf_frame_begin();
-        perf_render_tree_begin();
-#if YUI_WITH_GAME
-        game_render();
-#endif
-        render_layer(ui_root);
-        perf_render_tree_end();
-        render_inspect_overlay(ui_root);
-        perf_draw_overlay(ui_root);
-
-        // 渲染弹出层
-        popup_manager_render();
-        perf_frame_end();
-
-        SDL_RenderPresent(renderer);
+        backend_render_frame(ui_root);
+        perf_loop_end();
 
 #ifdef YUI_WIN32_NATIVE
         // 第一帧渲染后重新应用暗色（此时窗口已完全显示）
@@ -2250,7 +2557,9 @@ void backend_run(Layer* ui_root){
             }
         }
 
-        SDL_Delay(16);
+        if (running && !g_request_quit && !backend_wait_next_frame(ui_root)) {
+            running = 0;
+        }
     }
 #endif
 
@@ -2263,13 +2572,18 @@ void backend_tick(Layer* ui_root) {
         return;
     }
 
+    perf_loop_begin();
+    perf_phase_begin(PERF_PHASE_EVENTS);
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) {
+            perf_loop_end();
             return;
         }
         handle_event(ui_root, &event);
     }
+    perf_phase_end(PERF_PHASE_EVENTS);
 
+    perf_phase_begin(PERF_PHASE_UPDATE);
     for (int i = 0; i < update_callback_count; i++) {
         if (update_callbacks[i]) {
             update_callbacks[i]();
@@ -2279,23 +2593,10 @@ void backend_tick(Layer* ui_root) {
 #if YUI_WITH_GAME
     game_update(-1.0f);
 #endif
+    perf_phase_end(PERF_PHASE_UPDATE);
 
-    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
-    SDL_RenderClear(renderer);
-
-    perf_frame_begin();
-    perf_render_tree_begin();
-#if YUI_WITH_GAME
-    game_render();
-#endif
-    render_layer(ui_root);
-    perf_render_tree_end();
-    render_inspect_overlay(ui_root);
-    perf_draw_overlay(ui_root);
-    popup_manager_render();
-    perf_frame_end();
-
-    SDL_RenderPresent(renderer);
+    backend_render_frame(ui_root);
+    perf_loop_end();
 }
 
 DFont* backend_load_font(char* font_path,int size){
@@ -2606,6 +2907,32 @@ Texture* backend_load_texture(char* path){
     return texture;
 }
 
+static int backend_image_device_px(int logical) {
+    float density = yui_density > 0.0f ? yui_density : 1.0f;
+    return logical > 0 ? (int)ceilf(logical * density) : 0;
+}
+
+BackendImage* backend_image_acquire(const char* path, int max_w, int max_h) {
+    return sdl_image_cache_acquire(renderer, path, backend_image_device_px(max_w),
+                                   backend_image_device_px(max_h));
+}
+
+void backend_image_release(BackendImage* image) {
+    sdl_image_cache_release(image);
+}
+
+Texture* backend_image_texture(BackendImage* image) {
+    return sdl_image_cache_texture(image);
+}
+
+int backend_image_failed(BackendImage* image) {
+    return sdl_image_cache_failed(image);
+}
+
+void backend_image_set_budget(size_t bytes) {
+    sdl_image_cache_set_budget(bytes);
+}
+
 int backend_query_texture(Texture * texture,
                      Uint32 * format, int *access,
                      int *w, int *h){
@@ -2700,6 +3027,76 @@ int backend_measure_text_width(DFont* font, const char* text) {
     return 0;
 }
 
+void backend_set_glyph_atlas(int on) {
+    g_glyph_atlas = on ? 1 : 0;
+}
+
+int backend_glyph_atlas_enabled(void) {
+    if (g_glyph_atlas < 0) {
+#ifdef __EMSCRIPTEN__
+        // wasm 文本由浏览器 Canvas 光栅化，保持字符串纹理
+        g_glyph_atlas = 0;
+#else
+        const char* env = getenv("YUI_GLYPH_ATLAS");
+        g_glyph_atlas = (env && strcmp(env, "0") == 0) ? 0 : 1;
+#endif
+    }
+    return g_glyph_atlas;
+}
+
+int backend_text_size(DFont* font, const char* text, int* w, int* h) {
+    float density = yui_density > 0.0f ? yui_density : 1.0f;
+    int tw = 0, th = 0;
+
+    if (!font || !text || !text[0]) {
+        return -1;
+    }
+
+    if (backend_glyph_atlas_enabled()) {
+        DFont* fallback = backend_has_font_fallback() ? backend_get_fallback_font_for(font) : NULL;
+        if (sdl_glyph_atlas_measure(font, fallback, text, &tw, &th) == 0) {
+            if (w) *w = (int)(tw / density);
+            if (h) *h = (int)(th / density);
+            return 0;
+        }
+    }
+
+    {
+        Texture* texture = backend_render_texture(font, text, (Color){0, 0, 0, 255});
+        if (!texture) {
+            return -1;
+        }
+        SDL_QueryTexture(texture, NULL, NULL, &tw, &th);
+        backend_render_text_destroy(texture);
+    }
+    if (w) *w = (int)(tw / density);
+    if (h) *h = (int)(th / density);
+    return 0;
+}
+
+void backend_render_text(DFont* font, const char* text, Color color, const Rect* dst) {
+    Texture* texture;
+
+    if (!font || !text || !text[0] || !dst) {
+        return;
+    }
+
+    if (backend_glyph_atlas_enabled()) {
+        DFont* fallback = backend_has_font_fallback() ? backend_get_fallback_font_for(font) : NULL;
+        if (sdl_glyph_atlas_draw(renderer, font, fallback, text, color, dst) == 0) {
+            return;
+        }
+    }
+
+    // 图集不可用（字形过多、彩色 emoji 等）时退回字符串纹理
+    texture = backend_render_texture(font, text, color);
+    if (!texture) {
+        return;
+    }
+    SDL_RenderCopy(renderer, texture, NULL, dst);
+    backend_render_text_destroy(texture);
+}
+
 Texture* backend_render_texture(DFont* font,const char* text,Color color){
     if (!font) {
         printf("error: backend_render_texture called with NULL font (text: '%s')\n", text ? text : "(null)");
@@ -2975,6 +3372,19 @@ void backend_render_set_clip_rect(Rect* clip){
     SDL_RenderSetClipRect(renderer, &current_clip);
 }
 
+/* 切回之前的渲染目标。SDL2 切到纹理目标会把 scale 重置为 1 并关闭 clip，
+   回到 back-buffer（或其它纹理目标）时要重新应用，NULL 目标由 SDL 自行恢复。 */
+static void backend_restore_render_target(SDL_Texture* prev) {
+    SDL_SetRenderTarget(renderer, prev);
+    if (!prev) {
+        return;
+    }
+    if (prev == g_back_buffer) {
+        SDL_RenderSetScale(renderer, yui_density, yui_density);
+    }
+    SDL_RenderSetClipRect(renderer, clip_enabled ? &current_clip : NULL);
+}
+
 
 // 创建带透明度的颜色
 SDL_Color create_color(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
@@ -3566,7 +3976,7 @@ static SDL_Texture* yui_rounded_rect_texture_get(int w, int h, int radius, SDL_C
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
     SDL_RenderClear(renderer);
     yui_draw_rounded_rect_direct(renderer, 0, 0, w, h, radius, color);
-    SDL_SetRenderTarget(renderer, prev);
+    backend_restore_render_target(prev);
 
     if (clip_on) SDL_RenderSetClipRect(renderer, &prev_clip);
 
@@ -4019,7 +4429,7 @@ static SDL_Texture* yui_gradient_texture_get(int w, int h, int radius, int verti
     } else {
         yui_draw_horizontal_gradient_fast(0, 0, w, h, radius, colors, n);
     }
-    SDL_SetRenderTarget(renderer, prev);
+    backend_restore_render_target(prev);
 
     g_style_fx[slot].tex = tex;
     g_style_fx[slot].tw = w;
@@ -4409,6 +4819,7 @@ void backend_render_arc(int center_x, int center_y, int radius, float start_angl
         SDL_Texture* tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
                                              SDL_TEXTUREACCESS_TARGET, size, size);
         if (tex) {
+            SDL_Texture* prev_target = SDL_GetRenderTarget(renderer);
             SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
             SDL_SetRenderTarget(renderer, tex);
             SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
@@ -4424,7 +4835,7 @@ void backend_render_arc(int center_x, int center_y, int radius, float start_angl
             // 批量绘制到纹理
             arc_draw_bucketed(points, point_alphas, point_count, color);
 
-            SDL_SetRenderTarget(renderer, NULL);
+            backend_restore_render_target(prev_target);
 
             // 存入缓存
             int cache_idx = find_available_arc_cache_entry();
@@ -4580,12 +4991,19 @@ void backend_render_backdrop_filter(Rect* rect, int blur_radius, float saturatio
     // 将当前屏幕内容复制到临时纹理
     SDL_Rect src_rect = *rect;
     SDL_Rect dst_rect = {0, 0, rect->w, rect->h};
+    if (current_target && current_target == g_back_buffer) {
+        // back-buffer 为设备像素，rect 为逻辑坐标
+        src_rect.x = (int)(rect->x * yui_density);
+        src_rect.y = (int)(rect->y * yui_density);
+        src_rect.w = (int)(rect->w * yui_density);
+        src_rect.h = (int)(rect->h * yui_density);
+    }
     
     // 将屏幕内容渲染到临时纹理
     SDL_RenderCopy(renderer, current_target, &src_rect, &dst_rect);
     
     // 恢复原始渲染目标
-    SDL_SetRenderTarget(renderer, current_target);
+    backend_restore_render_target(current_target);
     
     // 创建模糊纹理（只创建一次）
     SDL_Texture* blur_texture = SDL_CreateTexture(
@@ -4623,7 +5041,7 @@ void backend_render_backdrop_filter(Rect* rect, int blur_radius, float saturatio
     }
     
     // 恢复原始渲染目标
-    SDL_SetRenderTarget(renderer, current_target);
+    backend_restore_render_target(current_target);
     
     // 应用饱和度和亮度调整（如果需要）
     if (saturation != 1.0f || brightness != 1.0f) {
@@ -4659,7 +5077,7 @@ void backend_render_backdrop_filter(Rect* rect, int blur_radius, float saturatio
             // 将模糊纹理复制到缓存纹理
             SDL_SetRenderTarget(renderer, blur_cache[cache_index].texture);
             SDL_RenderCopy(renderer, blur_texture, NULL, NULL);
-            SDL_SetRenderTarget(renderer, current_target);
+            backend_restore_render_target(current_target);
             
             // 更新缓存条目信息
             blur_cache[cache_index].x = rect->x;
@@ -4686,6 +5104,19 @@ void backend_set_resize_callback(ResizeCallback callback) {
     resize_callback = callback;
 }
 
+void backend_wake(void) {
+    SDL_Event event;
+
+    if (g_wake_event == (Uint32)-1 || !SDL_AtomicCAS(&g_wake_posted, 0, 1)) {
+        return;
+    }
+    memset(&event, 0, sizeof(event));
+    event.type = g_wake_event;
+    if (SDL_PushEvent(&event) != 1) {
+        SDL_AtomicSet(&g_wake_posted, 0);
+    }
+}
+
 void backend_register_update_callback(UpdateCallback callback) {
     if (!callback) return;
 
@@ -4965,7 +5396,7 @@ int backend_screenshot(const char* path) {
     SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
         0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
     if (!surface) {
-        SDL_SetRenderTarget(renderer, prev_target);
+        backend_restore_render_target(prev_target);
         SDL_DestroyTexture(target);
         return -4;
     }
@@ -4974,12 +5405,12 @@ int backend_screenshot(const char* path) {
                              surface->pixels, surface->pitch) != 0) {
         printf("screenshot: ReadPixels failed: %s\n", SDL_GetError());
         SDL_FreeSurface(surface);
-        SDL_SetRenderTarget(renderer, prev_target);
+        backend_restore_render_target(prev_target);
         SDL_DestroyTexture(target);
         return -5;
     }
 
-    SDL_SetRenderTarget(renderer, prev_target);
+    backend_restore_render_target(prev_target);
     SDL_DestroyTexture(target);
 
     SDL_Surface* rgba = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
@@ -4992,4 +5423,51 @@ int backend_screenshot(const char* path) {
                                  rgba->w, rgba->h, rgba->pitch);
     SDL_FreeSurface(rgba);
     return rc;
-}
\ No newline at end of file
+}
+/* 离屏目标：同 style fx 烘焙，期间关闭 clip，结束时恢复之前的目标和裁剪 */
+static SDL_Texture* g_rtt_prev = NULL;
+static SDL_Rect g_rtt_prev_clip;
+static SDL_bool g_rtt_clip_on = SDL_FALSE;
+static int g_rtt_active = 0;
+
+Texture* backend_create_target_texture(int w, int h) {
+    SDL_Texture* tex;
+    if (!renderer || w <= 0 || h <= 0) {
+        return NULL;
+    }
+    tex = SDL_CreateTexture(renderer, yui_fx_pixel_format(), SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!tex) {
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    return tex;
+}
+
+int backend_begin_render_to_texture(Texture* target) {
+    if (!renderer || !target || g_rtt_active) {
+        return -1;
+    }
+    g_rtt_clip_on = SDL_RenderIsClipEnabled(renderer);
+    if (g_rtt_clip_on) SDL_RenderGetClipRect(renderer, &g_rtt_prev_clip);
+    SDL_RenderSetClipRect(renderer, NULL);
+
+    g_rtt_prev = SDL_GetRenderTarget(renderer);
+    if (SDL_SetRenderTarget(renderer, target) != 0) {
+        SDL_RenderSetClipRect(renderer, g_rtt_clip_on ? &g_rtt_prev_clip : NULL);
+        return -1;
+    }
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    g_rtt_active = 1;
+    return 0;
+}
+
+void backend_end_render_to_texture(void) {
+    if (!g_rtt_active) {
+        return;
+    }
+    backend_restore_render_target(g_rtt_prev);
+    if (g_rtt_clip_on) SDL_RenderSetClipRect(renderer, &g_rtt_prev_clip);
+    g_rtt_prev = NULL;
+    g_rtt_active = 0;
+}
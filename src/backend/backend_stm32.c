@@ -594,6 +594,30 @@ int backend_screenshot(const char* path) {
     return -1;
 }
 
+int backend_render_geometry(Texture* texture, const BackendVertex* vertices, int vertex_count,
+                            const int* indices, int index_count) {
+    (void)texture;
+    (void)vertices;
+    (void)vertex_count;
+    (void)indices;
+    (void)index_count;
+    return -1;
+}
+
+Texture* backend_create_target_texture(int w, int h) {
+    (void)w;
+    (void)h;
+    return NULL;
+}
+
+int backend_begin_render_to_texture(Texture* target) {
+    (void)target;
+    return -1;
+}
+
+void backend_end_render_to_texture(void) {
+}
+
 void backend_set_ui_root(Layer* root) {
     (void)root;
 }
\ No newline at end of file
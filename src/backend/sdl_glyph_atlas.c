@@ -0,0 +1,455 @@
+#ifndef YUI_BACKEND_EMBEDDED
+
+#include "sdl_glyph_atlas.h"
+#include "util.h"
+#include "perf/perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* SDL_RenderGeometry 需要 SDL >= 2.0.18，32 位字形 API 需要 SDL_ttf >= 2.0.18；
+   更旧的版本不启用图集，backend_render_text 全部走字符串纹理。 */
+#if SDL_VERSION_ATLEAST(2, 0, 18) && defined(SDL_TTF_VERSION_ATLEAST) && SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+#define GLYPH_ATLAS_SUPPORTED 1
+#else
+#define GLYPH_ATLAS_SUPPORTED 0
+#endif
+
+#if GLYPH_ATLAS_SUPPORTED
+
+#define GLYPH_ATLAS_SIZE  1024   // 图集边长（设备像素）
+#define GLYPH_ATLAS_PAD   1      // 字形间留白，避免线性采样串色
+#define GLYPH_CACHE_SIZE  2048   // 2^11，便于用位运算取模
+#define GLYPH_CACHE_LIMIT 1536   // 超过后整体重建，保持探测链短
+#define GLYPH_RUN_MAX     512    // 单次绘制的最大字形数，超出退回纹理路径
+#define GLYPH_BATCH_MAX   128    // 每次 SDL_RenderGeometry 提交的四边形数
+
+typedef struct {
+    DFont* font;
+    Uint32 codepoint;
+    int16_t x, y;        // 图集内位置（不含留白）
+    int16_t w, h;        // 位图尺寸，0 表示无墨迹（空格等）
+    int16_t offset_x;    // 位图左边相对笔位置的偏移
+    int16_t advance;
+    uint8_t color;       // 彩色字形（emoji 等）：顶点色调制会染色，不进图集
+} GlyphEntry;
+
+typedef struct {
+    const GlyphEntry* glyph;
+    int pen_x;
+    int offset_y;
+} GlyphPlacement;
+
+static GlyphEntry g_glyphs[GLYPH_CACHE_SIZE];
+static int g_glyph_count = 0;
+static SDL_Texture* g_atlas = NULL;
+static SDL_Renderer* g_atlas_renderer = NULL;
+static int g_shelf_x = 0;
+static int g_shelf_y = 0;
+static int g_shelf_h = 0;
+static uint32_t g_generation = 0;
+
+static GlyphPlacement g_run[GLYPH_RUN_MAX];
+static SDL_Vertex g_vertices[GLYPH_BATCH_MAX * 4];
+static int g_indices[GLYPH_BATCH_MAX * 6];
+static int g_indices_ready = 0;
+
+static uint32_t glyph_hash(DFont* font, Uint32 codepoint) {
+    uint64_t h = 14695981039346656037ULL;
+    h ^= (uint64_t)(uintptr_t)font;
+    h *= 1099511628211ULL;
+    h ^= (uint64_t)codepoint;
+    h *= 1099511628211ULL;
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+static void glyph_atlas_clear(void) {
+    memset(g_glyphs, 0, sizeof(g_glyphs));
+    g_glyph_count = 0;
+    g_shelf_x = 0;
+    g_shelf_y = 0;
+    g_shelf_h = 0;
+    g_generation++;
+}
+
+static int glyph_atlas_ensure(SDL_Renderer* renderer) {
+    if (g_atlas && g_atlas_renderer == renderer) {
+        return 1;
+    }
+    if (g_atlas) {
+        SDL_DestroyTexture(g_atlas);
+        g_atlas = NULL;
+    }
+    g_atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE);
+    if (!g_atlas) {
+        printf("glyph atlas: create texture failed: %s\n", SDL_GetError());
+        return 0;
+    }
+    SDL_SetTextureBlendMode(g_atlas, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(g_atlas, SDL_ScaleModeLinear);
+    g_atlas_renderer = renderer;
+    glyph_atlas_clear();
+    return 1;
+}
+
+static GlyphEntry* glyph_find(DFont* font, Uint32 codepoint, int* out_slot) {
+    int slot = (int)(glyph_hash(font, codepoint) & (GLYPH_CACHE_SIZE - 1));
+
+    // 线性探测；表不会填满（GLYPH_CACHE_LIMIT），总能遇到空槽
+    while (g_glyphs[slot].font) {
+        if (g_glyphs[slot].font == font && g_glyphs[slot].codepoint == codepoint) {
+            return &g_glyphs[slot];
+        }
+        slot = (slot + 1) & (GLYPH_CACHE_SIZE - 1);
+    }
+    if (out_slot) {
+        *out_slot = slot;
+    }
+    return NULL;
+}
+
+// 货架式打包：当前行放不下换行，整张放不下返回 0
+static int glyph_atlas_pack(int w, int h, int* x, int* y) {
+    int pw = w + GLYPH_ATLAS_PAD * 2;
+    int ph = h + GLYPH_ATLAS_PAD * 2;
+
+    if (pw > GLYPH_ATLAS_SIZE || ph > GLYPH_ATLAS_SIZE) {
+        return 0;
+    }
+    if (g_shelf_x + pw > GLYPH_ATLAS_SIZE) {
+        g_shelf_y += g_shelf_h;
+        g_shelf_x = 0;
+        g_shelf_h = 0;
+    }
+    if (g_shelf_y + ph > GLYPH_ATLAS_SIZE) {
+        return 0;
+    }
+    *x = g_shelf_x + GLYPH_ATLAS_PAD;
+    *y = g_shelf_y + GLYPH_ATLAS_PAD;
+    g_shelf_x += pw;
+    if (ph > g_shelf_h) {
+        g_shelf_h = ph;
+    }
+    return 1;
+}
+
+// 白色光栅化后有非白像素即为彩色字形（FreeType 按 CPAL/CBDT 上色）
+static int glyph_surface_is_color(const SDL_Surface* argb) {
+    int row, col;
+    for (row = 0; row < argb->h; row++) {
+        const Uint32* line = (const Uint32*)((const Uint8*)argb->pixels + (size_t)row * argb->pitch);
+        for (col = 0; col < argb->w; col++) {
+            if ((line[col] >> 24) != 0 && (line[col] & 0x00FFFFFFu) != 0x00FFFFFFu) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// 光栅化白色字形并上传，颜色在绘制时由顶点色调制；返回 1 成功，0 失败，-1 彩色字形
+static int glyph_atlas_upload(GlyphEntry* entry) {
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* surface;
+    SDL_Surface* argb;
+    SDL_Rect dst;
+    Uint32* pixels;
+    int pw, ph;
+    int row;
+
+    surface = TTF_RenderGlyph32_Blended(entry->font, entry->codepoint, white);
+    if (!surface) {
+        return 0;
+    }
+    argb = surface;
+    if (surface->format->format != SDL_PIXELFORMAT_ARGB8888) {
+        argb = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(surface);
+        if (!argb) {
+            return 0;
+        }
+    }
+    if (glyph_surface_is_color(argb)) {
+        SDL_FreeSurface(argb);
+        return -1;
+    }
+
+    if (!glyph_atlas_pack(argb->w, argb->h, &dst.x, &dst.y)) {
+        // 图集已满：清空后重新打包，正在排版的调用方通过 generation 发现并重试
+        glyph_atlas_clear();
+        if (!glyph_atlas_pack(argb->w, argb->h, &dst.x, &dst.y)) {
+            SDL_FreeSurface(argb);
+            return 0;
+        }
+    }
+
+    // 连同四周留白一起上传，留白清零
+    pw = argb->w + GLYPH_ATLAS_PAD * 2;
+    ph = argb->h + GLYPH_ATLAS_PAD * 2;
+    pixels = (Uint32*)calloc((size_t)pw * (size_t)ph, sizeof(Uint32));
+    if (!pixels) {
+        SDL_FreeSurface(argb);
+        return 0;
+    }
+    for (row = 0; row < argb->h; row++) {
+        memcpy(pixels + (size_t)(row + GLYPH_ATLAS_PAD) * pw + GLYPH_ATLAS_PAD,
+               (const Uint8*)argb->pixels + (size_t)row * argb->pitch,
+               (size_t)argb->w * sizeof(Uint32));
+    }
+    {
+        SDL_Rect padded = {dst.x - GLYPH_ATLAS_PAD, dst.y - GLYPH_ATLAS_PAD, pw, ph};
+        SDL_UpdateTexture(g_atlas, &padded, pixels, pw * (int)sizeof(Uint32));
+    }
+    free(pixels);
+
+    entry->x = (int16_t)dst.x;
+    entry->y = (int16_t)dst.y;
+    entry->w = (int16_t)argb->w;
+    entry->h = (int16_t)argb->h;
+    SDL_FreeSurface(argb);
+    perf_frame_add_text_rasterized(1);
+    return 1;
+}
+
+static const GlyphEntry* glyph_get(DFont* font, Uint32 codepoint, int rasterize) {
+    static GlyphEntry metrics_only;
+    GlyphEntry glyph;
+    GlyphEntry* entry;
+    int slot = 0;
+    int minx, maxx, miny, maxy, advance;
+
+    entry = glyph_find(font, codepoint, NULL);
+    if (entry) {
+        return entry->color ? NULL : entry;
+    }
+    if (TTF_GlyphMetrics32(font, codepoint, &minx, &maxx, &miny, &maxy, &advance) != 0) {
+        return NULL;
+    }
+
+    memset(&glyph, 0, sizeof(glyph));
+    glyph.font = font;
+    glyph.codepoint = codepoint;
+    glyph.advance = (int16_t)advance;
+    glyph.offset_x = (int16_t)(minx < 0 ? minx : 0);
+
+    if (!rasterize) {
+        // 仅测量：不入表，避免占用图集
+        metrics_only = glyph;
+        return &metrics_only;
+    }
+
+    if (g_glyph_count >= GLYPH_CACHE_LIMIT) {
+        glyph_atlas_clear();
+    }
+    if (maxx > minx) {
+        int uploaded = glyph_atlas_upload(&glyph);
+        if (uploaded == 0) {
+            return NULL;
+        }
+        // 彩色字形也登记，之后直接判定失败，不再每帧光栅化
+        glyph.color = uploaded < 0;
+    }
+
+    // 上传可能清空了图集，登记前重新找空槽
+    glyph_find(font, codepoint, &slot);
+    entry = &g_glyphs[slot];
+    *entry = glyph;
+    g_glyph_count++;
+    return entry->color ? NULL : entry;
+}
+
+static DFont* glyph_pick_font(DFont* primary, DFont* fallback, Uint32 codepoint) {
+    if (!fallback || fallback == primary || TTF_GlyphIsProvided32(primary, codepoint)) {
+        return primary;
+    }
+    if (TTF_GlyphIsProvided32(fallback, codepoint)) {
+        return fallback;
+    }
+    return primary;
+}
+
+/* 排版一行：逐字选字体、累计 advance 与字距。
+   与字符串纹理一致，fallback 字形在主字体行高内垂直居中。 */
+static int glyph_layout(DFont* primary, DFont* fallback, const char* text, int rasterize,
+                        int* out_w, int* out_h) {
+    const char* cursor = text;
+    int line_h = TTF_FontHeight(primary);
+    int pen_x = 0;
+    int right = 0;
+    int count = 0;
+    DFont* prev_font = NULL;
+    Uint32 prev_cp = 0;
+
+    while (*cursor) {
+        Uint32 codepoint = 0;
+        DFont* font;
+        const GlyphEntry* glyph;
+
+        if (!utf8_decode_codepoint(&cursor, &codepoint)) {
+            break;
+        }
+        if (count >= GLYPH_RUN_MAX) {
+            return -1;
+        }
+        font = glyph_pick_font(primary, fallback, codepoint);
+        glyph = glyph_get(font, codepoint, rasterize);
+        if (!glyph) {
+            return -1;
+        }
+        if (prev_font == font) {
+            pen_x += TTF_GetFontKerningSizeGlyphs32(font, prev_cp, codepoint);
+        }
+        if (rasterize) {
+            g_run[count].glyph = glyph;
+            g_run[count].pen_x = pen_x;
+            g_run[count].offset_y = font == primary ? 0 : (line_h - TTF_FontHeight(font)) / 2;
+        }
+        count++;
+        pen_x += glyph->advance;
+        // 宽度只取 advance，测量与绘制不依赖字形是否已光栅化
+        if (pen_x > right) right = pen_x;
+        prev_font = font;
+        prev_cp = codepoint;
+    }
+
+    if (out_w) *out_w = right;
+    if (out_h) *out_h = line_h;
+    return count;
+}
+
+static void glyph_flush(SDL_Renderer* renderer, int quads) {
+    if (quads > 0) {
+        SDL_RenderGeometry(renderer, g_atlas, g_vertices, quads * 4, g_indices, quads * 6);
+    }
+}
+
+int sdl_glyph_atlas_measure(DFont* primary, DFont* fallback, const char* text, int* w, int* h) {
+    if (!primary || !text) {
+        return -1;
+    }
+    return glyph_layout(primary, fallback, text, 0, w, h) < 0 ? -1 : 0;
+}
+
+int sdl_glyph_atlas_draw(SDL_Renderer* renderer, DFont* primary, DFont* fallback,
+                         const char* text, Color color, const Rect* dst) {
+    SDL_Color vc = {color.r, color.g, color.b, color.a};
+    uint32_t generation;
+    int count = -1;
+    int text_w = 0, text_h = 0;
+    int attempt;
+    int quads = 0;
+    float sx, sy;
+    float inv = 1.0f / GLYPH_ATLAS_SIZE;
+
+    if (!renderer || !primary || !text || !dst || dst->w <= 0 || dst->h <= 0) {
+        return -1;
+    }
+    if (!glyph_atlas_ensure(renderer)) {
+        return -1;
+    }
+    if (!g_indices_ready) {
+        for (int i = 0; i < GLYPH_BATCH_MAX; i++) {
+            g_indices[i * 6 + 0] = i * 4 + 0;
+            g_indices[i * 6 + 1] = i * 4 + 1;
+            g_indices[i * 6 + 2] = i * 4 + 2;
+            g_indices[i * 6 + 3] = i * 4 + 2;
+            g_indices[i * 6 + 4] = i * 4 + 3;
+            g_indices[i * 6 + 5] = i * 4 + 0;
+        }
+        g_indices_ready = 1;
+    }
+
+    // 排版中途图集被清空时，先前取到的字形已失效，重排一次
+    for (attempt = 0; attempt < 2; attempt++) {
+        generation = g_generation;
+        count = glyph_layout(primary, fallback, text, 1, &text_w, &text_h);
+        if (count < 0) {
+            return -1;
+        }
+        if (generation == g_generation) {
+            break;
+        }
+    }
+    if (generation != g_generation || text_w <= 0 || text_h <= 0) {
+        return -1;
+    }
+
+    // 设备像素 -> dst 逻辑坐标；dst 等于测量尺寸时恰好是 1/density
+    sx = (float)dst->w / (float)text_w;
+    sy = (float)dst->h / (float)text_h;
+
+    for (int i = 0; i < count; i++) {
+        const GlyphEntry* g = g_run[i].glyph;
+        SDL_Vertex* v;
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+
+        if (g->w <= 0 || g->h <= 0) {
+            continue;
+        }
+        x0 = dst->x + (g_run[i].pen_x + g->offset_x) * sx;
+        y0 = dst->y + g_run[i].offset_y * sy;
+        x1 = x0 + g->w * sx;
+        y1 = y0 + g->h * sy;
+        u0 = g->x * inv;
+        v0 = g->y * inv;
+        u1 = (g->x + g->w) * inv;
+        v1 = (g->y + g->h) * inv;
+
+        v = &g_vertices[quads * 4];
+        v[0].position.x = x0; v[0].position.y = y0; v[0].tex_coord.x = u0; v[0].tex_coord.y = v0;
+        v[1].position.x = x1; v[1].position.y = y0; v[1].tex_coord.x = u1; v[1].tex_coord.y = v0;
+        v[2].position.x = x1; v[2].position.y = y1; v[2].tex_coord.x = u1; v[2].tex_coord.y = v1;
+        v[3].position.x = x0; v[3].position.y = y1; v[3].tex_coord.x = u0; v[3].tex_coord.y = v1;
+        v[0].color = vc;
+        v[1].color = vc;
+        v[2].color = vc;
+        v[3].color = vc;
+        quads++;
+        if (quads == GLYPH_BATCH_MAX) {
+            glyph_flush(renderer, quads);
+            quads = 0;
+        }
+    }
+    glyph_flush(renderer, quads);
+    return 0;
+}
+
+void sdl_glyph_atlas_reset(void) {
+    if (g_glyph_count > 0 || g_shelf_x > 0 || g_shelf_y > 0) {
+        glyph_atlas_clear();
+    }
+}
+
+void sdl_glyph_atlas_destroy(void) {
+    if (g_atlas) {
+        SDL_DestroyTexture(g_atlas);
+        g_atlas = NULL;
+    }
+    g_atlas_renderer = NULL;
+    glyph_atlas_clear();
+}
+
+#else
+
+int sdl_glyph_atlas_measure(DFont* primary, DFont* fallback, const char* text, int* w, int* h) {
+    (void)primary; (void)fallback; (void)text; (void)w; (void)h;
+    return -1;
+}
+
+int sdl_glyph_atlas_draw(SDL_Renderer* renderer, DFont* primary, DFont* fallback,
+                         const char* text, Color color, const Rect* dst) {
+    (void)renderer; (void)primary; (void)fallback; (void)text; (void)color; (void)dst;
+    return -1;
+}
+
+void sdl_glyph_atlas_reset(void) {
+}
+
+void sdl_glyph_atlas_destroy(void) {
+}
+
+#endif /* GLYPH_ATLAS_SUPPORTED */
+
+#endif /* YUI_BACKEND_EMBEDDED */
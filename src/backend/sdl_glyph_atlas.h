@@ -0,0 +1,25 @@
+#ifndef SDL_GLYPH_ATLAS_H
+#define SDL_GLYPH_ATLAS_H
+
+#include "ytype.h"
+
+#ifndef YUI_BACKEND_EMBEDDED
+
+/* 字形图集：按 (字体, 码点) 光栅化一次并打包进共享纹理，
+   文本以带顶点色的四边形提交，同一图集的连续绘制由 SDL 合批。
+   主字体缺字时逐字选用 fallback 字体。 */
+
+// 测量文本（设备像素），不光栅化；失败返回 -1
+int sdl_glyph_atlas_measure(DFont* primary, DFont* fallback, const char* text, int* w, int* h);
+
+// 绘制到 dst（渲染器逻辑坐标），dst 与测量尺寸不同则缩放；失败返回 -1，调用方退回纹理路径
+int sdl_glyph_atlas_draw(SDL_Renderer* renderer, DFont* primary, DFont* fallback,
+                         const char* text, Color color, const Rect* dst);
+
+// 字体关闭后必须清空（字体指针可能被复用）
+void sdl_glyph_atlas_reset(void);
+void sdl_glyph_atlas_destroy(void);
+
+#endif
+
+#endif
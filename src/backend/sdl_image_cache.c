@@ -0,0 +1,467 @@
+#ifndef YUI_BACKEND_EMBEDDED
+
+#include "sdl_image_cache.h"
+#include "backend.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IMAGE_CACHE_BUCKETS 1024   // 2^10，便于用位运算取模
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define IMAGE_CACHE_THREADS 0
+#else
+#define IMAGE_CACHE_THREADS 1
+#endif
+
+typedef enum {
+    IMAGE_PENDING = 0,   // 排队或解码中
+    IMAGE_READY,
+    IMAGE_FAILED,
+} ImageState;
+
+struct BackendImage {
+    struct BackendImage* hash_next;
+    struct BackendImage* lru_prev;
+    struct BackendImage* lru_next;
+    struct BackendImage* job_next;   // 解码队列 / 完成队列
+    char* path;
+    int max_w;
+    int max_h;
+    unsigned int hash;
+    int refcount;
+    int state;                       // 只在渲染线程读写
+    int in_lru;
+    SDL_Surface* surface;            // 工作线程的解码结果，进完成队列后归渲染线程
+    SDL_Texture* texture;
+    size_t bytes;
+};
+
+static struct BackendImage* g_buckets[IMAGE_CACHE_BUCKETS];
+static struct BackendImage* g_lru_head = NULL;   // 最近释放
+static struct BackendImage* g_lru_tail = NULL;   // 最久未用
+static size_t g_bytes = 0;
+static size_t g_budget = SDL_IMAGE_CACHE_BUDGET;
+
+// 以下由 g_lock 保护
+static SDL_mutex* g_lock = NULL;
+static SDL_cond* g_cond = NULL;
+static struct BackendImage* g_jobs_head = NULL;
+static struct BackendImage* g_jobs_tail = NULL;
+static struct BackendImage* g_done = NULL;
+static int g_quit = 0;
+
+static SDL_Thread* g_workers[SDL_IMAGE_CACHE_WORKERS];
+static int g_worker_count = 0;
+static int g_started = 0;
+
+static unsigned int image_cache_hash(const char* path, int max_w, int max_h) {
+    unsigned int h = 2166136261u;
+    while (*path) {
+        h ^= (unsigned char)*path++;
+        h *= 16777619u;
+    }
+    h ^= (unsigned int)max_w * 0x9E3779B1u;
+    h *= 16777619u;
+    h ^= (unsigned int)max_h * 0x85EBCA6Bu;
+    return h;
+}
+
+static int image_cache_is_svg(const char* path) {
+    const char* ext = strrchr(path, '.');
+    return ext && (strcmp(ext, ".svg") == 0 || strcmp(ext, ".SVG") == 0);
+}
+
+// 线性插值缩放；倍数大于 2 时先逐次减半，避免跳采样产生的锯齿
+static SDL_Surface* image_cache_downscale(SDL_Surface* surface, int w, int h) {
+    SDL_Surface* current = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+
+    while (current && (current->w != w || current->h != h)) {
+        int step_w = current->w / 2 >= w ? current->w / 2 : w;
+        int step_h = current->h / 2 >= h ? current->h / 2 : h;
+        SDL_Surface* next = SDL_CreateRGBSurfaceWithFormat(0, step_w, step_h, 32,
+                                                           SDL_PIXELFORMAT_ARGB8888);
+        int ok;
+
+        if (!next) {
+            break;
+        }
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+        ok = SDL_SoftStretchLinear(current, NULL, next, NULL) == 0;
+#else
+        SDL_SetSurfaceBlendMode(current, SDL_BLENDMODE_NONE);
+        ok = SDL_BlitScaled(current, NULL, next, NULL) == 0;
+#endif
+        SDL_FreeSurface(current);
+        current = next;
+        if (!ok) {
+            SDL_FreeSurface(current);
+            return NULL;
+        }
+    }
+    return current;
+}
+
+// 工作线程中执行：只碰 surface，不碰渲染器
+static SDL_Surface* image_cache_decode(const char* path, int max_w, int max_h) {
+    SDL_Surface* surface = IMG_Load(path);
+
+    if (!surface) {
+        printf("Failed to load image %s: %s\n", path, IMG_GetError());
+        if (!image_cache_is_svg(path)) {
+            return NULL;
+        }
+        // 与 backend_load_texture 一致：SVG 解码失败给灰色占位
+        printf("Note: SVG support requires SDL_image 2.6.0 or newer.\n");
+        surface = SDL_CreateRGBSurface(0, 100, 100, 32, 0, 0, 0, 0);
+        if (surface) {
+            SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 200, 200, 200));
+        }
+        return surface;
+    }
+
+    if (max_w > 0 && max_h > 0 && surface->w > 0 && surface->h > 0) {
+        // 等比缩到刚好覆盖目标框，拉伸、适应、填充三种模式都不缺像素
+        float scale_w = (float)max_w / (float)surface->w;
+        float scale_h = (float)max_h / (float)surface->h;
+        float scale = scale_w > scale_h ? scale_w : scale_h;
+
+        if (scale < 1.0f) {
+            int w = (int)ceilf(surface->w * scale);
+            int h = (int)ceilf(surface->h * scale);
+            SDL_Surface* scaled = image_cache_downscale(surface, w > 0 ? w : 1, h > 0 ? h : 1);
+            if (scaled) {
+                SDL_FreeSurface(surface);
+                surface = scaled;
+            }
+        }
+    }
+    return surface;
+}
+
+static int image_cache_worker(void* arg) {
+    (void)arg;
+
+    SDL_LockMutex(g_lock);
+    while (!g_quit) {
+        struct BackendImage* job = g_jobs_head;
+        SDL_Surface* surface;
+
+        if (!job) {
+            SDL_CondWait(g_cond, g_lock);
+            continue;
+        }
+        g_jobs_head = job->job_next;
+        if (!g_jobs_head) {
+            g_jobs_tail = NULL;
+        }
+        SDL_UnlockMutex(g_lock);
+
+        surface = image_cache_decode(job->path, job->max_w, job->max_h);
+
+        SDL_LockMutex(g_lock);
+        job->surface = surface;
+        job->job_next = g_done;
+        g_done = job;
+        // 唤醒可能阻塞在 SDL_WaitEvent 的主循环，backend_wake 自行合并多次调用
+        backend_wake();
+    }
+    SDL_UnlockMutex(g_lock);
+    return 0;
+}
+
+static void image_cache_start(void) {
+    int count;
+
+    if (g_started) {
+        return;
+    }
+    g_started = 1;
+    g_quit = 0;
+
+#if IMAGE_CACHE_THREADS
+    g_lock = SDL_CreateMutex();
+    g_cond = SDL_CreateCond();
+    if (!g_lock || !g_cond) {
+        printf("image cache: no mutex, decoding synchronously: %s\n", SDL_GetError());
+        return;
+    }
+
+    count = SDL_GetCPUCount() - 1;
+    if (count < 1) {
+        count = 1;
+    }
+    if (count > SDL_IMAGE_CACHE_WORKERS) {
+        count = SDL_IMAGE_CACHE_WORKERS;
+    }
+    while (g_worker_count < count) {
+        SDL_Thread* thread = SDL_CreateThread(image_cache_worker, "yui-image", NULL);
+        if (!thread) {
+            break;
+        }
+        g_workers[g_worker_count++] = thread;
+    }
+    if (g_worker_count == 0) {
+        printf("image cache: no worker thread, decoding synchronously: %s\n", SDL_GetError());
+    }
+#else
+    (void)count;
+#endif
+}
+
+static void image_cache_lru_remove(struct BackendImage* image) {
+    if (!image->in_lru) {
+        return;
+    }
+    if (image->lru_prev) {
+        image->lru_prev->lru_next = image->lru_next;
+    } else {
+        g_lru_head = image->lru_next;
+    }
+    if (image->lru_next) {
+        image->lru_next->lru_prev = image->lru_prev;
+    } else {
+        g_lru_tail = image->lru_prev;
+    }
+    image->lru_prev = NULL;
+    image->lru_next = NULL;
+    image->in_lru = 0;
+}
+
+static void image_cache_free(struct BackendImage* image) {
+    struct BackendImage** link = &g_buckets[image->hash & (IMAGE_CACHE_BUCKETS - 1)];
+
+    while (*link) {
+        if (*link == image) {
+            *link = image->hash_next;
+            break;
+        }
+        link = &(*link)->hash_next;
+    }
+    image_cache_lru_remove(image);
+    if (image->texture) {
+        SDL_DestroyTexture(image->texture);
+        g_bytes -= image->bytes;
+    }
+    free(image->path);
+    free(image);
+}
+
+// 超出预算时从最久未用的开始释放；仍被引用的纹理不在 LRU 中
+static void image_cache_trim(void) {
+    while (g_bytes > g_budget && g_lru_tail) {
+        image_cache_free(g_lru_tail);
+    }
+}
+
+// 引用归零：成功的进 LRU 留待复用，失败的直接释放（下次再请求时重试）
+static void image_cache_unused(struct BackendImage* image) {
+    if (image->state == IMAGE_FAILED) {
+        image_cache_free(image);
+        return;
+    }
+    image->lru_prev = NULL;
+    image->lru_next = g_lru_head;
+    if (g_lru_head) {
+        g_lru_head->lru_prev = image;
+    } else {
+        g_lru_tail = image;
+    }
+    g_lru_head = image;
+    image->in_lru = 1;
+}
+
+static void image_cache_finish(SDL_Renderer* renderer, struct BackendImage* image,
+                               SDL_Surface* surface) {
+    image->surface = NULL;
+    if (surface) {
+        image->texture = renderer ? SDL_CreateTextureFromSurface(renderer, surface) : NULL;
+        if (image->texture) {
+            image->bytes = (size_t)surface->w * (size_t)surface->h * 4;
+            g_bytes += image->bytes;
+        } else {
+            printf("image cache: upload %s failed: %s\n", image->path, SDL_GetError());
+        }
+        SDL_FreeSurface(surface);
+    }
+    image->state = image->texture ? IMAGE_READY : IMAGE_FAILED;
+    if (image->refcount == 0) {
+        image_cache_unused(image);
+    }
+}
+
+struct BackendImage* sdl_image_cache_acquire(SDL_Renderer* renderer, const char* path,
+                                             int max_w, int max_h) {
+    struct BackendImage* image;
+    unsigned int hash;
+
+    if (!path || !path[0]) {
+        return NULL;
+    }
+    if (max_w < 0 || max_h < 0) {
+        max_w = 0;
+        max_h = 0;
+    }
+
+    hash = image_cache_hash(path, max_w, max_h);
+    for (image = g_buckets[hash & (IMAGE_CACHE_BUCKETS - 1)]; image; image = image->hash_next) {
+        if (image->hash == hash && image->max_w == max_w && image->max_h == max_h &&
+            strcmp(image->path, path) == 0) {
+            image_cache_lru_remove(image);
+            image->refcount++;
+            return image;
+        }
+    }
+
+    image = (struct BackendImage*)calloc(1, sizeof(struct BackendImage));
+    if (!image) {
+        return NULL;
+    }
+    image->path = strdup(path);
+    if (!image->path) {
+        free(image);
+        return NULL;
+    }
+    image->max_w = max_w;
+    image->max_h = max_h;
+    image->hash = hash;
+    image->refcount = 1;
+    image->state = IMAGE_PENDING;
+    image->hash_next = g_buckets[hash & (IMAGE_CACHE_BUCKETS - 1)];
+    g_buckets[hash & (IMAGE_CACHE_BUCKETS - 1)] = image;
+
+    image_cache_start();
+    if (g_worker_count > 0) {
+        SDL_LockMutex(g_lock);
+        if (g_jobs_tail) {
+            g_jobs_tail->job_next = image;
+        } else {
+            g_jobs_head = image;
+        }
+        g_jobs_tail = image;
+        SDL_CondSignal(g_cond);
+        SDL_UnlockMutex(g_lock);
+    } else {
+        image_cache_finish(renderer, image, image_cache_decode(path, max_w, max_h));
+        image_cache_trim();
+    }
+    return image;
+}
+
+void sdl_image_cache_release(struct BackendImage* image) {
+    if (!image || image->refcount <= 0) {
+        return;
+    }
+    if (--image->refcount > 0 || image->state == IMAGE_PENDING) {
+        return;  // 解码中的在上传时再处理
+    }
+    image_cache_unused(image);
+    image_cache_trim();
+}
+
+SDL_Texture* sdl_image_cache_texture(struct BackendImage* image) {
+    return image && image->state == IMAGE_READY ? image->texture : NULL;
+}
+
+int sdl_image_cache_failed(struct BackendImage* image) {
+    return image && image->state == IMAGE_FAILED;
+}
+
+int sdl_image_cache_pump(SDL_Renderer* renderer) {
+    struct BackendImage* done;
+    int count = 0;
+
+    if (g_worker_count == 0) {
+        return 0;
+    }
+
+    SDL_LockMutex(g_lock);
+    done = g_done;
+    g_done = NULL;
+    SDL_UnlockMutex(g_lock);
+
+    while (done) {
+        struct BackendImage* next = done->job_next;
+        done->job_next = NULL;
+        image_cache_finish(renderer, done, done->surface);
+        count++;
+        done = next;
+    }
+    if (count > 0) {
+        image_cache_trim();
+    }
+    return count;
+}
+
+void sdl_image_cache_set_budget(size_t bytes) {
+    g_budget = bytes;
+    image_cache_trim();
+}
+
+size_t sdl_image_cache_bytes(void) {
+    return g_bytes;
+}
+
+void sdl_image_cache_destroy(void) {
+    struct BackendImage* job;
+    int i;
+
+    if (g_worker_count > 0) {
+        SDL_LockMutex(g_lock);
+        g_quit = 1;
+        SDL_CondBroadcast(g_cond);
+        SDL_UnlockMutex(g_lock);
+        for (i = 0; i < g_worker_count; i++) {
+            SDL_WaitThread(g_workers[i], NULL);
+        }
+        g_worker_count = 0;
+    }
+
+    // 线程已停：未上传的解码结果直接丢弃，按失败处理
+    for (job = g_done; job; job = job->job_next) {
+        if (job->surface) {
+            SDL_FreeSurface(job->surface);
+            job->surface = NULL;
+        }
+        job->state = IMAGE_FAILED;
+    }
+    for (job = g_jobs_head; job; job = job->job_next) {
+        job->state = IMAGE_FAILED;
+    }
+    g_done = NULL;
+    g_jobs_head = NULL;
+    g_jobs_tail = NULL;
+
+    // 仍被图层持有的条目只释放纹理，留到 release 时再释放结构体
+    for (i = 0; i < IMAGE_CACHE_BUCKETS; i++) {
+        struct BackendImage* image = g_buckets[i];
+        while (image) {
+            struct BackendImage* next = image->hash_next;
+            image->job_next = NULL;
+            if (image->refcount == 0) {
+                image_cache_free(image);
+            } else {
+                if (image->texture) {
+                    SDL_DestroyTexture(image->texture);
+                    image->texture = NULL;
+                    g_bytes -= image->bytes;
+                }
+                image->state = IMAGE_FAILED;
+            }
+            image = next;
+        }
+    }
+
+    if (g_cond) {
+        SDL_DestroyCond(g_cond);
+        g_cond = NULL;
+    }
+    if (g_lock) {
+        SDL_DestroyMutex(g_lock);
+        g_lock = NULL;
+    }
+    g_started = 0;
+}
+
+#endif
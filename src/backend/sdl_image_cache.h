@@ -0,0 +1,40 @@
+#ifndef SDL_IMAGE_CACHE_H
+#define SDL_IMAGE_CACHE_H
+
+#include "ytype.h"
+
+#ifndef YUI_BACKEND_EMBEDDED
+
+/* 图片纹理缓存：按 (路径, 目标尺寸) 共享，引用计数。
+   解码（IMG_Load + 可选缩小）在后台线程池完成，纹理上传在渲染线程
+   sdl_image_cache_pump 中进行；建不了线程时（如无 pthread 的 Emscripten）在
+   acquire 中同步解码。引用归零的纹理留在 LRU 中，超出字节预算时从最久未用的释放。 */
+
+#define SDL_IMAGE_CACHE_BUDGET (64u * 1024u * 1024u)  // 默认字节预算
+#define SDL_IMAGE_CACHE_WORKERS 4                     // 解码线程上限
+
+struct BackendImage;
+
+/* 取图片（引用计数 +1），max_w/max_h 为设备像素，>0 时解码后等比缩小到
+   刚好覆盖该尺寸（不放大）；失败返回 NULL */
+struct BackendImage* sdl_image_cache_acquire(SDL_Renderer* renderer, const char* path,
+                                             int max_w, int max_h);
+void sdl_image_cache_release(struct BackendImage* image);
+
+// 未就绪或解码失败返回 NULL
+SDL_Texture* sdl_image_cache_texture(struct BackendImage* image);
+int sdl_image_cache_failed(struct BackendImage* image);
+
+/* 渲染线程每帧调用：上传解码完成的图片，返回本次上传（或确认失败）的数量。
+   有完成项时调用方应整屏记脏。 */
+int sdl_image_cache_pump(SDL_Renderer* renderer);
+
+void sdl_image_cache_set_budget(size_t bytes);
+size_t sdl_image_cache_bytes(void);
+
+// 停止线程并释放全部纹理（SDL 退出前调用）
+void sdl_image_cache_destroy(void);
+
+#endif
+
+#endif
@@ -505,19 +505,13 @@ void button_component_render(Layer* layer) {
     }
     int density = yui_density;
 
-    // --- 测量文本 ---
-    Texture* text_tex = NULL;
+    // --- 测量文本（逻辑像素，不生成纹理） ---
+    const char* text_draw = NULL;
     int text_w = 0, text_h = 0;
-    if (has_text) {
-        text_tex = render_text(layer, layer_text, text_color);
-        if (text_tex) {
-            int tw, th;
-            backend_query_texture(text_tex, NULL, NULL, &tw, &th);
-            text_w = tw / density;
-            text_h = th / density;
-            if (text_w < 1) text_w = 1;
-            if (text_h < 1) text_h = 1;
-        }
+    if (has_text && render_text_size(layer, layer_text, &text_w, &text_h) == 0) {
+        text_draw = layer_text;
+        if (text_w < 1) text_w = 1;
+        if (text_h < 1) text_h = 1;
     }
 
     // --- 渲染图标 ---
@@ -578,7 +572,7 @@ void button_component_render(Layer* layer) {
 
     // --- 仅有文本（保持原位置逻辑） ---
     if (!has_icon) {
-        if (text_tex) {
+        if (text_draw) {
             int avail_w = layer->rect.w - pad_left - pad_right;
             int avail_h = layer->rect.h - pad_top - pad_bottom;
             if (avail_w < 1) avail_w = 1;
@@ -596,8 +590,7 @@ void button_component_render(Layer* layer) {
             int text_x = layer->rect.x + (layer->rect.w - text_w) / 2;
             int text_y = layer->rect.y + (layer->rect.h - text_h) / 2;
             Rect tr = {text_x, text_y, text_w, text_h};
-            backend_render_text_copy(text_tex, NULL, &tr);
-            backend_render_text_destroy(text_tex);
+            render_text_at(layer, text_draw, text_color, &tr);
         }
         return;
     }
@@ -617,62 +610,27 @@ void button_component_render(Layer* layer) {
         avail_text_w = content_w;
     if (avail_text_w < 8) avail_text_w = 8;
 
-    if (text_tex) backend_render_text_destroy(text_tex);
-    text_tex = NULL;
-    text_w = 0; text_h = 0;
-
-    {
-        int need_trunc = 0;
-        if (layer->font && layer->font->default_font) {
-            Texture* mt = backend_render_texture(layer->font->default_font, layer_text, (Color){0,0,0,255});
-            if (mt) {
-                int mw;
-                backend_query_texture(mt, NULL, NULL, &mw, NULL);
-                backend_render_text_destroy(mt);
-                if (mw / density > avail_text_w) need_trunc = 1;
-            }
+    char* truncated = NULL;
+    if (text_draw && text_w > avail_text_w) {
+        int byte_len = (int)strlen(layer_text);
+        truncated = malloc((size_t)byte_len + 4);
+        while (truncated && byte_len > 0) {
+            int safe_len = utf8_safe_prefix_bytes(layer_text, byte_len);
+            if (safe_len <= 0) break;
+            memcpy(truncated, layer_text, (size_t)safe_len);
+            truncated[safe_len] = '\0';
+            strcat(truncated, "...");
+            int sw;
+            if (render_text_size(layer, truncated, &sw, NULL) == 0 && sw <= avail_text_w) break;
+            byte_len = utf8_prev_prefix_bytes(layer_text, safe_len);
         }
-
-        if (need_trunc) {
-            int byte_len = (int)strlen(layer_text);
-            char* truncated = malloc((size_t)byte_len + 4);
-            while (byte_len > 0) {
-                int safe_len = utf8_safe_prefix_bytes(layer_text, byte_len);
-                if (safe_len <= 0) break;
-                memcpy(truncated, layer_text, (size_t)safe_len);
-                truncated[safe_len] = '\0';
-                strcat(truncated, "...");
-                Texture* st = backend_render_texture(layer->font->default_font, truncated, (Color){0,0,0,255});
-                if (st) {
-                    int sw;
-                    backend_query_texture(st, NULL, NULL, &sw, NULL);
-                    backend_render_text_destroy(st);
-                    if (sw / density <= avail_text_w) break;
-                }
-                byte_len = utf8_prev_prefix_bytes(layer_text, safe_len);
-            }
-            if (byte_len > 0) {
-                text_tex = render_text(layer, truncated, text_color);
-                if (text_tex) {
-                    int tw, th;
-                    backend_query_texture(text_tex, NULL, NULL, &tw, &th);
-                    text_w = tw / density;
-                    text_h = th / density;
-                    if (text_w < 1) text_w = 1;
-                    if (text_h < 1) text_h = 1;
-                }
-            }
-            free(truncated);
+        text_draw = (truncated && byte_len > 0) ? truncated : NULL;
+        text_w = 0; text_h = 0;
+        if (text_draw && render_text_size(layer, text_draw, &text_w, &text_h) == 0) {
+            if (text_w < 1) text_w = 1;
+            if (text_h < 1) text_h = 1;
         } else {
-            text_tex = render_text(layer, layer_text, text_color);
-            if (text_tex) {
-                int tw, th;
-                backend_query_texture(text_tex, NULL, NULL, &tw, &th);
-                text_w = tw / density;
-                text_h = th / density;
-                if (text_w < 1) text_w = 1;
-                if (text_h < 1) text_h = 1;
-            }
+            text_draw = NULL;
         }
     }
 
@@ -686,7 +644,7 @@ void button_component_render(Layer* layer) {
             Rect tr = {start_x + icon_w + gap, start_y + (block_h - text_h) / 2, text_w, text_h};
             if (icon_is_path) backend_render_texture_tinted(icon_tex, NULL, &ir, text_color);
             else backend_render_text_copy(icon_tex, NULL, &ir);
-            if (text_tex) { backend_render_text_copy(text_tex, NULL, &tr); backend_render_text_destroy(text_tex); }
+            if (text_draw) render_text_at(layer, text_draw, text_color, &tr);
             break;
         }
         case ICON_ALIGN_RIGHT: {
@@ -696,7 +654,7 @@ void button_component_render(Layer* layer) {
             int start_y = layer->rect.y + pad_top + (content_h - block_h) / 2;
             Rect tr = {start_x, start_y + (block_h - text_h) / 2, text_w, text_h};
             Rect ir = {start_x + text_w + gap, start_y + (block_h - icon_h) / 2, icon_w, icon_h};
-            if (text_tex) { backend_render_text_copy(text_tex, NULL, &tr); backend_render_text_destroy(text_tex); }
+            if (text_draw) render_text_at(layer, text_draw, text_color, &tr);
             if (icon_is_path) backend_render_texture_tinted(icon_tex, NULL, &ir, text_color);
             else backend_render_text_copy(icon_tex, NULL, &ir);
             break;
@@ -726,7 +684,7 @@ void button_component_render(Layer* layer) {
             Rect tr = {layer->rect.x + (layer->rect.w - text_w) / 2, start_y + use_icon_h + gap, text_w, text_h};
             if (icon_is_path) backend_render_texture_tinted(icon_tex, NULL, &ir, text_color);
             else backend_render_text_copy(icon_tex, NULL, &ir);
-            if (text_tex) { backend_render_text_copy(text_tex, NULL, &tr); backend_render_text_destroy(text_tex); }
+            if (text_draw) render_text_at(layer, text_draw, text_color, &tr);
             break;
         }
         case ICON_ALIGN_BOTTOM: {
@@ -742,7 +700,7 @@ void button_component_render(Layer* layer) {
             total_h = text_h + gap + icon_h;
             int start_y = layer->rect.y + pad_top + (content_h - total_h) / 2;
             Rect tr = {layer->rect.x + (layer->rect.w - text_w) / 2, start_y, text_w, text_h};
-            if (text_tex) { backend_render_text_copy(text_tex, NULL, &tr); backend_render_text_destroy(text_tex); }
+            if (text_draw) render_text_at(layer, text_draw, text_color, &tr);
             Rect ir = {layer->rect.x + (layer->rect.w - icon_w) / 2, start_y + text_h + gap, icon_w, icon_h};
             if (icon_is_path) backend_render_texture_tinted(icon_tex, NULL, &ir, text_color);
             else backend_render_text_copy(icon_tex, NULL, &ir);
@@ -750,5 +708,6 @@ void button_component_render(Layer* layer) {
         }
     }
 
+    free(truncated);
     if (icon_tex_owned) backend_render_text_destroy(icon_tex);
 }
\ No newline at end of file
@@ -2,11 +2,14 @@
 #include "../backend.h"
 #include "../event.h"
 #include "../util.h"
+#include "../damage.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
 
+#define CLOCK_REDRAW_MS 250  // 秒针刷新间隔
+
 static void clock_layer_destroy(Layer* layer) {
     if (!layer || !layer->component) {
         return;
@@ -221,6 +224,8 @@ void clock_component_render(Layer* layer) {
     
     // 更新时间
     clock_component_update_time(component);
+    // 指针按秒走动，定时请求重绘自身区域
+    damage_add_layer_at(layer, backend_get_ticks() + CLOCK_REDRAW_MS);
     
     int center_x = layer->rect.x + layer->rect.w / 2;
     int center_y = layer->rect.y + layer->rect.h / 2;
@@ -6,6 +6,7 @@
 #include "../layer.h"
 #include "../util.h"
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +36,31 @@ typedef struct ConnectorDragState {
 
 static ConnectorDragState g_connector_drag;
 
+// 画布端点表：(端点图层, 锚点, 端) -> 画布上连到该端点的连线，按子节点顺序排列
+typedef struct ConnectorFanSlot {
+    Layer* layer;       // NULL 为空槽
+    int key;            // anchor * 2 + at_from_end
+    int start;          // 在 items 中的起点
+    int count;
+} ConnectorFanSlot;
+
+typedef struct ConnectorFanMap {
+    Layer* canvas;
+    ConnectorFanSlot* slots;
+    int slot_cap;
+    int slot_alloc;
+    ConnectorComponent** items;
+    int item_alloc;
+} ConnectorFanMap;
+
+static ConnectorFanMap* g_fan_maps = NULL;
+static int g_fan_map_count = 0;
+static int g_fan_map_cap = 0;
+static unsigned int g_fan_topology = 1;        // 连线增删、改端点时递增
+static unsigned int g_fan_built_topology = 0;
+static unsigned int g_fan_built_generation = 0;
+static Layer* g_fan_built_root = NULL;
+
 static void connector_merge_anchor_entry(ConnectorAnchorEntry* entries,
                                          int* entry_count, int max_entries,
                                          Layer* layer, ConnectorAnchor anchor)
@@ -73,6 +99,40 @@ Layer* connector_resolve_endpoint(const char* id_or_path)
     return find_layer_by_id(g_ui_root, id_or_path);
 }
 
+static void connector_topology_changed(void)
+{
+    if (++g_fan_topology == 0) {
+        g_fan_topology = 1;
+    }
+}
+
+// from_id/to_id 改写后调用
+static void connector_endpoints_changed(ConnectorComponent* component)
+{
+    if (component) {
+        component->resolve_generation = 0;
+    }
+    connector_topology_changed();
+}
+
+// 端点按 id 解析后缓存，图层登记/移除（创建、改 id、销毁）后重新解析；
+// 路径形式的端点依赖子节点下标，每次都重新解析
+static void connector_resolve_cached(ConnectorComponent* component)
+{
+    unsigned int generation = layer_index_generation();
+
+    if (component->resolve_generation == generation &&
+        component->resolve_root == g_ui_root) {
+        return;
+    }
+
+    component->from_layer = connector_resolve_endpoint(component->from_id);
+    component->to_layer = connector_resolve_endpoint(component->to_id);
+    component->resolve_root = g_ui_root;
+    component->resolve_generation =
+        (strchr(component->from_id, '.') || strchr(component->to_id, '.')) ? 0 : generation;
+}
+
 int connector_layer_is_connectable(Layer* layer)
 {
     if (!layer) {
@@ -195,8 +255,9 @@ static void connector_emit_connect_change(Layer* layer, ConnectorComponent* comp
 
     connector_dispatch_connect_change(layer, detail, component->on_connect_change_name);
 
-    from_layer = connector_resolve_endpoint(component->from_id);
-    to_layer = connector_resolve_endpoint(component->to_id);
+    connector_resolve_cached(component);
+    from_layer = component->from_layer;
+    to_layer = component->to_layer;
     from_host = from_layer ? connector_find_draggable_host(from_layer) : NULL;
     to_host = to_layer ? connector_find_draggable_host(to_layer) : NULL;
 
@@ -238,16 +299,9 @@ static int connector_component_register_event(Layer* layer, const char* event_na
 static void connector_collect_endpoint_for_draggable(Layer* root, Layer* draggable,
                                                      ConnectorAnchorEntry* entries,
                                                      int* entry_count, int max_entries,
-                                                     const char* endpoint_id,
+                                                     Layer* endpoint,
                                                      ConnectorAnchor anchor)
 {
-    Layer* endpoint;
-
-    if (!endpoint_id || !endpoint_id[0]) {
-        return;
-    }
-
-    endpoint = connector_resolve_endpoint(endpoint_id);
     if (!endpoint || !connector_layer_is_connectable(endpoint)) {
         return;
     }
@@ -272,11 +326,12 @@ static void connector_walk_connectors_for_draggable(Layer* root, Layer* draggabl
 
     if (root->type == CONNECTOR && root->component) {
         component = (ConnectorComponent*)root->component;
+        connector_resolve_cached(component);
         connector_collect_endpoint_for_draggable(root, draggable, entries, entry_count,
-                                               max_entries, component->from_id,
+                                               max_entries, component->from_layer,
                                                component->from_anchor);
         connector_collect_endpoint_for_draggable(root, draggable, entries, entry_count,
-                                               max_entries, component->to_id,
+                                               max_entries, component->to_layer,
                                                component->to_anchor);
     }
 
@@ -428,60 +483,202 @@ static void connector_apply_endpoint_fanout(Layer* canvas, Layer* ep_layer,
                                             int at_from_end, ConnectorComponent* self,
                                             int pending_extra, int* x, int* y);
 
-static int connector_same_endpoint(Layer* layer_a, ConnectorAnchor anchor_a,
-                                   Layer* layer_b, ConnectorAnchor anchor_b)
+static unsigned int connector_fan_hash(Layer* layer, int key)
 {
-    return layer_a && layer_b && layer_a == layer_b && anchor_a == anchor_b;
+    uintptr_t h = ((uintptr_t)layer >> 4) ^ ((uintptr_t)key * 0x9E3779B1u);
+    return (unsigned int)(h * 2654435761u);
 }
 
-static int connector_count_endpoint_usage(Layer* canvas, Layer* ep_layer,
-                                          ConnectorAnchor ep_anchor,
-                                          int at_from_end, ConnectorComponent* self,
-                                          int* out_index, int* out_total)
+static ConnectorFanSlot* connector_fan_find(ConnectorFanMap* map, Layer* layer, int key,
+                                            int insert)
 {
-    int i;
-    int total = 0;
-    int index = 0;
+    unsigned int mask;
+    unsigned int i;
 
-    if (!canvas || !ep_layer || !out_index || !out_total) {
-        return 0;
+    if (!map || map->slot_cap <= 0) {
+        return NULL;
     }
 
-    *out_index = 0;
-    *out_total = 0;
+    mask = (unsigned int)map->slot_cap - 1;
+    i = connector_fan_hash(layer, key) & mask;
+    while (map->slots[i].layer) {
+        if (map->slots[i].layer == layer && map->slots[i].key == key) {
+            return &map->slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+    if (!insert) {
+        return NULL;
+    }
+
+    map->slots[i].layer = layer;
+    map->slots[i].key = key;
+    map->slots[i].start = 0;
+    map->slots[i].count = 0;
+    return &map->slots[i];
+}
+
+static int connector_fan_map_build(ConnectorFanMap* map, Layer* canvas)
+{
+    int connectors = 0;
+    int cap = 16;
+    int offset = 0;
+    int pass;
+    int i;
 
     for (i = 0; i < canvas->child_count; i++) {
         Layer* child = canvas->children[i];
-        ConnectorComponent* other;
-        Layer* from_layer;
-        Layer* to_layer;
+        if (child && child->type == CONNECTOR && child->component) {
+            connectors++;
+        }
+    }
 
-        if (!child || child->type != CONNECTOR || !child->component) {
-            continue;
+    // 每条连线两个键，负载不超过 1/2
+    while (cap < connectors * 4) {
+        cap <<= 1;
+    }
+    if (cap > map->slot_alloc) {
+        ConnectorFanSlot* slots =
+            (ConnectorFanSlot*)realloc(map->slots, (size_t)cap * sizeof(ConnectorFanSlot));
+        if (!slots) {
+            return 0;
+        }
+        map->slots = slots;
+        map->slot_alloc = cap;
+    }
+    if (connectors * 2 > map->item_alloc) {
+        ConnectorComponent** items = (ConnectorComponent**)realloc(
+            map->items, (size_t)connectors * 2 * sizeof(ConnectorComponent*));
+        if (!items) {
+            return 0;
         }
+        map->items = items;
+        map->item_alloc = connectors * 2;
+    }
+    memset(map->slots, 0, (size_t)cap * sizeof(ConnectorFanSlot));
+    map->slot_cap = cap;
+    map->canvas = canvas;
+
+    // 第一遍计数，第二遍按子节点顺序填入，序号即为扇出位置
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < canvas->child_count; i++) {
+            Layer* child = canvas->children[i];
+            ConnectorComponent* component;
+            int end;
 
-        other = (ConnectorComponent*)child->component;
-        from_layer = connector_resolve_endpoint(other->from_id);
-        to_layer = connector_resolve_endpoint(other->to_id);
-        if (at_from_end) {
-            if (!connector_same_endpoint(from_layer, other->from_anchor, ep_layer,
-                                         ep_anchor)) {
+            if (!child || child->type != CONNECTOR || !child->component) {
                 continue;
             }
-        } else if (!connector_same_endpoint(to_layer, other->to_anchor, ep_layer,
-                                             ep_anchor)) {
-            continue;
+
+            component = (ConnectorComponent*)child->component;
+            if (pass == 0) {
+                connector_resolve_cached(component);
+            }
+            component->fan_canvas = canvas;
+            for (end = 0; end < 2; end++) {
+                Layer* ep_layer = end ? component->from_layer : component->to_layer;
+                ConnectorAnchor ep_anchor = end ? component->from_anchor : component->to_anchor;
+                ConnectorFanSlot* slot;
+
+                if (!ep_layer) {
+                    continue;
+                }
+                slot = connector_fan_find(map, ep_layer, (int)ep_anchor * 2 + end, pass == 0);
+                if (pass == 0) {
+                    slot->count++;
+                } else {
+                    component->fan_index[end] = slot->count;
+                    map->items[slot->start + slot->count++] = component;
+                }
+            }
         }
 
-        if (self && other == self) {
-            index = total;
+        if (pass == 0) {
+            for (i = 0; i < cap; i++) {
+                if (map->slots[i].layer) {
+                    map->slots[i].start = offset;
+                    offset += map->slots[i].count;
+                    map->slots[i].count = 0;
+                }
+            }
         }
-        total++;
     }
 
-    *out_index = index;
-    *out_total = total;
-    return total;
+    return 1;
+}
+
+// 取画布的端点表；连线增删、改端点或图层 id 变化后整体失效，各画布用到时重建
+static ConnectorFanMap* connector_fan_map(Layer* canvas)
+{
+    unsigned int generation = layer_index_generation();
+    ConnectorFanMap* map;
+    int i;
+
+    if (!canvas) {
+        return NULL;
+    }
+
+    if (g_fan_built_topology != g_fan_topology || g_fan_built_generation != generation ||
+        g_fan_built_root != g_ui_root) {
+        g_fan_map_count = 0;
+        g_fan_built_topology = g_fan_topology;
+        g_fan_built_generation = generation;
+        g_fan_built_root = g_ui_root;
+    }
+
+    for (i = 0; i < g_fan_map_count; i++) {
+        if (g_fan_maps[i].canvas == canvas) {
+            return &g_fan_maps[i];
+        }
+    }
+
+    if (g_fan_map_count == g_fan_map_cap) {
+        int cap = g_fan_map_cap ? g_fan_map_cap * 2 : 4;
+        ConnectorFanMap* maps =
+            (ConnectorFanMap*)realloc(g_fan_maps, (size_t)cap * sizeof(ConnectorFanMap));
+        if (!maps) {
+            return NULL;
+        }
+        memset(maps + g_fan_map_cap, 0, (size_t)(cap - g_fan_map_cap) * sizeof(ConnectorFanMap));
+        g_fan_maps = maps;
+        g_fan_map_cap = cap;
+    }
+
+    map = &g_fan_maps[g_fan_map_count];
+    if (!connector_fan_map_build(map, canvas)) {
+        return NULL;
+    }
+    g_fan_map_count++;
+    return map;
+}
+
+static int connector_count_endpoint_usage(Layer* canvas, Layer* ep_layer,
+                                          ConnectorAnchor ep_anchor,
+                                          int at_from_end, ConnectorComponent* self,
+                                          int* out_index, int* out_total)
+{
+    ConnectorFanSlot* slot;
+    int end = at_from_end ? 1 : 0;
+
+    if (!canvas || !ep_layer || !out_index || !out_total) {
+        return 0;
+    }
+
+    *out_index = 0;
+    *out_total = 0;
+
+    slot = connector_fan_find(connector_fan_map(canvas), ep_layer, (int)ep_anchor * 2 + end, 0);
+    if (!slot) {
+        return 0;
+    }
+
+    if (self && self->fan_canvas == canvas && self->layer && self->layer->parent == canvas &&
+        (end ? self->from_layer : self->to_layer) == ep_layer &&
+        (end ? self->from_anchor : self->to_anchor) == ep_anchor) {
+        *out_index = self->fan_index[end];
+    }
+    *out_total = slot->count;
+    return slot->count;
 }
 
 static void connector_apply_endpoint_fanout(Layer* canvas, Layer* ep_layer,
@@ -535,8 +732,9 @@ static int connector_get_component_geometry(ConnectorComponent* component,
         return 0;
     }
 
-    from_layer = connector_resolve_endpoint(component->from_id);
-    to_layer = connector_resolve_endpoint(component->to_id);
+    connector_resolve_cached(component);
+    from_layer = component->from_layer;
+    to_layer = component->to_layer;
     if (!from_layer || !to_layer ||
         !connector_layer_is_connectable(from_layer) ||
         !connector_layer_is_connectable(to_layer)) {
@@ -590,6 +788,74 @@ static void connector_bezier_point(int x0, int y0, int cx1, int cy1,
     *out_y = (int)(uuu * y0 + 3.0f * uu * t * cy1 + 3.0f * u * tt * cy2 + ttt * y1);
 }
 
+// 点到线段距离的平方
+static int connector_segment_dist_sq(int x, int y, int ax, int ay, int bx, int by)
+{
+    long long dx = bx - ax;
+    long long dy = by - ay;
+    long long len_sq = dx * dx + dy * dy;
+    long long dot;
+    float t;
+    float ex;
+    float ey;
+
+    if (len_sq == 0) {
+        return connector_dist_sq(x, y, ax, ay);
+    }
+
+    dot = (long long)(x - ax) * dx + (long long)(y - ay) * dy;
+    if (dot <= 0) {
+        return connector_dist_sq(x, y, ax, ay);
+    }
+    if (dot >= len_sq) {
+        return connector_dist_sq(x, y, bx, by);
+    }
+
+    t = (float)dot / (float)len_sq;
+    ex = x - (ax + t * (float)dx);
+    ey = y - (ay + t * (float)dy);
+    return (int)(ex * ex + ey * ey);
+}
+
+// 曲线展平成折线并求包围盒；端点与控制点不变时沿用上次结果
+static void connector_update_curve(ConnectorComponent* component, const int geometry[8])
+{
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    int j;
+
+    if (component->curve_valid &&
+        memcmp(component->curve_geometry, geometry, sizeof(component->curve_geometry)) == 0) {
+        return;
+    }
+
+    memcpy(component->curve_geometry, geometry, sizeof(component->curve_geometry));
+    min_x = max_x = geometry[0];
+    min_y = max_y = geometry[1];
+    for (j = 0; j <= CONNECTOR_CURVE_SEGMENTS; j++) {
+        int px;
+        int py;
+
+        connector_bezier_point(geometry[0], geometry[1], geometry[4], geometry[5],
+                               geometry[6], geometry[7], geometry[2], geometry[3],
+                               (float)j / CONNECTOR_CURVE_SEGMENTS, &px, &py);
+        component->curve_x[j] = px;
+        component->curve_y[j] = py;
+        if (px < min_x) min_x = px;
+        if (px > max_x) max_x = px;
+        if (py < min_y) min_y = py;
+        if (py > max_y) max_y = py;
+    }
+
+    component->curve_bounds.x = min_x;
+    component->curve_bounds.y = min_y;
+    component->curve_bounds.w = max_x - min_x;
+    component->curve_bounds.h = max_y - min_y;
+    component->curve_valid = 1;
+}
+
 static void connector_remove_child_layer(Layer* parent, Layer* child);
 static void connector_refresh_canvas_draggbles(Layer* canvas);
 
@@ -649,6 +915,7 @@ ConnectorComponent* connector_component_create(Layer* layer)
     component->stroke_width = 2;
 
     layer->component = component;
+    connector_topology_changed();
     layer->render = connector_component_render;
     layer->register_event = connector_component_register_event;
     layer->on_destroy = connector_layer_destroy;
@@ -730,6 +997,7 @@ ConnectorComponent* connector_component_create_from_json(Layer* layer, cJSON* js
         }
     }
 
+    connector_endpoints_changed(component);
     return component;
 }
 
@@ -737,6 +1005,7 @@ void connector_component_destroy(ConnectorComponent* component)
 {
     if (component) {
         free(component);
+        connector_topology_changed();
     }
 }
 
@@ -848,11 +1117,12 @@ static void connector_merge_anchors_for_draggable_tree(Layer* root, Layer* dragg
 
     if (root->type == CONNECTOR && root->component) {
         component = (ConnectorComponent*)root->component;
+        connector_resolve_cached(component);
         connector_collect_endpoint_for_draggable(root, draggable, entries, entry_count,
-                                               max_entries, component->from_id,
+                                               max_entries, component->from_layer,
                                                component->from_anchor);
         connector_collect_endpoint_for_draggable(root, draggable, entries, entry_count,
-                                               max_entries, component->to_id,
+                                               max_entries, component->to_layer,
                                                component->to_anchor);
     }
 
@@ -1051,17 +1321,8 @@ static int connector_hit_test_curve(Layer* canvas, int x, int y, int threshold,
     int i;
     int best_dist = -1;
     Layer* best_layer = NULL;
-    int x0;
-    int y0;
-    int x1;
-    int y1;
-    int cx1;
-    int cy1;
-    int cx2;
-    int cy2;
+    int geometry[8];
     int j;
-    int px;
-    int py;
     int dist;
     int limit;
 
@@ -1074,21 +1335,30 @@ static int connector_hit_test_curve(Layer* canvas, int x, int y, int threshold,
     for (i = 0; i < canvas->child_count; i++) {
         Layer* child = canvas->children[i];
         ConnectorComponent* component;
+        Rect* bounds;
 
         if (!child || child->type != CONNECTOR || !child->component) {
             continue;
         }
 
         component = (ConnectorComponent*)child->component;
-        if (!connector_get_component_geometry(component, &x0, &y0, &x1, &y1,
-                                              &cx1, &cy1, &cx2, &cy2)) {
+        if (!connector_get_component_geometry(component, &geometry[0], &geometry[1],
+                                              &geometry[2], &geometry[3], &geometry[4],
+                                              &geometry[5], &geometry[6], &geometry[7])) {
+            continue;
+        }
+
+        connector_update_curve(component, geometry);
+        bounds = &component->curve_bounds;
+        if (x < bounds->x - threshold || x > bounds->x + bounds->w + threshold ||
+            y < bounds->y - threshold || y > bounds->y + bounds->h + threshold) {
             continue;
         }
 
-        for (j = 0; j <= 24; j++) {
-            connector_bezier_point(x0, y0, cx1, cy1, cx2, cy2, x1, y1,
-                                   j / 24.0f, &px, &py);
-            dist = connector_dist_sq(x, y, px, py);
+        for (j = 0; j < CONNECTOR_CURVE_SEGMENTS; j++) {
+            dist = connector_segment_dist_sq(x, y, component->curve_x[j], component->curve_y[j],
+                                             component->curve_x[j + 1],
+                                             component->curve_y[j + 1]);
             if (dist <= limit && (best_dist < 0 || dist < best_dist)) {
                 best_dist = dist;
                 best_layer = child;
@@ -1117,8 +1387,9 @@ static int connector_endpoint_matches(ConnectorComponent* component,
         return 0;
     }
 
-    from_layer = connector_resolve_endpoint(component->from_id);
-    to_layer = connector_resolve_endpoint(component->to_id);
+    connector_resolve_cached(component);
+    from_layer = component->from_layer;
+    to_layer = component->to_layer;
     return (from_layer == endpoint && component->from_anchor == anchor) ||
            (to_layer == endpoint && component->to_anchor == anchor);
 }
@@ -1264,8 +1535,7 @@ static void connector_sync_pick_layer(Layer* canvas)
         }
 
         pick->type = VIEW;
-        strncpy(pick->id, "_connector_pick", sizeof(pick->id) - 1);
-        pick->id[sizeof(pick->id) - 1] = '\0';
+        layer_set_id(pick, "_connector_pick");
         pick->bg_color.a = 0;
         pick->focusable = 0;
         pick->pointer_passthrough = 1;
@@ -1342,6 +1612,7 @@ static int connector_canvas_insert_layer(Layer* canvas, Layer* connector_layer)
     canvas->children = children;
     canvas->child_count = count + 1;
     connector_layer->parent = canvas;
+    connector_topology_changed();
     return 0;
 }
 
@@ -1365,8 +1636,7 @@ Layer* connector_create_link(Layer* canvas, Layer* from_layer, ConnectorAnchor f
     }
 
     snprintf(edge_id, sizeof(edge_id), "edge_drag_%d", ++s_edge_counter);
-    strncpy(layer->id, edge_id, sizeof(layer->id) - 1);
-    layer->id[sizeof(layer->id) - 1] = '\0';
+    layer_set_id(layer, edge_id);
     layer->type = CONNECTOR;
     layer->visible = VISIBLE;
     layer->focusable = 0;
@@ -1381,6 +1651,7 @@ Layer* connector_create_link(Layer* canvas, Layer* from_layer, ConnectorAnchor f
     connector_layer_endpoint_id(to_layer, component->to_id, sizeof(component->to_id));
     component->from_anchor = from_anchor;
     component->to_anchor = to_anchor;
+    connector_endpoints_changed(component);
     component->stroke_color = (Color){137, 180, 250, 255};
     component->stroke_width = 2;
 
@@ -1476,8 +1747,9 @@ static int connector_capture_handle_mouse(Layer* layer, PointerEvent* event)
                 ConnectorAnchor fixed_anchor;
                 int valid = 1;
 
+                connector_resolve_cached(component);
                 if (g_connector_drag.modify_from_end) {
-                    fixed_layer = connector_resolve_endpoint(component->to_id);
+                    fixed_layer = component->to_layer;
                     fixed_anchor = component->to_anchor;
                     if (fixed_layer && to_layer == fixed_layer &&
                         to_anchor == fixed_anchor) {
@@ -1488,7 +1760,7 @@ static int connector_capture_handle_mouse(Layer* layer, PointerEvent* event)
                         component->from_anchor = to_anchor;
                     }
                 } else {
-                    fixed_layer = connector_resolve_endpoint(component->from_id);
+                    fixed_layer = component->from_layer;
                     fixed_anchor = component->from_anchor;
                     if (fixed_layer && to_layer == fixed_layer &&
                         to_anchor == fixed_anchor) {
@@ -1501,6 +1773,7 @@ static int connector_capture_handle_mouse(Layer* layer, PointerEvent* event)
                 }
 
                 if (valid) {
+                    connector_endpoints_changed(component);
                     layout_layer(g_connector_drag.canvas);
                     connector_refresh_canvas_draggbles(g_connector_drag.canvas);
                     connector_emit_connect_change(g_connector_drag.modify_layer,
@@ -1541,8 +1814,7 @@ static int connector_create_capture_layer(void)
     }
 
     capture->type = VIEW;
-    strncpy(capture->id, "_connector_capture", sizeof(capture->id) - 1);
-    capture->id[sizeof(capture->id) - 1] = '\0';
+    layer_set_id(capture, "_connector_capture");
     capture->bg_color.a = 0;
     capture->focusable = 0;
     capture->render = connector_capture_render;
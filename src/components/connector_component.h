@@ -9,6 +9,7 @@ extern "C" {
 #endif
 
 #define CONNECTOR_MAX_ANCHOR_ENTRIES 32
+#define CONNECTOR_CURVE_SEGMENTS 24   // 命中测试时贝塞尔曲线展平的段数
 
 typedef enum {
     CONNECTOR_ANCHOR_CENTER = 0,
@@ -40,6 +41,19 @@ typedef struct ConnectorComponent {
     Color stroke_color;
     int stroke_width;
     char on_connect_change_name[YUI_MAX_PATH];
+
+    // 以下为缓存，由 connector_component.c 维护
+    Layer* from_layer;              // 按 from_id/to_id 解析出的端点
+    Layer* to_layer;
+    Layer* resolve_root;
+    unsigned int resolve_generation; // 对应 layer_index_generation()，0 表示未解析
+    Layer* fan_canvas;              // 所在画布的端点表最近一次重建时写入
+    int fan_index[2];               // 同一端点上的序号，[0] to 端，[1] from 端
+    int curve_geometry[8];          // 展平折线对应的端点与控制点
+    int curve_valid;
+    int curve_x[CONNECTOR_CURVE_SEGMENTS + 1];
+    int curve_y[CONNECTOR_CURVE_SEGMENTS + 1];
+    Rect curve_bounds;
 } ConnectorComponent;
 
 typedef struct ConnectorAnchorEntry {
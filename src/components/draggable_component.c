@@ -289,13 +289,15 @@ static void draggable_sync_dot_overlay(DraggableComponent* component)
     if (!component->dot_overlay) {
         Layer* overlay = layer_create(parent, 0, 0, parent->rect.w, parent->rect.h);
         Layer** children;
+        char overlay_id[YUI_LAYER_ID_MAX];
 
         if (!overlay) {
             return;
         }
 
         overlay->type = VIEW;
-        snprintf(overlay->id, sizeof(overlay->id), "%s_dots", parent->id);
+        snprintf(overlay_id, sizeof(overlay_id), "%s_dots", parent->id);
+        layer_set_id(overlay, overlay_id);
         overlay->bg_color.a = 0;
         overlay->focusable = 0;
         overlay->pointer_passthrough = 1;
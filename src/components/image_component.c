@@ -3,6 +3,7 @@
 #include "../backend.h"
 #include "cJSON.h"
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -16,8 +17,86 @@ static void image_layer_destroy(Layer* layer) {
 
 void* image_component_create_from_json(Layer* layer, cJSON* json)
 {
-    (void)json;
-    return image_component_create(layer);
+    ImageComponent* component = image_component_create(layer);
+    cJSON* downscale = json ? cJSON_GetObjectItem(json, "downscale") : NULL;
+
+    if (component && cJSON_IsBool(downscale)) {
+        component->downscale = cJSON_IsTrue(downscale);
+    }
+    return component;
+}
+
+static void image_component_release_images(ImageComponent* component) {
+    backend_image_release(component->next);
+    backend_image_release(component->image);
+    component->next = NULL;
+    component->image = NULL;
+    component->image_path[0] = '\0';
+}
+
+// 缩小解码按 64 逻辑像素分档，拖拽缩放时不会每帧重新解码
+static int image_component_bucket(int size) {
+    return size > 0 ? ((size + 63) / 64) * 64 : 0;
+}
+
+/* 按当前 source 与显示尺寸取共享纹理。路径变化立即换图（就绪前画占位）；
+   尺寸档位变化先取 next，旧图继续显示到 next 就绪。 */
+static void image_component_sync_image(ImageComponent* component, Layer* layer) {
+    char path[YUI_MAX_PATH];
+    int w = 0;
+    int h = 0;
+
+    if (render_image_path(layer, path, sizeof(path)) != 0) {
+        image_component_release_images(component);
+        return;
+    }
+    if (layer->texture) {
+        // source 从 data URI 改成了文件路径
+        backend_render_text_destroy(layer->texture);
+        layer->texture = NULL;
+    }
+    if (component->downscale) {
+        w = image_component_bucket(layer->rect.w);
+        h = image_component_bucket(layer->rect.h);
+        if (w == 0 || h == 0) {
+            return;  // 未布局，等有尺寸再解码
+        }
+    }
+
+    if (strcmp(path, component->image_path) != 0) {
+        image_component_release_images(component);
+        snprintf(component->image_path, sizeof(component->image_path), "%s", path);
+        component->image = backend_image_acquire(path, w, h);
+        component->image_w = w;
+        component->image_h = h;
+        return;
+    }
+
+    if (w != component->image_w || h != component->image_h) {
+        if (component->next && (w != component->next_w || h != component->next_h)) {
+            backend_image_release(component->next);
+            component->next = NULL;
+        }
+        if (!component->next) {
+            component->next = backend_image_acquire(path, w, h);
+            component->next_w = w;
+            component->next_h = h;
+        }
+    }
+    if (component->next) {
+        if (backend_image_texture(component->next)) {
+            backend_image_release(component->image);
+            component->image = component->next;
+        } else if (backend_image_failed(component->next)) {
+            // 新档位解码失败：保留旧图拉伸显示，不再重试
+            backend_image_release(component->next);
+        } else {
+            return;
+        }
+        component->next = NULL;
+        component->image_w = component->next_w;
+        component->image_h = component->next_h;
+    }
 }
 
 // 创建图片组件
@@ -47,6 +126,7 @@ ImageComponent* image_component_create(Layer* layer) {
 // 销毁图片组件
 void image_component_destroy(ImageComponent* component) {
     if (component) {
+        image_component_release_images(component);
         // 释放图片纹理
         if (component->layer && component->layer->texture) {
             backend_render_text_destroy(component->layer->texture);
@@ -72,6 +152,7 @@ void image_component_set_source(ImageComponent* component, const char* source) {
     component->layer->source = strdup(source);
     
     // 释放旧的纹理
+    image_component_release_images(component);
     if (component->layer->texture) {
         backend_render_text_destroy(component->layer->texture);
         component->layer->texture = NULL;
@@ -129,23 +210,30 @@ void image_component_render(Layer* layer) {
     }
     
     ImageComponent* component = (ImageComponent*)layer->component;
-    // 图片类型渲染：从文件路径加载并渲染图片（支持多种格式）
-    if (layer->source && strlen(layer->source) > 0 && !layer->texture) {
-        // 修改为使用image支持多种格式
-        load_textures(layer);
+    Texture* texture;
+
+    // 文件图片走共享纹理缓存（后台解码，失败不每帧重试）；data URI 仍由图层自己持有
+    if (layer->source && strncmp(layer->source, "data:", 5) == 0) {
+        image_component_release_images(component);
+        if (!layer->texture) {
+            load_textures(layer);
+        }
+        texture = layer->texture;
+    } else {
+        image_component_sync_image(component, layer);
+        texture = backend_image_texture(component->image);
     }
     
-    
     // 渲染图片纹理
-    if (layer->texture) {
+    if (texture) {
         // 根据图片模式进行不同的渲染
         if (layer->image_mode == IMAGE_MODE_STRETCH || !component->preserve_aspect) {
             // 拉伸模式：直接填充整个区域
-            backend_render_text_copy(layer->texture, NULL, &layer->rect);
+            backend_render_text_copy(texture, NULL, &layer->rect);
         } else {
             // 获取图片原始尺寸
             int img_width, img_height;
-            backend_query_texture(layer->texture, NULL, NULL, &img_width, &img_height);
+            backend_query_texture(texture, NULL, NULL, &img_width, &img_height);
             
             // 计算缩放比例
             float scale_x = (float)layer->rect.w / img_width;
@@ -173,7 +261,7 @@ void image_component_render(Layer* layer) {
                 render_rect.y = layer->rect.y + (layer->rect.h - render_rect.h) / 2;
             }
             
-            backend_render_text_copy(layer->texture, NULL, &render_rect);
+            backend_render_text_copy(texture, NULL, &render_rect);
         }
     } else {
         // 如果图片加载失败，绘制一个占位符
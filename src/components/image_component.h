@@ -9,6 +9,12 @@ typedef struct {
     char source[YUI_MAX_PATH]; // 图片源文件路径
     ImageMode image_mode;  // 图片显示模式
     int preserve_aspect;   // 是否保持宽高比
+    int downscale;         // 按显示尺寸缩小解码（"downscale": true）
+    struct BackendImage* image;  // 共享纹理缓存中的当前图片
+    struct BackendImage* next;   // 尺寸档位变化后待换上的图片，就绪前仍画 image
+    char image_path[YUI_MAX_PATH];  // image 对应的解析后路径
+    int image_w, image_h;  // image 的目标尺寸档位，0 为原图
+    int next_w, next_h;
 } ImageComponent;
 
 // 函数声明
@@ -3,6 +3,7 @@
 #include "../backend.h"
 #include "../popup_manager.h"
 #include "../util.h"
+#include "../damage.h"
 #include "cJSON.h"
 #include <stdlib.h>
 #include <string.h>
@@ -20,19 +21,15 @@ static void tooltip_layer_render(Layer* layer) {
         backend_render_fill_rect(&layer->rect, bg);
     }
 
-    Texture* tex = render_text(layer, layer->text, text_color);
-    if (!tex) return;
-
     int tw, th;
-    backend_query_texture(tex, NULL, NULL, &tw, &th);
+    if (render_text_size(layer, layer->text, &tw, &th) != 0) return;
     Rect text_rect = {
         .x = layer->rect.x + 6,
         .y = layer->rect.y + 4,
-        .w = tw / yui_density,
-        .h = th / yui_density
+        .w = tw,
+        .h = th
     };
-    backend_render_text_copy(tex, NULL, &text_rect);
-    backend_render_text_destroy(tex);
+    render_text_at(layer, layer->text, text_color, &text_rect);
 }
 
 static void show_tooltip(LabelComponent* comp, int mouse_x, int mouse_y) {
@@ -46,14 +43,11 @@ static void show_tooltip(LabelComponent* comp, int mouse_x, int mouse_y) {
     if (full_text[0] == '\0') return;
 
     // 测量文本宽度
-    Texture* tex = backend_render_texture(layer->font->default_font, full_text, (Color){255,255,255,255});
-    if (!tex) return;
     int tw, th;
-    backend_query_texture(tex, NULL, NULL, &tw, &th);
-    backend_render_text_destroy(tex);
+    if (backend_text_size(layer->font->default_font, full_text, &tw, &th) != 0) return;
 
     int tooltip_avail_w = layer->rect.w - (layer->rect.w > 10 ? 10 : 0);
-    if (tw / yui_density <= tooltip_avail_w) return;
+    if (tw <= tooltip_avail_w) return;
 
     // 创建 tooltip layer
     Layer* tl = malloc(sizeof(Layer));
@@ -68,8 +62,8 @@ static void show_tooltip(LabelComponent* comp, int mouse_x, int mouse_y) {
 
     tl->rect.x = mouse_x + 12;
     tl->rect.y = mouse_y + 12;
-    tl->rect.w = tw / yui_density + pad * 2;
-    tl->rect.h = th / yui_density + pad * 2;
+    tl->rect.w = tw + pad * 2;
+    tl->rect.h = th + pad * 2;
 
     if (tl->rect.x + tl->rect.w > sw)
         tl->rect.x = mouse_x - tl->rect.w - 4;
@@ -188,12 +182,9 @@ void label_component_set_text(LabelComponent* component, const char* text) {
 
     if (component->auto_size && component->layer->font && component->layer->font->default_font) {
         int text_width, text_height;
-        Texture* text_texture = backend_render_texture(component->layer->font->default_font, text, (Color){0, 0, 0, 255});
-        if (text_texture) {
-            backend_query_texture(text_texture, NULL, NULL, &text_width, &text_height);
-            backend_render_text_destroy(text_texture);
-            component->layer->rect.w = text_width / yui_density + 10;
-            component->layer->rect.h = text_height / yui_density + 10;
+        if (backend_text_size(component->layer->font->default_font, text, &text_width, &text_height) == 0) {
+            component->layer->rect.w = text_width + 10;
+            component->layer->rect.h = text_height + 10;
         }
     }
 }
@@ -286,92 +277,54 @@ void label_component_render(Layer* layer) {
         return;
     }
 
-    // --- 仅有文本（原逻辑不变） ---
+    // --- 仅有文本 ---
     if (!has_icon) {
         component->has_overflow = 0;
         const char* display_text = original_text;
-
-        if (layer->font && layer->font->default_font) {
-            Texture* tex = backend_render_texture(layer->font->default_font, original_text, (Color){0,0,0,255});
-            if (tex) {
-                int tw;
-                backend_query_texture(tex, NULL, NULL, &tw, NULL);
-                backend_render_text_destroy(tex);
-
-                int avail_w = layer->rect.w - (layer->rect.w > 10 ? 10 : 0);
-                if (tw / density > avail_w) {
-                    component->has_overflow = 1;
-                    int byte_len = (int)strlen(original_text);
-                    char* truncated = malloc((size_t)byte_len + 4);
-                    while (byte_len > 0) {
-                        int safe_len = utf8_safe_prefix_bytes(original_text, byte_len);
-                        if (safe_len <= 0) break;
-                        memcpy(truncated, original_text, (size_t)safe_len);
-                        truncated[safe_len] = '\0';
-                        strcat(truncated, "...");
-                        Texture* short_tex = backend_render_texture(layer->font->default_font, truncated, (Color){0,0,0,255});
-                        if (short_tex) {
-                            int stw;
-                            backend_query_texture(short_tex, NULL, NULL, &stw, NULL);
-                            backend_render_text_destroy(short_tex);
-                            if (stw / density <= avail_w) break;
-                        }
-                        byte_len = utf8_prev_prefix_bytes(original_text, safe_len);
-                    }
-                    if (byte_len > 0) {
-                        Texture* final_tex = render_text(layer, truncated, text_color);
-                        if (final_tex) {
-                            int ftw, fth;
-                            backend_query_texture(final_tex, NULL, NULL, &ftw, &fth);
-                            Rect text_rect;
-                            text_rect.h = fth / density;
-                            text_rect.w = ftw / density;
-                            text_rect.y = layer->rect.y + (layer->rect.h - text_rect.h) / 2;
-                            switch (component->text_alignment) {
-                                case LAYOUT_LEFT:
-                                case LAYOUT_ALIGN_LEFT:
-                                    text_rect.x = layer->rect.x + 5; break;
-                                case LAYOUT_RIGHT:
-                                case LAYOUT_ALIGN_RIGHT:
-                                    text_rect.x = layer->rect.x + layer->rect.w - text_rect.w - 5; break;
-                                default:
-                                    text_rect.x = layer->rect.x + (layer->rect.w - text_rect.w) / 2; break;
-                            }
-                            if (text_rect.x < layer->rect.x) text_rect.x = layer->rect.x;
-                            if (text_rect.y < layer->rect.y) text_rect.y = layer->rect.y;
-                            backend_render_text_copy(final_tex, NULL, &text_rect);
-                            backend_render_text_destroy(final_tex);
-                        }
-                        display_text = NULL;
-                    }
-                    free(truncated);
+        char* truncated = NULL;
+        int tw = 0, th = 0;
+
+        if (render_text_size(layer, original_text, &tw, &th) == 0) {
+            int avail_w = layer->rect.w - (layer->rect.w > 10 ? 10 : 0);
+            if (tw > avail_w) {
+                component->has_overflow = 1;
+                int byte_len = (int)strlen(original_text);
+                truncated = malloc((size_t)byte_len + 4);
+                while (byte_len > 0) {
+                    int safe_len = utf8_safe_prefix_bytes(original_text, byte_len);
+                    if (safe_len <= 0) break;
+                    memcpy(truncated, original_text, (size_t)safe_len);
+                    truncated[safe_len] = '\0';
+                    strcat(truncated, "...");
+                    int stw = 0;
+                    if (render_text_size(layer, truncated, &stw, NULL) == 0 && stw <= avail_w) break;
+                    byte_len = utf8_prev_prefix_bytes(original_text, safe_len);
+                }
+                if (byte_len > 0) {
+                    display_text = truncated;
                 }
             }
         }
 
-        if (display_text) {
-            Texture* text_texture = render_text(layer, display_text, text_color);
-            if (text_texture) {
-                int text_width, text_height;
-                backend_query_texture(text_texture, NULL, NULL, &text_width, &text_height);
-                Rect text_rect;
-                int nat_w = text_width / density;
-                int nat_h = text_height / density;
-                text_rect.w = nat_w;
-                text_rect.h = nat_h;
-                text_rect.y = layer->rect.y + (layer->rect.h - text_rect.h) / 2;
-                switch (component->text_alignment) {
-                    case LAYOUT_LEFT:
-                    case LAYOUT_ALIGN_LEFT:
-                        text_rect.x = layer->rect.x + 5; break;
-                    case LAYOUT_RIGHT:
-                    case LAYOUT_ALIGN_RIGHT:
-                        text_rect.x = layer->rect.x + layer->rect.w - text_rect.w - 5; break;
-                    default:
-                        text_rect.x = layer->rect.x + (layer->rect.w - text_rect.w) / 2; break;
-                }
-                if (text_rect.x < layer->rect.x) text_rect.x = layer->rect.x;
-                if (text_rect.y < layer->rect.y) text_rect.y = layer->rect.y;
+        if (display_text && render_text_size(layer, display_text, &tw, &th) == 0) {
+            Rect text_rect;
+            text_rect.w = tw;
+            text_rect.h = th;
+            text_rect.y = layer->rect.y + (layer->rect.h - text_rect.h) / 2;
+            switch (component->text_alignment) {
+                case LAYOUT_LEFT:
+                case LAYOUT_ALIGN_LEFT:
+                    text_rect.x = layer->rect.x + 5; break;
+                case LAYOUT_RIGHT:
+                case LAYOUT_ALIGN_RIGHT:
+                    text_rect.x = layer->rect.x + layer->rect.w - text_rect.w - 5; break;
+                default:
+                    text_rect.x = layer->rect.x + (layer->rect.w - text_rect.w) / 2; break;
+            }
+            if (text_rect.x < layer->rect.x) text_rect.x = layer->rect.x;
+            if (text_rect.y < layer->rect.y) text_rect.y = layer->rect.y;
+            // 截断失败时整体缩放进图层
+            if (display_text == original_text) {
                 if (layer->rect.w > 0 && text_rect.w > layer->rect.w) {
                     float s = (float)layer->rect.w / (float)text_rect.w;
                     text_rect.w = layer->rect.w;
@@ -385,10 +338,10 @@ void label_component_render(Layer* layer) {
                     if (text_rect.w < 1) text_rect.w = 1;
                     text_rect.y = layer->rect.y;
                 }
-                backend_render_text_copy(text_texture, NULL, &text_rect);
-                backend_render_text_destroy(text_texture);
             }
+            render_text_at(layer, display_text, text_color, &text_rect);
         }
+        free(truncated);
 
         if (component->hovering && component->has_overflow) {
             Uint32 now = backend_get_ticks();
@@ -396,6 +349,9 @@ void label_component_render(Layer* layer) {
                 int mx, my;
                 backend_get_pointer_state(&mx, &my);
                 show_tooltip(component, mx, my);
+            } else {
+                // 延时到期时重绘以弹出提示
+                damage_add_layer_at(layer, component->hover_start + TOOLTIP_DELAY_MS);
             }
         }
         return;
@@ -412,7 +368,8 @@ void label_component_render(Layer* layer) {
     int avail_text_w = 0;
 
     // 准备渲染文本（可能带 "..." 截断）
-    Texture* text_tex = NULL;
+    const char* text_draw = NULL;
+    char* truncated = NULL;
     int draw_w = 0, draw_h = 0;
 
     // 先测量原始文本，确定是否需要截断（水平模式）
@@ -426,59 +383,28 @@ void label_component_render(Layer* layer) {
     if (avail_text_w < 8) avail_text_w = 8;
 
     {
-        int need_trunc = 0;
-        if (layer->font && layer->font->default_font) {
-            Texture* mt = backend_render_texture(layer->font->default_font, original_text, (Color){0,0,0,255});
-            if (mt) {
-                int mw;
-                backend_query_texture(mt, NULL, NULL, &mw, NULL);
-                backend_render_text_destroy(mt);
-                if (mw / density > avail_text_w) {
-                    need_trunc = 1;
-                }
-            }
-        }
-
-        if (need_trunc) {
+        int mw = 0;
+        text_draw = original_text;
+        if (render_text_size(layer, original_text, &mw, NULL) == 0 && mw > avail_text_w) {
             int byte_len = (int)strlen(original_text);
-            char* truncated = malloc((size_t)byte_len + 4);
+            truncated = malloc((size_t)byte_len + 4);
             while (byte_len > 0) {
                 int safe_len = utf8_safe_prefix_bytes(original_text, byte_len);
                 if (safe_len <= 0) break;
                 memcpy(truncated, original_text, (size_t)safe_len);
                 truncated[safe_len] = '\0';
                 strcat(truncated, "...");
-                Texture* st = backend_render_texture(layer->font->default_font, truncated, (Color){0,0,0,255});
-                if (st) {
-                    int sw;
-                    backend_query_texture(st, NULL, NULL, &sw, NULL);
-                    backend_render_text_destroy(st);
-                    if (sw / density <= avail_text_w) break;
-                }
+                int sw = 0;
+                if (render_text_size(layer, truncated, &sw, NULL) == 0 && sw <= avail_text_w) break;
                 byte_len = utf8_prev_prefix_bytes(original_text, safe_len);
             }
-            if (byte_len > 0) {
-                text_tex = render_text(layer, truncated, text_color);
-                if (text_tex) {
-                    int tw, th;
-                    backend_query_texture(text_tex, NULL, NULL, &tw, &th);
-                    draw_w = tw / density;
-                    draw_h = th / density;
-                    if (draw_w < 1) draw_w = 1;
-                    if (draw_h < 1) draw_h = 1;
-                }
-            }
-            free(truncated);
+            text_draw = byte_len > 0 ? truncated : NULL;
+        }
+        if (text_draw && render_text_size(layer, text_draw, &draw_w, &draw_h) == 0) {
+            if (draw_w < 1) draw_w = 1;
+            if (draw_h < 1) draw_h = 1;
         } else {
-            text_tex = render_text(layer, original_text, text_color);
-            if (text_tex) {
-                int tw, th;
-                backend_query_texture(text_tex, NULL, NULL, &tw, &th);
-                draw_w = tw / density;
-                draw_h = th / density;
-                if (draw_w < 1) draw_w = 1;
-                if (draw_h < 1) draw_h = 1;
-            }
+            text_draw = NULL;
         }
     }
 
@@ -490,9 +416,9 @@ void label_component_render(Layer* layer) {
             int start_y = layer->rect.y + pad_top + (content_h - block_h) / 2;
             Rect ir = {start_x, start_y + (block_h - icon_h) / 2, icon_w, icon_h};
             backend_render_text_copy(icon_tex, NULL, &ir);
-            if (text_tex) {
+            if (text_draw) {
                 Rect tr = {start_x + icon_w + gap, start_y + (block_h - draw_h) / 2, draw_w, draw_h};
-                backend_render_text_copy(text_tex, NULL, &tr);
+                render_text_at(layer, text_draw, text_color, &tr);
             }
             break;
         }
@@ -501,9 +427,9 @@ void label_component_render(Layer* layer) {
             int block_h = label_max_int(icon_h, draw_h);
             int start_x = layer->rect.x + pad_left + (content_w - block_w) / 2;
             int start_y = layer->rect.y + pad_top + (content_h - block_h) / 2;
-            if (text_tex) {
+            if (text_draw) {
                 Rect tr = {start_x, start_y + (block_h - draw_h) / 2, draw_w, draw_h};
-                backend_render_text_copy(text_tex, NULL, &tr);
+                render_text_at(layer, text_draw, text_color, &tr);
             }
             Rect ir = {start_x + draw_w + gap, start_y + (block_h - icon_h) / 2, icon_w, icon_h};
             backend_render_text_copy(icon_tex, NULL, &ir);
@@ -532,9 +458,9 @@ void label_component_render(Layer* layer) {
             int start_y = layer->rect.y + pad_top + (content_h - total_h) / 2;
             Rect ir = {layer->rect.x + (layer->rect.w - use_icon_w) / 2, start_y, use_icon_w, use_icon_h};
             backend_render_text_copy(icon_tex, NULL, &ir);
-            if (text_tex) {
+            if (text_draw) {
                 Rect tr = {layer->rect.x + (layer->rect.w - draw_w) / 2, start_y + use_icon_h + gap, draw_w, draw_h};
-                backend_render_text_copy(text_tex, NULL, &tr);
+                render_text_at(layer, text_draw, text_color, &tr);
             }
             break;
         }
@@ -550,9 +476,9 @@ void label_component_render(Layer* layer) {
             }
             total_h = draw_h + gap + icon_h;
             int start_y = layer->rect.y + pad_top + (content_h - total_h) / 2;
-            if (text_tex) {
+            if (text_draw) {
                 Rect tr = {layer->rect.x + (layer->rect.w - draw_w) / 2, start_y, draw_w, draw_h};
-                backend_render_text_copy(text_tex, NULL, &tr);
+                render_text_at(layer, text_draw, text_color, &tr);
             }
             Rect ir = {layer->rect.x + (layer->rect.w - icon_w) / 2, start_y + draw_h + gap, icon_w, icon_h};
             backend_render_text_copy(icon_tex, NULL, &ir);
@@ -560,7 +486,7 @@ void label_component_render(Layer* layer) {
         }
     }
 
-    if (text_tex) backend_render_text_destroy(text_tex);
+    free(truncated);
     backend_render_text_destroy(icon_tex);
 }
 
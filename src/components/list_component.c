@@ -57,6 +57,51 @@ static char* list_json_value_to_string(cJSON* item) {
     return printed ? printed : strdup("");
 }
 
+static void list_store_free(ListComponent* component) {
+    free(component->rows);
+    component->rows = NULL;
+    component->rows_count = 0;
+    component->rows_capacity = 0;
+    component->rows_source = NULL;
+}
+
+// 一次遍历 data 数组建立行指针表；已与 data 一致时直接返回
+static int list_store_sync(ListComponent* component) {
+    Layer* layer = component->layer;
+    cJSON* data = (layer && layer->data) ? layer->data->json : NULL;
+    if (!data || !cJSON_IsArray(data)) {
+        list_store_free(component);
+        return 0;
+    }
+    if (component->rows_source == data && component->rows_count == layer->data->size) {
+        return 1;
+    }
+
+    list_store_free(component);
+    int count = 0;
+    for (cJSON* row = data->child; row; row = row->next) count++;
+    if (count > 0) {
+        component->rows = (cJSON**)malloc((size_t)count * sizeof(cJSON*));
+        if (!component->rows) return 0;
+        count = 0;
+        for (cJSON* row = data->child; row; row = row->next) {
+            component->rows[count++] = row;
+        }
+    }
+    component->rows_count = count;
+    component->rows_capacity = count;
+    component->rows_source = data;
+    layer->data->size = count;
+    return 1;
+}
+
+static cJSON* list_store_row(ListComponent* component, int index) {
+    if (index < 0 || !list_store_sync(component) || index >= component->rows_count) {
+        return NULL;
+    }
+    return component->rows[index];
+}
+
 static char* list_resolve_template(ListComponent* component, int index, const char* template_text) {
     Layer* layer = component->layer;
     if (!template_text || !template_text[0]) return strdup("");
@@ -65,7 +110,7 @@ static char* list_resolve_template(ListComponent* component, int index, const ch
         return strdup(template_text);
     }
 
-    cJSON* item = cJSON_GetArrayItem(layer->data->json, index);
+    cJSON* item = list_store_row(component, index);
     if (!item) return strdup(template_text);
 
     char* result = strdup(template_text);
@@ -91,6 +136,44 @@ static char* list_resolve_template(ListComponent* component, int index, const ch
     return result;
 }
 
+static void list_recycle_clear_slot(ListItemCache* slot) {
+    free(slot->text_tpl);
+    free(slot->text);
+    free(slot->icon_tpl);
+    free(slot->icon);
+    memset(slot, 0, sizeof(*slot));
+    slot->index = -1;
+}
+
+static void list_recycle_clear(ListComponent* component) {
+    for (int i = 0; i < LIST_RECYCLE_SLOTS; i++) {
+        list_recycle_clear_slot(&component->recycle[i]);
+    }
+}
+
+/* 取第 index 行模板解析后的文本：命中回收池直接返回，否则解析并放入（直接映射，冲突时替换） */
+static const char* list_recycle_resolve(ListComponent* component, int index,
+                                        const char* template_text, int is_icon) {
+    ListItemCache* slot = &component->recycle[index % LIST_RECYCLE_SLOTS];
+    if (slot->index != index) {
+        list_recycle_clear_slot(slot);
+        slot->index = index;
+    }
+
+    char** tpl = is_icon ? &slot->icon_tpl : &slot->text_tpl;
+    char** value = is_icon ? &slot->icon : &slot->text;
+    const char* src = template_text ? template_text : "";
+    if (*value && *tpl && strcmp(*tpl, src) == 0) {
+        return *value;
+    }
+
+    free(*tpl);
+    free(*value);
+    *tpl = strdup(src);
+    *value = list_resolve_template(component, index, template_text);
+    return *value;
+}
+
 static Layer* list_resolve_font_layer(Layer* list_layer, Layer* template_layer) {
     if (template_layer && template_layer->font && template_layer->font->default_font) {
         return template_layer;
@@ -160,6 +243,26 @@ static void list_get_item_rect(ListComponent* component, int index, Rect* out) {
     out->h = component->item_height;
 }
 
+/* 行高固定，由 scroll_offset 直接算出可见行区间 [first, last]，没有可见行返回 0 */
+static int list_get_visible_range(ListComponent* component, int* first, int* last) {
+    Layer* layer = component->layer;
+    int count = list_component_get_item_count(component);
+    int step = component->item_height + list_get_spacing(component);
+    if (count <= 0 || component->item_height <= 0 || step <= 0) return 0;
+
+    int top = layer->scroll_offset - list_get_padding(layer, 0);
+    int bottom = top + layer->rect.h;
+    if (bottom < 0) return 0;
+
+    int lo = top > 0 ? top / step : 0;
+    int hi = bottom / step;
+    if (lo >= count) return 0;
+    if (hi >= count) hi = count - 1;
+    *first = lo;
+    *last = hi;
+    return 1;
+}
+
 static int list_point_in_item(ListComponent* component, int x, int y, int* out_index) {
     if (!component || !component->layer) return 0;
 
@@ -170,16 +273,21 @@ static int list_point_in_item(ListComponent* component, int x, int y, int* out_i
     }
 
     int count = list_component_get_item_count(component);
-    for (int i = 0; i < count; i++) {
-        Rect item_rect;
-        list_get_item_rect(component, i, &item_rect);
-        if (x >= item_rect.x && x < item_rect.x + item_rect.w &&
-            y >= item_rect.y && y < item_rect.y + item_rect.h) {
-            if (out_index) *out_index = i;
-            return 1;
-        }
-    }
-    return 0;
+    int step = component->item_height + list_get_spacing(component);
+    if (count <= 0 || component->item_height <= 0 || step <= 0) return 0;
+
+    int rel = y - layer->rect.y - list_get_padding(layer, 0) + layer->scroll_offset;
+    if (rel < 0) return 0;
+    int index = rel / step;
+    // 落在行间距里不算命中
+    if (index >= count || rel - index * step >= component->item_height) return 0;
+
+    Rect item_rect;
+    list_get_item_rect(component, index, &item_rect);
+    if (x < item_rect.x || x >= item_rect.x + item_rect.w) return 0;
+
+    if (out_index) *out_index = index;
+    return 1;
 }
 
 static void list_dispatch_select(ListComponent* component, int index) {
@@ -190,7 +298,7 @@ static void list_dispatch_select(ListComponent* component, int index) {
     EventHandler handler = find_event_by_name(component->on_select_name);
     if (!handler) return;
 
-    cJSON* item = cJSON_GetArrayItem(layer->data->json, index);
+    cJSON* item = list_store_row(component, index);
     if (!item) return;
 
     char* item_json = cJSON_PrintUnformatted(item);
@@ -230,6 +338,10 @@ static int list_data_update(Layer* layer, cJSON* data) {
     }
 
     layer->data->size = cJSON_GetArraySize(data);
+    // 旧数组可能已释放且地址被复用，先清空再重建
+    list_store_free(component);
+    list_store_sync(component);
+    list_recycle_clear(component);
     component->hovered_index = -1;
     component->pressed_index = -1;
 
@@ -238,6 +350,63 @@ static int list_data_update(Layer* layer, cJSON* data) {
     return already_owned ? 0 : 1;
 }
 
+// 追加行：已解析的可见行不受影响，只更新条数与内容尺寸
+static int list_rows_append(Layer* layer, cJSON* rows) {
+    if (!layer || !layer->component || !rows || !cJSON_IsArray(rows)) return 0;
+
+    ListComponent* component = (ListComponent*)layer->component;
+    if (!layer->data || !layer->data->json || !cJSON_IsArray(layer->data->json)) {
+        cJSON* data = cJSON_CreateArray();
+        if (!data) return 0;
+        if (list_data_update(layer, data) == 0) {
+            cJSON_Delete(data);
+            return 0;
+        }
+    }
+
+    cJSON* data = layer->data->json;
+    int add = cJSON_GetArraySize(rows);
+    if (add <= 0) return 1;
+    if (!list_store_sync(component)) return 0;
+
+    if (component->rows_count + add > component->rows_capacity) {
+        int capacity = component->rows_capacity > 0 ? component->rows_capacity : 16;
+        while (capacity < component->rows_count + add) capacity *= 2;
+        cJSON** grown = (cJSON**)realloc(component->rows, (size_t)capacity * sizeof(cJSON*));
+        if (!grown) return 0;
+        component->rows = grown;
+        component->rows_capacity = capacity;
+    }
+
+    while (rows->child) {
+        cJSON* row = cJSON_DetachItemViaPointer(rows, rows->child);
+        cJSON_AddItemToArray(data, row);
+        component->rows[component->rows_count++] = row;
+    }
+    layer->data->size = component->rows_count;
+    list_component_update_content_size(component);
+    mark_layer_dirty(layer, DIRTY_LAYOUT | DIRTY_TEXT);
+    return 1;
+}
+
+// 替换一行：只清掉该行的回收池条目
+static int list_row_update(Layer* layer, int index, cJSON* row) {
+    if (!layer || !layer->component || !row) return 0;
+    if (!layer->data || !layer->data->json || index < 0 || index >= layer->data->size) return 0;
+
+    ListComponent* component = (ListComponent*)layer->component;
+    cJSON* old = list_store_row(component, index);
+    if (!old || !cJSON_ReplaceItemViaPointer(layer->data->json, old, row)) return 0;
+    component->rows[index] = row;
+
+    ListItemCache* slot = &component->recycle[index % LIST_RECYCLE_SLOTS];
+    if (slot->index == index) {
+        list_recycle_clear_slot(slot);
+    }
+    mark_layer_dirty(layer, DIRTY_TEXT);
+    return 1;
+}
+
 static void list_layer_destroy(Layer* layer) {
     if (!layer || !layer->component) return;
     list_component_destroy((ListComponent*)layer->component);
@@ -253,6 +422,9 @@ ListComponent* list_component_create(Layer* layer) {
     component->spacing = 4;
     component->hovered_index = -1;
     component->pressed_index = -1;
+    for (int i = 0; i < LIST_RECYCLE_SLOTS; i++) {
+        component->recycle[i].index = -1;
+    }
 
     layer->component = component;
     layer->render = list_component_render;
@@ -261,6 +433,8 @@ ListComponent* list_component_create(Layer* layer) {
     layer->handle_key_event = list_component_handle_key_event;
     layer->focusable = 1;
     layer->on_data_update = list_data_update;
+    layer->on_rows_append = list_rows_append;
+    layer->on_row_update = list_row_update;
     layer->on_destroy = list_layer_destroy;
 
     return component;
@@ -268,6 +442,8 @@ ListComponent* list_component_create(Layer* layer) {
 
 void list_component_destroy(ListComponent* component) {
     if (!component) return;
+    list_recycle_clear(component);
+    list_store_free(component);
     free(component);
 }
 
@@ -390,7 +566,7 @@ static void list_render_item(ListComponent* component, int index, int is_hovered
     int text_x_offset = 0;
 
     if (btn_template && btn_template->icon_text && btn_template->icon_text[0]) {
-        char* icon_text = list_resolve_template(component, index, btn_template->icon_text);
+        const char* icon_text = list_recycle_resolve(component, index, btn_template->icon_text, 1);
         if (icon_text && icon_text[0]) {
             Texture* icon_tex = render_text(font_layer, icon_text, text_color);
             if (icon_tex) {
@@ -407,11 +583,10 @@ static void list_render_item(ListComponent* component, int index, int is_hovered
                 text_x_offset = icon_w + 8;
             }
         }
-        if (icon_text) free(icon_text);
     }
 
     const char* text_template = layer_get_text(template_layer);
-    char* item_text = list_resolve_template(component, index, text_template);
+    const char* item_text = list_recycle_resolve(component, index, text_template, 0);
     if (item_text && item_text[0]) {
         Texture* text_tex = render_text(font_layer, item_text, text_color);
         if (text_tex) {
@@ -432,7 +607,6 @@ static void list_render_item(ListComponent* component, int index, int is_hovered
             backend_render_text_destroy(text_tex);
         }
     }
-    if (item_text) free(item_text);
 }
 
 void list_component_render(Layer* layer) {
@@ -455,11 +629,13 @@ void list_component_render(Layer* layer) {
         }
     }
 
-    int count = list_component_get_item_count(component);
-    for (int i = 0; i < count; i++) {
-        list_render_item(component, i,
-                         component->hovered_index == i,
-                         component->pressed_index == i);
+    int first, last;
+    if (list_get_visible_range(component, &first, &last)) {
+        for (int i = first; i <= last; i++) {
+            list_render_item(component, i,
+                             component->hovered_index == i,
+                             component->pressed_index == i);
+        }
     }
 
     render_clip_pop(&prev_clip);
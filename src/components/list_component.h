@@ -8,6 +8,17 @@
 extern "C" {
 #endif
 
+#define LIST_RECYCLE_SLOTS 64  // 按 index 直接映射，覆盖常见可见行数
+
+// 可见行模板解析结果的回收池条目，data 更新时整体清空
+typedef struct ListItemCache {
+    int index;          // -1 表示空
+    char* text_tpl;     // 解析时使用的模板，模板变化则重新解析
+    char* text;
+    char* icon_tpl;
+    char* icon;
+} ListItemCache;
+
 typedef struct ListComponent {
     Layer* layer;
     int item_height;
@@ -16,6 +27,12 @@ typedef struct ListComponent {
     int pressed_index;
     int touch_scrolled;
     char on_select_name[128];
+    ListItemCache recycle[LIST_RECYCLE_SLOTS];
+    /* 行指针表：按下标取行为 O(1)；data 数组被替换或条数对不上时重建 */
+    cJSON** rows;
+    int rows_count;
+    int rows_capacity;      // rows 已分配的槽数（appendRows 按倍数扩容）
+    cJSON* rows_source;     // rows 对应的 data 数组
 } ListComponent;
 
 ListComponent* list_component_create(Layer* layer);
@@ -3,6 +3,7 @@
 #include "../backend.h"
 #include "../util.h"
 #include "../layer_update.h"
+#include "../damage.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -275,4 +276,7 @@ void loading_component_render(Layer* layer)
     }
 
     loading_render_text(component, layer);
+
+    // 持续动画：请求下一帧重绘自身区域
+    damage_add_layer(layer, DIRTY_NONE);
 }
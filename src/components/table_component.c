@@ -18,7 +18,7 @@
 #define TABLE_TOOLTIP_DELAY_MS 400
 #define TABLE_TOOLTIP_ROW_NONE -2
 
-static void table_draw_cell_text(Layer* layer, const char* text, Color color,
+static void table_draw_cell_text(Layer* layer, const char* text, int text_w, int text_h, Color color,
                                 int x, int y, int w, int h, TableColumnAlign align);
 static void table_get_cell_rect(TableComponent* component, Layer* layer,
                                 int row, int col, Rect* out);
@@ -30,6 +30,10 @@ static int table_row_at_point(TableComponent* component, Layer* layer, int x, in
 static int table_point_in_header(TableComponent* component, Layer* layer, int x, int y);
 static int table_resize_column_at(TableComponent* component, Layer* layer, int x, int y);
 static char* table_json_value_to_string(cJSON* item);
+static cJSON* table_store_row(TableComponent* component, int row);
+static cJSON* table_store_value(TableComponent* component, cJSON* row_json, int col);
+static TableCellCache* table_store_cell(TableComponent* component, int row, int col);
+static int table_store_cell_size(TableComponent* component, Layer* layer, TableCellCache* cell);
 static void table_tooltip_schedule_show(TableComponent* component, Layer* layer);
 static int table_measure_text_width(Layer* layer, const char* text);
 
@@ -178,21 +182,16 @@ static void table_tooltip_reset(TableComponent* component) {
 }
 
 static int table_measure_text_width(Layer* layer, const char* text) {
+    int tw = 0;
     if (!layer || !text || !text[0] || !layer->font || !layer->font->default_font) return 0;
-
-    Texture* tex = backend_render_texture(layer->font->default_font, text, (Color){255, 255, 255, 255});
-    if (!tex) return 0;
-
-    int tw = 0, th = 0;
-    backend_query_texture(tex, NULL, NULL, &tw, &th);
-    backend_render_text_destroy(tex);
-    return tw / yui_density;
+    if (render_text_size(layer, text, &tw, NULL) != 0) return 0;
+    return tw;
 }
 
-static int table_text_overflows(Layer* layer, const char* text, int cell_w) {
+static int table_text_overflows(int text_w, int cell_w) {
     int avail = cell_w - TABLE_CELL_PAD_X * 2;
     if (avail < 1) avail = 1;
-    return table_measure_text_width(layer, text) > avail;
+    return text_w > avail;
 }
 
 static int table_column_index_at_x(TableComponent* component, Layer* layer, int x) {
@@ -217,35 +216,19 @@ static int table_column_index_at_x(TableComponent* component, Layer* layer, int
     return -1;
 }
 
-static char* table_get_body_cell_text(TableComponent* component, int row, int col) {
-    if (!component || !component->layer || row < 0 || col < 0 || col >= component->column_count) {
-        return NULL;
-    }
-
-    Layer* layer = component->layer;
-    if (!layer->data || !layer->data->json || !cJSON_IsArray(layer->data->json)) {
-        return NULL;
-    }
-
-    cJSON* row_json = cJSON_GetArrayItem(layer->data->json, row);
-    if (!row_json) return NULL;
-
-    cJSON* value = cJSON_GetObjectItem(row_json, component->columns[col].key);
-    return table_json_value_to_string(value);
+// 返回行缓存中的字符串，下一次取单元格前有效
+static const char* table_get_body_cell_text(TableComponent* component, int row, int col) {
+    TableCellCache* cell = table_store_cell(component, row, col);
+    return cell ? cell->text : NULL;
 }
 
-static const char* table_get_tooltip_text(TableComponent* component, int row, int col,
-                                          char** owned_text) {
+static const char* table_get_tooltip_text(TableComponent* component, int row, int col) {
     if (!component || col < 0 || col >= component->column_count) return NULL;
-    if (owned_text) *owned_text = NULL;
 
     if (row < 0) {
         return component->columns[col].title;
     }
-
-    char* text = table_get_body_cell_text(component, row, col);
-    if (owned_text) *owned_text = text;
-    return text;
+    return table_get_body_cell_text(component, row, col);
 }
 
 static void table_show_tooltip(TableComponent* component, Layer* layer,
@@ -365,17 +348,20 @@ static void table_tooltip_update_hover(TableComponent* component, Layer* layer,
         return;
     }
 
-    char* owned_text = NULL;
-    const char* text = table_get_tooltip_text(component, row, col, &owned_text);
+    const char* text = table_get_tooltip_text(component, row, col);
     if (!text || !text[0]) {
-        free(owned_text);
         table_tooltip_reset(component);
         return;
     }
 
-    int cell_w = component->columns[col].computed_width;
-    int overflows = table_text_overflows(layer, text, cell_w);
-    free(owned_text);
+    int text_w;
+    if (row < 0) {
+        text_w = table_measure_text_width(layer, text);
+    } else {
+        TableCellCache* cell = table_store_cell(component, row, col);
+        text_w = (cell && table_store_cell_size(component, layer, cell) == 0) ? cell->w : 0;
+    }
+    int overflows = table_text_overflows(text_w, component->columns[col].computed_width);
 
     if (!overflows) {
         table_tooltip_reset(component);
@@ -413,18 +399,15 @@ static void table_tooltip_try_show(TableComponent* component, Layer* layer) {
         return;
     }
 
-    char* owned_text = NULL;
     const char* text = table_get_tooltip_text(component, component->tooltip_row,
-                                              component->tooltip_col, &owned_text);
+                                              component->tooltip_col);
     if (!text || !text[0]) {
-        free(owned_text);
         return;
     }
 
     int mx = 0, my = 0;
     backend_get_pointer_state(&mx, &my);
     table_show_tooltip(component, layer, text, mx, my);
-    free(owned_text);
 }
 
 static int table_edit_has_selection(TableComponent* component) {
@@ -601,11 +584,169 @@ static int table_handle_edit_mouse(TableComponent* component, Layer* layer, Poin
 }
 
 static int table_row_count(TableComponent* component) {
-    if (!component || !component->layer || !component->layer->data || !component->layer->data->json) {
-        return 0;
+    return component ? component->rows_count : 0;
+}
+
+static void table_row_cache_free_slot(TableComponent* component, TableRowCache* slot) {
+    if (slot->cells) {
+        for (int c = 0; c < component->row_cache_cols; c++) {
+            free(slot->cells[c].text);
+        }
+        free(slot->cells);
+    }
+    slot->cells = NULL;
+    slot->row = -1;
+}
+
+static void table_row_cache_clear(TableComponent* component) {
+    for (int i = 0; i < TABLE_ROW_CACHE_SLOTS; i++) {
+        table_row_cache_free_slot(component, &component->row_cache[i]);
+    }
+    component->row_cache_cols = component->column_count;
+}
+
+// 单元格内容被修改后丢弃该行缓存
+static void table_row_cache_invalidate(TableComponent* component, int row) {
+    if (row < 0) return;
+    TableRowCache* slot = &component->row_cache[row % TABLE_ROW_CACHE_SLOTS];
+    if (slot->row == row) {
+        table_row_cache_free_slot(component, slot);
+    }
+}
+
+/* 每列 key 在首行中的位置；各行字段顺序一致时取值只需沿 child 走到该位置 */
+static void table_store_resolve_keys(TableComponent* component) {
+    free(component->column_key_pos);
+    component->column_key_pos = NULL;
+    table_row_cache_clear(component);
+
+    if (component->column_count <= 0) return;
+    component->column_key_pos = (int*)malloc((size_t)component->column_count * sizeof(int));
+    if (!component->column_key_pos) return;
+
+    cJSON* first = component->rows_count > 0 ? component->rows[0] : NULL;
+    for (int c = 0; c < component->column_count; c++) {
+        int pos = 0;
+        component->column_key_pos[c] = -1;
+        for (cJSON* field = first ? first->child : NULL; field; field = field->next, pos++) {
+            if (field->string && strcmp(field->string, component->columns[c].key) == 0) {
+                component->column_key_pos[c] = pos;
+                break;
+            }
+        }
+    }
+}
+
+static void table_store_free(TableComponent* component) {
+    table_row_cache_clear(component);
+    free(component->rows);
+    component->rows = NULL;
+    component->rows_count = 0;
+    component->rows_capacity = 0;
+    free(component->column_key_pos);
+    component->column_key_pos = NULL;
+}
+
+// 一次遍历 data 数组建立行指针表
+static void table_store_rebuild(TableComponent* component) {
+    Layer* layer = component->layer;
+    cJSON* data = (layer && layer->data) ? layer->data->json : NULL;
+
+    table_store_free(component);
+    if (!data || !cJSON_IsArray(data)) return;
+
+    int count = 0;
+    for (cJSON* row = data->child; row; row = row->next) count++;
+    if (count > 0) {
+        component->rows = (cJSON**)malloc((size_t)count * sizeof(cJSON*));
+        if (!component->rows) return;
+        count = 0;
+        for (cJSON* row = data->child; row; row = row->next) {
+            component->rows[count++] = row;
+        }
+    }
+    component->rows_count = count;
+    component->rows_capacity = count;
+    table_store_resolve_keys(component);
+}
+
+static cJSON* table_store_row(TableComponent* component, int row) {
+    if (!component || row < 0 || row >= component->rows_count) return NULL;
+    return component->rows[row];
+}
+
+static cJSON* table_store_value(TableComponent* component, cJSON* row_json, int col) {
+    if (!row_json || col < 0 || col >= component->column_count) return NULL;
+
+    const char* key = component->columns[col].key;
+    int pos = component->column_key_pos ? component->column_key_pos[col] : -1;
+    if (pos >= 0) {
+        cJSON* field = row_json->child;
+        for (int i = 0; field && i < pos; i++) field = field->next;
+        if (field && field->string && strcmp(field->string, key) == 0) {
+            return field;
+        }
     }
-    if (!cJSON_IsArray(component->layer->data->json)) return 0;
-    return cJSON_GetArraySize(component->layer->data->json);
+    return cJSON_GetObjectItem(row_json, key);
+}
+
+static TableCellCache* table_store_cell(TableComponent* component, int row, int col) {
+    if (!component || col < 0 || col >= component->column_count) return NULL;
+    cJSON* row_json = table_store_row(component, row);
+    if (!row_json) return NULL;
+
+    if (component->row_cache_cols != component->column_count) {
+        table_row_cache_clear(component);
+    }
+
+    TableRowCache* slot = &component->row_cache[row % TABLE_ROW_CACHE_SLOTS];
+    if (slot->row != row) {
+        table_row_cache_free_slot(component, slot);
+        slot->cells = (TableCellCache*)calloc((size_t)component->column_count, sizeof(TableCellCache));
+        if (!slot->cells) return NULL;
+        for (int c = 0; c < component->column_count; c++) {
+            slot->cells[c].w = -1;
+        }
+        slot->row = row;
+    }
+
+    TableCellCache* cell = &slot->cells[col];
+    if (!cell->text) {
+        cell->text = table_json_value_to_string(table_store_value(component, row_json, col));
+        cell->w = -1;
+    }
+    return cell->text ? cell : NULL;
+}
+
+// 测量并缓存单元格文本尺寸；字体变化时作废全部测量结果
+static int table_store_cell_size(TableComponent* component, Layer* layer, TableCellCache* cell) {
+    DFont* font = (layer && layer->font) ? layer->font->default_font : NULL;
+    if (!cell || !font) return -1;
+
+    if (component->row_cache_font != font) {
+        component->row_cache_font = font;
+        for (int i = 0; i < TABLE_ROW_CACHE_SLOTS; i++) {
+            TableRowCache* slot = &component->row_cache[i];
+            if (!slot->cells) continue;
+            for (int c = 0; c < component->row_cache_cols; c++) {
+                slot->cells[c].w = -1;
+            }
+        }
+    }
+
+    if (cell->w < 0) {
+        int tw = 0, th = 0;
+        if (!cell->text[0]) {
+            cell->w = 0;
+            cell->h = 0;
+        } else if (render_text_size(layer, cell->text, &tw, &th) == 0) {
+            cell->w = tw;
+            cell->h = th;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
 }
 
 static char* table_json_value_to_string(cJSON* item) {
@@ -688,6 +829,7 @@ static int table_parse_columns(TableComponent* component, cJSON* columns_json) {
     table_free_columns(component);
     component->columns = cols;
     component->column_count = count;
+    table_store_resolve_keys(component);
     return 1;
 }
 
@@ -718,6 +860,7 @@ static int table_build_auto_columns(TableComponent* component, cJSON* data) {
     table_free_columns(component);
     component->columns = cols;
     component->column_count = i;
+    table_store_resolve_keys(component);
     return 1;
 }
 
@@ -1140,7 +1283,7 @@ static int table_commit_edit(TableComponent* component) {
         return 0;
     }
 
-    cJSON* row = cJSON_GetArrayItem(layer->data->json, component->editing_row);
+    cJSON* row = table_store_row(component, component->editing_row);
     if (!row || component->editing_col >= component->column_count) {
         table_cancel_edit(component);
         return 0;
@@ -1148,6 +1291,7 @@ static int table_commit_edit(TableComponent* component) {
 
     TableColumn* col = &component->columns[component->editing_col];
     table_set_cell_json_value(row, col->key, component->edit_buffer, component->edit_orig_number);
+    table_row_cache_invalidate(component, component->editing_row);
 
     component->selected_row = component->editing_row;
     component->selected_col = component->editing_col;
@@ -1163,17 +1307,15 @@ static void table_begin_edit(TableComponent* component, int row, int col) {
     Layer* layer = component->layer;
     if (!layer || !layer->data || !layer->data->json) return;
 
-    cJSON* row_json = cJSON_GetArrayItem(layer->data->json, row);
+    cJSON* row_json = table_store_row(component, row);
     if (!row_json) return;
 
-    TableColumn* column = &component->columns[col];
-    cJSON* value = cJSON_GetObjectItem(row_json, column->key);
-    char* text = table_json_value_to_string(value);
+    cJSON* value = table_store_value(component, row_json, col);
+    const char* text = table_get_body_cell_text(component, row, col);
     if (!text) return;
 
     strncpy(component->edit_buffer, text, TABLE_EDIT_BUF_SIZE - 1);
     component->edit_buffer[TABLE_EDIT_BUF_SIZE - 1] = '\0';
-    free(text);
 
     component->editing_row = row;
     component->editing_col = col;
@@ -1223,14 +1365,10 @@ static void table_copy_cell(TableComponent* component) {
     Layer* layer = component->layer;
     if (!layer || !layer->data || !layer->data->json) return;
 
-    cJSON* row = cJSON_GetArrayItem(layer->data->json, component->selected_row);
-    if (!row || component->selected_col >= component->column_count) return;
-
-    char* text = table_json_value_to_string(
-        cJSON_GetObjectItem(row, component->columns[component->selected_col].key));
+    const char* text = table_get_body_cell_text(component, component->selected_row,
+                                                component->selected_col);
     if (text) {
         backend_set_clipboard_text(text);
-        free(text);
     }
 }
 
@@ -1240,20 +1378,16 @@ static void table_copy_row(TableComponent* component) {
     Layer* layer = component->layer;
     if (!layer || !layer->data || !layer->data->json || component->column_count <= 0) return;
 
-    cJSON* row = cJSON_GetArrayItem(layer->data->json, component->selected_row);
-    if (!row) return;
+    if (!table_store_row(component, component->selected_row)) return;
 
     char* buf = (char*)malloc((size_t)component->column_count * 256);
     if (!buf) return;
     buf[0] = '\0';
 
     for (int c = 0; c < component->column_count; c++) {
-        char* text = table_json_value_to_string(
-            cJSON_GetObjectItem(row, component->columns[c].key));
-        if (!text) text = strdup("");
+        const char* text = table_get_body_cell_text(component, component->selected_row, c);
         if (c > 0) strcat(buf, "\t");
-        strncat(buf, text, 255);
-        free(text);
+        strncat(buf, text ? text : "", 255);
     }
     backend_set_clipboard_text(buf);
     free(buf);
@@ -1476,7 +1610,7 @@ static void table_dispatch_select(TableComponent* component, int index) {
     EventHandler handler = find_event_by_name(component->on_select_name);
     if (!handler) return;
 
-    cJSON* item = cJSON_GetArrayItem(layer->data->json, index);
+    cJSON* item = table_store_row(component, index);
     if (!item) return;
 
     char* item_json = cJSON_PrintUnformatted(item);
@@ -1506,6 +1640,7 @@ static int table_data_update(Layer* layer, cJSON* data) {
 
     int already_owned = layer->data && layer->data->json == data;
     if (!already_owned) {
+        table_store_free(component);
         if (layer->data) {
             if (layer->data->json) cJSON_Delete(layer->data->json);
             free(layer->data);
@@ -1518,10 +1653,11 @@ static int table_data_update(Layer* layer, cJSON* data) {
         layer->data->json = data;
     }
 
-    layer->data->size = cJSON_GetArraySize(data);
+    table_tooltip_reset(component);
+    table_store_rebuild(component);
+    layer->data->size = component->rows_count;
     component->hovered_row = -1;
     component->pressed_row = -1;
-    table_tooltip_reset(component);
     table_cancel_edit(component);
     component->selected_col = -1;
     if (component->selected_row >= layer->data->size) {
@@ -1533,6 +1669,80 @@ static int table_data_update(Layer* layer, cJSON* data) {
     return already_owned ? 0 : 1;
 }
 
+/* 追加行：行指针表按倍数扩容，已缓存的行与选中状态不受影响 */
+static int table_rows_append(Layer* layer, cJSON* rows) {
+    if (!layer || !layer->component || !rows || !cJSON_IsArray(rows)) return 0;
+
+    TableComponent* component = (TableComponent*)layer->component;
+    if (!layer->data || !layer->data->json || !cJSON_IsArray(layer->data->json)) {
+        cJSON* data = cJSON_CreateArray();
+        if (!data) return 0;
+        if (table_data_update(layer, data) == 0) {
+            cJSON_Delete(data);
+            return 0;
+        }
+    }
+
+    cJSON* data = layer->data->json;
+    int was_empty = component->rows_count == 0;
+    int add = cJSON_GetArraySize(rows);
+    if (add <= 0) return 1;
+
+    if (component->rows_count + add > component->rows_capacity) {
+        int capacity = component->rows_capacity > 0 ? component->rows_capacity : 16;
+        while (capacity < component->rows_count + add) capacity *= 2;
+        cJSON** grown = (cJSON**)realloc(component->rows, (size_t)capacity * sizeof(cJSON*));
+        if (!grown) return 0;
+        component->rows = grown;
+        component->rows_capacity = capacity;
+    }
+
+    while (rows->child) {
+        cJSON* row = cJSON_DetachItemViaPointer(rows, rows->child);
+        cJSON_AddItemToArray(data, row);
+        component->rows[component->rows_count++] = row;
+    }
+
+    if (was_empty) {
+        if (component->auto_columns || component->column_count == 0) {
+            table_build_auto_columns(component, data);
+        }
+        table_store_resolve_keys(component);
+    }
+    layer->data->size = component->rows_count;
+    table_component_update_content_size(component);
+    mark_layer_dirty(layer, DIRTY_LAYOUT | DIRTY_TEXT);
+    return 1;
+}
+
+// 替换一行：只作废该行的单元格缓存
+static int table_row_update(Layer* layer, int index, cJSON* row) {
+    if (!layer || !layer->component || !row) return 0;
+
+    TableComponent* component = (TableComponent*)layer->component;
+    if (!layer->data || !layer->data->json || index < 0 || index >= component->rows_count) {
+        return 0;
+    }
+    if (!cJSON_ReplaceItemViaPointer(layer->data->json, component->rows[index], row)) {
+        return 0;
+    }
+    component->rows[index] = row;
+
+    if (component->editing_row == index) {
+        table_cancel_edit(component);
+    }
+    if (component->tooltip_row == index) {
+        table_tooltip_reset(component);
+    }
+    if (index == 0) {
+        table_store_resolve_keys(component);
+    } else {
+        table_row_cache_invalidate(component, index);
+    }
+    mark_layer_dirty(layer, DIRTY_TEXT);
+    return 1;
+}
+
 static void table_layer_destroy(Layer* layer) {
     if (!layer || !layer->component) return;
     table_component_destroy((TableComponent*)layer->component);
@@ -1587,6 +1797,8 @@ TableComponent* table_component_create(Layer* layer) {
     layer->handle_key_event = table_component_handle_key_event;
     layer->focusable = 1;
     layer->on_data_update = table_data_update;
+    layer->on_rows_append = table_rows_append;
+    layer->on_row_update = table_row_update;
     layer->on_destroy = table_layer_destroy;
     layer->set_style = table_component_apply_theme_style;
 
@@ -1596,6 +1808,7 @@ TableComponent* table_component_create(Layer* layer) {
 void table_component_destroy(TableComponent* component) {
     if (!component) return;
     table_tooltip_reset(component);
+    table_store_free(component);
     table_free_columns(component);
     free(component);
 }
@@ -1734,17 +1947,16 @@ int table_component_get_row_count(TableComponent* component) {
     return table_row_count(component);
 }
 
-static void table_draw_cell_text(Layer* layer, const char* text, Color color,
+/* text_w/text_h 为已缓存的测量尺寸（逻辑像素），< 0 时现场测量 */
+static void table_draw_cell_text(Layer* layer, const char* text, int text_w, int text_h, Color color,
                                 int x, int y, int w, int h, TableColumnAlign align) {
-    if (!layer || !text || !layer->font || !layer->font->default_font) return;
+    if (!layer || !text || !text[0] || !layer->font || !layer->font->default_font) return;
 
-    Texture* tex = render_text(layer, text, color);
-    if (!tex) return;
-
-    int tw = 0, th = 0;
-    backend_query_texture(tex, NULL, NULL, &tw, &th);
-    int draw_w = (int)(tw / yui_density);
-    int draw_h = (int)(th / yui_density);
+    int draw_w = text_w;
+    int draw_h = text_h;
+    if (draw_w < 0 || draw_h < 0) {
+        if (render_text_size(layer, text, &draw_w, &draw_h) != 0) return;
+    }
     if (draw_w < 1) draw_w = 1;
     if (draw_h < 1) draw_h = 1;
 
@@ -1771,13 +1983,11 @@ static void table_draw_cell_text(Layer* layer, const char* text, Color color,
     Rect cell_clip = {x, y, w, h};
     Rect prev_clip;
     if (!render_clip_push(&cell_clip, &prev_clip)) {
-        backend_render_text_destroy(tex);
         return;
     }
 
     Rect dst = {draw_x, draw_y, draw_w, draw_h};
-    backend_render_text_copy(tex, NULL, &dst);
-    backend_render_text_destroy(tex);
+    render_text_at(layer, text, color, &dst);
 
     render_clip_pop(&prev_clip);
 }
@@ -1847,7 +2057,7 @@ static void table_render_header(TableComponent* component, Layer* layer, int vie
         TableColumn* col = &component->columns[i];
         Rect cell = {x, header.y, col->computed_width, header.h};
         if (cell.x + cell.w > header.x && cell.x < header.x + header.w) {
-            table_draw_cell_text(layer, col->title, component->header_text_color,
+            table_draw_cell_text(layer, col->title, -1, -1, component->header_text_color,
                                  cell.x, cell.y, cell.w, cell.h, col->align);
         }
         if (component->show_grid_lines) {
@@ -1880,14 +2090,13 @@ static void table_render_rows(TableComponent* component, Layer* layer, int viewp
     Rect body_clip;
     backend_render_get_clip_rect(&body_clip);
 
-    int row_count = cJSON_GetArraySize(layer->data->json);
+    int row_count = table_row_count(component);
     int first_row = layer->scroll_offset / component->row_height;
     if (first_row < 0) first_row = 0;
     int visible_rows = body_h / component->row_height + 2;
 
     for (int r = first_row; r < row_count && r < first_row + visible_rows; r++) {
-        cJSON* row = cJSON_GetArrayItem(layer->data->json, r);
-        if (!row) continue;
+        if (!table_store_row(component, r)) continue;
 
         /* Layout from table body origin — not from intersected clip.y */
         int row_y = body_y + r * component->row_height - layer->scroll_offset;
@@ -1928,14 +2137,12 @@ static void table_render_rows(TableComponent* component, Layer* layer, int viewp
             if (is_editing) {
                 table_render_edit_cell(component, layer, cell);
             } else {
-                cJSON* value = cJSON_GetObjectItem(row, col->key);
-                char* text = table_json_value_to_string(value);
-                if (text) {
-                    if (cell.x + cell.w > body_x && cell.x < body_x + viewport_w) {
-                        table_draw_cell_text(layer, text, layer->color,
+                if (cell.x + cell.w > body_x && cell.x < body_x + viewport_w) {
+                    TableCellCache* cached = table_store_cell(component, r, c);
+                    if (cached && table_store_cell_size(component, layer, cached) == 0) {
+                        table_draw_cell_text(layer, cached->text, cached->w, cached->h, layer->color,
                                              cell.x, cell.y, cell.w, cell.h, col->align);
                     }
-                    free(text);
                 }
             }
 
@@ -25,6 +25,20 @@ typedef struct TableColumn {
     int computed_width;
 } TableColumn;
 
+#define TABLE_ROW_CACHE_SLOTS 128  // 按行号直接映射，覆盖可见行与最近访问的行
+
+// 单元格显示字符串及其测量尺寸（逻辑像素，w < 0 表示未测量）
+typedef struct TableCellCache {
+    char* text;
+    int w;
+    int h;
+} TableCellCache;
+
+typedef struct TableRowCache {
+    int row;                // -1 表示空
+    TableCellCache* cells;  // row_cache_cols 个
+} TableRowCache;
+
 typedef struct TableComponent {
     Layer* layer;
     TableColumn* columns;
@@ -72,6 +86,14 @@ typedef struct TableComponent {
     int tooltip_col;
     Uint32 tooltip_hover_start;
     int tooltip_overflow;
+    /* 行存储：table_data_update 时建立，取行/取单元格均为 O(1) */
+    cJSON** rows;
+    int rows_count;
+    int rows_capacity;      // rows 已分配的槽数（appendRows 按倍数扩容）
+    int* column_key_pos;    // 每列 key 在首行中的位置，-1 表示按名查找
+    TableRowCache row_cache[TABLE_ROW_CACHE_SLOTS];
+    int row_cache_cols;
+    DFont* row_cache_font;  // 测量所用字体，变化后重新测量
 } TableComponent;
 
 TableComponent* table_component_create(Layer* layer);
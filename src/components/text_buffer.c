@@ -0,0 +1,480 @@
+#include "text_buffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct TextPiece {
+    TextPiece* left;
+    TextPiece* right;
+    unsigned int prio;
+    int from_add;
+    int start;
+    int len;
+    int lf;
+    int sub_len;
+    int sub_lf;
+};
+
+static int text_buffer_count_lf(const char* s, int n)
+{
+    int count = 0;
+    const char* end = s + n;
+    while (s < end) {
+        const char* nl = (const char*)memchr(s, '\n', (size_t)(end - s));
+        if (!nl) {
+            break;
+        }
+        count++;
+        s = nl + 1;
+    }
+    return count;
+}
+
+static unsigned int text_buffer_rand(TextBuffer* buffer)
+{
+    unsigned int x = buffer->seed ? buffer->seed : 2463534242u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    buffer->seed = x;
+    return x;
+}
+
+static const char* text_piece_data(const TextBuffer* buffer, const TextPiece* p)
+{
+    return (p->from_add ? buffer->add : buffer->original) + p->start;
+}
+
+static int text_piece_sub_len(const TextPiece* p)
+{
+    return p ? p->sub_len : 0;
+}
+
+static int text_piece_sub_lf(const TextPiece* p)
+{
+    return p ? p->sub_lf : 0;
+}
+
+static void text_piece_update(TextPiece* p)
+{
+    p->sub_len = p->len + text_piece_sub_len(p->left) + text_piece_sub_len(p->right);
+    p->sub_lf = p->lf + text_piece_sub_lf(p->left) + text_piece_sub_lf(p->right);
+}
+
+static TextPiece* text_piece_create(TextBuffer* buffer, int from_add, int start, int len)
+{
+    TextPiece* p = (TextPiece*)calloc(1, sizeof(TextPiece));
+    if (!p) {
+        return NULL;
+    }
+    p->prio = text_buffer_rand(buffer);
+    p->from_add = from_add;
+    p->start = start;
+    p->len = len;
+    p->lf = text_buffer_count_lf(text_piece_data(buffer, p), len);
+    text_piece_update(p);
+    return p;
+}
+
+static void text_piece_free_tree(TextPiece* p)
+{
+    if (!p) {
+        return;
+    }
+    text_piece_free_tree(p->left);
+    text_piece_free_tree(p->right);
+    free(p);
+}
+
+static TextPiece* text_piece_merge(TextPiece* a, TextPiece* b)
+{
+    if (!a) {
+        return b;
+    }
+    if (!b) {
+        return a;
+    }
+    if (a->prio >= b->prio) {
+        a->right = text_piece_merge(a->right, b);
+        text_piece_update(a);
+        return a;
+    }
+    b->left = text_piece_merge(a, b->left);
+    text_piece_update(b);
+    return b;
+}
+
+/* 前 pos 字节进 *l，其余进 *r；切到片段中间时用 spare 作为后半段（一次 split 至多切一个片段） */
+static void text_piece_split(const TextBuffer* buffer, TextPiece* t, int pos,
+                             TextPiece** l, TextPiece** r, TextPiece** spare)
+{
+    int lsz;
+    if (!t) {
+        *l = NULL;
+        *r = NULL;
+        return;
+    }
+    lsz = text_piece_sub_len(t->left);
+    if (pos <= lsz) {
+        text_piece_split(buffer, t->left, pos, l, &t->left, spare);
+        text_piece_update(t);
+        *r = t;
+    } else if (pos >= lsz + t->len) {
+        text_piece_split(buffer, t->right, pos - lsz - t->len, &t->right, r, spare);
+        text_piece_update(t);
+        *l = t;
+    } else {
+        int k = pos - lsz;
+        TextPiece* tail = *spare;
+        *spare = NULL;
+        /* 与 t 同优先级，t 的右子树仍满足堆序 */
+        tail->prio = t->prio;
+        tail->from_add = t->from_add;
+        tail->start = t->start + k;
+        tail->len = t->len - k;
+        tail->lf = text_buffer_count_lf(text_piece_data(buffer, tail), tail->len);
+        tail->left = NULL;
+        tail->right = t->right;
+        t->len = k;
+        t->lf -= tail->lf;
+        t->right = NULL;
+        text_piece_update(tail);
+        text_piece_update(t);
+        *l = t;
+        *r = tail;
+    }
+}
+
+static int text_buffer_split(TextBuffer* buffer, TextPiece* t, int pos, TextPiece** l, TextPiece** r)
+{
+    TextPiece* spare = (TextPiece*)calloc(1, sizeof(TextPiece));
+    if (!spare) {
+        return -1;
+    }
+    text_piece_split(buffer, t, pos, l, r, &spare);
+    free(spare);
+    return 0;
+}
+
+/* 连续输入：紧接在上一次追加之后时直接加长最右片段，避免每个按键产生一个节点 */
+static int text_piece_extend_last(TextBuffer* buffer, TextPiece* t, int add_start, int len, int lf)
+{
+    if (!t) {
+        return 0;
+    }
+    if (t->right) {
+        if (!text_piece_extend_last(buffer, t->right, add_start, len, lf)) {
+            return 0;
+        }
+    } else {
+        if (!t->from_add || t->start + t->len != add_start || t->len + len > TEXT_BUFFER_PIECE_MAX) {
+            return 0;
+        }
+        t->len += len;
+        t->lf += lf;
+    }
+    text_piece_update(t);
+    return 1;
+}
+
+static TextPiece* text_buffer_build_pieces(TextBuffer* buffer, int from_add, int start, int len)
+{
+    TextPiece* tree = NULL;
+    int off = 0;
+    while (off < len) {
+        int n = len - off;
+        TextPiece* p;
+        if (n > TEXT_BUFFER_PIECE_MAX) {
+            n = TEXT_BUFFER_PIECE_MAX;
+        }
+        p = text_piece_create(buffer, from_add, start + off, n);
+        if (!p) {
+            text_piece_free_tree(tree);
+            return NULL;
+        }
+        tree = text_piece_merge(tree, p);
+        off += n;
+    }
+    return tree;
+}
+
+void text_buffer_init(TextBuffer* buffer, const char* text)
+{
+    if (!buffer) {
+        return;
+    }
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->seed = 2463534242u;
+    text_buffer_set(buffer, text);
+}
+
+void text_buffer_free(TextBuffer* buffer)
+{
+    if (!buffer) {
+        return;
+    }
+    text_piece_free_tree(buffer->root);
+    free(buffer->original);
+    free(buffer->add);
+    buffer->root = NULL;
+    buffer->original = NULL;
+    buffer->add = NULL;
+    buffer->original_len = 0;
+    buffer->add_len = 0;
+    buffer->add_cap = 0;
+}
+
+int text_buffer_set(TextBuffer* buffer, const char* text)
+{
+    int len;
+    char* copy;
+    if (!buffer) {
+        return -1;
+    }
+    len = text ? (int)strlen(text) : 0;
+    copy = (char*)malloc((size_t)len + 1);
+    if (!copy) {
+        return -1;
+    }
+    if (len > 0) {
+        memcpy(copy, text, (size_t)len);
+    }
+    copy[len] = '\0';
+
+    text_buffer_free(buffer);
+    buffer->version++;
+    buffer->original = copy;
+    buffer->original_len = len;
+    buffer->root = text_buffer_build_pieces(buffer, 0, 0, len);
+    if (len > 0 && !buffer->root) {
+        return -1;
+    }
+    return 0;
+}
+
+int text_buffer_length(const TextBuffer* buffer)
+{
+    return buffer ? text_piece_sub_len(buffer->root) : 0;
+}
+
+int text_buffer_line_count(const TextBuffer* buffer)
+{
+    return buffer ? text_piece_sub_lf(buffer->root) + 1 : 1;
+}
+
+static int text_buffer_reserve_add(TextBuffer* buffer, int extra)
+{
+    int need = buffer->add_len + extra;
+    int cap;
+    char* grown;
+    if (need <= buffer->add_cap) {
+        return 0;
+    }
+    cap = buffer->add_cap > 0 ? buffer->add_cap : 256;
+    while (cap < need) {
+        cap *= 2;
+    }
+    grown = (char*)realloc(buffer->add, (size_t)cap);
+    if (!grown) {
+        return -1;
+    }
+    buffer->add = grown;
+    buffer->add_cap = cap;
+    return 0;
+}
+
+int text_buffer_insert(TextBuffer* buffer, int pos, const char* text, int len)
+{
+    TextPiece* left;
+    TextPiece* right;
+    TextPiece* mid;
+    int add_start;
+    if (!buffer || !text || len < 0 || pos < 0 || pos > text_buffer_length(buffer)) {
+        return -1;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    if (text_buffer_reserve_add(buffer, len) != 0) {
+        return -1;
+    }
+    buffer->version++;
+    add_start = buffer->add_len;
+    memcpy(buffer->add + add_start, text, (size_t)len);
+    buffer->add_len += len;
+
+    if (text_buffer_split(buffer, buffer->root, pos, &left, &right) != 0) {
+        buffer->add_len = add_start;
+        return -1;
+    }
+    if (text_piece_extend_last(buffer, left, add_start, len,
+                               text_buffer_count_lf(text, len))) {
+        buffer->root = text_piece_merge(left, right);
+        return 0;
+    }
+    mid = text_buffer_build_pieces(buffer, 1, add_start, len);
+    if (!mid) {
+        buffer->root = text_piece_merge(left, right);
+        buffer->add_len = add_start;
+        return -1;
+    }
+    buffer->root = text_piece_merge(text_piece_merge(left, mid), right);
+    return 0;
+}
+
+int text_buffer_delete(TextBuffer* buffer, int pos, int len)
+{
+    TextPiece* left;
+    TextPiece* rest;
+    TextPiece* mid;
+    TextPiece* right;
+    int total = text_buffer_length(buffer);
+    if (!buffer || pos < 0 || len < 0 || pos > total) {
+        return -1;
+    }
+    if (len > total - pos) {
+        len = total - pos;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    buffer->version++;
+    if (text_buffer_split(buffer, buffer->root, pos, &left, &rest) != 0) {
+        return -1;
+    }
+    if (text_buffer_split(buffer, rest, len, &mid, &right) != 0) {
+        buffer->root = text_piece_merge(left, rest);
+        return -1;
+    }
+    text_piece_free_tree(mid);
+    buffer->root = text_piece_merge(left, right);
+    return 0;
+}
+
+char text_buffer_byte_at(const TextBuffer* buffer, int pos)
+{
+    const TextPiece* p = buffer ? buffer->root : NULL;
+    if (pos < 0) {
+        return '\0';
+    }
+    while (p) {
+        int lsz = text_piece_sub_len(p->left);
+        if (pos < lsz) {
+            p = p->left;
+            continue;
+        }
+        pos -= lsz;
+        if (pos < p->len) {
+            return text_piece_data(buffer, p)[pos];
+        }
+        pos -= p->len;
+        p = p->right;
+    }
+    return '\0';
+}
+
+int text_buffer_line_start(const TextBuffer* buffer, int line)
+{
+    const TextPiece* p;
+    int base = 0;
+    int k;
+    if (!buffer || line <= 0) {
+        return 0;
+    }
+    if (line > text_piece_sub_lf(buffer->root)) {
+        line = text_piece_sub_lf(buffer->root);
+    }
+    /* 找第 line 个 '\n'，行首是它的下一个字节 */
+    k = line;
+    p = buffer->root;
+    while (p && k > 0) {
+        int llf = text_piece_sub_lf(p->left);
+        if (k <= llf) {
+            p = p->left;
+            continue;
+        }
+        k -= llf;
+        base += text_piece_sub_len(p->left);
+        if (k <= p->lf) {
+            const char* data = text_piece_data(buffer, p);
+            int i;
+            for (i = 0; i < p->len; i++) {
+                if (data[i] == '\n' && --k == 0) {
+                    return base + i + 1;
+                }
+            }
+        }
+        k -= p->lf;
+        base += p->len;
+        p = p->right;
+    }
+    return base;
+}
+
+int text_buffer_line_of(const TextBuffer* buffer, int pos)
+{
+    const TextPiece* p;
+    int lines = 0;
+    if (!buffer || pos <= 0) {
+        return 0;
+    }
+    p = buffer->root;
+    while (p) {
+        int lsz = text_piece_sub_len(p->left);
+        if (pos < lsz) {
+            p = p->left;
+            continue;
+        }
+        lines += text_piece_sub_lf(p->left);
+        pos -= lsz;
+        if (pos < p->len) {
+            return lines + text_buffer_count_lf(text_piece_data(buffer, p), pos);
+        }
+        lines += p->lf;
+        pos -= p->len;
+        p = p->right;
+    }
+    return lines;
+}
+
+static void text_piece_copy(const TextBuffer* buffer, const TextPiece* p, int base,
+                            int start, int end, char* out)
+{
+    int piece_start;
+    int piece_end;
+    if (!p || start >= end) {
+        return;
+    }
+    piece_start = base + text_piece_sub_len(p->left);
+    piece_end = piece_start + p->len;
+    if (start < piece_start) {
+        text_piece_copy(buffer, p->left, base, start, end, out);
+    }
+    if (start < piece_end && end > piece_start) {
+        int a = start > piece_start ? start : piece_start;
+        int b = end < piece_end ? end : piece_end;
+        memcpy(out + (a - start), text_piece_data(buffer, p) + (a - piece_start), (size_t)(b - a));
+    }
+    if (end > piece_end) {
+        text_piece_copy(buffer, p->right, piece_end, start, end, out);
+    }
+}
+
+int text_buffer_copy(const TextBuffer* buffer, int start, int end, char* out)
+{
+    int total = text_buffer_length(buffer);
+    if (!buffer || !out) {
+        return 0;
+    }
+    if (start < 0) {
+        start = 0;
+    }
+    if (end > total) {
+        end = total;
+    }
+    if (start >= end) {
+        return 0;
+    }
+    text_piece_copy(buffer, buffer->root, 0, start, end, out);
+    return end - start;
+}
@@ -0,0 +1,64 @@
+#ifndef YUI_TEXT_BUFFER_H
+#define YUI_TEXT_BUFFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Piece table text buffer.
+ *
+ * Text is a sequence of pieces referencing either the original buffer
+ * (read-only) or an append-only add buffer. Pieces live in a treap keyed
+ * by position; every node keeps subtree byte and newline counts, so
+ * insert/delete/offset/line lookups are O(log n). Pieces are capped at
+ * TEXT_BUFFER_PIECE_MAX bytes so in-piece scans stay bounded.
+ *
+ * Offsets are byte offsets; lines are 0-based and split on '\n'.
+ */
+
+#define TEXT_BUFFER_PIECE_MAX 4096
+
+typedef struct TextPiece TextPiece;
+
+typedef struct TextBuffer {
+    char* original;
+    int original_len;
+    char* add;
+    int add_len;
+    int add_cap;
+    TextPiece* root;
+    unsigned int seed;
+    unsigned int version; /* bumped by every edit, for callers caching copies */
+} TextBuffer;
+
+void text_buffer_init(TextBuffer* buffer, const char* text);
+void text_buffer_free(TextBuffer* buffer);
+
+/* Replace the whole content (resets both buffers). */
+int text_buffer_set(TextBuffer* buffer, const char* text);
+
+int text_buffer_length(const TextBuffer* buffer);
+int text_buffer_line_count(const TextBuffer* buffer);
+
+/* Returns 0 on success, -1 on allocation failure or bad range. */
+int text_buffer_insert(TextBuffer* buffer, int pos, const char* text, int len);
+int text_buffer_delete(TextBuffer* buffer, int pos, int len);
+
+/* Byte at pos, '\0' when out of range. */
+char text_buffer_byte_at(const TextBuffer* buffer, int pos);
+
+/* Offset of the first byte of line (clamped to [0, line_count - 1]). */
+int text_buffer_line_start(const TextBuffer* buffer, int line);
+
+/* Line containing pos (number of '\n' before pos). */
+int text_buffer_line_of(const TextBuffer* buffer, int pos);
+
+/* Copy [start, end) into out (no terminator); returns bytes copied. */
+int text_buffer_copy(const TextBuffer* buffer, int start, int end, char* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -81,64 +81,236 @@ static int text_component_get_left_padding(TextComponent* component) {
 }
 
 static void text_component_get_content_rect(TextComponent* component, Layer* layer, Rect* out);
-static void text_component_get_layout_line_range(TextComponent* component, const char* text,
-                                                 int text_len, int line_index,
+static void text_component_get_layout_line_range(TextComponent* component, int line_index,
                                                  int* out_start, int* out_end);
 static void text_component_insert_text(TextComponent* component, const char* text);
 static void text_component_delete_selection(TextComponent* component);
 static void text_component_delete_prev_char(TextComponent* component);
 static void text_component_delete_next_char(TextComponent* component);
 
-static TextEditSnapshot* text_component_capture_snapshot(TextComponent* component)
+/* 把 buffer 物化到 layer->text（复用已有容量），只在有人读取时进行 */
+static void text_component_sync_text(TextComponent* component)
 {
-    const char* text;
+    Layer* layer;
+    int len;
     if (!component || !component->layer) {
-        return NULL;
+        return;
+    }
+    layer = component->layer;
+    if (!component->text_stale && layer->text) {
+        return;
     }
-    text = component->layer->text ? component->layer->text : "";
-    return text_edit_snapshot_create(text,
-                                    component->cursor_pos,
-                                    component->selection_start,
-                                    component->selection_end,
-                                    component->style_runs,
-                                    component->style_run_count,
-                                    component->typing_style);
+    len = text_buffer_length(&component->buffer);
+    if (!layer->text || layer->text_size < (size_t)len + 1) {
+        char* grown = (char*)realloc(layer->text, (size_t)len + 1);
+        if (!grown) {
+            return;
+        }
+        layer->text = grown;
+        layer->text_size = (size_t)len + 1;
+    }
+    text_buffer_copy(&component->buffer, 0, len, layer->text);
+    layer->text[len] = '\0';
+    component->text_stale = 0;
+}
+
+// 平坦文本（需要整段字符串的路径使用），不为 NULL
+static char* text_component_text(TextComponent* component)
+{
+    text_component_sync_text(component);
+    return component->layer->text ? component->layer->text : (char*)"";
+}
+
+static int text_component_text_length(TextComponent* component)
+{
+    return text_buffer_length(&component->buffer);
 }
 
-static void text_component_apply_snapshot(TextComponent* component, TextEditSnapshot* snap)
+/*
+ * [start, end) 的连续副本，view[0] 对应 start；只从 piece table 拷这一段。
+ * 已缓存的区间包含它时直接返回，不再拷贝。返回值在下一次调用前有效。
+ */
+static const char* text_component_view(TextComponent* component, int start, int end)
 {
-    if (!component || !snap) {
+    int len;
+    if (start < 0) start = 0;
+    if (end > text_buffer_length(&component->buffer)) end = text_buffer_length(&component->buffer);
+    if (end < start) end = start;
+    if (component->view && component->view_version == component->buffer.version &&
+        start >= component->view_start && end <= component->view_start + component->view_len) {
+        return component->view + (start - component->view_start);
+    }
+    len = end - start;
+    if (!component->view || component->view_cap < len + 1) {
+        char* grown = (char*)realloc(component->view, (size_t)len + 1);
+        if (!grown) {
+            return NULL;
+        }
+        component->view = grown;
+        component->view_cap = len + 1;
+    }
+    text_buffer_copy(&component->buffer, start, end, component->view);
+    component->view[len] = '\0';
+    component->view_start = start;
+    component->view_len = len;
+    component->view_version = component->buffer.version;
+    return component->view;
+}
+
+static void text_layer_sync_text(Layer* layer)
+{
+    if (layer && layer->component) {
+        text_component_sync_text((TextComponent*)layer->component);
+    }
+}
+
+// layer_set_text 从外部整体替换文本
+static void text_layer_on_text_set(Layer* layer)
+{
+    TextComponent* component;
+    if (!layer || !layer->component) {
         return;
     }
-    layer_set_text(component->layer, snap->text ? snap->text : "");
-    component->cursor_pos = snap->cursor_pos;
-    component->selection_start = snap->selection_start;
-    component->selection_end = snap->selection_end;
-    component->typing_style = snap->typing_style;
+    component = (TextComponent*)layer->component;
+    text_buffer_set(&component->buffer, layer->text);
+    component->text_stale = 0;
+    // 历史里的增量基于旧文本，整体替换后无法回放
+    text_edit_history_clear(&component->history);
+    if (component->cursor_pos > text_buffer_length(&component->buffer)) {
+        component->cursor_pos = text_buffer_length(&component->buffer);
+    }
+    text_component_invalidate_layout(component);
+}
+
+/* 用 ins 替换 [start, end)，O(log n)；layer->text 延迟到下次读取时再物化 */
+static int text_component_replace_range(TextComponent* component, int start, int end,
+                                        const char* ins, int ins_len)
+{
+    int removed_lines;
+
+    if (component->history.open) {
+        // 记录增量：只保存被删掉的字节和插入的字节
+        char* removed = NULL;
+        if (end > start) {
+            removed = (char*)malloc((size_t)(end - start));
+            if (!removed) {
+                return -1;
+            }
+            text_buffer_copy(&component->buffer, start, end, removed);
+        }
+        text_edit_history_record(&component->history, start, removed, end - start, ins, ins_len);
+        free(removed);
+    }
+    removed_lines = end > start
+        ? text_buffer_line_of(&component->buffer, end) - text_buffer_line_of(&component->buffer, start)
+        : 0;
+    if (end > start && text_buffer_delete(&component->buffer, start, end - start) != 0) {
+        return -1;
+    }
+    if (ins_len > 0 && text_buffer_insert(&component->buffer, start, ins, ins_len) != 0) {
+        return -1;
+    }
+    component->text_stale = 1;
+
+    // 布局只作废受影响的段，后面的段保留测量结果
+    if (component->layout.para_count > 0 &&
+        component->layout_cache_revision == component->text_revision) {
+        if (text_layout_replace(&component->layout, &component->buffer, start,
+                                end - start, removed_lines, ins_len) == 0) {
+            component->layout_cache_text_len = text_buffer_length(&component->buffer);
+            component->layout_incremental = 1;
+        } else {
+            text_component_invalidate_layout(component);
+        }
+    }
+    mark_layer_dirty(component->layer, DIRTY_TEXT);
+    return 0;
+}
+
+static int text_component_prev_char_len(TextComponent* component, int pos)
+{
+    int n = 1;
+    if (pos <= 0) {
+        return 0;
+    }
+    while (pos - n > 0 && n < 4 &&
+           ((unsigned char)text_buffer_byte_at(&component->buffer, pos - n) & 0xC0) == 0x80) {
+        n++;
+    }
+    return n;
+}
+
+static int text_component_next_char_len(TextComponent* component, int pos)
+{
+    int n = utf8_char_len((unsigned char)text_buffer_byte_at(&component->buffer, pos));
+    if (n <= 0) n = 1;
+    if (pos + n > text_buffer_length(&component->buffer)) {
+        n = text_buffer_length(&component->buffer) - pos;
+    }
+    return n;
+}
+
+static void text_component_capture_state(TextComponent* component, TextEditState* state)
+{
+    text_edit_state_set(state,
+                        component->cursor_pos,
+                        component->selection_start,
+                        component->selection_end,
+                        component->style_runs,
+                        component->style_run_count,
+                        component->typing_style);
+}
+
+static void text_component_apply_state(TextComponent* component, const TextEditState* state)
+{
+    int len = text_buffer_length(&component->buffer);
+    component->cursor_pos = state->cursor_pos;
+    component->selection_start = state->selection_start;
+    component->selection_end = state->selection_end;
+    if (component->cursor_pos > len) component->cursor_pos = len;
+    if (component->selection_end > len) component->selection_end = len;
+    component->typing_style = state->typing_style;
     text_style_runs_free(component->style_runs);
-    component->style_runs = text_style_runs_clone(snap->runs, snap->run_count);
-    component->style_run_count = component->style_runs ? snap->run_count : 0;
+    component->style_runs = text_style_runs_clone(state->runs, state->run_count);
+    component->style_run_count = component->style_runs ? state->run_count : 0;
+    component->text_stale = 1;
     component->cursor_visual_line = -1;
+    mark_layer_dirty(component->layer, DIRTY_TEXT);
     text_component_invalidate_layout(component);
     text_component_update_content_height(component);
     text_component_update_scroll_for_cursor(component);
     text_component_trigger_on_change(component);
 }
 
+/* 回放一步：undo 逆序撤销每个替换，redo 顺序重做；直接改 buffer，不再记录历史 */
+static void text_component_apply_step(TextComponent* component, const TextEditStep* step, int reverse)
+{
+    int i;
+    for (i = 0; i < step->op_count; i++) {
+        const TextEditOp* op = &step->ops[reverse ? step->op_count - 1 - i : i];
+        int del_len = reverse ? op->inserted_len : op->removed_len;
+        const char* ins_text = reverse ? op->removed : op->inserted;
+        int ins_len = reverse ? op->removed_len : op->inserted_len;
+        if (del_len > 0) {
+            text_buffer_delete(&component->buffer, op->pos, del_len);
+        }
+        if (ins_len > 0) {
+            text_buffer_insert(&component->buffer, op->pos, ins_text, ins_len);
+        }
+    }
+}
+
 static void text_component_begin_edit(TextComponent* component, TextEditKind kind)
 {
-    TextEditSnapshot* snap;
+    TextEditState state;
     if (!component) {
         return;
     }
     if (component->history_suppress > 0) {
         return;
     }
-    snap = text_component_capture_snapshot(component);
-    if (!snap) {
-        return;
-    }
-    text_edit_history_before_edit(&component->history, snap, kind, backend_get_ticks());
+    text_component_capture_state(component, &state);
+    text_edit_history_before_edit(&component->history, &state, kind, backend_get_ticks());
 }
 
 static void text_component_history_suppress_begin(TextComponent* component)
@@ -157,39 +329,33 @@ static void text_component_history_suppress_end(TextComponent* component)
 
 static int text_component_do_undo(TextComponent* component)
 {
-    TextEditSnapshot* current;
-    TextEditSnapshot* prev;
+    TextEditState current;
+    const TextEditStep* step;
     if (!component || !text_edit_history_can_undo(&component->history)) {
         return 0;
     }
-    current = text_component_capture_snapshot(component);
-    prev = text_edit_history_undo(&component->history, current);
-    if (!prev) {
+    text_component_capture_state(component, &current);
+    step = text_edit_history_undo(&component->history, &current);
+    if (!step) {
         return 0;
     }
-    text_component_history_suppress_begin(component);
-    text_component_apply_snapshot(component, prev);
-    text_component_history_suppress_end(component);
-    text_edit_snapshot_free(prev);
+    text_component_apply_step(component, step, 1);
+    text_component_apply_state(component, &step->before);
     return 1;
 }
 
 static int text_component_do_redo(TextComponent* component)
 {
-    TextEditSnapshot* current;
-    TextEditSnapshot* next;
+    const TextEditStep* step;
     if (!component || !text_edit_history_can_redo(&component->history)) {
         return 0;
     }
-    current = text_component_capture_snapshot(component);
-    next = text_edit_history_redo(&component->history, current);
-    if (!next) {
+    step = text_edit_history_redo(&component->history);
+    if (!step) {
         return 0;
     }
-    text_component_history_suppress_begin(component);
-    text_component_apply_snapshot(component, next);
-    text_component_history_suppress_end(component);
-    text_edit_snapshot_free(next);
+    text_component_apply_step(component, step, 0);
+    text_component_apply_state(component, &step->after);
     return 1;
 }
 
@@ -213,13 +379,28 @@ static void text_component_normalize_selection_range(TextComponent* component, i
         s = e;
         e = t;
     }
-    text_len = component->layer && component->layer->text ? (int)strlen(component->layer->text) : 0;
+    text_len = component->layer ? text_component_text_length(component) : 0;
     if (s < 0) s = 0;
     if (e > text_len) e = text_len;
     *start = s;
     *end = e;
 }
 
+// 样式改变字宽：只重排选区覆盖的段
+static void text_component_invalidate_style_range(TextComponent* component, int start, int end)
+{
+    if (start >= end) {
+        return;
+    }
+    if (component->layout.para_count > 0 &&
+        component->layout_cache_revision == component->text_revision) {
+        text_layout_invalidate_paras(&component->layout,
+                                     text_buffer_line_of(&component->buffer, start),
+                                     text_buffer_line_of(&component->buffer, end));
+        component->layout_incremental = 1;
+    }
+}
+
 static int text_component_toggle_style(TextComponent* component, uint32_t flags)
 {
     int start;
@@ -231,6 +412,7 @@ static int text_component_toggle_style(TextComponent* component, uint32_t flags)
     text_component_begin_edit(component, TEXT_EDIT_STYLE);
     if (start < end) {
         text_style_runs_toggle(&component->style_runs, &component->style_run_count, start, end, flags);
+        text_component_invalidate_style_range(component, start, end);
     } else {
         component->typing_style ^= flags;
     }
@@ -508,125 +690,71 @@ void text_component_invalidate_layout(TextComponent* component) {
 
 static void text_component_free_layout(TextComponent* component) {
     if (!component) return;
-    free(component->layout_starts);
-    component->layout_starts = NULL;
-    component->layout_count = 0;
+    text_layout_free(&component->layout);
     component->layout_cache_revision = -1;
     component->layout_cache_max_width = 0;
     component->layout_cache_text_len = -1;
 }
 
+static int text_component_layout_wrap(void* user, int start, int para_end, int max_width) {
+    TextComponent* component = (TextComponent*)user;
+    const char* text;
+    int end;
+
+    if (!component->wrap) {
+        return para_end;
+    }
+    // 同一段的后续视觉行落在已拷贝的区间内，整段只拷一次
+    text = text_component_view(component, start, para_end);
+    if (!text) {
+        return para_end;
+    }
+    end = text_component_find_wrap_end(text, 0, para_end - start, max_width, component);
+    if (end <= 0) {
+        int clen = utf8_char_len_at(text);
+        end = clen > 0 ? clen : 1;
+    }
+    return start + end;
+}
+
+/*
+ * 布局按段缓存，这里只在版本/宽度变化时重建段表（不测量）。
+ * 段内折行在用到对应视觉行时才测量，见 text_layout.c。
+ */
 static void text_component_ensure_layout(TextComponent* component, int max_width) {
     if (!component || !component->layer) return;
-    const char* text = component->layer->text ? component->layer->text : "";
-    int text_len = (int)strlen(text);
+    int text_len = text_component_text_length(component);
     if (max_width < 1) max_width = 1;
 
-    if (component->layout_starts &&
+    if (component->layout.para_count > 0 &&
         component->layout_cache_revision == component->text_revision &&
         component->layout_cache_max_width == max_width &&
         component->layout_cache_text_len == text_len) {
         return;
     }
-    int capacity = 64;
-    int* starts = (int*)malloc(sizeof(int) * (size_t)capacity);
-    if (!starts) return;
-
-    int count = 0;
-    int current_pos = 0;
-    while (current_pos < text_len) {
-        if (count >= capacity) {
-            capacity *= 2;
-            int* grown = (int*)realloc(starts, sizeof(int) * (size_t)capacity);
-            if (!grown) break;
-            starts = grown;
-        }
-        starts[count++] = current_pos;
-
-        int line_end = current_pos;
-        while (line_end < text_len && text[line_end] != '\n') {
-            line_end++;
-        }
 
-        if (component->wrap) {
-            int split_pos = text_component_find_wrap_end(text, current_pos, line_end, max_width, component);
-            if (split_pos <= current_pos) {
-                int clen = utf8_char_len_at(text + current_pos);
-                split_pos = current_pos + (clen > 0 ? clen : 1);
-            }
-            if (split_pos < line_end) {
-                current_pos = split_pos;
-                continue;
-            }
-        }
-        if (line_end < text_len && text[line_end] == '\n') {
-            current_pos = line_end + 1;
-        } else {
-            current_pos = line_end;
-        }
-    }
-
-    /*
-     * A trailing empty visual line exists only for empty text or a final
-     * explicit newline.  Adding one after every non-empty line made the
-     * cursor and content height one line too large when wrap was disabled.
-     */
-    if (text_len == 0 || text[text_len - 1] == '\n') {
-        if (count >= capacity) {
-            int* grown = (int*)realloc(starts, sizeof(int) * (size_t)(capacity + 1));
-            if (grown) {
-                starts = grown;
-                capacity++;
-            }
-        }
-        if (count < capacity) {
-            starts[count++] = text_len;
+    {
+        /* 未测量段的估算：按半个行高的平均字宽 */
+        int avg_char_w = text_component_get_line_height(component) / 2;
+        int est_bytes_per_line = max_width / (avg_char_w > 0 ? avg_char_w : 1);
+        if (text_layout_reset(&component->layout, &component->buffer,
+                              max_width, component->wrap, est_bytes_per_line) != 0) {
+            return;
         }
     }
-
-    free(component->layout_starts);
-    component->layout_starts = starts;
-    component->layout_count = count;
     component->layout_cache_revision = component->text_revision;
     component->layout_cache_max_width = max_width;
     component->layout_cache_text_len = text_len;
 }
 
-static int text_component_count_visual_lines_in_range(TextComponent* component, int max_width,
-                                                      int start, int logical_end) {
-    if (!component || !component->layer || !component->layer->text) return 1;
-    char* text = component->layer->text;
-    if (start >= logical_end) return 1;
-
-    if (!component->wrap) {
-        int lines = 0;
-        int pos = start;
-        while (pos < logical_end) {
-            int next = pos;
-            while (next < logical_end && text[next] != '\n') {
-                next++;
-            }
-            lines++;
-            pos = (next < logical_end && text[next] == '\n') ? next + 1 : next;
-        }
-        return lines > 0 ? lines : 1;
-    }
-
-    int width = text_component_measure_width(component, text, start, logical_end);
-    if (width <= max_width) return 1;
+static int text_component_layout_count(TextComponent* component) {
+    return text_layout_line_count(&component->layout);
+}
 
-    int lines = 0;
-    int pos = start;
-    while (pos < logical_end) {
-        int split_pos = text_component_find_wrap_end(text, pos, logical_end, max_width, component);
-        if (split_pos <= pos) {
-            int clen = utf8_char_len_at(text + pos);
-            split_pos = pos + (clen > 0 ? clen : 1);
-        }
-        lines++;
-        pos = split_pos;
-    }
-    return lines > 0 ? lines : 1;
+// pos 所在的视觉行；软换行边界按 prefer_line 决定归属
+static int text_component_layout_line_of(TextComponent* component, int pos, int prefer_line) {
+    return text_layout_line_of(&component->layout, &component->buffer, pos, prefer_line,
+                               text_component_layout_wrap, component);
 }
 
 static int text_component_render_text_cluster_font(TextComponent* component, DFont* font,
@@ -789,15 +917,18 @@ static void text_component_render_text_segment_plain(TextComponent* component, D
     }
 }
 
+/* text 是 [start, end) 这一段（text[0] 对应 start）；start/end 只用于查样式段 */
 static void text_component_render_text_segment(TextComponent* component, const char* text,
                                                int start, int end, int x, int y) {
+    int len = end - start;
+
     if (!component || !component->layer || !component->layer->font || !component->layer->font->default_font) {
         return;
     }
-    if (start >= end) return;
+    if (!text || start >= end) return;
 
     if (component->syntax_config.lang != NULL) {
-        text_syntax_render_range(component->layer->font->default_font, text, start, end,
+        text_syntax_render_range(component->layer->font->default_font, text, 0, len,
                                  &component->syntax_config, x, y);
         return;
     }
@@ -810,30 +941,31 @@ static void text_component_render_text_segment(TextComponent* component, const c
                                                      component->style_run_count, pos);
             int seg_end = text_component_style_seg_end(component, pos, end);
             DFont* font = text_component_font_for_flags(component, flags);
-            int len = seg_end - pos;
+            int seg_len = seg_end - pos;
+            const char* seg = text + (pos - start);
             char* buf;
             Texture* tex;
             if (!font) {
                 font = component->layer->font->default_font;
             }
-            buf = (char*)malloc((size_t)len + 1);
+            buf = (char*)malloc((size_t)seg_len + 1);
             if (!buf) {
                 break;
             }
-            memcpy(buf, text + pos, (size_t)len);
-            buf[len] = '\0';
+            memcpy(buf, seg, (size_t)seg_len);
+            buf[seg_len] = '\0';
             tex = backend_render_texture(font, buf, component->layer->color);
             free(buf);
             if (!tex) {
-                text_component_render_text_segment_graphemes_font(component, font, text, pos, seg_end,
+                text_component_render_text_segment_graphemes_font(component, font, seg, 0, seg_len,
                                                                   cursor_x, y);
                 /* approximate advance for next piece */
                 {
                     int approx = 0;
-                    int p = pos;
-                    while (p < seg_end) {
+                    int p = 0;
+                    while (p < seg_len) {
                         int clen = 0;
-                        unsigned int cp = text_component_codepoint_at(text + p, &clen);
+                        unsigned int cp = text_component_codepoint_at(seg + p, &clen);
                         int adv = text_component_estimate_cluster_width(component, cp);
                         if (adv < 1) adv = 1;
                         approx += adv;
@@ -855,7 +987,7 @@ static void text_component_render_text_segment(TextComponent* component, const c
     }
 
     text_component_render_text_segment_plain(component, component->layer->font->default_font,
-                                             text, start, end, x, y);
+                                             text, 0, len, x, y);
 }
 
 void text_component_set_syntax_highlight(TextComponent* component, const char* language) {
@@ -993,7 +1125,6 @@ static void text_component_apply_theme_style(Layer* layer, cJSON* style) {
 static void text_layer_destroy(Layer* layer) {
     if (!layer || !layer->component) return;
     text_component_destroy((TextComponent*)layer->component);
-    layer->component = NULL;
 }
 
 TextComponent* text_component_create(Layer* layer) {
@@ -1028,12 +1159,12 @@ TextComponent* text_component_create(Layer* layer) {
     component->cached_line_height = 0;  // 行高缓存初始化为0（无效）
     component->line_height_valid = 0;  // 标记缓存无效
     component->text_revision = 0;
-    component->layout_starts = NULL;
-    component->layout_count = 0;
+    text_layout_init(&component->layout);
+    component->layout_incremental = 0;
     component->layout_cache_revision = -1;
     component->layout_cache_max_width = 0;
     component->layout_cache_text_len = -1;
-    text_edit_history_init(&component->history, 80);
+    text_edit_history_init(&component->history, TEXT_EDIT_HISTORY_DEFAULT_BYTES);
     component->history_suppress = 0;
     component->style_runs = NULL;
     component->style_run_count = 0;
@@ -1046,6 +1177,8 @@ TextComponent* text_component_create(Layer* layer) {
     if (!layer->text) {
         layer_set_text(layer, "");  // 初始化为空字符串
     }
+    text_buffer_init(&component->buffer, layer->text);
+    component->text_stale = 0;
     
     // 设置图层的焦点属性，使其可以获得焦点
     layer->focusable = 1;
@@ -1060,6 +1193,8 @@ TextComponent* text_component_create(Layer* layer) {
     layer->set_property = text_component_set_property_from_json;
     layer->set_style = text_component_apply_theme_style;
     layer->on_destroy = text_layer_destroy;
+    layer->sync_text = text_layer_sync_text;
+    layer->on_text_set = text_layer_on_text_set;
 
     return component;
 }
@@ -1156,7 +1291,18 @@ TextComponent* text_component_create_from_json(Layer* layer,cJSON* json_obj){
 // 销毁文本组件
 void text_component_destroy(TextComponent* component) {
     if (component) {
+        Layer* layer = component->layer;
+        if (layer && layer->component == component) {
+            // 先物化，组件销毁后 layer->text 仍保持最新内容，并摘掉指向组件的钩子
+            text_component_sync_text(component);
+            layer->component = NULL;
+            layer->sync_text = NULL;
+            layer->on_text_set = NULL;
+        }
         text_component_free_layout(component);
+        text_buffer_free(&component->buffer);
+        free(component->view);
+        component->view = NULL;
         text_edit_history_free(&component->history);
         text_style_runs_free(component->style_runs);
         component->style_runs = NULL;
@@ -1240,11 +1386,11 @@ void text_component_set_max_length(TextComponent* component, int max_length) {
     // 注释掉最大长度检查，因为现在使用 layer_set_text_with_size 进行动态内存分配
     /*
     // 确保文本不超过新的最大长度
-    if (strlen(component->layer->text) >= max_length) {
+    if (text_component_text_length(component) >= max_length) {
         // 截断文本
         char* temp_text = malloc(max_length);
         if (temp_text) {
-            strncpy(temp_text, component->layer->text, max_length - 1);
+            strncpy(temp_text, text_component_text(component), max_length - 1);
             temp_text[max_length - 1] = '\0';
             layer_set_text(component->layer, temp_text);
             free(temp_text);
@@ -1372,8 +1518,8 @@ cJSON* text_component_get_property(Layer* layer, const char* property_name) {
     
     if (strcmp(property_name, "value") == 0 || strcmp(property_name, "text") == 0) {
         // 获取文本内容
-        if (layer->text && strlen(layer->text) > 0) {
-            return cJSON_CreateString(layer->text);
+        if (text_component_text_length(component) > 0) {
+            return cJSON_CreateString(text_component_text(component));
         }
         return cJSON_CreateNull();
     }
@@ -1403,7 +1549,10 @@ cJSON* text_component_get_property(Layer* layer, const char* property_name) {
         int pad_top;
         int pad_bottom;
         if (layer->dirty_flags & DIRTY_TEXT) {
-            text_component_invalidate_layout(component);
+            if (!component->layout_incremental) {
+                text_component_invalidate_layout(component);
+            }
+            component->layout_incremental = 0;
             layer->dirty_flags &= ~DIRTY_TEXT;
         }
         text_component_update_content_height(component);
@@ -1432,7 +1581,7 @@ cJSON* text_component_get_property(Layer* layer, const char* property_name) {
         char* selected;
         int len;
 
-        if (start < 0 || end < 0 || !layer->text) {
+        if (start < 0 || end < 0) {
             return cJSON_CreateString("");
         }
         if (start > end) {
@@ -1440,7 +1589,7 @@ cJSON* text_component_get_property(Layer* layer, const char* property_name) {
             start = end;
             end = tmp;
         }
-        text_len = (int)strlen(layer->text);
+        text_len = text_component_text_length(component);
         if (start > text_len) start = text_len;
         if (end > text_len) end = text_len;
         if (start >= end) {
@@ -1451,7 +1600,7 @@ cJSON* text_component_get_property(Layer* layer, const char* property_name) {
         if (!selected) {
             return cJSON_CreateString("");
         }
-        memcpy(selected, layer->text + start, (size_t)len);
+        text_buffer_copy(&component->buffer, start, end, selected);
         selected[len] = '\0';
         {
             cJSON* out = cJSON_CreateString(selected);
@@ -1469,7 +1618,7 @@ cJSON* text_component_get_property(Layer* layer, const char* property_name) {
         return layer->font ? cJSON_CreateNumber(layer->font->size) : cJSON_CreateNull();
     }
     else if (strcmp(property_name, "length") == 0) {
-        return cJSON_CreateNumber(layer->text ? (double)strlen(layer->text) : 0);
+        return cJSON_CreateNumber(text_component_text_length(component));
     }
     else if (strcmp(property_name, "lineStart") == 0) {
         return cJSON_CreateNumber(get_line_start(component, component->cursor_pos));
@@ -1541,7 +1690,7 @@ static void text_component_clamp_cursor(TextComponent* component)
     if (!component || !component->layer) {
         return;
     }
-    text_len = component->layer->text ? (int)strlen(component->layer->text) : 0;
+    text_len = text_component_text_length(component);
     if (component->cursor_pos < 0) {
         component->cursor_pos = 0;
     }
@@ -1557,7 +1706,7 @@ static void text_component_clamp_selection(TextComponent* component)
     if (!component || !component->layer) {
         return;
     }
-    text_len = component->layer->text ? (int)strlen(component->layer->text) : 0;
+    text_len = text_component_text_length(component);
     if (component->selection_start < -1) {
         component->selection_start = -1;
     }
@@ -1579,7 +1728,7 @@ static int text_component_copy_selection_to_clipboard(TextComponent* component)
     int len;
     char* selected;
 
-    if (!component || !component->layer || !component->layer->text) {
+    if (!component || !component->layer) {
         return 0;
     }
     if (component->selection_start < 0 || component->selection_end < 0) {
@@ -1600,7 +1749,7 @@ static int text_component_copy_selection_to_clipboard(TextComponent* component)
     if (!selected) {
         return 0;
     }
-    memcpy(selected, component->layer->text + start, (size_t)len);
+    text_buffer_copy(&component->buffer, start, end, selected);
     selected[len] = '\0';
     backend_set_clipboard_text(selected);
     free(selected);
@@ -1696,7 +1845,7 @@ int text_component_set_property_from_json(Layer* layer, const char* key, cJSON*
         return 1;
     }
     if (strcmp(key, "selectAll") == 0) {
-        int text_len = layer->text ? (int)strlen(layer->text) : 0;
+        int text_len = text_component_text_length(component);
         component->selection_start = 0;
         component->selection_end = text_len;
         component->cursor_pos = text_len;
@@ -1792,6 +1941,7 @@ int text_component_set_property_from_json(Layer* layer, const char* key, cJSON*
                 text_style_runs_apply(&component->style_runs, &component->style_run_count,
                                       start, end, 0, flag);
             }
+            text_component_invalidate_style_range(component, start, end);
         } else if (enable) {
             component->typing_style |= flag;
         } else {
@@ -1922,35 +2072,20 @@ static void text_component_delete_selection(TextComponent* component) {
     // 确保start不为负数
     if (start < 0) start = 0;
     // 确保end不超过文本长度
-    int text_len = strlen(component->layer->text);
+    int text_len = text_component_text_length(component);
     if (end > text_len) end = text_len;
     
     // 只有当start < end时才执行删除操作
     if (start < end) {
         text_component_begin_edit(component, TEXT_EDIT_DELETE);
 
-        // 计算新文本的长度
-        size_t new_len = text_len - (end - start);
-        
-        // 创建临时缓冲区存储新文本
-        char* new_text = malloc(new_len + 1);
-        if (!new_text) {
+        if (text_component_replace_range(component, start, end, NULL, 0) != 0) {
             return;
         }
-        
-        // 复制start之前的部分
-        memcpy(new_text, component->layer->text, start);
-        // 复制end之后的部分
-        memcpy(new_text + start, component->layer->text + end, text_len - end + 1);
-        
-        // 设置新文本
-        layer_set_text(component->layer, new_text);
-        free(new_text);
 
         text_style_runs_delete(&component->style_runs, &component->style_run_count, start, end);
         
         component->cursor_pos = start;
-        text_component_invalidate_layout(component);
         
         // 更新内容高度
         text_component_update_content_height(component);
@@ -1969,7 +2104,7 @@ static void text_component_insert_char(TextComponent* component, char c) {
         return;
     }
 
-    int len = strlen(component->layer->text);
+    int len = text_component_text_length(component);
     int has_selection = 0;
     int insert_at;
 
@@ -1994,7 +2129,7 @@ static void text_component_insert_char(TextComponent* component, char c) {
         text_component_delete_selection(component);
         text_component_history_suppress_end(component);
         // 更新len，因为删除选择后文本长度可能改变
-        len = strlen(component->layer->text);
+        len = text_component_text_length(component);
     }
     
     // 确保cursor_pos在有效范围内
@@ -2002,25 +2137,9 @@ static void text_component_insert_char(TextComponent* component, char c) {
     if (component->cursor_pos > len) component->cursor_pos = len;
     insert_at = component->cursor_pos;
     
-    // 计算新文本长度
-    size_t new_len = len + 1;
-    
-    // 创建临时缓冲区存储新文本
-    char* new_text = malloc(new_len + 1);
-    if (!new_text) {
+    if (text_component_replace_range(component, insert_at, insert_at, &c, 1) != 0) {
         return;
     }
-    
-    // 复制光标位置之前的部分
-    memcpy(new_text, component->layer->text, component->cursor_pos);
-    // 插入新字符
-    new_text[component->cursor_pos] = c;
-    // 复制光标位置之后的部分
-    memcpy(new_text + component->cursor_pos + 1, component->layer->text + component->cursor_pos, len - component->cursor_pos + 1);
-    
-    // 设置新文本
-    layer_set_text(component->layer, new_text);
-    free(new_text);
 
     text_style_runs_insert(&component->style_runs, &component->style_run_count, insert_at, 1);
     if (component->typing_style) {
@@ -2029,7 +2148,6 @@ static void text_component_insert_char(TextComponent* component, char c) {
     }
     
     component->cursor_pos++;
-    text_component_invalidate_layout(component);
     
     // 更新内容高度（只调用一次）
     text_component_update_content_height(component);
@@ -2046,10 +2164,7 @@ void text_component_update_scroll_for_cursor(TextComponent* component) {
     Rect render_rect;
     int line_height;
     int line_stride;
-    int text_len;
-    const char* text;
     int cursor_line = 0;
-    int i;
 
     if (!component || !component->layer) {
         return;
@@ -2059,29 +2174,11 @@ void text_component_update_scroll_for_cursor(TextComponent* component) {
 
     /* Multiline: keep cursor line visible via vertical scroll_offset */
     if (component->multiline) {
-        if (!component->layer->text) {
-            component->layer->scroll_offset = 0;
-            return;
-        }
-        text = component->layer->text;
-        text_len = (int)strlen(text);
         line_height = text_component_get_line_height(component);
         line_stride = line_height + TEXT_LINE_SPACING;
         text_component_ensure_layout(component, render_rect.w > 0 ? render_rect.w : 1);
-
-        for (i = 0; i < component->layout_count; i++) {
-            int start = 0;
-            int end = 0;
-            text_component_get_layout_line_range(component, text, text_len, i, &start, &end);
-            if (component->cursor_pos < end ||
-                (component->cursor_pos == end &&
-                 ((end < text_len && text[end] == '\n') ||
-                  component->cursor_visual_line == i)) ||
-                i == component->layout_count - 1) {
-                cursor_line = i;
-                break;
-            }
-        }
+        cursor_line = text_component_layout_line_of(component, component->cursor_pos,
+                                                    component->cursor_visual_line);
 
         {
             int cursor_top = cursor_line * line_stride;
@@ -2124,11 +2221,15 @@ void text_component_update_scroll_for_cursor(TextComponent* component) {
         int cursor_x;
         int cursor_pixel_x;
         char* before_cursor;
+        int text_len = text_component_text_length(component);
+        const char* text = text_component_view(component, 0, text_len);
 
-        if (component->layer->text && strlen(component->layer->text) > 0) {
+        if (!text) {
+            return;
+        }
+        if (text_len > 0) {
             Texture* full_tex = backend_render_texture(component->layer->font->default_font,
-                                                      component->layer->text,
-                                                      component->layer->color);
+                                                      text, component->layer->color);
             if (full_tex) {
                 int full_width, full_height;
                 backend_query_texture(full_tex, NULL, NULL, &full_width, &full_height);
@@ -2147,12 +2248,15 @@ void text_component_update_scroll_for_cursor(TextComponent* component) {
             component->scroll_x = 0;
             return;
         }
+        if (component->cursor_pos > text_len) {
+            component->cursor_pos = text_len;
+        }
 
         before_cursor = (char*)malloc((size_t)component->cursor_pos + 1);
         if (!before_cursor) {
             return;
         }
-        strncpy(before_cursor, component->layer->text, (size_t)component->cursor_pos);
+        memcpy(before_cursor, text, (size_t)component->cursor_pos);
         before_cursor[component->cursor_pos] = '\0';
 
         cursor_x = render_rect.x;
@@ -2194,7 +2298,6 @@ int text_component_calculate_content_height(TextComponent* component) {
         return component->layer->rect.h;
     }
 
-    const char* text = component->layer->text ? component->layer->text : "";
     int line_height = text_component_get_line_height(component);
     Rect content_rect;
     text_component_get_content_rect(component, component->layer, &content_rect);
@@ -2202,10 +2305,11 @@ int text_component_calculate_content_height(TextComponent* component) {
     if (max_width < 1) max_width = 1;
 
     text_component_ensure_layout(component, max_width);
-    if (component->layout_count <= 0) {
+    // 未测量的段按估算行数计入
+    if (text_component_layout_count(component) <= 0) {
         return line_height + TEXT_LINE_SPACING;
     }
-    return component->layout_count * (line_height + TEXT_LINE_SPACING);
+    return text_component_layout_count(component) * (line_height + TEXT_LINE_SPACING);
 }
 
 
@@ -2243,7 +2347,7 @@ static void text_component_delete_prev_char(TextComponent* component) {
         return;
     }
     
-    int len = strlen(component->layer->text);
+    int len = text_component_text_length(component);
     
     // 确保不会越界
     if (component->cursor_pos > len) {
@@ -2252,35 +2356,20 @@ static void text_component_delete_prev_char(TextComponent* component) {
     
     if (component->cursor_pos > 0) {
         // 获取光标前一个 UTF-8 字符的字节长度
-        int char_len = get_prev_utf8_char_len(component->layer->text, component->cursor_pos);
+        int char_len = text_component_prev_char_len(component, component->cursor_pos);
         if (char_len <= 0) char_len = 1;
         int del_start = component->cursor_pos - char_len;
         int del_end = component->cursor_pos;
 
         text_component_begin_edit(component, TEXT_EDIT_DELETE);
         
-        // 计算新文本长度
-        size_t new_len = len - char_len;
-        
-        // 创建临时缓冲区存储新文本
-        char* new_text = malloc(new_len + 1);
-        if (!new_text) {
+        if (text_component_replace_range(component, del_start, del_end, NULL, 0) != 0) {
             return;
         }
-        
-        // 复制光标位置之前的部分（不包括要删除的字符）
-        memcpy(new_text, component->layer->text, component->cursor_pos - char_len);
-        // 复制光标位置之后的部分
-        memcpy(new_text + component->cursor_pos - char_len, component->layer->text + component->cursor_pos, len - component->cursor_pos + 1);
-        
-        // 设置新文本
-        layer_set_text(component->layer, new_text);
-        free(new_text);
 
         text_style_runs_delete(&component->style_runs, &component->style_run_count, del_start, del_end);
         
         component->cursor_pos -= char_len;
-        text_component_invalidate_layout(component);
         
         // 触发 onChange 事件
         text_component_trigger_on_change(component);
@@ -2318,7 +2407,7 @@ static void text_component_delete_next_char(TextComponent* component) {
         }
     }
     
-    int len = strlen(component->layer->text);
+    int len = text_component_text_length(component);
     
     // 确保cursor_pos在有效范围内
     if (component->cursor_pos < 0) component->cursor_pos = 0;
@@ -2328,27 +2417,14 @@ static void text_component_delete_next_char(TextComponent* component) {
 
     text_component_begin_edit(component, TEXT_EDIT_DELETE);
     
-    // 计算新文本长度
-    size_t new_len = len - 1;
-    
-    // 创建临时缓冲区存储新文本
-    char* new_text = malloc(new_len + 1);
-    if (!new_text) {
+    int char_len = text_component_next_char_len(component, component->cursor_pos);
+    if (text_component_replace_range(component, component->cursor_pos,
+                                     component->cursor_pos + char_len, NULL, 0) != 0) {
         return;
     }
-    
-    // 复制光标位置之前的部分
-    memcpy(new_text, component->layer->text, component->cursor_pos);
-    // 复制光标位置之后的部分（跳过要删除的字符）
-    memcpy(new_text + component->cursor_pos, component->layer->text + component->cursor_pos + 1, len - component->cursor_pos);
-    
-    // 设置新文本
-    layer_set_text(component->layer, new_text);
-    free(new_text);
 
     text_style_runs_delete(&component->style_runs, &component->style_run_count,
-                           component->cursor_pos, component->cursor_pos + 1);
-    text_component_invalidate_layout(component);
+                           component->cursor_pos, component->cursor_pos + char_len);
     
     // 更新内容高度
     text_component_update_content_height(component);
@@ -2398,7 +2474,7 @@ static void text_component_insert_text(TextComponent* component, const char* tex
     }
     const char* insert_text = normalized;
     
-    int current_len = strlen(component->layer->text);
+    int current_len = text_component_text_length(component);
     int has_selection = 0;
     int insert_at;
     
@@ -2421,7 +2497,7 @@ static void text_component_insert_text(TextComponent* component, const char* tex
         text_component_history_suppress_begin(component);
         text_component_delete_selection(component);
         text_component_history_suppress_end(component);
-        current_len = strlen(component->layer->text);
+        current_len = text_component_text_length(component);
     }
     
     // 确保cursor_pos在有效范围内
@@ -2454,28 +2530,10 @@ static void text_component_insert_text(TextComponent* component, const char* tex
         text_component_begin_edit(component, TEXT_EDIT_REPLACE);
     }
     
-    // 计算新文本长度
-    size_t new_len = current_len + text_len;
-    
-    // 创建临时缓冲区存储新文本
-    char* new_text = malloc(new_len + 1);
-    if (!new_text) {
+    if (text_component_replace_range(component, insert_at, insert_at, insert_text, text_len) != 0) {
         free(normalized);
         return;
     }
-    
-    // 复制光标位置之前的部分
-    memcpy(new_text, component->layer->text, component->cursor_pos);
-    // 插入新文本
-    memcpy(new_text + component->cursor_pos, insert_text, text_len);
-    // 复制光标位置之后的部分
-    memcpy(new_text + component->cursor_pos + text_len, 
-           component->layer->text + component->cursor_pos, 
-           current_len - component->cursor_pos + 1);
-    
-    // 设置新文本
-    layer_set_text(component->layer, new_text);
-    free(new_text);
     free(normalized);
 
     text_style_runs_insert(&component->style_runs, &component->style_run_count, insert_at, text_len);
@@ -2485,7 +2543,6 @@ static void text_component_insert_text(TextComponent* component, const char* tex
     }
     
     component->cursor_pos += text_len;
-    text_component_invalidate_layout(component);
     
     // 更新内容高度（只调用一次）
     text_component_update_content_height(component);
@@ -2543,7 +2600,7 @@ int text_component_handle_key_event(Layer* layer, KeyEvent* event) {
                 }
                 break;
             case SDLK_RIGHT:
-                if (component->cursor_pos < strlen(component->layer->text)) {
+                if (component->cursor_pos < text_component_text_length(component)) {
                     // 如果按住Shift键，需要先检查是否已有选择
                     if (event->data.key.mod & KMOD_SHIFT) {
                         // 如果没有选择，开始新选择
@@ -2570,27 +2627,13 @@ int text_component_handle_key_event(Layer* layer, KeyEvent* event) {
                     // 先保存当前光标位置作为选择起始点
                     int old_cursor_pos = component->cursor_pos;
                     
-                    // 简单的向上移动光标实现
-                    int pos = component->cursor_pos;
-                    while (pos > 0 && component->layer->text[pos] != '\n') {
-                        pos--;
-                    }
-                    if (pos > 0) {
-                        pos--;
-                        // 尽量保持在同一列
-                        int col = 0;
-                        int temp = component->cursor_pos;
-                        while (temp > 0 && component->layer->text[temp - 1] != '\n') {
-                            col++;
-                            temp--;
-                        }
-                        
-                        temp = pos;
-                        while (col > 0 && temp < strlen(component->layer->text) && component->layer->text[temp] != '\n') {
-                            temp++;
-                            col--;
-                        }
-                        component->cursor_pos = temp;
+                    // 按 buffer 行索引移到上一行同一列（字节），不物化全文
+                    int line_start = get_line_start(component, component->cursor_pos);
+                    if (line_start > 0) {
+                        int col = component->cursor_pos - line_start;
+                        int prev_start = get_line_start(component, line_start - 1);
+                        int prev_len = line_start - 1 - prev_start;
+                        component->cursor_pos = prev_start + (col < prev_len ? col : prev_len);
                     } else {
                         component->cursor_pos = 0;
                     }
@@ -2615,29 +2658,15 @@ int text_component_handle_key_event(Layer* layer, KeyEvent* event) {
                     // 先保存当前光标位置作为选择起始点
                     int old_cursor_pos = component->cursor_pos;
                     
-                    // 简单的向下移动光标实现
-                    int pos = component->cursor_pos;
-                    while (pos < strlen(component->layer->text) && component->layer->text[pos] != '\n') {
-                        pos++;
-                    }
-                    if (pos < strlen(component->layer->text)) {
-                        pos++;
-                        // 尽量保持在同一列
-                        int col = 0;
-                        int temp = component->cursor_pos;
-                        while (temp > 0 && component->layer->text[temp - 1] != '\n') {
-                            col++;
-                            temp--;
-                        }
-                        
-                        temp = pos;
-                        while (col > 0 && temp < strlen(component->layer->text) && component->layer->text[temp] != '\n') {
-                            temp++;
-                            col--;
-                        }
-                        component->cursor_pos = temp;
+                    // 按 buffer 行索引移到下一行同一列（字节），不物化全文
+                    int line_end = get_line_end(component, component->cursor_pos);
+                    if (line_end < text_component_text_length(component)) {
+                        int col = component->cursor_pos - get_line_start(component, component->cursor_pos);
+                        int next_start = line_end + 1;
+                        int next_len = get_line_end(component, next_start) - next_start;
+                        component->cursor_pos = next_start + (col < next_len ? col : next_len);
                     } else {
-                        component->cursor_pos = strlen(component->layer->text);
+                        component->cursor_pos = text_component_text_length(component);
                     }
                     
                     // 处理选择
@@ -2668,8 +2697,8 @@ int text_component_handle_key_event(Layer* layer, KeyEvent* event) {
                 // Ctrl+A 全选
                 if (event->data.key.mod & KMOD_CTRL) {
                     component->selection_start = 0;
-                    component->selection_end = strlen(component->layer->text);
-                    component->cursor_pos = strlen(component->layer->text);
+                    component->selection_end = text_component_text_length(component);
+                    component->cursor_pos = text_component_text_length(component);
                 } else if (event->type == KEY_EVENT_TEXT_INPUT) {
                     text_component_insert_char(component, 'a');
                 }
@@ -2690,7 +2719,7 @@ int text_component_handle_key_event(Layer* layer, KeyEvent* event) {
                         int len = end - start;
                         char* selected_text = (char*)malloc(len + 1);
                         if (selected_text) {
-                            strncpy(selected_text, component->layer->text + start, len);
+                            strncpy(selected_text, text_component_text(component) + start, len);
                             selected_text[len] = '\0';
                             printf("Copied: '%s'\n", selected_text);
                             // 复制到剪贴板
@@ -2731,7 +2760,7 @@ int text_component_handle_key_event(Layer* layer, KeyEvent* event) {
                         int len = end - start;
                         char* selected_text = (char*)malloc(len + 1);
                         if (selected_text) {
-                            strncpy(selected_text, component->layer->text + start, len);
+                            strncpy(selected_text, text_component_text(component) + start, len);
                             selected_text[len] = '\0';
                             printf("Cut: '%s'\n", selected_text);
                             // 复制到剪贴板
@@ -2896,8 +2925,7 @@ static void text_component_get_line_range_at_pos(TextComponent* component, Layer
                                                  int pos, int* out_start, int* out_end) {
     if (!component || !layer || !out_start || !out_end) return;
 
-    const char* text = layer->text ? layer->text : "";
-    int text_len = (int)strlen(text);
+    int text_len = text_component_text_length(component);
     if (pos < 0) pos = 0;
     if (pos > text_len) pos = text_len;
 
@@ -2911,23 +2939,12 @@ static void text_component_get_line_range_at_pos(TextComponent* component, Layer
     text_component_get_content_rect(component, layer, &render_rect);
     text_component_ensure_layout(component, render_rect.w);
 
-    for (int i = 0; i < component->layout_count; i++) {
-        int start = component->layout_starts[i];
-        int end = (i + 1 < component->layout_count)
-            ? component->layout_starts[i + 1] : text_len;
-        while (end > start && text[end - 1] == '\n') {
-            end--;
-        }
-
-        if (pos >= start && pos <= end) {
-            *out_start = start;
-            *out_end = end;
-            return;
-        }
+    {
+        // 软换行边界归到前一行（行尾）
+        int line = text_component_layout_line_of(component, pos, -1);
+        line = text_component_layout_line_of(component, pos, line - 1);
+        text_component_get_layout_line_range(component, line, out_start, out_end);
     }
-
-    *out_start = get_line_start(component, pos);
-    *out_end = get_line_end(component, pos);
 }
 
 static void text_component_focus(TextComponent* component) {
@@ -3057,7 +3074,7 @@ int text_component_handle_pointer_event(Layer* layer, PointerEvent* event) {
                 drag_pos = 0;
             } else if (pt.y > layer->rect.y + layer->rect.h) {
                 // 拖到下方，选择到文本末尾
-                drag_pos = strlen(component->layer->text);
+                drag_pos = text_component_text_length(component);
             } else {
                 // 默认情况，保持当前位置
                 drag_pos = component->cursor_pos;
@@ -3105,17 +3122,13 @@ int get_line_start(TextComponent* component, int pos) {
     }
     
     // 限制pos在文本范围内
-    if (pos > strlen(component->layer->text)) {
-        pos = strlen(component->layer->text);
+    if (pos > text_component_text_length(component)) {
+        pos = text_component_text_length(component);
     }
     
-    // 从pos向前查找换行符
-    int start = pos;
-    while (start > 0 && component->layer->text[start - 1] != '\n') {
-        start--;
-    }
-    
-    return start;
+    // 按 buffer 的换行计数定位，O(log n)
+    return text_buffer_line_start(&component->buffer,
+                                  text_buffer_line_of(&component->buffer, pos));
 }
 
 // 辅助函数：获取指定位置所在行的结束位置
@@ -3125,33 +3138,27 @@ int get_line_end(TextComponent* component, int pos) {
     }
     
     // 限制pos在文本范围内
-    if (pos > strlen(component->layer->text)) {
-        pos = strlen(component->layer->text);
+    if (pos > text_component_text_length(component)) {
+        pos = text_component_text_length(component);
     }
     
-    // 从pos向后查找换行符或文本末尾
-    int end = pos;
-    while (end < strlen(component->layer->text) && component->layer->text[end] != '\n') {
-        end++;
+    // 下一行起点减去换行符；最后一行到文本末尾
+    int line = text_buffer_line_of(&component->buffer, pos);
+    if (line + 1 >= text_buffer_line_count(&component->buffer)) {
+        return text_component_text_length(component);
     }
-    
-    return end;
+    return text_buffer_line_start(&component->buffer, line + 1) - 1;
 }
 
-static void text_component_get_layout_line_range(TextComponent* component, const char* text,
-                                                 int text_len, int line_index,
+static void text_component_get_layout_line_range(TextComponent* component, int line_index,
                                                  int* out_start, int* out_end) {
     int start = 0;
     int end = 0;
 
-    if (component && component->layout_count > 0 &&
-        line_index >= 0 && line_index < component->layout_count) {
-        start = component->layout_starts[line_index];
-        end = (line_index + 1 < component->layout_count)
-            ? component->layout_starts[line_index + 1] : text_len;
-        while (end > start && text[end - 1] == '\n') {
-            end--;
-        }
+    if (component && line_index >= 0 && line_index < text_component_layout_count(component)) {
+        // 所在段未测量时在这里按需折行
+        text_layout_line_range(&component->layout, &component->buffer, line_index,
+                               text_component_layout_wrap, component, &start, &end);
     }
 
     if (out_start) *out_start = start;
@@ -3197,34 +3204,39 @@ int text_component_get_position_from_point(TextComponent* component, Point pt, L
     
     // 边界检查
     if (pt.y < render_rect.y) return 0;
-    if (pt.y > render_rect.y + render_rect.h) return strlen(component->layer->text);
+    if (pt.y > render_rect.y + render_rect.h) return text_component_text_length(component);
     if (pt.x < render_rect.x) return 0;
     
     // 如果没有文本，返回0
-    if (strlen(component->layer->text) == 0) {
+    if (text_component_text_length(component) == 0) {
         return 0;
     }
     
     if (component->multiline) {
-        const char* text = component->layer->text;
-        int text_len = (int)strlen(text);
+        int text_len = text_component_text_length(component);
         int line_height = text_component_get_line_height(component);
         int line_stride = line_height + TEXT_LINE_SPACING;
         int target_line = (pt.y - render_rect.y + layer->scroll_offset) / line_stride;
         int start;
         int end;
+        const char* text;
 
         text_component_ensure_layout(component, render_rect.w);
         if (target_line < 0) target_line = 0;
-        if (target_line >= component->layout_count) return text_len;
+        if (target_line >= text_component_layout_count(component)) return text_len;
         component->cursor_visual_line = target_line;
-        text_component_get_layout_line_range(component, text, text_len, target_line, &start, &end);
-        return text_component_position_in_layout_line(component, text, start, end,
-                                                      pt.x - render_rect.x);
+        text_component_get_layout_line_range(component, target_line, &start, &end);
+        // 只拷贝命中的这一视觉行
+        text = text_component_view(component, start, end);
+        if (!text) return start;
+        return start + text_component_position_in_layout_line(component, text, 0, end - start,
+                                                              pt.x - render_rect.x);
     } else {
+        int text_len = text_component_text_length(component);
+        const char* text = text_component_view(component, 0, text_len);
         component->cursor_visual_line = -1;
-        return text_component_position_in_layout_line(component, component->layer->text,
-                                                      0, (int)strlen(component->layer->text),
+        if (!text) return 0;
+        return text_component_position_in_layout_line(component, text, 0, text_len,
                                                       pt.x - render_rect.x + component->scroll_x);
     }
 }
@@ -3239,7 +3251,11 @@ void text_component_render(Layer* layer) {
         load_all_fonts(layer);
     }
     if (layer->dirty_flags & DIRTY_TEXT) {
-        text_component_invalidate_layout(component);
+        // 编辑已增量更新布局；其他来源的文本变化整体重建
+        if (!component->layout_incremental) {
+            text_component_invalidate_layout(component);
+        }
+        component->layout_incremental = 0;
         layer->dirty_flags &= ~DIRTY_TEXT;
     }
     component->syntax_config.default_color = layer->color;
@@ -3274,98 +3290,34 @@ void text_component_render(Layer* layer) {
         // 获取行高
         int line_height = text_component_get_line_height(component);
         
-        // 遍历文本，使用与渲染相同的算法，为每个逻辑行渲染行号
-        char* text = component->layer->text;
-        int text_len = strlen(text);
-        int current_pos = 0;
-        int visual_line = 0;  // 视觉行号
-        int logical_line = 1;  // 逻辑行号（从1开始）
-        // 计算文本内容区域的宽度（与正文渲染区域一致）
+        // 行号只画可见段：段的首个视觉行由布局索引给出，不再逐行测量整篇文本
         Rect content_rect_for_wrap;
         text_component_get_content_rect(component, layer, &content_rect_for_wrap);
-        int max_width = content_rect_for_wrap.w;
-        
-        while (current_pos < text_len) {
-            // 记录当前逻辑行的起始视觉行
-            int logical_line_visual_start = visual_line;
-            
-            // 查找当前逻辑行的结束位置
-            int line_end = current_pos;
-            while (line_end < text_len) {
-                if (text[line_end] == '\n') {
-                    break;
-                }
-                line_end++;
+        text_component_ensure_layout(component, content_rect_for_wrap.w);
+        int line_stride = line_height + TEXT_LINE_SPACING;
+        int total_lines = text_component_layout_count(component);
+        int first_visible = layer->scroll_offset / line_stride;
+        int last_visible = (layer->scroll_offset + line_number_bg.h) / line_stride + 1;
+
+        // 先让可见行所在段完成测量，行号位置才与正文一致
+        for (int i = first_visible; i <= last_visible && i < total_lines; i++) {
+            int seg_start;
+            int seg_end;
+            text_component_get_layout_line_range(component, i, &seg_start, &seg_end);
+        }
+
+        for (int para = text_layout_para_of_line(&component->layout, first_visible);
+             para < component->layout.para_count; para++) {
+            int logical_line_visual_start = text_layout_para_first_line(&component->layout, para);
+            int logical_line = para + 1;
+            if (logical_line_visual_start > last_visible) {
+                break;
             }
-            
-            // 处理这个逻辑行的所有视觉行（包括自动换行产生的）
-            int logical_line_pos = current_pos;
-            if (logical_line_pos >= line_end) {
-                // 空行，也占一个视觉行
-                visual_line++;
-            } else {
-                while (logical_line_pos < line_end) {
-                    // 计算剩余文本的宽度
-                    int current_width = 0;
-                    char* temp_line = (char*)malloc(line_end - logical_line_pos + 1);
-                    if (temp_line) {
-                        strncpy(temp_line, text + logical_line_pos, line_end - logical_line_pos);
-                        temp_line[line_end - logical_line_pos] = '\0';
-                        
-                        Texture* line_tex = backend_render_texture(layer->font->default_font, temp_line, layer->color);
-                        if (line_tex) {
-                            int line_width, line_height_ignore;
-                            backend_query_texture(line_tex, NULL, NULL, &line_width, &line_height_ignore);
-                            current_width = line_width / yui_density;
-                            backend_render_text_destroy(line_tex);
-                        }
-                        
-                        free(temp_line);
-                    }
-                    
-                    // 确定当前视觉行的结束位置
-                    int split_pos = logical_line_pos;
-                    if (current_width <= max_width || !component->wrap) {
-                        split_pos = line_end;
-                    } else {
-                        split_pos = logical_line_pos;
-                        while (split_pos < line_end) {
-                            char* test_line = (char*)malloc(split_pos - logical_line_pos + 1);
-                            if (test_line) {
-                                strncpy(test_line, text + logical_line_pos, split_pos - logical_line_pos);
-                                test_line[split_pos - logical_line_pos] = '\0';
-                                
-                                Texture* test_tex = backend_render_texture(layer->font->default_font, test_line, layer->color);
-                                if (test_tex) {
-                                    int test_width, test_height;
-                                    backend_query_texture(test_tex, NULL, NULL, &test_width, &test_height);
-                                    if (test_width / yui_density > max_width) {
-                                        backend_render_text_destroy(test_tex);
-                                        free(test_line);
-                                        break;
-                                    }
-                                    backend_render_text_destroy(test_tex);
-                                }
-                                
-                                free(test_line);
-                            }
-                            split_pos++;
-                        } 
-                        
-                        if (split_pos > logical_line_pos) {
-                            split_pos--;
-                        }
-                    }
-                    
-                    if (split_pos < logical_line_pos) {
-                        split_pos = logical_line_pos;
-                    }
-                    
-                    logical_line_pos = split_pos;
-                    visual_line++;
-                }
+            // 末尾的空段（文本为空或以换行结尾）不显示行号
+            if (para == component->layout.para_count - 1 && component->layout.paras[para].len == 0) {
+                break;
             }
-            
+
             // 为这个逻辑行渲染行号（只在第一个视觉行的位置）
             int line_y = line_number_bg.y + logical_line_visual_start * (line_height + 2) - layer->scroll_offset;
             
@@ -3390,13 +3342,6 @@ void text_component_render(Layer* layer) {
                     backend_render_text_destroy(line_num_tex);
                 }
             }
-            
-            // 移动到下一个逻辑行
-            current_pos = line_end;
-            if (current_pos < text_len && text[current_pos] == '\n') {
-                current_pos++;
-            }
-            logical_line++;
         }
     }
     
@@ -3411,7 +3356,7 @@ void text_component_render(Layer* layer) {
     }
     
     // 如果文本为空且有占位符，显示占位符
-    if (strlen(component->layer->text) == 0 && strlen(component->placeholder) > 0) {
+    if (text_component_text_length(component) == 0 && strlen(component->placeholder) > 0) {
         // 使用透明度较低的颜色绘制占位符
         Color placeholder_color = {150, 150, 150, 128};
         Texture* tex = backend_render_texture(layer->font->default_font, component->placeholder, placeholder_color);
@@ -3458,241 +3403,108 @@ void text_component_render(Layer* layer) {
             }
             
             if (component->multiline) {
-                // 多行模式：需要考虑自动换行，使用与文本渲染完全相同的逻辑
-                char* text = component->layer->text;
-                int text_len = strlen(text);
-                int line_y = render_rect.y - layer->scroll_offset;
-                int current_pos = 0;
-                int max_width = render_rect.w;
-                
-                // 遍历文本，模拟渲染过程（与文本渲染使用相同的算法）
-                while (current_pos < text_len) {
-                    // 查找当前行可以显示的最大文本长度
-                    int line_end = current_pos;
-                    
-                    // 尝试找到合适的换行点（找到\n或文本末尾）
-                    while (line_end < text_len) {
-                        // 遇到换行符时立即换行
-                        if (text[line_end] == '\n') {
-                            break;
-                        }
-                        line_end++;
-                    }
-                    
-                    // 计算整行文本的宽度
-                    int current_width = 0;
-                    char* temp_line = (char*)malloc(line_end - current_pos + 1);
-                    if (temp_line) {
-                        strncpy(temp_line, text + current_pos, line_end - current_pos);
-                        temp_line[line_end - current_pos] = '\0';
-                        
-                        Texture* line_tex = backend_render_texture(layer->font->default_font, temp_line, layer->color);
-                        if (line_tex) {
-                            int line_width, line_height_ignore;
-                            backend_query_texture(line_tex, NULL, NULL, &line_width, &line_height_ignore);
-                            current_width = line_width / yui_density;
-                            backend_render_text_destroy(line_tex);
-                        }
-                        
-                        free(temp_line);
-                    }
-                    
-                    // 确定当前视觉行的结束位置
-                    int split_pos = current_pos;
-                    
-                    // 如果文本没有超过宽度限制，或关闭了自动换行
-                    if (current_width <= max_width || !component->wrap) {
-                        // 使用整行（到\n或文本末尾）
-                        split_pos = line_end;
-                    }
-                    // 如果文本超过宽度限制，需要硬换行
-                    else {
-                        // 找到最大的不超过宽度的位置
-                        split_pos = current_pos;
-                        while (split_pos < line_end) {
-                            char* test_line = (char*)malloc(split_pos - current_pos + 1);
-                            if (test_line) {
-                                strncpy(test_line, text + current_pos, split_pos - current_pos);
-                                test_line[split_pos - current_pos] = '\0';
-                                
-                                Texture* test_tex = backend_render_texture(layer->font->default_font, test_line, layer->color);
-                                if (test_tex) {
-                                    int test_width, test_height;
-                                    backend_query_texture(test_tex, NULL, NULL, &test_width, &test_height);
-                                    if (test_width / yui_density > max_width) {
-                                        backend_render_text_destroy(test_tex);
-                                        free(test_line);
-                                        break;
-                                    }
-                                    backend_render_text_destroy(test_tex);
-                                }
-                                
-                                free(test_line);
-                            }
-                            split_pos++;
-                        } 
-                        
-                        if (split_pos > current_pos) {
-                            split_pos--;
-                        }
-                    }
-                    
-                    // 确保split_pos >= current_pos，防止负长度
-                    if (split_pos < current_pos) {
-                        split_pos = current_pos;
+                // 多行模式：只遍历可见视觉行，行区间取自布局，文本只拷贝这一行
+                int line_stride = line_height + TEXT_LINE_SPACING;
+                int line_index;
+                int line_count;
+
+                text_component_ensure_layout(component, render_rect.w);
+                line_count = text_component_layout_count(component);
+                for (line_index = layer->scroll_offset / line_stride;
+                     line_index <= (layer->scroll_offset + render_rect.h) / line_stride &&
+                     line_index < line_count;
+                     line_index++) {
+                    int line_start;
+                    int line_end;
+                    int sel_start_in_line;
+                    int sel_end_in_line;
+                    const char* text;
+
+                    text_component_get_layout_line_range(component, line_index, &line_start, &line_end);
+                    if (line_start >= end) {
+                        break;
                     }
-                    
-                    // 处理这一视觉行的选择背景
-                    int visual_line_start = current_pos;
-                    int visual_line_end = split_pos;
-                    
-                    // 检查选择区域是否与当前视觉行相交
-                    if (start < visual_line_end && end > visual_line_start) {
-                        // 计算当前视觉行内的选择起始和结束位置
-                        int sel_start_in_line = (start > visual_line_start) ? start : visual_line_start;
-                        int sel_end_in_line = (end < visual_line_end) ? end : visual_line_end;
-                        
-                        // 计算选择起始位置的X坐标
-                        int sel_start_x = render_rect.x;
-                        if (sel_start_in_line > visual_line_start) {
-                            int before_len = sel_start_in_line - visual_line_start;
-                            char* before_sel = (char*)malloc(before_len + 1);
-                            if (before_sel) {
-                                strncpy(before_sel, text + visual_line_start, before_len);
-                                before_sel[before_len] = '\0';
-                                
-                                Texture* before_tex = backend_render_texture(layer->font->default_font, before_sel, layer->color);
-                                if (before_tex) {
-                                    int before_width, before_height;
-                                    backend_query_texture(before_tex, NULL, NULL, &before_width, &before_height);
-                                    sel_start_x = render_rect.x + before_width / yui_density;
-                                    backend_render_text_destroy(before_tex);
-                                }
-                                free(before_sel);
-                            }
-                        }
-                        
-                        // 计算选择区域的宽度
-                        int sel_width = 0;
-                        int sel_len = sel_end_in_line - sel_start_in_line;
-                        if (sel_len > 0) {
-                            char* sel_text = (char*)malloc(sel_len + 1);
-                            if (sel_text) {
-                                strncpy(sel_text, text + sel_start_in_line, sel_len);
-                                sel_text[sel_len] = '\0';
-                                
-                                Texture* sel_tex = backend_render_texture(layer->font->default_font, sel_text, layer->color);
-                                if (sel_tex) {
-                                    int sel_tex_width, sel_tex_height;
-                                    backend_query_texture(sel_tex, NULL, NULL, &sel_tex_width, &sel_tex_height);
-                                    sel_width = sel_tex_width / yui_density;
-                                    backend_render_text_destroy(sel_tex);
-                                }
-                                free(sel_text);
-                            }
-                        }
-                        
-                        // 绘制选择区域
-                        Rect sel_rect = {
-                            sel_start_x,
-                            line_y,
-                            sel_width,
-                            line_height
-                        };
-                        
-                        // 确保选择区域在可见范围内
-                        if (sel_rect.y + sel_rect.h > render_rect.y && sel_rect.y < render_rect.y + render_rect.h) {
-                            backend_render_fill_rect(&sel_rect, selection_bg);
-                        }
+                    if (start >= line_end || end <= line_start) {
+                        continue;
                     }
-                    
-                    // 移动到下一视觉行
-                    // 如果是在换行符处结束，直接跳到下一个字符
-                    if (split_pos < text_len && text[split_pos] == '\n') {
-                        current_pos = split_pos + 1;
-                    } else {
-                        current_pos = split_pos;
+                    sel_start_in_line = start > line_start ? start : line_start;
+                    sel_end_in_line = end < line_end ? end : line_end;
+                    text = text_component_view(component, line_start, line_end);
+                    if (!text) {
+                        break;
                     }
-                    
-                    // 移动到下一行
-                    line_y += line_height + 2; // 加2作为行间距
+
+                    Rect sel_rect = {
+                        render_rect.x + text_component_measure_width(
+                            component, text, 0, sel_start_in_line - line_start),
+                        render_rect.y + line_index * line_stride - layer->scroll_offset,
+                        text_component_measure_width(component, text, sel_start_in_line - line_start,
+                                                     sel_end_in_line - line_start),
+                        line_height
+                    };
+                    backend_render_fill_rect(&sel_rect, selection_bg);
                 }
             } else {
-                // 单行模式 - 使用实际渲染宽度
-                int sel_start_x = render_rect.x;
-                int sel_width = 0;
-                
-                // 计算选择起始位置的X坐标
-                if (start > 0) {
-                    char* before_sel = (char*)malloc(start + 1);
-                    if (before_sel) {
-                        strncpy(before_sel, component->layer->text, start);
-                        before_sel[start] = '\0';
-                        
-                        Texture* before_tex = backend_render_texture(layer->font->default_font, before_sel, layer->color);
-                        if (before_tex) {
-                            int before_width, before_height;
-                            backend_query_texture(before_tex, NULL, NULL, &before_width, &before_height);
-                            sel_start_x = render_rect.x + before_width / yui_density;
-                            backend_render_text_destroy(before_tex);
-                        }
-                        free(before_sel);
-                    }
-                }
-                
-                // 计算选择区域的宽度
-                int sel_len = end - start;
-                if (sel_len > 0) {
-                    char* sel_text = (char*)malloc(sel_len + 1);
-                    if (sel_text) {
-                        strncpy(sel_text, component->layer->text + start, sel_len);
-                        sel_text[sel_len] = '\0';
-                        
-                        Texture* sel_tex = backend_render_texture(layer->font->default_font, sel_text, layer->color);
-                        if (sel_tex) {
-                            int sel_tex_width, sel_tex_height;
-                            backend_query_texture(sel_tex, NULL, NULL, &sel_tex_width, &sel_tex_height);
-                            sel_width = sel_tex_width / yui_density;
-                            backend_render_text_destroy(sel_tex);
-                        }
-                        free(sel_text);
-                    }
+                // 单行模式：宽度与正文渲染同一套测量
+                const char* text = text_component_view(component, 0, end);
+                if (text) {
+                    Rect sel_rect = {
+                        render_rect.x + text_component_measure_width(component, text, 0, start) -
+                            component->scroll_x,
+                        render_rect.y + (render_rect.h - line_height) / 2,
+                        text_component_measure_width(component, text, start, end),
+                        line_height
+                    };
+                    backend_render_fill_rect(&sel_rect, selection_bg);
                 }
-                
-                Rect sel_rect = {
-                    sel_start_x,
-                    render_rect.y + (render_rect.h - line_height) / 2,
-                    sel_width,
-                    line_height
-                };
-                
-                backend_render_fill_rect(&sel_rect, selection_bg);
             }
         }
         
         // 绘制文本
         if (component->multiline) {
-            char* text = component->layer->text;
-            int text_len = (int)strlen(text);
+            int text_len = text_component_text_length(component);
             int line_height = text_component_get_line_height(component);
             int line_stride = line_height + TEXT_LINE_SPACING;
+            const char* text;
 
             text_component_ensure_layout(component, render_rect.w);
 
             int first_visible_line = layer->scroll_offset / line_stride;
             int max_visible_lines = render_rect.h / line_stride + 2;
             int last_visible_line = first_visible_line + max_visible_lines;
+            int line_count;
+
+            // 视口上下各多测量半屏，滚动时估算行数的修正不会落在可见区
+            {
+                int margin = max_visible_lines / 2;
+                int prefetch_end = last_visible_line + margin;
+                for (int line_index = first_visible_line - margin; line_index < prefetch_end; line_index++) {
+                    int start;
+                    int end;
+                    if (line_index < 0) continue;
+                    if (line_index >= text_component_layout_count(component)) break;
+                    text_component_get_layout_line_range(component, line_index, &start, &end);
+                }
+            }
 
-            for (int line_index = 0; line_index < component->layout_count; line_index++) {
-                if (line_index < first_visible_line) continue;
-                if (line_index >= last_visible_line) break;
+            // 可见行是连续的一段：一次从 piece table 拷出，逐行绘制时不再拷贝
+            line_count = text_component_layout_count(component);
+            if (first_visible_line < line_count) {
+                int block_start;
+                int block_end;
+                int unused;
+                int last = last_visible_line < line_count ? last_visible_line : line_count;
+                text_component_get_layout_line_range(component, first_visible_line, &block_start, &unused);
+                text_component_get_layout_line_range(component, last - 1, &unused, &block_end);
+                text_component_view(component, block_start, block_end);
+            }
 
-                int start = component->layout_starts[line_index];
-                int end = (line_index + 1 < component->layout_count)
-                    ? component->layout_starts[line_index + 1] : text_len;
-                while (end > start && text[end - 1] == '\n') {
-                    end--;
-                }
+            for (int line_index = first_visible_line;
+                 line_index < last_visible_line && line_index < line_count;
+                 line_index++) {
+                int start;
+                int end;
+                text_component_get_layout_line_range(component, line_index, &start, &end);
                 if (end <= start) continue;
 
                 int line_y = render_rect.y + line_index * line_stride - layer->scroll_offset;
@@ -3700,10 +3512,13 @@ void text_component_render(Layer* layer) {
                     continue;
                 }
 
+                text = text_component_view(component, start, end);
+                if (!text) break;
                 text_component_render_text_segment(component, text, start, end, render_rect.x, line_y);
             }
 
-            if (component->layout_count <= 0 && text_len > 0) {
+            if (line_count <= 0 && text_len > 0) {
+                text = text_component_view(component, 0, text_len);
                 text_component_render_text_segment(component, text, 0, text_len,
                                                    render_rect.x, render_rect.y - layer->scroll_offset);
             }
@@ -3718,17 +3533,17 @@ void text_component_render(Layer* layer) {
             }
         } else {
             int line_height = text_component_get_line_height(component);
-            int text_len = (int)strlen(component->layer->text);
+            int text_len = (int)text_component_text_length(component);
             int text_y = render_rect.y + (render_rect.h - line_height) / 2;
-            text_component_render_text_segment(component, component->layer->text, 0, text_len,
-                                               render_rect.x - component->scroll_x, text_y);
+            text_component_render_text_segment(component, text_component_view(component, 0, text_len),
+                                               0, text_len, render_rect.x - component->scroll_x, text_y);
         }
     }
     
     // 如果组件可编辑，绘制光标
     if (component->editable && HAS_STATE(layer, LAYER_STATE_FOCUSED)) {
         // 确保光标位置在有效范围内
-        int text_len = strlen(component->layer->text);
+        int text_len = text_component_text_length(component);
         if (component->cursor_pos < 0) component->cursor_pos = 0;
         if (component->cursor_pos > text_len) component->cursor_pos = text_len;
         
@@ -3736,7 +3551,7 @@ void text_component_render(Layer* layer) {
         int line_height = text_component_get_line_height(component);
         
         if (component->multiline) {
-            const char* text = component->layer->text;
+            const char* text;
             int cursor_line = 0;
             int line_start = 0;
             int line_end = 0;
@@ -3745,194 +3560,28 @@ void text_component_render(Layer* layer) {
             int line_stride = line_height + TEXT_LINE_SPACING;
 
             text_component_ensure_layout(component, render_rect.w);
-            for (int i = 0; i < component->layout_count; i++) {
-                int start;
-                int end;
-                text_component_get_layout_line_range(component, text, text_len, i, &start, &end);
-
-                if (component->cursor_pos < end ||
-                    (component->cursor_pos == end &&
-                     ((end < text_len && text[end] == '\n') ||
-                      component->cursor_visual_line == i)) ||
-                    i == component->layout_count - 1) {
-                    cursor_line = i;
-                    line_start = start;
-                    line_end = end;
-                    break;
-                }
-            }
+            cursor_line = text_component_layout_line_of(component, component->cursor_pos,
+                                                        component->cursor_visual_line);
+            text_component_get_layout_line_range(component, cursor_line, &line_start, &line_end);
 
             if (component->cursor_pos < line_start) component->cursor_pos = line_start;
             if (component->cursor_pos > line_end) component->cursor_pos = line_end;
-            cursor_x = render_rect.x + text_component_measure_width(
-                component, text, line_start, component->cursor_pos);
+            // 只拷贝光标所在的视觉行
+            text = text_component_view(component, line_start, component->cursor_pos);
+            cursor_x = render_rect.x + (text ? text_component_measure_width(
+                component, text, 0, component->cursor_pos - line_start) : 0);
             cursor_y = render_rect.y + cursor_line * line_stride - layer->scroll_offset;
 
             backend_render_fill_rect(&(Rect){cursor_x, cursor_y, 2, line_height},
                                      component->cursor_color);
-        } else if (component->multiline) {
-            // 旧的多行光标计算路径（保留以便后续移除）
-            char* text = component->layer->text;
-            int current_pos = 0;
-            int visual_line = 0;
-            int max_width = render_rect.w;
-            int cursor_x = render_rect.x;
-            int cursor_y = render_rect.y - layer->scroll_offset;
-            
-            // 遍历文本，使用与渲染相同的算法找到光标所在的视觉行
-            while (current_pos < text_len && current_pos < component->cursor_pos) {
-                // 查找当前行可以显示的最大文本长度
-                int line_end = current_pos;
-                
-                // 尝试找到合适的换行点
-                while (line_end < text_len) {
-                    if (text[line_end] == '\n') {
-                        break;
-                    }
-                    line_end++;
-                }
-                
-                // 计算整行文本的宽度
-                int current_width = 0;
-                char* temp_line = (char*)malloc(line_end - current_pos + 1);
-                if (temp_line) {
-                    strncpy(temp_line, text + current_pos, line_end - current_pos);
-                    temp_line[line_end - current_pos] = '\0';
-                    
-                    Texture* line_tex = backend_render_texture(layer->font->default_font, temp_line, layer->color);
-                    if (line_tex) {
-                        int line_width, line_height_ignore;
-                        backend_query_texture(line_tex, NULL, NULL, &line_width, &line_height_ignore);
-                        current_width = line_width / yui_density;
-                        backend_render_text_destroy(line_tex);
-                    }
-                    
-                    free(temp_line);
-                }
-                
-                // 确定当前视觉行的结束位置
-                int split_pos = current_pos;
-                
-                // 如果文本没有超过宽度限制，或关闭了自动换行
-                if (current_width <= max_width || !component->wrap) {
-                    // 使用整行（到\n或文本末尾）
-                    split_pos = line_end;
-                }
-                // 如果文本超过宽度限制，需要硬换行
-                else {
-                    split_pos = current_pos;
-                    while (split_pos < line_end) {
-                        char* test_line = (char*)malloc(split_pos - current_pos + 1);
-                        if (test_line) {
-                            strncpy(test_line, text + current_pos, split_pos - current_pos);
-                            test_line[split_pos - current_pos] = '\0';
-                            
-                            Texture* test_tex = backend_render_texture(layer->font->default_font, test_line, layer->color);
-                            if (test_tex) {
-                                int test_width, test_height;
-                                backend_query_texture(test_tex, NULL, NULL, &test_width, &test_height);
-                                if (test_width / yui_density > max_width) {
-                                    backend_render_text_destroy(test_tex);
-                                    free(test_line);
-                                    break;
-                                }
-                                backend_render_text_destroy(test_tex);
-                            }
-                            
-                            free(test_line);
-                        }
-                        split_pos++;
-                    } 
-                    
-                    if (split_pos > current_pos) {
-                        split_pos--;
-                    }
-                }
-                
-                if (split_pos < current_pos) {
-                    split_pos = current_pos;
-                }
-                
-                // 检查光标是否在当前视觉行内
-                if (component->cursor_pos <= split_pos) {
-                    // 光标在当前视觉行，计算X坐标
-                    int len_to_cursor = component->cursor_pos - current_pos;
-                    if (len_to_cursor > 0) {
-                        char* text_before_cursor = (char*)malloc(len_to_cursor + 1);
-                        if (text_before_cursor) {
-                            strncpy(text_before_cursor, text + current_pos, len_to_cursor);
-                            text_before_cursor[len_to_cursor] = '\0';
-                            
-                            Texture* before_tex = backend_render_texture(layer->font->default_font, text_before_cursor, layer->color);
-                            if (before_tex) {
-                                int before_width, before_height;
-                                backend_query_texture(before_tex, NULL, NULL, &before_width, &before_height);
-                                cursor_x = render_rect.x + before_width / yui_density;
-                                backend_render_text_destroy(before_tex);
-                            }
-                            free(text_before_cursor);
-                        }
-                    } else {
-                        cursor_x = render_rect.x;
-                    }
-                    
-                    cursor_y = render_rect.y + visual_line * (line_height + 2) - layer->scroll_offset;
-                    break;
-                }
-                
-                // 移动到下一视觉行
-                visual_line++;
-                if (split_pos < text_len && text[split_pos] == '\n') {
-                    current_pos = split_pos + 1;
-                } else {
-                    current_pos = split_pos;
-                }
-            }
-            
-            // 如果光标在文本末尾
-            if (current_pos >= component->cursor_pos && component->cursor_pos == text_len) {
-                // 计算文本最后一行
-                cursor_x = render_rect.x;
-                
-                // 获取最后一行文本（从当前pos到文本末尾）
-                int remaining_len = text_len - current_pos;
-                if (remaining_len > 0) {
-                    char* last_line = (char*)malloc(remaining_len + 1);
-                    if (last_line) {
-                        strncpy(last_line, text + current_pos, remaining_len);
-                        last_line[remaining_len] = '\0';
-                        
-                        // 计算最后一行文本的宽度
-                        Texture* last_tex = backend_render_texture(layer->font->default_font, last_line, layer->color);
-                        if (last_tex) {
-                            int last_width, last_height;
-                            backend_query_texture(last_tex, NULL, NULL, &last_width, &last_height);
-                            cursor_x = render_rect.x + last_width / yui_density;
-                            backend_render_text_destroy(last_tex);
-                        }
-                        free(last_line);
-                    }
-                }
-                
-                cursor_y = render_rect.y + visual_line * (line_height + 2) - layer->scroll_offset;
-            }
-            
-            // 绘制光标
-            Rect cursor_rect = {
-                cursor_x,
-                cursor_y,
-                2,
-                line_height
-            };
-            
-            backend_render_fill_rect(&cursor_rect, component->cursor_color);
         } else {
             // 单行模式：计算光标前文本的宽度，并应用滚动偏移
             int char_width = 0;
             if (component->cursor_pos > 0) {
-                char* temp_text = (char*)malloc(component->cursor_pos + 1);
+                const char* text = text_component_view(component, 0, component->cursor_pos);
+                char* temp_text = text ? (char*)malloc(component->cursor_pos + 1) : NULL;
                 if (temp_text) {
-                    strncpy(temp_text, component->layer->text, component->cursor_pos);
+                    memcpy(temp_text, text, (size_t)component->cursor_pos);
                     temp_text[component->cursor_pos] = '\0';
                     
                     Texture* cursor_text_texture = backend_render_texture(layer->font->default_font, temp_text, layer->color);
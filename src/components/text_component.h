@@ -5,6 +5,8 @@
 #include "text_syntax.h"
 #include "text_edit_history.h"
 #include "text_style_runs.h"
+#include "text_buffer.h"
+#include "text_layout.h"
 
 typedef struct Layer Layer;
 typedef struct KeyEvent KeyEvent;
@@ -12,7 +14,14 @@ typedef struct KeyEvent KeyEvent;
 // 多行文本组件结构体
 typedef struct {
     Layer* layer;          // 关联的图层
-    // 注意：文本内容现在存储在 layer->text 中，不再使用固定大小的数组
+    // 文本内容存放在 piece table 中，layer->text 只是按需物化的副本
+    TextBuffer buffer;
+    int text_stale;        // layer->text 落后于 buffer，读取前需物化
+    char* view;            // 渲染/测量用的一段文本副本（可见行或当前段），不物化全文
+    int view_start;        // view[0] 对应的文本偏移
+    int view_len;
+    int view_cap;
+    unsigned int view_version; // 对应的 buffer 版本，编辑后失效
     char placeholder[MAX_TEXT];  // 占位文本
     int cursor_pos;        // 光标位置
     int cursor_visual_line; // 光标所在视觉行，消除自动换行边界位置歧义
@@ -39,8 +48,8 @@ typedef struct {
     int line_height_valid;   // 行高缓存是否有效
     TextSyntaxConfig syntax_config; // 语法高亮配置
     int text_revision;       // 文本变更版本号
-    int* layout_starts;      // 视觉行起始偏移缓存
-    int layout_count;        // 视觉行数量
+    TextLayout layout;       // 按段缓存的视觉行布局（按需测量）
+    int layout_incremental;  // 本次 DIRTY_TEXT 已由编辑增量更新布局
     int layout_cache_revision; // 布局缓存对应的文本版本
     int layout_cache_max_width; // 布局缓存对应的最大宽度
     int layout_cache_text_len;  // 布局缓存对应的文本长度
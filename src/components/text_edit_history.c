@@ -3,64 +3,90 @@
 #include <stdlib.h>
 #include <string.h>
 
-static void text_edit_history_clear_stack(TextEditSnapshot*** stack, int* count)
+static size_t text_edit_state_bytes(const TextEditState* state)
+{
+    return state->runs ? (size_t)state->run_count * sizeof(TextStyleRun) : 0;
+}
+
+static void text_edit_state_release(TextEditState* state)
+{
+    text_style_runs_free(state->runs);
+    state->runs = NULL;
+    state->run_count = 0;
+}
+
+/* 保存状态：复制 runs，dst 原有内容先释放 */
+static void text_edit_state_store(TextEditState* dst, const TextEditState* src)
+{
+    text_edit_state_release(dst);
+    *dst = *src;
+    dst->runs = NULL;
+    dst->run_count = 0;
+    if (src->runs && src->run_count > 0) {
+        dst->runs = text_style_runs_clone(src->runs, src->run_count);
+        dst->run_count = dst->runs ? src->run_count : 0;
+    }
+}
+
+static void text_edit_step_free(TextEditStep* step)
 {
     int i;
-    if (!stack || !*stack || !count) {
+    if (!step) {
         return;
     }
-    for (i = 0; i < *count; i++) {
-        text_edit_snapshot_free((*stack)[i]);
-        (*stack)[i] = NULL;
+    for (i = 0; i < step->op_count; i++) {
+        free(step->ops[i].removed);
+        free(step->ops[i].inserted);
     }
-    *count = 0;
+    free(step->ops);
+    text_edit_state_release(&step->before);
+    text_edit_state_release(&step->after);
+    free(step);
 }
 
-void text_edit_snapshot_free(TextEditSnapshot* snap)
+static void text_edit_history_clear_stack(TextEditHistory* history, TextEditStep** stack, int* count)
 {
-    if (!snap) {
+    int i;
+    if (!stack || !count) {
         return;
     }
-    free(snap->text);
-    text_style_runs_free(snap->runs);
-    free(snap);
+    for (i = 0; i < *count; i++) {
+        history->bytes -= stack[i]->bytes;
+        if (stack[i] == history->open) {
+            history->open = NULL;
+        }
+        text_edit_step_free(stack[i]);
+        stack[i] = NULL;
+    }
+    *count = 0;
 }
 
-TextEditSnapshot* text_edit_snapshot_create(const char* text,
-                                            int cursor_pos,
-                                            int selection_start,
-                                            int selection_end,
-                                            const TextStyleRun* runs,
-                                            int run_count,
-                                            uint32_t typing_style)
+void text_edit_state_set(TextEditState* state,
+                         int cursor_pos,
+                         int selection_start,
+                         int selection_end,
+                         const TextStyleRun* runs,
+                         int run_count,
+                         uint32_t typing_style)
 {
-    TextEditSnapshot* snap = (TextEditSnapshot*)calloc(1, sizeof(TextEditSnapshot));
-    if (!snap) {
-        return NULL;
-    }
-    snap->text = text ? strdup(text) : strdup("");
-    if (!snap->text) {
-        free(snap);
-        return NULL;
-    }
-    snap->cursor_pos = cursor_pos;
-    snap->selection_start = selection_start;
-    snap->selection_end = selection_end;
-    snap->typing_style = typing_style;
-    if (runs && run_count > 0) {
-        snap->runs = text_style_runs_clone(runs, run_count);
-        snap->run_count = snap->runs ? run_count : 0;
+    if (!state) {
+        return;
     }
-    return snap;
+    state->cursor_pos = cursor_pos;
+    state->selection_start = selection_start;
+    state->selection_end = selection_end;
+    state->runs = (TextStyleRun*)runs;
+    state->run_count = runs ? run_count : 0;
+    state->typing_style = typing_style;
 }
 
-void text_edit_history_init(TextEditHistory* history, int max_depth)
+void text_edit_history_init(TextEditHistory* history, size_t max_bytes)
 {
     if (!history) {
         return;
     }
     memset(history, 0, sizeof(*history));
-    history->max_depth = max_depth > 0 ? max_depth : 80;
+    history->max_bytes = max_bytes > 0 ? max_bytes : TEXT_EDIT_HISTORY_DEFAULT_BYTES;
     history->coalesce_window_ms = 400;
 }
 
@@ -69,8 +95,10 @@ void text_edit_history_clear(TextEditHistory* history)
     if (!history) {
         return;
     }
-    text_edit_history_clear_stack(&history->undo, &history->undo_count);
-    text_edit_history_clear_stack(&history->redo, &history->redo_count);
+    text_edit_history_clear_stack(history, history->undo, &history->undo_count);
+    text_edit_history_clear_stack(history, history->redo, &history->redo_count);
+    history->bytes = 0;
+    history->open = NULL;
     history->coalescing = 0;
     history->coalesce_kind = 0;
     history->coalesce_ticks = 0;
@@ -90,58 +118,70 @@ void text_edit_history_free(TextEditHistory* history)
     history->redo_cap = 0;
 }
 
-static int text_edit_history_push(TextEditSnapshot*** stack, int* count, int* cap,
-                                  int max_depth, TextEditSnapshot* snap)
+static int text_edit_history_push(TextEditStep*** stack, int* count, int* cap, TextEditStep* step)
 {
-    TextEditSnapshot** items;
-    if (!stack || !count || !cap || !snap) {
-        text_edit_snapshot_free(snap);
-        return 0;
-    }
-    if (*count >= max_depth && max_depth > 0) {
-        text_edit_snapshot_free((*stack)[0]);
-        memmove(*stack, *stack + 1, (size_t)(*count - 1) * sizeof(TextEditSnapshot*));
-        (*count)--;
-    }
+    TextEditStep** items;
     if (*count >= *cap) {
         int new_cap = *cap ? (*cap * 2) : 16;
-        items = (TextEditSnapshot**)realloc(*stack, (size_t)new_cap * sizeof(TextEditSnapshot*));
+        items = (TextEditStep**)realloc(*stack, (size_t)new_cap * sizeof(TextEditStep*));
         if (!items) {
-            text_edit_snapshot_free(snap);
             return 0;
         }
         *stack = items;
         *cap = new_cap;
     }
-    (*stack)[(*count)++] = snap;
+    (*stack)[(*count)++] = step;
     return 1;
 }
 
-static TextEditSnapshot* text_edit_history_pop(TextEditSnapshot*** stack, int* count)
+static TextEditStep* text_edit_history_pop(TextEditStep** stack, int* count)
 {
-    TextEditSnapshot* snap;
-    if (!stack || !count || *count <= 0) {
+    TextEditStep* step;
+    if (!stack || *count <= 0) {
         return NULL;
     }
-    snap = (*stack)[--(*count)];
-    (*stack)[*count] = NULL;
-    return snap;
+    step = stack[--(*count)];
+    stack[*count] = NULL;
+    return step;
+}
+
+static void text_edit_history_drop_oldest(TextEditHistory* history, TextEditStep** stack, int* count)
+{
+    TextEditStep* step = stack[0];
+    history->bytes -= step->bytes;
+    if (step == history->open) {
+        history->open = NULL;
+    }
+    text_edit_step_free(step);
+    memmove(stack, stack + 1, (size_t)(*count - 1) * sizeof(TextEditStep*));
+    (*count)--;
+}
+
+/* 超出字节上限时丢弃最旧的步骤；最新一步总是保留，即便它本身超限 */
+static void text_edit_history_trim(TextEditHistory* history)
+{
+    while (history->bytes > history->max_bytes && history->redo_count > 0) {
+        text_edit_history_drop_oldest(history, history->redo, &history->redo_count);
+    }
+    while (history->bytes > history->max_bytes && history->undo_count > 1) {
+        text_edit_history_drop_oldest(history, history->undo, &history->undo_count);
+    }
 }
 
 void text_edit_history_before_edit(TextEditHistory* history,
-                                   TextEditSnapshot* current,
+                                   const TextEditState* current,
                                    TextEditKind kind,
                                    unsigned int now_ms)
 {
+    TextEditStep* step;
     int can_coalesce;
 
     if (!history || !current) {
-        text_edit_snapshot_free(current);
         return;
     }
 
     can_coalesce = 0;
-    if (history->coalescing &&
+    if (history->coalescing && history->open &&
         (kind == TEXT_EDIT_TYPING || kind == TEXT_EDIT_DELETE) &&
         kind == history->coalesce_kind &&
         now_ms >= history->coalesce_ticks &&
@@ -151,22 +191,156 @@ void text_edit_history_before_edit(TextEditHistory* history,
 
     if (can_coalesce) {
         history->coalesce_ticks = now_ms;
-        text_edit_snapshot_free(current);
         return;
     }
 
-    text_edit_history_clear_stack(&history->redo, &history->redo_count);
-    text_edit_history_push(&history->undo, &history->undo_count, &history->undo_cap,
-                           history->max_depth, current);
+    text_edit_history_clear_stack(history, history->redo, &history->redo_count);
+    history->open = NULL;
+    history->coalescing = 0;
+    history->coalesce_kind = 0;
+
+    step = (TextEditStep*)calloc(1, sizeof(TextEditStep));
+    if (!step) {
+        return;
+    }
+    text_edit_state_store(&step->before, current);
+    step->bytes = sizeof(TextEditStep) + text_edit_state_bytes(&step->before);
+    if (!text_edit_history_push(&history->undo, &history->undo_count, &history->undo_cap, step)) {
+        text_edit_step_free(step);
+        return;
+    }
+    history->bytes += step->bytes;
+    history->open = step;
+    text_edit_history_trim(history);
 
     if (kind == TEXT_EDIT_TYPING || kind == TEXT_EDIT_DELETE) {
         history->coalescing = 1;
         history->coalesce_kind = kind;
         history->coalesce_ticks = now_ms;
+    }
+}
+
+/* 把 src 拼到 *str 的前面或后面 */
+static int text_edit_op_splice(char** str, int* len, const char* src, int src_len, int prepend)
+{
+    char* grown;
+    if (src_len <= 0) {
+        return 0;
+    }
+    grown = (char*)realloc(*str, (size_t)(*len + src_len));
+    if (!grown) {
+        return -1;
+    }
+    if (prepend) {
+        memmove(grown + src_len, grown, (size_t)*len);
+        memcpy(grown, src, (size_t)src_len);
     } else {
-        history->coalescing = 0;
-        history->coalesce_kind = 0;
+        memcpy(grown + *len, src, (size_t)src_len);
     }
+    *str = grown;
+    *len += src_len;
+    return 0;
+}
+
+/* 与上一个操作相邻时就地合并：连续输入、连续退格、连续向前删除 */
+static int text_edit_op_merge(TextEditOp* last, int pos,
+                              const char* removed, int removed_len,
+                              const char* inserted, int inserted_len)
+{
+    if (removed_len == 0 && pos == last->pos + last->inserted_len) {
+        return text_edit_op_splice(&last->inserted, &last->inserted_len, inserted, inserted_len, 0) == 0 ? 1 : -1;
+    }
+    if (inserted_len == 0 && last->inserted_len == 0) {
+        if (pos + removed_len == last->pos) {
+            if (text_edit_op_splice(&last->removed, &last->removed_len, removed, removed_len, 1) != 0) {
+                return -1;
+            }
+            last->pos = pos;
+            return 1;
+        }
+        if (pos == last->pos) {
+            return text_edit_op_splice(&last->removed, &last->removed_len, removed, removed_len, 0) == 0 ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+static char* text_edit_dup(const char* src, int len)
+{
+    char* out;
+    if (len <= 0) {
+        return NULL;
+    }
+    out = (char*)malloc((size_t)len);
+    if (out) {
+        memcpy(out, src, (size_t)len);
+    }
+    return out;
+}
+
+int text_edit_history_record(TextEditHistory* history, int pos,
+                             const char* removed, int removed_len,
+                             const char* inserted, int inserted_len)
+{
+    TextEditStep* step;
+    TextEditOp* op;
+    size_t before;
+    int merged = 0;
+
+    if (!history || !history->open) {
+        return 0;
+    }
+    if (removed_len < 0) removed_len = 0;
+    if (inserted_len < 0) inserted_len = 0;
+    if (removed_len == 0 && inserted_len == 0) {
+        return 0;
+    }
+
+    step = history->open;
+    before = step->bytes;
+    if (step->op_count > 0) {
+        merged = text_edit_op_merge(&step->ops[step->op_count - 1], pos,
+                                    removed, removed_len, inserted, inserted_len);
+    }
+    if (merged == 0) {
+        if (step->op_count >= step->op_cap) {
+            int new_cap = step->op_cap ? step->op_cap * 2 : 4;
+            TextEditOp* ops = (TextEditOp*)realloc(step->ops, (size_t)new_cap * sizeof(TextEditOp));
+            if (!ops) {
+                merged = -1;
+            } else {
+                step->bytes += (size_t)(new_cap - step->op_cap) * sizeof(TextEditOp);
+                step->ops = ops;
+                step->op_cap = new_cap;
+            }
+        }
+        if (merged == 0) {
+            op = &step->ops[step->op_count];
+            memset(op, 0, sizeof(*op));
+            op->pos = pos;
+            op->removed = text_edit_dup(removed, removed_len);
+            op->inserted = text_edit_dup(inserted, inserted_len);
+            if ((removed_len > 0 && !op->removed) || (inserted_len > 0 && !op->inserted)) {
+                free(op->removed);
+                free(op->inserted);
+                merged = -1;
+            } else {
+                op->removed_len = removed_len;
+                op->inserted_len = inserted_len;
+                step->op_count++;
+            }
+        }
+    }
+    if (merged < 0) {
+        // 丢了一个操作就无法正确回放，整段历史作废
+        text_edit_history_clear(history);
+        return -1;
+    }
+
+    step->bytes += (size_t)removed_len + (size_t)inserted_len;
+    history->bytes += step->bytes - before;
+    text_edit_history_trim(history);
+    return 0;
 }
 
 int text_edit_history_can_undo(const TextEditHistory* history)
@@ -179,34 +353,46 @@ int text_edit_history_can_redo(const TextEditHistory* history)
     return history && history->redo_count > 0;
 }
 
-TextEditSnapshot* text_edit_history_undo(TextEditHistory* history, TextEditSnapshot* current)
+size_t text_edit_history_bytes(const TextEditHistory* history)
+{
+    return history ? history->bytes : 0;
+}
+
+const TextEditStep* text_edit_history_undo(TextEditHistory* history, const TextEditState* current)
 {
-    TextEditSnapshot* prev;
+    TextEditStep* step;
+    size_t before;
     if (!history || !text_edit_history_can_undo(history)) {
-        text_edit_snapshot_free(current);
         return NULL;
     }
     history->coalescing = 0;
+    history->open = NULL;
+    if (!text_edit_history_push(&history->redo, &history->redo_count, &history->redo_cap, NULL)) {
+        return NULL;
+    }
+    step = text_edit_history_pop(history->undo, &history->undo_count);
+    history->redo[history->redo_count - 1] = step;
     if (current) {
-        text_edit_history_push(&history->redo, &history->redo_count, &history->redo_cap,
-                               history->max_depth, current);
+        before = text_edit_state_bytes(&step->after);
+        text_edit_state_store(&step->after, current);
+        step->bytes = step->bytes - before + text_edit_state_bytes(&step->after);
+        history->bytes = history->bytes - before + text_edit_state_bytes(&step->after);
     }
-    prev = text_edit_history_pop(&history->undo, &history->undo_count);
-    return prev;
+    return step;
 }
 
-TextEditSnapshot* text_edit_history_redo(TextEditHistory* history, TextEditSnapshot* current)
+const TextEditStep* text_edit_history_redo(TextEditHistory* history)
 {
-    TextEditSnapshot* next;
+    TextEditStep* step;
     if (!history || !text_edit_history_can_redo(history)) {
-        text_edit_snapshot_free(current);
         return NULL;
     }
     history->coalescing = 0;
-    if (current) {
-        text_edit_history_push(&history->undo, &history->undo_count, &history->undo_cap,
-                               history->max_depth, current);
+    history->open = NULL;
+    if (!text_edit_history_push(&history->undo, &history->undo_count, &history->undo_cap, NULL)) {
+        return NULL;
     }
-    next = text_edit_history_pop(&history->redo, &history->redo_count);
-    return next;
+    step = text_edit_history_pop(history->redo, &history->redo_count);
+    history->undo[history->undo_count - 1] = step;
+    return step;
 }
@@ -1,12 +1,17 @@
 #ifndef YUI_TEXT_EDIT_HISTORY_H
 #define YUI_TEXT_EDIT_HISTORY_H
 
+#include <stddef.h>
+
 #include "text_style_runs.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Default undo/redo memory budget in bytes. */
+#define TEXT_EDIT_HISTORY_DEFAULT_BYTES (4 * 1024 * 1024)
+
 typedef enum {
     TEXT_EDIT_TYPING = 1,
     TEXT_EDIT_DELETE = 2,
@@ -14,55 +19,89 @@ typedef enum {
     TEXT_EDIT_STYLE = 4
 } TextEditKind;
 
-typedef struct TextEditSnapshot {
-    char* text;
+/* Caret/selection/style state around a step (no text). */
+typedef struct TextEditState {
     int cursor_pos;
     int selection_start;
     int selection_end;
     TextStyleRun* runs;
     int run_count;
     uint32_t typing_style;
-} TextEditSnapshot;
+} TextEditState;
+
+/* One replacement: at pos, `removed` was replaced by `inserted`. */
+typedef struct TextEditOp {
+    int pos;
+    char* removed;
+    int removed_len;
+    char* inserted;
+    int inserted_len;
+} TextEditOp;
+
+/* One undo entry: ops in application order plus state before/after. */
+typedef struct TextEditStep {
+    TextEditOp* ops;
+    int op_count;
+    int op_cap;
+    TextEditState before;
+    TextEditState after;
+    size_t bytes;
+} TextEditStep;
 
 typedef struct TextEditHistory {
-    TextEditSnapshot** undo;
+    TextEditStep** undo;
     int undo_count;
     int undo_cap;
-    TextEditSnapshot** redo;
+    TextEditStep** redo;
     int redo_count;
     int redo_cap;
-    int max_depth;
+    size_t max_bytes;
+    size_t bytes;
+    TextEditStep* open; /* step receiving recorded ops, NULL when none */
     int coalescing;
     int coalesce_kind;
     unsigned int coalesce_ticks;
     unsigned int coalesce_window_ms;
 } TextEditHistory;
 
-void text_edit_history_init(TextEditHistory* history, int max_depth);
+void text_edit_history_init(TextEditHistory* history, size_t max_bytes);
 void text_edit_history_clear(TextEditHistory* history);
 void text_edit_history_free(TextEditHistory* history);
 
-TextEditSnapshot* text_edit_snapshot_create(const char* text,
-                                            int cursor_pos,
-                                            int selection_start,
-                                            int selection_end,
-                                            const TextStyleRun* runs,
-                                            int run_count,
-                                            uint32_t typing_style);
-void text_edit_snapshot_free(TextEditSnapshot* snap);
+/* Fill state; runs are borrowed (cloned by the history when stored). */
+void text_edit_state_set(TextEditState* state,
+                         int cursor_pos,
+                         int selection_start,
+                         int selection_end,
+                         const TextStyleRun* runs,
+                         int run_count,
+                         uint32_t typing_style);
 
-/* Capture current state before a mutating edit. Coalesces TYPING/DELETE. */
+/* Open a step before a mutating edit, or extend the open one (coalesces TYPING/DELETE). */
 void text_edit_history_before_edit(TextEditHistory* history,
-                                   TextEditSnapshot* current,
+                                   const TextEditState* current,
                                    TextEditKind kind,
                                    unsigned int now_ms);
 
+/* Record a replacement into the open step. Returns 0, or -1 on failure
+   (history is cleared since it can no longer be replayed). */
+int text_edit_history_record(TextEditHistory* history, int pos,
+                             const char* removed, int removed_len,
+                             const char* inserted, int inserted_len);
+
 int text_edit_history_can_undo(const TextEditHistory* history);
 int text_edit_history_can_redo(const TextEditHistory* history);
 
-/* Pops undo and returns snapshot to apply; caller must free. Pushes `current` to redo. */
-TextEditSnapshot* text_edit_history_undo(TextEditHistory* history, TextEditSnapshot* current);
-TextEditSnapshot* text_edit_history_redo(TextEditHistory* history, TextEditSnapshot* current);
+/* Bytes held by undo + redo steps. */
+size_t text_edit_history_bytes(const TextEditHistory* history);
+
+/* Move the newest step to redo and return it (owned by the history).
+   The caller reverts ops from last to first and restores step->before.
+   `current` becomes step->after. */
+const TextEditStep* text_edit_history_undo(TextEditHistory* history, const TextEditState* current);
+
+/* Move the newest redo step back to undo; caller replays ops in order and restores step->after. */
+const TextEditStep* text_edit_history_redo(TextEditHistory* history);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,472 @@
+#include "text_layout.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void text_layout_para_clear(TextLayoutPara* para)
+{
+    free(para->breaks);
+    para->breaks = NULL;
+    para->visual_count = 0;
+    para->dirty = 0;
+}
+
+/* 未测量的段按字节数估算视觉行数 */
+static int text_layout_para_lines(const TextLayout* layout, const TextLayoutPara* para)
+{
+    int bpl;
+    if (para->visual_count > 0) {
+        return para->visual_count;
+    }
+    if (!layout->wrap || para->len <= 0) {
+        return 1;
+    }
+    bpl = layout->est_bytes_per_line > 0 ? layout->est_bytes_per_line : 1;
+    return (para->len + bpl - 1) / bpl;
+}
+
+static void text_layout_tree_build(TextLayout* layout)
+{
+    int n = layout->para_count;
+    int i;
+    layout->total = 0;
+    for (i = 1; i <= n; i++) {
+        layout->tree[i] = text_layout_para_lines(layout, &layout->paras[i - 1]);
+        layout->total += layout->tree[i];
+    }
+    for (i = 1; i <= n; i++) {
+        int j = i + (i & -i);
+        if (j <= n) {
+            layout->tree[j] += layout->tree[i];
+        }
+    }
+    layout->tree_valid = 1;
+}
+
+static void text_layout_tree_ensure(TextLayout* layout)
+{
+    if (!layout->tree_valid) {
+        text_layout_tree_build(layout);
+    }
+}
+
+static void text_layout_tree_add(TextLayout* layout, int para, int delta)
+{
+    int i;
+    if (!layout->tree_valid || delta == 0) {
+        return;
+    }
+    for (i = para + 1; i <= layout->para_count; i += i & -i) {
+        layout->tree[i] += delta;
+    }
+    layout->total += delta;
+}
+
+static int text_layout_reserve(TextLayout* layout, int count)
+{
+    TextLayoutPara* paras;
+    int* tree;
+    int cap;
+    if (count <= layout->para_cap) {
+        return 0;
+    }
+    cap = layout->para_cap ? layout->para_cap : 64;
+    while (cap < count) {
+        cap *= 2;
+    }
+    paras = (TextLayoutPara*)realloc(layout->paras, (size_t)cap * sizeof(TextLayoutPara));
+    if (!paras) {
+        return -1;
+    }
+    layout->paras = paras;
+    tree = (int*)realloc(layout->tree, (size_t)(cap + 1) * sizeof(int));
+    if (!tree) {
+        return -1;
+    }
+    layout->tree = tree;
+    layout->para_cap = cap;
+    return 0;
+}
+
+void text_layout_init(TextLayout* layout)
+{
+    if (!layout) {
+        return;
+    }
+    memset(layout, 0, sizeof(*layout));
+}
+
+void text_layout_free(TextLayout* layout)
+{
+    int i;
+    if (!layout) {
+        return;
+    }
+    for (i = 0; i < layout->para_count; i++) {
+        free(layout->paras[i].breaks);
+    }
+    free(layout->paras);
+    free(layout->tree);
+    memset(layout, 0, sizeof(*layout));
+}
+
+int text_layout_reset(TextLayout* layout, const TextBuffer* buffer,
+                      int max_width, int wrap, int est_bytes_per_line)
+{
+    int count;
+    int total;
+    int i;
+
+    if (!layout) {
+        return -1;
+    }
+    for (i = 0; i < layout->para_count; i++) {
+        free(layout->paras[i].breaks);
+    }
+    layout->para_count = 0;
+    layout->tree_valid = 0;
+    layout->total = 0;
+    layout->max_width = max_width;
+    layout->wrap = wrap;
+    layout->est_bytes_per_line = est_bytes_per_line > 0 ? est_bytes_per_line : 1;
+    layout->measured = 0;
+
+    /* Paragraphs come from the buffer's line index; no text is copied. */
+    count = text_buffer_line_count(buffer);
+    total = text_buffer_length(buffer);
+    if (text_layout_reserve(layout, count) != 0) {
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        TextLayoutPara* para = &layout->paras[i];
+        int start = text_buffer_line_start(buffer, i);
+        int end = i + 1 < count ? text_buffer_line_start(buffer, i + 1) - 1 : total;
+        memset(para, 0, sizeof(*para));
+        para->len = end - start;
+    }
+    layout->para_count = count;
+    return 0;
+}
+
+static int text_layout_para_len(const TextBuffer* buffer, int para)
+{
+    int start = text_buffer_line_start(buffer, para);
+    if (para + 1 < text_buffer_line_count(buffer)) {
+        return text_buffer_line_start(buffer, para + 1) - 1 - start;
+    }
+    return text_buffer_length(buffer) - start;
+}
+
+int text_layout_replace(TextLayout* layout, const TextBuffer* buffer, int pos,
+                        int removed_len, int removed_lines, int inserted_len)
+{
+    int first;
+    int inserted_lines;
+    int i;
+
+    if (!layout || !buffer || layout->para_count <= 0) {
+        return -1;
+    }
+    first = text_buffer_line_of(buffer, pos);
+    inserted_lines = text_buffer_line_of(buffer, pos + inserted_len) - first;
+    if (first + removed_lines >= layout->para_count) {
+        return -1;
+    }
+
+    if (removed_lines == 0 && inserted_lines == 0) {
+        /* 常见路径：段内编辑，保留旧折行等测量时重新对齐 */
+        TextLayoutPara* para = &layout->paras[first];
+        int rel = pos - text_buffer_line_start(buffer, first);
+        int delta = inserted_len - removed_len;
+        int old_lines = text_layout_para_lines(layout, para);
+        para->len += delta;
+        if (para->visual_count == 0) {
+            text_layout_tree_add(layout, first, text_layout_para_lines(layout, para) - old_lines);
+        } else {
+            if (!para->dirty) {
+                para->dirty = 1;
+                para->dirty_pos = rel;
+                para->dirty_old_end = rel + removed_len;
+                para->dirty_delta = delta;
+            } else {
+                /* 与上一次未测量的编辑合并，坐标换回旧文本 */
+                int cur_end = para->dirty_old_end + para->dirty_delta;
+                int old_end = rel + removed_len >= cur_end
+                    ? rel + removed_len - para->dirty_delta : para->dirty_old_end;
+                if (rel < para->dirty_pos) para->dirty_pos = rel;
+                if (old_end > para->dirty_old_end) para->dirty_old_end = old_end;
+                para->dirty_delta += delta;
+            }
+        }
+        return 0;
+    }
+
+    /* 换行数变化：受影响的段重建为未测量，后续段保持不变只整体平移 */
+    if (inserted_lines > removed_lines &&
+        text_layout_reserve(layout, layout->para_count + inserted_lines - removed_lines) != 0) {
+        return -1;
+    }
+    for (i = first; i <= first + removed_lines; i++) {
+        free(layout->paras[i].breaks);
+    }
+    if (inserted_lines != removed_lines) {
+        memmove(&layout->paras[first + inserted_lines + 1],
+                &layout->paras[first + removed_lines + 1],
+                (size_t)(layout->para_count - first - removed_lines - 1) * sizeof(TextLayoutPara));
+        layout->para_count += inserted_lines - removed_lines;
+    }
+    for (i = first; i <= first + inserted_lines; i++) {
+        TextLayoutPara* para = &layout->paras[i];
+        memset(para, 0, sizeof(*para));
+        para->len = text_layout_para_len(buffer, i);
+    }
+    layout->tree_valid = 0;
+    return 0;
+}
+
+void text_layout_invalidate_paras(TextLayout* layout, int first, int last)
+{
+    int i;
+    if (!layout) {
+        return;
+    }
+    if (first < 0) first = 0;
+    if (last >= layout->para_count) last = layout->para_count - 1;
+    for (i = first; i <= last; i++) {
+        text_layout_para_clear(&layout->paras[i]);
+    }
+    layout->tree_valid = 0;
+}
+
+int text_layout_line_count(TextLayout* layout)
+{
+    if (!layout || layout->para_count <= 0) {
+        return 0;
+    }
+    text_layout_tree_ensure(layout);
+    return layout->total;
+}
+
+int text_layout_para_first_line(TextLayout* layout, int para)
+{
+    int sum = 0;
+    int i;
+    if (!layout || para <= 0) {
+        return 0;
+    }
+    if (para > layout->para_count) para = layout->para_count;
+    text_layout_tree_ensure(layout);
+    for (i = para; i > 0; i -= i & -i) {
+        sum += layout->tree[i];
+    }
+    return sum;
+}
+
+int text_layout_para_of_line(TextLayout* layout, int index)
+{
+    int pos = 0;
+    int step = 1;
+    if (!layout || layout->para_count <= 0 || index <= 0) {
+        return 0;
+    }
+    text_layout_tree_ensure(layout);
+    while (step * 2 <= layout->para_count) {
+        step *= 2;
+    }
+    for (; step > 0; step >>= 1) {
+        if (pos + step <= layout->para_count && layout->tree[pos + step] <= index) {
+            pos += step;
+            index -= layout->tree[pos];
+        }
+    }
+    return pos < layout->para_count ? pos : layout->para_count - 1;
+}
+
+static int text_layout_push_break(int** breaks, int* count, int* cap, int value)
+{
+    if (*count >= *cap) {
+        int new_cap = *cap ? *cap * 2 : 8;
+        int* grown = (int*)realloc(*breaks, (size_t)new_cap * sizeof(int));
+        if (!grown) {
+            return -1;
+        }
+        *breaks = grown;
+        *cap = new_cap;
+    }
+    (*breaks)[(*count)++] = value;
+    return 0;
+}
+
+int text_layout_measure_para(TextLayout* layout, const TextBuffer* buffer, int para,
+                             TextLayoutWrapFn wrap_fn, void* user)
+{
+    TextLayoutPara* p;
+    int* breaks = NULL;
+    int count = 0;
+    int cap = 0;
+    int start;
+    int end;
+    int rel;
+    int old_lines;
+    int old_i = 0;
+    int old_n = 0;
+
+    if (!layout || para < 0 || para >= layout->para_count) {
+        return -1;
+    }
+    p = &layout->paras[para];
+    if (p->visual_count > 0 && !p->dirty) {
+        return 0;
+    }
+    old_lines = text_layout_para_lines(layout, p);
+    if (!layout->wrap || p->len <= 0 || !wrap_fn) {
+        text_layout_para_clear(p);
+        p->visual_count = 1;
+        text_layout_tree_add(layout, para, 1 - old_lines);
+        return 0;
+    }
+
+    start = text_buffer_line_start(buffer, para);
+    end = start + p->len;
+    rel = 0;
+
+    if (p->dirty) {
+        /* 编辑点之前的折行不变；从编辑点前一视觉行起重排（贪心换行会看后一个字符） */
+        old_n = p->visual_count - 1;
+        while (old_i < old_n && p->breaks[old_i] < p->dirty_pos) {
+            old_i++;
+        }
+        if (old_i > 0) {
+            old_i--;
+        }
+        if (old_i > 0) {
+            breaks = (int*)malloc((size_t)old_i * sizeof(int));
+            if (!breaks) {
+                return -1;
+            }
+            memcpy(breaks, p->breaks, (size_t)old_i * sizeof(int));
+            count = old_i;
+            cap = old_i;
+        }
+        rel = old_i > 0 ? p->breaks[old_i - 1] : 0;
+    }
+
+    while (start + rel < end) {
+        int next = wrap_fn(user, start + rel, end, layout->max_width) - start;
+        if (next <= rel) {
+            next = rel + 1;
+        }
+        if (next >= p->len) {
+            break;
+        }
+        if (text_layout_push_break(&breaks, &count, &cap, next) != 0) {
+            free(breaks);
+            return -1;
+        }
+        rel = next;
+
+        if (p->dirty && rel >= p->dirty_old_end + p->dirty_delta) {
+            /* 新折行与平移后的旧折行重合，后面的折行全部沿用 */
+            while (old_i < old_n &&
+                   (p->breaks[old_i] < p->dirty_old_end ||
+                    p->breaks[old_i] + p->dirty_delta < rel)) {
+                old_i++;
+            }
+            if (old_i < old_n && p->breaks[old_i] + p->dirty_delta == rel) {
+                for (old_i++; old_i < old_n; old_i++) {
+                    if (text_layout_push_break(&breaks, &count, &cap,
+                                               p->breaks[old_i] + p->dirty_delta) != 0) {
+                        free(breaks);
+                        return -1;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    free(p->breaks);
+    p->breaks = breaks;
+    p->visual_count = count + 1;
+    p->dirty = 0;
+    layout->measured++;
+    text_layout_tree_add(layout, para, p->visual_count - old_lines);
+    return 0;
+}
+
+void text_layout_line_range(TextLayout* layout, const TextBuffer* buffer, int index,
+                            TextLayoutWrapFn wrap_fn, void* user,
+                            int* out_start, int* out_end)
+{
+    int para = 0;
+    int sub = 0;
+    int start = 0;
+    int end = 0;
+    int guard;
+
+    if (layout && buffer && layout->para_count > 0) {
+        /* 测量会改变行数，重新定位直到所在段已测量 */
+        for (guard = 0; guard < 64; guard++) {
+            para = text_layout_para_of_line(layout, index);
+            if (layout->paras[para].visual_count > 0 && !layout->paras[para].dirty) {
+                break;
+            }
+            if (text_layout_measure_para(layout, buffer, para, wrap_fn, user) != 0) {
+                break;
+            }
+        }
+        sub = index - text_layout_para_first_line(layout, para);
+        if (sub < 0) sub = 0;
+        if (sub >= text_layout_para_lines(layout, &layout->paras[para])) {
+            sub = text_layout_para_lines(layout, &layout->paras[para]) - 1;
+        }
+        start = text_buffer_line_start(buffer, para);
+        end = start + layout->paras[para].len;
+        if (layout->paras[para].breaks && layout->paras[para].visual_count > 1) {
+            int base = start;
+            if (sub > 0) start = base + layout->paras[para].breaks[sub - 1];
+            if (sub + 1 < layout->paras[para].visual_count) end = base + layout->paras[para].breaks[sub];
+        }
+    }
+    if (out_start) *out_start = start;
+    if (out_end) *out_end = end;
+}
+
+int text_layout_line_of(TextLayout* layout, const TextBuffer* buffer, int pos, int prefer_line,
+                        TextLayoutWrapFn wrap_fn, void* user)
+{
+    TextLayoutPara* p;
+    int para;
+    int rel;
+    int sub = 0;
+    int first;
+
+    if (!layout || !buffer || layout->para_count <= 0) {
+        return 0;
+    }
+    para = text_buffer_line_of(buffer, pos);
+    if (para >= layout->para_count) para = layout->para_count - 1;
+    text_layout_measure_para(layout, buffer, para, wrap_fn, user);
+    p = &layout->paras[para];
+    rel = pos - text_buffer_line_start(buffer, para);
+    if (p->breaks && p->visual_count > 1) {
+        /* 最后一个 <= rel 的折行 */
+        int lo = 0;
+        int hi = p->visual_count - 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (p->breaks[mid] <= rel) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        sub = lo;
+    }
+    first = text_layout_para_first_line(layout, para);
+    /* 软换行边界：光标停在上一行行尾 */
+    if (sub > 0 && p->breaks[sub - 1] == rel && prefer_line == first + sub - 1) {
+        sub--;
+    }
+    return first + sub;
+}
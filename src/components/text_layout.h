@@ -0,0 +1,93 @@
+#ifndef YUI_TEXT_LAYOUT_H
+#define YUI_TEXT_LAYOUT_H
+
+#include "text_buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Visual-line layout for wrapped text, kept per paragraph (logical line).
+ *
+ * Each paragraph stores its wrap breaks relative to its own start, so an
+ * edit only drops the paragraphs it touched; later paragraphs keep their
+ * measurement and simply shift. Paragraphs are wrapped lazily when a
+ * visual line inside them is requested; unmeasured paragraphs count with
+ * an estimated number of visual lines. Visual-line counts live in a
+ * Fenwick tree, so index <-> paragraph lookups are O(log n).
+ */
+
+/* Returns the end offset (absolute) of the visual line starting at start,
+   within the paragraph [start, para_end). Must return > start when start < para_end. */
+typedef int (*TextLayoutWrapFn)(void* user, int start, int para_end, int max_width);
+
+typedef struct TextLayoutPara {
+    int len;          /* bytes, without the trailing '\n' */
+    int visual_count; /* 0 = not measured yet */
+    int* breaks;      /* visual_count - 1 offsets relative to the paragraph start */
+    /* Edited since the last wrap: [dirty_pos, dirty_old_end) of the old text
+       changed by dirty_delta bytes. Old breaks are reused before the edit and
+       once a new break lines up with a shifted old one after it. */
+    int dirty;
+    int dirty_pos;
+    int dirty_old_end;
+    int dirty_delta;
+} TextLayoutPara;
+
+typedef struct TextLayout {
+    TextLayoutPara* paras;
+    int para_count;
+    int para_cap;
+    int* tree;        /* Fenwick tree over per-paragraph visual counts (1-based) */
+    int tree_valid;
+    int total;        /* visual lines including estimates */
+    int max_width;
+    int wrap;
+    int est_bytes_per_line;
+    int measured;     /* paragraphs wrapped so far (stats) */
+} TextLayout;
+
+void text_layout_init(TextLayout* layout);
+void text_layout_free(TextLayout* layout);
+
+/* Drop all measurements and rebuild paragraphs from the buffer's lines (no wrapping). */
+int text_layout_reset(TextLayout* layout, const TextBuffer* buffer,
+                      int max_width, int wrap, int est_bytes_per_line);
+
+/* Call after buffer replaced removed_len bytes at pos (containing removed_lines
+   '\n') by inserted_len bytes. Only the touched paragraphs lose their wrap. */
+int text_layout_replace(TextLayout* layout, const TextBuffer* buffer, int pos,
+                        int removed_len, int removed_lines, int inserted_len);
+
+/* Forget the wrap of paragraphs [first, last] (e.g. style change). */
+void text_layout_invalidate_paras(TextLayout* layout, int first, int last);
+
+/* Total visual lines; estimated for unmeasured paragraphs. */
+int text_layout_line_count(TextLayout* layout);
+
+/* First visual line of paragraph (estimates before it count). */
+int text_layout_para_first_line(TextLayout* layout, int para);
+
+/* Paragraph containing visual line index (clamped). */
+int text_layout_para_of_line(TextLayout* layout, int index);
+
+/* Wrap a paragraph if needed. Returns 0, -1 on allocation failure. */
+int text_layout_measure_para(TextLayout* layout, const TextBuffer* buffer, int para,
+                             TextLayoutWrapFn wrap_fn, void* user);
+
+/* Range of visual line index; the paragraph is wrapped on demand. End excludes '\n'. */
+void text_layout_line_range(TextLayout* layout, const TextBuffer* buffer, int index,
+                            TextLayoutWrapFn wrap_fn, void* user,
+                            int* out_start, int* out_end);
+
+/* Visual line containing pos. At a soft wrap boundary pos belongs to the
+   next line unless prefer_line is the previous one. */
+int text_layout_line_of(TextLayout* layout, const TextBuffer* buffer, int pos, int prefer_line,
+                        TextLayoutWrapFn wrap_fn, void* user);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
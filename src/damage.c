@@ -0,0 +1,286 @@
+#include "damage.h"
+#include "layer_update.h"
+
+#include <string.h>
+
+#define DAMAGE_GEOMETRY_FLAGS (DIRTY_RECT | DIRTY_LAYOUT | DIRTY_CHILDREN | DIRTY_VISIBLE)
+
+typedef struct DamageLayerEntry {
+    Layer* layer;
+    unsigned int flags;
+} DamageLayerEntry;
+
+typedef struct DamageTimedEntry {
+    Layer* layer;
+    uint32_t due_ms;
+} DamageTimedEntry;
+
+/* 启动后第一帧必须整屏绘制 */
+static int g_pending_full = 1;
+static Rect g_pending_rects[DAMAGE_MAX_RECTS];
+static int g_pending_count = 0;
+static DamageLayerEntry g_pending_layers[DAMAGE_MAX_LAYERS];
+static int g_pending_layer_count = 0;
+static DamageTimedEntry g_timed[DAMAGE_MAX_TIMED];
+static int g_timed_count = 0;
+
+static Rect g_frame_rects[DAMAGE_MAX_RECTS];
+static int g_frame_count = 0;
+static int g_frame_full = 0;
+static int g_frame_active = 0;
+
+static int damage_rect_empty(const Rect* r) {
+    return !r || r->w <= 0 || r->h <= 0;
+}
+
+// 相交或紧贴都视为可合并，减少碎片
+static int damage_rect_touch(const Rect* a, const Rect* b) {
+    return a->x <= b->x + b->w && b->x <= a->x + a->w &&
+           a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+static void damage_rect_union(Rect* out, const Rect* a, const Rect* b) {
+    int x0 = a->x < b->x ? a->x : b->x;
+    int y0 = a->y < b->y ? a->y : b->y;
+    int x1 = (a->x + a->w) > (b->x + b->w) ? (a->x + a->w) : (b->x + b->w);
+    int y1 = (a->y + a->h) > (b->y + b->h) ? (a->y + a->h) : (b->y + b->h);
+    out->x = x0;
+    out->y = y0;
+    out->w = x1 - x0;
+    out->h = y1 - y0;
+}
+
+static int damage_rect_clip(Rect* r, const Rect* bounds) {
+    int x0 = r->x > bounds->x ? r->x : bounds->x;
+    int y0 = r->y > bounds->y ? r->y : bounds->y;
+    int x1 = (r->x + r->w) < (bounds->x + bounds->w) ? (r->x + r->w) : (bounds->x + bounds->w);
+    int y1 = (r->y + r->h) < (bounds->y + bounds->h) ? (r->y + r->h) : (bounds->y + bounds->h);
+    r->x = x0;
+    r->y = y0;
+    r->w = x1 - x0;
+    r->h = y1 - y0;
+    return r->w > 0 && r->h > 0;
+}
+
+// 合并进列表：与已有矩形相接则并入并继续向后吸收，列表满时整体退化为包围盒
+static void damage_rect_list_add(Rect* list, int* count, const Rect* rect) {
+    Rect merged = *rect;
+    int i = 0;
+
+    while (i < *count) {
+        if (damage_rect_touch(&list[i], &merged)) {
+            damage_rect_union(&merged, &list[i], &merged);
+            list[i] = list[*count - 1];
+            (*count)--;
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+
+    if (*count < DAMAGE_MAX_RECTS) {
+        list[(*count)++] = merged;
+        return;
+    }
+
+    for (i = 0; i < *count; i++) {
+        damage_rect_union(&merged, &merged, &list[i]);
+    }
+    list[0] = merged;
+    *count = 1;
+}
+
+void damage_layer_visual_rect(const Layer* layer, Rect* out) {
+    if (!out) return;
+    if (!layer) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = layer->rect;
+    if (layer->shadow.enabled && layer->shadow.color.a > 0) {
+        int ox = layer->shadow.offset_x < 0 ? -layer->shadow.offset_x : layer->shadow.offset_x;
+        int oy = layer->shadow.offset_y < 0 ? -layer->shadow.offset_y : layer->shadow.offset_y;
+        int spread = layer->shadow.spread > 0 ? layer->shadow.spread : 0;
+        int ex = ox + layer->shadow.blur + spread;
+        int ey = oy + layer->shadow.blur + spread;
+        out->x -= ex;
+        out->y -= ey;
+        out->w += ex * 2;
+        out->h += ey * 2;
+    }
+}
+
+void damage_add_rect(const Rect* rect) {
+    if (g_pending_full || damage_rect_empty(rect)) return;
+    damage_rect_list_add(g_pending_rects, &g_pending_count, rect);
+}
+
+void damage_add_full(void) {
+    g_pending_full = 1;
+    g_pending_count = 0;
+    g_pending_layer_count = 0;
+}
+
+// 图层当前可见区域；几何变化影响兄弟节点排布，扩大到父图层
+static int damage_layer_add_now(Layer* layer, unsigned int flags) {
+    Rect r;
+    Layer* target = layer;
+
+    if (flags & DAMAGE_GEOMETRY_FLAGS) {
+        if (!layer->parent) {
+            damage_add_full();
+            return 0;
+        }
+        target = layer->parent;
+    }
+    damage_layer_visual_rect(target, &r);
+    damage_add_rect(&r);
+    return 1;
+}
+
+void damage_add_layer(Layer* layer, unsigned int flags) {
+    if (!layer || g_pending_full) return;
+    if (!damage_layer_add_now(layer, flags)) return;
+
+    for (int i = 0; i < g_pending_layer_count; i++) {
+        if (g_pending_layers[i].layer == layer) {
+            g_pending_layers[i].flags |= flags;
+            return;
+        }
+    }
+    if (g_pending_layer_count >= DAMAGE_MAX_LAYERS) {
+        damage_add_full();
+        return;
+    }
+    g_pending_layers[g_pending_layer_count].layer = layer;
+    g_pending_layers[g_pending_layer_count].flags = flags;
+    g_pending_layer_count++;
+}
+
+int damage_pending(void) {
+    return g_pending_full || g_pending_count > 0 || g_pending_layer_count > 0;
+}
+
+void damage_add_layer_at(Layer* layer, uint32_t due_ms) {
+    if (!layer) return;
+    for (int i = 0; i < g_timed_count; i++) {
+        if (g_timed[i].layer == layer) {
+            // 同一图层只保留最早的一次
+            if ((int32_t)(due_ms - g_timed[i].due_ms) < 0) {
+                g_timed[i].due_ms = due_ms;
+            }
+            return;
+        }
+    }
+    if (g_timed_count >= DAMAGE_MAX_TIMED) {
+        damage_add_layer(layer, DIRTY_NONE);
+        return;
+    }
+    g_timed[g_timed_count].layer = layer;
+    g_timed[g_timed_count].due_ms = due_ms;
+    g_timed_count++;
+}
+
+void damage_promote_due(uint32_t now_ms) {
+    int i = 0;
+    while (i < g_timed_count) {
+        if ((int32_t)(now_ms - g_timed[i].due_ms) >= 0) {
+            damage_add_layer(g_timed[i].layer, DIRTY_NONE);
+            g_timed[i] = g_timed[--g_timed_count];
+            continue;
+        }
+        i++;
+    }
+}
+
+int damage_next_due(uint32_t now_ms) {
+    int best = -1;
+    for (int i = 0; i < g_timed_count; i++) {
+        int32_t delta = (int32_t)(g_timed[i].due_ms - now_ms);
+        if (delta < 0) delta = 0;
+        if (best < 0 || delta < best) {
+            best = delta;
+        }
+    }
+    return best;
+}
+
+void damage_layer_destroyed(Layer* layer) {
+    if (!layer) return;
+    if (!g_pending_full) {
+        Rect r;
+        damage_layer_visual_rect(layer, &r);
+        damage_add_rect(&r);
+    }
+    for (int i = 0; i < g_timed_count; i++) {
+        if (g_timed[i].layer == layer) {
+            g_timed[i] = g_timed[--g_timed_count];
+            break;
+        }
+    }
+    for (int i = 0; i < g_pending_layer_count; i++) {
+        if (g_pending_layers[i].layer == layer) {
+            g_pending_layers[i] = g_pending_layers[--g_pending_layer_count];
+            return;
+        }
+    }
+}
+
+int damage_begin_frame(const Rect* viewport) {
+    int i;
+
+    /* 布局已在修改入口完成，补记图层的新位置 */
+    for (i = 0; i < g_pending_layer_count && !g_pending_full; i++) {
+        damage_layer_add_now(g_pending_layers[i].layer, g_pending_layers[i].flags);
+    }
+    g_pending_layer_count = 0;
+
+    g_frame_count = 0;
+    g_frame_full = g_pending_full;
+    if (g_pending_full) {
+        if (viewport && !damage_rect_empty(viewport)) {
+            g_frame_rects[0] = *viewport;
+            g_frame_count = 1;
+        }
+    } else {
+        for (i = 0; i < g_pending_count; i++) {
+            Rect r = g_pending_rects[i];
+            if (viewport && !damage_rect_clip(&r, viewport)) continue;
+            damage_rect_list_add(g_frame_rects, &g_frame_count, &r);
+        }
+        /* 脏区已覆盖整个视口时按整屏处理（可直接 clear） */
+        if (viewport && g_frame_count == 1 &&
+            memcmp(&g_frame_rects[0], viewport, sizeof(Rect)) == 0) {
+            g_frame_full = 1;
+        }
+    }
+
+    g_pending_full = 0;
+    g_pending_count = 0;
+    return g_frame_count;
+}
+
+const Rect* damage_frame_rects(int* count) {
+    if (count) *count = g_frame_count;
+    return g_frame_rects;
+}
+
+int damage_frame_is_full(void) {
+    return g_frame_full;
+}
+
+uint64_t damage_frame_area(void) {
+    uint64_t area = 0;
+    for (int i = 0; i < g_frame_count; i++) {
+        area += (uint64_t)g_frame_rects[i].w * (uint64_t)g_frame_rects[i].h;
+    }
+    return area;
+}
+
+void damage_set_frame_active(int active) {
+    g_frame_active = active ? 1 : 0;
+}
+
+int damage_frame_active(void) {
+    return g_frame_active;
+}
@@ -0,0 +1,70 @@
+#ifndef YUI_DAMAGE_H
+#define YUI_DAMAGE_H
+
+#include "ytype.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 脏区（damage）累积器：mark_layer_dirty 等修改入口把受影响区域记到 pending，
+   主循环在帧开始时取走，只重绘与脏区相交的图层；没有脏区的帧直接跳过。
+   坐标均为逻辑坐标（与 layer->rect 一致）。 */
+
+#define DAMAGE_MAX_RECTS  16   // 超出后合并为包围盒
+#define DAMAGE_MAX_LAYERS 64   // 超出后退化为整屏重绘
+#define DAMAGE_MAX_TIMED  32   // 定时重绘条目，超出后立即记脏
+
+// 记录一块脏矩形
+void damage_add_rect(const Rect* rect);
+
+// 记录图层脏区：当前区域立即记录，帧开始时再补记布局后的区域；
+// 几何类标记（RECT/LAYOUT/CHILDREN/VISIBLE）扩大到父图层
+void damage_add_layer(Layer* layer, unsigned int flags);
+
+// 整屏重绘（弹出层、JS 定时器、动画、窗口变化等无法精确定位的修改）
+void damage_add_full(void);
+
+// 是否有待处理的脏区
+int damage_pending(void);
+
+// 到 due_ms（backend_get_ticks 时基）时重绘图层，用于时钟、延时提示等定时刷新
+void damage_add_layer_at(Layer* layer, uint32_t due_ms);
+
+// 把已到期的定时重绘转为脏区
+void damage_promote_due(uint32_t now_ms);
+
+// 距最早定时重绘的毫秒数（已到期为 0），没有返回 -1
+int damage_next_due(uint32_t now_ms);
+
+// 图层销毁前调用：记录其区域并移出待处理/定时列表
+void damage_layer_destroyed(Layer* layer);
+
+// 图层的可视区域（含阴影外扩）
+void damage_layer_visual_rect(const Layer* layer, Rect* out);
+
+/**
+ * 帧开始：取走 pending 脏区（渲染期间新增的脏区留给下一帧）
+ * @param viewport 逻辑视口，整屏脏区按它裁剪
+ * @return 本帧脏矩形数量，0 表示可以跳过本帧
+ */
+int damage_begin_frame(const Rect* viewport);
+
+// 本帧脏矩形（damage_begin_frame 之后有效）
+const Rect* damage_frame_rects(int* count);
+
+// 本帧是否整屏重绘
+int damage_frame_is_full(void);
+
+// 本帧脏区覆盖的逻辑像素数
+uint64_t damage_frame_area(void);
+
+// 后端在局部重绘阶段置位，render_layer 据此裁掉与脏区不相交的自绘图层
+void damage_set_frame_active(int active);
+int damage_frame_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
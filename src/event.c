@@ -2,8 +2,11 @@
 #include "util.h"
 #include "backend.h"
 #include "popup_manager.h"
+#include "hit_test.h"
 #include "component_registry.h"
 #include "input/state.h"
+#include "damage.h"
+#include "layer_update.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
@@ -25,6 +28,13 @@ static int g_key_listener_count = 0;
 static WindowEventListener g_window_listeners[MAX_DEVICE_LISTENERS];
 static int g_window_listener_count = 0;
 
+// 输入只改了图层外观（悬停、按下、焦点、组件内部状态），只重绘该图层
+static void event_damage_layer(Layer* layer) {
+    if (layer) {
+        damage_add_layer(layer, DIRTY_NONE);
+    }
+}
+
 void pointer_gesture_mark_scrolled(void) {
     pointer_gesture_scrolled = 1;
 }
@@ -302,8 +312,8 @@ static void handler_virtical_scroll_event(Layer* layer, int scroll_delta) {
         if (layer->event && layer->event->scroll) {
             EVENT_INVOKE(layer->event->scroll, layer);
         }
-        // 重新布局子元素
-        layout_layer(layer);
+        // 只平移子元素，尺寸不变无需重新布局
+        layout_scroll_changed(layer);
     }
 }
 
@@ -337,8 +347,8 @@ static void handle_horizontal_scroll_event(Layer* layer, int scroll_delta) {
         if (layer->event && layer->event->scroll) {
             EVENT_INVOKE(layer->event->scroll, layer);
         }
-        // 重新布局子元素
-        layout_layer(layer);
+        // 只平移子元素，尺寸不变无需重新布局
+        layout_scroll_changed(layer);
     }
 }
 
@@ -348,8 +358,9 @@ static void handle_key_event_tree(Layer* layer, KeyEvent* event) {
         return;
     }
 
-    // 优先处理popup层的键盘事件
+    // 优先处理popup层的键盘事件；弹出层可能开关，整屏重绘
     if (popup_manager_handle_key_event(event)) {
+        damage_add_full();
         return;
     }
 
@@ -376,7 +387,10 @@ void handle_key_event(Layer* layer, KeyEvent* event) {
         return;
     }
     notify_key_listeners(event);
+    // 按键只送到焦点图层：处理前后的焦点图层各重绘一次
+    event_damage_layer(focused_layer);
     handle_key_event_tree(layer, event);
+    event_damage_layer(focused_layer);
 }
 
 // 递归检查指定位置是否有子图层可以处理点击事件
@@ -405,6 +419,7 @@ int default_layer_handle_pointer_event(Layer* layer, PointerEvent* event) {
     if (!layer || !event) return 0;
 
     Point mouse_pos = {event->x, event->y};
+    unsigned int old_state = layer->state;
 
     if (point_in_rect(mouse_pos, layer->rect)) {
         if (layer->state != LAYER_STATE_FOCUSED && layer->state != LAYER_STATE_DISABLED) {
@@ -419,6 +434,9 @@ int default_layer_handle_pointer_event(Layer* layer, PointerEvent* event) {
             layer->state = LAYER_STATE_NORMAL;
         }
     }
+    if (layer->state != old_state) {
+        event_damage_layer(layer);
+    }
 
     if (layer->event && layer->event->click && !layer->handle_pointer_event) {
         const YuiComponentOps* ops = yui_type_get_ops(layer->type);
@@ -548,6 +566,16 @@ static SDL_EventType pointer_phase_to_sdl_type(PointerPhase phase) {
     return SDL_MOUSEMOTION;
 }
 
+/* 图层自身消费了事件：按下时成为指针捕获目标，拖出区域后仍收到移动 */
+static int pointer_event_consumed(Layer* layer, PointerEvent* pe) {
+    if (pe->phase == POINTER_DOWN || pe->phase == POINTER_DOUBLE_TAP) {
+        if (!hit_test_get_capture()) {
+            hit_test_set_capture(layer);
+        }
+    }
+    return 1;
+}
+
 int handle_pointer_event(Layer* layer, PointerEvent* event) {
     PointerEvent scroll_cancel_event;
     PointerEvent* pe = event;
@@ -557,15 +585,20 @@ int handle_pointer_event(Layer* layer, PointerEvent* event) {
     }
 
     if (layer->parent == NULL) {
+        // 命中测试前让挂起的滚动生效
+        layout_flush_scroll();
         notify_pointer_listeners(event);
         if (event->phase == POINTER_DOWN || event->phase == POINTER_DOUBLE_TAP) {
             pointer_gesture_scrolled = 0;
         }
+        // 弹出层画在 back-buffer 之上且可能开关，交给它的事件整屏重绘
         if (event->phase == POINTER_WHEEL &&
             popup_manager_handle_scroll_event(event->delta_y)) {
+            damage_add_full();
             return 1;
         }
         if (popup_manager_handle_pointer_event(event)) {
+            damage_add_full();
             return 1;
         }
         if (event->device == POINTER_DEVICE_MOUSE && event->phase == POINTER_UP) {
@@ -577,15 +610,32 @@ int handle_pointer_event(Layer* layer, PointerEvent* event) {
             scroll_cancel_event.phase = POINTER_CANCEL;
             pe = &scroll_cancel_event;
         }
+        /* 移动事件只派发给命中索引标记的图层；其他事件按 rect 逐层判断 */
+        if (pe->phase == POINTER_MOVE) {
+            hit_test_begin_move(layer, pe->x, pe->y);
+        } else {
+            hit_test_end_move();
+        }
+        if (pe->phase == POINTER_DOWN || pe->phase == POINTER_DOUBLE_TAP ||
+            pe->phase == POINTER_UP || pe->phase == POINTER_CANCEL) {
+            hit_test_release_capture();
+        }
     }
 
     Point pos = {pe->x, pe->y};
+    int gate_move = pe->phase == POINTER_MOVE && hit_test_marked(layer);
 
     for (int i = layer->child_count - 1; i >= 0; i--) {
         if (layer->children[i] && layer->children[i]->visible == VISIBLE) {
-            /* POINTER_MOVE: don't gate on child rect — a drag may have moved outside */
-            if (pe->phase != POINTER_MOVE &&
-                !point_in_rect(pos, layer->children[i]->rect)) {
+            /* POINTER_MOVE: don't gate on child rect — a drag may have moved outside;
+             * the hit-test index keeps only layers under the pointer, the previous
+             * hits and the capture target */
+            if (gate_move) {
+                if (!hit_test_marked(layer->children[i])) {
+                    continue;
+                }
+            } else if (pe->phase != POINTER_MOVE &&
+                       !point_in_rect(pos, layer->children[i]->rect)) {
                 continue;
             }
             int consumed = handle_pointer_event(layer->children[i], pe);
@@ -608,13 +658,16 @@ int handle_pointer_event(Layer* layer, PointerEvent* event) {
             (pe->phase == POINTER_DOWN || pe->phase == POINTER_DOUBLE_TAP)) {
             if (focused_layer && focused_layer != layer) {
                 focused_layer->state = LAYER_STATE_NORMAL;
+                event_damage_layer(focused_layer);
             }
             focused_layer = layer;
             layer->state = LAYER_STATE_FOCUSED;
+            event_damage_layer(layer);
         }
     }
 
-    if (layer->sub && layer->sub->visible == VISIBLE) {
+    if (layer->sub && layer->sub->visible == VISIBLE &&
+        (!gate_move || hit_test_marked(layer->sub))) {
         int consumed = handle_pointer_event(layer->sub, pe);
         if (consumed) return 1;
     }
@@ -624,17 +677,20 @@ int handle_pointer_event(Layer* layer, PointerEvent* event) {
         process_layer_scrollbar(layer, pe->x, pe->y,
                                 pointer_phase_to_sdl_type(pe->phase));
         if (layer_scrollbar_dragging(layer)) {
-            return 1;
+            event_damage_layer(layer);
+            return pointer_event_consumed(layer, pe);
         }
     }
 
     if (layer->handle_pointer_event) {
         int consumed = layer->handle_pointer_event(layer, pe);
-        if (consumed) return 1;
+        // 组件自己维护悬停/按下等状态，不一定标脏
+        event_damage_layer(layer);
+        if (consumed) return pointer_event_consumed(layer, pe);
     }
 
     if (default_scrollable_pointer_handler(layer, pe)) {
-        return 1;
+        return pointer_event_consumed(layer, pe);
     }
 
     if (layer->event && layer->event->touch &&
@@ -647,10 +703,14 @@ int handle_pointer_event(Layer* layer, PointerEvent* event) {
         current_pointer_event_active = 1;
         EVENT_INVOKE(layer->event->touch, layer);
         current_pointer_event_active = 0;
-        return 1;
+        event_damage_layer(layer);
+        return pointer_event_consumed(layer, pe);
     }
 
-    return default_layer_handle_pointer_event(layer, pe);
+    if (default_layer_handle_pointer_event(layer, pe)) {
+        return pointer_event_consumed(layer, pe);
+    }
+    return 0;
 }
 
 // 处理滚动条拖动事件
@@ -701,9 +761,7 @@ static void process_layer_scrollbar(Layer* layer, int mouse_x, int mouse_y, SDL_
                 float scroll_ratio = (float)(new_scrollbar_y - layer->rect.y) / (visible_height - scrollbar_height);
                 layer->scroll_offset = (int)(scroll_ratio * (content_height - visible_height));
 
-                if (layer->layout_manager && layer->child_count > 0) {
-                    layout_layer(layer);
-                }
+                layout_scroll_changed(layer);
             }
         }
     }
@@ -752,9 +810,7 @@ static void process_layer_scrollbar(Layer* layer, int mouse_x, int mouse_y, SDL_
                 float scroll_ratio = (float)(new_scrollbar_x - layer->rect.x) / (visible_width - scrollbar_width);
                 layer->scroll_offset_x = (int)(scroll_ratio * (content_width - visible_width));
 
-                if (layer->layout_manager && layer->child_count > 0) {
-                    layout_layer(layer);
-                }
+                layout_scroll_changed(layer);
             }
         }
     }
@@ -806,9 +862,7 @@ static void process_layer_scrollbar(Layer* layer, int mouse_x, int mouse_y, SDL_
                 float scroll_ratio = (float)(new_scrollbar_y - layer->rect.y) / (visible_height - scrollbar_height);
                 layer->scroll_offset = (int)(scroll_ratio * (content_height - visible_height));
 
-                if (layer->layout_manager && layer->child_count > 0) {
-                    layout_layer(layer);
-                }
+                layout_scroll_changed(layer);
             }
         }
     }
@@ -820,6 +874,10 @@ static void reset_scrollbar_dragging_state(Layer* layer) {
         return;
     }
     
+    if (layer_scrollbar_dragging(layer)) {
+        event_damage_layer(layer);
+    }
+
     // 重置当前图层的垂直滚动条拖动状态
     if (layer->scrollbar_v) {
         layer->scrollbar_v->is_dragging = 0;
@@ -3,45 +3,76 @@
 
 #if YUI_WITH_GAME
 
+#include <stdlib.h>
 #include <string.h>
 
+static GameAnim* game_anim_of(GameEntity* e)
+{
+    if (!e->anim) {
+        e->anim = (GameAnim*)calloc(1, sizeof(GameAnim));
+    }
+    return e->anim;
+}
+
 void game_anim_update(GameEntity* e, float dt)
 {
+    GameAnim* a;
     int idx;
-    if (!e || !e->alive || e->anim_frame_count <= 0 || e->anim_fps <= 0.0f) {
+    if (!e || !GAME_ALIVE(e) || !e->anim) {
         return;
     }
-    e->anim_t += dt;
-    if (e->anim_t >= 1.0f / e->anim_fps) {
-        e->anim_t = 0.0f;
-        e->anim_frame = (e->anim_frame + 1) % e->anim_frame_count;
+    a = e->anim;
+    if (a->frame_count <= 0 || a->fps <= 0.0f) {
+        return;
+    }
+    a->t += dt;
+    if (a->t >= 1.0f / a->fps) {
+        a->t = 0.0f;
+        a->frame = (a->frame + 1) % a->frame_count;
     }
-    idx = e->anim_frame;
-    if (idx < 0 || idx >= e->anim_frame_count) {
+    idx = a->frame;
+    if (idx < 0 || idx >= a->frame_count) {
         idx = 0;
     }
-    e->frame_x = e->anim_frames_x[idx];
-    e->frame_y = e->anim_frames_y[idx];
-    e->frame_w = e->anim_frames_w[idx];
-    e->frame_h = e->anim_frames_h[idx];
+    e->frame_x = a->frames_x[idx];
+    e->frame_y = a->frames_y[idx];
+    e->frame_w = a->frames_w[idx];
+    e->frame_h = a->frames_h[idx];
     e->use_frame = 1;
 }
 
+/* One pass over the table; entities without frames cost a pointer test. */
+void game_anim_step(GameEntity** all, int n, float dt)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+        if (all[i] && all[i]->anim) {
+            game_anim_update(all[i], dt);
+        }
+    }
+}
+
 int game_play_anim(GameEntity* e, const char* clip)
 {
+    GameAnim* a;
     if (!e || !clip) {
         return 0;
     }
-    strncpy(e->anim_clip, clip, GAME_ID_LEN - 1);
-    e->anim_clip[GAME_ID_LEN - 1] = '\0';
-    e->anim_frame = 0;
-    e->anim_t = 0.0f;
-    return e->anim_frame_count > 0;
+    a = game_anim_of(e);
+    if (!a) {
+        return 0;
+    }
+    strncpy(a->clip, clip, GAME_ID_LEN - 1);
+    a->clip[GAME_ID_LEN - 1] = '\0';
+    a->frame = 0;
+    a->t = 0.0f;
+    return a->frame_count > 0;
 }
 
 /* Parse anim from entity JSON: anim: { fps, frames: [{x,y,w,h}, ...] } or clip name only */
 void game_anim_apply_json(GameEntity* e, cJSON* anim)
 {
+    GameAnim* a;
     cJSON* frames;
     cJSON* fr;
     cJSON* t;
@@ -49,15 +80,19 @@ void game_anim_apply_json(GameEntity* e, cJSON* anim)
     if (!e || !anim || !cJSON_IsObject(anim)) {
         return;
     }
+    a = game_anim_of(e);
+    if (!a) {
+        return;
+    }
     t = cJSON_GetObjectItem(anim, "clip");
     if (cJSON_IsString(t) && t->valuestring) {
-        strncpy(e->anim_clip, t->valuestring, GAME_ID_LEN - 1);
+        strncpy(a->clip, t->valuestring, GAME_ID_LEN - 1);
     }
     t = cJSON_GetObjectItem(anim, "fps");
     if (cJSON_IsNumber(t)) {
-        e->anim_fps = (float)t->valuedouble;
+        a->fps = (float)t->valuedouble;
     } else {
-        e->anim_fps = 8.0f;
+        a->fps = 8.0f;
     }
     frames = cJSON_GetObjectItem(anim, "frames");
     if (!cJSON_IsArray(frames)) {
@@ -68,23 +103,23 @@ void game_anim_apply_json(GameEntity* e, cJSON* anim)
             break;
         }
         t = cJSON_GetObjectItem(fr, "x");
-        e->anim_frames_x[i] = cJSON_IsNumber(t) ? t->valueint : 0;
+        a->frames_x[i] = cJSON_IsNumber(t) ? t->valueint : 0;
         t = cJSON_GetObjectItem(fr, "y");
-        e->anim_frames_y[i] = cJSON_IsNumber(t) ? t->valueint : 0;
+        a->frames_y[i] = cJSON_IsNumber(t) ? t->valueint : 0;
         t = cJSON_GetObjectItem(fr, "w");
-        e->anim_frames_w[i] = cJSON_IsNumber(t) ? t->valueint : (int)e->w;
+        a->frames_w[i] = cJSON_IsNumber(t) ? t->valueint : (int)e->w;
         t = cJSON_GetObjectItem(fr, "h");
-        e->anim_frames_h[i] = cJSON_IsNumber(t) ? t->valueint : (int)e->h;
+        a->frames_h[i] = cJSON_IsNumber(t) ? t->valueint : (int)e->h;
         i++;
     }
-    e->anim_frame_count = i;
-    e->anim_frame = 0;
-    e->anim_t = 0.0f;
+    a->frame_count = i;
+    a->frame = 0;
+    a->t = 0.0f;
     if (i > 0) {
-        e->frame_x = e->anim_frames_x[0];
-        e->frame_y = e->anim_frames_y[0];
-        e->frame_w = e->anim_frames_w[0];
-        e->frame_h = e->anim_frames_h[0];
+        e->frame_x = a->frames_x[0];
+        e->frame_y = a->frames_y[0];
+        e->frame_w = a->frames_w[0];
+        e->frame_h = a->frames_h[0];
         e->use_frame = 1;
     }
 }
@@ -0,0 +1,224 @@
+#include "game.h"
+#include "internal.h"
+
+#if YUI_WITH_GAME
+
+#include "../backend.h"
+#include <stdlib.h>
+
+/* Sprite batch: consecutive quads that share a texture are collected into
+ * one vertex run and submitted with a single backend_render_geometry call;
+ * a NULL texture is a run of solid-color quads. Callers keep their draw
+ * order, so a texture switch (or a solid quad between sprites) ends a run.
+ * Backends without geometry support get one copy / fill_rect per quad and
+ * never allocate the vertex buffers. */
+
+static BackendVertex* g_verts;
+static int* g_indices;
+static int g_quad_cap;
+static int g_quads;
+static Texture* g_tex;
+static int g_tex_w; /* size of g_tex for src rects; 0 = not queried yet */
+static int g_tex_h;
+static int g_geometry; /* backend accepted the probe this frame */
+static int g_direct_run; /* without geometry: a run is open in g_tex */
+static int g_batches; /* runs, i.e. geometry calls this frame needs */
+static int g_calls;
+
+static const GameBatchBackend g_default_backend = {
+    backend_render_geometry,
+    backend_query_texture,
+};
+static const GameBatchBackend* g_backend = &g_default_backend;
+
+void game_batch_set_backend(const GameBatchBackend* backend)
+{
+    g_backend = backend ? backend : &g_default_backend;
+}
+
+static int game_batch_grow(int quads)
+{
+    int cap = g_quad_cap > 0 ? g_quad_cap : 256;
+    BackendVertex* verts;
+    int* indices;
+    int i;
+    while (cap < quads) {
+        cap *= 2;
+    }
+    verts = (BackendVertex*)realloc(g_verts, (size_t)cap * 4 * sizeof(BackendVertex));
+    if (!verts) {
+        return -1;
+    }
+    g_verts = verts;
+    indices = (int*)realloc(g_indices, (size_t)cap * 6 * sizeof(int));
+    if (!indices) {
+        return -1;
+    }
+    g_indices = indices;
+    /* Index pattern is the same for every run: two triangles per quad. */
+    for (i = g_quad_cap; i < cap; i++) {
+        g_indices[i * 6 + 0] = i * 4 + 0;
+        g_indices[i * 6 + 1] = i * 4 + 1;
+        g_indices[i * 6 + 2] = i * 4 + 2;
+        g_indices[i * 6 + 3] = i * 4 + 2;
+        g_indices[i * 6 + 4] = i * 4 + 3;
+        g_indices[i * 6 + 5] = i * 4 + 0;
+    }
+    g_quad_cap = cap;
+    return 0;
+}
+
+static void game_batch_flush(void)
+{
+    if (g_quads == 0) {
+        return;
+    }
+    g_backend->render_geometry(g_tex, g_verts, g_quads * 4, g_indices, g_quads * 6);
+    g_batches++;
+    g_calls++;
+    g_quads = 0;
+}
+
+/* Make the open run draw with tex; returns 0 if the caller must draw directly. */
+static int game_batch_use(Texture* tex, int quads)
+{
+    if (!g_geometry) {
+        if (!g_direct_run || tex != g_tex) {
+            g_direct_run = 1;
+            g_tex = tex;
+            g_batches++;
+        }
+        return 0;
+    }
+    if (tex != g_tex) {
+        game_batch_flush();
+        g_tex = tex;
+        g_tex_w = 0;
+        g_tex_h = 0;
+    }
+    if (g_quads + quads > g_quad_cap && game_batch_grow(g_quads + quads) != 0) {
+        game_batch_flush();
+        if (quads > g_quad_cap) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void game_batch_begin(void)
+{
+    g_quads = 0;
+    g_tex = NULL;
+    g_tex_w = 0;
+    g_tex_h = 0;
+    g_direct_run = 0;
+    g_batches = 0;
+    g_calls = 0;
+    g_geometry = g_backend->render_geometry(NULL, NULL, 0, NULL, 0) == 0;
+}
+
+void game_batch_end(void)
+{
+    game_batch_flush();
+    g_tex = NULL;
+    g_direct_run = 0;
+}
+
+void game_batch_write_quad(BackendVertex* v, float x, float y, float w, float h, Color color,
+                           float u0, float v0, float u1, float v1)
+{
+    v[0].x = x;
+    v[0].y = y;
+    v[0].u = u0;
+    v[0].v = v0;
+    v[1].x = x + w;
+    v[1].y = y;
+    v[1].u = u1;
+    v[1].v = v0;
+    v[2].x = x + w;
+    v[2].y = y + h;
+    v[2].u = u1;
+    v[2].v = v1;
+    v[3].x = x;
+    v[3].y = y + h;
+    v[3].u = u0;
+    v[3].v = v1;
+    v[0].color = color;
+    v[1].color = color;
+    v[2].color = color;
+    v[3].color = color;
+}
+
+void game_batch_quad(Texture* tex, const Rect* src, const Rect* dst, Color color)
+{
+    float u0 = 0.0f;
+    float v0 = 0.0f;
+    float u1 = 1.0f;
+    float v1 = 1.0f;
+    if (!dst) {
+        return;
+    }
+    if (!game_batch_use(tex, 1)) {
+        if (tex) {
+            backend_render_text_copy(tex, src, dst);
+        } else {
+            backend_render_fill_rect((Rect*)dst, color);
+        }
+        g_calls++;
+        return;
+    }
+    if (tex && src) {
+        if (g_tex_w <= 0 || g_tex_h <= 0) {
+            if (g_backend->query_texture(tex, NULL, NULL, &g_tex_w, &g_tex_h) != 0 ||
+                g_tex_w <= 0 || g_tex_h <= 0) {
+                g_tex_w = 0;
+                g_tex_h = 0;
+                game_batch_flush();
+                backend_render_text_copy(tex, src, dst);
+                g_calls++;
+                return;
+            }
+        }
+        u0 = (float)src->x / (float)g_tex_w;
+        v0 = (float)src->y / (float)g_tex_h;
+        u1 = (float)(src->x + src->w) / (float)g_tex_w;
+        v1 = (float)(src->y + src->h) / (float)g_tex_h;
+    }
+    game_batch_write_quad(g_verts + g_quads * 4, (float)dst->x, (float)dst->y,
+                          (float)dst->w, (float)dst->h, color, u0, v0, u1, v1);
+    g_quads++;
+}
+
+BackendVertex* game_batch_reserve(Texture* tex, int quads)
+{
+    BackendVertex* v;
+    if (quads <= 0 || !game_batch_use(tex, quads)) {
+        return NULL;
+    }
+    v = g_verts + g_quads * 4;
+    g_quads += quads;
+    return v;
+}
+
+void game_batch_stats(int* batches, int* calls)
+{
+    if (batches) {
+        *batches = g_batches;
+    }
+    if (calls) {
+        *calls = g_calls;
+    }
+}
+
+void game_batch_free(void)
+{
+    free(g_verts);
+    free(g_indices);
+    g_verts = NULL;
+    g_indices = NULL;
+    g_quad_cap = 0;
+    g_quads = 0;
+    g_tex = NULL;
+}
+
+#endif
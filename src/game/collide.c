@@ -4,20 +4,41 @@
 #if YUI_WITH_GAME
 
 #include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
-#define GAME_MAX_TRIGGER_PAIRS 256
+/* Entities touched after the solid index was built are checked on every
+ * query; past this many the index is rebuilt instead. */
+#define GAME_COLLIDE_MAX_TRACKED 256
 
 typedef struct TriggerPair {
     GameEntity* a;
     GameEntity* b;
-    int active;
+    int slot_a;
+    int slot_b;
+    unsigned int gen_a; /* entity generations when the pair was found */
+    unsigned int gen_b;
 } TriggerPair;
 
-static TriggerPair g_prev_pairs[GAME_MAX_TRIGGER_PAIRS];
-static int g_prev_count;
+/* Trigger pairs of one frame plus an open-addressing index over them. */
+typedef struct TriggerPairSet {
+    TriggerPair* pairs;
+    int count;
+    int cap;
+    int* index; /* -1 = empty */
+    int index_size;
+} TriggerPairSet;
+
+static TriggerPairSet g_pair_sets[2];
+static int g_prev_set;
 static GameTriggerFn g_trigger_fn;
 
+static GameSpatialHash g_solid_hash;
+static int g_solid_ready; /* index valid for the current update */
+static int g_in_update;
+static GameSpatialHash g_trigger_hash;
+
 void game_set_trigger_fn(GameTriggerFn fn)
 {
     g_trigger_fn = fn;
@@ -31,10 +52,10 @@ void game_entity_world_aabb(const GameEntity* e, float* out_x, float* out_y,
     if (!e) {
         return;
     }
-    w = e->cw > 0 ? e->cw : e->w;
-    h = e->ch > 0 ? e->ch : e->h;
-    if (out_x) *out_x = e->x + e->cox;
-    if (out_y) *out_y = e->y + e->coy;
+    w = GAME_CW(e) > 0 ? GAME_CW(e) : e->w;
+    h = GAME_CH(e) > 0 ? GAME_CH(e) : e->h;
+    if (out_x) *out_x = GAME_X(e) + GAME_COX(e);
+    if (out_y) *out_y = GAME_Y(e) + GAME_COY(e);
     if (out_w) *out_w = w;
     if (out_h) *out_h = h;
 }
@@ -48,7 +69,7 @@ int game_aabb_overlap(float ax, float ay, float aw, float ah,
 int game_entities_overlap(const GameEntity* a, const GameEntity* b)
 {
     float ax, ay, aw, ah, bx, by, bw, bh;
-    if (!a || !b || !a->alive || !b->alive) {
+    if (!a || !b || !GAME_ALIVE(a) || !GAME_ALIVE(b)) {
         return 0;
     }
     game_entity_world_aabb(a, &ax, &ay, &aw, &ah);
@@ -61,7 +82,7 @@ static int game_entity_vs_solid(GameEntity* e, GameEntity* solid, float* out_nx,
     float ax, ay, aw, ah, bx, by, bw, bh;
     float overlap_x;
     float overlap_y;
-    if (!e || !solid || !solid->solid || solid->trigger) {
+    if (!e || !solid || !GAME_SOLID(solid) || GAME_TRIGGER(solid)) {
         return 0;
     }
     game_entity_world_aabb(e, &ax, &ay, &aw, &ah);
@@ -93,30 +114,126 @@ static int game_entity_vs_solid(GameEntity* e, GameEntity* solid, float* out_nx,
     return 1;
 }
 
+static int collide_is_solid(const GameEntity* e)
+{
+    return GAME_ALIVE(e) && GAME_SOLID(e) && !GAME_TRIGGER(e);
+}
+
+void game_collide_invalidate(void)
+{
+    g_solid_ready = 0;
+}
+
+void game_collide_begin_update(void)
+{
+    g_in_update = 1;
+    g_solid_ready = 0;
+}
+
+void game_collide_end_update(void)
+{
+    g_in_update = 0;
+    g_solid_ready = 0;
+}
+
+/* Spawned, re-acquired or script-moved entity: its old cells in the index
+ * may be stale, so return it from every query until the next rebuild. */
+void game_collide_track(GameEntity* e)
+{
+    if (!e || !g_solid_ready) {
+        return;
+    }
+    if (g_solid_hash.oversized_count >= GAME_COLLIDE_MAX_TRACKED ||
+        game_spatial_add_always(&g_solid_hash, e->slot) != 0) {
+        g_solid_ready = 0;
+    }
+}
+
+/* Candidate solids near the AABB, or NULL (count -1) to scan every entity:
+ * outside game_update nothing tells us which solids moved. */
+static const int* collide_solid_candidates(GameEntity** all, int n, float x, float y,
+                                           float w, float h, int* out_count)
+{
+    *out_count = -1;
+    if (!g_in_update) {
+        return NULL;
+    }
+    if (!g_solid_ready) {
+        if (game_spatial_build(&g_solid_hash, all, n, collide_is_solid) != 0) {
+            return NULL;
+        }
+        g_solid_ready = 1;
+    }
+    return game_spatial_query(&g_solid_hash, x, y, w, h, out_count);
+}
+
+/* Movers only: solids are moved by scripts and never pushed. Runs straight
+ * over the columns; free, dead and solid slots are masked out by selects
+ * rather than skipped, so the loop body has no branches. */
+void game_collide_integrate(int n, float dt)
+{
+    int base;
+    for (base = 0; base < n; base += GAME_ENTITY_CHUNK) {
+        GameEntityColumns* cols = game_entity_columns(base / GAME_ENTITY_CHUNK);
+        int count = n - base < GAME_ENTITY_CHUNK ? n - base : GAME_ENTITY_CHUNK;
+        int j;
+        if (!cols) {
+            continue;
+        }
+        for (j = 0; j < count; j++) {
+            unsigned int f = cols->flags[j];
+            int mover = (f & (GAME_ENTITY_ALIVE | GAME_ENTITY_SOLID)) == GAME_ENTITY_ALIVE;
+            float nx = cols->x[j] + cols->vx[j] * dt;
+            float ny = cols->y[j] + cols->vy[j] * dt;
+            cols->x[j] = mover ? nx : cols->x[j];
+            cols->y[j] = mover ? ny : cols->y[j];
+            cols->flags[j] = mover ? f & ~GAME_ENTITY_GROUNDED : f;
+        }
+    }
+}
+
 void game_move_and_collide(GameEntity* e, float dt)
+{
+    if (!e || !GAME_ALIVE(e) || GAME_SOLID(e)) {
+        return;
+    }
+    GAME_SET_FLAG(e, GAME_ENTITY_GROUNDED, 0);
+    GAME_X(e) += GAME_VX(e) * dt;
+    GAME_Y(e) += GAME_VY(e) * dt;
+    game_collide_resolve_solids(e);
+}
+
+/* Push an already integrated mover out of solids and the tilemap. */
+void game_collide_resolve_solids(GameEntity* e)
 {
     int n = 0;
     GameEntity** all;
-    int i;
+    const int* cand;
+    int cand_count;
+    int k;
     float nx;
     float ny;
-    if (!e || !e->alive || e->solid) {
+    float ax, ay, aw, ah;
+    if (!e || !GAME_ALIVE(e) || GAME_SOLID(e)) {
         return;
     }
-    e->grounded = 0;
-    e->x += e->vx * dt;
-    e->y += e->vy * dt;
-
     all = game_entities(&n);
-    for (i = 0; i < n; i++) {
-        if (!all[i] || !all[i]->alive || all[i] == e || !all[i]->solid) {
+    /* Resolving shifts e by less than its own size, so pad the query by that much. */
+    game_entity_world_aabb(e, &ax, &ay, &aw, &ah);
+    cand = collide_solid_candidates(all, n, ax - aw, ay - ah, aw * 3.0f, ah * 3.0f, &cand_count);
+    if (cand_count < 0) {
+        cand_count = n;
+    }
+    for (k = 0; k < cand_count; k++) {
+        int i = cand ? cand[k] : k;
+        if (i >= n || !all[i] || !GAME_ALIVE(all[i]) || all[i] == e || !GAME_SOLID(all[i])) {
             continue;
         }
         if (game_entity_vs_solid(e, all[i], &nx, &ny)) {
             /* Triggers (bullets): die on solid hit — do not MTV-slide along walls. */
-            if (e->trigger) {
-                e->vx = 0;
-                e->vy = 0;
+            if (GAME_TRIGGER(e)) {
+                GAME_VX(e) = 0;
+                GAME_VY(e) = 0;
                 if (e->pooled || e->prefab[0]) {
                     game_pool_release(e);
                 } else {
@@ -124,90 +241,196 @@ void game_move_and_collide(GameEntity* e, float dt)
                 }
                 return;
             }
-            e->x += nx;
-            e->y += ny;
-            if (ny < 0 && e->vy > 0) {
-                e->vy = 0;
-                e->grounded = 1;
-            } else if (ny > 0 && e->vy < 0) {
-                e->vy = 0;
+            GAME_X(e) += nx;
+            GAME_Y(e) += ny;
+            if (ny < 0 && GAME_VY(e) > 0) {
+                GAME_VY(e) = 0;
+                GAME_SET_FLAG(e, GAME_ENTITY_GROUNDED, 1);
+            } else if (ny > 0 && GAME_VY(e) < 0) {
+                GAME_VY(e) = 0;
             }
             if (nx != 0) {
-                e->vx = 0;
+                GAME_VX(e) = 0;
             }
         }
     }
     game_tilemap_collide(e);
 }
 
-void game_collide_resolve_solids(GameEntity* e, float dt)
+static uint32_t pair_hash(const GameEntity* a, const GameEntity* b)
 {
-    game_move_and_collide(e, dt);
+    uintptr_t lo = (uintptr_t)(a < b ? a : b);
+    uintptr_t hi = (uintptr_t)(a < b ? b : a);
+    uint64_t v = (uint64_t)lo * 0x9E3779B97F4A7C15ULL ^ (uint64_t)hi * 0xC2B2AE3D27D4EB4FULL;
+    return (uint32_t)(v ^ (v >> 29));
 }
 
-static int pair_in_list(GameEntity* a, GameEntity* b, TriggerPair* list, int count)
+/* Storage is reused in place, so a pointer match alone may be a new occupant. */
+static int pair_same(const TriggerPair* p, const TriggerPair* q)
 {
-    int i;
-    for (i = 0; i < count; i++) {
-        if ((list[i].a == a && list[i].b == b) || (list[i].a == b && list[i].b == a)) {
+    return (p->a == q->a && p->gen_a == q->gen_a && p->b == q->b && p->gen_b == q->gen_b) ||
+           (p->a == q->b && p->gen_a == q->gen_b && p->b == q->a && p->gen_b == q->gen_a);
+}
+
+static void pair_set_clear(TriggerPairSet* set)
+{
+    set->count = 0;
+}
+
+static int pair_set_contains(const TriggerPairSet* set, const TriggerPair* q)
+{
+    uint32_t mask;
+    uint32_t h;
+    if (set->count == 0 || !set->index) {
+        return 0;
+    }
+    mask = (uint32_t)(set->index_size - 1);
+    for (h = pair_hash(q->a, q->b) & mask; set->index[h] >= 0; h = (h + 1) & mask) {
+        if (pair_same(&set->pairs[set->index[h]], q)) {
             return 1;
         }
     }
     return 0;
 }
 
+static int pair_set_rehash(TriggerPairSet* set, int size)
+{
+    int* index = (int*)malloc((size_t)size * sizeof(int));
+    int i;
+    if (!index) {
+        return -1;
+    }
+    for (i = 0; i < size; i++) {
+        index[i] = -1;
+    }
+    free(set->index);
+    set->index = index;
+    set->index_size = size;
+    return 0;
+}
+
+static void pair_set_add(TriggerPairSet* set, GameEntity* a, GameEntity* b, int slot_a, int slot_b)
+{
+    uint32_t mask;
+    uint32_t h;
+    if (set->count >= set->cap) {
+        int cap = set->cap > 0 ? set->cap * 2 : 64;
+        TriggerPair* grown = (TriggerPair*)realloc(set->pairs, (size_t)cap * sizeof(TriggerPair));
+        if (!grown) {
+            return;
+        }
+        set->pairs = grown;
+        set->cap = cap;
+    }
+    if ((set->count + 1) * 2 > set->index_size) {
+        int size = set->index_size > 0 ? set->index_size * 2 : 128;
+        if (pair_set_rehash(set, size) != 0) {
+            return;
+        }
+        for (h = 0; h < (uint32_t)set->count; h++) {
+            const TriggerPair* p = &set->pairs[h];
+            uint32_t pos = pair_hash(p->a, p->b) & (uint32_t)(size - 1);
+            while (set->index[pos] >= 0) {
+                pos = (pos + 1) & (uint32_t)(size - 1);
+            }
+            set->index[pos] = (int)h;
+        }
+    } else if (set->count == 0) {
+        memset(set->index, 0xff, (size_t)set->index_size * sizeof(int));
+    }
+    mask = (uint32_t)(set->index_size - 1);
+    h = pair_hash(a, b) & mask;
+    while (set->index[h] >= 0) {
+        h = (h + 1) & mask;
+    }
+    set->index[h] = set->count;
+    set->pairs[set->count].a = a;
+    set->pairs[set->count].b = b;
+    set->pairs[set->count].slot_a = slot_a;
+    set->pairs[set->count].slot_b = slot_b;
+    set->pairs[set->count].gen_a = a->gen;
+    set->pairs[set->count].gen_b = b->gen;
+    set->count++;
+}
+
+/* Callbacks may destroy, pool or respawn entities; a reused slot keeps the
+ * pointer but not the generation. */
+static int pair_live(const TriggerPair* p)
+{
+    int n = 0;
+    GameEntity** all = game_entities(&n);
+    return p->slot_a < n && p->slot_b < n &&
+           all[p->slot_a] == p->a && all[p->slot_b] == p->b &&
+           p->a->gen == p->gen_a && p->b->gen == p->gen_b &&
+           GAME_ALIVE(p->a) && GAME_ALIVE(p->b);
+}
+
+static int trigger_hash_filter(const GameEntity* e)
+{
+    return GAME_ALIVE(e);
+}
+
 void game_trigger_update(void)
 {
-    TriggerPair cur[GAME_MAX_TRIGGER_PAIRS];
-    int cur_count = 0;
+    TriggerPairSet* cur = &g_pair_sets[g_prev_set ^ 1];
+    TriggerPairSet* prev = &g_pair_sets[g_prev_set];
     int n = 0;
-    int i, j;
+    int i, k;
+    int have_trigger = 0;
     GameEntity** all = game_entities(&n);
 
-    for (i = 0; i < n; i++) {
-        if (!all[i] || !all[i]->alive || !all[i]->trigger) {
-            continue;
-        }
-        for (j = 0; j < n; j++) {
-            if (i == j || !all[j] || !all[j]->alive) {
-                continue;
-            }
-            /* Only emit once per unordered pair; prefer trigger entity as a */
-            if (j < i && all[j]->trigger) {
-                continue;
-            }
-            if (!game_entities_overlap(all[i], all[j])) {
+    pair_set_clear(cur);
+    for (i = 0; i < n && !have_trigger; i++) {
+        have_trigger = all[i] && GAME_ALIVE(all[i]) && GAME_TRIGGER(all[i]);
+    }
+    if (have_trigger && game_spatial_build(&g_trigger_hash, all, n, trigger_hash_filter) == 0) {
+        for (i = 0; i < n; i++) {
+            const int* cand;
+            int cand_count = 0;
+            float x, y, w, h;
+            if (!all[i] || !GAME_ALIVE(all[i]) || !GAME_TRIGGER(all[i])) {
                 continue;
             }
-            if (cur_count < GAME_MAX_TRIGGER_PAIRS) {
-                cur[cur_count].a = all[i];
-                cur[cur_count].b = all[j];
-                cur[cur_count].active = 1;
-                cur_count++;
+            game_entity_world_aabb(all[i], &x, &y, &w, &h);
+            cand = game_spatial_query(&g_trigger_hash, x, y, w, h, &cand_count);
+            for (k = 0; k < cand_count; k++) {
+                int j = cand[k];
+                if (i == j || !all[j] || !GAME_ALIVE(all[j])) {
+                    continue;
+                }
+                /* Only emit once per unordered pair; prefer trigger entity as a */
+                if (j < i && GAME_TRIGGER(all[j])) {
+                    continue;
+                }
+                if (!game_entities_overlap(all[i], all[j])) {
+                    continue;
+                }
+                pair_set_add(cur, all[i], all[j], i, j);
             }
         }
     }
 
     if (g_trigger_fn) {
-        for (i = 0; i < cur_count; i++) {
-            if (pair_in_list(cur[i].a, cur[i].b, g_prev_pairs, g_prev_count)) {
-                g_trigger_fn(cur[i].a, cur[i].b, GAME_TRIGGER_STAY);
+        for (i = 0; i < cur->count; i++) {
+            TriggerPair* p = &cur->pairs[i];
+            if (!pair_live(p)) {
+                continue;
+            }
+            if (pair_set_contains(prev, p)) {
+                g_trigger_fn(p->a, p->b, GAME_TRIGGER_STAY);
             } else {
-                g_trigger_fn(cur[i].a, cur[i].b, GAME_TRIGGER_ENTER);
+                g_trigger_fn(p->a, p->b, GAME_TRIGGER_ENTER);
             }
         }
-        for (i = 0; i < g_prev_count; i++) {
-            if (!pair_in_list(g_prev_pairs[i].a, g_prev_pairs[i].b, cur, cur_count)) {
-                if (g_prev_pairs[i].a && g_prev_pairs[i].a->alive &&
-                    g_prev_pairs[i].b && g_prev_pairs[i].b->alive) {
-                    g_trigger_fn(g_prev_pairs[i].a, g_prev_pairs[i].b, GAME_TRIGGER_EXIT);
-                }
+        for (i = 0; i < prev->count; i++) {
+            TriggerPair* p = &prev->pairs[i];
+            if (!pair_set_contains(cur, p) && pair_live(p)) {
+                g_trigger_fn(p->a, p->b, GAME_TRIGGER_EXIT);
             }
         }
     }
 
-    memcpy(g_prev_pairs, cur, sizeof(TriggerPair) * (size_t)cur_count);
-    g_prev_count = cur_count;
+    g_prev_set ^= 1;
 }
 
 #endif
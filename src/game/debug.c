@@ -74,7 +74,7 @@ static void game_debug_dump_entities(void)
     for (i = 0; i < n; i++) {
         GameEntity* e = all[i];
         float cx, cy, cw, ch;
-        if (!e || !e->alive) {
+        if (!e || !GAME_ALIVE(e)) {
             continue;
         }
         game_entity_world_aabb(e, &cx, &cy, &cw, &ch);
@@ -83,13 +83,13 @@ static void game_debug_dump_entities(void)
                "pos=(%.1f,%.1f) grounded=%d\n",
                e->id[0] ? e->id : "(none)",
                e->tag[0] ? e->tag : "-",
-               e->solid, e->trigger,
+               GAME_SOLID(e), GAME_TRIGGER(e),
                e->w, e->h,
-               cw, ch, e->cox, e->coy,
-               e->x, e->y, e->grounded);
-        if (e->solid && e->cw > 0.0f && e->w != e->cw) {
-            printf("  !! MISMATCH id=%s  e->w=%.1f  e->cw=%.1f (display vs hitbox)\n",
-                   e->id[0] ? e->id : "?", e->w, e->cw);
+               cw, ch, GAME_COX(e), GAME_COY(e),
+               GAME_X(e), GAME_Y(e), GAME_GROUNDED(e));
+        if (GAME_SOLID(e) && GAME_CW(e) > 0.0f && e->w != GAME_CW(e)) {
+            printf("  !! MISMATCH id=%s  e->w=%.1f  cw=%.1f (display vs hitbox)\n",
+                   e->id[0] ? e->id : "?", e->w, GAME_CW(e));
         }
     }
     printf("[game-debug] ------------------------\n");
@@ -130,12 +130,12 @@ void game_debug_render(void)
         Color sprite_c = {0, 200, 255, 255};
         Color hit_c;
         char label[128];
-        if (!e || !e->alive) {
+        if (!e || !GAME_ALIVE(e)) {
             continue;
         }
 
         /* cyan = true e->w/h (what size field holds; may differ from draw) */
-        game_camera_world_to_screen(e->x, e->y, &sx, &sy);
+        game_camera_world_to_screen(GAME_X(e), GAME_Y(e), &sx, &sy);
         sprite_r.x = (int)sx;
         sprite_r.y = (int)sy;
         sprite_r.w = (int)(e->w > 0 ? e->w : 1);
@@ -149,9 +149,9 @@ void game_debug_render(void)
         hit_r.y = (int)sy;
         hit_r.w = (int)(hw > 0 ? hw : 1);
         hit_r.h = (int)(hh > 0 ? hh : 1);
-        if (e->solid) {
+        if (GAME_SOLID(e)) {
             hit_c = (Color){50, 255, 80, 255};
-        } else if (e->trigger) {
+        } else if (GAME_TRIGGER(e)) {
             hit_c = (Color){255, 220, 50, 255};
         } else {
             hit_c = (Color){255, 80, 80, 255};
@@ -160,7 +160,7 @@ void game_debug_render(void)
 
         snprintf(label, sizeof(label), "%s  sw=%.0fx%.0f hw=%.0fx%.0f",
                  e->id[0] ? e->id : "?", e->w, e->h, hw, hh);
-        game_debug_draw_label(e->x, e->y, label, hit_c);
+        game_debug_draw_label(GAME_X(e), GAME_Y(e), label, hit_c);
     }
 }
 
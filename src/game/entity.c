@@ -3,93 +3,296 @@
 
 #if YUI_WITH_GAME
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static GameEntity *g_entities[GAME_MAX_ENTITIES]; /* NULL = free slot */
+/* Entities live in fixed chunks so pointers stay valid while the table grows
+ * and a pass over the table walks memory in order. Slot i always maps to the
+ * same storage and column index; g_entities[i] is NULL while the slot is free. */
+
+static GameEntity **g_entities; /* NULL = free slot */
+static int g_entity_cap;
 static int g_entity_count; /* high-water for iteration */
+static int g_entity_free_hint; /* no NULL slot below this index */
+static GameEntity **g_chunks;
+static GameEntityColumns **g_col_chunks; /* hot fields of g_chunks[c] */
+static int g_chunk_count;
+static int *g_find_scratch; /* game_find_all_by_tag: matching slots */
+static int g_find_scratch_cap;
+static GameEntityReleaseFn g_release_fn;
+static GameEntityScriptFn g_script_fn;
+
+#define ENTITY_LINK(e, off) ((int *)((char *)(e) + (off)))
+#define ID_LINKS offsetof(GameEntity, id_prev), offsetof(GameEntity, id_next)
+#define TAG_LINKS offsetof(GameEntity, tag_prev), offsetof(GameEntity, tag_next)
+#define POOL_LINKS offsetof(GameEntity, pool_prev), offsetof(GameEntity, pool_next)
+
+static void entity_notify_release(GameEntity *e)
+{
+    if (g_release_fn && e) {
+        g_release_fn(e);
+    }
+}
+
+void game_set_entity_release_fn(GameEntityReleaseFn fn)
+{
+    g_release_fn = fn;
+}
+
+void game_set_entity_script_fn(GameEntityScriptFn fn)
+{
+    g_script_fn = fn;
+}
 
 static int entity_slot_of(const GameEntity *e)
 {
-    int i;
-    if (!e) {
+    if (!e || e->slot < 0 || e->slot >= g_entity_count || g_entities[e->slot] != e) {
         return -1;
     }
-    for (i = 0; i < GAME_MAX_ENTITIES; i++) {
-        if (g_entities[i] == e) {
-            return i;
+    return e->slot;
+}
+
+/* Per-name lists are doubly linked through entity slots, newest first. */
+static void entity_link(int *head, GameEntity *e, size_t prev_off, size_t next_off)
+{
+    *ENTITY_LINK(e, prev_off) = -1;
+    *ENTITY_LINK(e, next_off) = *head;
+    if (*head >= 0) {
+        *ENTITY_LINK(g_entities[*head], prev_off) = e->slot;
+    }
+    *head = e->slot;
+}
+
+static void entity_unlink(int *head, GameEntity *e, size_t prev_off, size_t next_off)
+{
+    int prev = *ENTITY_LINK(e, prev_off);
+    int next = *ENTITY_LINK(e, next_off);
+    if (prev >= 0) {
+        *ENTITY_LINK(g_entities[prev], next_off) = next;
+    } else if (*head == e->slot) {
+        *head = next;
+    }
+    if (next >= 0) {
+        *ENTITY_LINK(g_entities[next], prev_off) = prev;
+    }
+    *ENTITY_LINK(e, prev_off) = -1;
+    *ENTITY_LINK(e, next_off) = -1;
+}
+
+static void entity_unlink_all(GameEntity *e)
+{
+    if (!e->id) {
+        return; /* storage never initialised */
+    }
+    entity_unlink(&game_name_of(e->id)->id_head, e, ID_LINKS);
+    entity_unlink(&game_name_of(e->tag)->tag_head, e, TAG_LINKS);
+    if (e->pooled) {
+        entity_unlink(&game_name_of(e->prefab)->pool_head, e, POOL_LINKS);
+    }
+}
+
+/* Reset storage to an unnamed, dead entity that is in no list. */
+static int entity_scrub(GameEntity *e, int slot)
+{
+    const char *empty = game_intern("");
+    unsigned int gen = e->gen;
+    GameEntityColumns *cols = e->cols;
+    int col = e->col;
+    entity_unlink_all(e);
+    free(e->anim);
+    memset(e, 0, sizeof(GameEntity));
+    e->cols = cols;
+    e->col = col;
+    cols->x[col] = 0;
+    cols->y[col] = 0;
+    cols->vx[col] = 0;
+    cols->vy[col] = 0;
+    cols->cw[col] = 0;
+    cols->ch[col] = 0;
+    cols->cox[col] = 0;
+    cols->coy[col] = 0;
+    cols->flags[col] = 0;
+    e->gen = gen + 1;
+    e->slot = slot;
+    e->id_prev = e->id_next = -1;
+    e->tag_prev = e->tag_next = -1;
+    e->pool_prev = e->pool_next = -1;
+    if (!empty) {
+        return -1;
+    }
+    e->id = empty;
+    e->tag = empty;
+    e->script = empty;
+    e->prefab = empty;
+    e->sprite_path = empty;
+    return 0;
+}
+
+static GameEntity *entity_storage(int i)
+{
+    int c = i / GAME_ENTITY_CHUNK;
+    if (c >= g_chunk_count) {
+        int count = g_chunk_count > 0 ? g_chunk_count * 2 : 4;
+        GameEntity **grown;
+        GameEntityColumns **grown_cols;
+        while (count <= c) {
+            count *= 2;
+        }
+        grown = realloc(g_chunks, (size_t)count * sizeof(GameEntity *));
+        if (!grown) {
+            return NULL;
+        }
+        memset(grown + g_chunk_count, 0, (size_t)(count - g_chunk_count) * sizeof(GameEntity *));
+        g_chunks = grown;
+        grown_cols = realloc(g_col_chunks, (size_t)count * sizeof(GameEntityColumns *));
+        if (!grown_cols) {
+            return NULL;
+        }
+        memset(grown_cols + g_chunk_count, 0,
+               (size_t)(count - g_chunk_count) * sizeof(GameEntityColumns *));
+        g_col_chunks = grown_cols;
+        g_chunk_count = count;
+    }
+    if (!g_chunks[c]) {
+        GameEntity *chunk = calloc(GAME_ENTITY_CHUNK, sizeof(GameEntity));
+        GameEntityColumns *cols = calloc(1, sizeof(GameEntityColumns));
+        int k;
+        if (!chunk || !cols) {
+            free(chunk);
+            free(cols);
+            return NULL;
         }
+        for (k = 0; k < GAME_ENTITY_CHUNK; k++) {
+            chunk[k].cols = cols;
+            chunk[k].col = k;
+        }
+        g_chunks[c] = chunk;
+        g_col_chunks[c] = cols;
+    }
+    return &g_chunks[c][i % GAME_ENTITY_CHUNK];
+}
+
+GameEntityColumns *game_entity_columns(int chunk)
+{
+    if (chunk < 0 || chunk >= g_chunk_count) {
+        return NULL;
+    }
+    return g_col_chunks[chunk];
+}
+
+static int entity_table_grow(void)
+{
+    int cap = g_entity_cap > 0 ? g_entity_cap * 2 : 128;
+    GameEntity **grown;
+    if (GAME_MAX_ENTITIES > 0) {
+        if (g_entity_cap >= GAME_MAX_ENTITIES) {
+            return -1;
+        }
+        if (cap > GAME_MAX_ENTITIES) {
+            cap = GAME_MAX_ENTITIES;
+        }
+    }
+    grown = realloc(g_entities, (size_t)cap * sizeof(GameEntity *));
+    if (!grown) {
+        return -1;
+    }
+    memset(grown + g_entity_cap, 0, (size_t)(cap - g_entity_cap) * sizeof(GameEntity *));
+    g_entities = grown;
+    g_entity_cap = cap;
+    return 0;
+}
+
+static GameEntity *entity_reset_slot(int i)
+{
+    GameEntity *e = g_entities[i] ? g_entities[i] : entity_storage(i);
+    if (!e) {
+        return NULL;
+    }
+    /* Any binding still pointing at this slot belongs to the previous occupant. */
+    if (g_entities[i]) {
+        entity_notify_release(e);
+    }
+    if (entity_scrub(e, i) != 0) {
+        g_entities[i] = NULL;
+        return NULL;
+    }
+    g_entities[i] = e;
+    GAME_SET_FLAG(e, GAME_ENTITY_ALIVE, 1);
+    /* skip trace on fresh alloc defaults */
+    e->w = 16;
+    e->h = 16;
+    e->color = (Color){200, 200, 200, 255};
+    entity_link(&game_name_of(e->id)->id_head, e, ID_LINKS);
+    entity_link(&game_name_of(e->tag)->tag_head, e, TAG_LINKS);
+    if (i + 1 > g_entity_count) {
+        g_entity_count = i + 1;
     }
-    return -1;
+    game_collide_track(e);
+    return e;
 }
 
 void game_entity_pool_init(void)
 {
-    memset(g_entities, 0, sizeof(g_entities));
-    g_entity_count = 0;
+    game_entity_pool_free();
 }
 
 void game_entity_pool_clear(void)
 {
     int i;
-    for (i = 0; i < GAME_MAX_ENTITIES; i++) {
+    for (i = 0; i < g_entity_count; i++) {
         if (g_entities[i]) {
-            if (g_entities[i]->alive && g_entities[i]->texture) {
-                g_entities[i]->texture = NULL;
-            }
-            free(g_entities[i]);
+            entity_notify_release(g_entities[i]);
+            entity_scrub(g_entities[i], i);
             g_entities[i] = NULL;
         }
     }
     g_entity_count = 0;
+    g_entity_free_hint = 0;
+    game_collide_invalidate();
 }
 
 void game_entity_pool_free(void)
 {
     int i;
-    for (i = 0; i < GAME_MAX_ENTITIES; i++) {
-        free(g_entities[i]);
-        g_entities[i] = NULL;
+    game_entity_pool_clear();
+    for (i = 0; i < g_chunk_count; i++) {
+        free(g_chunks[i]);
+        free(g_col_chunks[i]);
     }
-    g_entity_count = 0;
+    free(g_chunks);
+    g_chunks = NULL;
+    free(g_col_chunks);
+    g_col_chunks = NULL;
+    g_chunk_count = 0;
+    free(g_entities);
+    g_entities = NULL;
+    g_entity_cap = 0;
+    free(g_find_scratch);
+    g_find_scratch = NULL;
+    g_find_scratch_cap = 0;
+    game_names_free();
 }
 
 GameEntity* game_entity_alloc(void)
 {
     int i;
-    for (i = 0; i < GAME_MAX_ENTITIES; i++) {
-        if (!g_entities[i] || (!g_entities[i]->alive && !g_entities[i]->pooled)) {
-            if (!g_entities[i]) {
-                g_entities[i] = calloc(1, sizeof(GameEntity));
-                if (!g_entities[i]) {
-                    return NULL;
-                }
-            }
-            memset(g_entities[i], 0, sizeof(GameEntity));
-            g_entities[i]->alive = 1;
-            /* skip trace on fresh alloc defaults */
-            g_entities[i]->w = 16;
-            g_entities[i]->h = 16;
-            g_entities[i]->color = (Color){200, 200, 200, 255};
-            if (i + 1 > g_entity_count) {
-                g_entity_count = i + 1;
-            }
-            return g_entities[i];
+    int old_cap = g_entity_cap;
+    for (i = g_entity_free_hint; i < g_entity_cap; i++) {
+        if (!g_entities[i] || (!GAME_ALIVE(g_entities[i]) && !g_entities[i]->pooled)) {
+            g_entity_free_hint = i + 1;
+            return entity_reset_slot(i);
         }
     }
-    /* Also reclaim pooled slots if needed */
-    for (i = 0; i < GAME_MAX_ENTITIES; i++) {
-        if (g_entities[i] && !g_entities[i]->alive) {
-            memset(g_entities[i], 0, sizeof(GameEntity));
-            g_entities[i]->alive = 1;
-            g_entities[i]->w = 16;
-            g_entities[i]->h = 16;
-            g_entities[i]->color = (Color){200, 200, 200, 255};
-            if (i + 1 > g_entity_count) {
-                g_entity_count = i + 1;
-            }
-            return g_entities[i];
+    if (entity_table_grow() == 0) {
+        g_entity_free_hint = old_cap + 1;
+        return entity_reset_slot(old_cap);
+    }
+    /* At the cap: reclaim pooled slots */
+    for (i = 0; i < g_entity_cap; i++) {
+        if (g_entities[i] && !GAME_ALIVE(g_entities[i])) {
+            return entity_reset_slot(i);
         }
     }
     return NULL;
@@ -105,8 +308,60 @@ void game_entity_free(GameEntity* e)
     if (slot < 0) {
         return;
     }
-    free(g_entities[slot]);
+    entity_notify_release(e);
+    /* Storage stays in its chunk; stale pointers read a dead, unnamed entity. */
+    entity_scrub(e, -1);
     g_entities[slot] = NULL;
+    if (slot < g_entity_free_hint) {
+        g_entity_free_hint = slot;
+    }
+}
+
+void game_entity_set_id(GameEntity* e, const char* id)
+{
+    const char* name = game_intern(id);
+    if (!name || entity_slot_of(e) < 0 || name == e->id) {
+        return;
+    }
+    entity_unlink(&game_name_of(e->id)->id_head, e, ID_LINKS);
+    e->id = name;
+    entity_link(&game_name_of(name)->id_head, e, ID_LINKS);
+}
+
+void game_entity_set_tag(GameEntity* e, const char* tag)
+{
+    const char* name = game_intern(tag);
+    if (!name || entity_slot_of(e) < 0 || name == e->tag) {
+        return;
+    }
+    entity_unlink(&game_name_of(e->tag)->tag_head, e, TAG_LINKS);
+    e->tag = name;
+    entity_link(&game_name_of(name)->tag_head, e, TAG_LINKS);
+}
+
+void game_entity_set_script(GameEntity* e, const char* script)
+{
+    const char* name = game_intern(script);
+    if (!name || entity_slot_of(e) < 0 || name == e->script) {
+        return;
+    }
+    e->script = name;
+    if (g_script_fn) {
+        g_script_fn(e);
+    }
+}
+
+void game_entity_set_prefab(GameEntity* e, const char* prefab)
+{
+    const char* name = game_intern(prefab);
+    if (!name || entity_slot_of(e) < 0 || name == e->prefab) {
+        return;
+    }
+    if (e->pooled) {
+        entity_unlink(&game_name_of(e->prefab)->pool_head, e, POOL_LINKS);
+        entity_link(&game_name_of(name)->pool_head, e, POOL_LINKS);
+    }
+    e->prefab = name;
 }
 
 GameEntity* game_spawn(const char* id)
@@ -116,8 +371,7 @@ GameEntity* game_spawn(const char* id)
         return NULL;
     }
     if (id && id[0]) {
-        strncpy(e->id, id, GAME_ID_LEN - 1);
-        e->id[GAME_ID_LEN - 1] = '\0';
+        game_entity_set_id(e, id);
     }
     return e;
 }
@@ -135,50 +389,76 @@ void game_destroy_by_id(const char* id)
     }
 }
 
-GameEntity* game_find(const char* id)
+/* Lowest live slot in a name list, matching the old full-table scan order. */
+static GameEntity* entity_first_alive(int head, size_t next_off)
 {
+    GameEntity* best = NULL;
     int i;
-    if (!id) {
-        return NULL;
-    }
-    for (i = 0; i < g_entity_count; i++) {
-        if (g_entities[i] && g_entities[i]->alive &&
-            strcmp(g_entities[i]->id, id) == 0) {
-            return g_entities[i];
+    for (i = head; i >= 0; i = *ENTITY_LINK(g_entities[i], next_off)) {
+        if (GAME_ALIVE(g_entities[i]) && (!best || i < best->slot)) {
+            best = g_entities[i];
         }
     }
-    return NULL;
+    return best;
 }
 
-GameEntity* game_find_by_tag(const char* tag)
+GameEntity* game_find(const char* id)
 {
-    int i;
-    if (!tag) {
+    GameName* name = game_name_lookup(id);
+    if (!name) {
         return NULL;
     }
-    for (i = 0; i < g_entity_count; i++) {
-        if (g_entities[i] && g_entities[i]->alive &&
-            strcmp(g_entities[i]->tag, tag) == 0) {
-            return g_entities[i];
-        }
+    return entity_first_alive(name->id_head, offsetof(GameEntity, id_next));
+}
+
+GameEntity* game_find_by_tag(const char* tag)
+{
+    GameName* name = game_name_lookup(tag);
+    if (!name) {
+        return NULL;
     }
-    return NULL;
+    return entity_first_alive(name->tag_head, offsetof(GameEntity, tag_next));
+}
+
+static int entity_slot_cmp(const void* a, const void* b)
+{
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    return (ia > ib) - (ia < ib);
 }
 
 int game_find_all_by_tag(const char* tag, GameEntity** out, int max_out)
 {
+    GameName* name = game_name_lookup(tag);
+    int count = 0;
     int i;
-    int n = 0;
-    if (!tag || !out || max_out <= 0) {
+    if (!name || !out || max_out <= 0) {
         return 0;
     }
-    for (i = 0; i < g_entity_count && n < max_out; i++) {
-        if (g_entities[i] && g_entities[i]->alive &&
-            strcmp(g_entities[i]->tag, tag) == 0) {
-            out[n++] = g_entities[i];
+    for (i = name->tag_head; i >= 0; i = g_entities[i]->tag_next) {
+        if (!GAME_ALIVE(g_entities[i])) {
+            continue;
+        }
+        if (count >= g_find_scratch_cap) {
+            int cap = g_find_scratch_cap > 0 ? g_find_scratch_cap * 2 : 64;
+            int* grown = realloc(g_find_scratch, (size_t)cap * sizeof(int));
+            if (!grown) {
+                break;
+            }
+            g_find_scratch = grown;
+            g_find_scratch_cap = cap;
         }
+        g_find_scratch[count++] = i;
     }
-    return n;
+    /* Slot order, as callers got from the old table scan */
+    qsort(g_find_scratch, (size_t)count, sizeof(int), entity_slot_cmp);
+    if (count > max_out) {
+        count = max_out;
+    }
+    for (i = 0; i < count; i++) {
+        out[i] = g_entities[g_find_scratch[i]];
+    }
+    return count;
 }
 
 GameEntity** game_entities(int* out_count)
@@ -191,44 +471,48 @@ GameEntity** game_entities(int* out_count)
 
 GameEntity* game_pool_acquire(const char* prefab)
 {
-    int i;
+    GameName* name;
     GameEntity* e;
     if (!prefab || !prefab[0]) {
         return game_spawn(NULL);
     }
-    for (i = 0; i < g_entity_count; i++) {
-        if (g_entities[i] && !g_entities[i]->alive && g_entities[i]->pooled &&
-            strcmp(g_entities[i]->prefab, prefab) == 0) {
-            e = g_entities[i];
-            e->alive = 1;
-            e->pooled = 0;
-            e->vx = 0;
-            e->vy = 0;
-            e->grounded = 0;
-            return e;
-        }
+    name = game_name_lookup(prefab);
+    if (name && name->pool_head >= 0) {
+        e = g_entities[name->pool_head];
+        entity_unlink(&name->pool_head, e, POOL_LINKS);
+        GAME_SET_FLAG(e, GAME_ENTITY_ALIVE, 1);
+        e->pooled = 0;
+        GAME_VX(e) = 0;
+        GAME_VY(e) = 0;
+        GAME_SET_FLAG(e, GAME_ENTITY_GROUNDED, 0);
+        game_collide_track(e);
+        return e;
     }
     e = game_spawn(NULL);
     if (e) {
-        strncpy(e->prefab, prefab, GAME_ID_LEN - 1);
-        e->prefab[GAME_ID_LEN - 1] = '\0';
-        strncpy(e->tag, prefab, GAME_ID_LEN - 1);
+        game_entity_set_prefab(e, prefab);
+        game_entity_set_tag(e, prefab);
     }
     return e;
 }
 
 void game_pool_release(GameEntity* e)
 {
-    if (!e) {
+    if (!e || entity_slot_of(e) < 0) {
         return;
     }
     if (!e->prefab[0] && e->tag[0]) {
-        strncpy(e->prefab, e->tag, GAME_ID_LEN - 1);
+        game_entity_set_prefab(e, e->tag);
+    }
+    entity_notify_release(e);
+    GAME_SET_FLAG(e, GAME_ENTITY_ALIVE, 0);
+    e->gen++;
+    GAME_VX(e) = 0;
+    GAME_VY(e) = 0;
+    if (!e->pooled) {
+        e->pooled = 1;
+        entity_link(&game_name_of(e->prefab)->pool_head, e, POOL_LINKS);
     }
-    e->alive = 0;
-    e->pooled = 1;
-    e->vx = 0;
-    e->vy = 0;
 }
 
 #endif
@@ -4,6 +4,7 @@
 #if YUI_WITH_GAME
 
 #include "../event.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -12,7 +13,16 @@ static int g_enabled = 1;
 static int g_paused;
 static int g_focus_seen;
 static GameScriptUpdateFn g_script_update;
+static GameScriptBatchFn g_script_batch;
+static GameEntity** g_batch; /* scripted entities handed to g_script_batch */
+static int g_batch_cap;
 static int g_entity_draws;
+static GameEntity** g_sorted; /* draw order scratch, grows with the entity table */
+static int g_sorted_cap;
+/* Texture -> draw group, open addressing; rebuilt every render */
+static Texture** g_group_keys;
+static int* g_group_ids;
+static int g_group_cap;
 
 static void game_on_window_event(const WindowEvent* event)
 {
@@ -50,6 +60,9 @@ void game_init(void)
     game_particles_clear();
     game_audio_init();
     g_script_update = NULL;
+    g_script_batch = NULL;
+    game_set_entity_release_fn(NULL);
+    game_set_entity_script_fn(NULL);
     g_enabled = 1;
     g_paused = 0;
     g_focus_seen = 0;
@@ -64,8 +77,22 @@ void game_shutdown(void)
     }
     unregister_window_event_listener(game_on_window_event);
     game_clear_scene();
+    game_entity_pool_free();
+    game_particles_free();
+    game_batch_free();
     game_audio_shutdown();
     g_script_update = NULL;
+    g_script_batch = NULL;
+    game_set_entity_release_fn(NULL);
+    game_set_entity_script_fn(NULL);
+    free(g_batch);
+    g_batch = NULL;
+    g_batch_cap = 0;
+    free(g_group_keys);
+    free(g_group_ids);
+    g_group_keys = NULL;
+    g_group_ids = NULL;
+    g_group_cap = 0;
     g_paused = 0;
     g_inited = 0;
 }
@@ -102,13 +129,98 @@ void game_set_script_update_fn(GameScriptUpdateFn fn)
     g_script_update = fn;
 }
 
+void game_set_script_batch_fn(GameScriptBatchFn fn)
+{
+    g_script_batch = fn;
+}
+
+/* Returns nonzero when the batch callback took over this frame's scripts. */
+static int game_run_script_batch(GameEntity** all, int n, float dt)
+{
+    int i;
+    int count = 0;
+    if (!g_script_batch) {
+        return 0;
+    }
+    if (n > g_batch_cap) {
+        GameEntity** grown = realloc(g_batch, (size_t)n * sizeof(GameEntity*));
+        if (!grown) {
+            return 0;
+        }
+        g_batch = grown;
+        g_batch_cap = n;
+    }
+    for (i = 0; i < n; i++) {
+        if (all[i] && GAME_ALIVE(all[i]) && all[i]->script[0]) {
+            g_batch[count++] = all[i];
+        }
+    }
+    return g_script_batch(g_batch, count, dt);
+}
+
+/* Number each texture by the first slot that uses it (solid color is 0).
+ * Sorting equal z by this keeps each texture in one run like sorting by
+ * pointer would, but the run order no longer depends on heap addresses. */
+static void game_assign_draw_groups(GameEntity** sorted, int count)
+{
+    int next = 1;
+    int cap = g_group_cap;
+    int i;
+    if (cap < count * 2) {
+        Texture** keys;
+        int* ids;
+        cap = cap > 0 ? cap : 64;
+        while (cap < count * 2) {
+            cap *= 2;
+        }
+        keys = (Texture**)malloc((size_t)cap * sizeof(Texture*));
+        ids = (int*)malloc((size_t)cap * sizeof(int));
+        if (!keys || !ids) {
+            free(keys);
+            free(ids);
+            for (i = 0; i < count; i++) {
+                sorted[i]->draw_group = sorted[i]->texture ? 1 : 0;
+            }
+            return;
+        }
+        free(g_group_keys);
+        free(g_group_ids);
+        g_group_keys = keys;
+        g_group_ids = ids;
+        g_group_cap = cap;
+    }
+    memset(g_group_keys, 0, (size_t)g_group_cap * sizeof(Texture*));
+    for (i = 0; i < count; i++) {
+        Texture* tex = sorted[i]->texture;
+        unsigned int h;
+        if (!tex) {
+            sorted[i]->draw_group = 0;
+            continue;
+        }
+        h = (unsigned int)(((uintptr_t)tex >> 4) * 2654435761u) & (unsigned int)(g_group_cap - 1);
+        while (g_group_keys[h] && g_group_keys[h] != tex) {
+            h = (h + 1) & (unsigned int)(g_group_cap - 1);
+        }
+        if (!g_group_keys[h]) {
+            g_group_keys[h] = tex;
+            g_group_ids[h] = next++;
+        }
+        sorted[i]->draw_group = g_group_ids[h];
+    }
+}
+
+/* Equal z has no defined order, so group it by texture: each texture run
+ * is one batch. Slot breaks the remaining ties to keep frames stable. */
 static int game_entity_z_cmp(const void* a, const void* b)
 {
     const GameEntity* ea = *(const GameEntity* const*)a;
     const GameEntity* eb = *(const GameEntity* const*)b;
     if (ea->z < eb->z) return -1;
     if (ea->z > eb->z) return 1;
-    return 0;
+    if (ea->draw_group != eb->draw_group) {
+        return ea->draw_group - eb->draw_group;
+    }
+    return ea->slot - eb->slot;
 }
 
 void game_update(float dt_override)
@@ -124,30 +236,41 @@ void game_update(float dt_override)
     game_input_begin_frame();
     dt = dt_override >= 0.0f ? dt_override : game_time_tick();
 
+    game_collide_begin_update();
     all = game_entities(&n);
     {
         int scene_gen = game_scene_generation();
-        for (i = 0; i < n; i++) {
-            GameEntity* e = all[i];
-            if (!e || !e->alive) {
-                continue;
-            }
-            if (g_script_update && e->script[0]) {
+        int limit = n; /* entities spawned this frame start moving next frame */
+        /* Scripts first, then each system as one pass over the table: the
+         * solid index is built after every script has moved its platforms. */
+        if (!game_run_script_batch(all, n, dt) && g_script_update) {
+            for (i = 0; i < limit; i++) {
+                GameEntity* e = all[i];
+                if (!e || !GAME_ALIVE(e) || !e->script[0]) {
+                    continue;
+                }
                 g_script_update(e, dt);
                 /* Script may have reloaded the scene; stop using stale slots. */
                 if (game_scene_generation() != scene_gen) {
                     break;
                 }
+                /* Script spawns may have reallocated the entity table. */
+                all = game_entities(&n);
             }
-            if (!e->alive) {
-                continue;
-            }
-            game_anim_update(e, dt);
-            if (!e->solid) {
-                game_move_and_collide(e, dt);
+        }
+        all = game_entities(&n);
+        if (game_scene_generation() != scene_gen) {
+            limit = 0;
+        }
+        game_anim_step(all, limit, dt);
+        game_collide_integrate(limit, dt);
+        for (i = 0; i < limit; i++) {
+            if (all[i] && GAME_ALIVE(all[i]) && !GAME_SOLID(all[i])) {
+                game_collide_resolve_solids(all[i]);
             }
         }
     }
+    game_collide_end_update();
     game_trigger_update();
     game_particles_update(dt);
     game_camera_update();
@@ -161,7 +284,7 @@ void game_render(void)
     int i;
     int count = 0;
     GameEntity** all;
-    GameEntity* sorted[GAME_MAX_ENTITIES];
+    GameEntity** sorted;
     if (!g_inited || !g_enabled) {
         return;
     }
@@ -169,19 +292,32 @@ void game_render(void)
     g_entity_draws = 0;
     game_tilemap_render();
     all = game_entities(&n);
+    if (n > g_sorted_cap) {
+        GameEntity** grown = realloc(g_sorted, (size_t)n * sizeof(GameEntity*));
+        if (!grown) {
+            game_perf_end_render(0);
+            return;
+        }
+        g_sorted = grown;
+        g_sorted_cap = n;
+    }
+    sorted = g_sorted;
     for (i = 0; i < n; i++) {
-        if (all[i] && all[i]->alive) {
+        if (all[i] && GAME_ALIVE(all[i])) {
             sorted[count++] = all[i];
         }
     }
     if (count > 1) {
+        game_assign_draw_groups(sorted, count);
         qsort(sorted, (size_t)count, sizeof(GameEntity*), game_entity_z_cmp);
     }
+    game_batch_begin();
     for (i = 0; i < count; i++) {
         game_sprite_draw_entity(sorted[i]);
         g_entity_draws++;
     }
     game_particles_render();
+    game_batch_end();
     game_debug_render();
     game_perf_end_render(g_entity_draws);
 }
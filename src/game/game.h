@@ -17,11 +17,13 @@
 extern "C" {
 #endif
 
+/* Entity table and particle arrays grow on demand; a nonzero value caps
+ * them (embedded targets). */
 #ifndef GAME_MAX_ENTITIES
-#define GAME_MAX_ENTITIES 128
+#define GAME_MAX_ENTITIES 0
 #endif
 #ifndef GAME_MAX_PARTICLES
-#define GAME_MAX_PARTICLES 256
+#define GAME_MAX_PARTICLES 0
 #endif
 #ifndef GAME_ID_LEN
 #define GAME_ID_LEN 64
@@ -33,29 +35,65 @@ extern "C" {
 #define GAME_ANIM_FRAMES 16
 #endif
 
+/* Animation frames live outside the entity: most entities never animate. */
+typedef struct GameAnim {
+    char clip[GAME_ID_LEN];
+    float fps;
+    int frame;
+    float t;
+    int frame_count;
+    int frames_x[GAME_ANIM_FRAMES];
+    int frames_y[GAME_ANIM_FRAMES];
+    int frames_w[GAME_ANIM_FRAMES];
+    int frames_h[GAME_ANIM_FRAMES];
+} GameAnim;
+
+/* Entities live in fixed chunks of this many slots (stable pointers). */
+#ifndef GAME_ENTITY_CHUNK
+#if GAME_MAX_ENTITIES > 0 && GAME_MAX_ENTITIES < 256
+#define GAME_ENTITY_CHUNK GAME_MAX_ENTITIES
+#else
+#define GAME_ENTITY_CHUNK 256
+#endif
+#endif
+
+/* Bits of GameEntityColumns.flags */
+#define GAME_ENTITY_ALIVE 0x1u
+#define GAME_ENTITY_SOLID 0x2u
+#define GAME_ENTITY_TRIGGER 0x4u
+#define GAME_ENTITY_GROUNDED 0x8u
+
+/* State read every frame by integration and collision, one column per field
+ * and one element per slot of a chunk, so those passes stream through
+ * contiguous arrays instead of whole entity records. */
+typedef struct GameEntityColumns {
+    float x[GAME_ENTITY_CHUNK];
+    float y[GAME_ENTITY_CHUNK];
+    float vx[GAME_ENTITY_CHUNK];
+    float vy[GAME_ENTITY_CHUNK];
+    float cw[GAME_ENTITY_CHUNK]; /* collider; 0 => use w/h */
+    float ch[GAME_ENTITY_CHUNK];
+    float cox[GAME_ENTITY_CHUNK];
+    float coy[GAME_ENTITY_CHUNK];
+    unsigned int flags[GAME_ENTITY_CHUNK];
+} GameEntityColumns;
+
+/* The rest of an entity, stored back to back in chunks alongside its
+ * columns. Names are interned strings ("" when unset) and only change
+ * through game_entity_set_*. */
 typedef struct GameEntity {
-    int alive;
-    char id[GAME_ID_LEN];
-    char tag[GAME_ID_LEN];
-    char script[GAME_ID_LEN]; /* JS global function name: update(entity, dt) */
-    char prefab[GAME_ID_LEN]; /* pool key */
-    float x;
-    float y;
-    float z;
-    float vx;
-    float vy;
+    GameEntityColumns* cols; /* hot fields: GAME_X(e) etc. */
+    int col;                 /* index into cols, fixed with the storage */
     float w;
     float h;
-    float cw; /* collider; 0 => use w/h */
-    float ch;
-    float cox;
-    float coy;
-    int trigger;
-    int solid;
-    int grounded;
+    float z;
+    int slot; /* index in game_entities(), fixed for the entity's lifetime */
+    /* Bumped whenever the storage changes occupant (free, reuse, pool
+     * release): storage and slot are reused, so (pointer, gen) is the identity. */
+    unsigned int gen;
     int pooled; /* released to pool, not free slot permanently */
+    int draw_group; /* render scratch: texture group used to order equal z */
     Color color;
-    char sprite_path[GAME_PATH_LEN];
     Texture* texture;
     /* sprite sheet frame (source rect in texture) */
     int frame_x;
@@ -63,18 +101,38 @@ typedef struct GameEntity {
     int frame_w;
     int frame_h;
     int use_frame;
-    /* animation */
-    char anim_clip[GAME_ID_LEN];
-    float anim_fps;
-    int anim_frame;
-    float anim_t;
-    int anim_frame_count;
-    int anim_frames_x[GAME_ANIM_FRAMES];
-    int anim_frames_y[GAME_ANIM_FRAMES];
-    int anim_frames_w[GAME_ANIM_FRAMES];
-    int anim_frames_h[GAME_ANIM_FRAMES];
+    const char* id;
+    const char* tag;
+    const char* script; /* JS global function name: update(entity, dt) */
+    const char* prefab; /* pool key */
+    const char* sprite_path;
+    GameAnim* anim; /* NULL until frames or a clip are set */
+    /* lookup lists by name (slots, -1 = end), maintained by entity.c */
+    int id_prev;
+    int id_next;
+    int tag_prev;
+    int tag_next;
+    int pool_prev;
+    int pool_next;
 } GameEntity;
 
+/* Hot fields of an entity as lvalues, e.g. GAME_X(e) += GAME_VX(e) * dt. */
+#define GAME_X(e) ((e)->cols->x[(e)->col])
+#define GAME_Y(e) ((e)->cols->y[(e)->col])
+#define GAME_VX(e) ((e)->cols->vx[(e)->col])
+#define GAME_VY(e) ((e)->cols->vy[(e)->col])
+#define GAME_CW(e) ((e)->cols->cw[(e)->col])
+#define GAME_CH(e) ((e)->cols->ch[(e)->col])
+#define GAME_COX(e) ((e)->cols->cox[(e)->col])
+#define GAME_COY(e) ((e)->cols->coy[(e)->col])
+#define GAME_FLAGS(e) ((e)->cols->flags[(e)->col])
+#define GAME_ALIVE(e) ((GAME_FLAGS(e) & GAME_ENTITY_ALIVE) != 0)
+#define GAME_SOLID(e) ((GAME_FLAGS(e) & GAME_ENTITY_SOLID) != 0)
+#define GAME_TRIGGER(e) ((GAME_FLAGS(e) & GAME_ENTITY_TRIGGER) != 0)
+#define GAME_GROUNDED(e) ((GAME_FLAGS(e) & GAME_ENTITY_GROUNDED) != 0)
+#define GAME_SET_FLAG(e, flag, on) \
+    (GAME_FLAGS(e) = (on) ? (GAME_FLAGS(e) | (flag)) : (GAME_FLAGS(e) & ~(unsigned int)(flag)))
+
 typedef struct GameCamera {
     float x;
     float y;
@@ -85,6 +143,9 @@ typedef struct GamePerfStats {
     int entities;
     int draws;
     int particles;
+    int tile_chunks; /* tilemap chunks drawn (after camera culling) */
+    int batches;     /* sprite/particle texture runs, one geometry call each */
+    int draw_calls;  /* backend draw calls actually issued */
     double fps;
     double update_ms;
     double render_ms;
@@ -97,6 +158,13 @@ typedef enum GameTriggerPhase {
 } GameTriggerPhase;
 
 typedef void (*GameScriptUpdateFn)(GameEntity* entity, float dt);
+/* One call per update with every live scripted entity; return nonzero when
+ * handled, which skips the per-entity GameScriptUpdateFn for this frame. */
+typedef int (*GameScriptBatchFn)(GameEntity** list, int count, float dt);
+/* Entity is being freed, pooled or its slot reused: drop bindings to it. */
+typedef void (*GameEntityReleaseFn)(GameEntity* e);
+/* Entity's script name changed: drop any function resolved for the old one. */
+typedef void (*GameEntityScriptFn)(GameEntity* e);
 typedef void (*GameTriggerFn)(GameEntity* a, GameEntity* b, GameTriggerPhase phase);
 
 void game_init(void);
@@ -117,6 +185,11 @@ GameEntity* game_find(const char* id);
 GameEntity* game_find_by_tag(const char* tag);
 int game_find_all_by_tag(const char* tag, GameEntity** out, int max_out);
 GameEntity** game_entities(int* out_count);
+/* Names are interned and stay valid until game shutdown. */
+void game_entity_set_id(GameEntity* e, const char* id);
+void game_entity_set_tag(GameEntity* e, const char* tag);
+void game_entity_set_script(GameEntity* e, const char* script);
+void game_entity_set_prefab(GameEntity* e, const char* prefab);
 
 /* Object pool: acquire by prefab tag, release back */
 GameEntity* game_pool_acquire(const char* prefab);
@@ -148,8 +221,14 @@ int game_entities_overlap(const GameEntity* a, const GameEntity* b);
 void game_move_and_collide(GameEntity* e, float dt);
 void game_trigger_update(void);
 void game_set_trigger_fn(GameTriggerFn fn);
+/* Solids are indexed once per game_update, after scripts have run; call this
+ * after moving a solid from C while movers are still being resolved. */
+void game_collide_invalidate(void);
 
 void game_set_script_update_fn(GameScriptUpdateFn fn);
+void game_set_script_batch_fn(GameScriptBatchFn fn);
+void game_set_entity_release_fn(GameEntityReleaseFn fn);
+void game_set_entity_script_fn(GameEntityScriptFn fn);
 void game_set_enabled(int on);
 void game_set_paused(int on);
 int game_is_paused(void);
@@ -168,6 +247,16 @@ void game_audio_stop_bgm(void);
 /* Tilemap */
 void game_tilemap_clear(void);
 int game_tilemap_load_from_json(cJSON* node);
+/* Binary map file ("YTM1" + run-length tiles); keeps tile size/tileset. */
+int game_tilemap_load_binary(const char* path);
+int game_tilemap_save_binary(const char* path);
+/* Changing a tile re-bakes only its chunk. get returns -1 outside the map. */
+int game_tilemap_set_tile(int col, int row, int tid);
+int game_tilemap_get_tile(int col, int row);
+/* Baked chunk textures lost their contents (render targets reset): re-bake
+ * on next draw. lost != 0 means the textures themselves are gone (device
+ * reset) and are recreated instead. */
+void game_tilemap_invalidate_chunks(int lost);
 void game_tilemap_render(void);
 void game_tilemap_collide(GameEntity* e);
 /* axis: 0 = X, 1 = Y. prev_top/prev_bottom used for one-way Y tops. */
@@ -17,13 +17,93 @@ void game_entity_pool_free(void);
 GameEntity* game_entity_alloc(void);
 void game_entity_free(GameEntity* e);
 
+/* Interned name record; the string bytes follow it. Heads are entity slots
+ * (-1 = empty) of the per-name lists kept in entity.c. */
+typedef struct GameName {
+    unsigned int hash;
+    int id_head;
+    int tag_head;
+    int pool_head;
+} GameName;
+
+const char* game_intern(const char* s); /* NULL only when out of memory */
+GameName* game_name_lookup(const char* s); /* NULL if never interned */
+GameName* game_name_of(const char* interned);
+void game_names_free(void);
+
 void game_camera_init(void);
 void game_camera_update(void);
 void game_camera_world_to_screen(float wx, float wy, float* sx, float* sy);
 
 void game_sprite_draw_entity(const GameEntity* e);
 
-void game_collide_resolve_solids(GameEntity* e, float dt);
+/* Sprite batch (batch.c): quads sharing a texture go out in one geometry
+ * call; NULL texture = solid color. Between begin and end nothing else may
+ * draw. reserve hands out 4*quads vertices to fill, or NULL when the caller
+ * has to draw directly (backend without geometry). */
+struct BackendVertex;
+void game_batch_begin(void);
+void game_batch_end(void);
+void game_batch_quad(Texture* tex, const Rect* src, const Rect* dst, Color color);
+struct BackendVertex* game_batch_reserve(Texture* tex, int quads);
+void game_batch_write_quad(struct BackendVertex* v, float x, float y, float w, float h, Color color,
+                           float u0, float v0, float u1, float v1);
+void game_batch_stats(int* batches, int* calls);
+void game_batch_free(void);
+
+/* What the batch calls into; the defaults are backend_render_geometry and
+ * backend_query_texture. Tests install their own to capture submitted runs
+ * without a renderer; NULL restores the defaults. */
+typedef struct GameBatchBackend {
+    int (*render_geometry)(Texture* tex, const struct BackendVertex* v, int n,
+                           const int* idx, int ni);
+    int (*query_texture)(Texture* tex, Uint32* format, int* access, int* w, int* h);
+} GameBatchBackend;
+void game_batch_set_backend(const GameBatchBackend* backend);
+
+/* Hot-field columns of storage chunk c (slots c * GAME_ENTITY_CHUNK ...),
+ * NULL if that chunk was never allocated. */
+GameEntityColumns* game_entity_columns(int chunk);
+
+/* Per-frame passes over the entity table (first n slots). */
+void game_collide_integrate(int n, float dt);
+void game_collide_resolve_solids(GameEntity* e); /* after integration */
+void game_anim_step(GameEntity** all, int n, float dt);
+void game_collide_begin_update(void);
+void game_collide_end_update(void);
+void game_collide_track(GameEntity* e);
+
+/* Broad phase: uniform grid hashed by cell, rebuilt from the entity table.
+ * Queries return candidate slot indices in ascending order; callers still do
+ * the exact AABB test. */
+typedef int (*GameSpatialFilter)(const GameEntity* e);
+
+typedef struct GameSpatialHash {
+    float cell;
+    float inv_cell;
+    int entity_count;
+    int bucket_count;
+    int* starts; /* bucket_count + 1 offsets into items */
+    int starts_cap;
+    int* items;
+    int items_cap;
+    int item_count;
+    int* keys; /* build scratch: (hash, slot) pairs */
+    int keys_cap;
+    int* oversized; /* slots spanning too many cells or added after the build */
+    int oversized_cap;
+    int oversized_count;
+    unsigned int* stamp; /* per-slot dedupe marks */
+    int stamp_cap;
+    unsigned int stamp_gen;
+    int* result;
+    int result_cap;
+} GameSpatialHash;
+
+int game_spatial_build(GameSpatialHash* h, GameEntity** all, int n, GameSpatialFilter filter);
+const int* game_spatial_query(GameSpatialHash* h, float x, float y, float w, float hh, int* out_count);
+int game_spatial_add_always(GameSpatialHash* h, int slot); /* returned by every query */
+void game_spatial_free(GameSpatialHash* h);
 
 void game_anim_apply_json(GameEntity* e, cJSON* anim);
 
@@ -32,6 +112,10 @@ void game_perf_end_update(void);
 void game_perf_begin_render(void);
 void game_perf_end_render(int entity_draws);
 int game_particles_draw_count(void);
+void game_particles_free(void);
+void game_tilemap_draw_stats(int* draws, int* chunks);
+/* Baked chunk textures held and how many the current window size allows. */
+void game_tilemap_cache_stats(int* baked, int* budget);
 
 #endif
 #endif
@@ -0,0 +1,133 @@
+#include "game.h"
+#include "internal.h"
+
+#if YUI_WITH_GAME
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Interned entity names (id / tag / script / prefab / sprite path). Each
+ * string is stored right after its GameName record, so an interned pointer
+ * leads back to its lookup lists without another hash probe. Names live
+ * until game_names_free(); there are only as many as distinct strings. */
+
+static GameName** g_names; /* open addressing, power-of-two size */
+static int g_name_cap;
+static int g_name_count;
+static const char* g_empty;
+
+static uint32_t game_name_hash(const char* s)
+{
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static const char* game_name_str(const GameName* name)
+{
+    return (const char*)(name + 1);
+}
+
+static int game_names_grow(void)
+{
+    int cap = g_name_cap > 0 ? g_name_cap * 2 : 256;
+    GameName** grown = (GameName**)calloc((size_t)cap, sizeof(GameName*));
+    int i;
+    if (!grown) {
+        return -1;
+    }
+    for (i = 0; i < g_name_cap; i++) {
+        GameName* name = g_names[i];
+        uint32_t h;
+        if (!name) {
+            continue;
+        }
+        for (h = name->hash & (uint32_t)(cap - 1); grown[h]; h = (h + 1) & (uint32_t)(cap - 1)) {
+        }
+        grown[h] = name;
+    }
+    free(g_names);
+    g_names = grown;
+    g_name_cap = cap;
+    return 0;
+}
+
+GameName* game_name_lookup(const char* s)
+{
+    uint32_t hash;
+    uint32_t mask;
+    uint32_t h;
+    if (!s || g_name_cap == 0) {
+        return NULL;
+    }
+    hash = game_name_hash(s);
+    mask = (uint32_t)(g_name_cap - 1);
+    for (h = hash & mask; g_names[h]; h = (h + 1) & mask) {
+        if (g_names[h]->hash == hash && strcmp(game_name_str(g_names[h]), s) == 0) {
+            return g_names[h];
+        }
+    }
+    return NULL;
+}
+
+GameName* game_name_of(const char* interned)
+{
+    return interned ? (GameName*)interned - 1 : NULL;
+}
+
+const char* game_intern(const char* s)
+{
+    GameName* name;
+    size_t len;
+    uint32_t h;
+    if (!s) {
+        s = "";
+    }
+    if (!s[0] && g_empty) {
+        return g_empty;
+    }
+    name = game_name_lookup(s);
+    if (name) {
+        return game_name_str(name);
+    }
+    if ((g_name_count + 1) * 2 > g_name_cap && game_names_grow() != 0) {
+        return NULL;
+    }
+    len = strlen(s);
+    name = (GameName*)malloc(sizeof(GameName) + len + 1);
+    if (!name) {
+        return NULL;
+    }
+    name->hash = game_name_hash(s);
+    name->id_head = -1;
+    name->tag_head = -1;
+    name->pool_head = -1;
+    memcpy(name + 1, s, len + 1);
+    for (h = name->hash & (uint32_t)(g_name_cap - 1); g_names[h]; h = (h + 1) & (uint32_t)(g_name_cap - 1)) {
+    }
+    g_names[h] = name;
+    g_name_count++;
+    if (!s[0]) {
+        g_empty = game_name_str(name);
+    }
+    return game_name_str(name);
+}
+
+void game_names_free(void)
+{
+    int i;
+    for (i = 0; i < g_name_cap; i++) {
+        free(g_names[i]);
+    }
+    free(g_names);
+    g_names = NULL;
+    g_name_cap = 0;
+    g_name_count = 0;
+    g_empty = NULL;
+}
+
+#endif
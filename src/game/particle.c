@@ -8,38 +8,95 @@
 #include <math.h>
 #include <string.h>
 
-typedef struct GameParticle {
-    int alive;
-    float x, y;
-    float vx, vy;
-    float life;
-    float life_max;
-    float size;
-    Color color;
-} GameParticle;
+/* Particles are kept as parallel arrays (SoA) with the live ones packed in
+ * [0, count): update streams through each field and a dead particle is
+ * replaced by the last one, so there are no holes to skip. */
+typedef struct GameParticles {
+    int count;
+    int cap;
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* life;
+    float* life_max;
+    float* size;
+    Color* color;
+} GameParticles;
 
-static GameParticle *g_parts = NULL; /* heap allocated, contiguous array */
+static GameParticles g_parts;
 static int g_part_draws;
 
-void game_particles_clear(void)
+static int game_particles_grow_field(void** field, size_t elem, int cap)
 {
-    if (!g_parts) {
-        g_parts = calloc(GAME_MAX_PARTICLES, sizeof(GameParticle));
+    void* grown = realloc(*field, elem * (size_t)cap);
+    if (!grown) {
+        return -1;
+    }
+    *field = grown;
+    return 0;
+}
+
+static int game_particles_reserve(int need)
+{
+    GameParticles* p = &g_parts;
+    int cap = p->cap > 0 ? p->cap : 256;
+    if (need <= p->cap) {
+        return 0;
+    }
+#if GAME_MAX_PARTICLES > 0
+    if (need > GAME_MAX_PARTICLES) {
+        return -1;
     }
-    if (g_parts) {
-        memset(g_parts, 0, sizeof(GameParticle) * GAME_MAX_PARTICLES);
+#endif
+    while (cap < need) {
+        cap *= 2;
+    }
+#if GAME_MAX_PARTICLES > 0
+    if (cap > GAME_MAX_PARTICLES) {
+        cap = GAME_MAX_PARTICLES;
+    }
+#endif
+    /* Fields that did grow are kept; cap only moves once all of them have. */
+    if (game_particles_grow_field((void**)&p->x, sizeof(float), cap) != 0 ||
+        game_particles_grow_field((void**)&p->y, sizeof(float), cap) != 0 ||
+        game_particles_grow_field((void**)&p->vx, sizeof(float), cap) != 0 ||
+        game_particles_grow_field((void**)&p->vy, sizeof(float), cap) != 0 ||
+        game_particles_grow_field((void**)&p->life, sizeof(float), cap) != 0 ||
+        game_particles_grow_field((void**)&p->life_max, sizeof(float), cap) != 0 ||
+        game_particles_grow_field((void**)&p->size, sizeof(float), cap) != 0 ||
+        game_particles_grow_field((void**)&p->color, sizeof(Color), cap) != 0) {
+        return -1;
     }
+    p->cap = cap;
+    return 0;
+}
+
+void game_particles_clear(void)
+{
+    g_parts.count = 0;
+    g_part_draws = 0;
+}
+
+void game_particles_free(void)
+{
+    free(g_parts.x);
+    free(g_parts.y);
+    free(g_parts.vx);
+    free(g_parts.vy);
+    free(g_parts.life);
+    free(g_parts.life_max);
+    free(g_parts.size);
+    free(g_parts.color);
+    memset(&g_parts, 0, sizeof(g_parts));
     g_part_draws = 0;
 }
 
 int game_spawn_particles(float x, float y, int count, Color color, float speed, float life)
 {
+    GameParticles* p = &g_parts;
     int spawned = 0;
     int i;
-    int slot;
-    if (!g_parts) {
-        return 0;
-    }
     if (count < 1) {
         count = 1;
     }
@@ -53,76 +110,85 @@ int game_spawn_particles(float x, float y, int count, Color color, float speed,
         life = 0.4f;
     }
     for (i = 0; i < count; i++) {
-        for (slot = 0; slot < GAME_MAX_PARTICLES; slot++) {
-            if (!g_parts[slot].alive) {
-                float ang = ((float)rand() / (float)RAND_MAX) * 6.2831853f;
-                float spd = speed * (0.4f + ((float)rand() / (float)RAND_MAX) * 0.8f);
-                g_parts[slot].alive = 1;
-                g_parts[slot].x = x;
-                g_parts[slot].y = y;
-                g_parts[slot].vx = cosf(ang) * spd;
-                g_parts[slot].vy = sinf(ang) * spd;
-                g_parts[slot].life = life;
-                g_parts[slot].life_max = life;
-                g_parts[slot].size = 3.0f + ((float)rand() / (float)RAND_MAX) * 4.0f;
-                g_parts[slot].color = color;
-                spawned++;
-                break;
-            }
+        float ang;
+        float spd;
+        int slot = p->count;
+        if (slot >= p->cap && game_particles_reserve(slot + 1) != 0) {
+            break;
         }
+        ang = ((float)rand() / (float)RAND_MAX) * 6.2831853f;
+        spd = speed * (0.4f + ((float)rand() / (float)RAND_MAX) * 0.8f);
+        p->x[slot] = x;
+        p->y[slot] = y;
+        p->vx[slot] = cosf(ang) * spd;
+        p->vy[slot] = sinf(ang) * spd;
+        p->life[slot] = life;
+        p->life_max[slot] = life;
+        p->size[slot] = 3.0f + ((float)rand() / (float)RAND_MAX) * 4.0f;
+        p->color[slot] = color;
+        p->count++;
+        spawned++;
     }
     return spawned;
 }
 
 void game_particles_update(float dt)
 {
-    int i;
-    if (!g_parts) {
-        return;
-    }
-    for (i = 0; i < GAME_MAX_PARTICLES; i++) {
-        if (!g_parts[i].alive) {
-            continue;
+    GameParticles* p = &g_parts;
+    int i = 0;
+    while (i < p->count) {
+        p->life[i] -= dt;
+        if (p->life[i] <= 0) {
+            int last = --p->count;
+            p->x[i] = p->x[last];
+            p->y[i] = p->y[last];
+            p->vx[i] = p->vx[last];
+            p->vy[i] = p->vy[last];
+            p->life[i] = p->life[last];
+            p->life_max[i] = p->life_max[last];
+            p->size[i] = p->size[last];
+            p->color[i] = p->color[last];
+            continue; /* the moved particle still needs this frame's step */
         }
-        g_parts[i].life -= dt;
-        if (g_parts[i].life <= 0) {
-            g_parts[i].alive = 0;
-            continue;
-        }
-        g_parts[i].x += g_parts[i].vx * dt;
-        g_parts[i].y += g_parts[i].vy * dt;
-        g_parts[i].vy += 200.0f * dt;
+        p->x[i] += p->vx[i] * dt;
+        p->y[i] += p->vy[i] * dt;
+        p->vy[i] += 200.0f * dt;
+        i++;
     }
 }
 
+/* All particles are solid quads: one geometry run, drawn after sprites. */
 void game_particles_render(void)
 {
+    GameParticles* p = &g_parts;
+    BackendVertex* v;
+    float ox;
+    float oy;
     int i;
-    float sx, sy;
-    Rect dst;
-    Color c;
-    float a;
     g_part_draws = 0;
-    if (!g_parts) {
+    if (p->count == 0) {
         return;
     }
-    for (i = 0; i < GAME_MAX_PARTICLES; i++) {
-        if (!g_parts[i].alive) {
-            continue;
-        }
-        a = g_parts[i].life / g_parts[i].life_max;
-        c = g_parts[i].color;
-        c.a = (unsigned char)((float)c.a * a);
-        game_camera_world_to_screen(g_parts[i].x, g_parts[i].y, &sx, &sy);
-        dst.x = (int)sx;
-        dst.y = (int)sy;
-        dst.w = (int)g_parts[i].size;
-        dst.h = (int)g_parts[i].size;
+    game_camera_world_to_screen(0.0f, 0.0f, &ox, &oy);
+    v = game_batch_reserve(NULL, p->count);
+    for (i = 0; i < p->count; i++) {
+        Color c = p->color[i];
+        Rect dst;
+        c.a = (unsigned char)((float)c.a * (p->life[i] / p->life_max[i]));
+        dst.x = (int)(p->x[i] + ox);
+        dst.y = (int)(p->y[i] + oy);
+        dst.w = (int)p->size[i];
+        dst.h = (int)p->size[i];
         if (dst.w < 1) dst.w = 1;
         if (dst.h < 1) dst.h = 1;
-        backend_render_fill_rect(&dst, c);
-        g_part_draws++;
+        if (v) {
+            game_batch_write_quad(v + i * 4, (float)dst.x, (float)dst.y,
+                                  (float)dst.w, (float)dst.h, c, 0.0f, 0.0f, 0.0f, 0.0f);
+        } else {
+            game_batch_quad(NULL, NULL, &dst, c);
+        }
     }
+    g_part_draws = p->count;
 }
 
 int game_particles_draw_count(void)
@@ -33,15 +33,20 @@ void game_perf_end_render(int entity_draws)
     int i;
     GameEntity** all = game_entities(&n);
     int alive = 0;
+    int tile_draws = 0;
+    int batch_calls = 0;
     const PerfFrameStats* fs = perf_get_frame_stats();
     for (i = 0; i < n; i++) {
-        if (all[i] && all[i]->alive) {
+        if (all[i] && GAME_ALIVE(all[i])) {
             alive++;
         }
     }
     g_stats.render_ms = (double)dt / 1.0e6;
     g_stats.entities = alive;
-    g_stats.draws = entity_draws + game_particles_draw_count();
+    game_tilemap_draw_stats(&tile_draws, &g_stats.tile_chunks);
+    g_stats.draws = entity_draws + tile_draws + game_particles_draw_count();
+    game_batch_stats(&g_stats.batches, &batch_calls);
+    g_stats.draw_calls = tile_draws + batch_calls;
     g_stats.particles = game_particles_draw_count();
     if (fs) {
         g_stats.fps = fs->fps;
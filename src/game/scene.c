@@ -28,11 +28,14 @@ void game_clear_scene(void)
 
 static void game_apply_sprite(GameEntity* e, const char* path)
 {
+    const char* interned;
     if (!e || !path || !path[0]) {
         return;
     }
-    strncpy(e->sprite_path, path, GAME_PATH_LEN - 1);
-    e->sprite_path[GAME_PATH_LEN - 1] = '\0';
+    interned = game_intern(path);
+    if (interned) {
+        e->sprite_path = interned;
+    }
     e->texture = backend_load_texture((char*)path);
 }
 
@@ -88,24 +91,24 @@ GameEntity* game_spawn_from_json(cJSON* obj)
 
     t = cJSON_GetObjectItem(obj, "tag");
     if (cJSON_IsString(t) && t->valuestring) {
-        strncpy(e->tag, t->valuestring, GAME_ID_LEN - 1);
-        strncpy(e->prefab, t->valuestring, GAME_ID_LEN - 1);
+        game_entity_set_tag(e, t->valuestring);
+        game_entity_set_prefab(e, t->valuestring);
     }
     t = cJSON_GetObjectItem(obj, "prefab");
     if (cJSON_IsString(t) && t->valuestring) {
-        strncpy(e->prefab, t->valuestring, GAME_ID_LEN - 1);
+        game_entity_set_prefab(e, t->valuestring);
     }
     t = cJSON_GetObjectItem(obj, "script");
     if (cJSON_IsString(t) && t->valuestring) {
-        strncpy(e->script, t->valuestring, GAME_ID_LEN - 1);
+        game_entity_set_script(e, t->valuestring);
     }
 
     sp = cJSON_GetObjectItem(obj, "transform");
     if (cJSON_IsObject(sp)) {
         t = cJSON_GetObjectItem(sp, "x");
-        if (cJSON_IsNumber(t)) e->x = (float)t->valuedouble;
+        if (cJSON_IsNumber(t)) GAME_X(e) = (float)t->valuedouble;
         t = cJSON_GetObjectItem(sp, "y");
-        if (cJSON_IsNumber(t)) e->y = (float)t->valuedouble;
+        if (cJSON_IsNumber(t)) GAME_Y(e) = (float)t->valuedouble;
         t = cJSON_GetObjectItem(sp, "z");
         if (cJSON_IsNumber(t)) e->z = (float)t->valuedouble;
     }
@@ -149,32 +152,32 @@ GameEntity* game_spawn_from_json(cJSON* obj)
     col = cJSON_GetObjectItem(obj, "collider");
     if (cJSON_IsObject(col)) {
         t = cJSON_GetObjectItem(col, "w");
-        if (cJSON_IsNumber(t)) e->cw = (float)t->valuedouble;
+        if (cJSON_IsNumber(t)) GAME_CW(e) = (float)t->valuedouble;
         t = cJSON_GetObjectItem(col, "h");
-        if (cJSON_IsNumber(t)) e->ch = (float)t->valuedouble;
+        if (cJSON_IsNumber(t)) GAME_CH(e) = (float)t->valuedouble;
         t = cJSON_GetObjectItem(col, "ox");
-        if (cJSON_IsNumber(t)) e->cox = (float)t->valuedouble;
+        if (cJSON_IsNumber(t)) GAME_COX(e) = (float)t->valuedouble;
         t = cJSON_GetObjectItem(col, "oy");
-        if (cJSON_IsNumber(t)) e->coy = (float)t->valuedouble;
+        if (cJSON_IsNumber(t)) GAME_COY(e) = (float)t->valuedouble;
         t = cJSON_GetObjectItem(col, "trigger");
-        if (cJSON_IsTrue(t) || (cJSON_IsNumber(t) && t->valueint)) e->trigger = 1;
+        if (cJSON_IsTrue(t) || (cJSON_IsNumber(t) && t->valueint)) GAME_SET_FLAG(e, GAME_ENTITY_TRIGGER, 1);
         t = cJSON_GetObjectItem(col, "solid");
-        if (cJSON_IsTrue(t) || (cJSON_IsNumber(t) && t->valueint)) e->solid = 1;
+        if (cJSON_IsTrue(t) || (cJSON_IsNumber(t) && t->valueint)) GAME_SET_FLAG(e, GAME_ENTITY_SOLID, 1);
     }
 
     t = cJSON_GetObjectItem(obj, "solid");
     if (cJSON_IsTrue(t) || (cJSON_IsNumber(t) && t->valueint)) {
-        e->solid = 1;
+        GAME_SET_FLAG(e, GAME_ENTITY_SOLID, 1);
     }
     t = cJSON_GetObjectItem(obj, "vx");
-    if (cJSON_IsNumber(t)) e->vx = (float)t->valuedouble;
+    if (cJSON_IsNumber(t)) GAME_VX(e) = (float)t->valuedouble;
     t = cJSON_GetObjectItem(obj, "vy");
-    if (cJSON_IsNumber(t)) e->vy = (float)t->valuedouble;
+    if (cJSON_IsNumber(t)) GAME_VY(e) = (float)t->valuedouble;
 
     /* Solid: keep sprite size locked to hitbox (avoids invisible ledges). */
-    // if (e->solid && e->cw > 0.0f && e->ch > 0.0f) {
-    //     e->w = e->cw;
-    //     e->h = e->ch;
+    // if (GAME_SOLID(e) && GAME_CW(e) > 0.0f && GAME_CH(e) > 0.0f) {
+    //     e->w = GAME_CW(e);
+    //     e->h = GAME_CH(e);
     // }
 
     return e;
@@ -0,0 +1,298 @@
+#include "game.h"
+#include "internal.h"
+
+#if YUI_WITH_GAME
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Entities covering more cells than this go to a side list that every query
+ * scans, so one huge floor does not flood the table. */
+#define GAME_SPATIAL_MAX_SPAN 64
+#define GAME_SPATIAL_MIN_CELL 16.0f
+#define GAME_SPATIAL_MAX_CELL 1024.0f
+
+static int game_spatial_grow(int** buf, int* cap, int need)
+{
+    int n;
+    int* grown;
+    if (need <= *cap) {
+        return 0;
+    }
+    n = *cap > 0 ? *cap : 64;
+    while (n < need) {
+        n *= 2;
+    }
+    grown = (int*)realloc(*buf, (size_t)n * sizeof(int));
+    if (!grown) {
+        return -1;
+    }
+    *buf = grown;
+    *cap = n;
+    return 0;
+}
+
+static uint32_t game_spatial_cell_hash(int cx, int cy)
+{
+    return ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+}
+
+/* Clamped so runaway coordinates (NaN, bullets flung off-world) stay in int range. */
+static int game_spatial_cell_coord(float v, float inv_cell)
+{
+    float c = floorf(v * inv_cell);
+    c = fmaxf(c, -1.0e8f);
+    c = fminf(c, 1.0e8f);
+    return (int)c;
+}
+
+static void game_spatial_cell_range(const GameSpatialHash* h, float x, float y, float w, float hh,
+                                    int* x0, int* y0, int* x1, int* y1)
+{
+    *x0 = game_spatial_cell_coord(x, h->inv_cell);
+    *y0 = game_spatial_cell_coord(y, h->inv_cell);
+    *x1 = game_spatial_cell_coord(x + w, h->inv_cell);
+    *y1 = game_spatial_cell_coord(y + hh, h->inv_cell);
+    if (*x1 < *x0) *x1 = *x0;
+    if (*y1 < *y0) *y1 = *y0;
+}
+
+/* Cell edge ~2x the mean collider extent, rounded to a power of two. */
+static float game_spatial_pick_cell(GameEntity** all, int n, GameSpatialFilter filter)
+{
+    double sum = 0.0;
+    int count = 0;
+    float cell = GAME_SPATIAL_MIN_CELL;
+    int i;
+    for (i = 0; i < n; i++) {
+        float x, y, w, h;
+        if (!all[i] || !filter(all[i])) {
+            continue;
+        }
+        game_entity_world_aabb(all[i], &x, &y, &w, &h);
+        sum += w > h ? w : h;
+        count++;
+    }
+    if (count > 0) {
+        float target = (float)(2.0 * sum / count);
+        while (cell < target && cell < GAME_SPATIAL_MAX_CELL) {
+            cell *= 2.0f;
+        }
+    }
+    return cell;
+}
+
+void game_spatial_free(GameSpatialHash* h)
+{
+    if (!h) {
+        return;
+    }
+    free(h->starts);
+    free(h->items);
+    free(h->keys);
+    free(h->oversized);
+    free(h->stamp);
+    free(h->result);
+    memset(h, 0, sizeof(*h));
+}
+
+int game_spatial_build(GameSpatialHash* h, GameEntity** all, int n, GameSpatialFilter filter)
+{
+    int i;
+    int cx, cy;
+    int entries = 0;
+    int buckets = 64;
+    uint32_t mask;
+
+    if (!h || !filter) {
+        return -1;
+    }
+    h->item_count = 0;
+    h->oversized_count = 0;
+    h->entity_count = n;
+    h->cell = game_spatial_pick_cell(all, n, filter);
+    h->inv_cell = 1.0f / h->cell;
+
+    /* Pass 1: one (bucket, entity) key per covered cell. */
+    for (i = 0; i < n; i++) {
+        float x, y, w, hh;
+        int x0, y0, x1, y1;
+        if (!all[i] || !filter(all[i])) {
+            continue;
+        }
+        game_entity_world_aabb(all[i], &x, &y, &w, &hh);
+        game_spatial_cell_range(h, x, y, w, hh, &x0, &y0, &x1, &y1);
+        if ((int64_t)(x1 - x0 + 1) * (int64_t)(y1 - y0 + 1) > GAME_SPATIAL_MAX_SPAN) {
+            if (game_spatial_grow(&h->oversized, &h->oversized_cap, h->oversized_count + 1) != 0) {
+                return -1;
+            }
+            h->oversized[h->oversized_count++] = i;
+            continue;
+        }
+        if (game_spatial_grow(&h->keys, &h->keys_cap, (entries + (x1 - x0 + 1) * (y1 - y0 + 1)) * 2) != 0) {
+            return -1;
+        }
+        for (cy = y0; cy <= y1; cy++) {
+            for (cx = x0; cx <= x1; cx++) {
+                h->keys[entries * 2] = (int)game_spatial_cell_hash(cx, cy);
+                h->keys[entries * 2 + 1] = i;
+                entries++;
+            }
+        }
+    }
+
+    while (buckets < entries * 2) {
+        buckets *= 2;
+    }
+    if (game_spatial_grow(&h->starts, &h->starts_cap, buckets + 1) != 0 ||
+        game_spatial_grow(&h->items, &h->items_cap, entries) != 0) {
+        return -1;
+    }
+    h->bucket_count = buckets;
+    mask = (uint32_t)(buckets - 1);
+
+    /* Pass 2: counting sort of entity indices by bucket. */
+    memset(h->starts, 0, (size_t)(buckets + 1) * sizeof(int));
+    for (i = 0; i < entries; i++) {
+        h->starts[((uint32_t)h->keys[i * 2] & mask) + 1]++;
+    }
+    for (i = 0; i < buckets; i++) {
+        h->starts[i + 1] += h->starts[i];
+    }
+    for (i = 0; i < entries; i++) {
+        uint32_t b = (uint32_t)h->keys[i * 2] & mask;
+        /* starts[b] is used as the write cursor, then shifted back below */
+        h->items[h->starts[b]++] = h->keys[i * 2 + 1];
+    }
+    for (i = buckets; i > 0; i--) {
+        h->starts[i] = h->starts[i - 1];
+    }
+    h->starts[0] = 0;
+    h->item_count = entries;
+    return 0;
+}
+
+static int game_spatial_int_cmp(const void* a, const void* b)
+{
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    return (ia > ib) - (ia < ib);
+}
+
+static void game_spatial_sort(int* v, int n)
+{
+    int i, j;
+    if (n > 32) {
+        qsort(v, (size_t)n, sizeof(int), game_spatial_int_cmp);
+        return;
+    }
+    for (i = 1; i < n; i++) {
+        int key = v[i];
+        for (j = i - 1; j >= 0 && v[j] > key; j--) {
+            v[j + 1] = v[j];
+        }
+        v[j + 1] = key;
+    }
+}
+
+static int game_spatial_reserve_stamp(GameSpatialHash* h, int n)
+{
+    unsigned int* grown;
+    if (n <= h->stamp_cap) {
+        return 0;
+    }
+    grown = (unsigned int*)realloc(h->stamp, (size_t)n * sizeof(unsigned int));
+    if (!grown) {
+        return -1;
+    }
+    memset(grown + h->stamp_cap, 0, (size_t)(n - h->stamp_cap) * sizeof(unsigned int));
+    h->stamp = grown;
+    h->stamp_cap = n;
+    return 0;
+}
+
+int game_spatial_add_always(GameSpatialHash* h, int slot)
+{
+    if (!h || slot < 0 || game_spatial_reserve_stamp(h, slot + 1) != 0 ||
+        game_spatial_grow(&h->oversized, &h->oversized_cap, h->oversized_count + 1) != 0) {
+        return -1;
+    }
+    h->oversized[h->oversized_count++] = slot;
+    return 0;
+}
+
+static int game_spatial_collect(GameSpatialHash* h, uint32_t b, int* count)
+{
+    int i;
+    for (i = h->starts[b]; i < h->starts[b + 1]; i++) {
+        int idx = h->items[i];
+        if (h->stamp[idx] == h->stamp_gen) {
+            continue;
+        }
+        h->stamp[idx] = h->stamp_gen;
+        if (game_spatial_grow(&h->result, &h->result_cap, *count + 1) != 0) {
+            return -1;
+        }
+        h->result[(*count)++] = idx;
+    }
+    return 0;
+}
+
+const int* game_spatial_query(GameSpatialHash* h, float x, float y, float w, float hh, int* out_count)
+{
+    int x0, y0, x1, y1;
+    int cx, cy;
+    int count = 0;
+    int i;
+    uint32_t mask;
+
+    *out_count = 0;
+    if (!h || h->bucket_count == 0) {
+        return NULL;
+    }
+    if (game_spatial_reserve_stamp(h, h->entity_count) != 0) {
+        return NULL;
+    }
+    if (++h->stamp_gen == 0) {
+        memset(h->stamp, 0, (size_t)h->stamp_cap * sizeof(unsigned int));
+        h->stamp_gen = 1;
+    }
+
+    mask = (uint32_t)(h->bucket_count - 1);
+    game_spatial_cell_range(h, x, y, w, hh, &x0, &y0, &x1, &y1);
+    if ((int64_t)(x1 - x0 + 1) * (int64_t)(y1 - y0 + 1) >= (int64_t)h->bucket_count) {
+        /* Query covers more cells than there are buckets: take every bucket once. */
+        for (i = 0; i < h->bucket_count; i++) {
+            if (game_spatial_collect(h, (uint32_t)i, &count) != 0) {
+                return NULL;
+            }
+        }
+    } else {
+        for (cy = y0; cy <= y1; cy++) {
+            for (cx = x0; cx <= x1; cx++) {
+                if (game_spatial_collect(h, game_spatial_cell_hash(cx, cy) & mask, &count) != 0) {
+                    return NULL;
+                }
+            }
+        }
+    }
+    for (i = 0; i < h->oversized_count; i++) {
+        int idx = h->oversized[i];
+        if (h->stamp[idx] == h->stamp_gen) {
+            continue;
+        }
+        h->stamp[idx] = h->stamp_gen;
+        if (game_spatial_grow(&h->result, &h->result_cap, count + 1) != 0) {
+            return NULL;
+        }
+        h->result[count++] = idx;
+    }
+    /* Slot order keeps resolution and callback order identical to a full scan. */
+    game_spatial_sort(h->result, count);
+    *out_count = count;
+    return h->result;
+}
+
+#endif
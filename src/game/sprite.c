@@ -5,22 +5,23 @@
 
 #include "../backend.h"
 
+/* Drawn through the sprite batch: call between game_batch_begin/end. */
 void game_sprite_draw_entity(const GameEntity* e)
 {
     float sx;
     float sy;
     Rect dst;
     Rect src;
-    if (!e || !e->alive) {
+    if (!e || !GAME_ALIVE(e)) {
         return;
     }
-    game_camera_world_to_screen(e->x, e->y, &sx, &sy);
+    game_camera_world_to_screen(GAME_X(e), GAME_Y(e), &sx, &sy);
     dst.x = (int)sx;
     dst.y = (int)sy;
     // /* Solids: always draw at hitbox size so visuals can't drift from collision. */
-    // if (e->solid && e->cw > 0.0f && e->ch > 0.0f) {
-    //     dst.w = (int)e->cw;
-    //     dst.h = (int)e->ch;
+    // if (GAME_SOLID(e) && GAME_CW(e) > 0.0f && GAME_CH(e) > 0.0f) {
+    //     dst.w = (int)GAME_CW(e);
+    //     dst.h = (int)GAME_CH(e);
     // } else {
         dst.w = (int)(e->w > 0 ? e->w : 16);
         dst.h = (int)(e->h > 0 ? e->h : 16);
@@ -30,21 +31,22 @@ void game_sprite_draw_entity(const GameEntity* e)
 
     /* Skip completely off-screen (optional cull) — still draw if partially visible */
     if (e->texture) {
+        static const Color white = {255, 255, 255, 255};
         if (e->use_frame && e->frame_w > 0 && e->frame_h > 0) {
             src.x = e->frame_x;
             src.y = e->frame_y;
             src.w = e->frame_w;
             src.h = e->frame_h;
-            backend_render_text_copy(e->texture, &src, &dst);
+            game_batch_quad(e->texture, &src, &dst, white);
         } else {
-            backend_render_text_copy(e->texture, NULL, &dst);
+            game_batch_quad(e->texture, NULL, &dst, white);
         }
     } else {
         Color c = e->color;
         if (c.a == 0) {
             c.a = 255;
         }
-        backend_render_fill_rect(&dst, c);
+        game_batch_quad(NULL, NULL, &dst, c);
     }
 }
 
@@ -8,7 +8,32 @@
 #include <string.h>
 #include <stdio.h>
 
-#define GAME_TILEMAP_MAX_CELLS (64 * 64)
+#include <stdint.h>
+#include <math.h>
+
+/* Grid size cap: guards cols*rows overflow, not a design limit (1024x1024
+ * is 2 MB of uint16 tiles). */
+#define GAME_TILEMAP_MAX_CELLS (4096 * 4096)
+/* Chunk side in tiles; each chunk bakes into one texture and is culled as
+ * a whole against the camera. */
+#define GAME_TILEMAP_CHUNK 16
+/* Baked chunk textures are kept for the chunks a window-sized view can
+ * touch plus this many rings of chunks around it; beyond that the least
+ * recently drawn one is recycled. */
+#ifndef GAME_TILEMAP_TEX_MARGIN
+#define GAME_TILEMAP_TEX_MARGIN 1
+#endif
+
+/* Binary map: "YTM1", u32 cols, u32 rows, then (u32 count, u16 tid) runs
+ * covering cols*rows tiles row-major. All little-endian. */
+static const char g_tilemap_magic[4] = {'Y', 'T', 'M', '1'};
+
+typedef struct GameTileChunk {
+    Texture* tex;      /* baked tiles, NULL until first drawn */
+    int filled;        /* non-zero tiles; 0 = nothing to draw */
+    int dirty;         /* tex content is stale */
+    unsigned int last_use;
+} GameTileChunk;
 
 typedef struct GameTilemap {
     int active;
@@ -17,33 +42,342 @@ typedef struct GameTilemap {
     int tile_w;
     int tile_h;
     int solid_nonzero; /* non-zero tiles are solid */
-    int* tiles;        /* heap allocated, cols*rows ints */
+    uint16_t* tiles;   /* heap allocated, cols*rows */
     char src[GAME_PATH_LEN];
     Texture* texture;
     int tileset_cols; /* frames per row in tileset; 0 = colored rects */
+    int chunk_cols;
+    int chunk_rows;
+    GameTileChunk* chunks;
+    int* baked; /* chunk indices holding a texture */
+    int baked_count;
+    int baked_cap;
+    int tex_budget; /* textures to keep, from window and chunk size */
+    int no_target; /* backend cannot render to texture: draw tiles directly */
+    unsigned int frame;
+    int chunks_drawn;
+    int draws;
 } GameTilemap;
 
 static GameTilemap g_tm;
 
+static void game_tilemap_free_chunks(void)
+{
+    int i;
+    for (i = 0; i < g_tm.baked_count; i++) {
+        GameTileChunk* ch = &g_tm.chunks[g_tm.baked[i]];
+        backend_render_text_destroy(ch->tex);
+        ch->tex = NULL;
+    }
+    g_tm.baked_count = 0;
+    free(g_tm.baked);
+    g_tm.baked = NULL;
+    g_tm.baked_cap = 0;
+    free(g_tm.chunks);
+    g_tm.chunks = NULL;
+    g_tm.chunk_cols = 0;
+    g_tm.chunk_rows = 0;
+}
+
 void game_tilemap_clear(void)
 {
+    game_tilemap_free_chunks();
     free(g_tm.tiles);
     g_tm.tiles = NULL;
     g_tm.active = 0;
     g_tm.cols = 0;
     g_tm.rows = 0;
     g_tm.solid_nonzero = 1;
+    g_tm.no_target = 0;
+    g_tm.chunks_drawn = 0;
+    g_tm.draws = 0;
 }
 
-int game_tilemap_load_from_json(cJSON* node)
+static int game_tilemap_size_ok(long cols, long rows)
+{
+    return cols > 0 && rows > 0 && cols <= GAME_TILEMAP_MAX_CELLS &&
+           rows <= GAME_TILEMAP_MAX_CELLS / cols;
+}
+
+/* Take ownership of a cols*rows grid and rebuild the chunk table. */
+static int game_tilemap_install(int cols, int rows, uint16_t* tiles)
+{
+    int r;
+    int c;
+    game_tilemap_free_chunks();
+    free(g_tm.tiles);
+    g_tm.tiles = tiles;
+    g_tm.cols = cols;
+    g_tm.rows = rows;
+    g_tm.active = 0;
+    if (g_tm.tile_w <= 0 || g_tm.tile_h <= 0) {
+        g_tm.tile_w = 32;
+        g_tm.tile_h = 32;
+    }
+    g_tm.chunk_cols = (cols + GAME_TILEMAP_CHUNK - 1) / GAME_TILEMAP_CHUNK;
+    g_tm.chunk_rows = (rows + GAME_TILEMAP_CHUNK - 1) / GAME_TILEMAP_CHUNK;
+    g_tm.chunks = (GameTileChunk*)calloc((size_t)g_tm.chunk_cols * (size_t)g_tm.chunk_rows,
+                                         sizeof(GameTileChunk));
+    if (!g_tm.chunks) {
+        printf("Game tilemap: out of memory for %dx%d chunks\n", g_tm.chunk_cols, g_tm.chunk_rows);
+        return 0;
+    }
+    for (r = 0; r < rows; r++) {
+        const uint16_t* row = tiles + (size_t)r * (size_t)cols;
+        GameTileChunk* line = g_tm.chunks + (size_t)(r / GAME_TILEMAP_CHUNK) * (size_t)g_tm.chunk_cols;
+        for (c = 0; c < cols; c++) {
+            if (row[c]) {
+                line[c / GAME_TILEMAP_CHUNK].filled++;
+            }
+        }
+    }
+    g_tm.active = 1;
+    printf("Game tilemap: %dx%d tile=%dx%d\n", g_tm.cols, g_tm.rows, g_tm.tile_w, g_tm.tile_h);
+    return 1;
+}
+
+static uint16_t* game_tilemap_alloc_grid(long cols, long rows)
+{
+    uint16_t* tiles;
+    if (!game_tilemap_size_ok(cols, rows)) {
+        printf("Game tilemap: invalid size %ldx%ld\n", cols, rows);
+        return NULL;
+    }
+    /* 懒分配：仅在加载真实 tilemap 时按实际尺寸 malloc */
+    tiles = (uint16_t*)calloc((size_t)cols * (size_t)rows, sizeof(uint16_t));
+    if (!tiles) {
+        printf("Game tilemap: out of memory for %ldx%ld tiles\n", cols, rows);
+    }
+    return tiles;
+}
+
+static uint16_t game_tilemap_tid(long v)
+{
+    if (v < 0) {
+        return 0;
+    }
+    return v > 0xffff ? 0xffff : (uint16_t)v;
+}
+
+/* Append one run at *pos; rejects runs past the end of the grid. */
+static int game_tilemap_fill_run(uint16_t* tiles, long total, long* pos, long count, uint16_t tid)
+{
+    long i;
+    if (count < 0 || count > total - *pos) {
+        return 0;
+    }
+    if (tid) {
+        for (i = 0; i < count; i++) {
+            tiles[*pos + i] = tid;
+        }
+    }
+    *pos += count;
+    return 1;
+}
+
+static int game_read_u32(FILE* fp, uint32_t* out)
+{
+    unsigned char b[4];
+    if (fread(b, 1, 4, fp) != 4) {
+        return 0;
+    }
+    *out = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    return 1;
+}
+
+static int game_read_u16(FILE* fp, uint16_t* out)
+{
+    unsigned char b[2];
+    if (fread(b, 1, 2, fp) != 2) {
+        return 0;
+    }
+    *out = (uint16_t)(b[0] | (b[1] << 8));
+    return 1;
+}
+
+static int game_write_u32(FILE* fp, uint32_t v)
+{
+    unsigned char b[4];
+    b[0] = (unsigned char)(v & 0xff);
+    b[1] = (unsigned char)((v >> 8) & 0xff);
+    b[2] = (unsigned char)((v >> 16) & 0xff);
+    b[3] = (unsigned char)((v >> 24) & 0xff);
+    return fwrite(b, 1, 4, fp) == 4;
+}
+
+static int game_write_u16(FILE* fp, uint16_t v)
+{
+    unsigned char b[2];
+    b[0] = (unsigned char)(v & 0xff);
+    b[1] = (unsigned char)((v >> 8) & 0xff);
+    return fwrite(b, 1, 2, fp) == 2;
+}
+
+int game_tilemap_load_binary(const char* path)
+{
+    FILE* fp;
+    char magic[4];
+    uint32_t cols;
+    uint32_t rows;
+    uint32_t count;
+    uint16_t tid;
+    uint16_t* tiles;
+    long total;
+    long pos = 0;
+    if (!path) {
+        return 0;
+    }
+    fp = fopen(path, "rb");
+    if (!fp) {
+        printf("Game tilemap: failed to open %s\n", path);
+        return 0;
+    }
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, g_tilemap_magic, 4) != 0 ||
+        !game_read_u32(fp, &cols) || !game_read_u32(fp, &rows)) {
+        printf("Game tilemap: %s is not a tilemap file\n", path);
+        fclose(fp);
+        return 0;
+    }
+    if (cols > GAME_TILEMAP_MAX_CELLS || rows > GAME_TILEMAP_MAX_CELLS) {
+        printf("Game tilemap: invalid size %ux%u\n", (unsigned)cols, (unsigned)rows);
+        fclose(fp);
+        return 0;
+    }
+    tiles = game_tilemap_alloc_grid((long)cols, (long)rows);
+    if (!tiles) {
+        fclose(fp);
+        return 0;
+    }
+    total = (long)cols * (long)rows;
+    while (pos < total) {
+        if (!game_read_u32(fp, &count) || !game_read_u16(fp, &tid) ||
+            count > (uint32_t)GAME_TILEMAP_MAX_CELLS ||
+            !game_tilemap_fill_run(tiles, total, &pos, (long)count, tid)) {
+            printf("Game tilemap: corrupt run data in %s\n", path);
+            free(tiles);
+            fclose(fp);
+            return 0;
+        }
+    }
+    fclose(fp);
+    return game_tilemap_install((int)cols, (int)rows, tiles);
+}
+
+int game_tilemap_save_binary(const char* path)
+{
+    FILE* fp;
+    long total;
+    long i;
+    long run;
+    int ok;
+    if (!path || !g_tm.active || !g_tm.tiles) {
+        return 0;
+    }
+    fp = fopen(path, "wb");
+    if (!fp) {
+        printf("Game tilemap: failed to write %s\n", path);
+        return 0;
+    }
+    ok = fwrite(g_tilemap_magic, 1, 4, fp) == 4 &&
+         game_write_u32(fp, (uint32_t)g_tm.cols) && game_write_u32(fp, (uint32_t)g_tm.rows);
+    total = (long)g_tm.cols * (long)g_tm.rows;
+    for (i = 0; ok && i < total; i += run) {
+        run = 1;
+        while (i + run < total && g_tm.tiles[i + run] == g_tm.tiles[i]) {
+            run++;
+        }
+        ok = game_write_u32(fp, (uint32_t)run) && game_write_u16(fp, g_tm.tiles[i]);
+    }
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    return ok;
+}
+
+/* "rle": [count, tid, count, tid, ...] with "size": [cols, rows]. */
+static int game_tilemap_load_rle_json(cJSON* rle, cJSON* size)
+{
+    cJSON* item;
+    uint16_t* tiles;
+    long cols;
+    long rows;
+    long total;
+    long pos = 0;
+    long count = -1;
+    if (!cJSON_IsArray(size) || cJSON_GetArraySize(size) < 2 ||
+        !cJSON_IsNumber(cJSON_GetArrayItem(size, 0)) || !cJSON_IsNumber(cJSON_GetArrayItem(size, 1))) {
+        printf("Game tilemap: rle needs size [cols, rows]\n");
+        return 0;
+    }
+    cols = cJSON_GetArrayItem(size, 0)->valueint;
+    rows = cJSON_GetArrayItem(size, 1)->valueint;
+    tiles = game_tilemap_alloc_grid(cols, rows);
+    if (!tiles) {
+        return 0;
+    }
+    total = cols * rows;
+    cJSON_ArrayForEach(item, rle) {
+        long v = cJSON_IsNumber(item) ? item->valueint : -1;
+        if (count < 0) {
+            count = v;
+            continue;
+        }
+        if (!game_tilemap_fill_run(tiles, total, &pos, count, game_tilemap_tid(v))) {
+            break;
+        }
+        count = -1;
+    }
+    if (pos != total || count >= 0) {
+        printf("Game tilemap: rle covers %ld of %ld tiles\n", pos, total);
+        free(tiles);
+        return 0;
+    }
+    return game_tilemap_install((int)cols, (int)rows, tiles);
+}
+
+static int game_tilemap_load_nested_json(cJSON* map)
 {
-    cJSON* map;
     cJSON* row;
     cJSON* cell;
-    cJSON* t;
+    uint16_t* tiles;
+    int rows;
+    int cols;
     int r;
     int c;
-    int idx;
+    rows = cJSON_GetArraySize(map);
+    if (rows <= 0) {
+        return 0;
+    }
+    row = cJSON_GetArrayItem(map, 0);
+    cols = cJSON_IsArray(row) ? cJSON_GetArraySize(row) : 0;
+    tiles = game_tilemap_alloc_grid(cols, rows);
+    if (!tiles) {
+        return 0;
+    }
+    r = 0;
+    cJSON_ArrayForEach(row, map) {
+        if (r >= rows) {
+            break;
+        }
+        if (cJSON_IsArray(row)) {
+            c = 0;
+            cJSON_ArrayForEach(cell, row) {
+                if (c >= cols) {
+                    break;
+                }
+                tiles[(size_t)r * (size_t)cols + (size_t)c] =
+                    cJSON_IsNumber(cell) ? game_tilemap_tid(cell->valueint) : 0;
+                c++;
+            }
+        }
+        r++;
+    }
+    return game_tilemap_install(cols, rows, tiles);
+}
+
+int game_tilemap_load_from_json(cJSON* node)
+{
+    cJSON* t;
     if (!node || !cJSON_IsObject(node)) {
         return 0;
     }
@@ -72,83 +406,262 @@ int game_tilemap_load_from_json(cJSON* node)
     if (cJSON_IsFalse(t) || (cJSON_IsNumber(t) && !t->valueint)) {
         g_tm.solid_nonzero = 0;
     }
-    map = cJSON_GetObjectItem(node, "map");
-    if (!cJSON_IsArray(map)) {
-        return 0;
+    /* Large maps: binary file or inline runs instead of nested arrays. */
+    t = cJSON_GetObjectItem(node, "mapFile");
+    if (cJSON_IsString(t) && t->valuestring) {
+        return game_tilemap_load_binary(t->valuestring);
     }
-    g_tm.rows = cJSON_GetArraySize(map);
-    if (g_tm.rows <= 0) {
-        return 0;
+    t = cJSON_GetObjectItem(node, "rle");
+    if (cJSON_IsArray(t)) {
+        return game_tilemap_load_rle_json(t, cJSON_GetObjectItem(node, "size"));
     }
-    row = cJSON_GetArrayItem(map, 0);
-    g_tm.cols = cJSON_IsArray(row) ? cJSON_GetArraySize(row) : 0;
-    if (g_tm.cols <= 0 || g_tm.rows * g_tm.cols > GAME_TILEMAP_MAX_CELLS) {
-        printf("Game tilemap: invalid size %dx%d\n", g_tm.cols, g_tm.rows);
+    t = cJSON_GetObjectItem(node, "map");
+    if (!cJSON_IsArray(t)) {
         return 0;
     }
-    /* 懒分配：仅在加载真实 tilemap 时按实际尺寸 malloc */
-    if (!g_tm.tiles) {
-        g_tm.tiles = calloc((size_t)(g_tm.rows * g_tm.cols), sizeof(int));
+    return game_tilemap_load_nested_json(t);
+}
+
+int game_tilemap_get_tile(int col, int row)
+{
+    if (!g_tm.active || col < 0 || row < 0 || col >= g_tm.cols || row >= g_tm.rows) {
+        return -1;
     }
-    if (!g_tm.tiles) {
-        printf("Game tilemap: out of memory for %dx%d tiles\n",
-               g_tm.cols, g_tm.rows);
+    return g_tm.tiles[(size_t)row * (size_t)g_tm.cols + (size_t)col];
+}
+
+int game_tilemap_set_tile(int col, int row, int tid)
+{
+    GameTileChunk* ch;
+    uint16_t* cell;
+    uint16_t v = game_tilemap_tid(tid);
+    if (!g_tm.active || col < 0 || row < 0 || col >= g_tm.cols || row >= g_tm.rows) {
         return 0;
     }
-    for (r = 0; r < g_tm.rows; r++) {
-        row = cJSON_GetArrayItem(map, r);
-        if (!cJSON_IsArray(row)) {
-            continue;
+    cell = &g_tm.tiles[(size_t)row * (size_t)g_tm.cols + (size_t)col];
+    if (*cell == v) {
+        return 1;
+    }
+    ch = &g_tm.chunks[(row / GAME_TILEMAP_CHUNK) * g_tm.chunk_cols + col / GAME_TILEMAP_CHUNK];
+    ch->filled += (v != 0) - (*cell != 0);
+    ch->dirty = 1;
+    *cell = v;
+    return 1;
+}
+
+void game_tilemap_invalidate_chunks(int lost)
+{
+    int i;
+    for (i = 0; i < g_tm.baked_count; i++) {
+        GameTileChunk* ch = &g_tm.chunks[g_tm.baked[i]];
+        if (lost) {
+            backend_render_text_destroy(ch->tex);
+            ch->tex = NULL;
         }
-        for (c = 0; c < g_tm.cols; c++) {
-            cell = cJSON_GetArrayItem(row, c);
-            idx = r * g_tm.cols + c;
-            g_tm.tiles[idx] = cJSON_IsNumber(cell) ? cell->valueint : 0;
+        ch->dirty = 1;
+    }
+    if (lost) {
+        g_tm.baked_count = 0;
+    }
+}
+
+void game_tilemap_draw_stats(int* draws, int* chunks)
+{
+    if (draws) {
+        *draws = g_tm.draws;
+    }
+    if (chunks) {
+        *chunks = g_tm.chunks_drawn;
+    }
+}
+
+void game_tilemap_cache_stats(int* baked, int* budget)
+{
+    if (baked) {
+        *baked = g_tm.baked_count;
+    }
+    if (budget) {
+        *budget = g_tm.tex_budget;
+    }
+}
+
+static void game_tilemap_draw_tile(int tid, int x, int y)
+{
+    Rect dst;
+    Rect src;
+    Color col;
+    dst.x = x;
+    dst.y = y;
+    dst.w = g_tm.tile_w;
+    dst.h = g_tm.tile_h;
+    if (g_tm.texture && g_tm.tileset_cols > 0) {
+        int tc = (tid - 1) % g_tm.tileset_cols;
+        int tr = (tid - 1) / g_tm.tileset_cols;
+        src.x = tc * g_tm.tile_w;
+        src.y = tr * g_tm.tile_h;
+        src.w = g_tm.tile_w;
+        src.h = g_tm.tile_h;
+        backend_render_text_copy(g_tm.texture, &src, &dst);
+    } else {
+        col = (Color){60, 80, 70, 255};
+        if (tid == 2) {
+            col = (Color){80, 70, 100, 255};
         }
+        backend_render_fill_rect(&dst, col);
     }
-    g_tm.active = 1;
-    printf("Game tilemap: %dx%d tile=%dx%d\n", g_tm.cols, g_tm.rows, g_tm.tile_w, g_tm.tile_h);
-    return 1;
+    g_tm.draws++;
 }
 
-void game_tilemap_render(void)
+/* Draw tiles [c0,c1]x[r0,r1]; (ox, oy) is the screen/texture origin of tile (0,0). */
+static void game_tilemap_draw_range(int c0, int r0, int c1, int r1, int ox, int oy)
 {
     int r;
     int c;
     int tid;
+    for (r = r0; r <= r1; r++) {
+        const uint16_t* row = g_tm.tiles + (size_t)r * (size_t)g_tm.cols;
+        for (c = c0; c <= c1; c++) {
+            tid = row[c];
+            if (tid != 0) {
+                game_tilemap_draw_tile(tid, ox + c * g_tm.tile_w, oy + r * g_tm.tile_h);
+            }
+        }
+    }
+}
+
+/* Drop the least recently drawn baked texture; chunks drawn this frame are
+ * never taken. Returns 0 when there is nothing to drop. */
+static int game_tilemap_evict_lru(void)
+{
+    int victim = -1;
+    int i;
+    for (i = 0; i < g_tm.baked_count; i++) {
+        GameTileChunk* other = &g_tm.chunks[g_tm.baked[i]];
+        if (other->last_use != g_tm.frame &&
+            (victim < 0 || other->last_use < g_tm.chunks[g_tm.baked[victim]].last_use)) {
+            victim = i;
+        }
+    }
+    if (victim < 0) {
+        return 0;
+    }
+    backend_render_text_destroy(g_tm.chunks[g_tm.baked[victim]].tex);
+    g_tm.chunks[g_tm.baked[victim]].tex = NULL;
+    g_tm.baked[victim] = g_tm.baked[--g_tm.baked_count];
+    return 1;
+}
+
+/* Give a chunk a texture, recycling old ones while over the budget. When
+ * every baked chunk is in view the cache grows instead, so a view is never
+ * left without textures. */
+static Texture* game_tilemap_chunk_texture(int index, int w, int h)
+{
+    GameTileChunk* ch = &g_tm.chunks[index];
+    if (ch->tex) {
+        return ch->tex;
+    }
+    if (g_tm.no_target) {
+        return NULL;
+    }
+    while (g_tm.baked_count >= g_tm.tex_budget) {
+        if (!game_tilemap_evict_lru()) {
+            break;
+        }
+    }
+    if (g_tm.baked_count >= g_tm.baked_cap) {
+        int cap = g_tm.baked_cap ? g_tm.baked_cap * 2 : 16;
+        int* grown;
+        if (cap < g_tm.tex_budget) {
+            cap = g_tm.tex_budget;
+        }
+        grown = (int*)realloc(g_tm.baked, (size_t)cap * sizeof(int));
+        if (!grown) {
+            return NULL;
+        }
+        g_tm.baked = grown;
+        g_tm.baked_cap = cap;
+    }
+    ch->tex = backend_create_target_texture(w, h);
+    if (!ch->tex) {
+        /* Backend has no render targets; stop asking every frame. */
+        g_tm.no_target = 1;
+        return NULL;
+    }
+    ch->dirty = 1;
+    g_tm.baked[g_tm.baked_count++] = index;
+    return ch->tex;
+}
+
+void game_tilemap_render(void)
+{
+    GameCamera* cam;
+    int ww = 800;
+    int wh = 600;
+    int chunk_w;
+    int chunk_h;
+    int cx0, cx1, cy0, cy1;
+    int cx, cy;
     float sx;
     float sy;
-    Rect dst;
-    Rect src;
-    Color col;
-    if (!g_tm.active) {
+    g_tm.chunks_drawn = 0;
+    g_tm.draws = 0;
+    if (!g_tm.active || !g_tm.chunks) {
         return;
     }
-    for (r = 0; r < g_tm.rows; r++) {
-        for (c = 0; c < g_tm.cols; c++) {
-            tid = g_tm.tiles[r * g_tm.cols + c];
-            if (tid == 0) {
+    cam = game_camera();
+    backend_get_windowsize(&ww, &wh);
+    g_tm.frame++;
+    chunk_w = GAME_TILEMAP_CHUNK * g_tm.tile_w;
+    chunk_h = GAME_TILEMAP_CHUNK * g_tm.tile_h;
+    /* A view spans at most ceil(size / chunk) + 1 chunks per axis. */
+    g_tm.tex_budget = ((ww + chunk_w - 1) / chunk_w + 1 + 2 * GAME_TILEMAP_TEX_MARGIN) *
+                      ((wh + chunk_h - 1) / chunk_h + 1 + 2 * GAME_TILEMAP_TEX_MARGIN);
+    cx0 = (int)floorf(cam->x / (float)chunk_w);
+    cy0 = (int)floorf(cam->y / (float)chunk_h);
+    cx1 = (int)floorf((cam->x + (float)ww - 1.0f) / (float)chunk_w);
+    cy1 = (int)floorf((cam->y + (float)wh - 1.0f) / (float)chunk_h);
+    if (cx0 < 0) cx0 = 0;
+    if (cy0 < 0) cy0 = 0;
+    if (cx1 >= g_tm.chunk_cols) cx1 = g_tm.chunk_cols - 1;
+    if (cy1 >= g_tm.chunk_rows) cy1 = g_tm.chunk_rows - 1;
+    game_camera_world_to_screen(0.0f, 0.0f, &sx, &sy);
+    for (cy = cy0; cy <= cy1; cy++) {
+        for (cx = cx0; cx <= cx1; cx++) {
+            int index = cy * g_tm.chunk_cols + cx;
+            GameTileChunk* ch = &g_tm.chunks[index];
+            int c0 = cx * GAME_TILEMAP_CHUNK;
+            int r0 = cy * GAME_TILEMAP_CHUNK;
+            int c1 = c0 + GAME_TILEMAP_CHUNK - 1;
+            int r1 = r0 + GAME_TILEMAP_CHUNK - 1;
+            Texture* tex;
+            Rect dst;
+            if (ch->filled == 0) {
                 continue;
             }
-            game_camera_world_to_screen((float)(c * g_tm.tile_w), (float)(r * g_tm.tile_h), &sx, &sy);
-            dst.x = (int)sx;
-            dst.y = (int)sy;
-            dst.w = g_tm.tile_w;
-            dst.h = g_tm.tile_h;
-            if (g_tm.texture && g_tm.tileset_cols > 0) {
-                int tc = (tid - 1) % g_tm.tileset_cols;
-                int tr = (tid - 1) / g_tm.tileset_cols;
-                src.x = tc * g_tm.tile_w;
-                src.y = tr * g_tm.tile_h;
-                src.w = g_tm.tile_w;
-                src.h = g_tm.tile_h;
-                backend_render_text_copy(g_tm.texture, &src, &dst);
-            } else {
-                col = (Color){60, 80, 70, 255};
-                if (tid == 2) {
-                    col = (Color){80, 70, 100, 255};
+            if (c1 >= g_tm.cols) c1 = g_tm.cols - 1;
+            if (r1 >= g_tm.rows) r1 = g_tm.rows - 1;
+            dst.x = (int)sx + c0 * g_tm.tile_w;
+            dst.y = (int)sy + r0 * g_tm.tile_h;
+            dst.w = (c1 - c0 + 1) * g_tm.tile_w;
+            dst.h = (r1 - r0 + 1) * g_tm.tile_h;
+            g_tm.chunks_drawn++;
+            tex = game_tilemap_chunk_texture(index, dst.w, dst.h);
+            if (tex && ch->dirty) {
+                if (backend_begin_render_to_texture(tex) == 0) {
+                    game_tilemap_draw_range(c0, r0, c1, r1,
+                                            -c0 * g_tm.tile_w, -r0 * g_tm.tile_h);
+                    backend_end_render_to_texture();
+                    ch->dirty = 0;
+                } else {
+                    tex = NULL;
                 }
-                backend_render_fill_rect(&dst, col);
+            }
+            ch->last_use = g_tm.frame;
+            if (tex) {
+                backend_render_text_copy(tex, NULL, &dst);
+                g_tm.draws++;
+            } else {
+                game_tilemap_draw_range(c0, r0, c1, r1, (int)sx, (int)sy);
             }
         }
     }
@@ -162,7 +675,7 @@ void game_tilemap_collide(GameEntity* e)
     float bx, by, bw, bh;
     float overlap_x, overlap_y;
     float nx, ny;
-    if (!g_tm.active || !e || !e->alive || e->solid) {
+    if (!g_tm.active || !e || !GAME_ALIVE(e) || GAME_SOLID(e)) {
         return;
     }
     game_entity_world_aabb(e, &ax, &ay, &aw, &ah);
@@ -176,7 +689,7 @@ void game_tilemap_collide(GameEntity* e)
     if (r1 >= g_tm.rows) r1 = g_tm.rows - 1;
     for (r = r0; r <= r1; r++) {
         for (c = c0; c <= c1; c++) {
-            tid = g_tm.tiles[r * g_tm.cols + c];
+            tid = g_tm.tiles[(size_t)r * (size_t)g_tm.cols + (size_t)c];
             if (!g_tm.solid_nonzero || tid == 0) {
                 continue;
             }
@@ -188,9 +701,9 @@ void game_tilemap_collide(GameEntity* e)
                 continue;
             }
             /* Triggers (bullets): die on solid tiles instead of sliding. */
-            if (e->trigger) {
-                e->vx = 0;
-                e->vy = 0;
+            if (GAME_TRIGGER(e)) {
+                GAME_VX(e) = 0;
+                GAME_VY(e) = 0;
                 if (e->pooled || e->prefab[0]) {
                     game_pool_release(e);
                 } else {
@@ -211,18 +724,18 @@ void game_tilemap_collide(GameEntity* e)
                 nx = 0;
                 ny = (ay + ah * 0.5f < by + bh * 0.5f) ? -overlap_y : overlap_y;
             }
-            e->x += nx;
-            e->y += ny;
+            GAME_X(e) += nx;
+            GAME_Y(e) += ny;
             ax += nx;
             ay += ny;
-            if (ny < 0 && e->vy > 0) {
-                e->vy = 0;
-                e->grounded = 1;
-            } else if (ny > 0 && e->vy < 0) {
-                e->vy = 0;
+            if (ny < 0 && GAME_VY(e) > 0) {
+                GAME_VY(e) = 0;
+                GAME_SET_FLAG(e, GAME_ENTITY_GROUNDED, 1);
+            } else if (ny > 0 && GAME_VY(e) < 0) {
+                GAME_VY(e) = 0;
             }
             if (nx != 0) {
-                e->vx = 0;
+                GAME_VX(e) = 0;
             }
         }
     }
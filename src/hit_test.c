@@ -0,0 +1,276 @@
+#include "hit_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct HitTestList {
+    Layer** items;
+    int count;
+    int cap;
+} HitTestList;
+
+static int g_valid = 0;
+static Layer* g_root = NULL;
+static Rect g_bounds;
+static int g_cols = 0;
+static int g_rows = 0;
+static int* g_cell_start = NULL;     // 每个单元在 g_cell_items 中的起点，共 cols*rows+1 项
+static int g_cell_cap = 0;
+static Layer** g_cell_items = NULL;
+static int g_cell_items_cap = 0;
+static HitTestList g_layers;          // 重建时收集的可见图层
+static HitTestList g_large;           // 覆盖单元过多的图层
+static HitTestList g_hits;            // 本次移动命中的图层
+static HitTestList g_prev;            // 上一次移动命中的图层
+static Layer* g_capture = NULL;
+static unsigned int g_serial = 0;
+static int g_gating = 0;
+
+static int hit_test_list_push(HitTestList* list, Layer* layer) {
+    if (list->count >= list->cap) {
+        int new_cap = list->cap ? list->cap * 2 : 64;
+        Layer** items = (Layer**)realloc(list->items, (size_t)new_cap * sizeof(Layer*));
+        if (!items) {
+            return 0;
+        }
+        list->items = items;
+        list->cap = new_cap;
+    }
+    list->items[list->count++] = layer;
+    return 1;
+}
+
+static void hit_test_list_remove(HitTestList* list, const Layer* layer) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->items[i] == layer) {
+            list->items[i] = list->items[--list->count];
+            i--;
+        }
+    }
+}
+
+// 与 handle_pointer_event 的遍历一致：跳过不可见子树，包含 sub
+static int hit_test_collect(Layer* layer) {
+    if (!layer || layer->visible != VISIBLE) {
+        return 1;
+    }
+    if (layer->rect.w > 0 && layer->rect.h > 0 && !hit_test_list_push(&g_layers, layer)) {
+        return 0;
+    }
+    if (layer->children) {
+        for (int i = 0; i < layer->child_count; i++) {
+            if (!hit_test_collect(layer->children[i])) {
+                return 0;
+            }
+        }
+    }
+    return hit_test_collect(layer->sub);
+}
+
+// 图层覆盖的单元范围，完全在网格外返回 0
+static int hit_test_cell_range(const Rect* r, int* c0, int* r0, int* c1, int* r1) {
+    int x0 = r->x - g_bounds.x;
+    int y0 = r->y - g_bounds.y;
+    int x1 = x0 + r->w - 1;
+    int y1 = y0 + r->h - 1;
+    if (x1 < 0 || y1 < 0 || x0 >= g_bounds.w || y0 >= g_bounds.h) {
+        return 0;
+    }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= g_bounds.w) x1 = g_bounds.w - 1;
+    if (y1 >= g_bounds.h) y1 = g_bounds.h - 1;
+    *c0 = x0 / HIT_TEST_CELL_SIZE;
+    *r0 = y0 / HIT_TEST_CELL_SIZE;
+    *c1 = x1 / HIT_TEST_CELL_SIZE;
+    *r1 = y1 / HIT_TEST_CELL_SIZE;
+    return 1;
+}
+
+static int hit_test_is_large(int c0, int r0, int c1, int r1) {
+    return (c1 - c0 + 1) * (r1 - r0 + 1) > HIT_TEST_LARGE_CELLS;
+}
+
+static int hit_test_rebuild(Layer* root) {
+    int cells;
+    int total = 0;
+
+    g_valid = 0;
+    g_layers.count = 0;
+    g_large.count = 0;
+    g_root = root;
+    g_bounds = root->rect;
+    if (g_bounds.w <= 0 || g_bounds.h <= 0) {
+        return 0;
+    }
+    g_cols = (g_bounds.w + HIT_TEST_CELL_SIZE - 1) / HIT_TEST_CELL_SIZE;
+    g_rows = (g_bounds.h + HIT_TEST_CELL_SIZE - 1) / HIT_TEST_CELL_SIZE;
+    cells = g_cols * g_rows;
+    if (cells + 1 > g_cell_cap) {
+        int* start = (int*)realloc(g_cell_start, (size_t)(cells + 1) * sizeof(int));
+        if (!start) {
+            return 0;
+        }
+        g_cell_start = start;
+        g_cell_cap = cells + 1;
+    }
+    memset(g_cell_start, 0, (size_t)(cells + 1) * sizeof(int));
+
+    if (!hit_test_collect(root)) {
+        return 0;
+    }
+
+    // 两遍计数排序：先数每个单元的图层数，再按前缀和填入
+    for (int i = 0; i < g_layers.count; i++) {
+        int c0, r0, c1, r1;
+        Layer* layer = g_layers.items[i];
+        if (!hit_test_cell_range(&layer->rect, &c0, &r0, &c1, &r1)) {
+            continue;
+        }
+        if (hit_test_is_large(c0, r0, c1, r1)) {
+            if (!hit_test_list_push(&g_large, layer)) {
+                return 0;
+            }
+            continue;
+        }
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                g_cell_start[r * g_cols + c + 1]++;
+            }
+        }
+    }
+    for (int i = 0; i < cells; i++) {
+        g_cell_start[i + 1] += g_cell_start[i];
+    }
+    total = g_cell_start[cells];
+    if (total > g_cell_items_cap) {
+        Layer** items = (Layer**)realloc(g_cell_items, (size_t)total * sizeof(Layer*));
+        if (!items) {
+            return 0;
+        }
+        g_cell_items = items;
+        g_cell_items_cap = total;
+    }
+    for (int i = 0; i < g_layers.count; i++) {
+        int c0, r0, c1, r1;
+        Layer* layer = g_layers.items[i];
+        if (!hit_test_cell_range(&layer->rect, &c0, &r0, &c1, &r1) ||
+            hit_test_is_large(c0, r0, c1, r1)) {
+            continue;
+        }
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                // 借用 start[cell] 作为写指针，填完后整体右移一格复原
+                g_cell_items[g_cell_start[r * g_cols + c]++] = layer;
+            }
+        }
+    }
+    memmove(g_cell_start + 1, g_cell_start, (size_t)cells * sizeof(int));
+    g_cell_start[0] = 0;
+
+    g_valid = 1;
+    return 1;
+}
+
+static int hit_test_contains(const Layer* layer, int x, int y) {
+    return x >= layer->rect.x && x < layer->rect.x + layer->rect.w &&
+           y >= layer->rect.y && y < layer->rect.y + layer->rect.h;
+}
+
+// 标记图层及其祖先，遇到已标记的祖先即停
+static void hit_test_mark(Layer* layer) {
+    while (layer && layer->hit_stamp != g_serial) {
+        layer->hit_stamp = g_serial;
+        layer = layer->parent;
+    }
+}
+
+void hit_test_invalidate(void) {
+    g_valid = 0;
+}
+
+int hit_test_begin_move(Layer* root, int x, int y) {
+    HitTestList swap;
+    int cell;
+
+    g_gating = 0;
+    if (!root) {
+        return 0;
+    }
+    if (!g_valid || g_root != root) {
+        if (!hit_test_rebuild(root)) {
+            return 0;
+        }
+    }
+    if (x < g_bounds.x || y < g_bounds.y ||
+        x >= g_bounds.x + g_bounds.w || y >= g_bounds.y + g_bounds.h) {
+        return 0;
+    }
+
+    g_hits.count = 0;
+    cell = ((y - g_bounds.y) / HIT_TEST_CELL_SIZE) * g_cols + (x - g_bounds.x) / HIT_TEST_CELL_SIZE;
+    for (int i = g_cell_start[cell]; i < g_cell_start[cell + 1]; i++) {
+        if (hit_test_contains(g_cell_items[i], x, y) && !hit_test_list_push(&g_hits, g_cell_items[i])) {
+            return 0;
+        }
+    }
+    for (int i = 0; i < g_large.count; i++) {
+        if (hit_test_contains(g_large.items[i], x, y) && !hit_test_list_push(&g_hits, g_large.items[i])) {
+            return 0;
+        }
+    }
+
+    g_serial++;
+    if (g_serial == 0) {
+        g_serial = 1;
+    }
+    // 上一次命中的图层再收一次移动，才能把 hover 等状态复原
+    for (int i = 0; i < g_prev.count; i++) {
+        hit_test_mark(g_prev.items[i]);
+    }
+    for (int i = 0; i < g_hits.count; i++) {
+        hit_test_mark(g_hits.items[i]);
+    }
+    hit_test_mark(g_capture);
+
+    swap = g_prev;
+    g_prev = g_hits;
+    g_hits = swap;
+    g_gating = 1;
+    return 1;
+}
+
+void hit_test_end_move(void) {
+    g_gating = 0;
+}
+
+int hit_test_marked(const Layer* layer) {
+    return g_gating && layer && layer->hit_stamp == g_serial;
+}
+
+void hit_test_set_capture(Layer* layer) {
+    g_capture = layer;
+}
+
+Layer* hit_test_get_capture(void) {
+    return g_capture;
+}
+
+void hit_test_release_capture(void) {
+    g_capture = NULL;
+}
+
+void hit_test_forget(Layer* layer) {
+    if (!layer) {
+        return;
+    }
+    if (g_capture == layer) {
+        g_capture = NULL;
+    }
+    if (g_root == layer) {
+        g_root = NULL;
+    }
+    hit_test_list_remove(&g_prev, layer);
+    hit_test_list_remove(&g_hits, layer);
+    g_valid = 0;
+}
@@ -0,0 +1,47 @@
+#ifndef YUI_HIT_TEST_H
+#define YUI_HIT_TEST_H
+
+#include "ytype.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 指针命中索引：把可见图层按 rect 放进均匀网格，POINTER_MOVE 只派发给
+   指针下的图层、上一次命中的图层（处理离开）和捕获目标，以及它们的祖先，
+   不再遍历整棵树。网格在布局、滚动、几何脏标记或新的一帧之后失效，
+   下一次移动事件时按需重建。坐标均为逻辑坐标（与 layer->rect 一致）。 */
+
+#define HIT_TEST_CELL_SIZE   64   // 网格单元边长
+#define HIT_TEST_LARGE_CELLS 64   // 覆盖超过这么多单元的图层放进大图层列表逐个测试
+
+// 标记网格失效（布局、滚动平移、几何变化、渲染新帧后调用）
+void hit_test_invalidate(void);
+
+/**
+ * 根图层收到 POINTER_MOVE 时调用：按需重建网格，标记本次要派发的图层及其祖先
+ * @return 1 表示派发可以按标记裁剪，0 表示指针在网格外，回退到完整遍历
+ */
+int hit_test_begin_move(Layer* root, int x, int y);
+
+// 根图层收到非移动事件时调用，结束按标记裁剪
+void hit_test_end_move(void);
+
+// 当前移动事件是否标记了 layer。已标记图层的子层只派发给已标记的；
+// 未标记的图层（不在索引内，例如 Tab 自行派发的内容层）子层照常遍历
+int hit_test_marked(const Layer* layer);
+
+// 指针捕获：按下时消费事件的图层自动成为捕获目标，抬起或取消时释放；
+// 捕获目标在指针移出其区域后仍能收到移动事件
+void hit_test_set_capture(Layer* layer);
+Layer* hit_test_get_capture(void);
+void hit_test_release_capture(void);
+
+// 图层销毁前调用：移出命中与捕获记录
+void hit_test_forget(Layer* layer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
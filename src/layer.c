@@ -10,6 +10,9 @@
 #include "component_registry.h"
 #include "log.h"
 #include "perf/perf.h"
+#include "damage.h"
+#include "hit_test.h"
+#include "row_stream.h"
 
 Layer* focused_layer = NULL;
 
@@ -336,6 +339,9 @@ void layer_set_text(Layer* layer, const char* value) {
     return;
   }
   layer_set_text_with_size(layer, value);
+  if (layer->on_text_set) {
+    layer->on_text_set(layer);
+  }
   mark_layer_dirty(layer, DIRTY_TEXT);
 }
 
@@ -344,6 +350,9 @@ const char* layer_get_label(const Layer* layer) {
 }
 
 const char* layer_get_text(const Layer* layer) {
+  if (layer && layer->sync_text) {
+    layer->sync_text((Layer*)layer);
+  }
   return layer && layer->text ? layer->text : "";
 }
 
@@ -372,6 +381,11 @@ Layer* layer_create_from_json(cJSON* json_obj, Layer* parent) {
 }
 
 Layer* parse_layer_from_json(Layer* layer,cJSON* json_obj, Layer* parent) {
+  return parse_layer_from_json_ex(layer, json_obj, parent, NULL, NULL);
+}
+
+Layer* parse_layer_from_json_ex(Layer* layer, cJSON* json_obj, Layer* parent,
+                                LayerChildrenBuilder build_children, void* user) {
   if (json_obj == NULL) {
     return NULL;
   }
@@ -406,9 +420,7 @@ Layer* parse_layer_from_json(Layer* layer,cJSON* json_obj, Layer* parent) {
 
   // 解析基础属性
   if (cJSON_HasObjectItem(json_obj, "id")) {
-    strncpy(layer->id, cJSON_GetObjectItem(json_obj, "id")->valuestring,
-            sizeof(layer->id) - 1);
-    layer->id[sizeof(layer->id) - 1] = '\0';
+    layer_set_id(layer, cJSON_GetObjectItem(json_obj, "id")->valuestring);
   }
   if (cJSON_HasObjectItem(json_obj, "connectable")) {
     cJSON* connectable_item = cJSON_GetObjectItem(json_obj, "connectable");
@@ -1083,9 +1095,11 @@ Layer* parse_layer_from_json(Layer* layer,cJSON* json_obj, Layer* parent) {
     skip_children = 1;
   }
 
-  // 递归解析子图层
+  // 递归解析子图层（提供了构建回调时由调用方创建子图层，例如二进制 UI 加载）
   cJSON* children = cJSON_GetObjectItem(json_obj, "children");
-  if (children && !has_custom_children && !skip_children) {
+  if (build_children && !has_custom_children && !skip_children) {
+    build_children(layer, user);
+  } else if (children && !has_custom_children && !skip_children) {
     layer->child_count = cJSON_GetArraySize(children);
     layer->children =
         realloc(layer->children, layer->child_count * sizeof(Layer*));
@@ -1097,6 +1111,7 @@ Layer* parse_layer_from_json(Layer* layer,cJSON* json_obj, Layer* parent) {
         continue;
       }
       layer->children[i] = parse_layer_from_json(NULL,child, layer);
+      layer_index_set_slot(layer->children[i], i);
     }
   }
 
@@ -1125,6 +1140,8 @@ void destroy_layer(Layer* layer) {
     }
 
     layer_lifecycle_before_destroy(layer);
+    layer_index_remove(layer);
+    row_stream_forget_layer(layer);
     
     // 递归销毁子图层
     if (layer->children) {
@@ -1216,32 +1233,45 @@ void destroy_layer(Layer* layer) {
 
     layer_free_strings(layer);
     perf_layer_destroyed(layer);
+    damage_layer_destroyed(layer);
+    layout_scroll_forget(layer);
+    hit_test_forget(layer);
     free(layer);
 }
 
 // 查找图层
-Layer* find_layer_by_id(Layer* root, const char* id) {
-    if (!root || !id) return NULL;
-
+static Layer* find_layer_by_id_scan(Layer* root, const char* id) {
     if (strcmp(root->id, id) == 0) {
         return root;
     }
 
     // 递归查找子图层
     for (int i = 0; i < root->child_count; i++) {
-        Layer* result = find_layer_by_id(root->children[i], id);
+        Layer* result = root->children[i] ? find_layer_by_id_scan(root->children[i], id) : NULL;
         if (result) return result;
     }
 
     // 检查sub图层
     if (root->sub) {
-        Layer* result = find_layer_by_id(root->sub, id);
+        Layer* result = find_layer_by_id_scan(root->sub, id);
         if (result) return result;
     }
 
     return NULL;
 }
 
+Layer* find_layer_by_id(Layer* root, const char* id) {
+    Layer* found;
+
+    if (!root || !id) return NULL;
+
+    // 先查 id 索引，索引无法判断时才遍历子树
+    if (layer_index_lookup(root, id, &found)) {
+        return found;
+    }
+    return find_layer_by_id_scan(root, id);
+}
+
 Layer* layer_resolve_path(Layer* root, const char* path)
 {
     char path_copy[256];
@@ -7,6 +7,7 @@
 #include "cJSON.h"
 #include "ytype.h"
 #include "event.h"
+#include "layer_index.h"
 
 
 cJSON* parse_json(char* json_path);
@@ -19,6 +20,11 @@ int layer_show(Layer* layer, int recursive);
 int layer_hide(Layer* layer);
 void layer_set_visible(Layer* layer, int visible);
 Layer* parse_layer_from_json(Layer* layer,cJSON* json_obj, Layer* parent);
+/** Builds layer->children in place of the JSON "children" array. */
+typedef void (*LayerChildrenBuilder)(Layer* layer, void* user);
+/** Same as parse_layer_from_json; when build_children is set it creates the children. */
+Layer* parse_layer_from_json_ex(Layer* layer, cJSON* json_obj, Layer* parent,
+                                LayerChildrenBuilder build_children, void* user);
 Layer* layer_create_from_json(cJSON* json_obj, Layer* parent) ;
 Layer* layer_create(Layer* root_layer, int x, int y, int width, int height);
 
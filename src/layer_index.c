@@ -0,0 +1,218 @@
+#include "layer_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LAYER_INDEX_MAX_DEPTH      4096  // parent 链超过此深度视为异常，回退遍历
+#define LAYER_INDEX_MAX_CANDIDATES 64    // 同 id 图层过多时遍历提前命中更快
+
+typedef struct LayerIndexPath {
+    int* slots;   // 从图层往上到 root 的各级位置，sub 记为 child_count
+    int count;
+    int cap;
+} LayerIndexPath;
+
+static Layer** g_buckets = NULL;
+static unsigned int g_bucket_cap = 0;
+static unsigned int g_count = 0;
+static unsigned int g_generation = 1;
+static LayerIndexPath g_path_a;
+static LayerIndexPath g_path_b;
+
+static unsigned int layer_index_hash(const char* id) {
+    unsigned int h = 2166136261u;
+    while (*id) {
+        h ^= (unsigned char)*id++;
+        h *= 16777619u;
+    }
+    return h ? h : 1;  // 0 留给“未登记”
+}
+
+static int layer_index_grow(void) {
+    unsigned int cap = g_bucket_cap ? g_bucket_cap * 2 : 256;
+    Layer** buckets = (Layer**)calloc(cap, sizeof(Layer*));
+    if (!buckets) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < g_bucket_cap; i++) {
+        Layer* layer = g_buckets[i];
+        while (layer) {
+            Layer* next = layer->id_next;
+            unsigned int b = layer->id_hash & (cap - 1);
+            layer->id_next = buckets[b];
+            buckets[b] = layer;
+            layer = next;
+        }
+    }
+    free(g_buckets);
+    g_buckets = buckets;
+    g_bucket_cap = cap;
+    return 1;
+}
+
+static void layer_index_bump_generation(void) {
+    if (++g_generation == 0) {
+        g_generation = 1;  // 0 留给缓存方表示“未解析”
+    }
+}
+
+void layer_index_add(Layer* layer) {
+    if (!layer || layer->id_hash || !layer->id[0]) {
+        return;
+    }
+    if (g_count + 1 > g_bucket_cap && !layer_index_grow() && !g_buckets) {
+        return;
+    }
+    layer->id_hash = layer_index_hash(layer->id);
+    unsigned int b = layer->id_hash & (g_bucket_cap - 1);
+    layer->id_next = g_buckets[b];
+    g_buckets[b] = layer;
+    g_count++;
+    layer_index_bump_generation();
+}
+
+void layer_index_remove(Layer* layer) {
+    if (!layer || !layer->id_hash || !g_buckets) {
+        return;
+    }
+    Layer** link = &g_buckets[layer->id_hash & (g_bucket_cap - 1)];
+    while (*link) {
+        if (*link == layer) {
+            *link = layer->id_next;
+            g_count--;
+            layer_index_bump_generation();
+            break;
+        }
+        link = &(*link)->id_next;
+    }
+    layer->id_next = NULL;
+    layer->id_hash = 0;
+}
+
+void layer_set_id(Layer* layer, const char* id) {
+    if (!layer) {
+        return;
+    }
+    layer_index_remove(layer);
+    strncpy(layer->id, id ? id : "", sizeof(layer->id) - 1);
+    layer->id[sizeof(layer->id) - 1] = '\0';
+    layer_index_add(layer);
+}
+
+void layer_index_set_slot(Layer* child, int slot) {
+    if (child) {
+        child->parent_slot = slot;
+    }
+}
+
+// child 在 parent 下的位置，未挂在 parent 下返回 -1
+static int layer_index_slot_of(Layer* parent, Layer* child) {
+    if (parent->children) {
+        int slot = child->parent_slot;
+        if (slot >= 0 && slot < parent->child_count && parent->children[slot] == child) {
+            return slot;
+        }
+        for (int i = 0; i < parent->child_count; i++) {
+            if (parent->children[i] == child) {
+                child->parent_slot = i;
+                return i;
+            }
+        }
+    }
+    if (parent->sub == child) {
+        return parent->child_count;
+    }
+    return -1;
+}
+
+static int layer_index_path_push(LayerIndexPath* path, int slot) {
+    if (path->count >= path->cap) {
+        int cap = path->cap ? path->cap * 2 : 32;
+        int* slots = (int*)realloc(path->slots, (size_t)cap * sizeof(int));
+        if (!slots) {
+            return 0;
+        }
+        path->slots = slots;
+        path->cap = cap;
+    }
+    path->slots[path->count++] = slot;
+    return 1;
+}
+
+// 1 挂在 root 子树中，0 不在，-1 无法判断
+static int layer_index_path(Layer* root, Layer* layer, LayerIndexPath* path) {
+    path->count = 0;
+    while (layer != root) {
+        Layer* parent = layer->parent;
+        if (!parent) {
+            return 0;
+        }
+        int slot = layer_index_slot_of(parent, layer);
+        if (slot < 0) {
+            return 0;
+        }
+        if (path->count >= LAYER_INDEX_MAX_DEPTH || !layer_index_path_push(path, slot)) {
+            return -1;
+        }
+        layer = parent;
+    }
+    return 1;
+}
+
+// 深度优先先序：a 是否排在 b 前面（祖先在前，兄弟按位置）
+static int layer_index_path_before(const LayerIndexPath* a, const LayerIndexPath* b) {
+    int i = a->count - 1;
+    int j = b->count - 1;
+    while (i >= 0 && j >= 0) {
+        if (a->slots[i] != b->slots[j]) {
+            return a->slots[i] < b->slots[j];
+        }
+        i--;
+        j--;
+    }
+    return a->count < b->count;
+}
+
+unsigned int layer_index_generation(void) {
+    return g_generation;
+}
+
+int layer_index_lookup(Layer* root, const char* id, Layer** out) {
+    LayerIndexPath* best_path = &g_path_a;
+    LayerIndexPath* path = &g_path_b;
+    Layer* best = NULL;
+    int registered = 0;
+
+    *out = NULL;
+    if (!root || !id || !id[0]) {
+        return 0;
+    }
+    if (!g_buckets) {
+        return 1;
+    }
+    unsigned int hash = layer_index_hash(id);
+    for (Layer* layer = g_buckets[hash & (g_bucket_cap - 1)]; layer; layer = layer->id_next) {
+        if (layer->id_hash != hash || strcmp(layer->id, id) != 0) {
+            continue;
+        }
+        if (++registered > LAYER_INDEX_MAX_CANDIDATES) {
+            return 0;
+        }
+        int in_tree = layer_index_path(root, layer, path);
+        if (in_tree < 0) {
+            return 0;
+        }
+        if (in_tree && (!best || layer_index_path_before(path, best_path))) {
+            LayerIndexPath swap = *best_path;
+            *best_path = *path;
+            *path = swap;
+            best = layer;
+        }
+    }
+    // 登记了却都不在子树中：可能是模板或 parent 链未维护的图层，交给遍历确认
+    if (!best && registered > 0) {
+        return 0;
+    }
+    *out = best;
+    return 1;
+}
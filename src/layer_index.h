@@ -0,0 +1,41 @@
+#ifndef YUI_LAYER_INDEX_H
+#define YUI_LAYER_INDEX_H
+
+#include "ytype.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* id -> 图层 的哈希索引，供 find_layer_by_id 使用。
+   所有非空 id 的图层在创建或改 id 时登记、销毁时移除，索引是全局的；
+   查找时沿 parent 链确认候选确实挂在 root 之下（children 或 sub），
+   多个候选时取深度优先遍历中最先出现的，与原先的递归查找结果一致。 */
+
+// 按 layer->id 登记，空 id 忽略；重复登记无副作用
+void layer_index_add(Layer* layer);
+
+// 从索引移除（销毁前调用）
+void layer_index_remove(Layer* layer);
+
+// 修改 id 并更新索引，所有改写 layer->id 的地方都应走这里
+void layer_set_id(Layer* layer, const char* id);
+
+// 记录 child 在 parent->children 中的位置，加快挂载校验
+void layer_index_set_slot(Layer* child, int slot);
+
+/**
+ * 在 root 子树中按 id 查找
+ * @return 1 表示索引已给出结论（*out 为结果或 NULL），
+ *         0 表示索引无法判断（空 id，或登记的图层 parent 链与树结构不一致），需回退遍历
+ */
+int layer_index_lookup(Layer* root, const char* id, Layer** out);
+
+// 每次登记或移除都会递增，按 id 缓存图层指针的地方据此判断缓存是否过期
+unsigned int layer_index_generation(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
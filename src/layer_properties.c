@@ -44,8 +44,7 @@ static int handle_label(Layer* layer, cJSON* value, int is_creating) {
 
 static int handle_id(Layer* layer, cJSON* value, int is_creating) {
     if (!cJSON_IsString(value)) return 0;
-    strncpy(layer->id, value->valuestring, sizeof(layer->id) - 1);
-    layer->id[sizeof(layer->id) - 1] = '\0';
+    layer_set_id(layer, value->valuestring);
     return 1;
 }
 
@@ -595,6 +594,22 @@ int layer_set_data(Layer* layer, cJSON* data) {
     return 0;
 }
 
+int layer_append_rows(Layer* layer, cJSON* rows) {
+    if (!layer || !rows || !cJSON_IsArray(rows)) return 0;
+    if (layer->on_rows_append) {
+        return layer->on_rows_append(layer, rows) ? 1 : 0;
+    }
+    return 0;
+}
+
+int layer_update_row(Layer* layer, int index, cJSON* row) {
+    if (!layer || !row || index < 0) return 0;
+    if (layer->on_row_update) {
+        return layer->on_row_update(layer, index, row) ? 2 : 0;
+    }
+    return 0;
+}
+
 int layer_set_property_from_json(Layer* layer, const char* key, cJSON* value, int is_creating) {
     if (!layer || !key || !value) {
         return 0;
@@ -616,13 +631,23 @@ int layer_set_property_from_json(Layer* layer, const char* key, cJSON* value, in
     // 在查找表中查找处理器
     for (int i = 0; property_handlers[i].key != NULL; i++) {
         if (strcmp(key, property_handlers[i].key) == 0) {
-            return property_handlers[i].handler(layer, value, is_creating);
+            int handled = property_handlers[i].handler(layer, value, is_creating);
+            /* 部分处理器不自行标脏，更新路径统一记一次脏区 */
+            if (handled && !is_creating) {
+                mark_layer_dirty(layer, DIRTY_STYLE);
+            }
+            return handled;
         }
     }
 
     if (layer->set_property) {
         int result = layer->set_property(layer, key, value, is_creating);
-        if (result) return result;
+        if (result) {
+            if (!is_creating) {
+                mark_layer_dirty(layer, DIRTY_STYLE);
+            }
+            return result;
+        }
     }
     
     // 未找到处理器
@@ -728,7 +753,7 @@ cJSON* layer_get_property_as_json(Layer* layer, const char* key) {
         return cJSON_CreateString(layer->id);
     }
     else if (strcmp(key, "text") == 0) {
-        return cJSON_CreateString(layer->text);
+        return cJSON_CreateString(layer_get_text(layer));
     }
     else if (strcmp(key, "label") == 0) {
         return cJSON_CreateString(layer->label);
@@ -793,8 +818,9 @@ cJSON* layer_get_property_as_json(Layer* layer, const char* key) {
     }
     else if (strcmp(key, "value") == 0) {
         // 对于大多数组件，value 可以从 text 属性获取
-        if (layer->text && strlen(layer->text) > 0) {
-            return cJSON_CreateString(layer->text);
+        const char* text = layer_get_text(layer);
+        if (text[0]) {
+            return cJSON_CreateString(text);
         }
         
         // 如果没有 text 属性，返回 null
@@ -845,8 +871,8 @@ cJSON* layer_get_all_properties_as_json(Layer* layer) {
     cJSON_AddStringToObject(result, "id", layer->id);
     
     // 文本属性
-    if (layer->text && strlen(layer->text) > 0) {
-        cJSON_AddStringToObject(result, "text", layer->text);
+    if (layer_get_text(layer)[0]) {
+        cJSON_AddStringToObject(result, "text", layer_get_text(layer));
     }
     if (layer->label && strlen(layer->label) > 0) {
         cJSON_AddStringToObject(result, "label", layer->label);
@@ -14,6 +14,19 @@ extern "C" {
  */
 int layer_set_data(Layer* layer, cJSON* data);
 
+/**
+ * 在数据末尾追加行（Table/List），不重建已有行
+ * rows 为数组，其元素被移入组件数据，rows 本身仍由调用者释放
+ * 返回 1 = 已处理；0 = 组件不支持
+ */
+int layer_append_rows(Layer* layer, cJSON* rows);
+
+/**
+ * 替换第 index 行，只作废该行的缓存
+ * 返回 2 = 已处理且接管 row 所有权；0 = 未处理（越界或组件不支持）
+ */
+int layer_update_row(Layer* layer, int index, cJSON* row);
+
 /**
  * 从 JSON 对象解析并设置图层的单个属性
  * 
@@ -1,4 +1,6 @@
 #include "layer_update.h"
+#include "damage.h"
+#include "hit_test.h"
 #include "layer_lifecycle.h"
 #include "layer_properties.h"
 #include "layer.h"
@@ -63,6 +65,10 @@ int parse_int_array(cJSON* array, int* a, int* b) {
 void mark_layer_dirty(Layer* layer, unsigned int flags) {
     if (!layer) return;
     layer->dirty_flags |= flags;
+    damage_add_layer(layer, flags);
+    if (flags & (DIRTY_RECT | DIRTY_LAYOUT | DIRTY_CHILDREN | DIRTY_VISIBLE)) {
+        hit_test_invalidate();
+    }
 }
 
 void clear_dirty_flags(Layer* layer) {
@@ -131,6 +137,7 @@ int yui_remove_child(Layer* parent, const char* child_id) {
     // 移动后续元素（压缩，保持数组无空洞；被销毁项已置 NULL 不影响后续遍历判空）
     for (int i = index; i < parent->child_count - 1; i++) {
         parent->children[i] = parent->children[i + 1];
+        layer_index_set_slot(parent->children[i], i);
     }
     
     parent->child_count--;
@@ -228,6 +235,7 @@ static int yui_append_child_from_json(Layer* parent, cJSON* child_json) {
 
     batch_prealloc_children(parent);
     if (s_batch_depth && parent == s_batch_prealloc_parent) {
+        layer_index_set_slot(new_child, parent->child_count);
         parent->children[parent->child_count++] = new_child;
         return 0;
     }
@@ -240,6 +248,7 @@ static int yui_append_child_from_json(Layer* parent, cJSON* child_json) {
     }
 
     parent->children = new_children;
+    layer_index_set_slot(new_child, parent->child_count);
     parent->children[parent->child_count++] = new_child;
     return 0;
 }
@@ -570,6 +579,20 @@ int yui_update(Layer* root, const char* update_json) {
         return -1;
     }
     
+    int result = yui_update_json(root, json);
+    cJSON_Delete(json);
+    return result;
+}
+
+/**
+ * 应用已解析的更新（单个对象或数组），不接管 json
+ */
+int yui_update_json(Layer* root, cJSON* json) {
+    if (!root || !json) {
+        LOGE("update", "invalid arguments");
+        return -1;
+    }
+
     int result = 0;
     
     if (cJSON_IsArray(json)) {
@@ -625,6 +648,5 @@ int yui_update(Layer* root, const char* update_json) {
         result = -1;
     }
     
-    cJSON_Delete(json);
     return result;
 }
@@ -31,6 +31,13 @@ extern "C" {
  */
 int yui_update(Layer* root, const char* update_json);
 
+/**
+ * 同 yui_update，参数为已解析的 cJSON（JS 对象直接转换，免去字符串往返）
+ * @param json 单个更新对象或数组，调用者负责释放
+ * @return 0 成功，-1 失败
+ */
+int yui_update_json(Layer* root, cJSON* json);
+
 /** Non-zero while a batch YUI.update([]) is applying (defer parent layouts). */
 int yui_update_is_batching(void);
 
@@ -2,6 +2,8 @@
 #include "util.h"
 #include "layer_update.h"
 #include "component_registry.h"
+#include "hit_test.h"
+#include "perf/perf.h"
 
 #ifndef YUI_LAYOUT_TRACE
 #define YUI_LAYOUT_TRACE 0
@@ -232,7 +234,7 @@ static Scrollbar* clone_scrollbar(const Scrollbar* src) {
     return copy;
 }
 
-void layout_layer(Layer* layer){
+static void layout_layer_node(Layer* layer){
     // 添加调试信息，检查layer指针
     if (!layer) {
         layout_trace("layout_layer: NULL layer pointer detected!\n");
@@ -246,6 +248,13 @@ void layout_layer(Layer* layer){
         layout_trace("layout_layer: WARNING: layer %s has child_count>0 but NULL children array!\n", layer->id ? layer->id : "(null)");
         return;
     }
+    hit_test_invalidate();
+
+    // 本次布局按当前偏移重新生成子层坐标，未生效的滚动随之作废
+    layer->scroll_applied = layer->scroll_offset;
+    layer->scroll_applied_x = layer->scroll_offset_x;
+    layer->scroll_axes = 0;
+
      // 计算 layer 的内容尺寸 - 通用算法（List 由 list_component 维护 content 尺寸）
      if (layer->type != LAYER_LIST) {
          layer->content_width = layer->rect.w;
@@ -317,6 +326,7 @@ void layout_layer(Layer* layer){
             // 添加水平滚动偏移量
             if (layer->scrollable == 2 || layer->scrollable == 3) {
                 current_x -= layer->scroll_offset_x;
+                layer->scroll_axes |= 2;
             }
 
             // 初始化内容尺寸
@@ -513,6 +523,7 @@ void layout_layer(Layer* layer){
             // 如果是可滚动的List类型，考虑滚动偏移量
             if (layer->scrollable == 1 || layer->scrollable == 3) {
                 current_y -= layer->scroll_offset;
+                layer->scroll_axes |= 1;
             }
 
             layout_trace("layout_layer: available_height: %d\n", available_height);
@@ -562,6 +573,7 @@ void layout_layer(Layer* layer){
                 if (layer->scrollable == 2 || layer->scrollable == 3) {
                     int original_x = child->rect.x;
                     child->rect.x -= layer->scroll_offset_x;
+                    layer->scroll_axes |= 2;
                     layout_trace("DEBUG: Applied horizontal scroll offset to child '%s': x=%d -> %d (offset=%d)\n", 
                            child->id ? child->id : "(null)", original_x, child->rect.x, layer->scroll_offset_x);
                 }
@@ -635,9 +647,11 @@ void layout_layer(Layer* layer){
 
                 if (layer->scrollable == 1 || layer->scrollable == 3) {
                     child->rect.y -= layer->scroll_offset;
+                    layer->scroll_axes |= 1;
                 }
                 if (layer->scrollable == 2 || layer->scrollable == 3) {
                     child->rect.x -= layer->scroll_offset_x;
+                    layer->scroll_axes |= 2;
                 }
             }
         }
@@ -660,7 +674,7 @@ void layout_layer(Layer* layer){
     // 检查sub指针并递归调用
     if(layer->sub!=NULL){
         layout_trace("layout_layer: processing sub-layer of %s\n", layer->id ? layer->id : "(null)");
-        layout_layer(layer->sub);
+        layout_layer_node(layer->sub);
     } else {
         layout_trace("layout_layer: layer %s has no sub-layer\n", layer->id ? layer->id : "(null)");
     }
@@ -679,7 +693,7 @@ void layout_layer(Layer* layer){
                 continue;
             }
             layout_trace("layout_layer: processing child[%d] of %s\n", i, layer->id ? layer->id : "(null)");
-            layout_layer(layer->children[i]);
+            layout_layer_node(layer->children[i]);
         }
     } else if (layer->child_count > 0) {
         layout_trace("layout_layer: layer %s has %d children but NULL children array\n", layer->id ? layer->id : "(null)", layer->child_count);
@@ -697,6 +711,13 @@ void layout_layer(Layer* layer){
     layout_trace("layout_layer: finished processing layer %s\n", layer->id ? layer->id : "(null)");
 }
 
+// 外层入口计入帧的 layout 阶段，递归走 layout_layer_node
+void layout_layer(Layer* layer){
+    perf_phase_begin(PERF_PHASE_LAYOUT);
+    layout_layer_node(layer);
+    perf_phase_end(PERF_PHASE_LAYOUT);
+}
+
 static int layout_scale_value(int value, float yui_density) {
     if (value <= 0) return value;
     int scaled = (int)(value * yui_density + 0.5f);
@@ -1089,9 +1110,88 @@ int layout_scroll_vertical(Layer* layer, int delta_y) {
     }
 
     if (layer->scroll_offset != old_offset) {
-        layout_layer(layer);
-        mark_layer_dirty(layer, DIRTY_LAYOUT);
+        layout_scroll_changed(layer);
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
+
+// ====================== 滚动平移 ======================
+// 滚动只改变子层位置，不改变尺寸：记录待处理的容器，在渲染/命中测试前
+// 按偏移差把子树整体平移一次，不再对每个滚轮事件重跑布局
+#define LAYOUT_SCROLL_PENDING_MAX 32
+
+static Layer* layout_scroll_pending[LAYOUT_SCROLL_PENDING_MAX];
+static int layout_scroll_pending_count = 0;
+
+static void layout_translate_subtree(Layer* layer, int dx, int dy) {
+    if (!layer) {
+        return;
+    }
+    layer->rect.x += dx;
+    layer->rect.y += dy;
+    if (layer->sub) {
+        layout_translate_subtree(layer->sub, dx, dy);
+    }
+    if (layer->children) {
+        for (int i = 0; i < layer->child_count; i++) {
+            layout_translate_subtree(layer->children[i], dx, dy);
+        }
+    }
+}
+
+static void layout_apply_scroll(Layer* layer) {
+    int dx = 0;
+    int dy = 0;
+
+    if (layer->scroll_axes & 1) {
+        dy = layer->scroll_applied - layer->scroll_offset;
+    }
+    if (layer->scroll_axes & 2) {
+        dx = layer->scroll_applied_x - layer->scroll_offset_x;
+    }
+    layer->scroll_applied = layer->scroll_offset;
+    layer->scroll_applied_x = layer->scroll_offset_x;
+    if ((dx == 0 && dy == 0) || !layer->children) {
+        return;
+    }
+    hit_test_invalidate();
+    // 只移动子层，容器自身和 sub（滚动条等）位置不变
+    for (int i = 0; i < layer->child_count; i++) {
+        layout_translate_subtree(layer->children[i], dx, dy);
+    }
+}
+
+void layout_scroll_changed(Layer* layer) {
+    if (!layer) {
+        return;
+    }
+    // 只需重绘容器区域，不触发重新布局
+    mark_layer_dirty(layer, DIRTY_COLOR);
+    for (int i = 0; i < layout_scroll_pending_count; i++) {
+        if (layout_scroll_pending[i] == layer) {
+            return;
+        }
+    }
+    if (layout_scroll_pending_count >= LAYOUT_SCROLL_PENDING_MAX) {
+        layout_flush_scroll();
+    }
+    layout_scroll_pending[layout_scroll_pending_count++] = layer;
+}
+
+void layout_flush_scroll(void) {
+    // 各容器只按自己的偏移差移动子层，嵌套容器的处理顺序无关
+    for (int i = 0; i < layout_scroll_pending_count; i++) {
+        layout_apply_scroll(layout_scroll_pending[i]);
+    }
+    layout_scroll_pending_count = 0;
+}
+
+void layout_scroll_forget(Layer* layer) {
+    for (int i = 0; i < layout_scroll_pending_count; i++) {
+        if (layout_scroll_pending[i] == layer) {
+            layout_scroll_pending[i] = layout_scroll_pending[--layout_scroll_pending_count];
+            return;
+        }
+    }
+}
@@ -18,6 +18,15 @@ void layout_capture_base(Layer* layer);
 void layout_resize(Layer* layer, int width, int height);
 void layout_dispatch_resize_events(Layer* layer, const ResizeEvent* event);
 int layout_scroll_vertical(Layer* layer, int delta_y);
+
+/* Scrolling without relayout: after changing scroll_offset / scroll_offset_x,
+   call layout_scroll_changed. Child rects are shifted by the offset delta on
+   the next layout_flush_scroll (run before rendering and hit-testing the
+   root), so sizes are not recomputed and bursts of wheel events coalesce. */
+void layout_scroll_changed(Layer* layer);
+void layout_flush_scroll(void);
+/* Drop a destroyed layer from the pending list. */
+void layout_scroll_forget(Layer* layer);
 void layer_dump(const Layer* layer, int depth);
 
 /* Build a cJSON tree for the layer subtree. Caller must cJSON_Delete. */
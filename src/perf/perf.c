@@ -3,6 +3,7 @@
 #include "../render.h"
 #include "../backend.h"
 #include "../component_registry.h"
+#include "../damage.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -11,12 +12,27 @@
 #include <SDL.h>
 #endif
 
+/* 图层槽按需增长；内存紧张的平台可用 -DPERF_MAX_SLOTS=N 设上限（0 不限），
+   超出的图层不统计并计入 layers_untracked */
 #ifndef PERF_MAX_SLOTS
-#define PERF_MAX_SLOTS 512
+#define PERF_MAX_SLOTS 0
+#endif
+// 主循环记录的环形缓冲轮数（开启统计时才分配）
+#ifndef PERF_LOOP_RING
+#define PERF_LOOP_RING 1024
+#endif
+// 每轮记录的阶段区间数，超出的只计入累计耗时
+#ifndef PERF_LOOP_SPANS
+#define PERF_LOOP_SPANS 16
 #endif
 #define PERF_MAX_WATCH 16
 #define PERF_MAX_OVERLAY_LINES 14
 
+// 直方图按微秒对数分桶：16 以下逐一，之后每个 2 的幂再分 16 份（取桶中点，误差约 3%）
+#define PERF_HIST_SUB 16
+#define PERF_HIST_BUCKETS (PERF_HIST_SUB + 28 * PERF_HIST_SUB)
+#define PERF_SERIES_COUNT (PERF_PHASE_COUNT + 1)
+
 typedef struct PerfSlot {
     Layer* layer;
     char id[50];
@@ -33,8 +49,52 @@ static int g_perf_overlay = 0;
 static int g_perf_top_n = 10;
 static int g_perf_log_interval = 0;
 
-static PerfSlot g_slots[PERF_MAX_SLOTS];
+// 阶段的一次最外层进入/退出，偏移相对本轮开始（ns）
+typedef struct PerfPhaseSpan {
+    uint32_t start;
+    uint32_t dur;
+    uint8_t phase;
+} PerfPhaseSpan;
+
+typedef struct PerfLoopRecord {
+    uint64_t index;
+    uint64_t start_ns;
+    uint32_t total_ns;
+    uint32_t wait_ms;
+    uint32_t layers;
+    uint8_t wake_reason;
+    uint8_t rendered;
+    uint16_t phase_mask;                      // 本轮进入过的阶段
+    uint16_t span_count;
+    uint16_t spans_dropped;                   // 超出 PERF_LOOP_SPANS 未记录的区间
+    uint32_t phase_ns[PERF_PHASE_COUNT];      // 本轮累计耗时
+    PerfPhaseSpan spans[PERF_LOOP_SPANS];     // 按结束顺序
+} PerfLoopRecord;
+
+typedef struct PerfHistogram {
+    uint64_t count;
+    uint64_t max_ns;
+    uint32_t buckets[PERF_HIST_BUCKETS];
+} PerfHistogram;
+
+// 图层槽：数组存数据，开放寻址表按 Layer 指针索引到数组下标（-1 为空）
+static PerfSlot* g_slots = NULL;
 static int g_slot_count = 0;
+static int g_slot_capacity = 0;
+static int* g_slot_index = NULL;
+static int g_slot_index_size = 0;
+static int g_slot_dead = 0;     // 图层已销毁的槽数，下一帧开始时压缩
+
+static PerfLoopRecord* g_loops = NULL;
+static int g_loop_next = 0;
+static int g_loop_count = 0;
+static uint64_t g_loop_index = 0;
+static int g_loop_open = 0;
+static int g_wake_fresh = 0;
+static PerfLoopRecord g_loop;
+static uint64_t g_phase_begin_ns[PERF_PHASE_COUNT];
+static int g_phase_depth[PERF_PHASE_COUNT];
+static PerfHistogram* g_hist = NULL;   // PERF_SERIES_COUNT 个
 
 static char g_watch_ids[PERF_MAX_WATCH][50];
 static int g_watch_count = 0;
@@ -72,35 +132,150 @@ int perf_is_enabled(void)
 
 void perf_enable(int on)
 {
+    /* 开启时整屏重绘一帧，保证统计立即有样本 */
+    if (on && !g_perf_enabled) {
+        damage_add_full();
+    }
     g_perf_enabled = on ? 1 : 0;
     if (!g_perf_enabled) {
         g_perf_overlay = 0;
     }
 }
 
+static uint32_t perf_slot_hash(const Layer* layer)
+{
+    uintptr_t v = (uintptr_t)layer >> 4;
+    return (uint32_t)(v * 2654435761u) ^ (uint32_t)(v >> 16);
+}
+
+// 按当前 g_slots 重建索引，size 为 2 的幂
+static int perf_slot_index_rebuild(int size)
+{
+    int* index = (int*)malloc((size_t)size * sizeof(int));
+    if (!index) {
+        return -1;
+    }
+    for (int i = 0; i < size; i++) {
+        index[i] = -1;
+    }
+    for (int i = 0; i < g_slot_count; i++) {
+        uint32_t h;
+        if (!g_slots[i].layer) {
+            continue;
+        }
+        h = perf_slot_hash(g_slots[i].layer) & (uint32_t)(size - 1);
+        while (index[h] >= 0) {
+            h = (h + 1) & (uint32_t)(size - 1);
+        }
+        index[h] = i;
+    }
+    free(g_slot_index);
+    g_slot_index = index;
+    g_slot_index_size = size;
+    return 0;
+}
+
+// 返回索引表中 layer 所在位置，不存在返回 -1
+static int perf_slot_find_pos(const Layer* layer)
+{
+    uint32_t mask;
+    uint32_t h;
+
+    if (!g_slot_index) {
+        return -1;
+    }
+    mask = (uint32_t)(g_slot_index_size - 1);
+    h = perf_slot_hash(layer) & mask;
+    while (g_slot_index[h] >= 0) {
+        if (g_slots[g_slot_index[h]].layer == layer) {
+            return (int)h;
+        }
+        h = (h + 1) & mask;
+    }
+    return -1;
+}
+
 void perf_layer_destroyed(Layer* layer)
 {
+    uint32_t mask;
+    uint32_t hole;
+    uint32_t h;
+    int pos;
+
     if (!layer) return;
+    pos = perf_slot_find_pos(layer);
+    if (pos < 0) {
+        return;
+    }
+    // 槽留到下一帧开始再压缩，本帧的统计仍可读到
+    g_slots[g_slot_index[pos]].layer = NULL;
+    g_slot_dead++;
+
+    // 线性探测的删除：把后续同簇的项前移填洞
+    mask = (uint32_t)(g_slot_index_size - 1);
+    hole = (uint32_t)pos;
+    g_slot_index[hole] = -1;
+    h = (hole + 1) & mask;
+    while (g_slot_index[h] >= 0) {
+        uint32_t home = perf_slot_hash(g_slots[g_slot_index[h]].layer) & mask;
+        if (((h - home) & mask) >= ((h - hole) & mask)) {
+            g_slot_index[hole] = g_slot_index[h];
+            g_slot_index[h] = -1;
+            hole = h;
+        }
+        h = (h + 1) & mask;
+    }
+}
+
+// 去掉已销毁图层的槽
+static void perf_slots_compact(void)
+{
+    int n = 0;
     for (int i = 0; i < g_slot_count; i++) {
-        if (g_slots[i].layer == layer) {
-            g_slots[i].layer = NULL;
-            return;
+        if (g_slots[i].layer) {
+            if (n != i) {
+                g_slots[n] = g_slots[i];
+            }
+            n++;
         }
     }
+    g_slot_count = n;
+    g_slot_dead = 0;
+    if (g_slot_index) {
+        perf_slot_index_rebuild(g_slot_index_size);
+    }
 }
 
 void perf_reset(void)
 {
     g_slot_count = 0;
+    g_slot_dead = 0;
+    if (g_slot_index) {
+        for (int i = 0; i < g_slot_index_size; i++) {
+            g_slot_index[i] = -1;
+        }
+    }
     memset(&g_frame, 0, sizeof(g_frame));
     g_fps_ema = 0.0;
+
+    g_loop_next = 0;
+    g_loop_count = 0;
+    g_loop_index = 0;
+    g_loop_open = 0;
+    g_wake_fresh = 0;
+    if (g_hist) {
+        memset(g_hist, 0, PERF_SERIES_COUNT * sizeof(PerfHistogram));
+    }
 }
 
 void perf_set_overlay(int on)
 {
     g_perf_overlay = on ? 1 : 0;
     if (g_perf_overlay) {
-        g_perf_enabled = 1;
+        perf_enable(1);
+    } else {
+        /* 关闭浮层后需要重绘被它覆盖的区域 */
+        damage_add_full();
     }
 }
 
@@ -182,26 +357,59 @@ void perf_clear_watch(void)
 
 static PerfSlot* perf_get_slot(Layer* layer, int create)
 {
+    PerfSlot* slot;
+    int pos;
+
     if (!layer) {
         return NULL;
     }
 
-    for (int i = 0; i < g_slot_count; i++) {
-        if (g_slots[i].layer == layer) {
-            return &g_slots[i];
-        }
+    pos = perf_slot_find_pos(layer);
+    if (pos >= 0) {
+        return &g_slots[g_slot_index[pos]];
     }
 
-    if (!create || g_slot_count >= PERF_MAX_SLOTS) {
+    if (!create) {
         return NULL;
     }
+    if (PERF_MAX_SLOTS > 0 && g_slot_count >= PERF_MAX_SLOTS) {
+        g_frame.layers_untracked++;
+        return NULL;
+    }
+    if (g_slot_count >= g_slot_capacity) {
+        int capacity = g_slot_capacity > 0 ? g_slot_capacity * 2 : 64;
+        PerfSlot* grown = (PerfSlot*)realloc(g_slots, (size_t)capacity * sizeof(PerfSlot));
+        if (!grown) {
+            g_frame.layers_untracked++;
+            return NULL;
+        }
+        g_slots = grown;
+        g_slot_capacity = capacity;
+    }
+    // 装载率不超过 1/2
+    if ((g_slot_count + 1) * 2 > g_slot_index_size) {
+        int size = g_slot_index_size > 0 ? g_slot_index_size * 2 : 128;
+        if (perf_slot_index_rebuild(size) != 0) {
+            g_frame.layers_untracked++;
+            return NULL;
+        }
+    }
 
-    PerfSlot* slot = &g_slots[g_slot_count++];
+    slot = &g_slots[g_slot_count];
     memset(slot, 0, sizeof(*slot));
     slot->layer = layer;
     strncpy(slot->id, layer->id, sizeof(slot->id) - 1);
     slot->id[sizeof(slot->id) - 1] = '\0';
     slot->type = layer->type;
+    {
+        uint32_t mask = (uint32_t)(g_slot_index_size - 1);
+        uint32_t h = perf_slot_hash(layer) & mask;
+        while (g_slot_index[h] >= 0) {
+            h = (h + 1) & mask;
+        }
+        g_slot_index[h] = g_slot_count;
+    }
+    g_slot_count++;
     return slot;
 }
 
@@ -211,8 +419,13 @@ void perf_frame_begin(void)
         return;
     }
 
+    if (g_slot_dead > 0) {
+        perf_slots_compact();
+    }
+
     g_frame_start_ns = perf_now_ns();
     g_frame.layers_rendered = 0;
+    g_frame.text_rasterized = 0;
 
     for (int i = 0; i < g_slot_count; i++) {
         g_slots[i].frame_count = 0;
@@ -228,6 +441,10 @@ void perf_frame_end(void)
 
     g_frame.frame_ns = perf_now_ns() - g_frame_start_ns;
     g_frame.frame_index++;
+    if (g_loop_open) {
+        g_loop.rendered = 1;
+        g_loop.layers = g_frame.layers_rendered;
+    }
 
     if (g_frame.frame_ns > 0) {
         double instant_fps = 1000000000.0 / (double)g_frame.frame_ns;
@@ -253,13 +470,21 @@ void perf_frame_end(void)
     if (g_perf_log_interval > 0 &&
         g_frame.frame_index % (uint64_t)g_perf_log_interval == 0) {
         PerfLayerStats top[8];
+        PerfPercentiles loop = {0};
         int n = perf_get_layer_stats(top, 8, PERF_SORT_TIME);
-        printf("YUI Perf [frame %llu] fps=%.1f frame=%.2fms render=%.2fms layers=%u\n",
+        perf_get_percentiles(PERF_SERIES_LOOP, &loop);
+        printf("YUI Perf [frame %llu] fps=%.1f frame=%.2fms render=%.2fms layers=%u pixels=%llu skipped=%llu wake=%s/%ums raster=%u loop p50/p95/p99=%.2f/%.2f/%.2fms\n",
                (unsigned long long)g_frame.frame_index,
                g_frame.fps,
                perf_ns_to_ms(g_frame.frame_ns),
                perf_ns_to_ms(g_frame.render_tree_ns),
-               g_frame.layers_rendered);
+               g_frame.layers_rendered,
+               (unsigned long long)g_frame.pixels_redrawn,
+               (unsigned long long)g_frame.frames_skipped,
+               perf_wake_reason_name(g_frame.wake_reason),
+               g_frame.wait_ms,
+               g_frame.text_rasterized,
+               loop.p50_ms, loop.p95_ms, loop.p99_ms);
         for (int i = 0; i < n; i++) {
             printf("  #%d %s type=%d count=%u self=%.2fms\n",
                    i + 1,
@@ -276,6 +501,7 @@ void perf_render_tree_begin(void)
     if (!g_perf_enabled) {
         return;
     }
+    perf_phase_begin(PERF_PHASE_RENDER);
     g_render_tree_start_ns = perf_now_ns();
 }
 
@@ -285,6 +511,320 @@ void perf_render_tree_end(void)
         return;
     }
     g_frame.render_tree_ns = perf_now_ns() - g_render_tree_start_ns;
+    perf_phase_end(PERF_PHASE_RENDER);
+}
+
+void perf_frame_set_pixels_redrawn(uint64_t pixels)
+{
+    if (!g_perf_enabled) {
+        return;
+    }
+    g_frame.pixels_redrawn = pixels;
+}
+
+void perf_frame_skipped(void)
+{
+    if (!g_perf_enabled) {
+        return;
+    }
+    g_frame.frames_skipped++;
+}
+
+void perf_frame_set_wake(int reason, uint32_t wait_ms)
+{
+    if (!g_perf_enabled) {
+        return;
+    }
+    g_frame.wake_reason = reason;
+    g_frame.wait_ms = wait_ms;
+    g_wake_fresh = 1;
+}
+
+void perf_frame_add_text_rasterized(uint32_t count)
+{
+    if (!g_perf_enabled) {
+        return;
+    }
+    g_frame.text_rasterized += count;
+}
+
+const char* perf_wake_reason_name(int reason)
+{
+    switch (reason) {
+    case PERF_WAKE_EVENT:
+        return "event";
+    case PERF_WAKE_TIMER:
+        return "timer";
+    case PERF_WAKE_ANIMATION:
+        return "animation";
+    case PERF_WAKE_POLL:
+        return "poll";
+    case PERF_WAKE_IO:
+        return "io";
+    default:
+        return "none";
+    }
+}
+
+// ====================== 主循环阶段、直方图与 trace ======================
+
+static uint32_t perf_clamp_u32(uint64_t v)
+{
+    return v > 0xFFFFFFFFULL ? 0xFFFFFFFFu : (uint32_t)v;
+}
+
+static int perf_hist_bucket(uint64_t us)
+{
+    int msb = 4;
+
+    if (us < PERF_HIST_SUB) {
+        return (int)us;
+    }
+    while (msb < 31 && (us >> (msb + 1)) != 0) {
+        msb++;
+    }
+    if ((us >> (msb + 1)) != 0) {
+        return PERF_HIST_BUCKETS - 1;
+    }
+    return PERF_HIST_SUB + (msb - 4) * PERF_HIST_SUB + (int)((us >> (msb - 4)) & (PERF_HIST_SUB - 1));
+}
+
+// 桶的中点（微秒）
+static double perf_hist_bucket_mid_us(int index)
+{
+    int msb;
+    int sub;
+    double width;
+
+    if (index < PERF_HIST_SUB) {
+        return (double)index + 0.5;
+    }
+    msb = (index - PERF_HIST_SUB) / PERF_HIST_SUB + 4;
+    sub = (index - PERF_HIST_SUB) % PERF_HIST_SUB;
+    width = (double)(1ULL << (msb - 4));
+    return (double)(PERF_HIST_SUB + sub) * width + width * 0.5;
+}
+
+static void perf_hist_add(int series, uint64_t ns)
+{
+    PerfHistogram* hist = &g_hist[series];
+    hist->buckets[perf_hist_bucket(ns / 1000ULL)]++;
+    hist->count++;
+    if (ns > hist->max_ns) {
+        hist->max_ns = ns;
+    }
+}
+
+const char* perf_phase_name(int phase)
+{
+    switch (phase) {
+    case PERF_PHASE_EVENTS:
+        return "events";
+    case PERF_PHASE_UPDATE:
+        return "update";
+    case PERF_PHASE_TIMERS:
+        return "timers";
+    case PERF_PHASE_LAYOUT:
+        return "layout";
+    case PERF_PHASE_RENDER:
+        return "render";
+    case PERF_PHASE_POPUPS:
+        return "popups";
+    case PERF_PHASE_PRESENT:
+        return "present";
+    case PERF_SERIES_LOOP:
+        return "loop";
+    default:
+        return "unknown";
+    }
+}
+
+void perf_loop_begin(void)
+{
+    if (!g_perf_enabled || g_loop_open) {
+        return;
+    }
+    if (!g_loops) {
+        g_loops = (PerfLoopRecord*)calloc(PERF_LOOP_RING, sizeof(PerfLoopRecord));
+        g_hist = (PerfHistogram*)calloc(PERF_SERIES_COUNT, sizeof(PerfHistogram));
+        if (!g_loops || !g_hist) {
+            free(g_loops);
+            free(g_hist);
+            g_loops = NULL;
+            g_hist = NULL;
+            return;
+        }
+    }
+    memset(&g_loop, 0, sizeof(g_loop));
+    memset(g_phase_depth, 0, sizeof(g_phase_depth));
+    g_loop.start_ns = perf_now_ns();
+    // 只认本轮之前那次等待，避免沿用上一轮的唤醒原因
+    if (g_wake_fresh) {
+        g_loop.wake_reason = (uint8_t)g_frame.wake_reason;
+        g_loop.wait_ms = g_frame.wait_ms;
+        g_wake_fresh = 0;
+    }
+    g_loop_open = 1;
+}
+
+// 阶段最外层退出：累计耗时并记一个区间
+static void perf_phase_close(int phase, uint64_t now)
+{
+    uint32_t dur = perf_clamp_u32(now - g_phase_begin_ns[phase]);
+    g_loop.phase_ns[phase] += dur;
+    if (g_loop.span_count < PERF_LOOP_SPANS) {
+        PerfPhaseSpan* span = &g_loop.spans[g_loop.span_count++];
+        span->start = perf_clamp_u32(g_phase_begin_ns[phase] - g_loop.start_ns);
+        span->dur = dur;
+        span->phase = (uint8_t)phase;
+    } else if (g_loop.spans_dropped < 0xFFFF) {
+        g_loop.spans_dropped++;
+    }
+}
+
+void perf_loop_end(void)
+{
+    uint64_t now;
+
+    if (!g_loop_open) {
+        return;
+    }
+    now = perf_now_ns();
+    // 异常路径上未配对的阶段在这里收尾
+    for (int i = 0; i < PERF_PHASE_COUNT; i++) {
+        if (g_phase_depth[i] > 0) {
+            perf_phase_close(i, now);
+            g_phase_depth[i] = 0;
+        }
+    }
+    g_loop.total_ns = perf_clamp_u32(now - g_loop.start_ns);
+    g_loop.index = g_loop_index++;
+    g_loop_open = 0;
+
+    g_loops[g_loop_next] = g_loop;
+    g_loop_next = (g_loop_next + 1) % PERF_LOOP_RING;
+    if (g_loop_count < PERF_LOOP_RING) {
+        g_loop_count++;
+    }
+
+    perf_hist_add(PERF_SERIES_LOOP, g_loop.total_ns);
+    for (int i = 0; i < PERF_PHASE_COUNT; i++) {
+        if (g_loop.phase_mask & (1u << i)) {
+            perf_hist_add(i, g_loop.phase_ns[i]);
+        }
+    }
+}
+
+void perf_phase_begin(int phase)
+{
+    if (!g_loop_open || phase < 0 || phase >= PERF_PHASE_COUNT) {
+        return;
+    }
+    if (g_phase_depth[phase]++ == 0) {
+        g_phase_begin_ns[phase] = perf_now_ns();
+        g_loop.phase_mask |= (uint16_t)(1u << phase);
+    }
+}
+
+void perf_phase_end(int phase)
+{
+    if (!g_loop_open || phase < 0 || phase >= PERF_PHASE_COUNT || g_phase_depth[phase] <= 0) {
+        return;
+    }
+    if (--g_phase_depth[phase] == 0) {
+        perf_phase_close(phase, perf_now_ns());
+    }
+}
+
+int perf_get_percentiles(int series, PerfPercentiles* out)
+{
+    static const double ranks[3] = {0.50, 0.95, 0.99};
+    double values[3] = {0.0, 0.0, 0.0};
+    PerfHistogram* hist;
+    uint64_t seen = 0;
+    int r = 0;
+
+    if (!out || series < 0 || series >= PERF_SERIES_COUNT) {
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!g_hist || g_hist[series].count == 0) {
+        return -1;
+    }
+    hist = &g_hist[series];
+    for (int i = 0; i < PERF_HIST_BUCKETS && r < 3; i++) {
+        seen += hist->buckets[i];
+        while (r < 3 && (double)seen >= ranks[r] * (double)hist->count) {
+            values[r++] = perf_hist_bucket_mid_us(i) / 1000.0;
+        }
+    }
+    out->count = hist->count;
+    out->max_ms = perf_ns_to_ms(hist->max_ns);
+    // 桶中点可能超过真实最大值
+    out->p50_ms = values[0] < out->max_ms ? values[0] : out->max_ms;
+    out->p95_ms = values[1] < out->max_ms ? values[1] : out->max_ms;
+    out->p99_ms = values[2] < out->max_ms ? values[2] : out->max_ms;
+    return 0;
+}
+
+int perf_loop_record_count(void)
+{
+    return g_loop_count;
+}
+
+/* Chrome trace-event 格式：每轮一个 "loop" 完整事件，阶段的每次最外层进入
+   作为一个嵌套事件，之前的阻塞等待作为 "wait"；时间戳为微秒，从最早一轮的等待开始计。 */
+int perf_export_trace(const char* path)
+{
+    FILE* f;
+    const PerfLoopRecord* first;
+    uint64_t base_ns;
+    int start;
+
+    if (!path || !path[0]) {
+        return -1;
+    }
+    f = fopen(path, "w");
+    if (!f) {
+        printf("YUI Perf: cannot write trace %s\n", path);
+        return -1;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main loop\"}}");
+
+    start = (g_loop_next - g_loop_count + PERF_LOOP_RING) % PERF_LOOP_RING;
+    first = g_loop_count > 0 ? &g_loops[start] : NULL;
+    base_ns = first ? first->start_ns - (uint64_t)first->wait_ms * 1000000ULL : 0;
+
+    for (int n = 0; n < g_loop_count; n++) {
+        const PerfLoopRecord* rec = &g_loops[(start + n) % PERF_LOOP_RING];
+        double ts = (double)(rec->start_ns - base_ns) / 1000.0;
+
+        if (rec->wait_ms > 0) {
+            fprintf(f, ",\n{\"name\":\"wait\",\"cat\":\"idle\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                       "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"wake\":\"%s\"}}",
+                    ts - (double)rec->wait_ms * 1000.0, (double)rec->wait_ms * 1000.0,
+                    perf_wake_reason_name(rec->wake_reason));
+        }
+        fprintf(f, ",\n{\"name\":\"loop\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                   "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"index\":%llu,\"rendered\":%d,\"layers\":%u,"
+                   "\"spansDropped\":%u}}",
+                ts, (double)rec->total_ns / 1000.0, (unsigned long long)rec->index,
+                rec->rendered, rec->layers, (unsigned)rec->spans_dropped);
+        for (int i = 0; i < rec->span_count; i++) {
+            const PerfPhaseSpan* span = &rec->spans[i];
+            fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                       "\"ts\":%.3f,\"dur\":%.3f}",
+                    perf_phase_name(span->phase), ts + (double)span->start / 1000.0,
+                    (double)span->dur / 1000.0);
+        }
+    }
+    fprintf(f, "\n]}\n");
+    if (fclose(f) != 0) {
+        return -1;
+    }
+    return g_loop_count;
 }
 
 void perf_layer_tree_enter(Layer* layer)
@@ -359,10 +899,18 @@ int perf_get_layer_stats(PerfLayerStats* out, int max_count, PerfSortBy sort_by)
         return 0;
     }
 
-    PerfLayerStats temp[PERF_MAX_SLOTS];
+    PerfLayerStats* temp;
     int count = 0;
 
-    for (int i = 0; i < g_slot_count && count < PERF_MAX_SLOTS; i++) {
+    if (g_slot_count == 0) {
+        return 0;
+    }
+    temp = (PerfLayerStats*)malloc((size_t)g_slot_count * sizeof(PerfLayerStats));
+    if (!temp) {
+        return 0;
+    }
+
+    for (int i = 0; i < g_slot_count; i++) {
         PerfSlot* slot = &g_slots[i];
         if (slot->frame_count == 0 && slot->frame_self_ns == 0) {
             continue;
@@ -378,6 +926,7 @@ int perf_get_layer_stats(PerfLayerStats* out, int max_count, PerfSortBy sort_by)
     }
 
     if (count == 0) {
+        free(temp);
         return 0;
     }
 
@@ -393,6 +942,7 @@ int perf_get_layer_stats(PerfLayerStats* out, int max_count, PerfSortBy sort_by)
         count = max_count;
     }
     memcpy(out, temp, (size_t)count * sizeof(PerfLayerStats));
+    free(temp);
     return count;
 }
 
@@ -5,14 +5,54 @@
 
 typedef struct Layer Layer;
 
+// 主循环本帧被唤醒的原因
+typedef enum PerfWakeReason {
+    PERF_WAKE_NONE = 0,        // 未等待（首帧 / 非 SDL 主循环）
+    PERF_WAKE_EVENT = 1,       // 输入或窗口事件
+    PERF_WAKE_TIMER = 2,       // JS 定时器或定时重绘到期
+    PERF_WAKE_ANIMATION = 3,   // 有待绘制的脏区/动画，按刷新周期出帧
+    PERF_WAKE_POLL = 4,        // 无法给出截止时间的 update 回调，按刷新周期轮询
+    PERF_WAKE_IO = 5,          // 后台线程 backend_wake（socket 就绪、图片解码完成等）
+} PerfWakeReason;
+
 typedef struct PerfFrameStats {
     uint64_t frame_index;
     uint64_t frame_ns;
     uint64_t render_tree_ns;
     uint32_t layers_rendered;
     double fps;
+    uint64_t pixels_redrawn;   // 本帧脏区重绘的设备像素数（整屏 = 宽 x 高）
+    uint64_t frames_skipped;   // 无脏区而跳过渲染/提交的帧累计数
+    int wake_reason;           // PerfWakeReason
+    uint32_t wait_ms;          // 本帧之前主循环休眠的毫秒数
+    uint32_t text_rasterized;  // 本帧文本光栅化次数（字符串纹理或图集字形）
+    uint64_t layers_untracked; // 因 PERF_MAX_SLOTS 上限或内存不足未统计的图层次数
 } PerfFrameStats;
 
+/* 主循环一轮内的阶段。阶段可以嵌套（JS 定时器在 update 回调里、布局可能发生在
+   事件或定时器里），同一阶段一轮内多次进入时耗时累加。 */
+typedef enum PerfPhase {
+    PERF_PHASE_EVENTS = 0,     // 输入/窗口事件分发
+    PERF_PHASE_UPDATE = 1,     // update 回调与游戏逻辑
+    PERF_PHASE_TIMERS = 2,     // JS 定时器与 requestAnimationFrame
+    PERF_PHASE_LAYOUT = 3,     // layout_layer
+    PERF_PHASE_RENDER = 4,     // 渲染图层树
+    PERF_PHASE_POPUPS = 5,     // 弹出层
+    PERF_PHASE_PRESENT = 6,    // 提交到屏幕
+    PERF_PHASE_COUNT
+} PerfPhase;
+
+// 百分位统计里“整轮主循环”的序号，紧跟各阶段之后
+#define PERF_SERIES_LOOP PERF_PHASE_COUNT
+
+typedef struct PerfPercentiles {
+    uint64_t count;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+} PerfPercentiles;
+
 typedef enum PerfSortBy {
     PERF_SORT_TIME = 0,
     PERF_SORT_COUNT = 1,
@@ -44,6 +84,26 @@ void perf_frame_begin(void);
 void perf_frame_end(void);
 void perf_render_tree_begin(void);
 void perf_render_tree_end(void);
+void perf_frame_set_pixels_redrawn(uint64_t pixels);
+void perf_frame_skipped(void);
+void perf_frame_set_wake(int reason, uint32_t wait_ms);
+void perf_frame_add_text_rasterized(uint32_t count);
+const char* perf_wake_reason_name(int reason);
+
+/* 主循环一轮（不含阻塞等待）：开启统计后每轮写入环形缓冲并计入直方图。
+   begin 在已开始的一轮内调用无效果，便于等待唤醒处提前开始。 */
+void perf_loop_begin(void);
+void perf_loop_end(void);
+void perf_phase_begin(int phase);
+void perf_phase_end(int phase);
+const char* perf_phase_name(int phase);
+
+// series 为 PerfPhase 或 PERF_SERIES_LOOP；返回 0 成功，-1 无样本或序号无效
+int perf_get_percentiles(int series, PerfPercentiles* out);
+// 环形缓冲中保留的轮数
+int perf_loop_record_count(void);
+// 把环形缓冲导出为 Chrome trace-event JSON（chrome://tracing、Perfetto），返回写出的轮数，失败 -1
+int perf_export_trace(const char* path);
 
 void perf_layer_tree_enter(Layer* layer);
 void perf_layer_add_self_ns(Layer* layer, uint64_t ns);
@@ -3,6 +3,9 @@
 #include "component_registry.h"
 #include "animate.h"
 #include "perf/perf.h"
+#include "damage.h"
+#include "layout.h"
+#include "hit_test.h"
 #include "util.h"
 #include <limits.h>
 #include <math.h>
@@ -38,21 +41,31 @@ void load_textures(Layer* root) {
         } else {
             // 修改为使用image支持多种格式
             char path[YUI_MAX_PATH];
-            
-            // 检查是否为绝对路径（以 '/' 开头，Unix/Linux/macOS）
-            if (root->source[0] == '/') {
-                // 使用绝对路径
-                snprintf(path, sizeof(path), "%s", root->source);
-            } else {
-                // 使用相对路径，拼接 assets 路径
-                snprintf(path, sizeof(path), "%s/%s", root->assets->path, root->source);
-            }
 
-            root->texture=backend_load_texture(path);
+            if (render_image_path(root, path, sizeof(path)) == 0) {
+                root->texture=backend_load_texture(path);
+            }
         }
     }
 }
 
+int render_image_path(Layer* layer, char* out, size_t size) {
+    if (!layer || !layer->source || !layer->source[0] || !out || size == 0) {
+        return -1;
+    }
+    if (strncmp(layer->source, "data:", 5) == 0) {
+        return -1;
+    }
+    // 检查是否为绝对路径（以 '/' 开头，Unix/Linux/macOS）
+    if (layer->source[0] == '/' || !layer->assets || !layer->assets->path[0]) {
+        snprintf(out, size, "%s", layer->source);
+    } else {
+        // 使用相对路径，拼接 assets 路径
+        snprintf(out, size, "%s/%s", layer->assets->path, layer->source);
+    }
+    return 0;
+}
+
 // 递归为所有图层加载字体（backend 按 path+size+weight 缓存 TTF_Font，多图层共享同一指针）
 void load_all_fonts(Layer* layer) {
     int i;
@@ -182,6 +195,26 @@ Texture* render_text(Layer* layer,const char* text, Color color) {
     return texture;
 }
 
+static DFont* render_text_font(Layer* layer) {
+    if (!layer || !layer->font) return NULL;
+    if (!layer->font->default_font) {
+        load_all_fonts(layer);
+    }
+    return layer->font->default_font;
+}
+
+int render_text_size(Layer* layer, const char* text, int* w, int* h) {
+    DFont* font = render_text_font(layer);
+    if (!font || !text || !text[0]) return -1;
+    return backend_text_size(font, text, w, h);
+}
+
+void render_text_at(Layer* layer, const char* text, Color color, const Rect* dst) {
+    DFont* font = render_text_font(layer);
+    if (!font) return;
+    backend_render_text(font, text, color, dst);
+}
+
 void render_layer_background(Layer* layer, const Color* override_bg) {
     Color fill;
     Rect fill_rect;
@@ -242,16 +275,25 @@ void render_layer(Layer* layer) {
     if (layer->visible == IN_VISIBLE) {
         return;
     }
+    if (layer->parent == NULL) {
+        layout_flush_scroll();
+        // 动画等会直接改 rect，新的一帧后命中索引重建
+        hit_test_invalidate();
+    }
 
     /* Fully clipped layers must not render or replace the parent clip.
      * Layers with a custom render function may draw outside their own rect
-     * (e.g. CONNECTOR draws bezier curves at absolute coords). */
-    if (layer->render == NULL) {
+     * (e.g. CONNECTOR draws bezier curves at absolute coords); during a
+     * damage pass the clip is the damage rect, so only CONNECTOR is kept. */
+    if (layer->render == NULL ||
+        (damage_frame_active() && layer->type != CONNECTOR)) {
         Rect parent_clip;
         backend_render_get_clip_rect(&parent_clip);
         if (parent_clip.w > 0 && parent_clip.h > 0) {
+            Rect layer_rect;
             Rect visible_rect;
-            render_rect_intersect(&visible_rect, &layer->rect, &parent_clip);
+            damage_layer_visual_rect(layer, &layer_rect);
+            render_rect_intersect(&visible_rect, &layer_rect, &parent_clip);
             if (visible_rect.w <= 0 || visible_rect.h <= 0) {
                 return;
             }
@@ -10,6 +10,8 @@
 void render_layer(Layer* layer);
 void render_inspect_overlay(Layer* layer);
 void load_textures(Layer* root);
+/* 图层 source 解析成文件路径（相对路径拼 assets 目录）；无源或 data URI 返回 -1 */
+int render_image_path(Layer* layer, char* out, size_t size);
 void load_font(Layer* root);
 void load_all_fonts(Layer* layer);
 
@@ -27,6 +29,9 @@ int render_clip_push(const Rect* local, Rect* prev_out);
 void render_clip_pop(const Rect* prev);
 
 Texture* render_text(Layer* layer,const char* text, Color color);
+/* 不经纹理的文本测量 / 绘制（逻辑像素），SDL 后端走字形图集 */
+int render_text_size(Layer* layer, const char* text, int* w, int* h);
+void render_text_at(Layer* layer, const char* text, Color color, const Rect* dst);
 
 /* 绘制图层阴影 + 背景（纯色或渐变）。override_bg 非空时覆盖 layer->bg_color */
 void render_layer_background(Layer* layer, const Color* override_bg);
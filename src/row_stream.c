@@ -0,0 +1,503 @@
+#include "row_stream.h"
+#include "layer_properties.h"
+#include "backend.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 嵌入式与 wasm 没有工作线程，退化为每帧同步取一批
+#if !defined(ESP_PLATFORM) && !defined(YUI_BACKEND_EMBEDDED) && !defined(__EMSCRIPTEN__)
+#define ROW_STREAM_THREAD 1
+#include <pthread.h>
+#include <time.h>
+#else
+#define ROW_STREAM_THREAD 0
+#endif
+
+#define ROW_STREAM_DEFAULT_BATCH 500
+#define ROW_STREAM_FIRST_BATCH 32                    // 首批尽快送达
+#define ROW_STREAM_FLUSH_NS (50ULL * 1000000ULL)     // 行来得慢时最多攒 50ms
+#define ROW_STREAM_MAX_QUEUED 8                      // 排队批次上限，超过则工作线程等待
+
+typedef struct RowStreamBatch {
+    cJSON* rows;
+    int count;
+    struct RowStreamBatch* next;
+} RowStreamBatch;
+
+typedef struct RowStream {
+    int id;
+    RowStreamSource source;
+    void* ctx;
+    int batch_rows;
+    // 以下只在主线程访问
+    Layer* target;
+    int delivered;
+    int closed;      // 调用者已丢弃记录，结束后即回收
+    int joined;      // 工作线程已回收、ctx 已释放
+    int opened;      // 同步模式：数据源已打开
+    struct RowStream* next;
+    // 以下由 g_lock 保护
+    int cancel;
+    int state;
+    int finished;    // 数据源已关闭，不会再有行
+    int queued;      // 排队中的批次数
+    int sealed;      // 已封口的批次总数，首批之后按 batch_rows 攒
+    RowStreamBatch* head;
+    RowStreamBatch* tail;
+    cJSON* building; // 正在攒的批次；取行阻塞时主线程到期可直接取走
+    int building_count;
+    uint64_t building_since;
+    char error[256];
+#if ROW_STREAM_THREAD
+    pthread_t thread;
+#endif
+} RowStream;
+
+static RowStream* g_streams = NULL;
+static int g_next_id = 1;
+
+#if ROW_STREAM_THREAD
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_space = PTHREAD_COND_INITIALIZER;   // 批次被取走或请求取消
+#define row_stream_lock() pthread_mutex_lock(&g_lock)
+#define row_stream_unlock() pthread_mutex_unlock(&g_lock)
+#else
+#define row_stream_lock() ((void)0)
+#define row_stream_unlock() ((void)0)
+#endif
+
+static uint64_t row_stream_now_ns(void)
+{
+#if ROW_STREAM_THREAD
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#else
+    return 0;   // 同步模式每次 tick 都封口，不需要计时
+#endif
+}
+
+static RowStream* row_stream_find(int id)
+{
+    for (RowStream* s = g_streams; s; s = s->next) {
+        if (s->id == id) return s;
+    }
+    return NULL;
+}
+
+// 把正在攒的批次封口入队（持锁调用）
+static void row_stream_seal_locked(RowStream* s)
+{
+    RowStreamBatch* batch;
+
+    if (!s->building) {
+        return;
+    }
+    batch = (RowStreamBatch*)malloc(sizeof(RowStreamBatch));
+    if (!batch) {
+        return;   // 留在 building 里，下次再试
+    }
+    batch->rows = s->building;
+    batch->count = s->building_count;
+    batch->next = NULL;
+    if (s->tail) {
+        s->tail->next = batch;
+    } else {
+        s->head = batch;
+    }
+    s->tail = batch;
+    s->queued++;
+    s->sealed++;
+    s->building = NULL;
+    s->building_count = 0;
+}
+
+/* 追加一行到正在攒的批次，攒满则封口（队列满时等待主线程取走）。
+   返回 1 表示封口了一批，-1 内存不足 */
+static int row_stream_add_row(RowStream* s, cJSON* row)
+{
+    int sealed = 0;
+
+    row_stream_lock();
+    if (!s->building) {
+        s->building = cJSON_CreateArray();
+        if (!s->building) {
+            row_stream_unlock();
+            cJSON_Delete(row);
+            return -1;
+        }
+        s->building_since = row_stream_now_ns();
+    }
+    cJSON_AddItemToArray(s->building, row);
+    s->building_count++;
+    if (s->building_count >= (s->sealed > 0 ? s->batch_rows : ROW_STREAM_FIRST_BATCH)) {
+#if ROW_STREAM_THREAD
+        while (s->queued >= ROW_STREAM_MAX_QUEUED && !s->cancel) {
+            pthread_cond_wait(&g_space, &g_lock);
+        }
+#endif
+        // 等待期间主线程可能已取走
+        if (s->building) {
+            row_stream_seal_locked(s);
+            sealed = 1;
+        }
+    }
+    row_stream_unlock();
+    return sealed;
+}
+
+static void row_stream_finish(RowStream* s, int state, const char* error)
+{
+    row_stream_lock();
+    if (state == ROW_STREAM_ERROR && s->cancel) {
+        state = ROW_STREAM_CANCELLED;   // 被 interrupt 打断的查询按取消处理
+    }
+    if (state == ROW_STREAM_CANCELLED) {
+        cJSON_Delete(s->building);
+        s->building = NULL;
+        s->building_count = 0;
+    } else {
+        row_stream_seal_locked(s);
+    }
+    s->state = state;
+    if (state == ROW_STREAM_ERROR) {
+        snprintf(s->error, sizeof(s->error), "%s", error && error[0] ? error : "row source failed");
+    }
+    s->finished = 1;
+    row_stream_unlock();
+    backend_wake();
+}
+
+#if ROW_STREAM_THREAD
+static int row_stream_cancelled(RowStream* s)
+{
+    int cancel;
+    row_stream_lock();
+    cancel = s->cancel;
+    row_stream_unlock();
+    return cancel;
+}
+
+static void* row_stream_worker(void* arg)
+{
+    RowStream* s = (RowStream*)arg;
+    char error[256] = {0};
+    int state = ROW_STREAM_DONE;
+
+    if (s->source.open(s->ctx, error, (int)sizeof(error)) != 0) {
+        row_stream_finish(s, ROW_STREAM_ERROR, error);
+        return NULL;
+    }
+
+    for (;;) {
+        cJSON* row = NULL;
+        int r;
+
+        if (row_stream_cancelled(s)) {
+            state = ROW_STREAM_CANCELLED;
+            break;
+        }
+        r = s->source.fetch(s->ctx, &row, error, (int)sizeof(error));
+        if (r <= 0) {
+            state = r == 0 ? ROW_STREAM_DONE : ROW_STREAM_ERROR;
+            break;
+        }
+        r = row_stream_add_row(s, row);
+        if (r < 0) {
+            snprintf(error, sizeof(error), "out of memory");
+            state = ROW_STREAM_ERROR;
+            break;
+        }
+        if (r > 0) {
+            backend_wake();
+        }
+    }
+
+    s->source.close(s->ctx);
+    row_stream_finish(s, state, error);
+    return NULL;
+}
+#else
+// 同步模式：每次 tick 取一批
+static void row_stream_step(RowStream* s)
+{
+    char error[256] = {0};
+    int state = ROW_STREAM_RUNNING;
+
+    if (!s->opened) {
+        if (s->source.open(s->ctx, error, (int)sizeof(error)) != 0) {
+            row_stream_finish(s, ROW_STREAM_ERROR, error);
+            return;
+        }
+        s->opened = 1;
+    }
+    if (s->cancel) {
+        s->source.close(s->ctx);
+        row_stream_finish(s, ROW_STREAM_CANCELLED, NULL);
+        return;
+    }
+
+    for (int i = 0; i < s->batch_rows; i++) {
+        cJSON* row = NULL;
+        int r = s->source.fetch(s->ctx, &row, error, (int)sizeof(error));
+        if (r <= 0) {
+            state = r == 0 ? ROW_STREAM_DONE : ROW_STREAM_ERROR;
+            break;
+        }
+        if (row_stream_add_row(s, row) < 0) {
+            snprintf(error, sizeof(error), "out of memory");
+            state = ROW_STREAM_ERROR;
+            break;
+        }
+    }
+    if (state != ROW_STREAM_RUNNING) {
+        s->source.close(s->ctx);
+        row_stream_finish(s, state, error);
+    } else {
+        row_stream_seal_locked(s);
+    }
+}
+#endif
+
+int row_stream_start(Layer* target, const RowStreamSource* source, void* ctx, int batch_rows)
+{
+    RowStream* s;
+
+    if (!source || !source->open || !source->fetch || !source->close) {
+        return -1;
+    }
+    s = (RowStream*)calloc(1, sizeof(RowStream));
+    if (!s) {
+        return -1;
+    }
+    s->id = g_next_id++;
+    if (g_next_id <= 0) g_next_id = 1;
+    s->source = *source;
+    s->ctx = ctx;
+    s->batch_rows = batch_rows > 0 ? batch_rows : ROW_STREAM_DEFAULT_BATCH;
+    s->target = target;
+    s->state = ROW_STREAM_RUNNING;
+
+#if ROW_STREAM_THREAD
+    if (pthread_create(&s->thread, NULL, row_stream_worker, s) != 0) {
+        printf("row_stream: failed to create worker thread\n");
+        free(s);
+        return -1;
+    }
+#endif
+    s->next = g_streams;
+    g_streams = s;
+    return s->id;
+}
+
+int row_stream_cancel(int id)
+{
+    RowStream* s = row_stream_find(id);
+    int finished;
+
+    if (!s) {
+        return -1;
+    }
+    row_stream_lock();
+    s->cancel = 1;
+    finished = s->finished;
+#if ROW_STREAM_THREAD
+    pthread_cond_broadcast(&g_space);
+#endif
+    row_stream_unlock();
+    // ctx 在工作线程回收前一直有效
+    if (!finished && s->source.interrupt) {
+        s->source.interrupt(s->ctx);
+    }
+    return 0;
+}
+
+int row_stream_status(int id, int* rows, char* error, int error_size)
+{
+    RowStream* s = row_stream_find(id);
+    int state;
+
+    if (!s || s->closed) {
+        return -1;
+    }
+    if (rows) {
+        *rows = s->delivered;
+    }
+    row_stream_lock();
+    // 批次全部送达后才算结束，保证此时 rows 是最终行数
+    state = (s->head || s->building) ? ROW_STREAM_RUNNING : s->state;
+    if (error && error_size > 0) {
+        snprintf(error, (size_t)error_size, "%s", state == ROW_STREAM_ERROR ? s->error : "");
+    }
+    row_stream_unlock();
+    return state;
+}
+
+static void row_stream_free_batches(RowStreamBatch* batch)
+{
+    while (batch) {
+        RowStreamBatch* next = batch->next;
+        cJSON_Delete(batch->rows);
+        free(batch);
+        batch = next;
+    }
+}
+
+// 数据源已关闭：回收线程并释放 ctx
+static void row_stream_reap(RowStream* s)
+{
+    if (s->joined) {
+        return;
+    }
+#if ROW_STREAM_THREAD
+    pthread_join(s->thread, NULL);
+#endif
+    if (s->source.release) {
+        s->source.release(s->ctx);
+    }
+    s->ctx = NULL;
+    s->joined = 1;
+}
+
+static void row_stream_unlink(RowStream* s)
+{
+    RowStream** link = &g_streams;
+    while (*link && *link != s) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = s->next;
+    }
+    row_stream_free_batches(s->head);
+    cJSON_Delete(s->building);
+    free(s);
+}
+
+void row_stream_close(int id)
+{
+    RowStream* s = row_stream_find(id);
+    int finished;
+
+    if (!s) {
+        return;
+    }
+    row_stream_cancel(id);
+    s->closed = 1;
+    s->target = NULL;
+    row_stream_lock();
+    finished = s->finished;
+    row_stream_unlock();
+    if (finished) {
+        row_stream_reap(s);
+        row_stream_unlink(s);
+    }
+}
+
+void row_stream_forget_layer(Layer* layer)
+{
+    for (RowStream* s = g_streams; s; s = s->next) {
+        if (s->target == layer) {
+            s->target = NULL;
+        }
+    }
+}
+
+void row_stream_tick(void)
+{
+    RowStream* s = g_streams;
+
+    while (s) {
+        RowStream* next = s->next;
+        RowStreamBatch* batch;
+        int finished;
+
+#if !ROW_STREAM_THREAD
+        if (!s->finished) {
+            row_stream_step(s);
+        }
+#endif
+        row_stream_lock();
+        // 取行阻塞时不让已攒的行一直等：超过 ROW_STREAM_FLUSH_NS 就先送达
+        if (s->building && row_stream_now_ns() - s->building_since >= ROW_STREAM_FLUSH_NS) {
+            row_stream_seal_locked(s);
+        }
+        batch = s->head;
+        s->head = s->tail = NULL;
+        s->queued = 0;
+        finished = s->finished;
+#if ROW_STREAM_THREAD
+        pthread_cond_broadcast(&g_space);
+#endif
+        row_stream_unlock();
+
+        while (batch) {
+            RowStreamBatch* after = batch->next;
+            if (!s->closed) {
+                if (s->target) {
+                    layer_append_rows(s->target, batch->rows);
+                }
+                s->delivered += batch->count;
+            }
+            cJSON_Delete(batch->rows);
+            free(batch);
+            batch = after;
+        }
+
+        if (finished) {
+            row_stream_reap(s);
+            if (s->closed) {
+                row_stream_unlink(s);
+            }
+        }
+        s = next;
+    }
+}
+
+int row_stream_deadline(void)
+{
+    int deadline = -1;
+    uint64_t now = 0;
+
+    row_stream_lock();
+    for (RowStream* s = g_streams; s; s = s->next) {
+#if ROW_STREAM_THREAD
+        if (s->head || (s->finished && !s->joined)) {
+#else
+        if (s->head || !s->finished) {
+#endif
+            deadline = 0;
+            break;
+        }
+        if (s->building) {
+            uint64_t elapsed;
+            int ms;
+            if (!now) now = row_stream_now_ns();
+            elapsed = now - s->building_since;
+            ms = elapsed >= ROW_STREAM_FLUSH_NS ? 0
+                 : (int)((ROW_STREAM_FLUSH_NS - elapsed + 999999ULL) / 1000000ULL);
+            if (deadline < 0 || ms < deadline) deadline = ms;
+        }
+    }
+    row_stream_unlock();
+    return deadline;
+}
+
+void row_stream_shutdown(void)
+{
+    for (RowStream* s = g_streams; s; s = s->next) {
+        row_stream_cancel(s->id);
+    }
+    while (g_streams) {
+        RowStream* s = g_streams;
+#if !ROW_STREAM_THREAD
+        if (s->opened && !s->finished) {
+            s->source.close(s->ctx);
+        }
+#endif
+        row_stream_reap(s);
+        row_stream_unlink(s);
+    }
+}
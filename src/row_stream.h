@@ -0,0 +1,66 @@
+#ifndef YUI_ROW_STREAM_H
+#define YUI_ROW_STREAM_H
+
+#include "ytype.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 后台行流：数据源在工作线程上逐行产出 cJSON 对象，攒成批次后由主循环
+   （row_stream_tick）直接追加到目标图层的行存储（layer_append_rows），
+   中间不经过 JSON 文本。第一批只攒少量行，慢查询也能先看到结果；
+   排队的行过多时工作线程暂停取行，内存有上限。
+   不支持线程的平台上改由 row_stream_tick 每帧同步取一批。 */
+
+typedef enum {
+    ROW_STREAM_RUNNING = 0,
+    ROW_STREAM_DONE,
+    ROW_STREAM_ERROR,
+    ROW_STREAM_CANCELLED,
+} RowStreamState;
+
+typedef struct {
+    // 工作线程：开始产出（如执行查询），0 成功；失败时自行释放已打开的资源（不会再调 close）
+    int (*open)(void* ctx, char* error, int error_size);
+    // 工作线程：取下一行，1 得到一行（*row 归调用者），0 结束，-1 出错
+    int (*fetch)(void* ctx, cJSON** row, char* error, int error_size);
+    // 工作线程：open 成功后必定调用一次
+    void (*close)(void* ctx);
+    // 任意线程：打断阻塞中的 fetch，可为 NULL（只在行间检查取消）
+    void (*interrupt)(void* ctx);
+    // 主线程：工作线程退出后释放 ctx，可为 NULL
+    void (*release)(void* ctx);
+} RowStreamSource;
+
+/* 启动行流，batch_rows <= 0 取默认值。target 可为 NULL（只计数不显示）。
+   返回流 id（>0），失败返回 -1（此时不会调用 release）。 */
+int row_stream_start(Layer* target, const RowStreamSource* source, void* ctx, int batch_rows);
+
+// 请求取消；已结束的流无影响。返回 0 成功，-1 未知 id
+int row_stream_cancel(int id);
+
+/* 查询状态：返回 RowStreamState，-1 未知 id。
+   rows 为已追加到图层的行数，error 在 ROW_STREAM_ERROR 时给出原因。 */
+int row_stream_status(int id, int* rows, char* error, int error_size);
+
+// 取消并丢弃记录；工作线程仍在阻塞时由后续 tick 回收
+void row_stream_close(int id);
+
+// 图层销毁前调用，之后到达的行直接丢弃
+void row_stream_forget_layer(Layer* layer);
+
+// 主循环更新回调：把已到达的批次追加到目标图层，回收已结束的工作线程
+void row_stream_tick(void);
+
+// 距下次需要 tick 的毫秒数：0 有待追加的批次，-1 无（工作线程到批后会 backend_wake）
+int row_stream_deadline(void);
+
+// 取消全部并等待工作线程退出
+void row_stream_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,7 +6,9 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define printf
+#define printf(...) ((void)0)
+
+static void theme_index_free(ThemeIndex* index);
 
 // 创建主题对象
 Theme* theme_create(const char* name, const char* version) {
@@ -38,6 +40,9 @@ void theme_destroy(Theme* theme) {
         return;
     }
     
+    theme_index_free(theme->index);
+    theme->index = NULL;
+
     // 销毁所有规则
     ThemeRule* current = theme->rules;
     while (current) {
@@ -134,6 +139,9 @@ Theme* theme_load_from_json(cJSON* json) {
             }
         }
     }
+
+    // 加载时编译选择器索引；失败时 theme_apply_to_layer 会再尝试
+    theme_compile(theme);
     
     return theme;
 }
@@ -147,6 +155,10 @@ void theme_add_rule(Theme* theme, ThemeRule* rule) {
     // 插入到链表头部（后添加的规则优先级更高）
     rule->next = theme->rules;
     theme->rules = rule;
+
+    // 索引作废，下一次应用时重建
+    theme_index_free(theme->index);
+    theme->index = NULL;
 }
 
 // 从JSON创建规则
@@ -361,150 +373,510 @@ void theme_rule_destroy(ThemeRule* rule) {
     }
 }
 
-#define THEME_COMPOUND_MARKER "."
-
 static int theme_is_variant_separator(char c) {
     return c == ' ' || c == ',' || c == ';' || c == '\t';
 }
 
-static int theme_variant_contains(const char* variant_str, const char* modifier) {
-    const char* p;
-
-    if (!variant_str || !modifier || modifier[0] == '\0') {
+static int theme_rule_specificity(ThemeRule* rule) {
+    if (!rule) {
         return 0;
     }
 
-    p = variant_str;
-    while (*p) {
-        size_t len;
-
-        while (theme_is_variant_separator(*p)) {
-            p++;
-        }
-        if (*p == '\0') {
-            break;
+    if (rule->selector_type == THEME_SELECTOR_ID) {
+        int count = 1000;
+        const char* dot = strchr(rule->selector, '.');
+        while (dot) {
+            count++;
+            dot = strchr(dot + 1, '.');
         }
+        return count;
+    }
 
-        len = 0;
-        while (p[len] && !theme_is_variant_separator(p[len])) {
-            len++;
-        }
-        if (len > 0 && strlen(modifier) == len && strncmp(p, modifier, len) == 0) {
-            return 1;
+    if (rule->selector_type == THEME_SELECTOR_COMPOUND) {
+        int count = 0;
+        const char* dot = strchr(rule->selector, '.');
+        while (dot) {
+            count++;
+            dot = strchr(dot + 1, '.');
         }
-        p += len;
+        return count;
     }
 
     return 0;
 }
 
-static int theme_variant_contains_all(const char* variant_str, const char* modifiers) {
-    const char* p;
+// ====================== 选择器索引 ======================
+// 规则按 "#id" / "Type" 分桶；复合选择器按 "#id.token" / "Type.token"（第一个修饰符）分桶，
+// 其余修饰符在查找时核对。桶内保存级联序号（specificity 升序，同级按 JSON 顺序）。
+#define THEME_INDEX_BUCKETS 256
+#define THEME_CACHE_BUCKETS 256
+#define THEME_CACHE_MAX 4096
+#define THEME_VARIANT_MAX_TOKENS 32
+#define THEME_CACHE_KEY_MAX 512
 
-    if (!variant_str || variant_str[0] == '\0' || !modifiers || modifiers[0] != '.') {
-        return 0;
+typedef struct ThemeCompiledRule {
+    ThemeRule* rule;
+    int spec;
+    int order;              // JSON 中的顺序
+    char* modifiers;        // 复合选择器的修饰符，以 '\0' 分隔
+    int modifier_count;
+} ThemeCompiledRule;
+
+typedef struct ThemeIndexEntry {
+    char* key;
+    int* ranks;
+    int count;
+    int cap;
+    struct ThemeIndexEntry* next;
+} ThemeIndexEntry;
+
+// 解析缓存：同一 (type, id, variant) 签名的图层共享匹配结果
+typedef struct ThemeCacheEntry {
+    char* key;
+    ThemeRule** rules;
+    int count;
+    struct ThemeCacheEntry* next;
+} ThemeCacheEntry;
+
+struct ThemeIndex {
+    ThemeCompiledRule* rules;   // 按级联顺序排列
+    int rule_count;
+    ThemeIndexEntry* buckets[THEME_INDEX_BUCKETS];
+    ThemeCacheEntry* cache[THEME_CACHE_BUCKETS];
+    int cache_count;
+};
+
+typedef struct ThemeToken {
+    const char* str;
+    int len;
+} ThemeToken;
+
+static unsigned int theme_hash_bytes(unsigned int h, const char* str, int len) {
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)str[i];
+        h *= 16777619u;
     }
+    return h;
+}
+
+// 键由 prefix（'#' 或 0）+ base + ("." + token) 拼成，查找时不必真的拼接
+static unsigned int theme_key_hash(char prefix, const char* base, const char* token, int token_len) {
+    unsigned int h = 2166136261u;
+    if (prefix) {
+        h = theme_hash_bytes(h, &prefix, 1);
+    }
+    h = theme_hash_bytes(h, base, (int)strlen(base));
+    if (token) {
+        h = theme_hash_bytes(h, ".", 1);
+        h = theme_hash_bytes(h, token, token_len);
+    }
+    return h;
+}
 
-    p = modifiers + 1;
-    if (*p == '\0') {
+static int theme_key_equals(const char* key, char prefix, const char* base,
+                            const char* token, int token_len) {
+    size_t base_len = strlen(base);
+    if (prefix) {
+        if (*key != prefix) {
+            return 0;
+        }
+        key++;
+    }
+    if (strncmp(key, base, base_len) != 0) {
         return 0;
     }
+    key += base_len;
+    if (!token) {
+        return *key == '\0';
+    }
+    return key[0] == '.' && strncmp(key + 1, token, (size_t)token_len) == 0 &&
+           key[1 + token_len] == '\0';
+}
 
-    while (*p) {
-        char modifier[32];
-        int i = 0;
-
-        while (*p && *p != '.' && i < (int)sizeof(modifier) - 1) {
-            modifier[i++] = *p++;
+static ThemeIndexEntry* theme_index_find(ThemeIndex* index, char prefix, const char* base,
+                                         const char* token, int token_len) {
+    unsigned int h = theme_key_hash(prefix, base, token, token_len);
+    ThemeIndexEntry* entry = index->buckets[h & (THEME_INDEX_BUCKETS - 1)];
+    while (entry) {
+        if (theme_key_equals(entry->key, prefix, base, token, token_len)) {
+            return entry;
         }
-        modifier[i] = '\0';
-        if (i == 0 || !theme_variant_contains(variant_str, modifier)) {
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+static ThemeIndexEntry* theme_index_get(ThemeIndex* index, char prefix, const char* base,
+                                        const char* token, int token_len) {
+    ThemeIndexEntry* entry = theme_index_find(index, prefix, base, token, token_len);
+    size_t len;
+    unsigned int h;
+    if (entry) {
+        return entry;
+    }
+    entry = (ThemeIndexEntry*)calloc(1, sizeof(ThemeIndexEntry));
+    if (!entry) {
+        return NULL;
+    }
+    len = (prefix ? 1 : 0) + strlen(base) + (token ? (size_t)token_len + 1 : 0);
+    entry->key = (char*)malloc(len + 1);
+    if (!entry->key) {
+        free(entry);
+        return NULL;
+    }
+    snprintf(entry->key, len + 1, "%s%s%s%.*s", prefix ? "#" : "", base,
+             token ? "." : "", token ? token_len : 0, token ? token : "");
+    h = theme_key_hash(prefix, base, token, token_len);
+    entry->next = index->buckets[h & (THEME_INDEX_BUCKETS - 1)];
+    index->buckets[h & (THEME_INDEX_BUCKETS - 1)] = entry;
+    return entry;
+}
+
+static int theme_index_entry_add(ThemeIndexEntry* entry, int rank) {
+    if (entry->count >= entry->cap) {
+        int new_cap = entry->cap ? entry->cap * 2 : 4;
+        int* ranks = (int*)realloc(entry->ranks, (size_t)new_cap * sizeof(int));
+        if (!ranks) {
             return 0;
         }
-        if (*p == '.') {
-            p++;
+        entry->ranks = ranks;
+        entry->cap = new_cap;
+    }
+    entry->ranks[entry->count++] = rank;
+    return 1;
+}
+
+static void theme_cache_clear(ThemeIndex* index) {
+    for (int i = 0; i < THEME_CACHE_BUCKETS; i++) {
+        ThemeCacheEntry* entry = index->cache[i];
+        while (entry) {
+            ThemeCacheEntry* next = entry->next;
+            free(entry->key);
+            free(entry->rules);
+            free(entry);
+            entry = next;
         }
+        index->cache[i] = NULL;
     }
+    index->cache_count = 0;
+}
 
-    return 1;
+static void theme_index_free(ThemeIndex* index) {
+    if (!index) {
+        return;
+    }
+    for (int i = 0; i < THEME_INDEX_BUCKETS; i++) {
+        ThemeIndexEntry* entry = index->buckets[i];
+        while (entry) {
+            ThemeIndexEntry* next = entry->next;
+            free(entry->key);
+            free(entry->ranks);
+            free(entry);
+            entry = next;
+        }
+    }
+    theme_cache_clear(index);
+    for (int i = 0; i < index->rule_count; i++) {
+        free(index->rules[i].modifiers);
+    }
+    free(index->rules);
+    free(index);
 }
 
-static int theme_match_compound_selector(const char* selector, const char* id,
-                                         const char* type, const char* variant) {
-    const char* dot = strchr(selector, THEME_COMPOUND_MARKER[0]);
-    if (!dot || dot == selector) {
-        return 0;
+static int theme_compiled_rule_cmp(const void* a, const void* b) {
+    const ThemeCompiledRule* ra = (const ThemeCompiledRule*)a;
+    const ThemeCompiledRule* rb = (const ThemeCompiledRule*)b;
+    if (ra->spec != rb->spec) {
+        return ra->spec < rb->spec ? -1 : 1;
     }
+    return ra->order - rb->order;
+}
 
-    if (!theme_variant_contains_all(variant, dot)) {
+// 拆出复合选择器的基础部分与修饰符；不可能匹配的选择器（"#.x"、"Button..x"）返回 0
+static int theme_compile_selector(ThemeCompiledRule* compiled, char* base, size_t base_size) {
+    const char* selector = compiled->rule->selector;
+    const char* dot = strchr(selector, '.');
+    size_t base_len;
+
+    if (!dot) {
+        snprintf(base, base_size, "%s", selector[0] == '#' ? selector + 1 : selector);
+        return 1;
+    }
+    base_len = (size_t)(dot - selector);
+    if (selector[0] == '#') {
+        selector++;
+        base_len--;
+    }
+    if (base_len == 0 || base_len >= base_size) {
         return 0;
     }
+    memcpy(base, selector, base_len);
+    base[base_len] = '\0';
 
-    if (selector[0] == '#') {
-        size_t id_len = (size_t)(dot - selector) - 1;
-        if (id_len == 0) {
-            return 0;
+    compiled->modifiers = strdup(dot + 1);
+    if (!compiled->modifiers) {
+        return 0;
+    }
+    compiled->modifier_count = 1;
+    for (char* p = compiled->modifiers; *p; p++) {
+        if (*p == '.') {
+            *p = '\0';
+            compiled->modifier_count++;
         }
-        return strncmp(id, selector + 1, id_len) == 0 && id[id_len] == '\0';
     }
-
+    // 末尾的 '.' 忽略；中间的空修饰符（"Button..x"）永远不匹配
+    if (compiled->modifier_count > 1 && dot[strlen(dot) - 1] == '.') {
+        compiled->modifier_count--;
+    }
     {
-        size_t type_len = (size_t)(dot - selector);
-        return strncmp(type, selector, type_len) == 0 && type[type_len] == '\0';
+        const char* m = compiled->modifiers;
+        for (int i = 0; i < compiled->modifier_count; i++) {
+            if (*m == '\0') {
+                return 0;
+            }
+            m += strlen(m) + 1;
+        }
     }
+    return 1;
 }
 
-static int theme_rule_matches(ThemeRule* rule, Layer* layer, const char* id, const char* type) {
-    if (!rule || !layer || !id || !type) {
-        return 0;
+int theme_compile(Theme* theme) {
+    ThemeIndex* index;
+    int count = 0;
+    int i;
+
+    if (!theme) {
+        return -1;
     }
+    theme_index_free(theme->index);
+    theme->index = NULL;
 
-    if (rule->selector_type == THEME_SELECTOR_ID) {
-        const char* selector_id = rule->selector + 1;
-        const char* dot = strchr(selector_id, '.');
-        if (dot) {
-            return theme_match_compound_selector(rule->selector, id, type, layer->variant);
+    for (ThemeRule* current = theme->rules; current; current = current->next) {
+        count++;
+    }
+    index = (ThemeIndex*)calloc(1, sizeof(ThemeIndex));
+    if (!index) {
+        return -1;
+    }
+    if (count > 0) {
+        index->rules = (ThemeCompiledRule*)calloc((size_t)count, sizeof(ThemeCompiledRule));
+        if (!index->rules) {
+            free(index);
+            return -1;
         }
-        return strcmp(selector_id, id) == 0;
     }
+    index->rule_count = count;
 
-    if (rule->selector_type == THEME_SELECTOR_TYPE) {
-        return strcmp(rule->selector, type) == 0;
+    // 链表头是最后添加的规则，倒过来就是 JSON 顺序
+    i = count - 1;
+    for (ThemeRule* current = theme->rules; current; current = current->next, i--) {
+        index->rules[i].rule = current;
+        index->rules[i].order = i;
+        index->rules[i].spec = theme_rule_specificity(current);
+    }
+    if (count > 1) {
+        qsort(index->rules, (size_t)count, sizeof(ThemeCompiledRule), theme_compiled_rule_cmp);
     }
 
-    if (rule->selector_type == THEME_SELECTOR_COMPOUND) {
-        return theme_match_compound_selector(rule->selector, id, type, layer->variant);
+    for (i = 0; i < count; i++) {
+        ThemeCompiledRule* compiled = &index->rules[i];
+        char prefix = compiled->rule->selector[0] == '#' ? '#' : 0;
+        char base[sizeof(compiled->rule->selector)];
+        ThemeIndexEntry* entry;
+
+        if (!theme_compile_selector(compiled, base, sizeof(base))) {
+            continue;
+        }
+        if (compiled->modifiers) {
+            // 登记 "#id" 本身，解析缓存据此判断 id 是否被规则引用
+            if (prefix && !theme_index_get(index, prefix, base, NULL, 0)) {
+                theme_index_free(index);
+                return -1;
+            }
+            entry = theme_index_get(index, prefix, base, compiled->modifiers,
+                                    (int)strlen(compiled->modifiers));
+        } else {
+            entry = theme_index_get(index, prefix, base, NULL, 0);
+        }
+        if (!entry || !theme_index_entry_add(entry, i)) {
+            theme_index_free(index);
+            return -1;
+        }
     }
 
+    theme->index = index;
     return 0;
 }
 
-static int theme_rule_specificity(ThemeRule* rule) {
-    if (!rule) {
+static int theme_tokenize_variant(const char* variant, ThemeToken* tokens, int max_tokens) {
+    int count = 0;
+    const char* p = variant;
+    if (!p) {
         return 0;
     }
+    while (*p && count < max_tokens) {
+        int len = 0;
+        while (theme_is_variant_separator(*p)) {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        while (p[len] && !theme_is_variant_separator(p[len])) {
+            len++;
+        }
+        tokens[count].str = p;
+        tokens[count].len = len;
+        count++;
+        p += len;
+    }
+    return count;
+}
 
-    if (rule->selector_type == THEME_SELECTOR_ID) {
-        int count = 1000;
-        const char* dot = strchr(rule->selector, '.');
-        while (dot) {
-            count++;
-            dot = strchr(dot + 1, '.');
+static int theme_tokens_contain(const ThemeToken* tokens, int token_count, const char* modifier) {
+    size_t len = strlen(modifier);
+    for (int i = 0; i < token_count; i++) {
+        if ((size_t)tokens[i].len == len && strncmp(tokens[i].str, modifier, len) == 0) {
+            return 1;
         }
-        return count;
     }
+    return 0;
+}
 
-    if (rule->selector_type == THEME_SELECTOR_COMPOUND) {
-        int count = 0;
-        const char* dot = strchr(rule->selector, '.');
-        while (dot) {
-            count++;
-            dot = strchr(dot + 1, '.');
+static int theme_compiled_rule_matches_variant(const ThemeCompiledRule* compiled,
+                                               const ThemeToken* tokens, int token_count) {
+    const char* m = compiled->modifiers;
+    for (int i = 0; i < compiled->modifier_count; i++) {
+        if (!theme_tokens_contain(tokens, token_count, m)) {
+            return 0;
         }
-        return count;
+        m += strlen(m) + 1;
     }
+    return 1;
+}
 
-    return 0;
+static int theme_rank_cmp(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+static int theme_collect_entry(ThemeIndex* index, ThemeIndexEntry* entry, int check_variant,
+                               const ThemeToken* tokens, int token_count,
+                               int** ranks, int* count, int* cap) {
+    if (!entry) {
+        return 1;
+    }
+    for (int i = 0; i < entry->count; i++) {
+        int rank = entry->ranks[i];
+        if (check_variant &&
+            !theme_compiled_rule_matches_variant(&index->rules[rank], tokens, token_count)) {
+            continue;
+        }
+        if (*count >= *cap) {
+            int new_cap = *cap ? *cap * 2 : 16;
+            int* grown = (int*)realloc(*ranks, (size_t)new_cap * sizeof(int));
+            if (!grown) {
+                return 0;
+            }
+            *ranks = grown;
+            *cap = new_cap;
+        }
+        (*ranks)[(*count)++] = rank;
+    }
+    return 1;
+}
+
+// 按索引求出匹配的规则（级联顺序）。返回规则数，-1 表示内存不足
+static int theme_index_match(ThemeIndex* index, const char* id, const char* type,
+                             const char* variant, ThemeRule*** out) {
+    ThemeToken tokens[THEME_VARIANT_MAX_TOKENS];
+    int token_count = theme_tokenize_variant(variant, tokens, THEME_VARIANT_MAX_TOKENS);
+    int* ranks = NULL;
+    int count = 0;
+    int cap = 0;
+    int ok = 1;
+    ThemeRule** rules;
+    int unique = 0;
+
+    *out = NULL;
+    ok = ok && theme_collect_entry(index, theme_index_find(index, '#', id, NULL, 0), 0,
+                                   tokens, token_count, &ranks, &count, &cap);
+    ok = ok && theme_collect_entry(index, theme_index_find(index, 0, type, NULL, 0), 0,
+                                   tokens, token_count, &ranks, &count, &cap);
+    for (int i = 0; ok && i < token_count; i++) {
+        ok = theme_collect_entry(index, theme_index_find(index, '#', id, tokens[i].str, tokens[i].len), 1,
+                                 tokens, token_count, &ranks, &count, &cap) &&
+             theme_collect_entry(index, theme_index_find(index, 0, type, tokens[i].str, tokens[i].len), 1,
+                                 tokens, token_count, &ranks, &count, &cap);
+    }
+    if (!ok) {
+        free(ranks);
+        return -1;
+    }
+    if (count == 0) {
+        free(ranks);
+        return 0;
+    }
+
+    // 变体里重复的 token 会把同一条规则收集多次
+    qsort(ranks, (size_t)count, sizeof(int), theme_rank_cmp);
+    rules = (ThemeRule**)malloc((size_t)count * sizeof(ThemeRule*));
+    if (!rules) {
+        free(ranks);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && ranks[i] == ranks[i - 1]) {
+            continue;
+        }
+        rules[unique++] = index->rules[ranks[i]].rule;
+    }
+    free(ranks);
+    *out = rules;
+    return unique;
+}
+
+// 解析缓存的签名：id 没有被任何规则引用时不参与签名，这类图层按类型与变体共享结果
+static int theme_cache_key(ThemeIndex* index, const char* id, const char* type,
+                           const char* variant, char* key, size_t key_size) {
+    int targeted = theme_index_find(index, '#', id, NULL, 0) != NULL;
+    int len = snprintf(key, key_size, "%s\x1f%s%s\x1f%s", type, targeted ? "#" : "",
+                       targeted ? id : "", variant ? variant : "");
+    return len > 0 && (size_t)len < key_size;
+}
+
+static ThemeCacheEntry* theme_cache_find(ThemeIndex* index, const char* key, unsigned int h) {
+    ThemeCacheEntry* entry = index->cache[h & (THEME_CACHE_BUCKETS - 1)];
+    while (entry) {
+        if (strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+// 成功时缓存接管 rules；失败返回 0，rules 仍归调用方
+static int theme_cache_insert(ThemeIndex* index, const char* key, unsigned int h,
+                              ThemeRule** rules, int count) {
+    ThemeCacheEntry* entry;
+    if (index->cache_count >= THEME_CACHE_MAX) {
+        theme_cache_clear(index);
+    }
+    entry = (ThemeCacheEntry*)calloc(1, sizeof(ThemeCacheEntry));
+    if (!entry) {
+        return 0;
+    }
+    entry->key = strdup(key);
+    if (!entry->key) {
+        free(entry);
+        return 0;
+    }
+    entry->rules = rules;
+    entry->count = count;
+    entry->next = index->cache[h & (THEME_CACHE_BUCKETS - 1)];
+    index->cache[h & (THEME_CACHE_BUCKETS - 1)] = entry;
+    index->cache_count++;
+    return 1;
 }
 
 void theme_apply_component_style(Layer* layer, cJSON* style) {
@@ -533,24 +905,41 @@ void theme_apply_to_layer(Theme* theme, Layer* layer, const char* id, const char
         return;
     }
 
-    ThemeRule* ordered[256];
-    int rule_count = 0;
-    for (ThemeRule* current = theme->rules; current && rule_count < 256; current = current->next) {
-        ordered[rule_count++] = current;
+    if (!theme->index && theme_compile(theme) != 0) {
+        return;
     }
+    ThemeIndex* index = theme->index;
 
-    int max_specificity = -1;
-    for (int i = 0; i < rule_count; i++) {
-        if (!theme_rule_matches(ordered[i], layer, id, type)) {
-            continue;
+    ThemeRule** rules = NULL;
+    int rule_count = 0;
+    int owned = 1;
+    char key[THEME_CACHE_KEY_MAX];
+    unsigned int h = 0;
+    int use_cache = theme_cache_key(index, id, type, layer->variant, key, sizeof(key));
+    ThemeCacheEntry* cached = NULL;
+    if (use_cache) {
+        h = theme_hash_bytes(2166136261u, key, (int)strlen(key));
+        cached = theme_cache_find(index, key, h);
+    }
+    if (cached) {
+        rules = cached->rules;
+        rule_count = cached->count;
+        owned = 0;
+    } else {
+        rule_count = theme_index_match(index, id, type, layer->variant, &rules);
+        if (rule_count < 0) {
+            return;
         }
-        int spec = theme_rule_specificity(ordered[i]);
-        if (spec > max_specificity) {
-            max_specificity = spec;
+        // 无匹配也缓存（rules 为 NULL）
+        if (use_cache && theme_cache_insert(index, key, h, rules, rule_count)) {
+            owned = 0;
         }
     }
 
-    if (max_specificity < 0) {
+    if (rule_count <= 0) {
+        if (owned) {
+            free(rules);
+        }
         return;
     }
 
@@ -559,41 +948,12 @@ void theme_apply_to_layer(Theme* theme, Layer* layer, const char* id, const char
     memset(&layer->bg_gradient, 0, sizeof(layer->bg_gradient));
     memset(&layer->border, 0, sizeof(layer->border));
 
-    printf("[Theme] Applying theme to layer id='%s', type='%s', specificity=%d\n",
-           id, type, max_specificity);
-
-    ThemeRule* matching[256];
-    int matching_spec[256];
-    int matching_count = 0;
-    /* JSON 顺序（低下标先写入）：同 specificity 时后写的覆盖先写的 */
-    for (int i = rule_count - 1; i >= 0 && matching_count < 256; i--) {
-        ThemeRule* current = ordered[i];
-        if (!theme_rule_matches(current, layer, id, type)) {
-            continue;
-        }
-        matching[matching_count] = current;
-        matching_spec[matching_count] = theme_rule_specificity(current);
-        matching_count++;
-    }
-
-    /* 按 specificity 升序稳定排序后级联合并 */
-    for (int a = 0; a < matching_count - 1; a++) {
-        for (int b = 0; b < matching_count - 1 - a; b++) {
-            if (matching_spec[b] > matching_spec[b + 1]) {
-                int tmp_spec = matching_spec[b];
-                ThemeRule* tmp_rule = matching[b];
-                matching_spec[b] = matching_spec[b + 1];
-                matching[b] = matching[b + 1];
-                matching_spec[b + 1] = tmp_spec;
-                matching[b + 1] = tmp_rule;
-            }
-        }
+    /* 级联顺序：specificity 升序，同级按 JSON 顺序，后写的覆盖先写的 */
+    for (int i = 0; i < rule_count; i++) {
+        theme_merge_style(rules[i], layer);
     }
-
-    for (int i = 0; i < matching_count; i++) {
-        printf("[Theme] Merging style for layer id='%s' selector='%s'\n",
-               id, matching[i]->selector);
-        theme_merge_style(matching[i], layer);
+    if (owned) {
+        free(rules);
     }
 }
 
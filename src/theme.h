@@ -35,11 +35,15 @@ typedef struct ThemeRule {
     struct ThemeRule* next;       // 链表下一个
 } ThemeRule;
 
+// 编译后的选择器索引（见 theme_compile）
+typedef struct ThemeIndex ThemeIndex;
+
 // 主题对象
 typedef struct Theme {
     char name[256];
     char version[64];
     ThemeRule* rules;             // 样式规则链表（按优先级排序）
+    ThemeIndex* index;            // 选择器索引与解析缓存，规则变化后作废并按需重建
 } Theme;
 
 // 创建主题对象
@@ -63,6 +67,10 @@ ThemeRule* theme_rule_create_from_json(cJSON* json);
 // 销毁规则
 void theme_rule_destroy(ThemeRule* rule);
 
+// 编译选择器索引：按 id / 类型 / 变体 token 分桶，预先计算 specificity 与级联顺序。
+// 加载时自动调用；theme_add_rule 之后在下一次应用时重建
+int theme_compile(Theme* theme);
+
 // 应用主题样式到图层
 void theme_apply_to_layer(Theme* theme, Layer* layer, const char* id, const char* type);
 
@@ -0,0 +1,1087 @@
+#include "ui_blob.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "layer.h"
+#include "event.h"
+#include "util.h"
+#include "theme.h"
+#include "theme_manager.h"
+#include "component_registry.h"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ESP_PLATFORM)
+#define UI_BLOB_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 值区编码：1 字节标签 + 数据，多字节数据按编译机字节序、不对齐存放
+enum {
+    UI_BLOB_VALUE_NULL = 0,
+    UI_BLOB_VALUE_FALSE,
+    UI_BLOB_VALUE_TRUE,
+    UI_BLOB_VALUE_NUMBER,   // double
+    UI_BLOB_VALUE_INT,      // int32，整数值更紧凑
+    UI_BLOB_VALUE_STRING,   // u32 字符串引用
+    UI_BLOB_VALUE_ARRAY,    // u32 个数 + 元素
+    UI_BLOB_VALUE_OBJECT,   // u32 个数 + (u32 键引用 + 值)
+};
+
+#define UI_BLOB_MAX_DEPTH 64
+
+struct UiBlob {
+    const unsigned char* data;
+    size_t size;
+    int mapped;                 // 1 mmap，2 malloc，0 调用方内存
+    const UiBlobHeader* header;
+    const UiBlobNode* nodes;
+    const UiBlobPlain* plains;
+    int* type_ids;
+    int theme_loaded;
+};
+
+// ====================== 编译 ======================
+
+typedef struct UiBlobBuf {
+    unsigned char* data;
+    size_t size;
+    size_t cap;
+} UiBlobBuf;
+
+typedef struct UiBlobWriter {
+    UiBlobBuf nodes;
+    UiBlobBuf plains;
+    UiBlobBuf values;
+    UiBlobBuf strings;
+    UiBlobBuf types;            // uint32_t 字符串引用
+    uint32_t* slots;            // 字符串去重哈希，存偏移 + 1
+    uint32_t slot_cap;
+    uint32_t string_count;
+    cJSON** queue;              // 广度优先队列，下标即节点号
+    uint32_t queue_count;
+    uint32_t queue_cap;
+    int failed;
+} UiBlobWriter;
+
+static int ui_blob_buf_append(UiBlobBuf* buf, const void* data, size_t len) {
+    if (buf->size + len > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 1024;
+        while (cap < buf->size + len) {
+            cap *= 2;
+        }
+        unsigned char* p = (unsigned char*)realloc(buf->data, cap);
+        if (!p) {
+            return 0;
+        }
+        buf->data = p;
+        buf->cap = cap;
+    }
+    if (len > 0) {
+        memcpy(buf->data + buf->size, data, len);
+    }
+    buf->size += len;
+    return 1;
+}
+
+static void ui_blob_put_u8(UiBlobWriter* w, UiBlobBuf* buf, unsigned char v) {
+    if (!ui_blob_buf_append(buf, &v, 1)) {
+        w->failed = 1;
+    }
+}
+
+static void ui_blob_put_u32(UiBlobWriter* w, UiBlobBuf* buf, uint32_t v) {
+    if (!ui_blob_buf_append(buf, &v, sizeof(v))) {
+        w->failed = 1;
+    }
+}
+
+static uint32_t ui_blob_hash(const char* s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int ui_blob_slots_grow(UiBlobWriter* w) {
+    uint32_t cap = w->slot_cap ? w->slot_cap * 2 : 256;
+    uint32_t* slots = (uint32_t*)calloc(cap, sizeof(uint32_t));
+    if (!slots) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < w->slot_cap; i++) {
+        if (w->slots[i]) {
+            uint32_t j = ui_blob_hash((const char*)w->strings.data + w->slots[i] - 1) & (cap - 1);
+            while (slots[j]) {
+                j = (j + 1) & (cap - 1);
+            }
+            slots[j] = w->slots[i];
+        }
+    }
+    free(w->slots);
+    w->slots = slots;
+    w->slot_cap = cap;
+    return 1;
+}
+
+// 字符串去重后写入字符串池，返回引用
+static uint32_t ui_blob_intern(UiBlobWriter* w, const char* s) {
+    if (!s) {
+        return UI_BLOB_NONE;
+    }
+    if ((w->string_count + 1) * 2 > w->slot_cap && !ui_blob_slots_grow(w)) {
+        w->failed = 1;
+        return UI_BLOB_NONE;
+    }
+    uint32_t j = ui_blob_hash(s) & (w->slot_cap - 1);
+    while (w->slots[j]) {
+        const char* existing = (const char*)w->strings.data + w->slots[j] - 1;
+        if (strcmp(existing, s) == 0) {
+            return w->slots[j] - 1;
+        }
+        j = (j + 1) & (w->slot_cap - 1);
+    }
+    uint32_t offset = (uint32_t)w->strings.size;
+    if (!ui_blob_buf_append(&w->strings, s, strlen(s) + 1)) {
+        w->failed = 1;
+        return UI_BLOB_NONE;
+    }
+    w->slots[j] = offset + 1;
+    w->string_count++;
+    return offset;
+}
+
+static void ui_blob_encode_value(UiBlobWriter* w, cJSON* item, int skip_children, int depth) {
+    if (depth > UI_BLOB_MAX_DEPTH) {
+        w->failed = 1;
+        return;
+    }
+    if (cJSON_IsObject(item)) {
+        uint32_t count = 0;
+        for (cJSON* c = item->child; c; c = c->next) {
+            if (!(skip_children && c->string && strcmp(c->string, "children") == 0)) {
+                count++;
+            }
+        }
+        ui_blob_put_u8(w, &w->values, UI_BLOB_VALUE_OBJECT);
+        ui_blob_put_u32(w, &w->values, count);
+        for (cJSON* c = item->child; c; c = c->next) {
+            if (skip_children && c->string && strcmp(c->string, "children") == 0) {
+                continue;
+            }
+            ui_blob_put_u32(w, &w->values, ui_blob_intern(w, c->string ? c->string : ""));
+            ui_blob_encode_value(w, c, 0, depth + 1);
+        }
+    } else if (cJSON_IsArray(item)) {
+        ui_blob_put_u8(w, &w->values, UI_BLOB_VALUE_ARRAY);
+        ui_blob_put_u32(w, &w->values, (uint32_t)cJSON_GetArraySize(item));
+        for (cJSON* c = item->child; c; c = c->next) {
+            ui_blob_encode_value(w, c, 0, depth + 1);
+        }
+    } else if (cJSON_IsString(item)) {
+        ui_blob_put_u8(w, &w->values, UI_BLOB_VALUE_STRING);
+        ui_blob_put_u32(w, &w->values, ui_blob_intern(w, item->valuestring));
+    } else if (cJSON_IsNumber(item)) {
+        double v = item->valuedouble;
+        if (v >= -2147483648.0 && v <= 2147483647.0 && (double)(int32_t)v == v) {
+            int32_t i = (int32_t)v;
+            ui_blob_put_u8(w, &w->values, UI_BLOB_VALUE_INT);
+            if (!ui_blob_buf_append(&w->values, &i, sizeof(i))) {
+                w->failed = 1;
+            }
+        } else {
+            ui_blob_put_u8(w, &w->values, UI_BLOB_VALUE_NUMBER);
+            if (!ui_blob_buf_append(&w->values, &v, sizeof(v))) {
+                w->failed = 1;
+            }
+        }
+    } else if (cJSON_IsTrue(item)) {
+        ui_blob_put_u8(w, &w->values, UI_BLOB_VALUE_TRUE);
+    } else if (cJSON_IsFalse(item)) {
+        ui_blob_put_u8(w, &w->values, UI_BLOB_VALUE_FALSE);
+    } else {
+        ui_blob_put_u8(w, &w->values, UI_BLOB_VALUE_NULL);
+    }
+}
+
+static uint32_t ui_blob_type_index(UiBlobWriter* w, const char* type_name) {
+    uint32_t ref = ui_blob_intern(w, type_name);
+    uint32_t count = (uint32_t)(w->types.size / sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t existing;
+        memcpy(&existing, w->types.data + i * sizeof(uint32_t), sizeof(existing));
+        if (existing == ref) {
+            return i;
+        }
+    }
+    ui_blob_put_u32(w, &w->types, ref);
+    return count;
+}
+
+static int ui_blob_key_allowed(const char* key, const char* const* keys) {
+    for (int i = 0; keys[i]; i++) {
+        if (strcmp(key, keys[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int ui_blob_is_string(cJSON* obj, const char* key) {
+    cJSON* item = cJSON_GetObjectItem(obj, key);
+    return !item || cJSON_IsString(item);
+}
+
+static int ui_blob_is_number(cJSON* obj, const char* key) {
+    cJSON* item = cJSON_GetObjectItem(obj, key);
+    return !item || cJSON_IsNumber(item);
+}
+
+// 普通节点：没有 create 钩子，属性都能在编译期算好
+static int ui_blob_is_plain(cJSON* json, const char* type_name, const YuiComponentOps* ops) {
+    static const char* const keys[] = {
+        "id", "type", "variant", "font", "fontSize", "fontWeight", "assets",
+        "position", "size", "width", "height", "flex", "label", "text",
+        "visible", "layout", "style", "children", NULL
+    };
+    static const char* const style_keys[] = {
+        "color", "bgColor", "radius", "borderRadius", "padding", "mode",
+        "font", "fontSize", "fontWeight", NULL
+    };
+
+    if (!cJSON_IsObject(json) || (ops && ops->create)) {
+        return 0;
+    }
+    // 编译时未注册的类型运行时可能由插件注册，交给运行时解析
+    if (type_name && type_name[0] && strcmp(type_name, "View") != 0 &&
+        strcmp(type_name, "main") != 0 && strcmp(type_name, "app") != 0 &&
+        yui_type_resolve(type_name) == VIEW) {
+        return 0;
+    }
+    for (cJSON* c = json->child; c; c = c->next) {
+        if (!c->string || !ui_blob_key_allowed(c->string, keys)) {
+            return 0;
+        }
+    }
+    if (!ui_blob_is_string(json, "id") || !ui_blob_is_string(json, "type") ||
+        !ui_blob_is_string(json, "variant") || !ui_blob_is_string(json, "font") ||
+        !ui_blob_is_number(json, "fontSize") || !ui_blob_is_string(json, "fontWeight") ||
+        !ui_blob_is_string(json, "assets") || !ui_blob_is_number(json, "width") ||
+        !ui_blob_is_number(json, "height") || !ui_blob_is_number(json, "flex") ||
+        !ui_blob_is_string(json, "label") || !ui_blob_is_string(json, "text")) {
+        return 0;
+    }
+    cJSON* position = cJSON_GetObjectItem(json, "position");
+    if (position && (!cJSON_IsArray(position) || cJSON_GetArraySize(position) < 2)) {
+        return 0;
+    }
+    cJSON* size = cJSON_GetObjectItem(json, "size");
+    if (size && (!cJSON_IsArray(size) || cJSON_GetArraySize(size) < 1)) {
+        return 0;
+    }
+    cJSON* layout = cJSON_GetObjectItem(json, "layout");
+    if (layout && !cJSON_IsObject(layout)) {
+        return 0;
+    }
+    cJSON* children = cJSON_GetObjectItem(json, "children");
+    if (children && !cJSON_IsArray(children)) {
+        return 0;
+    }
+    cJSON* style = cJSON_GetObjectItem(json, "style");
+    if (style) {
+        if (!cJSON_IsObject(style)) {
+            return 0;
+        }
+        for (cJSON* c = style->child; c; c = c->next) {
+            if (!c->string || !ui_blob_key_allowed(c->string, style_keys)) {
+                return 0;
+            }
+        }
+        if (!ui_blob_is_string(style, "color") || !ui_blob_is_string(style, "bgColor") ||
+            !ui_blob_is_number(style, "radius") || !ui_blob_is_number(style, "borderRadius") ||
+            !ui_blob_is_string(style, "mode") || !ui_blob_is_string(style, "font") ||
+            !ui_blob_is_number(style, "fontSize") || !ui_blob_is_string(style, "fontWeight")) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 与 parse_layer_from_json 的同名属性处理保持一致
+static void ui_blob_fill_plain(UiBlobWriter* w, cJSON* json, UiBlobPlain* plain, uint32_t* flags) {
+    cJSON* style = cJSON_GetObjectItem(json, "style");
+    cJSON* item;
+
+    plain->id = ui_blob_intern(w, cJSON_GetStringValue(cJSON_GetObjectItem(json, "id")));
+    plain->variant = ui_blob_intern(w, cJSON_GetStringValue(cJSON_GetObjectItem(json, "variant")));
+
+    cJSON* font = cJSON_GetObjectItem(json, "font");
+    cJSON* font_size = cJSON_GetObjectItem(json, "fontSize");
+    cJSON* font_weight = cJSON_GetObjectItem(json, "fontWeight");
+    cJSON* style_font = style ? cJSON_GetObjectItem(style, "font") : NULL;
+    cJSON* style_font_size = style ? cJSON_GetObjectItem(style, "fontSize") : NULL;
+    cJSON* style_font_weight = style ? cJSON_GetObjectItem(style, "fontWeight") : NULL;
+    if (font || font_size || font_weight || style_font || style_font_size || style_font_weight) {
+        *flags |= UI_BLOB_NODE_FONT;
+        plain->font_path = ui_blob_intern(w, font ? font->valuestring :
+                                            style_font ? style_font->valuestring :
+                                            "Roboto-Regular.ttf");
+        plain->font_size = font_size ? font_size->valueint :
+                          style_font_size ? style_font_size->valueint : 16;
+        plain->font_weight = ui_blob_intern(w, font_weight ? font_weight->valuestring :
+                                              style_font_weight ? style_font_weight->valuestring :
+                                              "normal");
+    }
+
+    item = cJSON_GetObjectItem(json, "assets");
+    if (item) {
+        *flags |= UI_BLOB_NODE_ASSETS;
+        plain->assets = ui_blob_intern(w, item->valuestring);
+    }
+
+    item = cJSON_GetObjectItem(json, "position");
+    if (item) {
+        plain->rect[0] = cJSON_GetArrayItem(item, 0)->valueint;
+        plain->rect[1] = cJSON_GetArrayItem(item, 1)->valueint;
+    }
+    item = cJSON_GetObjectItem(json, "size");
+    if (item) {
+        plain->rect[2] = cJSON_GetArrayItem(item, 0)->valueint;
+        plain->rect[3] = cJSON_GetArraySize(item) > 1 ? cJSON_GetArrayItem(item, 1)->valueint
+                                                     : plain->rect[2];
+        plain->fixed_height = plain->rect[3];
+        plain->fixed_width = plain->rect[2] > 0 ? plain->rect[2] : 0;
+    }
+    item = cJSON_GetObjectItem(json, "width");
+    if (item) {
+        plain->fixed_width = plain->rect[2] = item->valueint;
+    }
+    item = cJSON_GetObjectItem(json, "height");
+    if (item) {
+        plain->fixed_height = plain->rect[3] = item->valueint;
+    }
+    item = cJSON_GetObjectItem(json, "flex");
+    if (item) {
+        plain->flex = (float)item->valuedouble;
+    }
+
+    item = cJSON_GetObjectItem(json, "label");
+    if (item) {
+        *flags |= UI_BLOB_NODE_LABEL;
+        plain->label = ui_blob_intern(w, item->valuestring);
+    }
+    item = cJSON_GetObjectItem(json, "text");
+    if (item) {
+        *flags |= UI_BLOB_NODE_TEXT;
+        plain->text = ui_blob_intern(w, item->valuestring);
+    }
+    item = cJSON_GetObjectItem(json, "visible");
+    if (item) {
+        *flags |= UI_BLOB_NODE_VISIBLE;
+        if (cJSON_IsTrue(item)) {
+            *flags |= UI_BLOB_NODE_SHOWN;
+        }
+    }
+
+    // 布局用临时图层算出最终的 LayoutManager
+    Layer scratch;
+    LayoutManager manager;
+    int layout_padding_set = 0;
+    memset(&scratch, 0, sizeof(scratch));
+    memset(&manager, 0, sizeof(manager));
+    manager.type = LAYOUT_VERTICAL;
+    item = cJSON_GetObjectItem(json, "layout");
+    if (item) {
+        layer_apply_layout_from_json(&scratch, item);
+        if (scratch.layout_manager) {
+            manager = *scratch.layout_manager;
+            free(scratch.layout_manager);
+            scratch.layout_manager = NULL;
+        }
+        layout_padding_set = cJSON_GetObjectItem(item, "padding") != NULL;
+    }
+
+    Color color = {0, 0, 0, 0};
+    Color bg_color = {0xF5, 0xF5, 0xF5, 0xFF};
+    if (style) {
+        item = cJSON_GetObjectItem(style, "color");
+        if (item) {
+            parse_color(item->valuestring, &color);
+        }
+        item = cJSON_GetObjectItem(style, "bgColor");
+        if (item) {
+            parse_color(item->valuestring, &bg_color);
+        }
+        item = cJSON_GetObjectItem(style, "radius");
+        if (!item) {
+            item = cJSON_GetObjectItem(style, "borderRadius");
+        }
+        plain->radius = item ? item->valueint : 0;
+        item = cJSON_GetObjectItem(style, "padding");
+        if (item && layer_padding_apply_from_json(scratch.padding, item) && !layout_padding_set) {
+            memcpy(manager.padding, scratch.padding, sizeof(manager.padding));
+        }
+        item = cJSON_GetObjectItem(style, "mode");
+        if (item) {
+            if (strcmp(item->valuestring, "fit") == 0) {
+                plain->image_mode = IMAGE_MODE_ASPECT_FIT;
+            } else if (strcmp(item->valuestring, "fill") == 0) {
+                plain->image_mode = IMAGE_MODE_ASPECT_FILL;
+            } else if (strcmp(item->valuestring, "stretch") == 0) {
+                plain->image_mode = IMAGE_MODE_STRETCH;
+            }
+        }
+    }
+    plain->color[0] = color.r;
+    plain->color[1] = color.g;
+    plain->color[2] = color.b;
+    plain->color[3] = color.a;
+    plain->bg_color[0] = bg_color.r;
+    plain->bg_color[1] = bg_color.g;
+    plain->bg_color[2] = bg_color.b;
+    plain->bg_color[3] = bg_color.a;
+    memcpy(plain->padding, scratch.padding, sizeof(plain->padding));
+    plain->layout_type = manager.type;
+    plain->layout_spacing = manager.spacing;
+    memcpy(plain->layout_padding, manager.padding, sizeof(plain->layout_padding));
+    plain->layout_align = manager.align;
+    plain->layout_justify = manager.justify;
+    plain->layout_columns = manager.columns;
+}
+
+static int ui_blob_queue_push(UiBlobWriter* w, cJSON* json) {
+    if (w->queue_count >= w->queue_cap) {
+        uint32_t cap = w->queue_cap ? w->queue_cap * 2 : 256;
+        cJSON** queue = (cJSON**)realloc(w->queue, cap * sizeof(cJSON*));
+        if (!queue) {
+            return 0;
+        }
+        w->queue = queue;
+        w->queue_cap = cap;
+    }
+    w->queue[w->queue_count++] = json;
+    return 1;
+}
+
+static void ui_blob_write_node(UiBlobWriter* w, cJSON* json) {
+    UiBlobNode node;
+    UiBlobPlain plain;
+    const char* type_name = cJSON_GetStringValue(cJSON_GetObjectItem(json, "type"));
+    int type_id = yui_type_resolve(type_name);
+    const YuiComponentOps* ops = yui_type_get_ops(type_id);
+    int emit_children = 1;
+
+    memset(&node, 0, sizeof(node));
+    node.type = ui_blob_type_index(w, type_name ? type_name : "View");
+
+    // 与 yui_component_instantiate 一致：自定义子节点的组件自己读 children
+    if (ops && (ops->flags & YUI_COMP_SKIP_CHILDREN)) {
+        emit_children = 0;
+    }
+    if (ops && ops->create && (ops->flags & YUI_COMP_CUSTOM_CHILDREN)) {
+        emit_children = 0;
+    }
+
+    if (ui_blob_is_plain(json, type_name, ops)) {
+        memset(&plain, 0, sizeof(plain));
+        plain.id = plain.variant = plain.label = plain.text = UI_BLOB_NONE;
+        plain.font_path = plain.font_weight = plain.assets = UI_BLOB_NONE;
+        ui_blob_fill_plain(w, json, &plain, &node.flags);
+        node.data = (uint32_t)(w->plains.size / sizeof(UiBlobPlain));
+        if (!ui_blob_buf_append(&w->plains, &plain, sizeof(plain))) {
+            w->failed = 1;
+        }
+    } else {
+        int keep_children = ops && ops->create && (ops->flags & YUI_COMP_CUSTOM_CHILDREN);
+        node.flags |= UI_BLOB_NODE_PAYLOAD;
+        node.data = (uint32_t)w->values.size;
+        ui_blob_encode_value(w, json, !keep_children, 0);
+    }
+
+    cJSON* children = cJSON_GetObjectItem(json, "children");
+    if (emit_children && cJSON_IsArray(children)) {
+        node.first_child = w->queue_count;
+        for (cJSON* c = children->child; c; c = c->next) {
+            if (!ui_blob_queue_push(w, c)) {
+                w->failed = 1;
+                break;
+            }
+            node.child_count++;
+        }
+    }
+    if (!ui_blob_buf_append(&w->nodes, &node, sizeof(node))) {
+        w->failed = 1;
+    }
+}
+
+static void ui_blob_writer_free(UiBlobWriter* w) {
+    free(w->nodes.data);
+    free(w->plains.data);
+    free(w->values.data);
+    free(w->strings.data);
+    free(w->types.data);
+    free(w->slots);
+    free(w->queue);
+}
+
+static uint32_t ui_blob_align4(uint32_t v) {
+    return (v + 3u) & ~3u;
+}
+
+int ui_blob_compile(cJSON* ui, cJSON* theme, void** out_data, size_t* out_size) {
+    UiBlobWriter w;
+    UiBlobHeader header;
+
+    if (!ui || !out_data || !out_size) {
+        return -1;
+    }
+    *out_data = NULL;
+    *out_size = 0;
+    memset(&w, 0, sizeof(w));
+    memset(&header, 0, sizeof(header));
+
+    if (!ui_blob_queue_push(&w, ui)) {
+        ui_blob_writer_free(&w);
+        return -1;
+    }
+    for (uint32_t i = 0; i < w.queue_count && !w.failed; i++) {
+        ui_blob_write_node(&w, w.queue[i]);
+    }
+
+    header.theme = UI_BLOB_NONE;
+    if (theme) {
+        char* text = cJSON_PrintUnformatted(theme);
+        if (!text) {
+            w.failed = 1;
+        } else {
+            header.theme = ui_blob_intern(&w, text);
+            cJSON_free(text);
+        }
+    }
+    if (w.failed) {
+        printf("ui blob: out of memory while compiling\n");
+        ui_blob_writer_free(&w);
+        return -1;
+    }
+
+    header.magic = UI_BLOB_MAGIC;
+    header.version = UI_BLOB_VERSION;
+    header.node_size = sizeof(UiBlobNode);
+    header.node_offset = ui_blob_align4(sizeof(UiBlobHeader));
+    header.node_count = w.queue_count;
+    header.plain_size = sizeof(UiBlobPlain);
+    header.plain_offset = header.node_offset + (uint32_t)w.nodes.size;
+    header.plain_count = (uint32_t)(w.plains.size / sizeof(UiBlobPlain));
+    header.type_offset = header.plain_offset + (uint32_t)w.plains.size;
+    header.type_count = (uint32_t)(w.types.size / sizeof(uint32_t));
+    header.string_offset = header.type_offset + (uint32_t)w.types.size;
+    header.string_size = (uint32_t)w.strings.size;
+    header.value_offset = ui_blob_align4(header.string_offset + header.string_size);
+    header.value_size = (uint32_t)w.values.size;
+    header.size = header.value_offset + header.value_size;
+
+    unsigned char* data = (unsigned char*)calloc(1, header.size);
+    if (!data) {
+        ui_blob_writer_free(&w);
+        return -1;
+    }
+    memcpy(data, &header, sizeof(header));
+    if (w.nodes.size) memcpy(data + header.node_offset, w.nodes.data, w.nodes.size);
+    if (w.plains.size) memcpy(data + header.plain_offset, w.plains.data, w.plains.size);
+    if (w.types.size) memcpy(data + header.type_offset, w.types.data, w.types.size);
+    if (w.strings.size) memcpy(data + header.string_offset, w.strings.data, w.strings.size);
+    if (w.values.size) memcpy(data + header.value_offset, w.values.data, w.values.size);
+
+    ui_blob_writer_free(&w);
+    *out_data = data;
+    *out_size = header.size;
+    return 0;
+}
+
+int ui_blob_write_file(cJSON* ui, cJSON* theme, const char* path) {
+    void* data = NULL;
+    size_t size = 0;
+    if (!path || ui_blob_compile(ui, theme, &data, &size) != 0) {
+        return -1;
+    }
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        printf("ui blob: cannot open %s for writing\n", path);
+        free(data);
+        return -1;
+    }
+    int ok = fwrite(data, 1, size, file) == size;
+    ok = fclose(file) == 0 && ok;
+    free(data);
+    if (!ok) {
+        printf("ui blob: write %s failed\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// ====================== 加载 ======================
+
+static const char* ui_blob_string(const UiBlob* blob, uint32_t ref) {
+    if (ref == UI_BLOB_NONE || ref >= blob->header->string_size) {
+        return NULL;
+    }
+    return (const char*)blob->data + blob->header->string_offset + ref;
+}
+
+static int ui_blob_range_ok(size_t size, uint32_t offset, uint64_t len) {
+    return (uint64_t)offset + len <= size;
+}
+
+// 一次性校验结构，之后建树时不再逐项检查
+static int ui_blob_validate(UiBlob* blob) {
+    const UiBlobHeader* h = blob->header;
+    if (blob->size < sizeof(UiBlobHeader) || h->magic != UI_BLOB_MAGIC ||
+        h->version != UI_BLOB_VERSION || h->node_size != sizeof(UiBlobNode) ||
+        h->plain_size != sizeof(UiBlobPlain) || h->size > blob->size ||
+        (h->node_offset & 3u) || (h->plain_offset & 3u) || (h->type_offset & 3u) ||
+        !ui_blob_range_ok(h->size, h->node_offset, (uint64_t)h->node_count * sizeof(UiBlobNode)) ||
+        !ui_blob_range_ok(h->size, h->plain_offset, (uint64_t)h->plain_count * sizeof(UiBlobPlain)) ||
+        !ui_blob_range_ok(h->size, h->type_offset, (uint64_t)h->type_count * sizeof(uint32_t)) ||
+        !ui_blob_range_ok(h->size, h->string_offset, h->string_size) ||
+        !ui_blob_range_ok(h->size, h->value_offset, h->value_size) ||
+        h->node_count == 0 ||
+        (h->string_size > 0 && blob->data[h->string_offset + h->string_size - 1] != '\0')) {
+        return 0;
+    }
+    if (h->theme != UI_BLOB_NONE && h->theme >= h->string_size) {
+        return 0;
+    }
+    blob->nodes = (const UiBlobNode*)(blob->data + h->node_offset);
+    blob->plains = (const UiBlobPlain*)(blob->data + h->plain_offset);
+    for (uint32_t i = 0; i < h->node_count; i++) {
+        const UiBlobNode* node = &blob->nodes[i];
+        if (node->type >= h->type_count) {
+            return 0;
+        }
+        // 子节点必须排在父节点之后，保证无环
+        if (node->child_count > 0 &&
+            (node->first_child <= i || node->first_child > h->node_count ||
+             node->child_count > h->node_count - node->first_child)) {
+            return 0;
+        }
+        if (node->flags & UI_BLOB_NODE_PAYLOAD) {
+            if (node->data >= h->value_size) {
+                return 0;
+            }
+            continue;
+        }
+        if (node->data >= h->plain_count) {
+            return 0;
+        }
+        const UiBlobPlain* plain = &blob->plains[node->data];
+        const uint32_t refs[] = {
+            plain->id, plain->variant, plain->label, plain->text,
+            plain->font_path, plain->font_weight, plain->assets
+        };
+        for (size_t r = 0; r < sizeof(refs) / sizeof(refs[0]); r++) {
+            if (refs[r] != UI_BLOB_NONE && refs[r] >= h->string_size) {
+                return 0;
+            }
+        }
+    }
+
+    blob->type_ids = (int*)malloc((h->type_count ? h->type_count : 1) * sizeof(int));
+    if (!blob->type_ids) {
+        return 0;
+    }
+    const unsigned char* types = blob->data + h->type_offset;
+    for (uint32_t i = 0; i < h->type_count; i++) {
+        uint32_t ref;
+        memcpy(&ref, types + i * sizeof(uint32_t), sizeof(ref));
+        const char* name = ui_blob_string(blob, ref);
+        if (!name) {
+            return 0;
+        }
+        blob->type_ids[i] = yui_type_resolve(name);
+    }
+    return 1;
+}
+
+UiBlob* ui_blob_open_memory(const void* data, size_t size) {
+    if (!data || size < sizeof(UiBlobHeader) || ((uintptr_t)data & 3u)) {
+        return NULL;
+    }
+    UiBlob* blob = (UiBlob*)calloc(1, sizeof(UiBlob));
+    if (!blob) {
+        return NULL;
+    }
+    blob->data = (const unsigned char*)data;
+    blob->size = size;
+    blob->header = (const UiBlobHeader*)data;
+    if (!ui_blob_validate(blob)) {
+        printf("ui blob: invalid or incompatible data\n");
+        free(blob->type_ids);
+        free(blob);
+        return NULL;
+    }
+    return blob;
+}
+
+UiBlob* ui_blob_open(const char* path) {
+    UiBlob* blob = NULL;
+    if (!path) {
+        return NULL;
+    }
+#ifdef UI_BLOB_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("ui blob: open file failed %s\n", path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(UiBlobHeader)) {
+        close(fd);
+        printf("ui blob: bad file %s\n", path);
+        return NULL;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data != MAP_FAILED) {
+        blob = ui_blob_open_memory(data, (size_t)st.st_size);
+        if (!blob) {
+            munmap(data, (size_t)st.st_size);
+            return NULL;
+        }
+        blob->mapped = 1;
+        return blob;
+    }
+#endif
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf("ui blob: open file failed %s\n", path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    void* buffer = size > 0 ? malloc((size_t)size) : NULL;
+    if (!buffer || fread(buffer, 1, (size_t)size, file) != (size_t)size) {
+        fclose(file);
+        free(buffer);
+        printf("ui blob: read file failed %s\n", path);
+        return NULL;
+    }
+    fclose(file);
+    blob = ui_blob_open_memory(buffer, (size_t)size);
+    if (!blob) {
+        free(buffer);
+        return NULL;
+    }
+    blob->mapped = 2;
+    return blob;
+}
+
+void ui_blob_close(UiBlob* blob) {
+    if (!blob) {
+        return;
+    }
+#ifdef UI_BLOB_HAVE_MMAP
+    if (blob->mapped == 1) {
+        munmap((void*)blob->data, blob->size);
+    }
+#endif
+    if (blob->mapped == 2) {
+        free((void*)blob->data);
+    }
+    free(blob->type_ids);
+    free(blob);
+}
+
+int ui_blob_is_blob_file(const char* path) {
+    uint32_t magic = 0;
+    if (!path) {
+        return 0;
+    }
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    size_t n = fread(&magic, 1, sizeof(magic), file);
+    fclose(file);
+    return n == sizeof(magic) && magic == UI_BLOB_MAGIC;
+}
+
+int ui_blob_load_theme(UiBlob* blob) {
+    if (!blob || blob->theme_loaded || blob->header->theme == UI_BLOB_NONE) {
+        return 0;
+    }
+    blob->theme_loaded = 1;
+    Theme* theme = theme_manager_load_theme_from_json(ui_blob_string(blob, blob->header->theme));
+    if (!theme) {
+        return -1;
+    }
+    if (!theme_manager_get_current()) {
+        theme_manager_set_current(theme->name);
+    }
+    return 0;
+}
+
+static cJSON* ui_blob_decode_value(const UiBlob* blob, uint32_t* pos, int depth) {
+    const unsigned char* values = blob->data + blob->header->value_offset;
+    uint32_t size = blob->header->value_size;
+    uint32_t u;
+    double d;
+
+    if (depth > UI_BLOB_MAX_DEPTH || *pos >= size) {
+        return NULL;
+    }
+    unsigned char tag = values[(*pos)++];
+    switch (tag) {
+        case UI_BLOB_VALUE_NULL:
+            return cJSON_CreateNull();
+        case UI_BLOB_VALUE_FALSE:
+            return cJSON_CreateFalse();
+        case UI_BLOB_VALUE_TRUE:
+            return cJSON_CreateTrue();
+        case UI_BLOB_VALUE_NUMBER:
+            if (size - *pos < sizeof(d)) {
+                return NULL;
+            }
+            memcpy(&d, values + *pos, sizeof(d));
+            *pos += sizeof(d);
+            return cJSON_CreateNumber(d);
+        case UI_BLOB_VALUE_INT: {
+            int32_t i;
+            if (size - *pos < sizeof(i)) {
+                return NULL;
+            }
+            memcpy(&i, values + *pos, sizeof(i));
+            *pos += sizeof(i);
+            return cJSON_CreateNumber((double)i);
+        }
+        case UI_BLOB_VALUE_STRING: {
+            if (size - *pos < sizeof(u)) {
+                return NULL;
+            }
+            memcpy(&u, values + *pos, sizeof(u));
+            *pos += sizeof(u);
+            const char* s = ui_blob_string(blob, u);
+            return s ? cJSON_CreateString(s) : NULL;
+        }
+        case UI_BLOB_VALUE_ARRAY:
+        case UI_BLOB_VALUE_OBJECT: {
+            if (size - *pos < sizeof(u)) {
+                return NULL;
+            }
+            memcpy(&u, values + *pos, sizeof(u));
+            *pos += sizeof(u);
+            cJSON* container = tag == UI_BLOB_VALUE_ARRAY ? cJSON_CreateArray() : cJSON_CreateObject();
+            cJSON* tail = NULL;
+            if (!container) {
+                return NULL;
+            }
+            for (uint32_t i = 0; i < u; i++) {
+                const char* key = NULL;
+                uint32_t key_ref;
+                if (tag == UI_BLOB_VALUE_OBJECT) {
+                    if (size - *pos < sizeof(key_ref)) {
+                        cJSON_Delete(container);
+                        return NULL;
+                    }
+                    memcpy(&key_ref, values + *pos, sizeof(key_ref));
+                    *pos += sizeof(key_ref);
+                    key = ui_blob_string(blob, key_ref);
+                }
+                cJSON* item = ui_blob_decode_value(blob, pos, depth + 1);
+                if (!item || (tag == UI_BLOB_VALUE_OBJECT && !key)) {
+                    cJSON_Delete(item);
+                    cJSON_Delete(container);
+                    return NULL;
+                }
+                if (key) {
+                    item->string = (char*)cJSON_malloc(strlen(key) + 1);
+                    if (!item->string) {
+                        cJSON_Delete(item);
+                        cJSON_Delete(container);
+                        return NULL;
+                    }
+                    strcpy(item->string, key);
+                }
+                // 直接挂在尾部，保持原有键顺序且避免 AddItem 的线性查找
+                if (tail) {
+                    tail->next = item;
+                    item->prev = tail;
+                } else {
+                    container->child = item;
+                }
+                container->child->prev = item;
+                tail = item;
+            }
+            return container;
+        }
+        default:
+            return NULL;
+    }
+}
+
+typedef struct UiBlobBuild {
+    UiBlob* blob;
+    const UiBlobNode* node;
+} UiBlobBuild;
+
+static Layer* ui_blob_build_node(UiBlob* blob, uint32_t index, Layer* parent);
+
+static void ui_blob_build_children(Layer* layer, void* user) {
+    UiBlobBuild* build = (UiBlobBuild*)user;
+    const UiBlobNode* node = build->node;
+    if (node->child_count == 0) {
+        return;
+    }
+    Layer** children = (Layer**)realloc(layer->children, node->child_count * sizeof(Layer*));
+    if (!children) {
+        printf("ui blob: malloc children failed\n");
+        return;
+    }
+    layer->children = children;
+    layer->child_count = (int)node->child_count;
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        layer->children[i] = ui_blob_build_node(build->blob, node->first_child + i, layer);
+        layer_index_set_slot(layer->children[i], (int)i);
+    }
+}
+
+static void ui_blob_copy_string(char* dst, size_t dst_size, const char* src) {
+    strncpy(dst, src ? src : "", dst_size - 1);
+    dst[dst_size - 1] = '\0';
+}
+
+// 普通节点：字段已在编译期算好，顺序与 parse_layer_from_json 一致
+static Layer* ui_blob_build_plain(UiBlob* blob, const UiBlobNode* node, Layer* parent) {
+    const UiBlobPlain* plain = &blob->plains[node->data];
+    Layer* layer = (Layer*)calloc(1, sizeof(Layer));
+    if (!layer) {
+        printf("malloc layer failed\n");
+        return NULL;
+    }
+    layer->parent = parent;
+    layer->handle_pointer_event = default_layer_handle_pointer_event;
+    layer->state = LAYER_STATE_NORMAL;
+    layer->inspect_show_bounds = 1;
+    layer->inspect_show_info = 1;
+
+    layer_set_id(layer, ui_blob_string(blob, plain->id));
+    ui_blob_copy_string(layer->variant, sizeof(layer->variant), ui_blob_string(blob, plain->variant));
+    layer->type = blob->type_ids[node->type];
+
+    if (node->flags & UI_BLOB_NODE_FONT) {
+        layer->font = (Font*)malloc(sizeof(Font));
+        layer->font->default_font = NULL;
+        ui_blob_copy_string(layer->font->path, sizeof(layer->font->path),
+                            ui_blob_string(blob, plain->font_path));
+        ui_blob_copy_string(layer->font->weight, sizeof(layer->font->weight),
+                            ui_blob_string(blob, plain->font_weight));
+        layer->font->size = plain->font_size;
+    } else if (parent) {
+        layer->font = parent->font;
+    } else {
+        layer->font = (Font*)malloc(sizeof(Font));
+        layer->font->default_font = NULL;
+        strcpy(layer->font->path, "Roboto-Regular.ttf");
+        layer->font->size = 16;
+        strcpy(layer->font->weight, "normal");
+    }
+
+    if (node->flags & UI_BLOB_NODE_ASSETS) {
+        layer->assets = (Assets*)calloc(1, sizeof(Assets));
+        ui_blob_copy_string(layer->assets->path, sizeof(layer->assets->path),
+                            ui_blob_string(blob, plain->assets));
+    } else if (parent) {
+        layer->assets = parent->assets;
+    }
+
+    layer->rect.x = plain->rect[0];
+    layer->rect.y = plain->rect[1];
+    layer->rect.w = plain->rect[2];
+    layer->rect.h = plain->rect[3];
+    layer->fixed_width = plain->fixed_width;
+    layer->fixed_height = plain->fixed_height;
+    layer->flex_ratio = plain->flex;
+
+    if (node->flags & UI_BLOB_NODE_LABEL) {
+        layer_set_label(layer, ui_blob_string(blob, plain->label));
+    }
+    if (node->flags & UI_BLOB_NODE_TEXT) {
+        layer_set_text(layer, ui_blob_string(blob, plain->text));
+    }
+    if (node->flags & UI_BLOB_NODE_VISIBLE) {
+        layer->visible = (node->flags & UI_BLOB_NODE_SHOWN) ? VISIBLE : IN_VISIBLE;
+    }
+
+    layer->layout_manager = (LayoutManager*)calloc(1, sizeof(LayoutManager));
+    if (layer->layout_manager) {
+        layer->layout_manager->type = (LayoutType)plain->layout_type;
+        layer->layout_manager->spacing = plain->layout_spacing;
+        memcpy(layer->layout_manager->padding, plain->layout_padding, sizeof(plain->layout_padding));
+        layer->layout_manager->align = (LayoutType)plain->layout_align;
+        layer->layout_manager->justify = (LayoutType)plain->layout_justify;
+        layer->layout_manager->columns = plain->layout_columns;
+    }
+
+    layer->color = (Color){plain->color[0], plain->color[1], plain->color[2], plain->color[3]};
+    layer->bg_color = (Color){plain->bg_color[0], plain->bg_color[1], plain->bg_color[2], plain->bg_color[3]};
+    layer->radius = plain->radius;
+    memcpy(layer->padding, plain->padding, sizeof(layer->padding));
+    layer->image_mode = (ImageMode)plain->image_mode;
+
+    UiBlobBuild build = {blob, node};
+    ui_blob_build_children(layer, &build);
+
+    Theme* current_theme = theme_manager_get_current();
+    if (current_theme) {
+        theme_apply_to_layer(current_theme, layer, layer->id, yui_type_name(layer->type));
+    }
+    return layer;
+}
+
+static Layer* ui_blob_build_node(UiBlob* blob, uint32_t index, Layer* parent) {
+    const UiBlobNode* node = &blob->nodes[index];
+    if (!(node->flags & UI_BLOB_NODE_PAYLOAD)) {
+        const YuiComponentOps* ops = yui_type_get_ops(blob->type_ids[node->type]);
+        if (ops && ops->create) {
+            printf("ui blob: type %s has a component now, recompile the blob\n",
+                   yui_type_name(blob->type_ids[node->type]));
+        }
+        return ui_blob_build_plain(blob, node, parent);
+    }
+
+    // 组件节点：create 钩子只接受 cJSON，解码出不含 children 的属性对象
+    uint32_t pos = node->data;
+    cJSON* json = ui_blob_decode_value(blob, &pos, 0);
+    if (!json) {
+        printf("ui blob: bad payload for node %u\n", index);
+        return NULL;
+    }
+    UiBlobBuild build = {blob, node};
+    Layer* layer = parse_layer_from_json_ex(NULL, json, parent, ui_blob_build_children, &build);
+    cJSON_Delete(json);
+    return layer;
+}
+
+Layer* ui_blob_create_layers(UiBlob* blob, Layer* parent) {
+    if (!blob) {
+        return NULL;
+    }
+    ui_blob_load_theme(blob);
+    return ui_blob_build_node(blob, 0, parent);
+}
+
+Layer* ui_blob_load_file(const char* path, Layer* parent) {
+    UiBlob* blob = ui_blob_open(path);
+    if (!blob) {
+        return NULL;
+    }
+    Layer* layer = ui_blob_create_layers(blob, parent);
+    ui_blob_close(blob);
+    return layer;
+}
@@ -0,0 +1,131 @@
+#ifndef YUI_UI_BLOB_H
+#define YUI_UI_BLOB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cJSON.h"
+#include "ytype.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 预编译二进制 UI（.yuib）：离线把 UI JSON/YAML 与主题编译成紧凑的二进制，
+   运行时 mmap 后直接建图层树，不再做文本解析。
+
+   布局：头部 | 节点表 | 普通节点表 | 类型名表 | 字符串池 | 值区。节点按广度
+   优先排列，每个节点的子节点在表中连续。字符串全部去重，引用为字符串池内偏移。
+
+   普通节点（类型没有 create 钩子、属性只含 id/type/variant/字体/assets/
+   位置尺寸/flex/label/text/visible/layout/基础 style）的类型、颜色、布局、
+   padding、字体在编译期算好，加载时直接填进 Layer。组件节点和带事件、
+   动画、data 等其它属性的节点，其属性（不含 children）以二进制值编码存放，
+   加载时解码成一个小 cJSON 交给 parse_layer_from_json_ex，子节点仍从节点表构建。
+
+   文件按编译机字节序写入，版本或节点结构不符时拒绝加载。 */
+
+#define UI_BLOB_MAGIC   0x42495559u  // "YUIB"
+#define UI_BLOB_VERSION 1
+#define UI_BLOB_NONE    0xFFFFFFFFu  // 空引用
+#define UI_BLOB_EXT     ".yuib"
+
+// 节点标志
+#define UI_BLOB_NODE_PAYLOAD  (1u << 0)  // 组件/复杂节点：按 payload 走 JSON 解析
+#define UI_BLOB_NODE_FONT     (1u << 1)  // 自带字体，否则继承父级
+#define UI_BLOB_NODE_ASSETS   (1u << 2)  // 自带 assets，否则继承父级
+#define UI_BLOB_NODE_LABEL    (1u << 3)
+#define UI_BLOB_NODE_TEXT     (1u << 4)
+#define UI_BLOB_NODE_VISIBLE  (1u << 5)  // 指定了 visible
+#define UI_BLOB_NODE_SHOWN    (1u << 6)  // visible 的取值
+
+typedef struct UiBlobHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;           // 文件总字节数
+    uint32_t node_size;      // sizeof(UiBlobNode)，加载时校验
+    uint32_t node_offset;
+    uint32_t node_count;
+    uint32_t plain_size;     // sizeof(UiBlobPlain)
+    uint32_t plain_offset;
+    uint32_t plain_count;
+    uint32_t type_offset;    // 类型名表：字符串引用数组
+    uint32_t type_count;
+    uint32_t string_offset;
+    uint32_t string_size;
+    uint32_t value_offset;
+    uint32_t value_size;
+    uint32_t theme;          // 主题 JSON 文本的字符串引用，无主题为 UI_BLOB_NONE
+} UiBlobHeader;
+
+typedef struct UiBlobNode {
+    uint32_t flags;
+    uint32_t type;           // 类型名表下标，加载时每种类型只解析一次
+    uint32_t first_child;
+    uint32_t child_count;
+    uint32_t data;           // UI_BLOB_NODE_PAYLOAD 时为值区偏移，否则为普通节点表下标
+} UiBlobNode;
+
+// 普通节点编译期算好的属性
+typedef struct UiBlobPlain {
+    uint32_t id;             // 以下 uint32_t 字符串字段均为字符串引用
+    uint32_t variant;
+    uint32_t label;
+    uint32_t text;
+    uint32_t font_path;
+    uint32_t font_weight;
+    int32_t font_size;
+    uint32_t assets;
+    int32_t rect[4];         // x, y, w, h
+    int32_t fixed_width;
+    int32_t fixed_height;
+    float flex;
+    uint8_t color[4];        // r, g, b, a
+    uint8_t bg_color[4];
+    int32_t radius;
+    int32_t padding[4];
+    int32_t image_mode;
+    int32_t layout_type;
+    int32_t layout_spacing;
+    int32_t layout_padding[4];
+    int32_t layout_align;
+    int32_t layout_justify;
+    int32_t layout_columns;
+} UiBlobPlain;
+
+typedef struct UiBlob UiBlob;
+
+/**
+ * 编译 UI 树和可选主题为二进制。调用前需已注册组件类型（普通节点的判定依赖注册表）
+ * @return 0 成功，*out_data 由调用方 free
+ */
+int ui_blob_compile(cJSON* ui, cJSON* theme, void** out_data, size_t* out_size);
+
+// 编译并写入文件，0 成功
+int ui_blob_write_file(cJSON* ui, cJSON* theme, const char* path);
+
+// mmap 打开（不支持 mmap 的平台读入内存），失败返回 NULL
+UiBlob* ui_blob_open(const char* path);
+
+// 使用调用方的内存，不复制；data 需 4 字节对齐且在 ui_blob_close 之前有效
+UiBlob* ui_blob_open_memory(const void* data, size_t size);
+
+void ui_blob_close(UiBlob* blob);
+
+// 加载内嵌主题（若有且尚未加载），当前没有主题时设为当前主题
+int ui_blob_load_theme(UiBlob* blob);
+
+// 建图层树，先加载内嵌主题；返回的图层不再引用 blob 内存
+Layer* ui_blob_create_layers(UiBlob* blob, Layer* parent);
+
+// 打开、建树、关闭
+Layer* ui_blob_load_file(const char* path, Layer* parent);
+
+// 文件头是否为 .yuib
+int ui_blob_is_blob_file(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
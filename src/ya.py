@@ -22,7 +22,7 @@ if get_plat() == "esp32":
     add_files("game/*.c")
     add_cflags("-DYUI_WITH_GAME=1")
     add_cflags("-DYUI_WITH_GAME_AUDIO=0")
-    # 静态数组压缩适配 400KB SRAM（GameEntity ~600B，128 个 ≈ 76KB）
+    # 实体表按需增长，这里限量以适配 400KB SRAM（GameEntity ~130B，动画帧按需另存）
     add_cflags("-DGAME_MAX_ENTITIES=16")
     add_cflags("-DGAME_MAX_PARTICLES=32")
 else:
@@ -68,4 +68,6 @@ elif get_plat() in ("android", "ios"):
     add_cflags("-DYUI_BACKEND_MOBILE")
 else:
     add_files("backend/backend_sdl.c")
+    add_files("backend/sdl_glyph_atlas.c")
+    add_files("backend/sdl_image_cache.c")
     add_cflags("-DYUI_USE_SDL_BACKEND")
@@ -668,14 +668,26 @@ typedef struct Layer {
 
     // 数据更新回调（由组件各自注册）；返回 1 表示已接管 data 所有权
     int (*on_data_update)(Layer* layer, cJSON* data);
+    // 增量数据（Table/List）：rows 中的元素移入组件数据，rows 本身仍归调用方；
+    // on_row_update 返回 1 表示已接管 row
+    int (*on_rows_append)(Layer* layer, cJSON* rows);
+    int (*on_row_update)(Layer* layer, int index, cJSON* row);
 
     // 销毁回调（由组件各自注册，释放 component 等资源）
     void (*on_destroy)(Layer* layer);
 
+    // 文本由组件自有缓冲区维护时（Text 的 piece table）：layer_get_text 前调用 sync_text
+    // 把内容物化到 text；layer_set_text 写入后调用 on_text_set 同步回组件
+    void (*sync_text)(Layer* layer);
+    void (*on_text_set)(Layer* layer);
+
     // 添加滚动支持字段
     int scrollable;          // 滚动类型: 0=不可滚动, 1=垂直滚动, 2=水平滚动, 3=双向滚动
     int scroll_offset;       // 垂直滚动偏移
     int scroll_offset_x;     // 水平滚动偏移
+    int scroll_applied;      // 子层 rect 中已生效的垂直偏移（见 layout_scroll_changed）
+    int scroll_applied_x;    // 子层 rect 中已生效的水平偏移
+    unsigned char scroll_axes; // 布局实际应用了偏移的方向: bit0=垂直, bit1=水平
     Scrollbar* scrollbar;    // 旧的滚动条指针(为了兼容性保留)
     Scrollbar* scrollbar_v;  // 垂直滚动条
     Scrollbar* scrollbar_h;  // 水平滚动条
@@ -738,6 +750,12 @@ typedef struct Layer {
     int connectable;
 
     int pointer_passthrough;  // 1=事件穿透，不阻挡 POINTER_DOWN/POINTER_UP
+    unsigned int hit_stamp;   // 命中索引标记，等于当前移动序号时才派发 POINTER_MOVE
+
+    // id 索引（layer_index.c）
+    struct Layer* id_next;    // 同一哈希桶的下一个图层
+    unsigned int id_hash;     // 登记时 id 的哈希，0 表示未登记
+    int parent_slot;          // 在 parent->children 中的位置提示，可能过期
 
 } Layer;
 // 全局变量：当前拥有焦点的图层
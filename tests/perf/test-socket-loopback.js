@@ -0,0 +1,145 @@
+/**
+ * Perf gate: Socket.watch loopback throughput.
+ * A client streams small fixed-size messages (telemetry-like) over 127.0.0.1;
+ * the server side receives them through onReadable into one reusable ArrayBuffer.
+ * The main loop sleeps between wakes, so this also checks the reactor wakes it.
+ * Soft floor avoids flaky CI on slow machines; tighten later if needed.
+ */
+var SOCKET_MSG_BYTES = 64;
+var SOCKET_MSG_COUNT = 250000;
+var SOCKET_MIN_MSGS_PER_SEC = 20000;
+var SOCKET_TIMEOUT_MS = 10000;
+
+function hasWatchApi() {
+  return typeof Socket !== "undefined" &&
+    typeof Socket.watch === "function" &&
+    typeof Socket.wantWrite === "function";
+}
+
+function reportSocket(result) {
+  YTest.describe("Socket.watch loopback", function () {
+    YTest.it("API is registered", function () {
+      YTest.expect(hasWatchApi()).toBeTruthy();
+    });
+
+    if (!result) {
+      return;
+    }
+
+    YTest.it("receives every byte in order", function () {
+      YTest.expect(result.timedOut).toBeFalsy();
+      YTest.expect(result.received).toBe(SOCKET_MSG_COUNT * SOCKET_MSG_BYTES);
+      YTest.expect(result.ordered).toBeTruthy();
+    });
+
+    YTest.it("reuses one receive buffer", function () {
+      YTest.expect(result.buffers).toBe(1);
+    });
+
+    YTest.it("stays above the soft throughput floor", function () {
+      YTest.expect(result.msgsPerSec).toBeGreaterThan(SOCKET_MIN_MSGS_PER_SEC);
+    });
+  });
+
+  var ok = YTest.run();
+  if (typeof YUI.update === "function") {
+    YUI.update({
+      target: "socket_status",
+      change: { text: ok ? "PASS" : "FAIL", color: ok ? "#a6e3a1" : "#f38ba8" }
+    });
+  }
+  YTest.exit();
+}
+
+function runLoopback(done) {
+  var total = SOCKET_MSG_COUNT * SOCKET_MSG_BYTES;
+  var result = { received: 0, ordered: true, buffers: 0, timedOut: false, msgsPerSec: 0 };
+  var lastBuffer = null;
+  var finished = false;
+  var start = 0;
+
+  /* 一批 1024 条消息，每条首字节是序号低 8 位 */
+  var batch = new Uint8Array(SOCKET_MSG_BYTES * 1024);
+  for (var i = 0; i < batch.length; i++) {
+    batch[i] = i % SOCKET_MSG_BYTES === 0 ? (i / SOCKET_MSG_BYTES) & 255 : 0x55;
+  }
+
+  var srv = Socket.socket(Socket.TCP);
+  Socket.bind(srv, "127.0.0.1", 0);
+  Socket.listen(srv, 4);
+  var port = Socket.getsockname(srv).port;
+  var conn = -1;
+  var cli = Socket.socket(Socket.TCP);
+  var sent = 0;
+
+  function finish(timedOut) {
+    if (finished) {
+      return;
+    }
+    finished = true;
+    var ms = Math.max(1, Date.now() - start);
+    result.timedOut = timedOut;
+    result.msgsPerSec = Math.round(result.received / SOCKET_MSG_BYTES * 1000 / ms);
+    YUI.log("socket loopback: " + (result.received / SOCKET_MSG_BYTES) + " msgs in " + ms + " ms, " +
+      result.msgsPerSec + " msgs/s, " + (result.received / 1048576 * 1000 / ms).toFixed(1) + " MB/s");
+    Socket.close(cli);
+    if (conn >= 0) {
+      Socket.close(conn);
+    }
+    Socket.close(srv);
+    done(result);
+  }
+
+  function onData(buf, n) {
+    if (buf !== lastBuffer) {
+      lastBuffer = buf;
+      result.buffers++;
+    }
+    var bytes = new Uint8Array(buf, 0, n);
+    /* 消息边界可能跨两次回调，按全局偏移检查序号 */
+    var first = (SOCKET_MSG_BYTES - result.received % SOCKET_MSG_BYTES) % SOCKET_MSG_BYTES;
+    for (var k = first; k < n; k += SOCKET_MSG_BYTES) {
+      var seq = ((result.received + k) / SOCKET_MSG_BYTES) % 1024;
+      if (bytes[k] !== (seq & 255)) {
+        result.ordered = false;
+      }
+    }
+    result.received += n;
+    if (result.received >= total) {
+      finish(false);
+    }
+  }
+
+  function pump() {
+    while (sent < total) {
+      var len = Math.min(batch.length - sent % batch.length, total - sent);
+      var n = Socket.send(cli, new Uint8Array(batch.buffer, sent % batch.length, len), 0);
+      if (n <= 0) {
+        Socket.wantWrite(cli);
+        return;
+      }
+      sent += n;
+    }
+  }
+
+  Socket.watch(srv, {
+    recv: false,
+    onReadable: function () {
+      conn = Socket.accept(srv);
+      Socket.watch(conn, { onReadable: onData, onClose: function () { finish(true); } });
+    }
+  });
+
+  start = Date.now();
+  Socket.connect(cli, "127.0.0.1", port, 0);
+  Socket.watch(cli, { onWritable: pump });
+  setTimeout(function () { finish(true); }, SOCKET_TIMEOUT_MS);
+}
+
+function onSocketLoad() {
+  if (!hasWatchApi()) {
+    reportSocket(null);
+    return;
+  }
+  runLoopback(reportSocket);
+}
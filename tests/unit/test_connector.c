@@ -0,0 +1,151 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include "ytype.h"
+#include "layer.h"
+#include "layout.h"
+#include "component_registry.h"
+#include "components/connector_component.h"
+#include "cJSON.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+extern Layer *g_ui_root;
+
+static int setup_registry(void **state)
+{
+    (void)state;
+    yui_component_registry_init();
+    yui_components_register_builtin();
+    return 0;
+}
+
+/* 画布：两个节点 a、b，edges 条连线都从 a 的 right 连到 b 的 left */
+static Layer *make_canvas(int edges)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON *children = cJSON_AddArrayToObject(root, "children");
+    const char *names[2] = {"a", "b"};
+    Layer *layer;
+    int i;
+
+    cJSON_AddStringToObject(root, "id", "canvas");
+    cJSON_AddItemToObject(root, "size", cJSON_CreateIntArray((const int[]){2000, 1000}, 2));
+    cJSON_AddStringToObject(cJSON_AddObjectToObject(root, "layout"), "type", "absolute");
+    for (i = 0; i < edges; i++) {
+        char id[32];
+        cJSON *edge = cJSON_CreateObject();
+        snprintf(id, sizeof(id), "edge%d", i);
+        cJSON_AddStringToObject(edge, "id", id);
+        cJSON_AddStringToObject(edge, "type", "Connector");
+        cJSON_AddStringToObject(cJSON_AddObjectToObject(edge, "from"), "id", "a");
+        cJSON_AddStringToObject(cJSON_GetObjectItem(edge, "from"), "anchor", "right");
+        cJSON_AddStringToObject(cJSON_AddObjectToObject(edge, "to"), "id", "b");
+        cJSON_AddStringToObject(cJSON_GetObjectItem(edge, "to"), "anchor", "left");
+        cJSON_AddItemToArray(children, edge);
+    }
+    for (i = 0; i < 2; i++) {
+        cJSON *node = cJSON_CreateObject();
+        cJSON_AddStringToObject(node, "id", names[i]);
+        cJSON_AddStringToObject(node, "type", "Draggable");
+        cJSON_AddItemToObject(node, "position", cJSON_CreateIntArray((const int[]){i * 400, 0}, 2));
+        cJSON_AddItemToObject(node, "size", cJSON_CreateIntArray((const int[]){100, 50}, 2));
+        cJSON_AddItemToArray(children, node);
+    }
+
+    layer = layer_create_from_json(root, NULL);
+    cJSON_Delete(root);
+    assert_non_null(layer);
+    /* a 的 right 锚点在 (100, 25)，b 的 left 锚点在 (400, 25) */
+    layout_layer(layer);
+    assert_int_equal(layer->children[edges + 1]->rect.x, 400);
+    assert_int_equal(layer->children[edges + 1]->rect.h, 50);
+    return layer;
+}
+
+static void test_fanout_hit_and_invalidation(void **state)
+{
+    Layer *canvas = make_canvas(3);
+    Layer *b = canvas->children[4];
+
+    (void)state;
+    g_ui_root = canvas;
+
+    /* 同一端点的三条连线按画布顺序错开 -12/0/+12，水平方向为直线 */
+    assert_int_equal(connector_try_remove_at(canvas, 250, 37, 4), 1);
+    assert_null(find_layer_by_id(canvas, "edge2"));
+    assert_non_null(find_layer_by_id(canvas, "edge0"));
+    assert_non_null(find_layer_by_id(canvas, "edge1"));
+
+    /* 剩两条：-6/+6 */
+    assert_int_equal(connector_try_remove_at(canvas, 250, 45, 4), 0);
+    assert_int_equal(connector_try_remove_at(canvas, 250, 19, 4), 1);
+    assert_null(find_layer_by_id(canvas, "edge0"));
+
+    /* 端点改 id 后缓存失效，连线不再解析到 b */
+    layer_set_id(b, "b_renamed");
+    assert_int_equal(connector_try_remove_at(canvas, 250, 25, 4), 0);
+    layer_set_id(b, "b");
+    assert_int_equal(connector_try_remove_at(canvas, 250, 25, 4), 1);
+    assert_null(find_layer_by_id(canvas, "edge1"));
+
+    g_ui_root = NULL;
+    destroy_layer(canvas);
+}
+
+/* 500 条连线共享端点：一帧算全部几何（渲染）再做一次落空的曲线命中 */
+static void test_many_connectors_frame(void **state)
+{
+    const int edges = 500;
+    const int frames = 20;
+    Layer *canvas = make_canvas(edges);
+    clock_t ticks = 0;
+    int f;
+    int i;
+
+    (void)state;
+    g_ui_root = canvas;
+    for (f = 0; f < frames; f++) {
+        clock_t start = clock();
+        for (i = 0; i < edges; i++) {
+            connector_component_render(canvas->children[i]);
+        }
+        assert_int_equal(connector_try_remove_at(canvas, 250, 4000, 4), 0);
+        ticks += clock() - start;
+    }
+    print_message("connector frame (%d edges): %.3f ms\n", edges,
+                  ticks * 1000.0 / CLOCKS_PER_SEC / frames);
+
+    g_ui_root = NULL;
+    destroy_layer(canvas);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_fanout_hit_and_invalidation),
+        cmocka_unit_test(test_many_connectors_frame),
+    };
+
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, setup_registry, NULL);
+}
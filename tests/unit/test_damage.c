@@ -0,0 +1,255 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "ytype.h"
+#include "damage.h"
+#include "layer_update.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+static const Rect k_viewport = {0, 0, 800, 600};
+
+/* 清掉启动时的整屏脏区，各用例从空状态开始 */
+static int setup_damage(void **state)
+{
+    (void)state;
+    damage_add_full();
+    damage_begin_frame(&k_viewport);
+    return 0;
+}
+
+static void init_layer(Layer *layer, Layer *parent, int x, int y, int w, int h)
+{
+    memset(layer, 0, sizeof(*layer));
+    layer->rect = (Rect){x, y, w, h};
+    layer->visible = VISIBLE;
+    layer->parent = parent;
+}
+
+static void test_damage_full_then_idle(void **state)
+{
+    int count = 0;
+    const Rect *rects;
+
+    (void)state;
+    damage_add_full();
+    assert_true(damage_pending());
+    assert_int_equal(damage_begin_frame(&k_viewport), 1);
+    assert_true(damage_frame_is_full());
+    rects = damage_frame_rects(&count);
+    assert_int_equal(count, 1);
+    assert_memory_equal(&rects[0], &k_viewport, sizeof(Rect));
+
+    /* 没有新修改：下一帧可以跳过 */
+    assert_false(damage_pending());
+    assert_int_equal(damage_begin_frame(&k_viewport), 0);
+    assert_int_equal(damage_frame_area(), 0);
+}
+
+static void test_damage_layer_style_and_geometry(void **state)
+{
+    Layer root, child;
+    int count = 0;
+    const Rect *rects;
+
+    (void)state;
+    init_layer(&root, NULL, 0, 0, 400, 300);
+    init_layer(&child, &root, 10, 20, 100, 40);
+
+    mark_layer_dirty(&child, DIRTY_COLOR);
+    assert_int_equal(damage_begin_frame(&k_viewport), 1);
+    assert_false(damage_frame_is_full());
+    rects = damage_frame_rects(&count);
+    assert_int_equal(rects[0].x, 10);
+    assert_int_equal(rects[0].y, 20);
+    assert_int_equal(damage_frame_area(), 100 * 40);
+
+    /* 几何变化扩大到父图层 */
+    mark_layer_dirty(&child, DIRTY_RECT);
+    assert_int_equal(damage_begin_frame(&k_viewport), 1);
+    rects = damage_frame_rects(&count);
+    assert_int_equal(rects[0].w, 400);
+    assert_int_equal(rects[0].h, 300);
+
+    /* 根图层几何变化按整屏处理 */
+    mark_layer_dirty(&root, DIRTY_LAYOUT);
+    assert_int_equal(damage_begin_frame(&k_viewport), 1);
+    assert_true(damage_frame_is_full());
+}
+
+static void test_damage_layer_moved_before_frame(void **state)
+{
+    Layer root, child;
+    int count = 0;
+    const Rect *rects;
+
+    (void)state;
+    init_layer(&root, NULL, 0, 0, 800, 600);
+    init_layer(&child, &root, 0, 0, 10, 10);
+
+    /* 标脏后才移动：旧位置和新位置都要重绘 */
+    mark_layer_dirty(&child, DIRTY_COLOR);
+    child.rect.x = 100;
+    assert_int_equal(damage_begin_frame(&k_viewport), 2);
+    rects = damage_frame_rects(&count);
+    assert_int_equal(count, 2);
+    assert_int_equal(damage_frame_area(), 2 * 10 * 10);
+}
+
+static void test_damage_merge_and_overflow(void **state)
+{
+    int count = 0;
+    const Rect *rects;
+    Rect a = {0, 0, 50, 50};
+    Rect b = {40, 40, 50, 50};
+    Rect c = {200, 200, 10, 10};
+
+    (void)state;
+    damage_add_rect(&a);
+    damage_add_rect(&b);
+    damage_add_rect(&c);
+    assert_int_equal(damage_begin_frame(&k_viewport), 2);
+    rects = damage_frame_rects(&count);
+    assert_int_equal(count, 2);
+
+    /* 超过上限合并为包围盒 */
+    for (int i = 0; i < DAMAGE_MAX_RECTS + 1; i++) {
+        Rect r = {i * 20, i * 20, 5, 5};
+        damage_add_rect(&r);
+    }
+    assert_int_equal(damage_begin_frame(&k_viewport), 1);
+    rects = damage_frame_rects(&count);
+    assert_int_equal(rects[0].x, 0);
+    assert_int_equal(rects[0].y, 0);
+    assert_int_equal(rects[0].w, DAMAGE_MAX_RECTS * 20 + 5);
+}
+
+static void test_damage_clip_to_viewport(void **state)
+{
+    Rect off = {900, 700, 20, 20};
+    Rect edge = {790, 590, 20, 20};
+    int count = 0;
+    const Rect *rects;
+
+    (void)state;
+    damage_add_rect(&off);
+    assert_int_equal(damage_begin_frame(&k_viewport), 0);
+
+    damage_add_rect(&edge);
+    assert_int_equal(damage_begin_frame(&k_viewport), 1);
+    rects = damage_frame_rects(&count);
+    assert_int_equal(rects[0].w, 10);
+    assert_int_equal(rects[0].h, 10);
+}
+
+static void test_damage_destroyed_layer(void **state)
+{
+    Layer root, child;
+    int count = 0;
+    const Rect *rects;
+
+    (void)state;
+    init_layer(&root, NULL, 0, 0, 800, 600);
+    init_layer(&child, &root, 10, 10, 20, 20);
+
+    mark_layer_dirty(&child, DIRTY_TEXT);
+    damage_layer_destroyed(&child);
+    /* 销毁后不能再读取该图层 */
+    child.rect = (Rect){500, 500, 20, 20};
+    assert_int_equal(damage_begin_frame(&k_viewport), 1);
+    rects = damage_frame_rects(&count);
+    assert_int_equal(rects[0].x, 10);
+    assert_int_equal(rects[0].y, 10);
+}
+
+static void test_damage_visual_rect_shadow(void **state)
+{
+    Layer layer;
+    Rect r;
+
+    (void)state;
+    init_layer(&layer, NULL, 100, 100, 50, 50);
+    layer.shadow.enabled = 1;
+    layer.shadow.color = (Color){0, 0, 0, 128};
+    layer.shadow.offset_x = 4;
+    layer.shadow.offset_y = -2;
+    layer.shadow.blur = 6;
+    layer.shadow.spread = 1;
+
+    damage_layer_visual_rect(&layer, &r);
+    assert_int_equal(r.x, 100 - 11);
+    assert_int_equal(r.y, 100 - 9);
+    assert_int_equal(r.w, 50 + 22);
+    assert_int_equal(r.h, 50 + 18);
+}
+
+static void test_damage_timed_redraw(void **state)
+{
+    Layer root, child;
+    int count = 0;
+    const Rect *rects;
+
+    (void)state;
+    init_layer(&root, NULL, 0, 0, 800, 600);
+    init_layer(&child, &root, 30, 40, 20, 10);
+
+    assert_int_equal(damage_next_due(1000), -1);
+    damage_add_layer_at(&child, 1250);
+    /* 同一图层只保留最早的时间点 */
+    damage_add_layer_at(&child, 1100);
+    damage_add_layer_at(&child, 1500);
+    assert_int_equal(damage_next_due(1000), 100);
+    assert_false(damage_pending());
+
+    /* 未到期不产生脏区 */
+    damage_promote_due(1050);
+    assert_int_equal(damage_begin_frame(&k_viewport), 0);
+
+    damage_promote_due(1100);
+    assert_int_equal(damage_next_due(1100), -1);
+    assert_int_equal(damage_begin_frame(&k_viewport), 1);
+    rects = damage_frame_rects(&count);
+    assert_int_equal(rects[0].x, 30);
+    assert_int_equal(rects[0].y, 40);
+
+    /* 销毁的图层不再触发定时重绘 */
+    damage_add_layer_at(&child, 2000);
+    damage_layer_destroyed(&child);
+    damage_begin_frame(&k_viewport);
+    assert_int_equal(damage_next_due(1100), -1);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup(test_damage_full_then_idle, setup_damage),
+        cmocka_unit_test_setup(test_damage_layer_style_and_geometry, setup_damage),
+        cmocka_unit_test_setup(test_damage_layer_moved_before_frame, setup_damage),
+        cmocka_unit_test_setup(test_damage_merge_and_overflow, setup_damage),
+        cmocka_unit_test_setup(test_damage_clip_to_viewport, setup_damage),
+        cmocka_unit_test_setup(test_damage_destroyed_layer, setup_damage),
+        cmocka_unit_test_setup(test_damage_visual_rect_shadow, setup_damage),
+        cmocka_unit_test_setup(test_damage_timed_redraw, setup_damage),
+    };
+
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,411 @@
+/*
+ * Game sprite batch: sprites sorted by z are grouped by texture into runs
+ * (one geometry call each on backends that support it), particles are one
+ * solid-color run, and the SoA particle store grows past the old 256 cap and
+ * drops expired particles without skipping survivors. A mock geometry backend
+ * checks the submitted vertices, UVs and indices. Prints batches, draw calls
+ * and ms per frame for 5k sprites + 20k particles, batched through a
+ * counting geometry backend and unbatched (one draw per quad).
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "game/game.h"
+#include "game/internal.h"
+#include "backend.h"
+#include "unit_util.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define BENCH_SPRITES 5000
+#define BENCH_PARTICLES 20000
+#define BENCH_FRAMES 60
+#define TEXTURES 4
+
+/* Never dereferenced by the game layer; only compared and handed to the backend. */
+static char g_fake_textures[TEXTURES];
+
+/* Mock geometry backend: records every submitted run. */
+#define MOCK_RUNS 16
+#define MOCK_QUADS 8
+
+typedef struct MockRun {
+    Texture *tex;
+    int quads;
+    BackendVertex v[MOCK_QUADS * 4];
+} MockRun;
+
+static MockRun g_runs[MOCK_RUNS];
+static int g_run_count;
+
+static int mock_render_geometry(Texture *tex, const BackendVertex *v, int n, const int *idx, int ni)
+{
+    MockRun *run;
+    int q;
+    if (!v) {
+        return 0; /* capability probe */
+    }
+    assert_int_equal(n % 4, 0);
+    assert_int_equal(ni, n / 4 * 6);
+    for (q = 0; q < n / 4; q++) {
+        assert_int_equal(idx[q * 6 + 0], q * 4 + 0);
+        assert_int_equal(idx[q * 6 + 1], q * 4 + 1);
+        assert_int_equal(idx[q * 6 + 2], q * 4 + 2);
+        assert_int_equal(idx[q * 6 + 3], q * 4 + 2);
+        assert_int_equal(idx[q * 6 + 4], q * 4 + 3);
+        assert_int_equal(idx[q * 6 + 5], q * 4 + 0);
+    }
+    assert_true(g_run_count < MOCK_RUNS);
+    run = &g_runs[g_run_count++];
+    run->tex = tex;
+    run->quads = n / 4;
+    memcpy(run->v, v, (size_t)(n < MOCK_QUADS * 4 ? n : MOCK_QUADS * 4) * sizeof(BackendVertex));
+    return 0;
+}
+
+static int mock_query_texture(Texture *tex, Uint32 *format, int *access, int *w, int *h)
+{
+    (void)tex;
+    (void)format;
+    (void)access;
+    *w = 64;
+    *h = 32;
+    return 0;
+}
+
+static const GameBatchBackend g_mock_backend = {
+    mock_render_geometry,
+    mock_query_texture,
+};
+
+/* Bench backend: counts calls and quads without checking them. */
+static int g_bench_calls;
+static int g_bench_quads;
+
+static int bench_render_geometry(Texture *tex, const BackendVertex *v, int n, const int *idx, int ni)
+{
+    (void)tex;
+    (void)idx;
+    (void)ni;
+    if (v) {
+        g_bench_calls++;
+        g_bench_quads += n / 4;
+    }
+    return 0;
+}
+
+static const GameBatchBackend g_bench_backend = {
+    bench_render_geometry,
+    mock_query_texture,
+};
+
+static const MockRun *find_run(Texture *tex)
+{
+    int i;
+    for (i = 0; i < g_run_count; i++) {
+        if (g_runs[i].tex == tex) {
+            return &g_runs[i];
+        }
+    }
+    return NULL;
+}
+
+/* Corners go clockwise from the top-left. */
+static void assert_quad(const BackendVertex *v, float x, float y, float w, float h,
+                        float u0, float v0, float u1, float v1)
+{
+    assert_true(v[0].x == x && v[0].y == y);
+    assert_true(v[1].x == x + w && v[1].y == y);
+    assert_true(v[2].x == x + w && v[2].y == y + h);
+    assert_true(v[3].x == x && v[3].y == y + h);
+    assert_true(v[0].u == u0 && v[0].v == v0);
+    assert_true(v[1].u == u1 && v[1].v == v0);
+    assert_true(v[2].u == u1 && v[2].v == v1);
+    assert_true(v[3].u == u0 && v[3].v == v1);
+}
+
+static void spawn_sprites(int count)
+{
+    GameEntity *e;
+    int i;
+    for (i = 0; i < count; i++) {
+        e = game_spawn(NULL);
+        assert_non_null(e);
+        GAME_X(e) = (float)(i % 100) * 8.0f;
+        GAME_Y(e) = (float)(i / 100) * 8.0f;
+        e->w = 8.0f;
+        e->h = 8.0f;
+        /* Interleaved in slot order: batching relies on the sort, not spawn order */
+        if (i % (TEXTURES + 1) == TEXTURES) {
+            e->color = (Color){200, 80, 40, 255};
+        } else {
+            e->texture = (Texture *)&g_fake_textures[i % (TEXTURES + 1)];
+        }
+    }
+}
+
+static int spawn_particle_burst(int total, float life)
+{
+    Color c = {255, 200, 80, 255};
+    int spawned = 0;
+    while (spawned < total) {
+        int n = game_spawn_particles(400.0f, 300.0f, total - spawned < 64 ? total - spawned : 64,
+                                     c, 120.0f, life);
+        if (n == 0) {
+            break;
+        }
+        spawned += n;
+    }
+    return spawned;
+}
+
+static void test_runs_group_by_texture(void **state)
+{
+    const GamePerfStats *st;
+    GameEntity *top;
+
+    (void)state;
+    game_init();
+    spawn_sprites(50);
+    game_render();
+    st = game_perf_get_stats();
+    assert_int_equal(st->entities, 50);
+    /* solid + one run per texture */
+    assert_int_equal(st->batches, TEXTURES + 1);
+
+    /* Particles add one solid run after the sprites */
+    assert_int_equal(spawn_particle_burst(100, 1.0f), 100);
+    game_render();
+    assert_int_equal(st->particles, 100);
+    assert_int_equal(st->batches, TEXTURES + 2);
+
+    /* A higher layer always starts its own run */
+    top = game_spawn("top");
+    top->z = 1.0f;
+    top->texture = (Texture *)&g_fake_textures[0];
+    game_render();
+    assert_int_equal(st->batches, TEXTURES + 3);
+    game_shutdown();
+}
+
+static void test_geometry_runs(void **state)
+{
+    Color red = {255, 0, 0, 255};
+    const GamePerfStats *st;
+    const MockRun *run;
+    GameEntity *e;
+
+    (void)state;
+    game_init();
+    game_batch_set_backend(&g_mock_backend);
+
+    e = game_spawn(NULL);
+    GAME_X(e) = 10.0f;
+    GAME_Y(e) = 20.0f;
+    e->w = 8.0f;
+    e->h = 4.0f;
+    e->color = red;
+    /* Atlas frame (16,8)-(32,16) of the 64x32 mock texture */
+    e = game_spawn(NULL);
+    GAME_X(e) = 30.0f;
+    GAME_Y(e) = 40.0f;
+    e->w = 16.0f;
+    e->h = 8.0f;
+    e->texture = (Texture *)&g_fake_textures[0];
+    e->use_frame = 1;
+    e->frame_x = 16;
+    e->frame_y = 8;
+    e->frame_w = 16;
+    e->frame_h = 8;
+    e = game_spawn(NULL);
+    GAME_X(e) = 50.0f;
+    GAME_Y(e) = 60.0f;
+    e->w = 10.0f;
+    e->h = 10.0f;
+    e->texture = (Texture *)&g_fake_textures[0];
+    e = game_spawn(NULL);
+    GAME_X(e) = 70.0f;
+    GAME_Y(e) = 80.0f;
+    e->w = 12.0f;
+    e->h = 6.0f;
+    e->texture = (Texture *)&g_fake_textures[1];
+
+    g_run_count = 0;
+    game_render();
+    st = game_perf_get_stats();
+    assert_int_equal(g_run_count, 3);
+    assert_int_equal(st->batches, 3);
+    assert_int_equal(st->draw_calls, 3);
+
+    run = find_run(NULL);
+    assert_non_null(run);
+    assert_int_equal(run->quads, 1);
+    assert_quad(run->v, 10.0f, 20.0f, 8.0f, 4.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    assert_int_equal(run->v[2].color.r, 255);
+    assert_int_equal(run->v[2].color.g, 0);
+
+    /* Same texture, same z: one run, in slot order */
+    run = find_run((Texture *)&g_fake_textures[0]);
+    assert_non_null(run);
+    assert_int_equal(run->quads, 2);
+    assert_quad(run->v, 30.0f, 40.0f, 16.0f, 8.0f, 0.25f, 0.25f, 0.5f, 0.5f);
+    assert_quad(run->v + 4, 50.0f, 60.0f, 10.0f, 10.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+
+    run = find_run((Texture *)&g_fake_textures[1]);
+    assert_non_null(run);
+    assert_int_equal(run->quads, 1);
+    assert_quad(run->v, 70.0f, 80.0f, 12.0f, 6.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+
+    /* Particles: one more solid run with a quad per particle */
+    assert_int_equal(spawn_particle_burst(5, 1.0f), 5);
+    g_run_count = 0;
+    game_render();
+    assert_int_equal(g_run_count, 4);
+    assert_null(g_runs[3].tex);
+    assert_int_equal(g_runs[3].quads, 5);
+    assert_int_equal(st->draw_calls, 4);
+    game_shutdown();
+}
+
+/* Equal-z runs follow the first slot using each texture, not texture addresses */
+static void test_run_order_follows_slots(void **state)
+{
+    static const int slot_tex[6] = {2, 0, 2, 1, 0, 1};
+    GameEntity *e;
+    int i;
+
+    (void)state;
+    game_init();
+    game_batch_set_backend(&g_mock_backend);
+    for (i = 0; i < 6; i++) {
+        e = game_spawn(NULL);
+        e->w = 4.0f;
+        e->h = 4.0f;
+        e->texture = (Texture *)&g_fake_textures[slot_tex[i]];
+    }
+    g_run_count = 0;
+    game_render();
+    assert_int_equal(g_run_count, 3);
+    assert_ptr_equal(g_runs[0].tex, &g_fake_textures[2]);
+    assert_ptr_equal(g_runs[1].tex, &g_fake_textures[0]);
+    assert_ptr_equal(g_runs[2].tex, &g_fake_textures[1]);
+    for (i = 0; i < 3; i++) {
+        assert_int_equal(g_runs[i].quads, 2);
+    }
+    game_shutdown();
+}
+
+static int restore_backend(void **state)
+{
+    (void)state;
+    game_batch_set_backend(NULL);
+    return 0;
+}
+
+static void test_particles_soa(void **state)
+{
+    Color c = {10, 20, 30, 255};
+
+    (void)state;
+    game_init();
+    assert_int_equal(game_spawn_particles(0, 0, 64, c, 50.0f, 0.1f), 64);
+    assert_int_equal(game_spawn_particles(0, 0, 64, c, 50.0f, 1.0f), 64);
+    assert_int_equal(game_spawn_particles(0, 0, 64, c, 50.0f, 0.1f), 64);
+    game_particles_update(0.2f);
+    game_render();
+    assert_int_equal(game_perf_get_stats()->particles, 64);
+    game_particles_update(1.0f);
+    game_render();
+    assert_int_equal(game_perf_get_stats()->particles, 0);
+
+    /* No fixed cap on desktop builds */
+    assert_int_equal(spawn_particle_burst(BENCH_PARTICLES, 5.0f), BENCH_PARTICLES);
+    game_particles_clear();
+    game_render();
+    assert_int_equal(game_perf_get_stats()->particles, 0);
+    game_shutdown();
+}
+
+/* Render BENCH_FRAMES frames; returns ms per frame. */
+static double bench_frames(void)
+{
+    double t0;
+    int i;
+    t0 = unit_now_ms();
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        game_particles_update(1.0f / 60.0f);
+        game_render();
+    }
+    return (unit_now_ms() - t0) / BENCH_FRAMES;
+}
+
+static void test_bench_sprites_particles(void **state)
+{
+    const GamePerfStats *st;
+    double batched_ms;
+    double unbatched_ms;
+    int batched_calls;
+    int batches;
+
+    (void)state;
+    game_init();
+    spawn_sprites(BENCH_SPRITES);
+    spawn_particle_burst(BENCH_PARTICLES, 100.0f);
+    st = game_perf_get_stats();
+
+    /* Batched: one geometry call per texture run */
+    game_batch_set_backend(&g_bench_backend);
+    batched_ms = bench_frames();
+    batches = st->batches;
+    batched_calls = st->draw_calls;
+    assert_int_equal(st->entities, BENCH_SPRITES);
+    assert_int_equal(st->particles, BENCH_PARTICLES);
+    assert_int_equal(batches, TEXTURES + 2);
+    assert_int_equal(batched_calls, batches);
+    assert_int_equal(g_bench_calls, BENCH_FRAMES * batches);
+    assert_int_equal(g_bench_quads, BENCH_FRAMES * (BENCH_SPRITES + BENCH_PARTICLES));
+
+    /* Unbatched: no geometry support, every quad is its own draw */
+    game_batch_set_backend(NULL);
+    unbatched_ms = bench_frames();
+    assert_int_equal(st->batches, TEXTURES + 2);
+    assert_int_equal(st->draw_calls, BENCH_SPRITES + BENCH_PARTICLES);
+
+    printf("[game-batch] %d sprites + %d particles: batched %d batches, %d draw calls, %.3f ms/frame; "
+           "unbatched %d draw calls, %.3f ms/frame\n",
+           st->entities, st->particles, batches, batched_calls, batched_ms,
+           st->draw_calls, unbatched_ms);
+    game_shutdown();
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_runs_group_by_texture),
+        cmocka_unit_test_teardown(test_geometry_runs, restore_backend),
+        cmocka_unit_test_teardown(test_run_order_follows_slots, restore_backend),
+        cmocka_unit_test(test_particles_soa),
+        cmocka_unit_test_teardown(test_bench_sprites_particles, restore_backend),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,432 @@
+/*
+ * Game broad phase: trigger pairs from the spatial hash must match a full
+ * pairwise scan (including ENTER/STAY/EXIT diffing), solids found through the
+ * index must still block movers (wide floors, script-moved platforms), and a
+ * 10k-entity scene reports game_update time per frame (printed, not asserted).
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "game/game.h"
+#include "unit_util.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define BENCH_ENTITIES 10000
+#define BENCH_FRAMES 120
+
+static unsigned int g_rng = 12345u;
+
+static float frand(float lo, float hi)
+{
+    g_rng = g_rng * 1103515245u + 12345u;
+    return lo + (hi - lo) * (float)((g_rng >> 8) & 0xffff) / 65535.0f;
+}
+
+/* ---------- trigger event capture ---------- */
+typedef struct {
+    GameEntity *a;
+    GameEntity *b;
+    int slot_a;
+    int slot_b;
+} Pair;
+
+#define MAX_PAIRS 20000
+
+static Pair g_events[3][MAX_PAIRS];
+static int g_event_count[3];
+
+static void record_trigger(GameEntity *a, GameEntity *b, GameTriggerPhase phase)
+{
+    int n = g_event_count[phase];
+    if (n < MAX_PAIRS) {
+        g_events[phase][n].a = a;
+        g_events[phase][n].b = b;
+        g_events[phase][n].slot_a = a->slot;
+        g_events[phase][n].slot_b = b->slot;
+        g_event_count[phase] = n + 1;
+    }
+}
+
+static void count_trigger_fn(GameEntity *a, GameEntity *b, GameTriggerPhase phase)
+{
+    (void)a;
+    (void)b;
+    g_event_count[phase]++;
+}
+
+/* Reference: every pair the old all-pairs loop would report, in its order. */
+static int brute_force_pairs(Pair *out)
+{
+    int n = 0;
+    int count = 0;
+    int i, j;
+    GameEntity **all = game_entities(&n);
+    for (i = 0; i < n; i++) {
+        if (!all[i] || !GAME_ALIVE(all[i]) || !GAME_TRIGGER(all[i])) {
+            continue;
+        }
+        for (j = 0; j < n; j++) {
+            if (i == j || !all[j] || !GAME_ALIVE(all[j])) {
+                continue;
+            }
+            if (j < i && GAME_TRIGGER(all[j])) {
+                continue;
+            }
+            if (game_entities_overlap(all[i], all[j]) && count < MAX_PAIRS) {
+                out[count].a = all[i];
+                out[count].b = all[j];
+                out[count].slot_a = i;
+                out[count].slot_b = j;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+static int pair_listed(const Pair *p, const Pair *list, int count)
+{
+    int i;
+    for (i = 0; i < count; i++) {
+        if (list[i].slot_a == p->slot_a && list[i].slot_b == p->slot_b) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int pair_alive(const Pair *p)
+{
+    int n = 0;
+    GameEntity **all = game_entities(&n);
+    return all[p->slot_a] == p->a && all[p->slot_b] == p->b && GAME_ALIVE(p->a) && GAME_ALIVE(p->b);
+}
+
+static GameEntity *spawn_box(float x, float y, float w, float h)
+{
+    GameEntity *e = game_spawn(NULL);
+    assert_non_null(e);
+    GAME_X(e) = x;
+    GAME_Y(e) = y;
+    e->w = w;
+    e->h = h;
+    return e;
+}
+
+static GameEntity *spawn_solid(float x, float y, float w, float h)
+{
+    GameEntity *e = spawn_box(x, y, w, h);
+    GAME_SET_FLAG(e, GAME_ENTITY_SOLID, 1);
+    return e;
+}
+
+static int setup(void **state)
+{
+    (void)state;
+    game_init();
+    game_clear_scene();
+    g_rng = 12345u;
+    return 0;
+}
+
+static int teardown(void **state)
+{
+    (void)state;
+    game_set_trigger_fn(NULL);
+    game_set_script_update_fn(NULL);
+    game_shutdown();
+    return 0;
+}
+
+static void test_triggers_match_bruteforce(void **state)
+{
+    static Pair expected[MAX_PAIRS];
+    static Pair prev[MAX_PAIRS];
+    int prev_count = 0;
+    int frame, i;
+
+    (void)state;
+    for (i = 0; i < 600; i++) {
+        GameEntity *e = spawn_box(frand(0, 1200), frand(0, 1200), frand(6, 40), frand(6, 40));
+        if (i % 3 == 0) {
+            GAME_SET_FLAG(e, GAME_ENTITY_TRIGGER, 1);
+        } else if (i % 11 == 0) {
+            GAME_SET_FLAG(e, GAME_ENTITY_SOLID, 1);
+        }
+        if (!GAME_SOLID(e)) {
+            GAME_VX(e) = frand(-120, 120);
+            GAME_VY(e) = frand(-120, 120);
+        }
+    }
+    /* one floor wider than the per-entity cell span limit */
+    spawn_solid(-500, 1190, 2500, 40);
+    game_set_trigger_fn(record_trigger);
+
+    for (frame = 0; frame < 30; frame++) {
+        int count;
+        int exits = 0;
+        memset(g_event_count, 0, sizeof(g_event_count));
+        game_update(1.0f / 30.0f);
+
+        count = brute_force_pairs(expected);
+        assert_true(count > 0);
+        assert_int_equal(g_event_count[GAME_TRIGGER_ENTER] + g_event_count[GAME_TRIGGER_STAY], count);
+        for (i = 0; i < count; i++) {
+            GameTriggerPhase want = pair_listed(&expected[i], prev, prev_count)
+                                        ? GAME_TRIGGER_STAY : GAME_TRIGGER_ENTER;
+            assert_true(pair_listed(&expected[i], g_events[want], g_event_count[want]));
+        }
+        for (i = 0; i < prev_count; i++) {
+            if (!pair_listed(&prev[i], expected, count) && pair_alive(&prev[i])) {
+                assert_true(pair_listed(&prev[i], g_events[GAME_TRIGGER_EXIT],
+                                        g_event_count[GAME_TRIGGER_EXIT]));
+                exits++;
+            }
+        }
+        assert_int_equal(g_event_count[GAME_TRIGGER_EXIT], exits);
+        /* callback order follows slot order like the old scan */
+        for (i = 1; i < g_event_count[GAME_TRIGGER_ENTER]; i++) {
+            const Pair *a = &g_events[GAME_TRIGGER_ENTER][i - 1];
+            const Pair *b = &g_events[GAME_TRIGGER_ENTER][i];
+            assert_true(a->slot_a < b->slot_a || (a->slot_a == b->slot_a && a->slot_b < b->slot_b));
+        }
+        memcpy(prev, expected, sizeof(Pair) * (size_t)count);
+        prev_count = count;
+    }
+}
+
+static GameEntity *g_platform;
+static GameEntity *g_faller;
+
+static void move_platform(GameEntity *e, float dt)
+{
+    (void)dt;
+    /* teleport under the faller, far from where the index saw it */
+    GAME_X(e) = GAME_X(g_faller) - 20;
+    GAME_Y(e) = 600;
+}
+
+static void test_solids_block_movers(void **state)
+{
+    GameEntity *lander;
+    GameEntity *walker;
+    int i;
+
+    (void)state;
+    for (i = 0; i < 2000; i++) {
+        spawn_solid(3000 + (float)(i % 50) * 40, 3000 + (float)(i / 50) * 40, 16, 16);
+    }
+    spawn_solid(-5000, 500, 10000, 32);
+
+    lander = spawn_box(100, 400, 16, 16);
+    GAME_VY(lander) = 300;
+    walker = spawn_box(3000 - 40, 3000, 16, 16);
+    GAME_VX(walker) = 600;
+
+    g_platform = spawn_box(-2000, -2000, 80, 16);
+    GAME_SET_FLAG(g_platform, GAME_ENTITY_SOLID, 1);
+    game_entity_set_script(g_platform, "mover");
+    g_faller = spawn_box(900, 560, 16, 16);
+    GAME_VY(g_faller) = 300;
+    game_set_script_update_fn(move_platform);
+    /* the faller's slot is after the platform's, so it moves after the script */
+    assert_true(g_faller->slot > g_platform->slot);
+
+    for (i = 0; i < 60; i++) {
+        game_update(1.0f / 60.0f);
+        /* park it again so every frame's index sees it far away */
+        GAME_X(g_platform) = -2000;
+        GAME_Y(g_platform) = -2000;
+    }
+    /* no gravity here: landing zeroes vy and the box rests on the floor */
+    assert_true(GAME_VY(lander) == 0.0f);
+    assert_true(GAME_Y(lander) + lander->h <= 500.01f);
+    assert_true(GAME_Y(lander) + lander->h >= 499.0f);
+    assert_true(GAME_X(walker) + walker->w <= 3000.01f);
+    assert_true(GAME_VY(g_faller) == 0.0f);
+    assert_true(GAME_Y(g_faller) + g_faller->h <= 600.01f);
+    assert_true(GAME_Y(g_faller) + g_faller->h >= 599.0f);
+}
+
+/* Bullet hits: destroy it and spawn an explosion, which reuses its slot and storage. */
+static GameEntity *g_bullet;
+static GameEntity *g_boom;
+
+static void explode_trigger(GameEntity *a, GameEntity *b, GameTriggerPhase phase)
+{
+    record_trigger(a, b, phase);
+    if (b == g_bullet) {
+        b = a;
+        a = g_bullet;
+    }
+    if (a == g_bullet && !g_boom && phase == GAME_TRIGGER_ENTER) {
+        float x = GAME_X(a);
+        float y = GAME_Y(a);
+        game_destroy(a);
+        g_boom = game_pool_acquire("boom");
+        assert_non_null(g_boom);
+        GAME_X(g_boom) = x;
+        GAME_Y(g_boom) = y;
+        g_boom->w = 20;
+        g_boom->h = 20;
+        GAME_SET_FLAG(g_boom, GAME_ENTITY_TRIGGER, 1);
+    }
+}
+
+static void test_trigger_respawn_in_callback(void **state)
+{
+    int slot;
+
+    (void)state;
+    spawn_box(100, 100, 20, 20);
+    spawn_box(110, 100, 20, 20);
+    g_boom = NULL;
+    g_bullet = spawn_box(105, 100, 20, 20);
+    GAME_SET_FLAG(g_bullet, GAME_ENTITY_TRIGGER, 1);
+    slot = g_bullet->slot;
+    game_set_trigger_fn(explode_trigger);
+
+    memset(g_event_count, 0, sizeof(g_event_count));
+    game_update(0.0f);
+    /* the second target's ENTER belonged to the destroyed bullet */
+    assert_non_null(g_boom);
+    assert_ptr_equal(g_boom, g_bullet);
+    assert_int_equal(g_boom->slot, slot);
+    assert_int_equal(g_event_count[GAME_TRIGGER_ENTER], 1);
+    assert_int_equal(g_event_count[GAME_TRIGGER_STAY], 0);
+
+    /* same storage, new entity: its overlaps are new, and the bullet's never exit */
+    memset(g_event_count, 0, sizeof(g_event_count));
+    game_update(0.0f);
+    assert_int_equal(g_event_count[GAME_TRIGGER_ENTER], 2);
+    assert_int_equal(g_event_count[GAME_TRIGGER_STAY], 0);
+    assert_int_equal(g_event_count[GAME_TRIGGER_EXIT], 0);
+
+    memset(g_event_count, 0, sizeof(g_event_count));
+    game_update(0.0f);
+    assert_int_equal(g_event_count[GAME_TRIGGER_ENTER], 0);
+    assert_int_equal(g_event_count[GAME_TRIGGER_STAY], 2);
+
+    /* pool release + reacquire is a new occupant as well */
+    memset(g_event_count, 0, sizeof(g_event_count));
+    game_pool_release(g_boom);
+    assert_ptr_equal(game_pool_acquire("boom"), g_boom);
+    game_update(0.0f);
+    assert_int_equal(g_event_count[GAME_TRIGGER_ENTER], 2);
+    assert_int_equal(g_event_count[GAME_TRIGGER_STAY], 0);
+    assert_int_equal(g_event_count[GAME_TRIGGER_EXIT], 0);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static void test_bench_10k(void **state)
+{
+    double samples[BENCH_FRAMES];
+    double sum = 0.0;
+    int frame, i;
+    int pairs = 0;
+
+    (void)state;
+    for (i = 0; i < BENCH_ENTITIES; i++) {
+        GameEntity *e;
+        if (i < 400) {
+            e = spawn_box(frand(0, 4000), frand(0, 4000), frand(32, 96), frand(32, 96));
+            GAME_SET_FLAG(e, GAME_ENTITY_SOLID, 1);
+            continue;
+        }
+        if (i < 8400) {
+            e = game_pool_acquire("bullet");
+            assert_non_null(e);
+            e->w = 6;
+            e->h = 6;
+            GAME_SET_FLAG(e, GAME_ENTITY_TRIGGER, 1);
+        } else {
+            e = spawn_box(0, 0, 24, 24);
+        }
+        GAME_X(e) = frand(0, 4000);
+        GAME_Y(e) = frand(0, 4000);
+        GAME_VX(e) = frand(-200, 200);
+        GAME_VY(e) = frand(-200, 200);
+    }
+    game_set_trigger_fn(count_trigger_fn);
+
+    for (frame = 0; frame < BENCH_FRAMES; frame++) {
+        int n = 0;
+        GameEntity **all;
+        double t0;
+
+        memset(g_event_count, 0, sizeof(g_event_count));
+        t0 = unit_now_ms();
+        game_update(1.0f / 60.0f);
+        samples[frame] = unit_now_ms() - t0;
+        sum += samples[frame];
+        pairs += g_event_count[GAME_TRIGGER_ENTER] + g_event_count[GAME_TRIGGER_STAY];
+
+        /* keep the population steady: refire bullets that hit a wall, wrap the rest */
+        all = game_entities(&n);
+        for (i = 0; i < n; i++) {
+            GameEntity *e = all[i];
+            if (!e) {
+                continue;
+            }
+            if (!GAME_ALIVE(e) && e->pooled) {
+                e = game_pool_acquire("bullet");
+                GAME_X(e) = frand(0, 4000);
+                GAME_Y(e) = frand(0, 4000);
+                GAME_VX(e) = frand(-200, 200);
+                GAME_VY(e) = frand(-200, 200);
+                all = game_entities(&n);
+            }
+            if (GAME_X(e) < 0) GAME_X(e) += 4000;
+            if (GAME_X(e) > 4000) GAME_X(e) -= 4000;
+            if (GAME_Y(e) < 0) GAME_Y(e) += 4000;
+            if (GAME_Y(e) > 4000) GAME_Y(e) -= 4000;
+        }
+    }
+
+    qsort(samples, BENCH_FRAMES, sizeof(double), cmp_double);
+    printf("[game-collide] %d entities, %d frames: avg=%.3fms p50=%.3fms p99=%.3fms max=%.3fms "
+           "trigger pairs/frame=%d\n",
+           BENCH_ENTITIES, BENCH_FRAMES, sum / BENCH_FRAMES,
+           samples[BENCH_FRAMES / 2], samples[BENCH_FRAMES * 99 / 100], samples[BENCH_FRAMES - 1],
+           pairs / BENCH_FRAMES);
+    /* Timings are informational: a wall-clock budget flakes on loaded CI */
+    assert_true(pairs > 0);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_triggers_match_bruteforce, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_solids_block_movers, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_trigger_respawn_in_callback, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_bench_10k, setup, teardown),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
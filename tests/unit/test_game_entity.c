@@ -0,0 +1,147 @@
+/*
+ * Game entity store: entities live in chunks past the old 128 cap, ids and
+ * tags are interned and looked up through per-name lists (lowest slot wins,
+ * findAllByTag stays in slot order), pools hand back released entities by
+ * prefab, and a freed slot is reused without leaking its old names.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "game/game.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define ENTITY_COUNT 5000
+
+static void test_names_and_lookup(void **state)
+{
+    static GameEntity *list[ENTITY_COUNT];
+    GameEntity *first;
+    GameEntity *e;
+    char id[32];
+    int n;
+    int i;
+
+    (void)state;
+    game_init();
+    for (i = 0; i < ENTITY_COUNT; i++) {
+        snprintf(id, sizeof(id), "e%d", i);
+        e = game_spawn(id);
+        assert_non_null(e);
+        assert_int_equal(e->slot, i);
+        game_entity_set_tag(e, (i % 3 == 0) ? "enemy" : "coin");
+    }
+    game_entities(&n);
+    assert_int_equal(n, ENTITY_COUNT);
+
+    e = game_find("e4321");
+    assert_non_null(e);
+    assert_int_equal(e->slot, 4321);
+    assert_string_equal(e->id, "e4321");
+    assert_null(game_find("missing"));
+    /* Same string, same pointer */
+    assert_ptr_equal(game_find("e7")->tag, game_find("e10")->tag);
+
+    first = game_find_by_tag("enemy");
+    assert_non_null(first);
+    assert_int_equal(first->slot, 0);
+    n = game_find_all_by_tag("enemy", list, ENTITY_COUNT);
+    assert_int_equal(n, (ENTITY_COUNT + 2) / 3);
+    for (i = 1; i < n; i++) {
+        assert_true(list[i - 1]->slot < list[i]->slot);
+    }
+    n = game_find_all_by_tag("enemy", list, 4);
+    assert_int_equal(n, 4);
+    assert_int_equal(list[3]->slot, 9);
+
+    /* Retag and destroy keep the lists consistent */
+    game_entity_set_tag(game_find("e0"), "boss");
+    assert_int_equal(game_find_by_tag("enemy")->slot, 3);
+    assert_int_equal(game_find_by_tag("boss")->slot, 0);
+    game_destroy_by_id("e3");
+    assert_null(game_find("e3"));
+    assert_int_equal(game_find_by_tag("enemy")->slot, 6);
+
+    /* Freed slot is reused and starts unnamed */
+    e = game_spawn(NULL);
+    assert_non_null(e);
+    assert_int_equal(e->slot, 3);
+    assert_string_equal(e->id, "");
+    assert_string_equal(e->tag, "");
+    assert_null(e->anim);
+    assert_int_equal(game_find_by_tag("enemy")->slot, 6);
+
+    game_clear_scene();
+    assert_null(game_find("e10"));
+    assert_null(game_find_by_tag("coin"));
+    game_shutdown();
+}
+
+static void test_pool_reuse(void **state)
+{
+    GameEntity *a;
+    GameEntity *b;
+    GameEntity *c;
+
+    (void)state;
+    game_init();
+    a = game_pool_acquire("bullet");
+    b = game_pool_acquire("bullet");
+    assert_non_null(a);
+    assert_non_null(b);
+    assert_ptr_not_equal(a, b);
+    assert_string_equal(a->prefab, "bullet");
+    assert_string_equal(a->tag, "bullet");
+
+    GAME_X(a) = 42.0f;
+    game_pool_release(a);
+    game_pool_release(a); /* double release is harmless */
+    assert_false(GAME_ALIVE(a));
+    assert_ptr_equal(game_find_by_tag("bullet"), b);
+
+    c = game_pool_acquire("bullet");
+    assert_ptr_equal(c, a);
+    assert_true(GAME_ALIVE(c));
+    assert_true(GAME_X(c) == 42.0f);
+    /* Pool is empty again: next acquire spawns a new slot */
+    c = game_pool_acquire("bullet");
+    assert_ptr_not_equal(c, a);
+    assert_ptr_not_equal(c, b);
+
+    /* Destroying a pooled entity drops it from the pool */
+    game_pool_release(b);
+    game_destroy(b);
+    c = game_pool_acquire("bullet");
+    assert_true(GAME_ALIVE(c));
+    assert_int_equal(c->slot, 1);
+    game_shutdown();
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_names_and_lookup),
+        cmocka_unit_test(test_pool_reuse),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
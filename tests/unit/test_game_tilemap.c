@@ -0,0 +1,215 @@
+/*
+ * Game tilemap: a 1024x1024 map loads from inline runs and round-trips
+ * through the binary format, only chunks under the camera are drawn,
+ * set_tile edits are visible to rendering and tile collision, baked
+ * chunks survive render target resets, and the chunk texture cache is
+ * sized from the window so panning never evicts chunks still in view.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "game/game.h"
+#include "game/internal.h"
+#include "unit_util.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define MAP_SIZE 1024
+#define GROUND_ROW 1000
+#define TILE 32
+#define BENCH_FRAMES 60
+
+/* Sky above GROUND_ROW, ground (tid 1) below it. */
+static int load_ground_map(void)
+{
+    char json[256];
+    cJSON *node;
+    int ok;
+    snprintf(json, sizeof(json),
+             "{\"tileSize\": %d, \"size\": [%d, %d], \"rle\": [%d, 0, %d, 1]}",
+             TILE, MAP_SIZE, MAP_SIZE, MAP_SIZE * GROUND_ROW, MAP_SIZE * (MAP_SIZE - GROUND_ROW));
+    node = cJSON_Parse(json);
+    ok = game_tilemap_load_from_json(node);
+    cJSON_Delete(node);
+    return ok;
+}
+
+static int chunks_drawn(void)
+{
+    game_render();
+    return game_perf_get_stats()->tile_chunks;
+}
+
+static void test_large_map_round_trip(void **state)
+{
+    char path[512];
+    cJSON *bad;
+    FILE *fp;
+    long size;
+
+    (void)state;
+    unit_temp_path(path, sizeof(path), "game_tilemap_test.ytm");
+    game_init();
+    assert_int_equal(load_ground_map(), 1);
+    assert_int_equal(game_tilemap_get_tile(0, GROUND_ROW - 1), 0);
+    assert_int_equal(game_tilemap_get_tile(MAP_SIZE - 1, GROUND_ROW), 1);
+    assert_int_equal(game_tilemap_get_tile(MAP_SIZE, 0), -1);
+    assert_int_equal(game_tilemap_get_tile(0, -1), -1);
+
+    assert_int_equal(game_tilemap_set_tile(700, 300, 7), 1);
+    assert_int_equal(game_tilemap_set_tile(701, 300, 7), 1);
+    assert_int_equal(game_tilemap_set_tile(-1, 0, 7), 0);
+    assert_int_equal(game_tilemap_save_binary(path), 1);
+
+    fp = fopen(path, "rb");
+    assert_non_null(fp);
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fclose(fp);
+    /* header + 4 runs instead of a million cells */
+    assert_int_equal(size, 12 + 4 * 6);
+
+    game_tilemap_clear();
+    assert_int_equal(game_tilemap_get_tile(700, 300), -1);
+    assert_int_equal(game_tilemap_load_binary(path), 1);
+    assert_int_equal(game_tilemap_get_tile(699, 300), 0);
+    assert_int_equal(game_tilemap_get_tile(700, 300), 7);
+    assert_int_equal(game_tilemap_get_tile(701, 300), 7);
+    assert_int_equal(game_tilemap_get_tile(MAP_SIZE - 1, MAP_SIZE - 1), 1);
+
+    /* Runs must cover the grid exactly */
+    bad = cJSON_Parse("{\"size\": [4, 4], \"rle\": [15, 0]}");
+    assert_int_equal(game_tilemap_load_from_json(bad), 0);
+    cJSON_Delete(bad);
+    bad = cJSON_Parse("{\"size\": [4, 4], \"rle\": [20, 1]}");
+    assert_int_equal(game_tilemap_load_from_json(bad), 0);
+    cJSON_Delete(bad);
+
+    remove(path);
+    game_shutdown();
+}
+
+static void test_camera_culling_and_edits(void **state)
+{
+    GameEntity *e;
+    double t0;
+    double ms;
+    int i;
+
+    (void)state;
+    game_init();
+    assert_int_equal(load_ground_map(), 1);
+
+    /* Top-left view: only sky, nothing to draw */
+    game_camera_set(0.0f, 0.0f);
+    assert_int_equal(chunks_drawn(), 0);
+
+    /* An edit in view makes its chunk drawable */
+    assert_int_equal(game_tilemap_set_tile(3, 3, 2), 1);
+    assert_int_equal(chunks_drawn(), 1);
+    assert_true(game_perf_get_stats()->draws >= 1);
+    assert_int_equal(game_tilemap_set_tile(3, 3, 0), 1);
+    assert_int_equal(chunks_drawn(), 0);
+
+    /* Bottom-left view over the ground: a handful of the 4096 chunks */
+    game_camera_set(0.0f, (float)(GROUND_ROW * TILE));
+    i = chunks_drawn();
+    assert_true(i > 0);
+    assert_true(i <= 6);
+
+    /* Off the map: nothing */
+    game_camera_set(-5000.0f, -5000.0f);
+    assert_int_equal(chunks_drawn(), 0);
+
+    game_camera_set(0.0f, (float)((GROUND_ROW - 10) * TILE));
+    t0 = unit_now_ms();
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        game_render();
+    }
+    ms = (unit_now_ms() - t0) / BENCH_FRAMES;
+    printf("tilemap bench: %dx%d tiles, %d chunks drawn, %.3f ms/frame\n",
+           MAP_SIZE, MAP_SIZE, game_perf_get_stats()->tile_chunks, ms);
+
+    /* Render target / device resets re-bake or recreate the same chunks */
+    i = game_perf_get_stats()->tile_chunks;
+    game_tilemap_invalidate_chunks(0);
+    assert_int_equal(chunks_drawn(), i);
+    game_tilemap_invalidate_chunks(1);
+    assert_int_equal(chunks_drawn(), i);
+
+    /* Tile collision lands on the ground row and on edited tiles */
+    e = game_spawn("hero");
+    assert_non_null(e);
+    e->w = 20.0f;
+    e->h = 20.0f;
+    GAME_X(e) = 100.0f;
+    GAME_Y(e) = (float)(GROUND_ROW * TILE) - 15.0f;
+    GAME_VY(e) = 50.0f;
+    game_tilemap_collide(e);
+    assert_true(GAME_GROUNDED(e));
+    assert_true(GAME_Y(e) + e->h <= (float)(GROUND_ROW * TILE) + 0.01f);
+
+    assert_int_equal(game_tilemap_set_tile(3, GROUND_ROW - 1, 0), 1);
+    assert_int_equal(game_tilemap_set_tile(3, 500, 1), 1);
+    GAME_SET_FLAG(e, GAME_ENTITY_GROUNDED, 0);
+    GAME_X(e) = 3.0f * TILE + 4.0f;
+    GAME_Y(e) = 500.0f * TILE - 15.0f;
+    GAME_VY(e) = 50.0f;
+    game_tilemap_collide(e);
+    assert_true(GAME_GROUNDED(e));
+    assert_true(GAME_Y(e) + e->h <= 500.0f * TILE + 0.01f);
+    game_shutdown();
+}
+
+static void test_texture_cache_follows_window(void **state)
+{
+    int baked;
+    int budget;
+    int drawn;
+    int i;
+
+    (void)state;
+    game_init();
+    assert_int_equal(load_ground_map(), 1);
+
+    /* Pan along the ground across many more chunks than any fixed cache */
+    for (i = 0; i < 400; i++) {
+        game_camera_set((float)(i * TILE * 2), (float)((GROUND_ROW - 4) * TILE));
+        drawn = chunks_drawn();
+        game_tilemap_cache_stats(&baked, &budget);
+        assert_true(drawn > 0);
+        assert_true(budget >= drawn);
+        assert_true(baked <= budget);
+    }
+    game_shutdown();
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_large_map_round_trip),
+        cmocka_unit_test(test_camera_culling_and_edits),
+        cmocka_unit_test(test_texture_cache_follows_window),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
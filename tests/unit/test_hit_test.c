@@ -0,0 +1,209 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "hit_test.h"
+#include "event.h"
+#include "damage.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define GRID_COLS 40
+#define GRID_ROWS 25
+#define CELL_W 20
+#define CELL_H 16
+
+/* 根节点下铺满 1000 个小图层 */
+typedef struct {
+    Layer root;
+    Layer cells[GRID_COLS * GRID_ROWS];
+    Layer* children[GRID_COLS * GRID_ROWS];
+} Tree;
+
+static Tree* tree_new(void)
+{
+    Tree* tree = calloc(1, sizeof(Tree));
+    int i;
+    assert_non_null(tree);
+    tree->root.visible = VISIBLE;
+    tree->root.rect.w = GRID_COLS * CELL_W;
+    tree->root.rect.h = GRID_ROWS * CELL_H;
+    tree->root.children = tree->children;
+    tree->root.child_count = GRID_COLS * GRID_ROWS;
+    for (i = 0; i < GRID_COLS * GRID_ROWS; i++) {
+        Layer* cell = &tree->cells[i];
+        cell->visible = VISIBLE;
+        cell->parent = &tree->root;
+        cell->rect.x = (i % GRID_COLS) * CELL_W;
+        cell->rect.y = (i / GRID_COLS) * CELL_H;
+        cell->rect.w = CELL_W;
+        cell->rect.h = CELL_H;
+        tree->children[i] = cell;
+    }
+    return tree;
+}
+
+/* 对应 destroy_layer 中的 hit_test_forget */
+static void tree_free(Tree* tree)
+{
+    int i;
+    for (i = 0; i < GRID_COLS * GRID_ROWS; i++) {
+        hit_test_forget(&tree->cells[i]);
+    }
+    hit_test_forget(&tree->root);
+    free(tree);
+}
+
+static int count_marked(Tree* tree)
+{
+    int i;
+    int n = 0;
+    for (i = 0; i < GRID_COLS * GRID_ROWS; i++) {
+        n += hit_test_marked(&tree->cells[i]);
+    }
+    return n;
+}
+
+static void test_move_marks_only_hits(void **state)
+{
+    Tree* tree = tree_new();
+    Layer* a = &tree->cells[3 * GRID_COLS + 5];
+    Layer* b = &tree->cells[10 * GRID_COLS + 20];
+
+    (void)state;
+    hit_test_invalidate();
+    assert_true(hit_test_begin_move(&tree->root, a->rect.x + 1, a->rect.y + 1));
+    assert_true(hit_test_marked(&tree->root));
+    assert_true(hit_test_marked(a));
+    assert_int_equal(count_marked(tree), 1);
+
+    /* 移到 b：a 作为上一次命中再收一次，用于复原 hover */
+    assert_true(hit_test_begin_move(&tree->root, b->rect.x + 2, b->rect.y + 2));
+    assert_true(hit_test_marked(a));
+    assert_true(hit_test_marked(b));
+    assert_int_equal(count_marked(tree), 2);
+
+    assert_true(hit_test_begin_move(&tree->root, b->rect.x + 3, b->rect.y + 3));
+    assert_false(hit_test_marked(a));
+    assert_int_equal(count_marked(tree), 1);
+
+    /* 网格外回退到完整遍历 */
+    assert_false(hit_test_begin_move(&tree->root, -5, 10));
+    assert_false(hit_test_marked(b));
+
+    hit_test_end_move();
+    assert_false(hit_test_marked(&tree->root));
+    tree_free(tree);
+}
+
+static void test_capture_and_invalidate(void **state)
+{
+    Tree* tree = tree_new();
+    Layer* a = &tree->cells[0];
+    Layer* b = &tree->cells[GRID_COLS * GRID_ROWS - 1];
+    int i;
+
+    (void)state;
+    hit_test_invalidate();
+    hit_test_set_capture(a);
+    for (i = 0; i < 3; i++) {
+        assert_true(hit_test_begin_move(&tree->root, b->rect.x + 1, b->rect.y + 1));
+    }
+    assert_true(hit_test_marked(a));
+    assert_true(hit_test_marked(b));
+    assert_int_equal(count_marked(tree), 2);
+
+    hit_test_release_capture();
+    assert_true(hit_test_begin_move(&tree->root, b->rect.x + 1, b->rect.y + 1));
+    assert_false(hit_test_marked(a));
+
+    /* 几何变化后重建：a 移到指针下 */
+    a->rect.x = b->rect.x;
+    a->rect.y = b->rect.y;
+    hit_test_invalidate();
+    assert_true(hit_test_begin_move(&tree->root, b->rect.x + 1, b->rect.y + 1));
+    assert_true(hit_test_marked(a));
+    assert_true(hit_test_marked(b));
+
+    /* 隐藏的图层不进索引 */
+    a->visible = IN_VISIBLE;
+    hit_test_invalidate();
+    assert_true(hit_test_begin_move(&tree->root, b->rect.x + 1, b->rect.y + 1));
+    assert_true(hit_test_begin_move(&tree->root, b->rect.x + 1, b->rect.y + 1));
+    assert_false(hit_test_marked(a));
+
+    hit_test_end_move();
+    tree_free(tree);
+}
+
+/* 悬停只重绘状态变化的图层，不再整屏 */
+static void test_move_damages_hovered_only(void **state)
+{
+    Tree* tree = tree_new();
+    Layer* a = &tree->cells[3 * GRID_COLS + 5];
+    Layer* b = &tree->cells[3 * GRID_COLS + 6];
+    Rect viewport = {0, 0, GRID_COLS * CELL_W, GRID_ROWS * CELL_H};
+    PointerEvent ev;
+    const Rect* rects;
+    int count;
+
+    (void)state;
+    hit_test_invalidate();
+    memset(&ev, 0, sizeof(ev));
+    ev.device = POINTER_DEVICE_MOUSE;
+    ev.phase = POINTER_MOVE;
+    ev.x = a->rect.x + 1;
+    ev.y = a->rect.y + 1;
+    /* 首次移动根图层也进入 hover，先取走这一帧 */
+    handle_pointer_event(&tree->root, &ev);
+    damage_begin_frame(&viewport);
+
+    ev.x = a->rect.x + 2;
+    handle_pointer_event(&tree->root, &ev);
+    assert_int_equal(a->state, LAYER_STATE_HOVER);
+    assert_int_equal(damage_begin_frame(&viewport), 0);
+
+    /* a -> b：只重绘离开和进入的两格 */
+    ev.x = b->rect.x + 1;
+    handle_pointer_event(&tree->root, &ev);
+    assert_int_equal(a->state, LAYER_STATE_NORMAL);
+    assert_int_equal(b->state, LAYER_STATE_HOVER);
+    assert_true(damage_begin_frame(&viewport) >= 1);
+    assert_false(damage_frame_is_full());
+    assert_int_equal(damage_frame_area(), 2 * CELL_W * CELL_H);
+    rects = damage_frame_rects(&count);
+    assert_non_null(rects);
+    assert_true(rects[0].y == a->rect.y);
+
+    hit_test_end_move();
+    tree_free(tree);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_move_marks_only_hits),
+        cmocka_unit_test(test_capture_and_invalidate),
+        cmocka_unit_test(test_move_damages_hovered_only),
+    };
+
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
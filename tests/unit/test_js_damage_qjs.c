@@ -0,0 +1,135 @@
+// test_js_damage_qjs.c
+// JS 事件回调的脏区：回调经 setBgColor 等设置器修改的图层与事件图层自身记脏，
+// 不再整屏重绘；没有处理器的事件不产生脏区。
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "js_module.h"
+#include "layer.h"
+#include "damage.h"
+#include "cJSON.h"
+#include "unit_util.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+extern struct Layer *g_layer_root;
+
+static const Rect k_viewport = {0, 0, 800, 600};
+
+static const char *kTestScript =
+    "var __clicks = 0;\n"
+    "function onBtn() { __clicks++; setBgColor('label', '#ff0000'); }\n";
+
+static int write_script(const char *path, const char *src)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    fwrite(src, 1, strlen(src), f);
+    fclose(f);
+    return 0;
+}
+
+static Layer *child(Layer *root, const char *id, int x, int y)
+{
+    Layer *layer = find_layer_by_id(root, id);
+    assert_non_null(layer);
+    layer->rect = (Rect){x, y, 100, 40};
+    return layer;
+}
+
+static int frame_has_rect(const Rect *want)
+{
+    int count = 0;
+    const Rect *rects = damage_frame_rects(&count);
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (memcmp(&rects[i], want, sizeof(Rect)) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void test_click_damages_touched_layers(void **state)
+{
+    char script_path[512];
+    cJSON *json = cJSON_Parse("{\"id\":\"root\",\"type\":\"View\",\"size\":[800,600],\"children\":["
+                              "{\"id\":\"btn\",\"type\":\"View\"},"
+                              "{\"id\":\"label\",\"type\":\"View\"},"
+                              "{\"id\":\"idle\",\"type\":\"View\"}]}");
+    Layer *root;
+    Layer *btn;
+    Layer *label;
+    Layer *idle;
+
+    (void)state;
+    unit_temp_path(script_path, sizeof(script_path), "js_damage_test_qjs.js");
+    assert_non_null(json);
+    root = layer_create_from_json(json, NULL);
+    cJSON_Delete(json);
+    assert_non_null(root);
+    root->rect = k_viewport;
+    btn = child(root, "btn", 10, 10);
+    label = child(root, "label", 400, 300);
+    idle = child(root, "idle", 10, 500);
+    g_layer_root = root;
+
+    assert_int_equal(write_script(script_path, kTestScript), 0);
+    assert_int_equal(js_module_init(), 0);
+    assert_int_equal(js_module_load_file(script_path), 0);
+    assert_int_equal(js_module_set_event("btn", "onClick", "onBtn"), 0);
+    assert_int_equal(js_module_set_event("idle", "onClick", "noSuchHandler"), 0);
+    assert_non_null(btn->event->click);
+    assert_non_null(idle->event->click);
+
+    damage_add_full();
+    damage_begin_frame(&k_viewport);
+
+    /* 回调改了 label 的背景色：只有 btn 与 label 两块 */
+    btn->event->click(btn);
+    assert_int_equal(label->bg_color.r, 255);
+    assert_int_equal(damage_begin_frame(&k_viewport), 2);
+    assert_false(damage_frame_is_full());
+    assert_true(frame_has_rect(&btn->rect));
+    assert_true(frame_has_rect(&label->rect));
+
+    /* 处理器不存在：什么都不重绘 */
+    idle->event->click(idle);
+    assert_int_equal(damage_begin_frame(&k_viewport), 0);
+
+    js_module_cleanup();
+    g_layer_root = NULL;
+    destroy_layer(root);
+    remove(script_path);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_click_damages_touched_layers),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,216 @@
+// test_js_data_qjs.c
+// QuickJS 数据绑定：layer.data 直接转 cJSON（不经 JSON.stringify，包装对象按原始值、BigInt 抛 TypeError），
+// Table 的 appendRows / updateRow 增量更新，并对比整表重发与单行更新的耗时；
+// List 的行指针表在 appendRows / updateRow / 重设 data 后与 data 数组一致。
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "js_module.h"
+#include "quickjs.h"
+#include "layer.h"
+#include "component_registry.h"
+#include "components/table_component.h"
+#include "components/list_component.h"
+#include "cJSON.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+extern struct Layer *g_layer_root;
+
+static const char *kTestScript =
+    "var __r = {};\n"
+    "function T(name, cond) { __r[name] = cond ? 1 : 0; }\n"
+    "var t = YUI.find('grid');\n"
+    "t.data = [{ id: 1, name: 'a', skip: undefined, fn: function () {} },\n"
+    "          { id: 2, name: 'b', tags: [1, undefined, 'x'] }];\n"
+    "T('set', t.data.length === 2 && t.data[0].fn === undefined);\n"
+    "T('holes', t.data[1].tags[1] === null);\n"
+    "T('append', t.appendRows([{ id: 3, name: 'c' }, { id: 4, name: 'd' }]) === true);\n"
+    "T('update', t.updateRow(1, { id: 20, name: 'bb' }) === true);\n"
+    "T('update_range', t.updateRow(9, { id: 0 }) === false);\n"
+    "T('read', t.data.length === 4 && t.data[1].id === 20 && t.data[3].name === 'd');\n"
+    "var cyclic = {}; cyclic.self = cyclic;\n"
+    "try { t.data = [cyclic]; T('cyclic', false); } catch (e) { T('cyclic', e instanceof RangeError); }\n"
+    "T('cyclic_kept', t.data.length === 4);\n"
+    "var bad = { get name() { throw new TypeError('boom'); } };\n"
+    "try { t.appendRows([{ id: 5 }, bad]); T('append_throw', false); } catch (e) { T('append_throw', e instanceof TypeError); }\n"
+    "try { t.updateRow(0, bad); T('update_throw', false); } catch (e) { T('update_throw', e instanceof TypeError); }\n"
+    "var badArr = [1]; Object.defineProperty(badArr, 0, { get: function () { throw new TypeError('elem'); } });\n"
+    "try { t.appendRows(badArr); T('elem_throw', false); } catch (e) { T('elem_throw', e instanceof TypeError); }\n"
+    "T('throw_kept', t.data.length === 4 && t.data[0].id === 1);\n"
+    "t.data = [{ id: new Number(7), name: new String('boxed'), on: new Boolean(false) }];\n"
+    "T('boxed', t.data[0].id === 7 && t.data[0].name === 'boxed' && t.data[0].on === false);\n"
+    "try { t.data = [{ id: 10n }]; T('bigint', false); } catch (e) { T('bigint', e instanceof TypeError); }\n"
+    "try { t.appendRows([{ id: Object(1n) }]); T('bigint_boxed', false); } catch (e) { T('bigint_boxed', e instanceof TypeError); }\n"
+    "T('bigint_kept', t.data.length === 1 && t.data[0].id === 7);\n"
+    "\n"
+    "/* 1 万行：整表重发 vs 单行更新 */\n"
+    "var rows = [];\n"
+    "for (var i = 0; i < 10000; i++) rows.push({ id: i, name: 'row ' + i, price: i * 1.5 });\n"
+    "var start = Date.now();\n"
+    "for (var k = 0; k < 5; k++) t.data = rows;\n"
+    "var full = (Date.now() - start) / 5;\n"
+    "start = Date.now();\n"
+    "for (var k = 0; k < 1000; k++) t.updateRow(k, { id: k, name: 'edit', price: 0 });\n"
+    "var one = (Date.now() - start) / 1000;\n"
+    "var __t = { full: full, one: one };\n"
+    "T('big', t.data.length === 10000 && t.data[999].name === 'edit');\n";
+
+static int write_script(const char *path, const char *src)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    fwrite(src, 1, strlen(src), f);
+    fclose(f);
+    return 0;
+}
+
+static double read_number(JSContext *ctx, const char *object, const char *name)
+{
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue obj = JS_GetPropertyStr(ctx, global, object);
+    JSValue v = JS_GetPropertyStr(ctx, obj, name);
+    double val = -1;
+
+    if (JS_ToFloat64(ctx, &val, v) != 0) {
+        val = -1;
+    }
+    JS_FreeValue(ctx, v);
+    JS_FreeValue(ctx, obj);
+    JS_FreeValue(ctx, global);
+    return val;
+}
+
+static const char *kResultNames[] = {
+    "set", "holes", "append", "update", "update_range", "read",
+    "cyclic", "cyclic_kept", "append_throw", "update_throw", "elem_throw", "throw_kept",
+    "boxed", "bigint", "bigint_boxed", "bigint_kept", "big",
+    NULL,
+};
+
+static void test_table_data_binding(void **state)
+{
+    const char *script_path = "build/js_data_test_qjs.js";
+    cJSON *json = cJSON_Parse("{\"id\":\"grid\",\"type\":\"Table\",\"size\":[400,300]}");
+    Layer *grid;
+    TableComponent *table;
+    JSContext *ctx;
+    int i;
+
+    (void)state;
+    yui_component_registry_init();
+    yui_components_register_builtin();
+    assert_non_null(json);
+    grid = layer_create_from_json(json, NULL);
+    cJSON_Delete(json);
+    assert_non_null(grid);
+    g_layer_root = grid;
+
+    assert_int_equal(write_script(script_path, kTestScript), 0);
+    assert_int_equal(js_module_init(), 0);
+    assert_int_equal(js_module_load_file(script_path), 0);
+
+    ctx = (JSContext *)js_module_get_context();
+    for (i = 0; kResultNames[i]; i++) {
+        double got = read_number(ctx, "__r", kResultNames[i]);
+        if (got != 1) {
+            fail_msg("JS check '%s' = %g, want 1", kResultNames[i], got);
+        }
+    }
+
+    /* 行指针表与 data 数组保持一致 */
+    table = (TableComponent *)grid->component;
+    assert_int_equal(table->rows_count, 10000);
+    assert_ptr_equal(table->rows[999], cJSON_GetArrayItem(grid->data->json, 999));
+    assert_string_equal(cJSON_GetObjectItem(table->rows[999], "name")->valuestring, "edit");
+
+    print_message("table data (10000 rows): full %.3f ms, updateRow %.4f ms\n",
+                  read_number(ctx, "__t", "full"), read_number(ctx, "__t", "one"));
+
+    js_module_cleanup();
+    g_layer_root = NULL;
+    destroy_layer(grid);
+    remove(script_path);
+}
+
+static void test_list_row_store(void **state)
+{
+    cJSON *json = cJSON_Parse("{\"id\":\"items\",\"type\":\"List\",\"size\":[200,300],"
+                              "\"data\":[{\"name\":\"a\"},{\"name\":\"b\"}]}");
+    cJSON *rows;
+    Layer *list;
+    ListComponent *component;
+    int i;
+
+    (void)state;
+    yui_component_registry_init();
+    yui_components_register_builtin();
+    assert_non_null(json);
+    list = layer_create_from_json(json, NULL);
+    cJSON_Delete(json);
+    assert_non_null(list);
+    component = (ListComponent *)list->component;
+    assert_non_null(component);
+
+    /* JSON 里带的 data 不经 on_data_update，首次取行时建表 */
+    rows = cJSON_CreateArray();
+    for (i = 0; i < 100; i++) {
+        cJSON *row = cJSON_CreateObject();
+        cJSON_AddNumberToObject(row, "id", i);
+        cJSON_AddItemToArray(rows, row);
+    }
+    assert_int_equal(list->on_rows_append(list, rows), 1);
+    cJSON_Delete(rows);
+    assert_int_equal(component->rows_count, 102);
+    assert_int_equal(list->data->size, 102);
+    assert_ptr_equal(component->rows[0], list->data->json->child);
+    assert_ptr_equal(component->rows[101], cJSON_GetArrayItem(list->data->json, 101));
+
+    rows = cJSON_CreateObject();
+    cJSON_AddStringToObject(rows, "name", "edit");
+    assert_int_equal(list->on_row_update(list, 50, rows), 1);
+    assert_ptr_equal(component->rows[50], rows);
+    assert_ptr_equal(cJSON_GetArrayItem(list->data->json, 50), rows);
+    rows = cJSON_CreateNull();
+    assert_int_equal(list->on_row_update(list, 102, rows), 0);
+    cJSON_Delete(rows);
+
+    /* 整体替换 data 后重建 */
+    json = cJSON_Parse("[{\"name\":\"x\"}]");
+    assert_int_equal(list->on_data_update(list, json), 1);
+    assert_int_equal(component->rows_count, 1);
+    assert_ptr_equal(component->rows[0], json->child);
+
+    destroy_layer(list);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_table_data_binding),
+        cmocka_unit_test(test_list_row_store),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,183 @@
+// test_js_game_qjs.c
+// QuickJS Game 绑定：实体对象按实体缓存（同一对象、自定义属性跨帧保留），
+// 访问器直接读写 GameEntity，销毁后对象失效；Game.update(entities, dt) 批量入口
+// 每帧只调用一次并替代逐实体脚本。最后打印 2000 个脚本实体两种方式的每帧耗时。
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "js_module.h"
+#include "js_game.h"
+#include "game/game.h"
+#include "unit_util.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define BENCH_ENTITIES 2000
+#define BENCH_FRAMES 60
+
+static const char *kBindScript =
+    "var __calls = 0, __runs = 0, __later = 0, __batchCalls = 0, __batchSeen = 0;\n"
+    "function walker(e, dt) { __calls++; e.vx = 10; e.steps = (e.steps || 0) + 1; }\n"
+    "function runner(e, dt) { __runs++; }\n"
+    "function bomb(e, dt) { Game.destroy(e); }\n"
+    "var a = Game.spawn({ id: 'a', script: 'walker', transform: { x: 0, y: 0 } });\n"
+    "var b = Game.spawn({ id: 'b', script: 'bomb' });\n"
+    "var __same = (Game.find('a') === a) ? 1 : 0;\n";
+
+static const char *kBenchScript =
+    "function drift(e, dt) { e.vx = 1; e.y = e.y + dt; }\n"
+    "for (var i = 0; i < 2000; i++) Game.spawn({ script: 'drift', transform: { x: i, y: 0 } });\n";
+
+static int write_script(const char *path, const char *src)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    fwrite(src, 1, strlen(src), f);
+    fclose(f);
+    return 0;
+}
+
+/* 执行表达式并取整数结果；异常返回 -9999 */
+static int eval_int(const char *expr)
+{
+    JSContext *ctx = (JSContext *)js_module_get_context();
+    JSValue v = JS_Eval(ctx, expr, strlen(expr), "<test>", JS_EVAL_TYPE_GLOBAL);
+    int val = -9999;
+    if (JS_IsException(v)) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return val;
+    }
+    JS_ToInt32(ctx, &val, v);
+    JS_FreeValue(ctx, v);
+    return val;
+}
+
+static void test_entity_objects_persist(void **state)
+{
+    char script_path[512];
+    int i;
+
+    (void)state;
+    unit_temp_path(script_path, sizeof(script_path), "js_game_test_qjs.js");
+    assert_int_equal(write_script(script_path, kBindScript), 0);
+    assert_int_equal(js_module_init(), 0);
+    assert_int_equal(js_module_load_file(script_path), 0);
+    assert_int_equal(eval_int("__same"), 1);
+
+    for (i = 0; i < 4; i++) {
+        game_update(0.5f);
+    }
+    assert_int_equal(eval_int("__calls"), 4);
+    /* 自定义属性保留说明每帧拿到的是同一个对象 */
+    assert_int_equal(eval_int("a.steps"), 4);
+    assert_int_equal(eval_int("Math.round(a.x)"), 20);
+    assert_int_equal(eval_int("JSON.stringify(a).indexOf('\"x\":20') >= 0 ? 1 : 0"), 1);
+    /* 脚本里销毁自己：旧对象失效，不再指向被复用的槽 */
+    assert_int_equal(eval_int("b.alive ? 1 : 0"), 0);
+    assert_int_equal(eval_int("b.x === undefined ? 1 : 0"), 1);
+    assert_int_equal(eval_int("Game.find('b') === null ? 1 : 0"), 1);
+
+    /* 写入直接落到 GameEntity */
+    assert_int_equal(eval_int("a.x = 100; 0"), 0);
+    assert_non_null(game_find("a"));
+    assert_true(GAME_X(game_find("a")) == 100.0f);
+
+    /* 换脚本后不再调用旧函数；新脚本的全局函数稍后才定义时按需补查 */
+    game_entity_set_script(game_find("a"), "runner");
+    game_update(0.5f);
+    assert_int_equal(eval_int("__calls"), 4);
+    assert_int_equal(eval_int("__runs"), 1);
+    game_entity_set_script(game_find("a"), "later");
+    game_update(0.5f);
+    assert_int_equal(eval_int("__runs"), 1);
+    assert_int_equal(eval_int("function later(e, dt) { __later++; } 0"), 0);
+    game_update(0.5f);
+    assert_int_equal(eval_int("__later"), 1);
+    assert_int_equal(eval_int("Math.round(a.x)"), 115);
+
+    /* 定义 Game.update 后每帧一次批量调用，逐实体脚本不再执行 */
+    assert_int_equal(eval_int("Game.update = function (list, dt) {"
+                              " __batchCalls++; __batchSeen = list.length;"
+                              " for (var i = 0; i < list.length; i++) list[i].vx = -10; }; 0"), 0);
+    game_update(0.5f);
+    game_update(0.5f);
+    assert_int_equal(eval_int("__batchCalls"), 2);
+    assert_int_equal(eval_int("__batchSeen"), 1);
+    assert_int_equal(eval_int("__calls"), 4);
+    assert_int_equal(eval_int("Math.round(a.x)"), 105);
+
+    assert_int_equal(eval_int("Game.clearScene(); a.alive ? 1 : 0"), 0);
+
+    js_module_cleanup();
+    remove(script_path);
+}
+
+static double bench_frames(void)
+{
+    double t0 = unit_now_ms();
+    int i;
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        game_update(1.0f / 60.0f);
+    }
+    return (unit_now_ms() - t0) / BENCH_FRAMES;
+}
+
+static void test_bench_scripted_entities(void **state)
+{
+    char script_path[512];
+    double per_entity_ms;
+    double batch_ms;
+    GameEntity *first;
+
+    (void)state;
+    unit_temp_path(script_path, sizeof(script_path), "js_game_bench_qjs.js");
+    assert_int_equal(write_script(script_path, kBenchScript), 0);
+    assert_int_equal(js_module_init(), 0);
+    assert_int_equal(js_module_load_file(script_path), 0);
+
+    per_entity_ms = bench_frames();
+    assert_int_equal(eval_int("Game.update = function (list, dt) {"
+                              " for (var i = 0; i < list.length; i++) drift(list[i], dt); }; 0"), 0);
+    batch_ms = bench_frames();
+    printf("js game bench: %d scripted entities, per-entity %.3f ms/frame, Game.update %.3f ms/frame\n",
+           BENCH_ENTITIES, per_entity_ms, batch_ms);
+    /* 两种方式推进的是同一批实体 */
+    assert_int_equal(eval_int("Game.findAllByTag('').length"), BENCH_ENTITIES);
+    first = game_find_by_tag("");
+    assert_non_null(first);
+    assert_int_equal((int)(GAME_Y(first) * 60.0f + 0.5f), BENCH_FRAMES * 2);
+
+    js_module_cleanup();
+    remove(script_path);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_entity_objects_persist),
+        cmocka_unit_test(test_bench_scripted_entities),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
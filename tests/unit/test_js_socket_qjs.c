@@ -0,0 +1,209 @@
+// test_js_socket_qjs.c
+// QuickJS Socket.watch 就绪回调：本机回环上 accept、onWritable 分批发送、
+// onReadable 复用同一个 ArrayBuffer、对端关闭触发 onClose，以及回调中取消关注。
+// 主循环由 js_socket_reactor_run() 驱动（测试里没有后端唤醒，按 1ms 轮询）。
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "js_module.h"
+#include "js_socket.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+static const char *kStreamScript =
+    "var __r = {}, __done = 0;\n"
+    "function T(name, cond) { __r[name] = cond ? 1 : 0; }\n"
+    "var TOTAL = 1 << 20;\n"
+    "var srv = Socket.socket(Socket.TCP);\n"
+    "T('bind', Socket.bind(srv, '127.0.0.1', 0) === 0);\n"
+    "T('listen', Socket.listen(srv, 4) === 0);\n"
+    "var port = Socket.getsockname(srv).port;\n"
+    "var conn = -1, received = 0, chunks = 0, firstBuf = null, sameBuf = true, ordered = true;\n"
+    "Socket.watch(srv, { recv: false, onReadable: function () {\n"
+    "  conn = Socket.accept(srv);\n"
+    "  Socket.watch(conn, {\n"
+    "    bufferSize: 8192,\n"
+    "    onReadable: function (buf, n) {\n"
+    "      if (!firstBuf) firstBuf = buf; else if (buf !== firstBuf) sameBuf = false;\n"
+    "      var bytes = new Uint8Array(buf, 0, n);\n"
+    "      for (var i = 0; i < n; i += 997) if (bytes[i] !== ((received + i) & 255)) ordered = false;\n"
+    "      received += n; chunks++;\n"
+    "    },\n"
+    "    onClose: function (err) {\n"
+    "      T('eof', err === 0); Socket.close(conn); Socket.close(srv);\n"
+    "      T('received', received === TOTAL); T('same_buffer', sameBuf && chunks > 1);\n"
+    "      T('ordered', ordered); __done = 1;\n"
+    "    }\n"
+    "  });\n"
+    "} });\n"
+    "var cli = Socket.socket(Socket.TCP);\n"
+    "T('connect', Socket.connect(cli, '127.0.0.1', port, 0) === 0);\n"
+    "var payload = new Uint8Array(65536);\n"
+    "var sent = 0, writable = 0;\n"
+    "function pump() {\n"
+    "  writable++;\n"
+    "  while (sent < TOTAL) {\n"
+    "    var start = sent & 255;\n"
+    "    for (var i = 0; i < payload.length; i++) payload[i] = (start + i) & 255;\n"
+    "    var n = Socket.send(cli, new Uint8Array(payload.buffer, 0, Math.min(payload.length, TOTAL - sent)), 0);\n"
+    "    if (n <= 0) { Socket.wantWrite(cli); return; }\n"
+    "    sent += n;\n"
+    "  }\n"
+    "  T('writable', writable >= 1); Socket.close(cli);\n"
+    "}\n"
+    "Socket.watch(cli, { onWritable: pump });\n";
+
+static const char *kUnwatchScript =
+    "var __r = {}, __done = 0;\n"
+    "function T(name, cond) { __r[name] = cond ? 1 : 0; }\n"
+    "function tcpPair() {\n"
+    "  var srv = Socket.socket(Socket.TCP);\n"
+    "  Socket.bind(srv, '127.0.0.1', 0); Socket.listen(srv, 1);\n"
+    "  var cli = Socket.socket(Socket.TCP);\n"
+    "  Socket.connect(cli, '127.0.0.1', Socket.getsockname(srv).port, 0);\n"
+    "  var peer = Socket.accept(srv); Socket.close(srv);\n"
+    "  return [cli, peer];\n"
+    "}\n"
+    "var pair = tcpPair();\n"
+    "var a = pair[0], b = pair[1], calls = 0, raw = new Uint8Array(16);\n"
+    "Socket.watch(a, { onReadable: function (buf, n) {\n"
+    "  calls++; Socket.unwatch(a);\n"
+    "  Socket.watch(b, { recv: false, onReadable: function () {\n"
+    "    var got = Socket.recvInto(b, raw, 2);\n"
+    "    T('recv_into', got === 3 && raw[2] === 120 && raw[4] === 122);\n"
+    "    Socket.close(b); Socket.close(a); __done = 1;\n"
+    "  } });\n"
+    "  Socket.send(a, 'xyz', 0);\n"
+    "} });\n"
+    "Socket.send(b, 'hello', 0);\n"
+    "Socket.send(b, 'again', 0);\n";
+
+static int write_script(const char *path, const char *src)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    fwrite(src, 1, strlen(src), f);
+    fclose(f);
+    return 0;
+}
+
+static int read_global_int(JSContext *ctx, const char *object, const char *name)
+{
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue obj = object ? JS_GetPropertyStr(ctx, global, object) : JS_DupValue(ctx, global);
+    JSValue v = JS_GetPropertyStr(ctx, obj, name);
+    int val = -1;
+
+    if (JS_ToInt32(ctx, &val, v) != 0) {
+        val = -1;
+    }
+    JS_FreeValue(ctx, v);
+    JS_FreeValue(ctx, obj);
+    JS_FreeValue(ctx, global);
+    return val;
+}
+
+/* 驱动反应器直到脚本置 __done 或超时（5s） */
+static void run_until_done(JSContext *ctx)
+{
+    for (int i = 0; i < 5000 && read_global_int(ctx, NULL, "__done") != 1; i++) {
+        if (js_socket_reactor_run(ctx) == 0) {
+#ifdef _WIN32
+            Sleep(1);
+#else
+            usleep(1000);
+#endif
+        }
+    }
+    assert_int_equal(read_global_int(ctx, NULL, "__done"), 1);
+}
+
+static void check_results(JSContext *ctx, const char **names)
+{
+    for (int i = 0; names[i]; i++) {
+        int got = read_global_int(ctx, "__r", names[i]);
+        if (got != 1) {
+            fail_msg("JS check '%s' = %d, want 1", names[i], got);
+        }
+    }
+}
+
+static void test_socket_stream(void **state)
+{
+    const char *script_path = "build/js_socket_test_qjs.js";
+    const char *names[] = {
+        "bind", "listen", "connect", "writable", "eof", "received", "same_buffer", "ordered", NULL,
+    };
+    JSContext *ctx;
+
+    (void)state;
+    assert_int_equal(write_script(script_path, kStreamScript), 0);
+    assert_int_equal(js_module_init(), 0);
+    assert_int_equal(js_module_load_file(script_path), 0);
+    ctx = (JSContext *)js_module_get_context();
+
+    run_until_done(ctx);
+    check_results(ctx, names);
+    /* 所有 fd 都已关闭并取消关注 */
+    assert_int_equal(js_socket_reactor_deadline(), -1);
+
+    js_module_cleanup();
+    remove(script_path);
+}
+
+static void test_socket_unwatch_in_callback(void **state)
+{
+    const char *script_path = "build/js_socket_test2_qjs.js";
+    const char *names[] = { "recv_into", NULL };
+    JSContext *ctx;
+
+    (void)state;
+    assert_int_equal(write_script(script_path, kUnwatchScript), 0);
+    assert_int_equal(js_module_init(), 0);
+    assert_int_equal(js_module_load_file(script_path), 0);
+    ctx = (JSContext *)js_module_get_context();
+
+    run_until_done(ctx);
+    check_results(ctx, names);
+    /* 第一次回调里就取消了关注，'again' 不再分派 */
+    assert_int_equal(read_global_int(ctx, NULL, "calls"), 1);
+
+    js_module_cleanup();
+    remove(script_path);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_socket_stream),
+        cmocka_unit_test(test_socket_unwatch_in_callback),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -1,6 +1,7 @@
 // test_js_timer_qjs.c
 // QuickJS setTimeout 驱动测试：
-// 验证 js_timer_run() 能驱动 setTimeout 回调执行。
+// 验证 js_timer_run() 能驱动 setTimeout 回调执行；
+// 以及 setInterval、requestAnimationFrame、超过 64 个定时器和 js_timer_next_deadline。
 // 与 mquickjs 版 test_js_timer_mqjs.c 对应（qjs 用 js_timer_run 驱动）。
 #include <stdarg.h>
 #include <stddef.h>
@@ -39,6 +40,28 @@ static const char *kTestScript =
     "var __timerFired2 = 7;\n"
     "setTimeout(function(){ __timerFired2 = 77; }, 1000);\n";
 
+static const char *kIntervalScript =
+    "var __ticks = 0, __many = 0, __frames = 0, __frameTsOk = 0, __order = '';\n"
+    "var iv = setInterval(function(){ if (++__ticks === 3) clearInterval(iv); }, 5);\n"
+    "for (var i = 0; i < 200; i++) setTimeout(function(){ __many++; }, i % 7);\n"
+    "var dead = setTimeout(function(){ __many += 1000; }, 0);\n"
+    "clearTimeout(dead);\n"
+    "setTimeout(function(){ __order += 'a'; }, 0);\n"
+    "setTimeout(function(){ __order += 'b'; }, 0);\n"
+    "function frame(ts){ __frameTsOk = typeof ts === 'number' && ts > 0 ? 1 : 0; if (++__frames < 3) requestAnimationFrame(frame); }\n"
+    "requestAnimationFrame(frame);\n"
+    "var gone = requestAnimationFrame(function(){ __frames += 100; });\n"
+    "cancelAnimationFrame(gone);\n";
+
+static void sleep_ms(int ms)
+{
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    usleep(ms * 1000);
+#endif
+}
+
 static int write_script(const char *path, const char *src)
 {
     FILE *f = fopen(path, "wb");
@@ -138,11 +161,62 @@ static void test_settimeout_respects_delay(void **state)
     remove(script_path);
 }
 
+static void test_interval_and_frames(void **state)
+{
+    const char *script_path = "build/js_timer_test3_qjs.js";
+    JSContext *ctx;
+    int i;
+
+    (void)state;
+    assert_int_equal(write_script(script_path, kIntervalScript), 0);
+    assert_int_equal(js_module_init(), 0);
+    assert_int_equal(js_module_load_file(script_path), 0);
+    ctx = (JSContext *)js_module_get_context();
+
+    /* 旧实现上限 64 个，这里 200 + interval + 2 个 */
+    assert_int_equal(js_timer_count(), 203);
+    /* 有 0ms 定时器和待执行的 rAF：应立即唤醒 */
+    assert_int_equal(js_timer_next_deadline(), 0);
+
+    for (i = 0; i < 200; i++) {
+        js_timer_run(ctx);
+        if (read_global_int(ctx, "__ticks") == 3 && read_global_int(ctx, "__frames") == 3 &&
+            read_global_int(ctx, "__many") == 200) {
+            break;
+        }
+        sleep_ms(5);
+    }
+    assert_int_equal(read_global_int(ctx, "__many"), 200);
+    assert_int_equal(read_global_int(ctx, "__ticks"), 3);
+    assert_int_equal(read_global_int(ctx, "__frames"), 3);
+    /* 时间戳是毫秒数（double），在 JS 侧判断，避免经 int32 截断 */
+    assert_int_equal(read_global_int(ctx, "__frameTsOk"), 1);
+
+    /* 同一到期时间按创建顺序触发 */
+    {
+        JSValue global = JS_GetGlobalObject(ctx);
+        JSValue v = JS_GetPropertyStr(ctx, global, "__order");
+        const char *order = JS_ToCString(ctx, v);
+        assert_string_equal(order, "ab");
+        JS_FreeCString(ctx, order);
+        JS_FreeValue(ctx, v);
+        JS_FreeValue(ctx, global);
+    }
+
+    /* interval 已清除、rAF 不再请求：没有待办 */
+    assert_int_equal(js_timer_count(), 0);
+    assert_int_equal(js_timer_next_deadline(), -1);
+
+    js_module_cleanup();
+    remove(script_path);
+}
+
 int main(int argc, char **argv)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_settimeout_fires),
         cmocka_unit_test(test_settimeout_respects_delay),
+        cmocka_unit_test(test_interval_and_frames),
     };
     (void)argc;
     (void)argv;
@@ -0,0 +1,152 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include "ytype.h"
+#include "layer.h"
+#include "layer_index.h"
+#include "layer_update.h"
+#include "cJSON.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+/* 未走索引的原始深度优先查找，用来比对结果 */
+static Layer *scan_by_id(Layer *root, const char *id)
+{
+    int i;
+    if (strcmp(root->id, id) == 0) {
+        return root;
+    }
+    for (i = 0; i < root->child_count; i++) {
+        Layer *found = scan_by_id(root->children[i], id);
+        if (found) {
+            return found;
+        }
+    }
+    return root->sub ? scan_by_id(root->sub, id) : NULL;
+}
+
+static Layer *load(const char *text)
+{
+    cJSON *json = parse_json_string((char *)text);
+    Layer *layer;
+    assert_non_null(json);
+    layer = layer_create_from_json(json, NULL);
+    cJSON_Delete(json);
+    assert_non_null(layer);
+    return layer;
+}
+
+static void test_duplicate_ids_follow_dfs_order(void **state)
+{
+    Layer *root = load(
+        "{\"id\":\"root\",\"children\":["
+        "  {\"id\":\"a\",\"children\":[{\"id\":\"dup\"},{\"id\":\"x\"}]},"
+        "  {\"id\":\"dup\",\"children\":[{\"id\":\"dup\"}]},"
+        "  {\"id\":\"b\"}]}");
+    Layer *other = load("{\"id\":\"root\",\"children\":[{\"id\":\"dup\"}]}");
+
+    (void)state;
+    /* 与遍历结果一致：先序中最先出现的，且限于 root 子树 */
+    assert_ptr_equal(find_layer_by_id(root, "dup"), root->children[0]->children[0]);
+    assert_ptr_equal(find_layer_by_id(root->children[1], "dup"), root->children[1]);
+    assert_ptr_equal(find_layer_by_id(other, "dup"), other->children[0]);
+    assert_ptr_equal(find_layer_by_id(root, "root"), root);
+    assert_ptr_equal(find_layer_by_id(root->children[0], "b"), NULL);
+    assert_ptr_equal(find_layer_by_id(root, "missing"), NULL);
+
+    /* 改 id 与删除节点后索引同步 */
+    layer_set_id(root->children[0]->children[0], "renamed");
+    assert_ptr_equal(find_layer_by_id(root, "dup"), root->children[1]);
+    assert_ptr_equal(find_layer_by_id(root, "renamed"), root->children[0]->children[0]);
+    assert_int_equal(yui_remove_child(root, "a"), 0);
+    assert_ptr_equal(find_layer_by_id(root, "renamed"), NULL);
+    assert_ptr_equal(find_layer_by_id(root, "b"), root->children[1]);
+
+    destroy_layer(other);
+    assert_ptr_equal(find_layer_by_id(root, "dup"), root->children[0]);
+    destroy_layer(root);
+}
+
+static void test_index_matches_scan(void **state)
+{
+    const int rows = 3000;
+    const int rounds = 20;
+    cJSON *json = cJSON_CreateObject();
+    cJSON *children = cJSON_AddArrayToObject(json, "children");
+    clock_t scan_ticks = 0;
+    clock_t index_ticks = 0;
+    Layer *root;
+    int i;
+    int r;
+
+    (void)state;
+    cJSON_AddStringToObject(json, "id", "root");
+    for (i = 0; i < rows; i++) {
+        char id[32];
+        cJSON *row = cJSON_CreateObject();
+        cJSON *cell = cJSON_CreateObject();
+        snprintf(id, sizeof(id), "row%d", i);
+        cJSON_AddStringToObject(row, "id", id);
+        snprintf(id, sizeof(id), "cell%d", i);
+        cJSON_AddStringToObject(cell, "id", id);
+        cJSON_AddItemToArray(cJSON_AddArrayToObject(row, "children"), cell);
+        cJSON_AddItemToArray(children, row);
+    }
+    root = layer_create_from_json(json, NULL);
+    cJSON_Delete(json);
+    assert_non_null(root);
+
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < rows; i += 97) {
+            char id[32];
+            clock_t start;
+            Layer *expected;
+            Layer *found;
+
+            snprintf(id, sizeof(id), "cell%d", i);
+            start = clock();
+            expected = scan_by_id(root, id);
+            scan_ticks += clock() - start;
+            start = clock();
+            found = find_layer_by_id(root, id);
+            index_ticks += clock() - start;
+            assert_non_null(expected);
+            assert_ptr_equal(found, expected);
+        }
+    }
+    print_message("find_layer_by_id (%d layers): scan %.3f ms, index %.3f ms\n",
+                  1 + rows * 2,
+                  scan_ticks * 1000.0 / CLOCKS_PER_SEC,
+                  index_ticks * 1000.0 / CLOCKS_PER_SEC);
+    destroy_layer(root);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_duplicate_ids_follow_dfs_order),
+        cmocka_unit_test(test_index_matches_scan),
+    };
+
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,207 @@
+// test_perf_trace.c
+// perf 模块：按 Layer 指针散列的图层槽在上千图层时不丢统计、销毁后槽被回收；
+// 主循环环形缓冲记录阶段，百分位有序，导出的 trace 是合法的 Chrome trace-event JSON。
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "ytype.h"
+#include "layer.h"
+#include "perf/perf.h"
+#include "cJSON.h"
+#include "unit_util.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define LAYER_COUNT 3000
+
+static char *read_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    char *buf;
+    long size;
+
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = (char *)malloc((size_t)size + 1);
+    if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        buf = NULL;
+    }
+    if (buf) {
+        buf[size] = '\0';
+    }
+    fclose(f);
+    return buf;
+}
+
+static void test_slots_scale_past_old_limit(void **state)
+{
+    Layer *layers = (Layer *)calloc(LAYER_COUNT, sizeof(Layer));
+    PerfLayerStats *stats = (PerfLayerStats *)calloc(LAYER_COUNT, sizeof(PerfLayerStats));
+    int n;
+
+    (void)state;
+    assert_non_null(layers);
+    assert_non_null(stats);
+    perf_enable(1);
+    perf_reset();
+
+    perf_frame_begin();
+    for (int i = 0; i < LAYER_COUNT; i++) {
+        perf_layer_tree_enter(&layers[i]);
+        perf_layer_add_self_ns(&layers[i], (uint64_t)(i + 1) * 1000);
+    }
+    perf_frame_end();
+
+    assert_int_equal(perf_get_frame_stats()->layers_rendered, LAYER_COUNT);
+    assert_int_equal(perf_get_frame_stats()->layers_untracked, 0);
+    n = perf_get_layer_stats(stats, LAYER_COUNT, PERF_SORT_TIME);
+    assert_int_equal(n, LAYER_COUNT);
+    assert_true(stats[0].render_ns == (uint64_t)LAYER_COUNT * 1000);
+
+    /* 销毁一半图层：下一帧开始时压缩，剩余图层仍能按指针找到原来的槽 */
+    for (int i = 0; i < LAYER_COUNT; i += 2) {
+        perf_layer_destroyed(&layers[i]);
+    }
+    perf_frame_begin();
+    for (int i = 1; i < LAYER_COUNT; i += 2) {
+        perf_layer_tree_enter(&layers[i]);
+    }
+    perf_frame_end();
+    n = perf_get_layer_stats(stats, LAYER_COUNT, PERF_SORT_COUNT);
+    assert_int_equal(n, LAYER_COUNT / 2);
+    for (int i = 0; i < n; i++) {
+        assert_int_equal(stats[i].render_count, 1);
+        assert_int_equal(stats[i].total_frames_seen, 2);
+    }
+
+    perf_reset();
+    perf_enable(0);
+    free(stats);
+    free(layers);
+}
+
+static void test_loop_ring_and_trace(void **state)
+{
+    char path[512];
+    PerfPercentiles loop;
+    PerfPercentiles layout;
+    cJSON *json;
+    cJSON *events;
+    cJSON *event;
+    char *text;
+    int loops = 0;
+    int layouts = 0;
+    double layout_end = 0.0;
+
+    (void)state;
+    unit_temp_path(path, sizeof(path), "perf_trace_test.json");
+    perf_enable(1);
+    perf_reset();
+    assert_int_equal(perf_get_percentiles(PERF_SERIES_LOOP, &loop), -1);
+
+    for (int i = 0; i < 1500; i++) {
+        perf_frame_set_wake(PERF_WAKE_TIMER, 4);
+        perf_loop_begin();
+        perf_loop_begin();
+        perf_phase_begin(PERF_PHASE_EVENTS);
+        perf_phase_end(PERF_PHASE_EVENTS);
+        if (i % 3 == 0) {
+            /* 嵌套进入同一阶段只按最外层计一次 */
+            perf_phase_begin(PERF_PHASE_LAYOUT);
+            perf_phase_begin(PERF_PHASE_LAYOUT);
+            perf_phase_end(PERF_PHASE_LAYOUT);
+            perf_phase_end(PERF_PHASE_LAYOUT);
+            /* 再次进入是另一段，trace 里单独成一个事件 */
+            perf_phase_begin(PERF_PHASE_LAYOUT);
+            perf_phase_end(PERF_PHASE_LAYOUT);
+        }
+        perf_frame_begin();
+        perf_render_tree_begin();
+        perf_render_tree_end();
+        perf_frame_end();
+        perf_phase_begin(PERF_PHASE_PRESENT);
+        perf_loop_end();
+    }
+    /* 未开始的一轮里阶段调用被忽略 */
+    perf_phase_begin(PERF_PHASE_UPDATE);
+    perf_phase_end(PERF_PHASE_UPDATE);
+
+    assert_int_equal(perf_loop_record_count(), 1024);
+    assert_int_equal(perf_get_percentiles(PERF_SERIES_LOOP, &loop), 0);
+    assert_int_equal(loop.count, 1500);
+    assert_true(loop.p50_ms <= loop.p95_ms);
+    assert_true(loop.p95_ms <= loop.p99_ms);
+    assert_true(loop.p99_ms <= loop.max_ms);
+    assert_int_equal(perf_get_percentiles(PERF_PHASE_LAYOUT, &layout), 0);
+    assert_int_equal(layout.count, 500);
+    assert_int_equal(perf_get_percentiles(PERF_PHASE_UPDATE, &layout), -1);
+    assert_string_equal(perf_phase_name(PERF_SERIES_LOOP), "loop");
+
+    assert_int_equal(perf_export_trace(path), 1024);
+    text = read_file(path);
+    assert_non_null(text);
+    json = cJSON_Parse(text);
+    free(text);
+    assert_non_null(json);
+    events = cJSON_GetObjectItem(json, "traceEvents");
+    assert_true(cJSON_IsArray(events));
+    cJSON_ArrayForEach(event, events) {
+        const char *name = cJSON_GetObjectItem(event, "name")->valuestring;
+        if (strcmp(name, "loop") == 0) {
+            cJSON *args = cJSON_GetObjectItem(event, "args");
+            assert_int_equal(cJSON_GetObjectItem(args, "rendered")->valueint, 1);
+            loops++;
+        } else if (strcmp(name, "layout") == 0) {
+            double ts = cJSON_GetObjectItem(event, "ts")->valuedouble;
+            /* 同一轮的两段按先后排列、互不重叠（输出保留到 0.001 微秒） */
+            if (layouts % 2 == 1) {
+                assert_true(ts + 0.002 >= layout_end);
+            }
+            layout_end = ts + cJSON_GetObjectItem(event, "dur")->valuedouble;
+            layouts++;
+        }
+    }
+    assert_int_equal(loops, 1024);
+    /* 环里保留的是第 476..1499 轮，其中 i % 3 == 0 的有 341 轮，每轮两段 */
+    assert_int_equal(layouts, 2 * 341);
+    cJSON_Delete(json);
+    remove(path);
+
+    perf_reset();
+    assert_int_equal(perf_loop_record_count(), 0);
+    perf_enable(0);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_slots_scale_past_old_limit),
+        cmocka_unit_test(test_loop_ring_and_trace),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
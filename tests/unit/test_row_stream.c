@@ -0,0 +1,245 @@
+// test_row_stream.c
+// 后台行流：用本地替身数据源代替数据库服务器，验证首批行在查询结束前就进入 Table、
+// 全部行按序送达、interrupt 打断阻塞中的取行，以及 open 失败的错误信息。
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "ytype.h"
+#include "layer.h"
+#include "row_stream.h"
+#include "component_registry.h"
+#include "components/table_component.h"
+#include "cJSON.h"
+
+#include <pthread.h>
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#define sleep_ms(ms) Sleep(ms)
+#else
+#include <unistd.h>
+#define sleep_ms(ms) usleep((ms) * 1000)
+#endif
+
+/* 替身数据源：产出 total 行，取到第 gate 行时阻塞，直到测试放行或被 interrupt */
+typedef struct {
+    int total;
+    int gate;
+    int next;
+    int fail_open;
+    int released;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int open_gate;
+    int interrupted;
+} FakeSource;
+
+static int fake_open(void *ctx, char *error, int error_size)
+{
+    FakeSource *src = (FakeSource *)ctx;
+    if (src->fail_open) {
+        snprintf(error, (size_t)error_size, "Access denied");
+        return -1;
+    }
+    return 0;
+}
+
+static int fake_fetch(void *ctx, cJSON **row, char *error, int error_size)
+{
+    FakeSource *src = (FakeSource *)ctx;
+
+    if (src->next == src->gate) {
+        pthread_mutex_lock(&src->lock);
+        while (!src->open_gate && !src->interrupted) {
+            pthread_cond_wait(&src->cond, &src->lock);
+        }
+        pthread_mutex_unlock(&src->lock);
+        if (src->interrupted) {
+            snprintf(error, (size_t)error_size, "Query execution was interrupted");
+            return -1;
+        }
+    }
+    if (src->next >= src->total) {
+        return 0;
+    }
+    *row = cJSON_CreateObject();
+    cJSON_AddNumberToObject(*row, "id", src->next);
+    cJSON_AddStringToObject(*row, "name", "row");
+    src->next++;
+    return 1;
+}
+
+static void fake_close(void *ctx)
+{
+    (void)ctx;
+}
+
+static void fake_interrupt(void *ctx)
+{
+    FakeSource *src = (FakeSource *)ctx;
+    pthread_mutex_lock(&src->lock);
+    src->interrupted = 1;
+    pthread_cond_broadcast(&src->cond);
+    pthread_mutex_unlock(&src->lock);
+}
+
+static void fake_release(void *ctx)
+{
+    ((FakeSource *)ctx)->released = 1;
+}
+
+static const RowStreamSource kFakeSource = {
+    fake_open, fake_fetch, fake_close, fake_interrupt, fake_release,
+};
+
+static void fake_init(FakeSource *src, int total, int gate)
+{
+    memset(src, 0, sizeof(*src));
+    src->total = total;
+    src->gate = gate;
+    pthread_mutex_init(&src->lock, NULL);
+    pthread_cond_init(&src->cond, NULL);
+}
+
+static void fake_open_gate(FakeSource *src)
+{
+    pthread_mutex_lock(&src->lock);
+    src->open_gate = 1;
+    pthread_cond_broadcast(&src->cond);
+    pthread_mutex_unlock(&src->lock);
+}
+
+/* 驱动主循环 tick，直到状态为 want 且已送达至少 min_rows 行（5s 超时） */
+static int tick_until(int id, int want, int min_rows)
+{
+    int rows = 0;
+    int state = -1;
+    for (int i = 0; i < 5000; i++) {
+        row_stream_tick();
+        state = row_stream_status(id, &rows, NULL, 0);
+        if (state == want && rows >= min_rows) {
+            break;
+        }
+        sleep_ms(1);
+    }
+    assert_int_equal(state, want);
+    return rows;
+}
+
+static Layer *create_table(void)
+{
+    cJSON *json = cJSON_Parse("{\"id\":\"result\",\"type\":\"Table\",\"autoColumns\":true,\"size\":[400,300]}");
+    Layer *table;
+
+    yui_component_registry_init();
+    yui_components_register_builtin();
+    assert_non_null(json);
+    table = layer_create_from_json(json, NULL);
+    cJSON_Delete(json);
+    assert_non_null(table);
+    return table;
+}
+
+static void test_first_rows_before_done(void **state)
+{
+    Layer *layer = create_table();
+    TableComponent *table = (TableComponent *)layer->component;
+    FakeSource src;
+    int id;
+    int rows;
+
+    (void)state;
+    fake_init(&src, 20000, 100);
+    id = row_stream_start(layer, &kFakeSource, &src, 500);
+    assert_true(id > 0);
+
+    /* 替身在第 100 行卡住，查询未结束：首批之后攒着的行到期也由主循环取走 */
+    rows = tick_until(id, ROW_STREAM_RUNNING, 100);
+    assert_int_equal(rows, 100);
+    assert_int_equal(table->rows_count, 100);
+    assert_true(row_stream_deadline() < 0);
+    assert_true(table->column_count >= 2);
+
+    fake_open_gate(&src);
+    rows = tick_until(id, ROW_STREAM_DONE, 20000);
+    assert_int_equal(rows, 20000);
+    assert_int_equal(table->rows_count, 20000);
+    for (int i = 0; i < 20000; i += 1999) {
+        assert_int_equal(cJSON_GetObjectItem(table->rows[i], "id")->valueint, i);
+    }
+    assert_int_equal(row_stream_deadline(), -1);
+    assert_int_equal(src.released, 1);
+
+    row_stream_close(id);
+    assert_int_equal(row_stream_status(id, NULL, NULL, 0), -1);
+    destroy_layer(layer);
+}
+
+static void test_cancel_interrupts_fetch(void **state)
+{
+    Layer *layer = create_table();
+    FakeSource src;
+    int id;
+
+    (void)state;
+    fake_init(&src, 1000, 10);
+    id = row_stream_start(layer, &kFakeSource, &src, 0);
+    assert_true(id > 0);
+    tick_until(id, ROW_STREAM_RUNNING, 10);
+
+    /* 取行阻塞在“服务器”上，取消时由 interrupt 打断 */
+    assert_int_equal(row_stream_cancel(id), 0);
+    assert_int_equal(tick_until(id, ROW_STREAM_CANCELLED, 0), 10);
+    assert_int_equal(src.interrupted, 1);
+    assert_int_equal(src.released, 1);
+
+    /* 图层销毁后才关闭记录也不会访问悬空指针 */
+    destroy_layer(layer);
+    row_stream_tick();
+    row_stream_close(id);
+}
+
+static void test_open_error(void **state)
+{
+    FakeSource src;
+    char error[64];
+    int id;
+
+    (void)state;
+    fake_init(&src, 10, -1);
+    src.fail_open = 1;
+    id = row_stream_start(NULL, &kFakeSource, &src, 0);
+    assert_true(id > 0);
+    tick_until(id, ROW_STREAM_ERROR, 0);
+    assert_int_equal(row_stream_status(id, NULL, error, (int)sizeof(error)), ROW_STREAM_ERROR);
+    assert_string_equal(error, "Access denied");
+    row_stream_shutdown();
+    assert_int_equal(src.released, 1);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_first_rows_before_done),
+        cmocka_unit_test(test_cancel_interrupts_fetch),
+        cmocka_unit_test(test_open_error),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
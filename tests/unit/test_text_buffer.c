@@ -0,0 +1,174 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "components/text_buffer.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+static char *buffer_flat(const TextBuffer *buffer)
+{
+    int len = text_buffer_length(buffer);
+    char *out = malloc((size_t)len + 1);
+    assert_non_null(out);
+    assert_int_equal(text_buffer_copy(buffer, 0, len, out), len);
+    out[len] = '\0';
+    return out;
+}
+
+static void assert_buffer_equals(const TextBuffer *buffer, const char *expected)
+{
+    char *flat = buffer_flat(buffer);
+    assert_string_equal(flat, expected);
+    free(flat);
+}
+
+static void test_text_buffer_insert_delete(void **state)
+{
+    TextBuffer buffer;
+
+    (void)state;
+    text_buffer_init(&buffer, "hello world");
+    assert_int_equal(text_buffer_length(&buffer), 11);
+
+    assert_int_equal(text_buffer_insert(&buffer, 5, ",", 1), 0);
+    assert_buffer_equals(&buffer, "hello, world");
+    /* 连续输入合并到同一片段 */
+    assert_int_equal(text_buffer_insert(&buffer, 6, " big", 4), 0);
+    assert_buffer_equals(&buffer, "hello, big world");
+    assert_int_equal(text_buffer_insert(&buffer, 0, ">", 1), 0);
+    assert_int_equal(text_buffer_insert(&buffer, text_buffer_length(&buffer), "!", 1), 0);
+    assert_buffer_equals(&buffer, ">hello, big world!");
+
+    assert_int_equal(text_buffer_delete(&buffer, 7, 4), 0);
+    assert_buffer_equals(&buffer, ">hello, world!");
+    assert_int_equal(text_buffer_delete(&buffer, 0, 100), 0);
+    assert_int_equal(text_buffer_length(&buffer), 0);
+
+    assert_int_equal(text_buffer_insert(&buffer, 1, "x", 1), -1);
+    assert_int_equal(text_buffer_byte_at(&buffer, 0), '\0');
+    text_buffer_free(&buffer);
+}
+
+static void test_text_buffer_lines(void **state)
+{
+    TextBuffer buffer;
+
+    (void)state;
+    text_buffer_init(&buffer, "a\nbb\n\nccc");
+    assert_int_equal(text_buffer_line_count(&buffer), 4);
+    assert_int_equal(text_buffer_line_start(&buffer, 0), 0);
+    assert_int_equal(text_buffer_line_start(&buffer, 1), 2);
+    assert_int_equal(text_buffer_line_start(&buffer, 2), 5);
+    assert_int_equal(text_buffer_line_start(&buffer, 3), 6);
+    /* 超出行数夹到最后一行 */
+    assert_int_equal(text_buffer_line_start(&buffer, 9), 6);
+
+    assert_int_equal(text_buffer_line_of(&buffer, 0), 0);
+    assert_int_equal(text_buffer_line_of(&buffer, 1), 0);
+    assert_int_equal(text_buffer_line_of(&buffer, 2), 1);
+    assert_int_equal(text_buffer_line_of(&buffer, 5), 2);
+    assert_int_equal(text_buffer_line_of(&buffer, 9), 3);
+
+    text_buffer_insert(&buffer, 3, "\n", 1);
+    assert_buffer_equals(&buffer, "a\nb\nb\n\nccc");
+    assert_int_equal(text_buffer_line_count(&buffer), 5);
+    assert_int_equal(text_buffer_line_start(&buffer, 2), 4);
+    assert_int_equal(text_buffer_byte_at(&buffer, 4), 'b');
+
+    text_buffer_delete(&buffer, 1, 3);
+    assert_buffer_equals(&buffer, "ab\n\nccc");
+    assert_int_equal(text_buffer_line_count(&buffer), 3);
+    text_buffer_free(&buffer);
+}
+
+/* 与平坦字符串对照的随机编辑，覆盖跨片段切分与大文本分片 */
+static void test_text_buffer_random_edits(void **state)
+{
+    TextBuffer buffer;
+    int cap = TEXT_BUFFER_PIECE_MAX * 8;
+    char *ref = malloc((size_t)cap + 1);
+    int ref_len;
+    unsigned int seed = 12345u;
+    int i;
+
+    (void)state;
+    assert_non_null(ref);
+    for (i = 0; i < TEXT_BUFFER_PIECE_MAX * 3; i++) {
+        ref[i] = (i % 37 == 0) ? '\n' : (char)('a' + i % 26);
+    }
+    ref_len = TEXT_BUFFER_PIECE_MAX * 3;
+    ref[ref_len] = '\0';
+    text_buffer_init(&buffer, ref);
+
+    for (i = 0; i < 2000; i++) {
+        int pos;
+        seed = seed * 1103515245u + 12345u;
+        pos = ref_len > 0 ? (int)((seed >> 8) % (unsigned int)(ref_len + 1)) : 0;
+        if ((seed & 3u) != 0 && ref_len + 3 < cap) {
+            const char *ins = (seed & 16u) ? "x\ny" : "zz";
+            int n = (int)strlen(ins);
+            memmove(ref + pos + n, ref + pos, (size_t)(ref_len - pos));
+            memcpy(ref + pos, ins, (size_t)n);
+            ref_len += n;
+            assert_int_equal(text_buffer_insert(&buffer, pos, ins, n), 0);
+        } else {
+            int n = (int)((seed >> 4) % 64u);
+            if (n > ref_len - pos) n = ref_len - pos;
+            memmove(ref + pos, ref + pos + n, (size_t)(ref_len - pos - n));
+            ref_len -= n;
+            assert_int_equal(text_buffer_delete(&buffer, pos, n), 0);
+        }
+        ref[ref_len] = '\0';
+        assert_int_equal(text_buffer_length(&buffer), ref_len);
+    }
+    assert_buffer_equals(&buffer, ref);
+
+    {
+        int line = 0;
+        int p;
+        for (p = 0; p <= ref_len; p++) {
+            assert_int_equal(text_buffer_line_of(&buffer, p), line);
+            if (p == 0 || ref[p - 1] == '\n') {
+                assert_int_equal(text_buffer_line_start(&buffer, line), p);
+            }
+            if (p < ref_len) {
+                assert_int_equal(text_buffer_byte_at(&buffer, p), ref[p]);
+                if (ref[p] == '\n') line++;
+            }
+        }
+        assert_int_equal(text_buffer_line_count(&buffer), line + 1);
+    }
+
+    text_buffer_free(&buffer);
+    free(ref);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_text_buffer_insert_delete),
+        cmocka_unit_test(test_text_buffer_lines),
+        cmocka_unit_test(test_text_buffer_random_edits),
+    };
+
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
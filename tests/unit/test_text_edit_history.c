@@ -0,0 +1,234 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "components/text_edit_history.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+/* 平坦字符串充当文档，模拟 TextComponent 的替换与回放 */
+typedef struct {
+    char *text;
+    int len;
+    int cap;
+} Doc;
+
+static void doc_init(Doc *doc, int len)
+{
+    int i;
+    doc->cap = len + 4096;
+    doc->text = malloc((size_t)doc->cap + 1);
+    assert_non_null(doc->text);
+    for (i = 0; i < len; i++) {
+        doc->text[i] = (char)('a' + i % 26);
+    }
+    doc->len = len;
+    doc->text[len] = '\0';
+}
+
+static void doc_splice(Doc *doc, int pos, int del, const char *ins, int ins_len)
+{
+    assert_true(doc->len - del + ins_len <= doc->cap);
+    memmove(doc->text + pos + ins_len, doc->text + pos + del, (size_t)(doc->len - pos - del));
+    if (ins_len > 0) {
+        memcpy(doc->text + pos, ins, (size_t)ins_len);
+    }
+    doc->len += ins_len - del;
+    doc->text[doc->len] = '\0';
+}
+
+static void doc_replace(TextEditHistory *history, Doc *doc, int pos, int del,
+                        const char *ins, int ins_len)
+{
+    assert_int_equal(text_edit_history_record(history, pos, doc->text + pos, del, ins, ins_len), 0);
+    doc_splice(doc, pos, del, ins, ins_len);
+}
+
+static void doc_apply_step(Doc *doc, const TextEditStep *step, int reverse)
+{
+    int i;
+    for (i = 0; i < step->op_count; i++) {
+        const TextEditOp *op = &step->ops[reverse ? step->op_count - 1 - i : i];
+        if (reverse) {
+            doc_splice(doc, op->pos, op->inserted_len, op->removed, op->removed_len);
+        } else {
+            doc_splice(doc, op->pos, op->removed_len, op->inserted, op->inserted_len);
+        }
+    }
+}
+
+static void begin(TextEditHistory *history, int cursor, TextEditKind kind, unsigned int now_ms)
+{
+    TextEditState state;
+    text_edit_state_set(&state, cursor, -1, -1, NULL, 0, 0);
+    text_edit_history_before_edit(history, &state, kind, now_ms);
+}
+
+/* 同样的编辑序列在不同大小的文档上，历史占用的字节数必须相同 */
+static size_t history_bytes_for(int doc_len, int edits, int edit_size)
+{
+    TextEditHistory history;
+    Doc doc;
+    char chunk[256];
+    size_t bytes;
+    int i;
+
+    memset(chunk, 'x', sizeof(chunk));
+    text_edit_history_init(&history, (size_t)1 << 30);
+    doc_init(&doc, doc_len);
+    for (i = 0; i < edits; i++) {
+        /* 超出合并窗口，每次都是独立的一步 */
+        begin(&history, i, TEXT_EDIT_TYPING, (unsigned int)i * 1000u);
+        doc_replace(&history, &doc, (i * 7919) % (doc.len + 1), 0, chunk, edit_size);
+    }
+    bytes = text_edit_history_bytes(&history);
+    text_edit_history_free(&history);
+    free(doc.text);
+    return bytes;
+}
+
+static void test_history_memory_independent_of_document(void **state)
+{
+    size_t small_doc;
+    size_t large_doc;
+    size_t double_edit;
+
+    (void)state;
+    small_doc = history_bytes_for(16, 50, 8);
+    large_doc = history_bytes_for(4 * 1024 * 1024, 50, 8);
+    assert_int_equal(small_doc, large_doc);
+
+    /* 编辑量翻倍，增长的正好是多出来的文本字节 */
+    double_edit = history_bytes_for(4 * 1024 * 1024, 50, 16);
+    assert_int_equal(double_edit - large_doc, 50 * 8);
+    assert_true(large_doc < 50 * 512);
+}
+
+static void test_history_undo_redo_coalesced(void **state)
+{
+    TextEditHistory history;
+    Doc doc;
+    const TextEditStep *step;
+    unsigned int now = 1000;
+    int i;
+
+    (void)state;
+    text_edit_history_init(&history, 0);
+    doc_init(&doc, 10);
+    doc_splice(&doc, 0, 10, "hello", 5);
+
+    /* 连续输入在窗口内合并成一步、一个操作 */
+    for (i = 0; i < 6; i++) {
+        begin(&history, 5 + i, TEXT_EDIT_TYPING, now);
+        doc_replace(&history, &doc, 5 + i, 0, &" world"[i], 1);
+        now += 50;
+    }
+    assert_string_equal(doc.text, "hello world");
+    assert_int_equal(history.undo_count, 1);
+    assert_int_equal(history.undo[0]->op_count, 1);
+
+    /* 连续退格同样合并 */
+    now += 1000;
+    for (i = 0; i < 3; i++) {
+        begin(&history, doc.len, TEXT_EDIT_DELETE, now);
+        doc_replace(&history, &doc, doc.len - 1, 1, NULL, 0);
+        now += 50;
+    }
+    assert_string_equal(doc.text, "hello wo");
+    assert_int_equal(history.undo_count, 2);
+    assert_int_equal(history.undo[1]->op_count, 1);
+
+    /* 替换选区：删除 + 插入记在同一步 */
+    now += 1000;
+    begin(&history, 0, TEXT_EDIT_REPLACE, now);
+    doc_replace(&history, &doc, 0, 5, NULL, 0);
+    doc_replace(&history, &doc, 0, 0, "HEY", 3);
+    assert_string_equal(doc.text, "HEY wo");
+
+    step = text_edit_history_undo(&history, NULL);
+    assert_non_null(step);
+    doc_apply_step(&doc, step, 1);
+    assert_string_equal(doc.text, "hello wo");
+    assert_int_equal(step->before.cursor_pos, 0);
+
+    step = text_edit_history_undo(&history, NULL);
+    doc_apply_step(&doc, step, 1);
+    assert_string_equal(doc.text, "hello world");
+    step = text_edit_history_undo(&history, NULL);
+    doc_apply_step(&doc, step, 1);
+    assert_string_equal(doc.text, "hello");
+    assert_false(text_edit_history_can_undo(&history));
+
+    step = text_edit_history_redo(&history);
+    doc_apply_step(&doc, step, 0);
+    step = text_edit_history_redo(&history);
+    doc_apply_step(&doc, step, 0);
+    assert_string_equal(doc.text, "hello wo");
+    assert_true(text_edit_history_can_redo(&history));
+
+    /* 新编辑清空 redo */
+    begin(&history, 0, TEXT_EDIT_TYPING, now + 5000);
+    doc_replace(&history, &doc, 0, 0, "!", 1);
+    assert_false(text_edit_history_can_redo(&history));
+
+    text_edit_history_free(&history);
+    free(doc.text);
+}
+
+static void test_history_byte_cap(void **state)
+{
+    TextEditHistory history;
+    char chunk[1024];
+    int i;
+
+    (void)state;
+    memset(chunk, 'y', sizeof(chunk));
+    text_edit_history_init(&history, 8 * 1024);
+    for (i = 0; i < 64; i++) {
+        begin(&history, 0, TEXT_EDIT_REPLACE, (unsigned int)i);
+        assert_int_equal(text_edit_history_record(&history, 0, NULL, 0, chunk, (int)sizeof(chunk)), 0);
+        assert_true(text_edit_history_bytes(&history) <= 8 * 1024);
+    }
+    assert_true(history.undo_count > 1);
+    assert_true(history.undo_count < 64);
+
+    /* 单步超过上限时仍保留最新一步 */
+    begin(&history, 0, TEXT_EDIT_REPLACE, 100);
+    for (i = 0; i < 16; i++) {
+        assert_int_equal(text_edit_history_record(&history, i * (int)sizeof(chunk), NULL, 0,
+                                                  chunk, (int)sizeof(chunk)), 0);
+    }
+    assert_int_equal(history.undo_count, 1);
+    assert_true(text_edit_history_can_undo(&history));
+
+    text_edit_history_free(&history);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_history_memory_independent_of_document),
+        cmocka_unit_test(test_history_undo_redo_coalesced),
+        cmocka_unit_test(test_history_byte_cap),
+    };
+
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,234 @@
+/*
+ * Incremental visual-line layout: random inserts and deletes (including ones
+ * that add or remove paragraph breaks, and pairs of edits that leave two
+ * pending dirty ranges in one paragraph) must give the same wrap breaks,
+ * visual line ranges and per-paragraph prefix line counts as a layout
+ * rebuilt from scratch. Before re-wrapping, the Fenwick totals must match the
+ * per-paragraph counts, with unmeasured paragraphs estimated from their bytes.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "components/text_buffer.h"
+#include "components/text_layout.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define WIDTH 12
+#define EST_BYTES 10
+#define ROUNDS 2000
+
+static unsigned int g_rng = 2463534242u;
+
+static int rnd(int n)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return (int)(g_rng % (unsigned int)n);
+}
+
+/* Greedy word wrap in bytes: break after the last space that fits, else hard. */
+static int wrap_words(void *user, int start, int para_end, int max_width)
+{
+    const TextBuffer *buffer = (const TextBuffer *)user;
+    int limit = start + max_width;
+    int i;
+    if (para_end <= limit) {
+        return para_end;
+    }
+    for (i = limit; i > start; i--) {
+        if (text_buffer_byte_at(buffer, i - 1) == ' ') {
+            return i;
+        }
+    }
+    return limit;
+}
+
+static int count_newlines(const TextBuffer *buffer, int pos, int len)
+{
+    char *text = malloc((size_t)len + 1);
+    int lines = 0;
+    int i;
+    assert_non_null(text);
+    assert_int_equal(text_buffer_copy(buffer, pos, pos + len, text), len);
+    for (i = 0; i < len; i++) {
+        lines += text[i] == '\n';
+    }
+    free(text);
+    return lines;
+}
+
+static void random_text(char *out, int len, int allow_newline)
+{
+    static const char alphabet[] = "abcdefg  hij ";
+    int i;
+    for (i = 0; i < len; i++) {
+        out[i] = allow_newline && rnd(24) == 0 ? '\n' : alphabet[rnd((int)sizeof(alphabet) - 1)];
+    }
+}
+
+/* One edit through both the buffer and the layout. near >= 0 keeps it inside
+   that paragraph and free of newlines, so it merges with a pending edit. */
+static void apply_edit(TextBuffer *buffer, TextLayout *layout, int near)
+{
+    char ins[32];
+    int total = text_buffer_length(buffer);
+    int pos;
+    int removed = 0;
+    int removed_lines = 0;
+    int inserted = 0;
+
+    if (near >= 0) {
+        int start = text_buffer_line_start(buffer, near);
+        int len = layout->paras[near].len;
+        pos = start + rnd(len + 1);
+        removed = rnd(2) == 0 ? rnd(start + len - pos + 1 < 8 ? start + len - pos + 1 : 8) : 0;
+        inserted = rnd(10);
+        random_text(ins, inserted, 0);
+    } else {
+        pos = rnd(total + 1);
+        removed = rnd(3) != 0 ? rnd(total - pos + 1 < 30 ? total - pos + 1 : 30) : 0;
+        inserted = rnd(3) != 0 ? rnd((int)sizeof(ins)) : 0;
+        random_text(ins, inserted, 1);
+    }
+    if (removed > 0) {
+        removed_lines = count_newlines(buffer, pos, removed);
+        assert_int_equal(text_buffer_delete(buffer, pos, removed), 0);
+    }
+    if (inserted > 0) {
+        assert_int_equal(text_buffer_insert(buffer, pos, ins, inserted), 0);
+    }
+    assert_int_equal(text_layout_replace(layout, buffer, pos, removed, removed_lines, inserted), 0);
+}
+
+/* Fenwick prefixes against a plain sum, with byte estimates for unmeasured paragraphs. */
+static void check_prefix_sums(TextLayout *layout, const TextBuffer *buffer)
+{
+    int sum = 0;
+    int i;
+    assert_int_equal(layout->para_count, text_buffer_line_count(buffer));
+    for (i = 0; i < layout->para_count; i++) {
+        const TextLayoutPara *para = &layout->paras[i];
+        int start = text_buffer_line_start(buffer, i);
+        int end = i + 1 < layout->para_count ? text_buffer_line_start(buffer, i + 1) - 1
+                                             : text_buffer_length(buffer);
+        int lines;
+        assert_int_equal(para->len, end - start);
+        if (para->visual_count > 0) {
+            lines = para->visual_count;
+        } else {
+            lines = para->len > 0 ? (para->len + EST_BYTES - 1) / EST_BYTES : 1;
+        }
+        assert_int_equal(text_layout_para_first_line(layout, i), sum);
+        sum += lines;
+    }
+    assert_int_equal(text_layout_line_count(layout), sum);
+}
+
+static void check_against_rebuild(TextLayout *layout, TextBuffer *buffer)
+{
+    TextLayout fresh;
+    int count;
+    int i;
+
+    text_layout_init(&fresh);
+    assert_int_equal(text_layout_reset(&fresh, buffer, WIDTH, 1, EST_BYTES), 0);
+    for (i = 0; i < fresh.para_count; i++) {
+        assert_int_equal(text_layout_measure_para(&fresh, buffer, i, wrap_words, buffer), 0);
+        assert_int_equal(text_layout_measure_para(layout, buffer, i, wrap_words, buffer), 0);
+    }
+    assert_int_equal(layout->para_count, fresh.para_count);
+    for (i = 0; i < fresh.para_count; i++) {
+        const TextLayoutPara *a = &layout->paras[i];
+        const TextLayoutPara *b = &fresh.paras[i];
+        assert_int_equal(a->dirty, 0);
+        assert_int_equal(a->visual_count, b->visual_count);
+        if (b->visual_count > 1) {
+            assert_memory_equal(a->breaks, b->breaks, (size_t)(b->visual_count - 1) * sizeof(int));
+        }
+        assert_int_equal(text_layout_para_first_line(layout, i), text_layout_para_first_line(&fresh, i));
+    }
+    count = text_layout_line_count(&fresh);
+    assert_int_equal(text_layout_line_count(layout), count);
+    for (i = 0; i < count; i++) {
+        int s0, e0, s1, e1;
+        text_layout_line_range(layout, buffer, i, wrap_words, buffer, &s0, &e0);
+        text_layout_line_range(&fresh, buffer, i, wrap_words, buffer, &s1, &e1);
+        assert_int_equal(s0, s1);
+        assert_int_equal(e0, e1);
+    }
+    text_layout_free(&fresh);
+}
+
+static void test_random_edits_match_rebuild(void **state)
+{
+    TextBuffer buffer;
+    TextLayout layout;
+    int merged = 0;
+    int round;
+
+    (void)state;
+    text_buffer_init(&buffer, "the quick brown fox jumps over the lazy dog\n"
+                              "\n"
+                              "pack my box with five dozen liquor jugs and then some more words\n"
+                              "short\n"
+                              "a rather long paragraph that wraps over several visual lines here");
+    text_layout_init(&layout);
+    assert_int_equal(text_layout_reset(&layout, &buffer, WIDTH, 1, EST_BYTES), 0);
+    check_prefix_sums(&layout, &buffer);
+    check_against_rebuild(&layout, &buffer);
+
+    for (round = 0; round < ROUNDS; round++) {
+        if (rnd(3) == 0) {
+            apply_edit(&buffer, &layout, -1);
+        } else {
+            /* One or two edits in a measured paragraph before it is re-wrapped */
+            int para = rnd(layout.para_count);
+            apply_edit(&buffer, &layout, para);
+            if (rnd(2) == 0) {
+                merged += layout.paras[para].dirty;
+                apply_edit(&buffer, &layout, para);
+            }
+        }
+        check_prefix_sums(&layout, &buffer);
+        check_against_rebuild(&layout, &buffer);
+        if (text_buffer_length(&buffer) > 4000) {
+            assert_int_equal(text_buffer_delete(&buffer, 0, 2000), 0);
+            assert_int_equal(text_layout_reset(&layout, &buffer, WIDTH, 1, EST_BYTES), 0);
+        }
+    }
+    /* The random walk must actually have merged pending edits */
+    assert_true(merged > 0);
+
+    text_layout_free(&layout);
+    text_buffer_free(&buffer);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_random_edits_match_rebuild),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
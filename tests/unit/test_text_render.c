@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <cmocka.h>
 
 #include "ytype.h"
@@ -75,10 +76,80 @@ static void test_multiline_create_and_update(void **state)
     layer_set_text(&layer, NULL);
 }
 
+static void send_key(Layer *layer, int key_code)
+{
+    KeyEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = KEY_EVENT_DOWN;
+    event.data.key.key_code = key_code;
+    text_component_handle_key_event(layer, &event);
+}
+
+/* 渲染与光标只从 piece table 拷贝可见行，不物化整篇文本 */
+static void test_render_copies_visible_lines_only(void **state)
+{
+    enum { LINES = 5000 };
+    Layer layer;
+    TextComponent *comp;
+    char *text;
+    int i;
+
+    (void)state;
+    text = malloc(LINES * 6 + 1);
+    assert_non_null(text);
+    for (i = 0; i < LINES; i++) {
+        memcpy(text + i * 6, "line \n", 6);
+        text[i * 6 + 4] = (char)('a' + i % 26);
+    }
+    text[LINES * 6 - 1] = '\0';
+
+    memset(&layer, 0, sizeof(layer));
+    strcpy(layer.id, "bigText");
+    layer.rect = (Rect){0, 0, 400, 300};
+    layer.type = TEXT;
+    layer.color = (Color){0, 0, 0, 255};
+    layer_set_text(&layer, text);
+    comp = text_component_create(&layer);
+    assert_non_null(comp);
+    text_component_set_multiline(comp, 1);
+    SET_STATE((&layer), LAYER_STATE_FOCUSED);
+
+    /* 编辑后 layer->text 过期，渲染（含选区、光标）不应把它物化 */
+    comp->cursor_pos = 6 * 3 + 5;
+    send_key(&layer, SDLK_BACKSPACE);
+    assert_int_equal(comp->cursor_pos, 6 * 3 + 4);
+    comp->selection_start = 0;
+    comp->selection_end = 6 * 10;
+    text_component_render(&layer);
+    assert_int_equal(comp->text_stale, 1);
+    assert_true(comp->view_len < 6 * 40);
+
+    /* 上下移动保持列，短行夹到行尾 */
+    send_key(&layer, SDLK_UP);
+    assert_int_equal(comp->cursor_pos, 6 * 2 + 4);
+    send_key(&layer, SDLK_DOWN);
+    send_key(&layer, SDLK_DOWN);
+    assert_int_equal(comp->cursor_pos, 6 * 4 - 1 + 4);
+    comp->cursor_pos = LINES * 6 - 2;
+    send_key(&layer, SDLK_DOWN);
+    assert_int_equal(comp->cursor_pos, LINES * 6 - 2);
+    assert_int_equal(comp->text_stale, 1);
+
+    /* 读取时才物化，内容与编辑一致 */
+    text[6 * 3 + 4] = '\0';
+    assert_memory_equal(layer_get_text(&layer), text, 6 * 3 + 4);
+    assert_int_equal(comp->text_stale, 0);
+
+    text_component_destroy(comp);
+    layer_set_text(&layer, NULL);
+    free(text);
+}
+
 int main(int argc, char **argv)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_multiline_create_and_update),
+        cmocka_unit_test(test_render_copies_visible_lines_only),
     };
     (void)argc;
     (void)argv;
@@ -0,0 +1,355 @@
+// test_theme_index.c
+// 主题选择器索引与解析缓存：随机规则集上，theme_apply_to_layer 的级联顺序
+// 必须与旧的线性匹配（逐条比对 + 按 specificity 稳定排序）完全一致。
+// 每条规则的 style 带一个 tag，经 layer->set_style 按合并顺序记录下来。
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#include "ytype.h"
+#include "theme.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+#define MAX_RULES 200
+#define MAX_TRACE 256
+
+static const char *k_ids[] = {"ok", "cancel", "title", "u1", "u2"};
+static const char *k_types[] = {"Button", "Label", "View"};
+static const char *k_modifiers[] = {"primary", "large", "dark", "flat"};
+
+static unsigned int g_rng = 88172645u;
+static int g_trace[MAX_TRACE];
+static int g_trace_count;
+static int g_next_tag;
+
+static int rnd(int n)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return (int)(g_rng % (unsigned int)n);
+}
+
+#define PICK(arr) (arr)[rnd((int)(sizeof(arr) / sizeof((arr)[0])))]
+
+static void record_style(Layer *layer, cJSON *style)
+{
+    cJSON *tag = cJSON_GetObjectItem(style, "tag");
+    (void)layer;
+    assert_non_null(tag);
+    assert_true(g_trace_count < MAX_TRACE);
+    g_trace[g_trace_count++] = tag->valueint;
+}
+
+// ---- 旧的线性匹配（索引引入前的实现），作为参照 ----
+
+static int ref_is_separator(char c)
+{
+    return c == ' ' || c == ',' || c == ';' || c == '\t';
+}
+
+static int ref_variant_contains(const char *variant_str, const char *modifier)
+{
+    const char *p = variant_str;
+    if (!variant_str || !modifier || modifier[0] == '\0') {
+        return 0;
+    }
+    while (*p) {
+        size_t len = 0;
+        while (ref_is_separator(*p)) {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        while (p[len] && !ref_is_separator(p[len])) {
+            len++;
+        }
+        if (strlen(modifier) == len && strncmp(p, modifier, len) == 0) {
+            return 1;
+        }
+        p += len;
+    }
+    return 0;
+}
+
+static int ref_variant_contains_all(const char *variant_str, const char *modifiers)
+{
+    const char *p;
+    if (!variant_str || variant_str[0] == '\0' || !modifiers || modifiers[0] != '.') {
+        return 0;
+    }
+    p = modifiers + 1;
+    if (*p == '\0') {
+        return 0;
+    }
+    while (*p) {
+        char modifier[32];
+        int i = 0;
+        while (*p && *p != '.' && i < (int)sizeof(modifier) - 1) {
+            modifier[i++] = *p++;
+        }
+        modifier[i] = '\0';
+        if (i == 0 || !ref_variant_contains(variant_str, modifier)) {
+            return 0;
+        }
+        if (*p == '.') {
+            p++;
+        }
+    }
+    return 1;
+}
+
+static int ref_match_compound(const char *selector, const char *id, const char *type,
+                              const char *variant)
+{
+    const char *dot = strchr(selector, '.');
+    if (!dot || dot == selector || !ref_variant_contains_all(variant, dot)) {
+        return 0;
+    }
+    if (selector[0] == '#') {
+        size_t id_len = (size_t)(dot - selector) - 1;
+        return id_len > 0 && strncmp(id, selector + 1, id_len) == 0 && id[id_len] == '\0';
+    }
+    return strncmp(type, selector, (size_t)(dot - selector)) == 0 &&
+           type[dot - selector] == '\0';
+}
+
+static int ref_rule_matches(ThemeRule *rule, const char *id, const char *type,
+                            const char *variant)
+{
+    if (rule->selector_type == THEME_SELECTOR_ID) {
+        if (strchr(rule->selector + 1, '.')) {
+            return ref_match_compound(rule->selector, id, type, variant);
+        }
+        return strcmp(rule->selector + 1, id) == 0;
+    }
+    if (rule->selector_type == THEME_SELECTOR_TYPE) {
+        return strcmp(rule->selector, type) == 0;
+    }
+    return ref_match_compound(rule->selector, id, type, variant);
+}
+
+static int ref_specificity(ThemeRule *rule)
+{
+    int count = rule->selector_type == THEME_SELECTOR_ID ? 1000 : 0;
+    const char *dot;
+    if (rule->selector_type == THEME_SELECTOR_TYPE) {
+        return 0;
+    }
+    for (dot = strchr(rule->selector, '.'); dot; dot = strchr(dot + 1, '.')) {
+        count++;
+    }
+    return count;
+}
+
+// 期望的合并顺序：JSON 顺序的匹配规则按 specificity 稳定排序
+static int ref_cascade(Theme *theme, const char *id, const char *type, const char *variant,
+                       int *tags)
+{
+    ThemeRule *ordered[MAX_RULES];
+    int spec[MAX_RULES];
+    int rule_count = 0;
+    int count = 0;
+    int i;
+
+    for (ThemeRule *r = theme->rules; r; r = r->next) {
+        ordered[rule_count++] = r;
+    }
+    for (i = rule_count - 1; i >= 0; i--) {
+        if (!ref_rule_matches(ordered[i], id, type, variant)) {
+            continue;
+        }
+        tags[count] = cJSON_GetObjectItem(ordered[i]->style_json, "tag")->valueint;
+        spec[count] = ref_specificity(ordered[i]);
+        count++;
+    }
+    for (i = 1; i < count; i++) {
+        int tag = tags[i];
+        int s = spec[i];
+        int j = i - 1;
+        while (j >= 0 && spec[j] > s) {
+            tags[j + 1] = tags[j];
+            spec[j + 1] = spec[j];
+            j--;
+        }
+        tags[j + 1] = tag;
+        spec[j + 1] = s;
+    }
+    return count;
+}
+
+// ---- 随机规则与图层 ----
+
+static void random_selector(char *out, size_t size)
+{
+    int kind = rnd(5);
+    int modifiers = 1 + rnd(2);
+    int len;
+
+    if (kind == 0) {
+        snprintf(out, size, "#%s", PICK(k_ids));
+        return;
+    }
+    if (kind == 1) {
+        snprintf(out, size, "%s", PICK(k_types));
+        return;
+    }
+    len = kind == 2 ? snprintf(out, size, "#%s", PICK(k_ids)) : snprintf(out, size, "%s", PICK(k_types));
+    while (modifiers-- > 0) {
+        len += snprintf(out + len, size - (size_t)len, ".%s", PICK(k_modifiers));
+    }
+    if (rnd(16) == 0) {
+        snprintf(out + len, size - (size_t)len, ".");
+    }
+}
+
+static void add_random_rule(Theme *theme)
+{
+    char selector[48];
+    char json[160];
+    cJSON *obj;
+    ThemeRule *rule;
+
+    random_selector(selector, sizeof(selector));
+    snprintf(json, sizeof(json), "{\"selector\":\"%s\",\"style\":{\"tag\":%d}}", selector, g_next_tag++);
+    obj = cJSON_Parse(json);
+    assert_non_null(obj);
+    rule = theme_rule_create_from_json(obj);
+    cJSON_Delete(obj);
+    assert_non_null(rule);
+    assert_non_null(rule->style_json);
+    theme_add_rule(theme, rule);
+}
+
+static void random_variant(char *out, size_t size)
+{
+    static const char separators[] = " ,; ";
+    int tokens = rnd(4);
+    int len = 0;
+    out[0] = '\0';
+    while (tokens-- > 0) {
+        if (len > 0) {
+            out[len++] = separators[rnd(4)];
+        }
+        len += snprintf(out + len, size - (size_t)len, "%s", PICK(k_modifiers));
+    }
+}
+
+static void init_layer(Layer *layer, const char *id, const char *variant)
+{
+    memset(layer, 0, sizeof(*layer));
+    snprintf(layer->id, sizeof(layer->id), "%s", id);
+    snprintf(layer->variant, sizeof(layer->variant), "%s", variant);
+    layer->set_style = record_style;
+}
+
+static void check_layer(Theme *theme, const char *id, const char *type, const char *variant)
+{
+    int expected[MAX_TRACE];
+    int expected_count = ref_cascade(theme, id, type, variant, expected);
+    Layer layer;
+
+    init_layer(&layer, id, variant);
+    g_trace_count = 0;
+    theme_apply_to_layer(theme, &layer, id, type);
+    assert_int_equal(g_trace_count, expected_count);
+    if (expected_count > 0) {
+        assert_memory_equal(g_trace, expected, (size_t)expected_count * sizeof(int));
+    }
+    free(layer.font);
+}
+
+static void test_index_matches_linear_cascade(void **state)
+{
+    Theme *theme = theme_create("index-test", "1.0");
+    int round;
+
+    (void)state;
+    assert_non_null(theme);
+    while (g_next_tag < 40) {
+        add_random_rule(theme);
+    }
+    assert_int_equal(theme_compile(theme), 0);
+
+    for (round = 0; round < 3000; round++) {
+        char variant[64];
+        // theme_add_rule 作废索引与缓存，之后的匹配要包含新规则
+        if (rnd(25) == 0 && g_next_tag < MAX_RULES) {
+            add_random_rule(theme);
+        }
+        random_variant(variant, sizeof(variant));
+        check_layer(theme, PICK(k_ids), PICK(k_types), variant);
+    }
+    theme_destroy(theme);
+}
+
+static void test_shared_cache_key(void **state)
+{
+    static const char *rules[] = {
+        "{\"selector\":\"Button\",\"style\":{\"tag\":1}}",
+        "{\"selector\":\"Button.primary\",\"style\":{\"tag\":2}}",
+        "{\"selector\":\"#ok\",\"style\":{\"tag\":3}}",
+        "{\"selector\":\"Button\",\"style\":{\"tag\":4}}",
+    };
+    Theme *theme = theme_create("cache-test", "1.0");
+    size_t i;
+
+    (void)state;
+    for (i = 0; i < sizeof(rules) / sizeof(rules[0]); i++) {
+        cJSON *obj = cJSON_Parse(rules[i]);
+        theme_add_rule(theme, theme_rule_create_from_json(obj));
+        cJSON_Delete(obj);
+    }
+
+    // u1、u2 不被任何规则引用，两者共用同一条缓存；ok 有自己的签名
+    check_layer(theme, "u1", "Button", "primary");
+    check_layer(theme, "u2", "Button", "primary");
+    assert_int_equal(g_trace_count, 3);
+    assert_int_equal(g_trace[0], 1);
+    assert_int_equal(g_trace[1], 4);
+    assert_int_equal(g_trace[2], 2);
+    check_layer(theme, "ok", "Button", "primary");
+    assert_int_equal(g_trace[g_trace_count - 1], 3);
+
+    // 新规则引用 u2：缓存作废，u2 不再与 u1 共享结果
+    {
+        cJSON *obj = cJSON_Parse("{\"selector\":\"#u2.primary\",\"style\":{\"tag\":5}}");
+        theme_add_rule(theme, theme_rule_create_from_json(obj));
+        cJSON_Delete(obj);
+    }
+    check_layer(theme, "u2", "Button", "primary");
+    assert_int_equal(g_trace[g_trace_count - 1], 5);
+    check_layer(theme, "u1", "Button", "primary");
+    assert_int_equal(g_trace_count, 3);
+    theme_destroy(theme);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_index_matches_linear_cascade),
+        cmocka_unit_test(test_shared_cache_key),
+    };
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,283 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include "ytype.h"
+#include "layer.h"
+#include "ui_blob.h"
+#include "component_registry.h"
+#include "cJSON.h"
+
+int main(int argc, char **argv);
+
+#if defined(_WIN32)
+#include <windows.h>
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nCmdShow;
+    return main(__argc, __argv);
+}
+#endif
+
+static int setup_registry(void **state)
+{
+    (void)state;
+    yui_component_registry_init();
+    yui_components_register_builtin();
+    return 0;
+}
+
+/* 每行：水平布局的容器 + Label + Button + 带 data/events 的嵌套容器 */
+static char *make_ui_json(int rows)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON *children = cJSON_AddArrayToObject(root, "children");
+    char *text;
+    int i;
+
+    cJSON_AddStringToObject(root, "id", "root");
+    cJSON_AddStringToObject(root, "type", "View");
+    cJSON_AddStringToObject(root, "assets", "app/assets");
+    cJSON_AddNumberToObject(root, "fontSize", 14);
+    cJSON_AddItemToObject(root, "size", cJSON_CreateIntArray((const int[]){800, 600}, 2));
+    cJSON_AddItemToObject(cJSON_AddObjectToObject(root, "style"), "bgColor",
+                          cJSON_CreateString("#202020"));
+    for (i = 0; i < rows; i++) {
+        char id[32];
+        cJSON *row = cJSON_CreateObject();
+        cJSON *layout = cJSON_AddObjectToObject(row, "layout");
+        cJSON *style = cJSON_AddObjectToObject(row, "style");
+        cJSON *row_children = cJSON_AddArrayToObject(row, "children");
+        cJSON *label = cJSON_CreateObject();
+        cJSON *button = cJSON_CreateObject();
+        cJSON *extra = cJSON_CreateObject();
+
+        snprintf(id, sizeof(id), "row%d", i);
+        cJSON_AddStringToObject(row, "id", id);
+        cJSON_AddNumberToObject(row, "height", 32);
+        cJSON_AddStringToObject(layout, "type", "horizontal");
+        cJSON_AddNumberToObject(layout, "spacing", 4);
+        cJSON_AddStringToObject(style, "bgColor", i % 2 ? "#303030" : "#383838");
+        cJSON_AddNumberToObject(style, "radius", 4);
+        cJSON_AddItemToObject(style, "padding", cJSON_CreateIntArray((const int[]){2, 6}, 2));
+
+        snprintf(id, sizeof(id), "label%d", i);
+        cJSON_AddStringToObject(label, "id", id);
+        cJSON_AddStringToObject(label, "type", "Label");
+        cJSON_AddStringToObject(label, "text", "Item title");
+        cJSON_AddNumberToObject(label, "flex", 1);
+        cJSON_AddItemToArray(row_children, label);
+
+        snprintf(id, sizeof(id), "button%d", i);
+        cJSON_AddStringToObject(button, "id", id);
+        cJSON_AddStringToObject(button, "type", "Button");
+        cJSON_AddStringToObject(button, "text", "Open");
+        cJSON_AddNumberToObject(button, "width", 80);
+        cJSON_AddItemToObject(cJSON_AddObjectToObject(button, "events"), "onClick",
+                              cJSON_CreateString("@open"));
+        cJSON_AddItemToArray(row_children, button);
+
+        snprintf(id, sizeof(id), "extra%d", i);
+        cJSON_AddStringToObject(extra, "id", id);
+        cJSON_AddBoolToObject(extra, "visible", i % 3 != 0);
+        cJSON_AddItemToObject(extra, "data", cJSON_CreateIntArray((const int[]){i, i + 1}, 2));
+        cJSON_AddItemToObject(extra, "children", cJSON_CreateArray());
+        cJSON_AddItemToArray(row_children, extra);
+
+        cJSON_AddItemToArray(children, row);
+    }
+    text = cJSON_Print(root);
+    cJSON_Delete(root);
+    return text;
+}
+
+static int count_layers(const Layer *layer)
+{
+    int count = 1;
+    int i;
+    for (i = 0; i < layer->child_count; i++) {
+        count += count_layers(layer->children[i]);
+    }
+    return count;
+}
+
+static void assert_same_layer(const Layer *a, const Layer *b)
+{
+    int i;
+
+    assert_string_equal(a->id, b->id);
+    assert_int_equal(a->type, b->type);
+    assert_memory_equal(&a->rect, &b->rect, sizeof(a->rect));
+    assert_int_equal(a->fixed_width, b->fixed_width);
+    assert_int_equal(a->fixed_height, b->fixed_height);
+    assert_true(a->flex_ratio == b->flex_ratio);
+    assert_int_equal(a->visible, b->visible);
+    assert_memory_equal(&a->color, &b->color, sizeof(a->color));
+    assert_memory_equal(&a->bg_color, &b->bg_color, sizeof(a->bg_color));
+    assert_int_equal(a->radius, b->radius);
+    assert_memory_equal(a->padding, b->padding, sizeof(a->padding));
+    assert_int_equal(a->image_mode, b->image_mode);
+    assert_string_equal(layer_get_label(a), layer_get_label(b));
+    assert_string_equal(layer_get_text(a), layer_get_text(b));
+    assert_int_equal(a->font != NULL, b->font != NULL);
+    if (a->font) {
+        assert_string_equal(a->font->path, b->font->path);
+        assert_string_equal(a->font->weight, b->font->weight);
+        assert_int_equal(a->font->size, b->font->size);
+    }
+    assert_int_equal(a->assets != NULL, b->assets != NULL);
+    if (a->assets) {
+        assert_string_equal(a->assets->path, b->assets->path);
+    }
+    assert_int_equal(a->layout_manager != NULL, b->layout_manager != NULL);
+    if (a->layout_manager) {
+        assert_memory_equal(a->layout_manager, b->layout_manager, sizeof(LayoutManager));
+    }
+    assert_int_equal(a->component != NULL, b->component != NULL);
+    assert_int_equal(a->data != NULL, b->data != NULL);
+    assert_int_equal(a->event != NULL, b->event != NULL);
+    assert_int_equal(a->child_count, b->child_count);
+    for (i = 0; i < a->child_count; i++) {
+        assert_ptr_equal(b->children[i]->parent, b);
+        assert_same_layer(a->children[i], b->children[i]);
+    }
+}
+
+static void test_blob_matches_json(void **state)
+{
+    char *text = make_ui_json(50);
+    cJSON *json = parse_json_string(text);
+    void *data = NULL;
+    size_t size = 0;
+    UiBlob *blob;
+    Layer *from_json;
+    Layer *from_blob;
+
+    (void)state;
+    assert_non_null(json);
+    assert_int_equal(ui_blob_compile(json, NULL, &data, &size), 0);
+    assert_true(size < strlen(text));
+
+    from_json = layer_create_from_json(json, NULL);
+    blob = ui_blob_open_memory(data, size);
+    assert_non_null(blob);
+    from_blob = ui_blob_create_layers(blob, NULL);
+    /* 建好的树不再引用 blob 内存 */
+    ui_blob_close(blob);
+    memset(data, 0, size);
+
+    assert_non_null(from_blob);
+    assert_int_equal(count_layers(from_blob), 1 + 50 * 4);
+    assert_same_layer(from_json, from_blob);
+
+    destroy_layer(from_json);
+    destroy_layer(from_blob);
+    cJSON_Delete(json);
+    free(data);
+    free(text);
+}
+
+static void test_blob_file_and_validation(void **state)
+{
+    const char *path = "test_ui_blob.yuib";
+    char *text = make_ui_json(3);
+    cJSON *json = parse_json_string(text);
+    cJSON *theme = cJSON_Parse("{\"name\":\"blob-test\",\"styles\":[]}");
+    void *data = NULL;
+    size_t size = 0;
+    UiBlobHeader *header;
+    Layer *layer;
+
+    (void)state;
+    assert_int_equal(ui_blob_write_file(json, theme, path), 0);
+    assert_true(ui_blob_is_blob_file(path));
+    layer = ui_blob_load_file(path, NULL);
+    assert_non_null(layer);
+    assert_string_equal(layer->id, "root");
+    assert_int_equal(layer->child_count, 3);
+    destroy_layer(layer);
+    remove(path);
+
+    /* 版本、节点结构或越界引用不符时拒绝加载 */
+    assert_int_equal(ui_blob_compile(json, NULL, &data, &size), 0);
+    header = (UiBlobHeader *)data;
+    header->version++;
+    assert_null(ui_blob_open_memory(data, size));
+    header->version--;
+    header->node_size++;
+    assert_null(ui_blob_open_memory(data, size));
+    header->node_size--;
+    assert_null(ui_blob_open_memory(data, size - 1));
+    ((UiBlobNode *)((char *)data + header->node_offset))->first_child = 0;
+    assert_null(ui_blob_open_memory(data, size));
+
+    free(data);
+    cJSON_Delete(theme);
+    cJSON_Delete(json);
+    free(text);
+}
+
+/* 启动基准：文本 JSON 解析 + 建树 对比 二进制建树 */
+static void test_blob_startup_benchmark(void **state)
+{
+    const int rows = 2000;
+    const int rounds = 5;
+    char *text = make_ui_json(rows);
+    cJSON *json = parse_json_string(text);
+    void *data = NULL;
+    size_t size = 0;
+    clock_t json_ticks = 0;
+    clock_t blob_ticks = 0;
+    int i;
+
+    (void)state;
+    assert_int_equal(ui_blob_compile(json, NULL, &data, &size), 0);
+    cJSON_Delete(json);
+
+    for (i = 0; i < rounds; i++) {
+        clock_t start = clock();
+        cJSON *parsed = parse_json_string(text);
+        Layer *layer = layer_create_from_json(parsed, NULL);
+        cJSON_Delete(parsed);
+        json_ticks += clock() - start;
+        assert_int_equal(count_layers(layer), 1 + rows * 4);
+        destroy_layer(layer);
+
+        start = clock();
+        UiBlob *blob = ui_blob_open_memory(data, size);
+        layer = ui_blob_create_layers(blob, NULL);
+        ui_blob_close(blob);
+        blob_ticks += clock() - start;
+        assert_int_equal(count_layers(layer), 1 + rows * 4);
+        destroy_layer(layer);
+    }
+
+    print_message("ui startup (%d layers, json %zu bytes, blob %zu bytes): json %.2f ms, blob %.2f ms\n",
+                  1 + rows * 4, strlen(text), size,
+                  json_ticks * 1000.0 / CLOCKS_PER_SEC / rounds,
+                  blob_ticks * 1000.0 / CLOCKS_PER_SEC / rounds);
+
+    free(data);
+    free(text);
+}
+
+int main(int argc, char **argv)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_blob_matches_json),
+        cmocka_unit_test(test_blob_file_and_validation),
+        cmocka_unit_test(test_blob_startup_benchmark),
+    };
+
+    (void)argc;
+    (void)argv;
+    return cmocka_run_group_tests(tests, setup_registry, NULL);
+}
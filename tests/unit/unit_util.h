@@ -0,0 +1,55 @@
+/*
+ * Helpers shared by unit tests: a monotonic clock for benchmarks and
+ * scratch file paths in the system temp dir, so tests do not depend on
+ * the working directory.
+ */
+#ifndef YUI_TESTS_UNIT_UTIL_H
+#define YUI_TESTS_UNIT_UTIL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+static inline double unit_now_ms(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER freq = {0};
+    LARGE_INTEGER cnt;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&cnt);
+    return (double)cnt.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+#endif
+}
+
+/* <tmp>/<pid>_<name>; the pid keeps parallel runs apart. */
+static inline void unit_temp_path(char *buf, size_t size, const char *name)
+{
+#if defined(_WIN32)
+    const char *dir = getenv("TEMP");
+    if (!dir || !dir[0]) {
+        dir = ".";
+    }
+    snprintf(buf, size, "%s\\%d_%s", dir, _getpid(), name);
+#else
+    const char *dir = getenv("TMPDIR");
+    if (!dir || !dir[0]) {
+        dir = "/tmp";
+    }
+    snprintf(buf, size, "%s/%d_%s", dir, (int)getpid(), name);
+#endif
+}
+
+#endif
@@ -697,6 +697,7 @@ def add_flags():
             '-lSDL2_ttf',
             '-lSDL2_image',
             '-lm',
+            '-lpthread',
             '-lws2_32',
             '-ldwmapi'
             )